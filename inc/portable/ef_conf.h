@@ -107,6 +107,21 @@
  */
 #define EF_DEF_VFAT_BUFFER_DYNAMIC  ( 2 )
 
+/**
+ *  This defines working on buffers checked out of a pool for LFN support.
+ */
+#define EF_DEF_VFAT_BUFFER_POOL  ( 3 )
+
+/**
+ *  This defines the system port without RTOS (src/portable/ef_port_system.c).
+ */
+#define EF_DEF_PORT_SYSTEM_BARE   ( 0 )
+
+/**
+ *  This defines the POSIX threads system port for host builds (src/portable/ef_port_systemPosix.c).
+ */
+#define EF_DEF_PORT_SYSTEM_POSIX  ( 1 )
+
 /* ************************************************************************* **
  *  Function Configurations
  * ************************************************************************* */
@@ -126,6 +141,117 @@
  */
 #define EF_CONF_USE_FIND 2
 
+/**
+ *  This option switches the volume creation function, eEF_mkfs(). It writes the
+ *  FATs, the root directory and, unless a quick format is asked for, the data area
+ *  with the whole working buffer per drive command. The volume is designated by
+ *  physical drive and partition, the working buffer is given by the caller and
+ *  GPT is not supported. (0:Disable or 1:Enable)
+ */
+#define EF_CONF_USE_MKFS  ( 1 )
+
+/**
+ *  This option switches the resumable file functions eEF_fread_nb(), eEF_fwrite_nb()
+ *  and eEF_fsync_nb(). They return EF_RET_PENDING while a data transfer started by the
+ *  optional drive functions pxReadStart/pxWriteStart is in progress, and continue from
+ *  the state saved in the file object on the next call, they are meant for bare-metal
+ *  callers polling from a single context. (0:Disable or 1:Enable)
+ */
+#define EF_CONF_NON_BLOCKING  ( 0 )
+
+/**
+ *  This option switches the bounded latency write mode of a file, eEF_fbounded(),
+ *  eEF_fmaintain() and eEF_fbounded_stats(). In this mode the cluster crossings of
+ *  eEF_fwrite() take clusters from a pool linked in advance, the directory entry and
+ *  the pool are updated by eEF_fmaintain() only, and each eEF_fwrite() call issues at
+ *  most EF_CONF_BOUNDED_WRITE_CMDS drive commands. (0:Disable or 1:Enable)
+ */
+#define EF_CONF_BOUNDED_WRITE ( 0 )
+
+/**
+ *  Maximum number of drive commands of an eEF_fwrite() call in bounded latency write
+ *  mode, a call writing less than requested must be completed by the next ones. (3 or more)
+ */
+#define EF_CONF_BOUNDED_WRITE_CMDS  ( 4 )
+
+/**
+ *  This option switches the digest of the data read from a file, eEF_fdigest() and
+ *  eEF_fdigest_offset(). The digest function attached to a file is called with the
+ *  bytes transferred by eEF_fread(), eEF_fread_nb() and eEF_forward() while they are
+ *  still in the cache, so a CRC or hash needs no extra pass. (0:Disable or 1:Enable)
+ */
+#define EF_CONF_FILE_DIGEST ( 0 )
+
+/**
+ *  Number of allocation groups the volume is divided in. Each new cluster chain
+ *  starts searching for free clusters at the beginning of the next group, so the
+ *  files and directories created one after another grow in different areas of the
+ *  volume instead of interleaving their clusters. Whatever this setting, a chain
+ *  growing takes the cluster following its last one first when it is free, then
+ *  falls back to the last allocated cluster of the volume. (0 or 1:Disable, up to 255)
+ */
+#define EF_CONF_ALLOC_GROUPS  ( 8 )
+
+/**
+ *  Number of free extents kept by each volume for eEF_expand(). The index is built
+ *  with a single pass over the FAT the first time a contiguous run is wanted, then
+ *  kept up to date as the clusters are allocated and freed. It only holds the
+ *  largest runs of free clusters, sorted by length, so the best fitting one is
+ *  found by a binary search. When disabled, each contiguous run is searched for
+ *  by scanning the FAT, the first one large enough is taken. (0:Disable, up to 255)
+ */
+#define EF_CONF_FREE_EXTENTS  ( 8 )
+
+/**
+ *  This option switches the lazy free cluster count of the volumes. When the
+ *  FSINFO free count is absent or not trusted, the mount does not scan the FAT:
+ *  the allocations work without the count, and eEF_getfree_slice() counts the
+ *  free clusters a few FAT sectors at a time from a maintenance task. The
+ *  allocations and frees made meanwhile are followed, and eEF_getfree() only
+ *  scans the part of the FAT not counted yet. (0:Disable or 1:Enable)
+ */
+#define EF_CONF_LAZY_FREE_COUNT ( 0 )
+
+/**
+ *  This option switches the allocation snapshot of the FAT32 volumes. eEF_umount()
+ *  saves the number of free clusters, the last allocated cluster and the largest
+ *  free extents in the reserved bytes of the FSINFO sector, with a generation
+ *  number. The next mount takes them back when no writable mount has followed
+ *  the snapshot and it still matches the FSINFO fields, so the first allocations
+ *  need no FAT scan. A writable mount stores its own generation number first, so
+ *  a power loss cannot leave a stale snapshot behind. The free extents are still
+ *  checked in the FAT before the first allocation from them, but a volume changed
+ *  by a system which does not update FSINFO must not be mounted with this option,
+ *  its free cluster count would be wrong. (0:Disable or 1:Enable)
+ */
+#define EF_CONF_ALLOC_SNAPSHOT  ( 0 )
+
+/**
+ *  This option switches the per-file preallocation eEF_reserve(). The reserved
+ *  clusters are linked past the end of the file in one contiguous run, and the
+ *  unused ones are given back by eEF_fclose() and eEF_truncate(). (0:Disable or 1:Enable)
+ */
+#define EF_CONF_FILE_RESERVE  ( 0 )
+
+/**
+ *  This option switches how eEF_fopen() truncates an existing file. When enabled,
+ *  the cluster chain of the file is kept: the new data overwrite its clusters in
+ *  place and the clusters left past the end of the file are freed on closing, as
+ *  for a reservation made by eEF_reserve(). When disabled, the chain is freed on
+ *  opening and allocated again cluster by cluster by the writes. It needs
+ *  EF_CONF_FILE_RESERVE. (0:Disable or 1:Enable)
+ */
+#define EF_CONF_TRUNCATE_REUSE  ( 0 )
+
+/**
+ *  Number of sectors of the constant zero buffer eEF_fseek() writes to clear the
+ *  data of a file extended past its end, when the drive does not implement the
+ *  CTRL_WRITE_ZEROES command. The missing clusters are linked as one contiguous
+ *  run whenever possible, so a larger buffer means fewer write commands. When
+ *  disabled, the extended data are left uninitialized. (0:Disable or 1 to 128)
+ */
+#define EF_CONF_SEEK_ZERO_FILL  ( 8 )
+
 /* ************************************************************************* **
  *  Locale and Namespace Configurations
  * ************************************************************************* */
@@ -245,11 +371,23 @@
  *
  * EF_DEF_VFAT_BUFFER_STATIC  : static working buffer on the BSS.
  * EF_DEF_VFAT_BUFFER_STACK   : working buffer on the stack.
+ * EF_DEF_VFAT_BUFFER_POOL    : working buffer checked out of a pool on the BSS
+ *                              for the duration of each operation, and set to the
+ *                              calling task with eEFPortTaskBufferSet().
  *
  *  When use stack for the working buffer, take care on stack overflow.
+ *  The static working buffer cannot be used with EF_CONF_FS_LOCK.
  */
 #define EF_CONF_VFAT_BUFFER  ( EF_DEF_VFAT_BUFFER_STATIC )
 
+/**
+ *  Number of LFN working buffers in the pool (EF_DEF_VFAT_BUFFER_POOL).
+ *  It is the number of tasks which can run a name operation at the same time,
+ *  on any volume. An operation fails with EF_RET_NOT_ENOUGH_CORE when the pool
+ *  is empty.
+ */
+#define EF_CONF_VFAT_BUFFER_POOL_NB  ( 2 )
+
 /**
  *  This option switches the character encoding on the API when LFN is enabled.
  *
@@ -286,6 +424,22 @@
  */
 #define EF_CONF_RELATIVE_PATH   ( 2 )
 
+/**
+ *  This option sets the size (in TCHAR, terminator included) of the current
+ *  directory path cache held by each volume when EF_CONF_RELATIVE_PATH == 2.
+ *  eEF_chdir() updates the cached path with the segments it follows and
+ *  eEF_getcwd() returns a copy of it.
+ *
+ *  0: Disable the cache, eEF_getcwd() walks the ".." entries on every call.
+ */
+#define EF_CONF_CWD_CACHE_SIZE  ( 64 )
+
+/**
+ *  This option sets the maximum directory depth recorded in the current
+ *  directory path cache. Deeper paths are not cached.
+ */
+#define EF_CONF_CWD_CACHE_DEPTH ( 8 )
+
 /* ************************************************************************* **
  *  Drive/Volume Configurations
  * ************************************************************************* */
@@ -427,11 +581,18 @@
  *  0:  Disable file lock function. To avoid volume corruption, application program
  *      should avoid illegal open, remove and rename to the open objects.
  *  >0: Enable file lock function. The value defines how many files/sub-directories
- *      can be opened simultaneously under file lock control. Note that the file
- *      lock control is independent of re-entrancy.
+ *      can be opened simultaneously on each volume under file lock control (1 to 65535).
+ *      Note that the file lock control is independent of re-entrancy.
  */
 #define EF_CONF_FILE_LOCK   ( 0 )
 
+/**
+ *  Number of slots of the hash index of the file lock table of each volume.
+ *  It must be a power of 2 greater than EF_CONF_FILE_LOCK, twice EF_CONF_FILE_LOCK
+ *  or more keeps the probe sequences short.
+ */
+#define EF_CONF_FILE_LOCK_HASH_SIZE ( 64 )
+
 /* #include <somertos.h>  // O/S definitions */
 /**
  *  The option EF_CONF_FS_LOCK switches the re-entrancy (thread safe) of the eFAT
@@ -448,6 +609,33 @@
  */
 #define EF_CONF_FS_LOCK ( 0 )
 
+/**
+ *  The option EF_CONF_FS_LOCK_SHARED switches the volume lock to a reader-writer
+ *  lock when EF_CONF_FS_LOCK is enabled. Read-only operations, eEF_fread() on a
+ *  file not opened for writing, eEF_stat() and eEF_dirread(), take the volume
+ *  lock shared and run concurrently. Every other operation takes it exclusive.
+ *  Shared holders serialize on a second sync object of the volume while they
+ *  use the filesystem window.
+ *
+ *   0: Exclusive volume lock only.
+ *   1: Reader-writer volume lock. eEFPortSyncObjectTakeShared() and
+ *      eEFPortSyncObjectGiveShared() must be provided by the system port.
+ */
+#define EF_CONF_FS_LOCK_SHARED  ( 0 )
+
+/**
+ *  The option EF_CONF_FS_LOCK_TRANSFER_RELEASE releases the volume lock while
+ *  eEF_fread() and eEF_fwrite() transfer whole sectors between the volume and
+ *  the user buffer. The sector run is resolved under the lock and the lock is
+ *  taken back before the file and volume metadata are updated. The disk driver
+ *  must accept requests from several tasks at the same time. eEF_umount() waits
+ *  for the running transfers, yielding with eEFPortTaskYield().
+ *
+ *   0: Keep the volume locked during data transfers.
+ *   1: Release the volume lock during whole sector data transfers.
+ */
+#define EF_CONF_FS_LOCK_TRANSFER_RELEASE  ( 0 )
+
 /** The EF_CONF_TIMEOUT defines timeout period in unit of time tick.
  *  The EF_SYNC_t defines O/S dependent sync object type. e.g. HANDLE, ID, OS_EVENT*,
  *  SemaphoreHandle_t and etc. A header file for O/S definitions needs to be
@@ -455,6 +643,53 @@
  */
 #define EF_CONF_TIMEOUT ( 1000 )
 
+/**
+ *  The option EF_CONF_PORT_SYSTEM selects the system port providing the sync objects
+ *  and the critical sections. The sources of the other ports compile to nothing.
+ *
+ *  EF_DEF_PORT_SYSTEM_BARE:  No RTOS, sync objects are plain flags (ef_port_system.c).
+ *  EF_DEF_PORT_SYSTEM_POSIX: POSIX threads mutexes, or reader-writer locks when
+ *                            EF_CONF_FS_LOCK_SHARED is enabled (ef_port_systemPosix.c).
+ *                            EF_CONF_TIMEOUT is given in milliseconds.
+ */
+#define EF_CONF_PORT_SYSTEM ( EF_DEF_PORT_SYSTEM_BARE )
+
+/**
+ *  The option EF_CONF_PORT_SYNC_STATS switches the recording of the sync objects
+ *  metrics by the POSIX threads system port: number of grants, contentions and
+ *  timeouts, wait time and hold time. They are read with eEFPortSyncStatsGet().
+ *  (0:Disable or 1:Enable)
+ */
+#define EF_CONF_PORT_SYNC_STATS ( 0 )
+
+/**
+ *  The option EF_CONF_PORT_MEM_WORD switches the memory functions of the port
+ *  (copy, set and compare) to word at a time loops. Bytes are handled one by one
+ *  up to the first word boundary and after the last one. Buffers whose
+ *  misalignments differ are copied and compared byte by byte. The words are
+ *  accessed at aligned addresses only. (0:Byte loops or 1:Word loops)
+ */
+#define EF_CONF_PORT_MEM_WORD   ( 0 )
+
+/**
+ *  The option EF_CONF_PORT_MEM_DMA defines the smallest copy, in bytes, handed
+ *  to the DMA engine registered with eEFPortMemDmaRegister(). The copy falls
+ *  back to the CPU when no engine is registered or it refuses the copy.
+ *  0 disables the hook.
+ */
+#define EF_CONF_PORT_MEM_DMA    ( 0 )
+
+/**
+ *  The option EF_CONF_PORT_NATIVE_LE selects how the little-endian fields of the
+ *  FAT structures are loaded and stored by ef_port_load_store.c.
+ *
+ *  0: Byte by byte, for any core.
+ *  1: Native unaligned accesses, for little-endian cores supporting them.
+ *  2: Native accesses when the compiler reports such a core (x86, ARMv7-M and
+ *     later, AArch64, RISC-V), else byte by byte.
+ */
+#define EF_CONF_PORT_NATIVE_LE  ( 0 )
+
 /* ***************************************************************************************************************** */
 #ifdef __cplusplus
 }
@@ -41,6 +41,14 @@
 /* Local constant macros ------------------------------------------------------------------------------------------- */
 /* Local function macros ------------------------------------------------------------------------------------------- */
 /* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
+
+#if ( 0 != EF_CONF_PORT_MEM_DMA )
+/**
+ *  @brief  Pointer to a DMA Engine Copy Function (returns once the copy is done, EF_RET_OK, or refused)
+ */
+typedef ef_return_et (xMemCopyDma)( const void * pvSrc, void * pvDst, ef_u32_t u32BytesNb );
+#endif
+
 /* Local variables ------------------------------------------------------------------------------------------------- */
 /* Public variables ------------------------------------------------------------------------------------------------ */
 /* Local function prototypes---------------------------------------------------------------------------------------- */
@@ -52,7 +60,7 @@
  *
  *  @param  pvBufferA   Pointer to the data buffer A
  *  @param  pvBufferB   Pointer to the data buffer B
- *  @param  u32Count    Directory table to clear
+ *  @param  u32Count    Number of bytes to compare
  *
  *  @return Operation result
  *  @retval EF_RET_OK  Success (equal)
@@ -66,7 +74,9 @@ ef_return_et eEFPortMemCompare (
 );
 
 /**
- *  @brief  Copy memory byte by byte
+ *  @brief  Copy memory
+ *
+ *  Copies of EF_CONF_PORT_MEM_DMA bytes or more are first handed to eEFPortMemCopyDma().
  *
  *  @param  pvSrc       Pointer to the source data
  *  @param  pvDst       Pointer to the destination data
@@ -83,6 +93,41 @@ ef_return_et eEFPortMemCopy (
   ef_u32_t      u32BytesNb
 );
 
+#if ( 0 != EF_CONF_PORT_MEM_DMA )
+/**
+ *  @brief  Register the copy function of the DMA engine
+ *
+ *  The function returns once the copy is done, caches included. The buffers do not overlap and have any alignment,
+ *  it refuses the copies it cannot do.
+ *
+ *  @param  pxCopy  Pointer to the copy function (0: none, the CPU does all the copies)
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK Success
+ */
+ef_return_et eEFPortMemDmaRegister (
+  xMemCopyDma * pxCopy
+);
+
+/**
+ *  @brief  Copy memory with the DMA engine registered by eEFPortMemDmaRegister()
+ *
+ *  @param  pvSrc       Pointer to the source data
+ *  @param  pvDst       Pointer to the destination data
+ *  @param  u32BytesNb  Number of bytes to transfer
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK           Success
+ *  @retval EF_RET_NOT_ENABLED  No engine is registered, the CPU does the copy
+ *  @retval EF_RET_ERROR        The engine refused the copy, the CPU does it
+ */
+ef_return_et eEFPortMemCopyDma (
+  const void  * pvSrc,
+  void        * pvDst,
+  ef_u32_t      u32BytesNb
+);
+#endif
+
 /**
  *  @brief  Set memory to zero
  *
@@ -43,11 +43,48 @@
 //  typedef  SemaphoreHandle_t  EF_SYNC_t;
 /* CMSIS-RTOS */
 //  typedef  osMutexDef_t EF_SYNC_t;
+#if ( EF_DEF_PORT_SYSTEM_POSIX == EF_CONF_PORT_SYSTEM )
+/* POSIX THREADS */
+/**
+ *  Object for synchronisation (defined in ef_port_systemPosix.c)
+ */
+typedef  struct ef_port_sync_struct * EF_SYNC_t;
+
+/**
+ *  @brief  Sync object metrics structure (ef_port_sync_stats_st)
+ *
+ *  Times are given in microseconds. The shared hold time is the time during which
+ *  at least one shared grant was held.
+ */
+typedef struct ef_port_sync_stats_struct {
+  ef_u32_t  u32TakeNb;          /**< Number of exclusive grants */
+  ef_u32_t  u32TakeSharedNb;    /**< Number of shared grants */
+  ef_u32_t  u32ContentionNb;    /**< Number of requests that had to wait */
+  ef_u32_t  u32TimeoutNb;       /**< Number of requests that timed out */
+  ef_u64_t  u64WaitTotal;       /**< Total time waited by the requests */
+  ef_u32_t  u32WaitMax;         /**< Longest wait of a request */
+  ef_u64_t  u64HoldTotal;       /**< Total time the exclusive grant was held */
+  ef_u32_t  u32HoldMax;         /**< Longest hold of the exclusive grant */
+  ef_u64_t  u64HoldSharedTotal; /**< Total time shared grants were held */
+  ef_u32_t  u32HoldSharedMax;   /**< Longest period shared grants were held */
+} ef_port_sync_stats_st;
+#else
 /* DEFAULT NO RTOS */
 /**
  *  Object for synchronisation
  */
 typedef  ef_u08_t* EF_SYNC_t;
+#endif
+
+/**
+ *  Number of sync objects, one volume lock and one filesystem window lock per volume
+ */
+#define EF_PORT_SYNC_OBJECTS_NB       ( 2 * EF_CONF_VOLUMES_NB )
+
+/**
+ *  Identifier given to eEFPortSyncObjectCreate() for the filesystem window lock of a volume
+ */
+#define EF_PORT_SYNC_WINDOW_ID( u8Volume )  ( EF_CONF_VOLUMES_NB + ( u8Volume ) )
 
   /* Public functions prototypes---------------------------------------------- */
 
@@ -126,6 +163,137 @@ ef_return_et eEFPortSyncObjectGive (
   EF_SYNC_t xSyncObject
 );
 
+/**
+ *  @brief  Request Shared Grant to Access the Volume
+ *          This function is called on entering read-only file functions when
+ *          EF_CONF_FS_LOCK_SHARED is enabled. Several shared grants can be held
+ *          at the same time, none while the exclusive grant is held.
+ *
+ *  @param  xSyncObject  Sync object to wait
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK         Success
+ *  @retval EF_RET_SYS_ERROR  An error occurred
+ *  @retval EF_RET_ASSERT     Assertion failed
+ */
+ef_return_et eEFPortSyncObjectTakeShared (
+  EF_SYNC_t xSyncObject
+);
+
+/**
+ *  @brief  Release Shared Grant to Access the Volume
+ *          This function is called on leaving read-only file functions when
+ *          EF_CONF_FS_LOCK_SHARED is enabled.
+ *
+ *  @param  xSyncObject  Sync object to be signaled
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK         Success
+ *  @retval EF_RET_SYS_ERROR  An error occurred
+ *  @retval EF_RET_ASSERT     Assertion failed
+ */
+ef_return_et eEFPortSyncObjectGiveShared (
+  EF_SYNC_t xSyncObject
+);
+
+/**
+ *  @brief  Enter a short critical section
+ *          This function protects data shared by all the volumes, such as the
+ *          pool of LFN working buffers, against the other tasks.
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK         Success
+ *  @retval EF_RET_SYS_ERROR  An error occurred
+ */
+ef_return_et eEFPortCriticalSectionEnter (
+  void
+);
+
+/**
+ *  @brief  Leave a short critical section entered with eEFPortCriticalSectionEnter()
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK         Success
+ *  @retval EF_RET_SYS_ERROR  An error occurred
+ */
+ef_return_et eEFPortCriticalSectionExit (
+  void
+);
+
+/**
+ *  @brief  Let the other tasks run before the calling task goes on
+ *          This function is called by eEF_umount() while it waits for the data
+ *          transfers running with the volume lock released (EF_CONF_FS_LOCK_TRANSFER_RELEASE).
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK         Success
+ *  @retval EF_RET_SYS_ERROR  An error occurred
+ */
+ef_return_et eEFPortTaskYield (
+  void
+);
+
+/**
+ *  @brief  Set the working buffer of the calling task
+ *          This function is called when an operation checks an LFN working buffer
+ *          out of the pool (EF_DEF_VFAT_BUFFER_POOL), and with a null pointer when
+ *          the operation gives it back. Each task keeps its own buffer.
+ *
+ *  @param  pvBuffer  Pointer to the working buffer, 0 to clear it
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK         Success
+ *  @retval EF_RET_SYS_ERROR  An error occurred
+ */
+ef_return_et eEFPortTaskBufferSet (
+  void  * pvBuffer
+);
+
+/**
+ *  @brief  Get the working buffer set by the calling task with eEFPortTaskBufferSet()
+ *
+ *  @param  ppvBuffer Pointer to the working buffer, 0 if none is set
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK         Success
+ *  @retval EF_RET_SYS_ERROR  An error occurred
+ *  @retval EF_RET_ASSERT     Assertion failed
+ */
+ef_return_et eEFPortTaskBufferGet (
+  void  **  ppvBuffer
+);
+
+#if ( EF_DEF_PORT_SYSTEM_POSIX == EF_CONF_PORT_SYSTEM )
+/**
+ *  @brief  Get the metrics of a sync object
+ *
+ *  @param  u8SyncId  Sync object identifier given to eEFPortSyncObjectCreate() (volume or EF_PORT_SYNC_WINDOW_ID())
+ *  @param  pxStats   Pointer to the structure receiving the metrics
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK                 Success
+ *  @retval EF_RET_INVALID_PARAMETER  The identifier is out of range
+ *  @retval EF_RET_ASSERT             Assertion failed
+ */
+ef_return_et eEFPortSyncStatsGet (
+  ef_u08_t                u8SyncId,
+  ef_port_sync_stats_st * pxStats
+);
+
+/**
+ *  @brief  Reset the metrics of a sync object
+ *
+ *  @param  u8SyncId  Sync object identifier given to eEFPortSyncObjectCreate() (volume or EF_PORT_SYNC_WINDOW_ID())
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK                 Success
+ *  @retval EF_RET_INVALID_PARAMETER  The identifier is out of range
+ */
+ef_return_et eEFPortSyncStatsReset (
+  ef_u08_t  u8SyncId
+);
+#endif
+
 //#endif
 
 /**
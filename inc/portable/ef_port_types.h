@@ -45,6 +45,7 @@ extern "C" {
   typedef uint16_t      ef_u16_t;   /**< 16-bit unsigned integer */
   typedef uint32_t      ef_u32_t;   /**< 32-bit unsigned integer */
   typedef uint64_t      ef_u64_t;   /**< 64-bit unsigned integer */
+  typedef uintptr_t     ef_uptr_t;  /**< unsigned integer holding a pointer */
   typedef bool          ef_bool_t;  /**< boolean type */
   #define EF_BOOL_TRUE  ( 1 )       /**< boolean TRUE value */
   #define EF_BOOL_FALSE ( 0 )       /**< boolean FALSE value */
@@ -52,6 +53,7 @@ extern "C" {
   typedef unsigned char   ef_u08_t;  /**<  8-bit unsigned integer */
   typedef unsigned short  ef_u16_t;  /**< 16-bit unsigned integer */
   typedef unsigned long   ef_u32_t;  /**< 32-bit unsigned integer */
+  typedef unsigned long   ef_uptr_t; /**< unsigned integer holding a pointer */
 #endif
 
 
@@ -62,6 +62,12 @@
 #define EF_FILE_MODIFIED  ( 0x40 )  /**< File has been modified */
 #define EF_FILE_WIN_DIRTY ( 0x80 )  /**< ef_file_st.buf[] needs to be written-back */
 
+/* Non-blocking operation in progress on a file (ef_file_st.u8NbState) */
+#define EF_FILE_NB_IDLE   ( 0 )     /**< No non-blocking operation */
+#define EF_FILE_NB_READ   ( 1 )     /**< eEF_fread_nb() in progress */
+#define EF_FILE_NB_WRITE  ( 2 )     /**< eEF_fwrite_nb() in progress */
+#define EF_FILE_NB_SYNC   ( 3 )     /**< eEF_fsync_nb() in progress */
+
 #define EF_FS_WIN_DIRTY   ( 0x01 )  /**< disk access window needs to be written-back */
 
 /* File attribute bits for directory entry (ef_file_info_st.u8Attrib) */
@@ -111,10 +117,70 @@
 #define EF_DIR_REPLACEMENT_CHAR  ( 0x05 )  /**< Replacement of the character collides with EF_DIR_DELETED_MASK */
 
 /* Re-entrancy related */
-#if ( ( 0 != EF_CONF_FS_LOCK ) && ( 0 != EF_CONF_VFAT ) )
-  #error Static LFN work area cannot be used at thread-safe configuration
+#if ( ( 0 != EF_CONF_FS_LOCK ) && ( 0 != EF_CONF_VFAT ) && ( EF_DEF_VFAT_BUFFER_STATIC == EF_CONF_VFAT_BUFFER ) )
+  #error Static LFN work area cannot be used at thread-safe configuration, use stack or pool LFN work area
+#endif
+
+#if ( ( 0 != EF_CONF_FS_LOCK_SHARED ) && ( 0 != EF_CONF_VFAT ) && ( EF_DEF_VFAT_BUFFER_STACK == EF_CONF_VFAT_BUFFER ) )
+  #error Stack LFN work area is set per volume, it cannot be used by the shared lock holders, use pool LFN work area
 #endif
 
+#if ( ( 0 != EF_CONF_VFAT ) && ( EF_DEF_VFAT_BUFFER_POOL == EF_CONF_VFAT_BUFFER ) && ( 1 > EF_CONF_VFAT_BUFFER_POOL_NB ) )
+  #error Wrong EF_CONF_VFAT_BUFFER_POOL_NB setting
+#endif
+
+#if ( 0 != EF_CONF_FILE_LOCK )
+  #if ( EF_CONF_FILE_LOCK > 0xFFFF )
+    #error Wrong EF_CONF_FILE_LOCK configuration
+  #endif
+  #if ( 0 != ( EF_CONF_FILE_LOCK_HASH_SIZE & ( EF_CONF_FILE_LOCK_HASH_SIZE - 1 ) ) ) || ( EF_CONF_FILE_LOCK_HASH_SIZE <= EF_CONF_FILE_LOCK )
+    #error EF_CONF_FILE_LOCK_HASH_SIZE must be a power of 2 greater than EF_CONF_FILE_LOCK
+  #endif
+#endif
+
+#if ( 0 != EF_CONF_BOUNDED_WRITE ) && ( 3 > EF_CONF_BOUNDED_WRITE_CMDS )
+  #error Wrong EF_CONF_BOUNDED_WRITE_CMDS setting
+#endif
+
+#if ( 255 < EF_CONF_ALLOC_GROUPS )
+  #error Wrong EF_CONF_ALLOC_GROUPS setting
+#endif
+
+#if ( 255 < EF_CONF_FREE_EXTENTS )
+  #error Wrong EF_CONF_FREE_EXTENTS setting
+#endif
+
+#if ( 0 != EF_CONF_LAZY_FREE_COUNT ) && ( 1 != EF_CONF_LAZY_FREE_COUNT )
+  #error Wrong EF_CONF_LAZY_FREE_COUNT setting
+#endif
+
+#if ( 0 != EF_CONF_ALLOC_SNAPSHOT ) && ( 1 != EF_CONF_ALLOC_SNAPSHOT )
+  #error Wrong EF_CONF_ALLOC_SNAPSHOT setting
+#endif
+
+#if ( 0 != EF_CONF_FILE_RESERVE ) && ( 1 != EF_CONF_FILE_RESERVE )
+  #error Wrong EF_CONF_FILE_RESERVE setting
+#endif
+
+#if ( 0 != EF_CONF_TRUNCATE_REUSE ) && ( 1 != EF_CONF_TRUNCATE_REUSE )
+  #error Wrong EF_CONF_TRUNCATE_REUSE setting
+#endif
+
+#if ( 0 != EF_CONF_TRUNCATE_REUSE ) && ( 0 == EF_CONF_FILE_RESERVE )
+  #error EF_CONF_TRUNCATE_REUSE needs EF_CONF_FILE_RESERVE
+#endif
+
+#if ( 128 < EF_CONF_SEEK_ZERO_FILL )
+  #error Wrong EF_CONF_SEEK_ZERO_FILL setting
+#endif
+
+#if ( 0 != EF_CONF_PORT_MEM_WORD ) && ( 1 != EF_CONF_PORT_MEM_WORD )
+  #error Wrong EF_CONF_PORT_MEM_WORD setting
+#endif
+
+#if ( 2 < EF_CONF_PORT_NATIVE_LE )
+  #error Wrong EF_CONF_PORT_NATIVE_LE setting
+#endif
 
 /* Definitions of sector size */
 #if ( EF_CONF_SECTOR_SIZE != 512 ) && ( EF_CONF_SECTOR_SIZE != 1024 ) && ( EF_CONF_SECTOR_SIZE != 2048 ) && ( EF_CONF_SECTOR_SIZE != 4096 )
@@ -191,6 +257,24 @@
 /* Public function macros -------------------------------------------------------------------------------------------------------------- */
 /* Public typedefs, structures, unions and enums --------------------------------------------------------------------------------------- */
 
+/**
+ *  @brief  File lock table entry structure (ef_flock_st)
+ */
+typedef struct ef_flock_struct {
+  ef_u32_t    u32Clst;    /**< Object ID 1, containing directory (0:root) */
+  ef_u32_t    u32Offset;  /**< Object ID 2, offset in the directory */
+  ef_u16_t    u16Cnt;     /**< Object open counter, 0:none, 0x01..0xFF:read mode open count, 0x100:write mode */
+  ef_u16_t    u16Next;    /**< Next free entry index origin from 1 (0:end of the free list) */
+} ef_flock_st;
+
+/**
+ *  @brief  Free extent structure (ef_free_extent_st)
+ */
+typedef struct ef_free_extent_struct {
+  ef_u32_t    u32Start;   /**< First free cluster of the extent */
+  ef_u32_t    u32Length;  /**< Number of free clusters of the extent */
+} ef_free_extent_st;
+
 /**
  *  @brief  Filesystem object structure (ef_fs_st)
  */
@@ -214,15 +298,54 @@ typedef struct ef_fs_strut {
   EF_SYNC_t   xSyncObject;            /**< Identifier of sync object */
 #else
   EF_SYNC_t   xSyncObject;            /**< Identifier of sync object */
+#endif
+#if ( 0 != EF_CONF_FS_LOCK_SHARED )
+  EF_SYNC_t   xWindowSyncObject;      /**< Identifier of sync object of the window for shared lock holders */
+#endif
+#if ( 0 != EF_CONF_FS_LOCK ) && ( 0 != EF_CONF_FS_LOCK_TRANSFER_RELEASE )
+  ef_u16_t    u16TransfersNb;         /**< Number of data transfers running with the volume lock released */
 #endif
   ef_u32_t    u32ClstLast;            /**< Last allocated cluster */
   ef_u32_t    u32ClstFreeNb;          /**< Number of free clusters */
+#if ( 1 < EF_CONF_ALLOC_GROUPS )
+  ef_u08_t    u8AllocGroup;           /**< Allocation group where the next new cluster chain starts */
+  ef_bool_t   bClstLastHint;          /**< The next new cluster chain starts after u32ClstLast, not in a group */
+#endif
+#if ( 0 != EF_CONF_FREE_EXTENTS )
+  ef_free_extent_st xFreeExt[ EF_CONF_FREE_EXTENTS ]; /**< Largest free extents, sorted by increasing length */
+  ef_u08_t    u8FreeExtNb;            /**< Number of free extents in xFreeExt */
+  ef_bool_t   bFreeExtValid;          /**< The free extents index has been built */
+  ef_bool_t   bFreeExtPartial;        /**< Free runs may be missing from the index, too small to be kept */
+#if ( 0 != EF_CONF_ALLOC_SNAPSHOT )
+  ef_bool_t   bFreeExtRestored;       /**< The index has been taken back from the snapshot, not checked in the FAT */
+#endif
+#endif
+#if ( 0 != EF_CONF_LAZY_FREE_COUNT )
+  ef_u32_t    u32FreeScanNext;        /**< Next FAT entry of the free cluster count (0:no count in progress) */
+  ef_u32_t    u32FreeScanNb;          /**< Number of free clusters found below u32FreeScanNext */
+#endif
+#if ( 0 != EF_CONF_ALLOC_SNAPSHOT )
+  ef_u32_t    u32SnapGeneration;      /**< Generation number of the last allocation snapshot of the volume */
+  ef_bool_t   bSnapSave;              /**< The allocation snapshot is saved on unmounting */
+#endif
 #if ( 0 != EF_CONF_RELATIVE_PATH )
   ef_u32_t    u32DirClstCurrent;      /**< Current directory start cluster (0:root) */
 #else
   ef_u32_t    u32DirClstCurrent;      /**< Current directory start cluster (0:root) */
 #endif
-  ef_u08_t    u8FsInfoFlags;          /**< FSINFO flags (b7:disabled, b0:dirty) only for FAT32 */
+#if ( 2 == EF_CONF_RELATIVE_PATH ) && ( 0 != EF_CONF_CWD_CACHE_SIZE )
+  TCHAR       xCwdPath[ EF_CONF_CWD_CACHE_SIZE ];         /**< Cached current directory path (no drive prefix) */
+  ef_u32_t    u32CwdClst[ EF_CONF_CWD_CACHE_DEPTH ];      /**< Cached start clusters of the current directory and its ancestors */
+  ef_u08_t    u8CwdDepth;             /**< Number of clusters in u32CwdClst[] */
+  ef_bool_t   bCwdValid;              /**< Current directory path cache is valid */
+  ef_bool_t   bCwdFollow;             /**< eEF_chdir() records the path it follows in the cache */
+#endif
+#if ( 0 != EF_CONF_FILE_LOCK )
+  ef_flock_st xLock[ EF_CONF_FILE_LOCK ];                 /**< Open objects lock table */
+  ef_u16_t    u16LockHash[ EF_CONF_FILE_LOCK_HASH_SIZE ]; /**< Open addressed index of xLock[], entry index origin from 1 (0:empty) */
+  ef_u16_t    u16LockFree;            /**< First free entry of xLock[], index origin from 1 (0:table full) */
+#endif
+  ef_u08_t    u8FsInfoFlags;         /**< FSINFO flags (b7:disabled, b0:dirty) only for FAT32 */
   ef_u32_t    u32FatEntriesNb;        /**< Number of FAT entries (number of clusters + 2) */
   ef_u32_t    u32FatSize;             /**< Size of an FAT [sectors] */
   ef_lba_t    xVolBase;               /**< Volume base sector */
@@ -246,7 +369,7 @@ typedef struct ef_object_struct {
   ef_u16_t    u16MountId;   /**< Hosting volume mount ID */
   ef_u08_t    u8Attrib;     /**< Object attribute */
   ef_u32_t    u32ClstStart; /**< Object data start cluster (0:no cluster or root directory) */
-  ef_u32_t    u32LockId;    /**< File lock ID origin from 1 (index of file semaphore table Files[]) */
+  ef_u32_t    u32LockId;    /**< File lock ID origin from 1 (index in the lock table of the hosting volume) */
 } ef_object_st;
 
 /**
@@ -264,6 +387,30 @@ typedef struct ef_file_struct {
   ef_u08_t      u8Window[ EF_CONF_SECTOR_SIZE ];  /**< File private data read/write window */
   ef_lba_t      xDirSector;                       /**< Sector number containing the directory entry */
   ef_u08_t    * pu8DirPtr;                        /**< Pointer to the directory entry in the window[] */
+#if ( 0 != EF_CONF_FILE_RESERVE )
+  ef_bool_t     bReserved;                        /**< Clusters are linked past the end of the file by eEF_reserve() */
+#endif
+#if ( 0 != EF_CONF_NON_BLOCKING )
+  ef_u08_t      u8NbState;                        /**< Non-blocking operation in progress (EF_FILE_NB_xxx) */
+  ef_bool_t     bNbTransfer;                      /**< A started drive transfer is not completed yet */
+  ef_u32_t      u32NbDone;                        /**< Bytes transferred by the operation since its first call */
+  ef_u32_t      u32NbSectors;                     /**< Number of sectors of the transfer in progress (0: none) */
+  ef_lba_t      xNbSector;                        /**< First sector of the transfer in progress */
+#endif
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+  ef_u32_t      u32PoolSize;                      /**< Clusters kept linked ahead of the writes (0:bounded mode off) */
+  ef_u32_t      u32PoolNext;                      /**< First cluster of the pool, the pool is contiguous */
+  ef_u32_t      u32PoolNb;                        /**< Number of clusters in the pool */
+  ef_u32_t      u32PoolPrev;                      /**< Cluster linked to the pool (0:pool starts the chain) */
+  ef_u32_t      u32BwWritesNb;                    /**< Number of eEF_fwrite() calls */
+  ef_u32_t      u32BwShortNb;                     /**< Number of eEF_fwrite() calls stopped by the limits */
+  ef_u32_t      u32BwCmdsMax;                     /**< Maximum drive commands observed in an eEF_fwrite() call */
+#endif
+#if ( 0 != EF_CONF_FILE_DIGEST )
+  xFileDigest * pxDigest;                         /**< Digest function of the bytes read (0:none) */
+  void        * pvDigestContext;                  /**< Context given to the digest function */
+  ef_u32_t      u32DigestOffset;                  /**< File offset following the last byte digested */
+#endif
 } ef_file_st;
 
 /**
@@ -0,0 +1,184 @@
+/**
+ * ********************************************************************************************************************
+ *  @file     ef_prv_cwd.h
+ *  @ingroup  group_eFAT_Private
+ *  @author   ChaN
+ *  @author   Emmanuel AMADIO
+ *  @version  V0.1
+ *  @brief    Private current directory path resolution and cache.
+ *
+ * ********************************************************************************************************************
+ *  eFAT - embedded FAT Filesystem module
+ * ********************************************************************************************************************
+ *
+ *  Copyright (C) 2021, Amadio Emmanuel, all right reserved.
+ *  Copyright (C) 2019, ChaN, all right reserved.
+ *
+ *  eFAT module is an open source software. Redistribution and use of eFAT in source and binary forms, with or without
+ *  modification, are permitted provided that the following condition is met:
+ *
+ *  Redistributions of source code must retain the above copyright notice, this condition and the following disclaimer.
+ *
+ *  This software is provided by the copyright holders and contributors "AS IS" and any warranties related to this
+ *  software are DISCLAIMED.
+ *  The copyright owners or contributors be NOT LIABLE for any damages caused by use of this software.
+ * ********************************************************************************************************************
+ */
+
+/* START OF FILE *************************************************************************************************** */
+#ifndef EFAT_PRIVATE_CWD_H
+#define EFAT_PRIVATE_CWD_H
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+/* ***************************************************************************************************************** */
+
+/* Includes -------------------------------------------------------------------------------------------------------- */
+#include <efat.h>
+#include "ef_prv_def.h"
+
+/* Local constant macros ------------------------------------------------------------------------------------------- */
+/* Local function macros ------------------------------------------------------------------------------------------- */
+/* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
+/* Local variables ------------------------------------------------------------------------------------------------- */
+/* Public variables ------------------------------------------------------------------------------------------------ */
+/* Local function prototypes---------------------------------------------------------------------------------------- */
+/* Local functions ------------------------------------------------------------------------------------------------- */
+/* Public functions ------------------------------------------------------------------------------------------------ */
+
+/**
+ *  @brief  Resolve the current directory path by following the ".." entries up to the root directory
+ *
+ *  The path is stacked from the end of the buffer, on success it starts at pxString[ *pu32Index ] and ends at
+ *  pxString[ u32Size - 1 ] (not terminated).
+ *  The LFN working buffer of the volume must be set by the caller.
+ *
+ *  @param  pxFS          Pointer to the Filesystem object
+ *  @param  pxString      Pointer to the buffer receiving the path
+ *  @param  u32Size       Size of the buffer (in TCHAR)
+ *  @param  pu32Index     Pointer to the index of the first path character
+ *  @param  pu32Clusters  Pointer to the array receiving the first u32ClustersNb directory clusters, current first
+ *                        (can be 0)
+ *  @param  u32ClustersNb Size of the array of directory clusters
+ *  @param  pu32Depth     Pointer to the number of directories in the path, even above u32ClustersNb (can be 0)
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK               Success
+ *  @retval EF_RET_NOT_ENOUGH_CORE  The buffer is too small
+ *  @retval EF_RET_INT_ERR          The directory chain is broken
+ *  @retval EF_RET_ERROR            An error occurred
+ */
+ef_return_et eEFPrvCwdResolve (
+  ef_fs_st  * pxFS,
+  TCHAR     * pxString,
+  ef_u32_t    u32Size,
+  ef_u32_t  * pu32Index,
+  ef_u32_t  * pu32Clusters,
+  ef_u32_t    u32ClustersNb,
+  ef_u32_t  * pu32Depth
+);
+
+/**
+ *  @brief  Start recording the path followed by eEF_chdir() in the current directory path cache of the volume
+ *
+ *  An absolute path, or a relative path from the root directory, starts from the root path. A relative path from a
+ *  sub-directory goes on from the cached path, and is not recorded when the cache is invalid.
+ *
+ *  @param  pxFS    Pointer to the Filesystem object
+ *  @param  pxPath  Pointer to the path to follow, without drive prefix
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       Success
+ */
+ef_return_et eEFPrvCwdCacheStart (
+  ef_fs_st    * pxFS,
+  const TCHAR * pxPath
+);
+
+/**
+ *  @brief  Record a segment found by eEFPrvPathFollow() in the current directory path cache of the volume
+ *
+ *  The dot entry is skipped, the dot dot entry drops the last name and another entry adds its name as read from the
+ *  directory. The cache is invalidated when the path does not fit in it.
+ *  The LFN working buffer of the volume must be set by the caller, the window holds the entry again on return.
+ *
+ *  @param  pxDir   Pointer to the directory object, on the entry found
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       Success
+ *  @retval EF_RET_DISK_ERR The sector of the entry could not be read back
+ */
+ef_return_et eEFPrvCwdCacheFollow (
+  ef_directory_st * pxDir
+);
+
+/**
+ *  @brief  Stop recording the path followed by eEF_chdir()
+ *
+ *  @param  pxFS    Pointer to the Filesystem object
+ *  @param  eResult Result of eEF_chdir(), the cache is invalidated on failure
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       Success
+ */
+ef_return_et eEFPrvCwdCacheEnd (
+  ef_fs_st      * pxFS,
+  ef_return_et    eResult
+);
+
+/**
+ *  @brief  Invalidate the current directory path cache of the volume
+ *
+ *  @param  pxFS  Pointer to the Filesystem object
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       Success
+ */
+ef_return_et eEFPrvCwdCacheInvalidate (
+  ef_fs_st  * pxFS
+);
+
+/**
+ *  @brief  Invalidate the current directory path cache if a directory of the path is modified
+ *
+ *  @param  pxFS        Pointer to the Filesystem object
+ *  @param  u32Cluster  Start cluster of the renamed or removed directory
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       Success
+ */
+ef_return_et eEFPrvCwdCacheCheck (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Cluster
+);
+
+/**
+ *  @brief  Copy the current directory path of the volume
+ *
+ *  The path is copied from the cache when it is valid. Else the ".." entries are followed once, directly in the
+ *  given buffer, and the cache is refreshed with the result when it fits in.
+ *  The LFN working buffer of the volume must be set by the caller.
+ *
+ *  @param  pxFS      Pointer to the Filesystem object
+ *  @param  pxString  Pointer to the buffer receiving the terminated path
+ *  @param  u32Size   Size of the buffer (in TCHAR, not 0)
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK               Success
+ *  @retval EF_RET_NOT_ENOUGH_CORE  The buffer is too small
+ *  @retval EF_RET_INT_ERR          The directory chain is broken
+ *  @retval EF_RET_ERROR            An error occurred
+ */
+ef_return_et eEFPrvCwdCopy (
+  ef_fs_st  * pxFS,
+  TCHAR     * pxString,
+  ef_u32_t    u32Size
+);
+
+/* ***************************************************************************************************************** */
+#ifdef __cplusplus
+}
+#endif
+#endif /* EFAT_PRIVATE_CWD_H */
+/* END OF FILE ***************************************************************************************************** */
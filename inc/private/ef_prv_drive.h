@@ -106,6 +106,71 @@ ef_return_et  eEFPrvDriveWrite (
   ef_u32_t          u32Count
 );
 
+#if ( 0 != EF_CONF_NON_BLOCKING )
+/**
+ *  @brief  Start reading Sector(s) without waiting for the end of the transfer
+ *
+ *  A drive without pxReadStart or pxTransferStatus function does a blocking read.
+ *
+ *  @param  u8PhyDrvNb  8 bits unsigned integer identifying the physical drive number
+ *  @param  pu8Buffer   Pointer to the data buffer to store read data (valid until the transfer ends)
+ *  @param  xSector     Start sector in LBA
+ *  @param  u32Count    Number of sectors to read
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       The sectors have been read (blocking read)
+ *  @retval EF_RET_PENDING  The transfer is started, eEFPrvDriveTransferPoll() gives its end
+ *  @retval EF_RET_LOCKED   The drive has not ended another started transfer yet
+ *  @retval EF_RET_DISK_ERR The transfer failed
+ */
+ef_return_et  eEFPrvDriveReadStart (
+  ef_u08_t    u8PhyDrvNb,
+  ef_u08_t  * pu8Buffer,
+  ef_lba_t    xSector,
+  ef_u32_t    u32Count
+);
+
+/**
+ *  @brief  Start writing Sector(s) without waiting for the end of the transfer
+ *
+ *  A drive without pxWriteStart or pxTransferStatus function does a blocking write.
+ *
+ *  @param  u8PhyDrvNb  8 bits unsigned integer identifying the physical drive number
+ *  @param  pu8Buffer   Pointer to the data to be written (valid until the transfer ends)
+ *  @param  xSector     Start sector in LBA
+ *  @param  u32Count    Number of sectors to write
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       The sectors have been written (blocking write)
+ *  @retval EF_RET_PENDING  The transfer is started, eEFPrvDriveTransferPoll() gives its end
+ *  @retval EF_RET_LOCKED   The drive has not ended another started transfer yet
+ *  @retval EF_RET_DISK_ERR The transfer failed
+ */
+ef_return_et  eEFPrvDriveWriteStart (
+  ef_u08_t          u8PhyDrvNb,
+  const ef_u08_t  * pu8Buffer,
+  ef_lba_t          xSector,
+  ef_u32_t          u32Count
+);
+
+/**
+ *  @brief  Poll the transfer started on a drive
+ *
+ *  Blocking requests on the drive wait for the end of the started transfer first, its result is then kept
+ *  until this function collects it.
+ *
+ *  @param  u8PhyDrvNb  8 bits unsigned integer identifying the physical drive number
+ *
+ *  @return Transfer result
+ *  @retval EF_RET_OK       The transfer ended successfully (or there is no started transfer)
+ *  @retval EF_RET_PENDING  The transfer is still running
+ *  @retval Others          The transfer failed (drive result)
+ */
+ef_return_et  eEFPrvDriveTransferPoll (
+  ef_u08_t  u8PhyDrvNb
+);
+#endif
+
 /**
  *  @brief  Miscellaneous Functions
  *
@@ -126,6 +191,24 @@ ef_return_et  eEFPrvDriveIOCtrl (
   void    * pvBuffer
 );
 
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+/**
+ *  @brief  Get the number of blocking commands (read, write and control) issued to a drive
+ *
+ *  The counter wraps around, the commands of an operation are given by the difference of two readings.
+ *
+ *  @param  u8PhyDrvNb    8 bits unsigned integer identifying the physical drive number
+ *  @param  pu32Commands  Pointer to the number of commands
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK   Success
+ */
+ef_return_et  eEFPrvDriveCommandsGet (
+  ef_u08_t    u8PhyDrvNb,
+  ef_u32_t  * pu32Commands
+);
+#endif
+
 /**
  *  @brief  Register the functions needed to access a Drive
  *
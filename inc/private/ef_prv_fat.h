@@ -141,6 +141,9 @@ ef_return_et eEFPrvFATSet (
 /**
  *  @brief  FAT handling - Remove a cluster chain
  *
+ *  The FAT16/FAT32 entries are cleared directly in the window, a FAT sector at a time, and the number of free clusters
+ *  is updated once for the whole chain.
+ *
  *  @param  xObject         Pointer to Corresponding object
  *  @param  u32Cluster      Cluster to remove a chain from
  *  @param  u32ClusterPrev  Previous cluster of clst (0 if entire chain)
@@ -277,6 +280,107 @@ ef_return_et eEFPrvFATChainStretch (
   ef_u32_t     * pu32Cluster
 );
 
+/**
+ *  @brief  FAT handling - Extend a chain with contiguous clusters
+ *
+ *  The clusters are linked in order and the last one is marked as end of chain.
+ *
+ *  @param  pxObject    Pointer to Corresponding object
+ *  @param  u32Cluster  Last cluster of the chain (0:create a new chain)
+ *  @param  bAdjacent   Only use the free clusters directly following u32Cluster (*pu32Count can be reduced to 0)
+ *  @param  pu32Count   Pointer to the number of clusters to link, updated with the number of clusters linked
+ *  @param  pu32Cluster Pointer to the first linked cluster number
+ *  @return Function completion
+ *  @retval EF_RET_OK                   Succeeded
+ *  @retval EF_RET_DENIED               There is no contiguous free run of *pu32Count clusters
+ *  @retval EF_RET_INT_ERR              Assertion failed or FAT access failed
+ */
+ef_return_et eEFPrvFATChainExtend (
+  ef_object_st  * pxObject,
+  ef_u32_t        u32Cluster,
+  ef_bool_t       bAdjacent,
+  ef_u32_t      * pu32Count,
+  ef_u32_t      * pu32Cluster
+);
+
+/**
+ *  @brief  FAT handling - Link a run of free clusters at the end of a chain
+ *
+ *  The clusters must be free, they are linked in order and the last one is marked as end of chain.
+ *
+ *  @param  pxFS            Pointer to the file system object
+ *  @param  u32Cluster      Last cluster of the chain (0:the run is a new chain)
+ *  @param  u32ClusterFirst First cluster of the run
+ *  @param  u32Count        Number of clusters of the run
+ *  @return Function completion
+ *  @retval EF_RET_OK                   Succeeded
+ *  @retval EF_RET_INT_ERR              FAT access failed
+ */
+ef_return_et eEFPrvFATChainLink (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Cluster,
+  ef_u32_t    u32ClusterFirst,
+  ef_u32_t    u32Count
+);
+
+#if ( 0 != EF_CONF_FREE_EXTENTS )
+/**
+ *  @brief  FAT handling - Build the free extents index of a volume
+ *
+ *  The whole FAT is read once, the largest runs of free clusters are kept and the number of free clusters is updated.
+ *
+ *  @param  pxFS  Pointer to the file system object
+ *  @return Function completion
+ *  @retval EF_RET_OK                   Succeeded
+ *  @retval EF_RET_INT_ERR              FAT access failed
+ */
+ef_return_et eEFPrvFATFreeExtentsBuild (
+  ef_fs_st  * pxFS
+);
+#endif
+
+/**
+ *  @brief  FAT handling - Find the best fitting run of free clusters
+ *
+ *  The run following u32Cluster is preferred, else the smallest free extent large enough is taken.
+ *  The index is built if needed, and rebuilt once when it may miss free clusters. Without the index
+ *  (EF_CONF_FREE_EXTENTS 0), the FAT is scanned and the first run large enough is taken.
+ *
+ *  @param  pxFS        Pointer to the file system object
+ *  @param  u32Count    Number of contiguous clusters wanted
+ *  @param  u32Cluster  Last cluster of the chain to grow (0:none)
+ *  @param  pu32Cluster Pointer to the first cluster of the run
+ *  @return Function completion
+ *  @retval EF_RET_OK                   Succeeded
+ *  @retval EF_RET_DENIED               There is no contiguous free run of u32Count clusters
+ *  @retval EF_RET_INT_ERR              FAT access failed
+ */
+ef_return_et eEFPrvFATFreeExtentFind (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Count,
+  ef_u32_t    u32Cluster,
+  ef_u32_t  * pu32Cluster
+);
+
+#if ( 0 != EF_CONF_LAZY_FREE_COUNT )
+/**
+ *  @brief  FAT handling - Count the free clusters of a volume by slices
+ *
+ *  The count goes on from where the previous call stopped, the clusters allocated and freed meanwhile are followed.
+ *  When the end of the FAT is reached, the number of free clusters of the volume becomes known.
+ *
+ *  @param  pxFS          Pointer to the file system object
+ *  @param  u32SectorsNb  Maximum number of FAT sectors counted by this call (0:up to the end of the FAT)
+ *  @return Function completion
+ *  @retval EF_RET_OK                   Succeeded
+ *  @retval EF_RET_INT_ERR              FAT access failed
+ */
+ef_return_et eEFPrvFATFreeCountScan (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32SectorsNb
+);
+#endif
+
 /* ***************************************************************************************************************** */
 #ifdef __cplusplus
 }
@@ -98,6 +98,278 @@ ef_return_et eEFPrvFileWindowUpdate (
   ef_lba_t      xSector
 );
 
+/**
+ *  @brief  Update the file structure cluster number for next read access (on cluster crossing)
+ *
+ *  @param  pxFile  Pointer to the file object
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK     Success
+ *  @retval EF_RET_ERROR  An error occurred
+ *  @retval EF_RET_ASSERT Assertion failed
+ */
+ef_return_et eEFPrvFileReadClusterNbUpdate (
+  ef_file_st  * pxFile
+);
+
+/**
+ *  @brief  Update the file structure cluster number for next write access (on cluster crossing)
+ *
+ *  @param  pxFile  Pointer to the file object
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK     Success
+ *  @retval EF_RET_ERROR  An error occurred
+ *  @retval EF_RET_ASSERT Assertion failed
+ */
+ef_return_et eEFPrvFileWriteClusterNbUpdate (
+  ef_file_st  * pxFile
+);
+
+/**
+ *  @brief  Switch the window of the file to a sector without reading it (sector past the end of the file)
+ *
+ *  @param  pxFile  Pointer to the file object
+ *  @param  pxFS    Pointer to the Filesystem object
+ *  @param  xSector Sector number to set in the window
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       Success
+ *  @retval EF_RET_DISK_ERR The dirty window write-back failed
+ */
+ef_return_et eEFPrvFileWindowSet (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ef_lba_t      xSector
+);
+
+/**
+ *  @brief  Take the next step of a read at the file offset
+ *
+ *  Not on a sector boundary, the bytes up to the end of the sector are taken from the window. On a sector boundary,
+ *  the whole sectors run following the file offset is resolved up to the cluster boundary, the caller transfers it.
+ *  No bytes and no run mean that less than a sector remains, eEFPrvFileReadEnd() reads it through the window.
+ *  The volume must be locked by the caller.
+ *
+ *  @param  pxFile          Pointer to the file object
+ *  @param  pxFS            Pointer to the Filesystem object
+ *  @param  pu8DataBuffer   Pointer to the buffer receiving the data at the file offset
+ *  @param  u32BytesToRead  Number of bytes remaining to read (within the file size)
+ *  @param  pxSector        Pointer to the first sector of the run
+ *  @param  pu32SectorsNb   Pointer to the number of sectors of the run (0: none)
+ *  @param  pu32Bytes       Pointer to the number of bytes taken from the window (0: none)
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       Success
+ *  @retval EF_RET_INT_ERR  Following the cluster chain or copying the bytes failed
+ */
+ef_return_et eEFPrvFileReadStep (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ef_u08_t    * pu8DataBuffer,
+  ef_u32_t      u32BytesToRead,
+  ef_lba_t    * pxSector,
+  ef_u32_t    * pu32SectorsNb,
+  ef_u32_t    * pu32Bytes
+);
+
+/**
+ *  @brief  End a read: load the sector of the file offset in the window and take the bytes of a last partial sector
+ *
+ *  The window is invalidated when the steps failed, it is left as is while a transfer is in progress.
+ *  The volume must be locked by the caller.
+ *
+ *  @param  pxFile          Pointer to the file object
+ *  @param  pxFS            Pointer to the Filesystem object
+ *  @param  pu8DataBuffer   Pointer to the buffer receiving the data at the file offset
+ *  @param  u32BytesToRead  Number of bytes remaining to read (less than a sector)
+ *  @param  xSector         Sector of the file offset
+ *  @param  eResult         Result of the steps
+ *  @param  pu32Bytes       Pointer to the number of bytes taken from the window
+ *
+ *  @return Operation result (eResult if it is not a success)
+ *  @retval EF_RET_OK       Success
+ *  @retval EF_RET_DISK_ERR The window update failed
+ *  @retval EF_RET_INT_ERR  Copying the bytes failed
+ */
+ef_return_et eEFPrvFileReadEnd (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ef_u08_t    * pu8DataBuffer,
+  ef_u32_t      u32BytesToRead,
+  ef_lba_t      xSector,
+  ef_return_et  eResult,
+  ef_u32_t    * pu32Bytes
+);
+
+/**
+ *  @brief  Take the next step of a write at the file offset
+ *
+ *  Not on a sector boundary, the bytes up to the end of the sector are put in the window. On a sector boundary, the
+ *  current cluster is followed or allocated and the whole sectors run following the file offset is resolved up to
+ *  the cluster boundary, the caller transfers it. No bytes and no run mean that less than a sector remains,
+ *  eEFPrvFileWriteEnd() writes it through the window.
+ *  The volume must be locked by the caller.
+ *
+ *  @param  pxFile          Pointer to the file object
+ *  @param  pxFS            Pointer to the Filesystem object
+ *  @param  pu8DataBuffer   Pointer to the data to write at the file offset
+ *  @param  u32BytesToWrite Number of bytes remaining to write
+ *  @param  pxSector        Pointer to the first sector of the run
+ *  @param  pu32SectorsNb   Pointer to the number of sectors of the run (0: none)
+ *  @param  pu32Bytes       Pointer to the number of bytes put in the window (0: none)
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       Success
+ *  @retval EF_RET_INT_ERR  Following or stretching the cluster chain or copying the bytes failed
+ */
+ef_return_et eEFPrvFileWriteStep (
+  ef_file_st      * pxFile,
+  ef_fs_st        * pxFS,
+  const ef_u08_t  * pu8DataBuffer,
+  ef_u32_t          u32BytesToWrite,
+  ef_lba_t        * pxSector,
+  ef_u32_t        * pu32SectorsNb,
+  ef_u32_t        * pu32Bytes
+);
+
+/**
+ *  @brief  End a write: switch the window to the sector of the file offset and put the bytes of a last partial
+ *          sector in it, then update the file size
+ *
+ *  The window is invalidated when the steps failed, it is left as is while a transfer is in progress.
+ *  The volume must be locked by the caller.
+ *
+ *  @param  pxFile          Pointer to the file object
+ *  @param  pxFS            Pointer to the Filesystem object
+ *  @param  pu8DataBuffer   Pointer to the data to write at the file offset
+ *  @param  u32BytesToWrite Number of bytes remaining to write (less than a sector)
+ *  @param  xSector         Sector of the file offset
+ *  @param  eResult         Result of the steps
+ *  @param  pu32Bytes       Pointer to the number of bytes put in the window
+ *
+ *  @return Operation result (eResult if it is not a success)
+ *  @retval EF_RET_OK       Success
+ *  @retval EF_RET_DISK_ERR The window update failed
+ *  @retval EF_RET_INT_ERR  Copying the bytes failed
+ */
+ef_return_et eEFPrvFileWriteEnd (
+  ef_file_st      * pxFile,
+  ef_fs_st        * pxFS,
+  const ef_u08_t  * pu8DataBuffer,
+  ef_u32_t          u32BytesToWrite,
+  ef_lba_t          xSector,
+  ef_return_et      eResult,
+  ef_u32_t        * pu32Bytes
+);
+
+#if ( 0 != EF_CONF_NON_BLOCKING )
+/**
+ *  @brief  Abandon the non-blocking operation in progress on a file
+ *
+ *  The transfer started by the operation is waited for and its result is collected, so that the drive is free for
+ *  the transfers of other files and no longer writes into the buffer of the operation. The bytes of the operation
+ *  not reported by its previous calls are not accounted for.
+ *  The volume is locked by the function.
+ *
+ *  @param  pxFile  Pointer to the file object
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK             Success (or no operation in progress)
+ *  @retval EF_RET_INVALID_OBJECT The file object is not valid
+ */
+ef_return_et eEFPrvFileNbCancel (
+  ef_file_st  * pxFile
+);
+#endif
+
+/**
+ *  @brief  Find the last cluster of the chain of a file and count the clusters
+ *
+ *  The chain is followed from the current cluster when the file offset is not null.
+ *  The volume must be locked by the caller.
+ *
+ *  @param  pxFile        Pointer to the file object
+ *  @param  pxFS          Pointer to the file system object
+ *  @param  pu32Cluster   Pointer to the last cluster of the chain (0:no chain)
+ *  @param  pu32Count     Pointer to the number of clusters of the chain
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       Success
+ *  @retval EF_RET_INT_ERR  Following the chain failed
+ */
+ef_return_et eEFPrvFileChainLast (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ef_u32_t    * pu32Cluster,
+  ef_u32_t    * pu32Count
+);
+
+/**
+ *  @brief  Release the clusters reserved past the end of a file by eEF_reserve()
+ *
+ *  The volume must be locked by the caller.
+ *
+ *  @param  pxFile  Pointer to the file object
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       Success
+ *  @retval EF_RET_INT_ERR  Following or removing the cluster chain failed
+ */
+ef_return_et eEFPrvFileReserveRelease (
+  ef_file_st  * pxFile
+);
+
+/**
+ *  Clusters are reserved past the end of the file by eEF_reserve()
+ */
+#if ( 0 != EF_CONF_FILE_RESERVE )
+#define EF_FILE_RESERVED( pxFile )  ( (pxFile)->bReserved )
+#else
+#define EF_FILE_RESERVED( pxFile )  ( EF_BOOL_FALSE )
+#endif
+
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+/**
+ *  @brief  Release the cluster pool of a file in bounded latency write mode
+ *
+ *  The volume must be locked by the caller.
+ *
+ *  @param  pxFile  Pointer to the file object
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       Success
+ *  @retval EF_RET_INT_ERR  Removing the pool from the cluster chain failed
+ */
+ef_return_et eEFPrvFileBoundedRelease (
+  ef_file_st  * pxFile
+);
+#endif
+
+#if ( 0 != EF_CONF_FILE_DIGEST )
+/**
+ *  @brief  Update the digest of a file with bytes transferred at its file offset
+ *
+ *  Only the bytes following the digest offset are digested, and only if the transfer does not leave a gap after it.
+ *
+ *  @param  pxFile    Pointer to the file object, its offset is the one of the first byte
+ *  @param  pu8Data   Pointer to the bytes transferred
+ *  @param  u32Size   Number of bytes transferred
+ */
+void vEFPrvFileDigest (
+  ef_file_st      * pxFile,
+  const ef_u08_t  * pu8Data,
+  ef_u32_t          u32Size
+);
+
+/**
+ *  Update the digest of a file with bytes transferred at its file offset
+ */
+#define EF_FILE_DIGEST( pxFile, pu8Data, u32Size )  vEFPrvFileDigest( (pxFile), (pu8Data), (u32Size) )
+#else
+#define EF_FILE_DIGEST( pxFile, pu8Data, u32Size )
+#endif
+
 /* ***************************************************************************************************************** */
 #ifdef __cplusplus
 }
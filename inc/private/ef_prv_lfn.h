@@ -83,6 +83,16 @@
     #define EF_LFN_BUFFER_FREE()
     #define LEAVE_MKFS(res)  return res
 
+  /* LFN enabled with working buffer checked out of the pool */
+  #elif ( EF_DEF_VFAT_BUFFER_POOL == EF_CONF_VFAT_BUFFER )
+
+    /* LFN working buffer of the calling task */
+    #define EF_LFN_BUFFER_DEFINE                  ucs2_t * pxLFNPoolBuffer = 0;
+    #define EF_LFN_BUFFER_SET( pxFS )             eEFPrvLFNBufferTake( &pxLFNPoolBuffer )
+    #define EF_LFN_BUFFER_GET( pxFS, ppxBuffer )  eEFPrvLFNBufferTaskGet( ppxBuffer )
+    #define EF_LFN_BUFFER_FREE()                  ( (void) eEFPrvLFNBufferGive( pxLFNPoolBuffer ) )
+    #define LEAVE_MKFS(res)  return res
+
   /* LFN enabled with dynamic working buffer on the heap */
   #elif ( EF_DEF_VFAT_BUFFER_DYNAMIC == EF_CONF_VFAT_BUFFER )
 
@@ -117,13 +127,55 @@
 /* Public functions ------------------------------------------------------------------------------------------------ */
 
 ef_return_et eEFPrvLFNBufferPtrGet (
-  ef_fs_st      *   pxFS,
-  const ucs2_t  **  ppxBuffer
+  ef_fs_st  *   pxFS,
+  ucs2_t    **  ppxBuffer
 );
 
 ef_return_et eEFPrvLFNBufferPtrSet (
-  ef_fs_st      * pxFS,
-  const ucs2_t  * pxBuffer
+  ef_fs_st  * pxFS,
+  ucs2_t    * pxBuffer
+);
+
+/**
+ *  @brief  Check out an LFN working buffer from the pool and set it as the working buffer of the calling task
+ *
+ *  @param  ppxBuffer Pointer to the checked out buffer pointer to return
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK               Success
+ *  @retval EF_RET_NOT_ENOUGH_CORE  The pool is empty
+ *  @retval EF_RET_SYS_ERROR        The buffer could not be set to the calling task
+ *  @retval EF_RET_ASSERT           Assertion failed
+ */
+ef_return_et eEFPrvLFNBufferTake (
+  ucs2_t  **  ppxBuffer
+);
+
+/**
+ *  @brief  Get the LFN working buffer checked out by the calling task
+ *
+ *  @param  ppxBuffer Pointer to the buffer pointer to return
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK     Success
+ *  @retval EF_RET_ERROR  The calling task has no buffer checked out
+ *  @retval EF_RET_ASSERT Assertion failed
+ */
+ef_return_et eEFPrvLFNBufferTaskGet (
+  ucs2_t  **  ppxBuffer
+);
+
+/**
+ *  @brief  Give back an LFN working buffer to the pool and clear the working buffer of the calling task
+ *
+ *  @param  pxBuffer  Pointer to the buffer checked out by eEFPrvLFNBufferTake() (0: nothing to do)
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK     Success
+ *  @retval EF_RET_ERROR  The buffer does not belong to the pool
+ */
+ef_return_et eEFPrvLFNBufferGive (
+  ucs2_t  * pxBuffer
 );
 
 /**
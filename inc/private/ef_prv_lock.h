@@ -95,6 +95,111 @@ ef_return_et eEFPrvFSUnlock (
 ef_return_et eEFPrvFSUnlockForce (
   ef_fs_st  * pxFS
 );
+
+/**
+ *  @brief  Request shared grant to access the volume (exclusive grant if EF_CONF_FS_LOCK_SHARED is disabled)
+ *
+ *  @param  pxFS  Pointer to the Filesystem object
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK  Success
+ *  @retval EF_RET_ERROR    An error occurred
+ *  @retval EF_RET_ASSERT   Assertion failed
+ */
+ef_return_et eEFPrvFSLockShared (
+  ef_fs_st  * pxFS
+);
+
+/**
+ *  @brief  Conditionnal Release shared grant to access the volume
+ *
+ *  @param  pxFS    Pointer to the Filesystem object
+ *  @param  eResult File function return code
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK  Success
+ *  @retval EF_RET_ERROR    An error occurred
+ *  @retval EF_RET_ASSERT   Assertion failed
+ */
+ef_return_et eEFPrvFSUnlockShared (
+  ef_fs_st    * pxFS,
+  ef_return_et  eResult
+);
+
+/**
+ *  @brief  Request grant to use the filesystem window while holding the shared grant
+ *
+ *  @param  pxFS  Pointer to the Filesystem object
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK  Success
+ *  @retval EF_RET_TIMEOUT  The grant could not be obtained
+ *  @retval EF_RET_ASSERT   Assertion failed
+ */
+ef_return_et eEFPrvFSWindowLock (
+  ef_fs_st  * pxFS
+);
+
+/**
+ *  @brief  Release grant to use the filesystem window
+ *
+ *  @param  pxFS  Pointer to the Filesystem object
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK  Success
+ *  @retval EF_RET_ERROR    An error occurred
+ *  @retval EF_RET_ASSERT   Assertion failed
+ */
+ef_return_et eEFPrvFSWindowUnlock (
+  ef_fs_st  * pxFS
+);
+
+/**
+ *  @brief  Release the grant to access the volume before a data transfer (EF_CONF_FS_LOCK_TRANSFER_RELEASE)
+ *
+ *  @param  pxFS    Pointer to the Filesystem object
+ *  @param  bShared The grant held is the shared grant
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK  Success
+ *  @retval EF_RET_ERROR    An error occurred
+ *  @retval EF_RET_ASSERT   Assertion failed
+ */
+ef_return_et eEFPrvFSTransferUnlock (
+  ef_fs_st  * pxFS,
+  ef_bool_t   bShared
+);
+
+/**
+ *  @brief  Request back the grant to access the volume after a data transfer (EF_CONF_FS_LOCK_TRANSFER_RELEASE)
+ *
+ *  @param  pxFS    Pointer to the Filesystem object
+ *  @param  bShared The grant to request is the shared grant
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK  Success
+ *  @retval EF_RET_TIMEOUT  The grant could not be obtained
+ *  @retval EF_RET_ASSERT   Assertion failed
+ */
+ef_return_et eEFPrvFSTransferLock (
+  ef_fs_st  * pxFS,
+  ef_bool_t   bShared
+);
+
+/**
+ *  @brief  Wait for the data transfers running with the volume lock released (EF_CONF_FS_LOCK_TRANSFER_RELEASE)
+ *          The caller holds the grant to access the volume: it is given away while the transfers end.
+ *
+ *  @param  pxFS  Pointer to the Filesystem object
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK  Success
+ *  @retval EF_RET_TIMEOUT  The grant could not be obtained back
+ *  @retval EF_RET_ASSERT   Assertion failed
+ */
+ef_return_et eEFPrvFSTransferWait (
+  ef_fs_st  * pxFS
+);
 /*-----------------------------------------------------------------------*/
 /* File lock control functions                                           */
 /*-----------------------------------------------------------------------*/
@@ -117,12 +222,14 @@ ef_return_et eEFPrvLockCheck ( /* v */
 /**
  *  @brief  Check if an entry is available for a new object
  *
+ *  @param  pxFS  Pointer to the Filesystem object
+ *
  *  @return Function completion
- *  @retval 1 Succeeded
- *  @retval 0 Fail
+ *  @retval EF_RET_OK                   Succeeded
+ *  @retval EF_RET_LOCKED               The lock table of the volume is full
  */
 ef_return_et eEFPrvLockEnq (
-  void
+  ef_fs_st  * pxFS
 );
 
 /**
@@ -143,14 +250,16 @@ ef_return_et eEFPrvLockInc (
 /**
  *  @brief  Decrement object open counter
  *
- *  @param  uiIndex Semaphore index (1..)
+ *  @param  pxFS      Pointer to the Filesystem object hosting the object
+ *  @param  u32Index  Semaphore index (1..)
  *
  *  @return Function completion
  *  @retval EF_RET_OK                   Succeeded
  *  @retval EF_RET_INT_ERR              Assertion failed
  */
 ef_return_et eEFPrvLockDec (
-  ef_u32_t  u32Index
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Index
 );
 
 /**
@@ -0,0 +1,95 @@
+/**
+ * ********************************************************************************************************************
+ *  @file     ef_prv_volume_snapshot.h
+ *  @ingroup  group_eFAT_Private
+ *  @author   ChaN
+ *  @author   Emmanuel AMADIO
+ *  @version  V0.1
+ *  @brief    Private allocation snapshot of a volume, kept across unmount and mount.
+ *
+ * ********************************************************************************************************************
+ *  eFAT - embedded FAT Filesystem module
+ * ********************************************************************************************************************
+ *
+ *  Copyright (C) 2021, Amadio Emmanuel, all right reserved.
+ *  Copyright (C) 2019, ChaN, all right reserved.
+ *
+ *  eFAT module is an open source software. Redistribution and use of eFAT in source and binary forms, with or without
+ *  modification, are permitted provided that the following condition is met:
+ *
+ *  Redistributions of source code must retain the above copyright notice, this condition and the following disclaimer.
+ *
+ *  This software is provided by the copyright holders and contributors "AS IS" and any warranties related to this
+ *  software are DISCLAIMED.
+ *  The copyright owners or contributors be NOT LIABLE for any damages caused by use of this software.
+ * ********************************************************************************************************************
+ */
+
+/* START OF FILE *************************************************************************************************** */
+#ifndef EFAT_PRIVATE_VOLUME_SNAPSHOT_H
+#define EFAT_PRIVATE_VOLUME_SNAPSHOT_H
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+/* ***************************************************************************************************************** */
+
+/* Includes -------------------------------------------------------------------------------------------------------- */
+#include <efat.h>
+#include "ef_prv_def.h"
+
+/* Local constant macros ------------------------------------------------------------------------------------------- */
+/* Local function macros ------------------------------------------------------------------------------------------- */
+/* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
+/* Local variables ------------------------------------------------------------------------------------------------- */
+/* Public variables ------------------------------------------------------------------------------------------------ */
+/* Local function prototypes---------------------------------------------------------------------------------------- */
+/* Local functions ------------------------------------------------------------------------------------------------- */
+/* Public functions ------------------------------------------------------------------------------------------------ */
+
+#if ( 0 != EF_CONF_ALLOC_SNAPSHOT )
+/**
+ *  @brief  Take back the allocation snapshot of a FAT32 volume being mounted
+ *
+ *  The snapshot is taken only when it is complete, no writable mount has followed it and it still matches the FSINFO
+ *  fields. The number of free clusters, the last allocated cluster and the free extents index are then known without
+ *  scanning the FAT. The free extents are not trusted: their clusters are checked in the FAT before the first
+ *  allocation from the index.
+ *  On a writable volume, the next generation number is stored on the storage as the one of the last mount, before any
+ *  change of the FAT can reach it: the snapshot does not match it any more.
+ *
+ *  @param  pxFS        Pointer to the file system object
+ *  @param  u8ReadOnly  Non zero: Read Only
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK         Succeeded, with or without a snapshot
+ *  @retval EF_RET_DISK_ERR   A hard error occurred in the low level disk I/O layer
+ */
+ef_return_et eEFPrvVolumeSnapshotLoad (
+  ef_fs_st  * pxFS,
+  ef_u08_t    u8ReadOnly
+);
+
+/**
+ *  @brief  Save the allocation snapshot of a volume being unmounted
+ *
+ *  Nothing is saved for a read only or non FAT32 volume, or when the number of free clusters is not known.
+ *  The volume must be locked by the caller.
+ *
+ *  @param  pxFS  Pointer to the file system object
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK         Succeeded
+ *  @retval EF_RET_DISK_ERR   A hard error occurred in the low level disk I/O layer
+ */
+ef_return_et eEFPrvVolumeSnapshotSave (
+  ef_fs_st  * pxFS
+);
+#endif
+
+/* ***************************************************************************************************************** */
+#ifdef __cplusplus
+}
+#endif
+#endif /* EFAT_PRIVATE_VOLUME_SNAPSHOT_H */
+/* END OF FILE ***************************************************************************************************** */
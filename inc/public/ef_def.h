@@ -73,20 +73,22 @@
  *
  */
 
-/* Format options (2nd argument of f_mkfs) */
+/* Format options (u8Format of the eEF_mkfs() parameters) */
 #define FM_FAT    0x01
 #define FM_FAT32  0x02
 #define FM_ANY    0x07
 #define FM_SFD    0x08
+#define FM_QUICK  0x10  /**< Quick format, the data area is trimmed instead of being written */
 
 /* Command code for disk_ioctrl function */
 
 /* Generic command (Used by eFAT) */
 #define CTRL_SYNC         (  0 )  /**< Complete pending write process */
-#define GET_SECTOR_COUNT  (  1 )  /**< Get media size (needed at EF_USE_MKFS == 1) */
+#define GET_SECTOR_COUNT  (  1 )  /**< Get media size (needed at EF_CONF_USE_MKFS == 1) */
 #define GET_SECTOR_SIZE   (  2 )  /**< Get sector size (needed at EF_CONF_SS_MAX != EF_CONF_SS_MIN) */
-#define GET_BLOCK_SIZE    (  3 )  /**< Get erase block size (needed at EF_USE_MKFS == 1) */
+#define GET_BLOCK_SIZE    (  3 )  /**< Get erase block size (needed at EF_CONF_USE_MKFS == 1) */
 #define CTRL_TRIM         (  4 )  /**< Inform device that the data on the block of sectors is no longer used (needed at EF_CONF_USE_TRIM == 1) */
+#define CTRL_WRITE_ZEROES (  9 )  /**< Fill the block of sectors with zeroes (optional, a drive without it gets zeroed sectors written) */
 
 /* Generic command (Not used by eFAT) */
 #define CTRL_POWER        (  5 )  /**< Get/Set power status */
@@ -258,7 +260,8 @@ typedef enum {
   EF_RET_LFN_BUFFER_ERROR,      /**< (23) Cluster is empty */
   EF_RET_BUFFER_ERROR,      /**< (23) Cluster is empty */
   EF_RET_DIR_ENTRY_EXIST,      /**< (23) Directory entry found */
-  EF_RET_DIR_ENTRY_ABSENT      /**< (23) Directory entry missing */
+  EF_RET_DIR_ENTRY_ABSENT,     /**< (23) Directory entry missing */
+  EF_RET_PENDING              /**< Transfer in progress, call the non-blocking function again to continue */
 } ef_return_et;
 
 /* Local variables ------------------------------------------------------------------------------------------------- */
@@ -102,6 +102,22 @@ typedef struct ef_file_info_struct {
 #endif
 } ef_file_info_st;
 
+/**
+ *  @brief  Bounded latency write mode statistics structure (ef_fbounded_stats_st)
+ */
+typedef struct ef_fbounded_stats_struct {
+  ef_u32_t  u32WritesNb;      /**< Number of eEF_fwrite() calls in bounded mode */
+  ef_u32_t  u32ShortNb;       /**< Number of calls which wrote less than requested (commands limit or empty pool) */
+  ef_u32_t  u32CommandsMax;   /**< Maximum number of drive commands observed in a call */
+  ef_u32_t  u32CommandsLimit; /**< Maximum number of drive commands allowed in a call */
+  ef_u32_t  u32PoolNb;        /**< Number of clusters remaining in the pool */
+} ef_fbounded_stats_st;
+
+/**
+ *  @brief  Pointer to a File Digest Function, updating the digest context with the given bytes
+ */
+typedef void (xFileDigest)( void * pvContext, const ef_u08_t * pu8Data, ef_u32_t u32Size );
+
 /**
  *  @brief  Pointer to a Drive Initialization Function
  */
@@ -127,16 +143,41 @@ typedef ef_return_et (xDriveWrite)( const ef_u08_t * pu8Buffer, ef_lba_t xSector
  */
 typedef ef_return_et (xDriveCtrl)( ef_u08_t u8Cmd, void * pvBuffer);
 
+#if ( 0 != EF_CONF_NON_BLOCKING )
+/**
+ *  @brief  Pointer to a Drive Sector(s) Read Start Function (returns without waiting for the transfer end)
+ */
+typedef ef_return_et (xDriveReadStart)( ef_u08_t * pu8Buffer, ef_lba_t xSector, ef_u32_t u32Count );
+
+/**
+ *  @brief  Pointer to a Drive Sector(s) Write Start Function (returns without waiting for the transfer end)
+ */
+typedef ef_return_et (xDriveWriteStart)( const ef_u08_t * pu8Buffer, ef_lba_t xSector, ef_u32_t u32Count );
+
+/**
+ *  @brief  Pointer to a Drive Transfer Status Function (EF_RET_PENDING while the started transfer is running)
+ */
+typedef ef_return_et (xDriveTransferStatus)( void );
+#endif
+
 /**
  *  @brief  Disk IO Drivefunction pointers structure definition
+ *
+ *  The transfer start and status functions exist with EF_CONF_NON_BLOCKING, they are optional (0), they are used by
+ *  the non-blocking file functions.
  */
 typedef struct
 {
-  xDriveInitialize  *pxInitialize;  /**< Pointer to a function to Initialize Drive      */
-  xDriveStatus      *pxStatus;      /**< Pointer to a function to Get Disk Status       */
-  xDriveRead        *pxRead;        /**< Pointer to a function to Read Sector(s)        */
-  xDriveWrite       *pxWrite;       /**< Pointer to a function to Write Sector(s)       */
-  xDriveCtrl        *pxCtrl;        /**< Pointer to a function to I/O control operation */
+  xDriveInitialize      *pxInitialize;      /**< Pointer to a function to Initialize Drive                */
+  xDriveStatus          *pxStatus;          /**< Pointer to a function to Get Disk Status                 */
+  xDriveRead            *pxRead;            /**< Pointer to a function to Read Sector(s)                  */
+  xDriveWrite           *pxWrite;           /**< Pointer to a function to Write Sector(s)                 */
+  xDriveCtrl            *pxCtrl;            /**< Pointer to a function to I/O control operation           */
+#if ( 0 != EF_CONF_NON_BLOCKING )
+  xDriveReadStart       *pxReadStart;       /**< Pointer to a function to Start reading Sector(s)         */
+  xDriveWriteStart      *pxWriteStart;      /**< Pointer to a function to Start writing Sector(s)         */
+  xDriveTransferStatus  *pxTransferStatus;  /**< Pointer to a function to Get the started transfer status */
+#endif
 } ef_drive_functions_st;
 
 /* Local variables ------------------------------------------------------------------------------------------------- */
@@ -372,6 +413,9 @@ ef_return_et eEF_fwrite (
 /**
  *  @brief  Seek File Read/Write Pointer
  *
+ *  In write mode, seeking past the end of the file extends it: the missing clusters are linked as one contiguous run
+ *  when a free run is large enough, and the new data are cleared when EF_CONF_SEEK_ZERO_FILL is enabled.
+ *
  *  @param  pxFile    Pointer to the file object
  *  @param  u32Offset Offset in bytes from top of file
  *
@@ -464,6 +508,91 @@ ef_return_et eEF_fsync (
   EF_FILE  * pxFile
 );
 
+/**
+ *  @brief  Read File without waiting for the data transfers
+ *
+ *  Behaves as eEF_fread() but returns EF_RET_PENDING as soon as a whole sectors transfer is started by the drive.
+ *  The function must then be called again with the same parameters until it returns another code, the progress
+ *  is kept in the file object and *pu32BytesRead gives the bytes read since the first call.
+ *  The data buffer must stay valid and the file must not be used by other functions meanwhile.
+ *  eEF_fclose(), eEF_fseek() and eEF_truncate() abandon the operation, they wait for its started transfer first.
+ *  Partial sectors and cluster chain accesses are still done with blocking drive requests.
+ *
+ *  @param  pxFile          Pointer to the file object
+ *  @param  pvDataPtr       Pointer to data buffer
+ *  @param  u32BytesToRead  Number of bytes to read
+ *  @param  pu32BytesRead   Pointer to number of bytes read
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK                   Succeeded
+ *  @retval EF_RET_PENDING              A transfer is in progress, call again to continue
+ *  @retval EF_RET_DISK_ERR             A hard error occurred in the low level disk I/O layer
+ *  @retval EF_RET_INT_ERR              Assertion failed
+ *  @retval EF_RET_DENIED               Another non-blocking operation is in progress on the file
+ *  @retval EF_RET_INVALID_OBJECT       The file/directory object is invalid
+ *  @retval EF_RET_TIMEOUT              Could not get a grant to access the volume within defined period
+ */
+ef_return_et eEF_fread_nb (
+  EF_FILE   * pxFile,
+  void      * pvDataPtr,
+  ef_u32_t    u32BytesToRead,
+  ef_u32_t  * pu32BytesRead
+);
+
+/**
+ *  @brief  Write File without waiting for the data transfers
+ *
+ *  Behaves as eEF_fwrite() but returns EF_RET_PENDING as soon as a whole sectors transfer is started by the
+ *  drive. The function must then be called again with the same parameters until it returns another code, the
+ *  progress is kept in the file object and *pu32BytesWritten gives the bytes written since the first call.
+ *  The data buffer must stay valid and the file must not be used by other functions meanwhile.
+ *  eEF_fclose(), eEF_fseek() and eEF_truncate() abandon the operation, they wait for its started transfer first.
+ *  Partial sectors and cluster allocations are still done with blocking drive requests.
+ *
+ *  @param  pxFile            Pointer to the file object
+ *  @param  pvDataPtr         Pointer to the data to be written
+ *  @param  u32BytesToWrite   Number of bytes to write
+ *  @param  pu32BytesWritten  Pointer to number of bytes written
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK                   Succeeded
+ *  @retval EF_RET_PENDING              A transfer is in progress, call again to continue
+ *  @retval EF_RET_DISK_ERR             A hard error occurred in the low level disk I/O layer
+ *  @retval EF_RET_INT_ERR              Assertion failed
+ *  @retval EF_RET_DENIED               File not opened for writing, or another non-blocking operation is in
+ *                                      progress on the file
+ *  @retval EF_RET_INVALID_OBJECT       The file/directory object is invalid
+ *  @retval EF_RET_TIMEOUT              Could not get a grant to access the volume within defined period
+ */
+ef_return_et eEF_fwrite_nb (
+  EF_FILE     * pxFile,
+  const void  * pvDataPtr,
+  ef_u32_t      u32BytesToWrite,
+  ef_u32_t    * pu32BytesWritten
+);
+
+/**
+ *  @brief  Synchronize the File without waiting for the data window write-back
+ *
+ *  The cached data sector of the file is written back with a started transfer, EF_RET_PENDING is returned
+ *  until it completes. The directory entry and the filesystem are then synchronized as eEF_fsync() does.
+ *  eEF_fclose(), eEF_fseek() and eEF_truncate() abandon the operation, they wait for its started transfer first.
+ *
+ *  @param  pxFile  Pointer to the file object
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK                   Succeeded
+ *  @retval EF_RET_PENDING              A transfer is in progress, call again to continue
+ *  @retval EF_RET_DISK_ERR             A hard error occurred in the low level disk I/O layer
+ *  @retval EF_RET_DENIED               Another non-blocking operation is in progress on the file
+ *  @retval EF_RET_ERROR                The synchronization failed
+ *  @retval EF_RET_INVALID_OBJECT       The file/directory object is invalid
+ *  @retval EF_RET_TIMEOUT              Could not get a grant to access the volume within defined period
+ */
+ef_return_et eEF_fsync_nb (
+  EF_FILE  * pxFile
+);
+
 /**
  *  @brief  Create a Directory Object
  *
@@ -955,6 +1084,29 @@ ef_return_et eEF_getfree (
   ef_u32_t    * pu32ClstNb
 );
 
+/**
+ *  @brief  Count the free clusters of a volume by slices
+ *
+ *  When the number of free clusters is not known after mounting, each call counts a few more FAT sectors, so a
+ *  maintenance task can spread the FAT scan instead of the first eEF_getfree() doing it all. The clusters allocated
+ *  and freed between the calls are followed, and eEF_getfree() only counts the part of the FAT left.
+ *  Requires EF_CONF_LAZY_FREE_COUNT.
+ *
+ *  @param  pxPath        Logical drive number
+ *  @param  u32SectorsNb  Maximum number of FAT sectors read by this call (0:up to the end of the FAT)
+ *  @param  pu32ClstNb    Pointer to a variable to return number of free clusters, 0xFFFFFFFF while the count is not
+ *                        complete
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK                   Succeeded
+ *  @retval EF_RET_ERROR                The volume cannot be mounted or accessing the FAT failed
+ */
+ef_return_et eEF_getfree_slice (
+  const TCHAR * pxPath,
+  ef_u32_t      u32SectorsNb,
+  ef_u32_t    * pu32ClstNb
+);
+
 /**
  *  @brief  Get Volume Label
  *
@@ -1056,9 +1208,14 @@ ef_return_et eEF_label_set (
 /**
  *  @brief  Allocate a Contiguous Blocks to the File
  *
+ *  The missing clusters are taken from a single run of free clusters: the one following the end of the chain when it
+ *  is large enough, else the smallest one large enough (best fit), so the large runs are kept for the large files.
+ *  A file which is not empty grows from the end of its chain, the bytes past its former size are not initialized.
+ *
  *  @param  pxFile  Pointer to the file object
- *  @param  u32Size   File size to be expanded to
- *  @param  u8Opt   Operation u8Mode 0:Find and prepare or 1:Find and allocate
+ *  @param  u32Size   File size to be expanded to, larger than the current size
+ *  @param  u8Opt   Operation u8Mode 0:Find the run and make it the starting point of the next allocation
+ *                                  1:Find the run, link it to the file and set the file size
  *
  *  @return Function completion
  *  @retval EF_RET_OK                   Succeeded
@@ -1088,6 +1245,135 @@ ef_return_et eEF_expand (
   ef_u08_t    u8Opt
 );
 
+/**
+ *  @brief  Reserve a Contiguous Extent for the future appends of a File
+ *
+ *  The clusters needed to grow the file by u32Bytes are linked after the end of its cluster chain in one contiguous
+ *  run, the file size is not changed. The writes crossing into them follow the chain, so concurrent files growing
+ *  slowly do not interleave their clusters. The unused ones are released by eEF_fclose(), eEF_truncate() or with
+ *  u32Bytes 0.
+ *
+ *  @param  pxFile    Pointer to the file object (opened for writing)
+ *  @param  u32Bytes  Number of bytes to reserve after the end of the file (0:release the reservation)
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK                   Succeeded
+ *  @retval EF_RET_DISK_ERR             A hard error occurred in the low level disk I/O layer
+ *  @retval EF_RET_INT_ERR              Assertion failed
+ *  @retval EF_RET_DENIED               File not opened for writing, in bounded mode or no contiguous free clusters
+ *  @retval EF_RET_INVALID_OBJECT       The file/directory object is invalid
+ *  @retval EF_RET_TIMEOUT              Could not get a grant to access the volume within defined period
+ */
+ef_return_et eEF_reserve (
+  EF_FILE   * pxFile,
+  ef_u32_t    u32Bytes
+);
+
+/**
+ *  @brief  Set the bounded latency write mode of a File
+ *
+ *  A pool of u32PoolClusters contiguous clusters is linked after the end of the cluster chain, eEF_fwrite() takes
+ *  its cluster crossings from it without accessing the FAT. It then issues at most EF_CONF_BOUNDED_WRITE_CMDS
+ *  drive commands per call and writes less than requested when the limit or the end of the pool is reached.
+ *  eEF_fmaintain() must be called regularly out of the time critical path to refill the pool and to update the
+ *  directory entry. The remaining pool is released by eEF_fclose(), eEF_truncate() or with u32PoolClusters 0.
+ *  The mode is meant for files written sequentially at their end, seeking beyond the end is not supported.
+ *
+ *  @param  pxFile          Pointer to the file object (opened for writing)
+ *  @param  u32PoolClusters Number of clusters kept linked ahead of the writes (0:leave the bounded mode)
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK                   Succeeded
+ *  @retval EF_RET_DISK_ERR             A hard error occurred in the low level disk I/O layer
+ *  @retval EF_RET_INT_ERR              Assertion failed
+ *  @retval EF_RET_DENIED               File not opened for writing, reserved or no contiguous free clusters
+ *  @retval EF_RET_INVALID_OBJECT       The file/directory object is invalid
+ *  @retval EF_RET_TIMEOUT              Could not get a grant to access the volume within defined period
+ */
+ef_return_et eEF_fbounded (
+  EF_FILE   * pxFile,
+  ef_u32_t    u32PoolClusters
+);
+
+/**
+ *  @brief  Maintain a File in bounded latency write mode
+ *
+ *  Refills the cluster pool and synchronizes the file as eEF_fsync() does. The pool is extended in place while
+ *  the clusters following it are free, an empty pool is replaced by the first contiguous free run.
+ *
+ *  @param  pxFile  Pointer to the file object
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK                   Succeeded
+ *  @retval EF_RET_DISK_ERR             A hard error occurred in the low level disk I/O layer
+ *  @retval EF_RET_INT_ERR              Assertion failed
+ *  @retval EF_RET_DENIED               No contiguous free clusters for an empty pool
+ *  @retval EF_RET_ERROR                The synchronization failed
+ *  @retval EF_RET_INVALID_OBJECT       The file/directory object is invalid
+ *  @retval EF_RET_TIMEOUT              Could not get a grant to access the volume within defined period
+ */
+ef_return_et eEF_fmaintain (
+  EF_FILE   * pxFile
+);
+
+/**
+ *  @brief  Get the bounded latency write mode statistics of a File
+ *
+ *  @param  pxFile    Pointer to the file object
+ *  @param  pxStats   Pointer to the structure receiving the statistics
+ *  @param  bReset    Clear the statistics after reading them
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK                   Succeeded
+ *  @retval EF_RET_INVALID_OBJECT       The file/directory object is invalid
+ *  @retval EF_RET_TIMEOUT              Could not get a grant to access the volume within defined period
+ */
+ef_return_et eEF_fbounded_stats (
+  EF_FILE               * pxFile,
+  ef_fbounded_stats_st  * pxStats,
+  ef_bool_t               bReset
+);
+
+/**
+ *  @brief  Attach a digest function to a File
+ *
+ *  The digest function is called with the bytes read by eEF_fread(), eEF_fread_nb(), eEF_forward() and
+ *  eEF_forward_buffered(), right after they are transferred, including the whole sectors read directly in the caller
+ *  buffer. The digest covers the bytes from the file offset at attachment up to the digest offset. Bytes read again
+ *  after a backward seek are not digested twice, bytes read after a forward seek past the digest offset are not
+ *  digested at all, the digest offset then stays behind the file offset.
+ *
+ *  @param  pxFile    Pointer to the file object
+ *  @param  pxFunc    Pointer to the digest function (0:detach the digest)
+ *  @param  pvContext Context given to the digest function, the CRC or hash state
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK                   Succeeded
+ *  @retval EF_RET_INVALID_OBJECT       The file/directory object is invalid
+ *  @retval EF_RET_TIMEOUT              Could not get a grant to access the volume within defined period
+ */
+ef_return_et eEF_fdigest (
+  EF_FILE     * pxFile,
+  xFileDigest * pxFunc,
+  void        * pvContext
+);
+
+/**
+ *  @brief  Get the digest offset of a File
+ *
+ *  @param  pxFile      Pointer to the file object
+ *  @param  pu32Offset  Pointer to the file offset following the last byte digested
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK                   Succeeded
+ *  @retval EF_RET_INVALID_OBJECT       The file/directory object is invalid
+ *  @retval EF_RET_TIMEOUT              Could not get a grant to access the volume within defined period
+ */
+ef_return_et eEF_fdigest_offset (
+  EF_FILE   * pxFile,
+  ef_u32_t  * pu32Offset
+);
+
 /**
  *  @brief  Set Active Codepage for the Path Name
  *
@@ -1141,6 +1427,31 @@ TCHAR* eEF_gets (
   EF_FILE * pxFile
 );
 
+/**
+ *  @brief  Get a line from the File
+ *
+ *  The line is read up to and including its line feed, or until the buffer is full. Without code conversion the
+ *  line feed is looked for in the file window, and the line is read with one eEF_fread() per sector it spans.
+ *
+ *  @param  pxFile      Pointer to the file object
+ *  @param  pxBuffer    Pointer to the buffer to store the line, it is always terminated
+ *  @param  u32Size     Size of the buffer (items)
+ *  @param  pu32Length  Pointer to the number of items stored, terminator excluded, 0 at the end of the file
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK                   Succeeded
+ *  @retval EF_RET_DISK_ERR             A hard error occurred in the low level disk I/O layer
+ *  @retval EF_RET_INT_ERR              Assertion failed
+ *  @retval EF_RET_INVALID_OBJECT       The file/directory object is invalid
+ *  @retval EF_RET_TIMEOUT              Could not get a grant to access the volume within defined period
+ */
+ef_return_et eEF_getline (
+  EF_FILE   * pxFile,
+  TCHAR     * pxBuffer,
+  ef_u32_t    u32Size,
+  ef_u32_t  * pu32Length
+);
+
 //#define eEF_eof(pxFile)           ((int)((pxFile)->u32FileOffset == (pxFile)->xObject.u32Size))
 //#define eEF_error(pxFile)         ((pxFile)->u8ErrorCode)
 //#define eEF_tell(pxFile)          ((pxFile)->u32FileOffset)
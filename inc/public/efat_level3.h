@@ -54,12 +54,17 @@
  */
 typedef ef_u32_t (StreamFn)(const ef_u08_t*,ef_u32_t);
 
+/**
+ *  @brief  Pointer to a producing Function, it fills up to the given size and returns the number of bytes filled
+ */
+typedef ef_u32_t (ProduceFn)(ef_u08_t*,ef_u32_t);
+
 
 /**
  *  @brief  Format parameter structure (MKFS_PARM)
  */
 typedef struct {
-  ef_u08_t u8Format;       /**< Format option (FM_FAT, FM_FAT32 and FM_SFD) */
+  ef_u08_t u8Format;       /**< Format option (FM_FAT, FM_FAT32, FM_SFD and FM_QUICK) */
   ef_u08_t u8FatsNb;       /**< Number of FATs */
   ef_u32_t u32DataAlign;    /**< Data area alignment (sector) */
   ef_u32_t u32RootDirNb;    /**< Number of root directory entries */
@@ -109,41 +114,111 @@ ef_return_et eEF_forward (
   ef_u32_t  * pu32BFw
 );
 
+/**
+ *  @brief  Forward Data to the Stream by contiguous runs
+ *
+ *  The bytes up to the next sector boundary go through the file window as with eEF_forward, then the contiguous
+ *  cluster runs of the file are read into the buffer by a single disk access each and handed to the stream as one
+ *  chunk of up to u32BufferSize bytes. The stream function may take a part of a chunk only, it is called again with
+ *  the rest until it goes busy. Without a buffer of at least one sector, it behaves as eEF_forward. As eEF_forward, it
+ *  returns the error code the file has been aborted with, if any, and forwards nothing.
+ *
+ *  @param  pxFile        Pointer to the file object
+ *  @param  pxFunc        Pointer to the streaming function
+ *  @param  pu8Buffer     Pointer to the chunk buffer (null: forward sector by sector)
+ *  @param  u32BufferSize Size of the chunk buffer [byte], a multiple of the sector size is best
+ *  @param  u32BFw        Number of bytes to forward
+ *  @param  pu32BFw       Pointer to number of bytes forwarded
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK                   Succeeded
+ *  @retval EF_RET_DISK_ERR             A hard error occurred in the low level disk I/O layer
+ *  @retval EF_RET_INT_ERR              Assertion failed, or the stream did not take any byte
+ *  @retval EF_RET_INVALID_OBJECT       The file/directory object is invalid
+ *  @retval EF_RET_TIMEOUT              Could not get a grant to access the volume within defined period
+ */
+ef_return_et eEF_forward_buffered (
+  EF_FILE   * pxFile,
+  StreamFn  * pxFunc,
+  ef_u08_t  * pu8Buffer,
+  ef_u32_t    u32BufferSize,
+  ef_u32_t    u32BFw,
+  ef_u32_t  * pu32BFw
+);
+
+/**
+ *  @brief  Receive Data from a Producer Directly
+ *
+ *  The producer function fills the file window directly, up to a sector. When a run buffer of at least one sector is
+ *  given, the whole sectors from a sector boundary are filled in it by contiguous runs of the cluster chain, the chain
+ *  end being extended with the adjacent free clusters, and each run is written by a single disk access. The call
+ *  ends when the producer returns 0, the clusters linked past the received data are released then.
+ *
+ *  @param  pxFile        Pointer to the file object
+ *  @param  pxFunc        Pointer to the producing function
+ *  @param  pu8Buffer     Pointer to the run buffer (null: receive sector by sector in the file window)
+ *  @param  u32BufferSize Size of the run buffer [byte], a multiple of the cluster size is best
+ *  @param  u32BTr        Number of bytes to receive
+ *  @param  pu32BTr       Pointer to number of bytes received
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK                   Succeeded
+ *  @retval EF_RET_DISK_ERR             A hard error occurred in the low level disk I/O layer
+ *  @retval EF_RET_INT_ERR              Assertion failed, or the FAT could not be accessed
+ *  @retval EF_RET_DENIED               The file is not opened for writing, or in bounded latency write mode
+ *  @retval EF_RET_INVALID_OBJECT       The file/directory object is invalid
+ *  @retval EF_RET_TIMEOUT              Could not get a grant to access the volume within defined period
+ */
+ef_return_et eEF_receive (
+  EF_FILE   * pxFile,
+  ProduceFn * pxFunc,
+  ef_u08_t  * pu8Buffer,
+  ef_u32_t    u32BufferSize,
+  ef_u32_t    u32BTr,
+  ef_u32_t  * pu32BTr
+);
+
 /**
  *  @brief  Create an FAT volume
  *
- *  @param  pxPath        Logical drive number
- *  @param  pxParameters  Format options
- *  @param  pvBuffer      Pointer to working buffer (null: use heap memory)
- *  @param  u32Size       Size of working buffer [byte]
+ *  The volume is created on a physical drive none of the mounted volumes lies on. On the whole drive, the volume is
+ *  created in a new MBR partition 1, that eEF_mount() finds with partition 1 or 255 (auto detect), unless FM_SFD is
+ *  given: it is then created without partition table, that eEF_mount() finds with partition 0. The FATs and the root
+ *  directory are written with the whole working buffer per drive command, and the data area starts on an erase block
+ *  boundary (GET_BLOCK_SIZE, or u32DataAlign). The data area is cleared, by the drive with CTRL_WRITE_ZEROES or with
+ *  the working buffer, unless FM_QUICK is given: it is trimmed then. On FAT32, the FSINFO free count and last
+ *  allocated cluster are only set when EF_CONF_USE_FAT32_FSINFO_CLUSTER_FREE or _ALLOCATED keeps them up to date,
+ *  else they are left unknown.
+ *
+ *  @note   API change from the former eEF_mkfs( pxPath, pxParameters, pvBuffer, u32Size ): the volume is designated
+ *          by its physical drive and partition, as for eEF_mount(), instead of a logical drive path, since logical
+ *          drives are only bound to a physical drive while mounted. The working buffer is no longer taken from the
+ *          heap when pvBuffer is null (EF_RET_NOT_ENOUGH_CORE), and GPT partitions are not supported any more
+ *          (EF_RET_MKFS_ABORTED).
+ *
+ *  @param  u8PhysDrvNb   Physical drive number
+ *  @param  u8PartitionNb Partition number (0: whole drive, as a new partition unless FM_SFD, 1-4: MBR partition)
+ *  @param  pxParameters  Format options (null: default options)
+ *  @param  pvBuffer      Pointer to working buffer, a few clusters large is best
+ *  @param  u32Size       Size of working buffer [byte], one sector at least
  *
  *  @return Function completion
  *  @retval EF_RET_OK                   Succeeded
  *  @retval EF_RET_DISK_ERR             A hard error occurred in the low level disk I/O layer
  *  @retval EF_RET_INT_ERR              Assertion failed
  *  @retval EF_RET_NOT_READY            The physical drive cannot work
- *  @retval EF_RET_NO_FILE              Could not find the file
- *  @retval EF_RET_NO_PATH              Could not find the pxPath
- *  @retval EF_RET_INVALID_NAME         The pxPath name format is invalid
- *  @retval EF_RET_DENIED               Access denied due to prohibited access or directory full
- *  @retval EF_RET_EXIST                Access denied due to prohibited access
- *  @retval EF_RET_INVALID_OBJECT       The file/directory object is invalid
  *  @retval EF_RET_WRITE_PROTECTED      The physical drive is write protected
- *  @retval EF_RET_INVALID_DRIVE        The logical drive number is invalid
- *  @retval EF_RET_NOT_ENABLED          The volume has no work area
- *  @retval EF_RET_NO_FILESYSTEM        There is no valid FAT volume
- *  @retval EF_RET_MKFS_ABORTED         The f_mkfs() aborted due to any problem
- *  @retval EF_RET_TIMEOUT              Could not get a grant to access the volume within defined period
- *  @retval EF_RET_LOCKED               The operation is rejected according to the file sharing policy
- *  @retval EF_RET_NOT_ENOUGH_CORE      LFN working buffer could not be allocated
- *  @retval EF_RET_TOO_MANY_OPEN_FILES  Number of open files > EF_CONF_FILE_LOCK
+ *  @retval EF_RET_MKFS_ABORTED         No such partition, GPT, or no FAT sub-type of this configuration fits
+ *  @retval EF_RET_LOCKED               A volume of the physical drive is mounted
+ *  @retval EF_RET_NOT_ENOUGH_CORE      The working buffer is null or smaller than a sector
  *  @retval EF_RET_INVALID_PARAMETER    Given parameter is invalid
  */
 ef_return_et eEF_mkfs (
-  const TCHAR             * pxPath,
+  ef_u08_t                  u8PhysDrvNb,
+  ef_u08_t                  u8PartitionNb,
   const ef_mkfs_param_st  * pxParameters,
   void                    * pvBuffer,
-  ef_u32_t                 u32Size
+  ef_u32_t                  u32Size
 );
 
 /**
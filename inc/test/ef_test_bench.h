@@ -0,0 +1,173 @@
+/**
+ * ********************************************************************************************************************
+ *  @file     ef_test_bench.h
+ *  @ingroup  GroupeFATTest
+ *  @author   Emmanuel AMADIO
+ *  @version  V0.1
+ *  @brief    Header for the multi-threaded stress and scaling benchmark on RAM drives (host builds).
+ *
+ * ********************************************************************************************************************
+ *  eFAT - embedded FAT Filesystem module
+ * ********************************************************************************************************************
+ *
+ *  Copyright (C) 2021, Amadio Emmanuel, all right reserved.
+ *  Copyright (C) 2019, ChaN, all right reserved.
+ *
+ *  eFAT module is an open source software. Redistribution and use of eFAT in source and binary forms, with or without
+ *  modification, are permitted provided that the following condition is met:
+ *
+ *  Redistributions of source code must retain the above copyright notice, this condition and the following disclaimer.
+ *
+ *  This software is provided by the copyright holders and contributors "AS IS" and any warranties related to this
+ *  software are DISCLAIMED.
+ *  The copyright owners or contributors be NOT LIABLE for any damages caused by use of this software.
+ * ********************************************************************************************************************
+ */
+
+/* START OF FILE *************************************************************************************************** */
+#ifndef EFAT_TEST_BENCH_H
+#define EFAT_TEST_BENCH_H
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+/* ***************************************************************************************************************** */
+
+/* Includes -------------------------------------------------------------------------------------------------------- */
+#include "efat.h"
+
+/* Local constant macros ------------------------------------------------------------------------------------------- */
+
+/**
+ *  Maximum number of RAM drives (and volumes) used by the benchmark
+ */
+#define EF_TEST_BENCH_DRIVES_NB   ( 2 )
+
+/* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
+
+/**
+ *  @brief  Benchmark configuration structure (ef_test_bench_config_st)
+ */
+typedef struct ef_test_bench_config_struct {
+  ef_u08_t  u8VolumesNb;        /**< Number of RAM drive volumes (1 to EF_TEST_BENCH_DRIVES_NB and EF_CONF_VOLUMES_NB) */
+  ef_u32_t  u32VolumeSectors;   /**< Size of each RAM drive in sectors (one sector clusters: FAT32 from about 66000 sectors, else FAT16) */
+  ef_u32_t  u32ThreadsMax;      /**< The benchmark runs with 1, 2, 4 ... up to u32ThreadsMax threads */
+  ef_u32_t  u32CyclesNb;        /**< Number of file cycles of each thread per run */
+  ef_u32_t  u32FileSize;        /**< Size of the file written then read back in a cycle */
+  ef_u32_t  u32ChunkSize;       /**< Number of bytes given to each eEF_fwrite() and eEF_fread() */
+  ef_u32_t  u32DriveLatency;    /**< Emulated drive access time in microseconds per request (0: none) */
+} ef_test_bench_config_st;
+
+/* Local function macros ------------------------------------------------------------------------------------------- */
+/* Local variables ------------------------------------------------------------------------------------------------- */
+/* Public variables ------------------------------------------------------------------------------------------------ */
+/* Local function prototypes---------------------------------------------------------------------------------------- */
+/* Local functions ------------------------------------------------------------------------------------------------- */
+/* Public functions ------------------------------------------------------------------------------------------------ */
+
+/**
+ *  @brief  Run the multi-threaded stress and scaling benchmark
+ *
+ *  The RAM drives are registered on the first call, they must be the first drives registered (physical
+ *  drives 0 to EF_TEST_BENCH_DRIVES_NB - 1). Each run formats and mounts the volumes "A:", "B:"..., then
+ *  every thread repeats on its own file of the volume (thread index modulo u8VolumesNb):
+ *  eEF_fopen() for writing, eEF_fwrite(), eEF_fsync(), eEF_fclose(), eEF_fopen() for reading, eEF_fread()
+ *  with data check, eEF_fclose() and eEF_remove().
+ *  The aggregate throughput and the latency percentiles of each operation are printed for each number of
+ *  threads, followed by the metrics of the volume and window locks (eEFPortSyncStatsGet()) when
+ *  EF_CONF_PORT_SYNC_STATS is enabled.
+ *
+ *  @note   Requires the POSIX threads system port (EF_CONF_PORT_SYSTEM), and EF_CONF_FS_LOCK for more than one
+ *          thread. The volumes are unmounted at the end of each run.
+ *
+ *  @param  pxConfig  Pointer to the benchmark configuration
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Invalid configuration
+ *  @retval 2   Not enough memory for the RAM drives or the samples
+ *  @retval 3   RAM drive registration failed
+ *  @retval 4   Volume mount failed
+ *  @retval 5   Thread creation failed
+ *  @retval 6   A file operation failed
+ *  @retval 7   Read data differs from the data written
+ */
+int32_t s32TestBenchConcurrency (
+  const ef_test_bench_config_st * pxConfig
+);
+
+/**
+ *  @brief  Run the fragmentation benchmark
+ *
+ *  The RAM drive 0 is formatted and mounted as "A:", then u32FilesNb files are appended u32ChunkSize bytes each
+ *  in turn, as loggers running side by side do, until they reach u32FileSize bytes. Each file is then read back
+ *  in one eEF_fread(), the number of discontiguous sector extents it reads and the number of read commands are
+ *  printed as averages per file.
+ *
+ *  @note   Requires the POSIX threads system port (EF_CONF_PORT_SYSTEM). The volume is unmounted at the end.
+ *
+ *  @param  u32VolumeSectors  Size of the RAM drive in sectors
+ *  @param  u32FilesNb        Number of files growing side by side
+ *  @param  u32FileSize       Size of each file
+ *  @param  u32ChunkSize      Number of bytes appended to a file in turn
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Invalid configuration
+ *  @retval 2   Not enough memory for the RAM drive or the buffers
+ *  @retval 3   RAM drive registration failed
+ *  @retval 4   Volume mount failed
+ *  @retval 6   A file operation failed
+ *  @retval 7   Read data differs from the data written
+ */
+int32_t s32TestBenchFragmentation (
+  ef_u32_t  u32VolumeSectors,
+  ef_u32_t  u32FilesNb,
+  ef_u32_t  u32FileSize,
+  ef_u32_t  u32ChunkSize
+);
+
+/**
+ *  @brief  Run the memory functions benchmark
+ *
+ *  eEFPortMemCopy(), eEFPortMemSet() and eEFPortMemCompare() are first checked against the C library for every
+ *  size up to a few words at every misalignment of both buffers. With EF_CONF_PORT_MEM_DMA, a counting engine is
+ *  registered to check that only the copies of that size or more are handed to it. Then the average time of a
+ *  sector sized copy with aligned and with misaligned buffers, of eEFPortMemZero() and of eEFPortMemCompare() on
+ *  equal buffers is printed, to be compared between the EF_CONF_PORT_MEM_WORD settings.
+ *
+ *  @param  u32LoopsNb  Number of calls timed for each function
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Invalid configuration
+ *  @retval 7   A memory function result differs from the C library one, or the DMA engine is misused
+ */
+int32_t s32TestBenchMemory (
+  ef_u32_t  u32LoopsNb
+);
+
+/**
+ *  @brief  Run the FAT fields load and store benchmark
+ *
+ *  u32EFPortLoad(), u16EFPortLoad() and eEFPortStoreu32() are first checked to be little-endian at every
+ *  misalignment. Then each one goes through every offset of a 4 KiB buffer u32LoopsNb times, and the average
+ *  time of one access is printed, to be compared between the EF_CONF_PORT_NATIVE_LE settings.
+ *
+ *  @param  u32LoopsNb  Number of passes over the buffer for each function
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Invalid configuration
+ *  @retval 7   A field is not loaded or stored little-endian
+ */
+int32_t s32TestBenchLoadStore (
+  ef_u32_t  u32LoopsNb
+);
+
+/* ***************************************************************************************************************** */
+#ifdef __cplusplus
+}
+#endif
+#endif /* EFAT_TEST_BENCH_H */
+/* END OF FILE ***************************************************************************************************** */
@@ -0,0 +1,497 @@
+/**
+ * ********************************************************************************************************************
+ *  @file     ef_test_file.h
+ *  @ingroup  GroupeFATTest
+ *  @author   Emmanuel AMADIO
+ *  @version  V0.1
+ *  @brief    Functional tests of the file system on RAM drives (host builds).
+ *
+ * ********************************************************************************************************************
+ *  eFAT - embedded FAT Filesystem module
+ * ********************************************************************************************************************
+ *
+ *  Copyright (C) 2021, Amadio Emmanuel, all right reserved.
+ *  Copyright (C) 2019, ChaN, all right reserved.
+ *
+ *  eFAT module is an open source software. Redistribution and use of eFAT in source and binary forms, with or without
+ *  modification, are permitted provided that the following condition is met:
+ *
+ *  Redistributions of source code must retain the above copyright notice, this condition and the following disclaimer.
+ *
+ *  This software is provided by the copyright holders and contributors "AS IS" and any warranties related to this
+ *  software are DISCLAIMED.
+ *  The copyright owners or contributors be NOT LIABLE for any damages caused by use of this software.
+ * ********************************************************************************************************************
+ */
+
+/* START OF FILE *************************************************************************************************** */
+#ifndef EFAT_TEST_FILE_H
+#define EFAT_TEST_FILE_H
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+/* ***************************************************************************************************************** */
+
+/* Includes -------------------------------------------------------------------------------------------------------- */
+#include "efat.h"
+
+/* Local constant macros ------------------------------------------------------------------------------------------- */
+
+/**
+ *  Number of RAM drives used by the functional tests
+ */
+#define EF_TEST_FILE_DRIVES_NB  ( 2 )
+
+/* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
+/* Local function macros ------------------------------------------------------------------------------------------- */
+/* Local variables ------------------------------------------------------------------------------------------------- */
+/* Public variables ------------------------------------------------------------------------------------------------ */
+/* Local function prototypes---------------------------------------------------------------------------------------- */
+/* Local functions ------------------------------------------------------------------------------------------------- */
+/* Public functions ------------------------------------------------------------------------------------------------ */
+
+/*
+ *  The RAM drives are registered on the first call of a test, they must be the first drives registered (physical
+ *  drives 0 to EF_TEST_FILE_DRIVES_NB - 1). Each test formats the RAM drives it uses as FAT32 volumes without
+ *  partition table, and leaves the volume "A:" unmounted.
+ */
+
+/**
+ *  @brief  Check that each registered drive gets its own physical drive number
+ *
+ *  Both RAM drives are formatted with a different number of clusters, then mounted in turn on "A:".
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 4   The volume found is not the one of the physical drive
+ */
+int32_t s32TestFileDriveRegister (
+  void
+);
+
+/**
+ *  @brief  Check that the clusters of a written file are allocated in the FAT
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed
+ *  @retval 6   The number of free clusters does not match the file size
+ */
+int32_t s32TestFileWrite (
+  void
+);
+
+/**
+ *  @brief  Check that an existing file is found and read back
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed
+ *  @retval 7   Read data differs from the data written
+ */
+int32_t s32TestFileRead (
+  void
+);
+
+/**
+ *  @brief  Check that a file opened in truncate mode is emptied and its clusters freed
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed
+ *  @retval 6   The number of free clusters does not match the file size
+ *  @retval 7   Read data differs from the data written
+ *  @retval 14  The FAT of the volume is not consistent
+ */
+int32_t s32TestFileTruncate (
+  void
+);
+
+/**
+ *  @brief  Check unaligned sequential reads through multi-sector clusters
+ *
+ *  Reads ending inside a sector are followed by reads of whole sectors in the middle of a cluster.
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed
+ *  @retval 7   Read data differs from the data written
+ */
+int32_t s32TestFileReadUnaligned (
+  void
+);
+
+#if ( 0 != EF_CONF_FILE_RESERVE )
+/**
+ *  @brief  Check the clusters reserved for two files growing side by side, one past its reservation
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed, or a reservation is not denied to a file opened for reading
+ *  @retval 6   The free cluster count does not match the clusters reserved or written
+ *  @retval 7   Read data differs from the data written
+ */
+int32_t s32TestFileReserve (
+  void
+);
+#endif
+
+#if ( 0 != EF_CONF_NON_BLOCKING )
+/**
+ *  @brief  Check unaligned sequential non-blocking reads through multi-sector clusters
+ *
+ *  Reads ending inside a sector are followed by reads of whole sectors in the middle of a cluster.
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed
+ *  @retval 7   Read data differs from the data written
+ */
+int32_t s32TestFileReadNbUnaligned (
+  void
+);
+#endif
+
+#if ( 2 == EF_CONF_RELATIVE_PATH )
+/**
+ *  @brief  Check the current directory path through changes of directory
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A directory operation failed
+ *  @retval 8   The current directory path is wrong, or does not report a too small buffer
+ */
+int32_t s32TestFileCwd (
+  void
+);
+#endif
+
+#if ( 0 != EF_CONF_VFAT )
+/**
+ *  @brief  Check long file names through creation, lookup in any case, information and removal, more times than
+ *          the LFN working buffers, so that a buffer not given back fails the test
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed
+ *  @retval 7   A file or its information differs from the one written
+ */
+int32_t s32TestFileLongName (
+  void
+);
+#endif
+
+/**
+ *  @brief  Check the lines read by eEF_getline() from a text file spread over several sectors and clusters, with a
+ *          buffer holding the whole lines, then with a buffer splitting them, and that a closed file is rejected
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed
+ *  @retval 7   A line differs from the text written
+ */
+int32_t s32TestFileGetline (
+  void
+);
+
+/**
+ *  @brief  Check the data forwarded to a stream by eEF_forward() and eEF_forward_buffered(), then that both return the
+ *          error code of an aborted file and forward nothing
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed, or forwarded bytes on an aborted file
+ *  @retval 7   Forwarded data differs from the data written
+ */
+int32_t s32TestFileForward (
+  void
+);
+
+/**
+ *  @brief  Check the data received by eEF_receive() appended to a file, then over the middle of a file with and without
+ *          a run buffer, and the free clusters after each
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed
+ *  @retval 6   Free cluster count is wrong
+ *  @retval 7   Read data differs from the data received
+ */
+int32_t s32TestFileReceive (
+  void
+);
+
+#if ( 0 != EF_CONF_FILE_DIGEST )
+/**
+ *  @brief  Check the digest of the bytes read by eEF_fread(), eEF_forward() and eEF_forward_buffered(), and the digest
+ *          offset given by eEF_fdigest_offset() after backward and forward seeks
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed, or the digest offset is wrong
+ *  @retval 7   The digest differs from the one of the bytes read
+ */
+int32_t s32TestFileDigest (
+  void
+);
+#endif
+
+/**
+ *  @brief  Check writes ending at a sector boundary followed by small writes, then lines written by eEF_printf(),
+ *          eEF_puts() and eEF_putc() over many sectors
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed
+ *  @retval 7   Read data differs from the data written
+ */
+int32_t s32TestFilePrintf (
+  void
+);
+
+#if ( 0 != EF_CONF_ALLOC_SNAPSHOT )
+/**
+ *  @brief  Check the allocation snapshot saved by eEF_umount() is taken back by the next mount, and that it is not
+ *          after a writable mount whose unmount was lost. Its free extents must be checked in the FAT, a cluster
+ *          allocated behind the snapshot splitting its run
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed
+ *  @retval 6   Free cluster count is wrong
+ *  @retval 16  The run allocated by eEF_expand() is not the best fitting one, or it is linked to a cluster in use
+ */
+int32_t s32TestFileSnapshot (
+  void
+);
+#endif
+
+#if ( 0 != EF_CONF_FILE_LOCK )
+/**
+ *  @brief  Check the sharing rules of the file lock table: a file open for writing is not opened again, readers
+ *          share a file, an open file is neither removed nor renamed, and no file is opened once the table is
+ *          full. The files are then closed out of order, removing entries from colliding hash probe sequences.
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed
+ *  @retval 9   A sharing rule is not applied
+ */
+int32_t s32TestFileLock (
+  void
+);
+#endif
+
+#if ( 0 != EF_CONF_NON_BLOCKING )
+/**
+ *  @brief  Check non-blocking writes, synchronizations and reads across sector and cluster boundaries, with a drive
+ *          ending its started transfers after a few polls
+ *
+ *  The file is written and read in uneven chunks through 4 sectors clusters, the window is written back after each
+ *  chunk. The data is then read back by blocking reads.
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed
+ *  @retval 7   Read data differs from the data written
+ *  @retval 10  No transfer has been left pending
+ */
+int32_t s32TestFileNbTransfer (
+  void
+);
+
+/**
+ *  @brief  Check that closing, seeking or truncating a file abandons its non-blocking operation
+ *
+ *  The started transfer of a file closed during a read neither blocks the reads of another file nor writes its
+ *  buffer afterwards. Another non-blocking operation follows a seek done during a write, and a truncation during a
+ *  write ends the file at the offset of the last bytes reported.
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed
+ *  @retval 7   Read data differs from the data written
+ *  @retval 10  A transfer is not left pending, or an abandoned operation or transfer is still in progress
+ */
+int32_t s32TestFileNbAbandon (
+  void
+);
+#endif
+
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+/**
+ *  @brief  Check the bounded latency write mode: a large write stops at the command budget, the writes stop at the
+ *          end of the pool until eEF_fmaintain() refills it, and the directory entry maintained by eEF_fmaintain()
+ *          gives the whole file after a remount without closing it
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed
+ *  @retval 7   Read data differs from the data written
+ *  @retval 11  A write exceeds the command budget or does not stop at the end of the pool
+ *  @retval 12  The directory entry does not match the file
+ */
+int32_t s32TestFileBounded (
+  void
+);
+#endif
+
+/**
+ *  @brief  Check the removal of a file fails when a link of its cluster chain is out of range
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed
+ *  @retval 13  The broken cluster chain is not reported
+ */
+int32_t s32TestFileChainBroken (
+  void
+);
+
+#if ( 0 != EF_CONF_TRUNCATE_REUSE )
+/**
+ *  @brief  Check a file truncated on opening keeps its first cluster in its directory entry with a size of 0, the
+ *          rewrite reuses its cluster chain without allocating, and the closing leaves a consistent FAT
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed
+ *  @retval 6   Free cluster count is wrong
+ *  @retval 7   Read data differs from the data written
+ *  @retval 12  The directory entry does not match the file
+ *  @retval 14  The FAT of the volume is not consistent
+ */
+int32_t s32TestFileTruncateKeep (
+  void
+);
+#endif
+
+#if ( 0 != EF_CONF_SEEK_ZERO_FILL )
+/**
+ *  @brief  Check the data of a file extended by a seek past its end read back as zeroes, the free clusters of the
+ *          volume holding stale data
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed
+ *  @retval 7   Read data differs from the data written or from zeroes
+ *  @retval 14  The FAT of the volume is not consistent
+ */
+int32_t s32TestFileSeekZero (
+  void
+);
+#endif
+
+#if ( 0 != EF_CONF_USE_MKFS )
+/**
+ *  @brief  Check the FAT12, FAT16 and FAT32 volumes created by eEF_mkfs(), without partition table or in an MBR
+ *          partition, are mounted, take a directory and a file, and leave a consistent FAT. Only the sub-types the
+ *          configuration mounts are checked.
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed
+ *  @retval 7   Read data differs from the data written
+ *  @retval 14  The FAT of the volume is not consistent
+ *  @retval 15  The volume creation failed or made another FAT type
+ */
+int32_t s32TestFileMkfs (
+  void
+);
+#endif
+
+#if ( 0 != EF_CONF_LAZY_FREE_COUNT )
+/**
+ *  @brief  Check the free cluster count of eEF_getfree_slice() is the one of a full eEF_getfree() scan, files being
+ *          written and removed between the slices, and that eEF_getfree() completes a count left half way
+ *
+ *  @return The test check Failure Id
+ *  @retval 0   Everything went well !
+ *  @retval 1   Not enough memory for the RAM drives
+ *  @retval 2   RAM drive registration failed
+ *  @retval 3   Volume mount failed
+ *  @retval 5   A file operation failed
+ *  @retval 6   Free cluster count is wrong
+ *  @retval 14  The FAT of the volume is not consistent
+ */
+int32_t s32TestFileLazyFree (
+  void
+);
+#endif
+
+/* ***************************************************************************************************************** */
+#ifdef __cplusplus
+}
+#endif
+#endif /* EFAT_TEST_FILE_H */
+/* END OF FILE ***************************************************************************************************** */
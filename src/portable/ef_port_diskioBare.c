@@ -117,6 +117,59 @@ ef_return_et eEFPortDriveSDIOCtrl (
   void *  pvBuffer
 );
 
+#if ( 0 != EF_CONF_NON_BLOCKING )
+/**
+ *  @brief  Start reading Sector(s) with the DMA
+ *
+ *  A buffer not aligned on 4 bytes is read with a blocking transfer.
+ *
+ *  @param  pu8Buffer   Pointer to the data buffer to store read data
+ *  @param  xSector     Start xSector in LBA
+ *  @param  u32Count    Number of sectors to read
+ *
+ *  @return Results of Disk Functions
+ *  @retval EF_RET_OK           The transfer is started
+ *  @retval EF_RET_DISK_ERROR   R/W Error
+ */
+ef_return_et eEFPortDriveSDIOReadStart (
+  ef_u08_t  * pu8Buffer,
+  ef_lba_t    xSector,
+  ef_u32_t    u32Count
+);
+
+/**
+ *  @brief  Start writing Sector(s) with the DMA
+ *
+ *  A buffer not aligned on 4 bytes is written with a blocking transfer.
+ *
+ *  @param  pu8Buffer   Pointer to the data to be written
+ *  @param  xSector     Start xSector in LBA
+ *  @param  u32Count    Number of sectors to write
+ *
+ *  @return Results of Disk Functions
+ *  @retval EF_RET_OK           The transfer is started
+ *  @retval EF_RET_DISK_ERROR   R/W Error
+ */
+ef_return_et eEFPortDriveSDIOWriteStart (
+  const ef_u08_t  * pu8Buffer,
+  ef_lba_t          xSector,
+  ef_u32_t          u32Count
+);
+
+/**
+ *  @brief  Get the status of the started transfer
+ *
+ *  @return Results of Disk Functions
+ *  @retval EF_RET_OK               The transfer ended successfully
+ *  @retval EF_RET_PENDING          The transfer is running
+ *  @retval EF_RET_DISK_TIMEOUT     The transfer did not end in time
+ *  @retval EF_RET_DISK_ERROR       R/W Error
+ */
+ef_return_et eEFPortDriveSDIOTransferStatus (
+  void
+);
+#endif
+
 /* Public functions ----------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 static ef_return_et eEFPortDriveSDIOCheckStatus (
@@ -131,6 +184,23 @@ static ef_return_et eEFPortDriveSDIOCheckStatus (
  */
 static volatile ef_return_et eSDIOStatus = EF_RET_DISK_NOINIT;
 
+#if ( 0 != EF_CONF_NON_BLOCKING )
+/**
+ *  Set by the DMA transfer complete callbacks
+ */
+static volatile ef_bool_t bSDIOTransferDone = EF_BOOL_FALSE;
+
+/**
+ *  Result of the started transfer when it did not use the DMA
+ */
+static ef_return_et eSDIOTransferResult = EF_RET_OK;
+
+/**
+ *  Remaining status polls before the started transfer times out
+ */
+static ef_u32_t u32SDIOTransferPolls = 0;
+#endif
+
 /* Private functions ---------------------------------------------------------*/
 
 /*
@@ -299,6 +369,118 @@ ef_return_et eEFPortDriveSDIOWrite (
   return eRetVal;
 }
 
+#if ( 0 != EF_CONF_NON_BLOCKING )
+/* Start reading Sector(s) with the DMA */
+ef_return_et eEFPortDriveSDIOReadStart (
+  ef_u08_t  * pu8Buffer,
+  ef_lba_t    xSector,
+  ef_u32_t    u32Count
+)
+{
+  ef_return_et eRetVal = EF_RET_OK;
+
+  bSDIOTransferDone     = EF_BOOL_FALSE;
+  u32SDIOTransferPolls  = EF_PORT_SD_TIMEOUT;
+
+  /* If the DMA cannot access the buffer, read it now */
+  if ( 0 != ( ( (ef_u32_t) pu8Buffer ) & 3 ) )
+  {
+    eSDIOTransferResult = eEFPortDriveSDIORead( pu8Buffer, xSector, u32Count );
+    bSDIOTransferDone   = EF_BOOL_TRUE;
+  }
+  /* Else, if the DMA transfer cannot be started */
+  else if ( MSD_OK != BSP_SD_ReadBlocks_DMA( (uint32_t*) pu8Buffer, (uint32_t) (xSector), u32Count ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERROR );
+  }
+  else
+  {
+    eSDIOTransferResult = EF_RET_OK;
+  }
+
+  return eRetVal;
+}
+
+/* Start writing Sector(s) with the DMA */
+ef_return_et eEFPortDriveSDIOWriteStart (
+  const ef_u08_t  * pu8Buffer,
+  ef_lba_t          xSector,
+  ef_u32_t          u32Count
+)
+{
+  ef_return_et eRetVal = EF_RET_OK;
+
+  bSDIOTransferDone     = EF_BOOL_FALSE;
+  u32SDIOTransferPolls  = EF_PORT_SD_TIMEOUT;
+
+  /* If the DMA cannot access the buffer, write it now */
+  if ( 0 != ( ( (ef_u32_t) pu8Buffer ) & 3 ) )
+  {
+    eSDIOTransferResult = eEFPortDriveSDIOWrite( pu8Buffer, xSector, u32Count );
+    bSDIOTransferDone   = EF_BOOL_TRUE;
+  }
+  /* Else, if the DMA transfer cannot be started */
+  else if ( MSD_OK != BSP_SD_WriteBlocks_DMA( (uint32_t*) pu8Buffer, (uint32_t) (xSector), u32Count ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERROR );
+  }
+  else
+  {
+    eSDIOTransferResult = EF_RET_OK;
+  }
+
+  return eRetVal;
+}
+
+/* Get the status of the started transfer */
+ef_return_et eEFPortDriveSDIOTransferStatus (
+  void
+)
+{
+  ef_return_et eRetVal;
+
+  /* If the transfer ended and the card is ready again */
+  if (    ( EF_BOOL_FALSE != bSDIOTransferDone )
+       && ( SD_TRANSFER_OK == BSP_SD_GetCardState( ) ) )
+  {
+    eRetVal = eSDIOTransferResult;
+  }
+  /* Else, if the transfer did not end in time */
+  else if ( 0 == u32SDIOTransferPolls )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_TIMEOUT );
+  }
+  else
+  {
+    /* Keep transfering */
+    u32SDIOTransferPolls--;
+    eRetVal = EF_RET_PENDING;
+  }
+
+  return eRetVal;
+}
+
+/**
+ *  @brief  BSP SD Rx Transfer completed callback (from the DMA interrupt)
+ */
+void BSP_SD_ReadCpltCallback (
+  void
+)
+{
+  bSDIOTransferDone = EF_BOOL_TRUE;
+}
+
+/**
+ *  @brief  BSP SD Tx Transfer completed callback (from the DMA interrupt)
+ */
+void BSP_SD_WriteCpltCallback (
+  void
+)
+{
+  bSDIOTransferDone = EF_BOOL_TRUE;
+}
+#endif
+
 /* Miscellaneous Functions */
 
 ef_return_et eEFPortDriveSDIOCtrl (
@@ -364,5 +546,13 @@ ef_drive_functions_st xffDriveFunctionsSDIO = {
     .pxWrite       = eEFPortDriveSDIOWrite,
     /* Pointer to function to I/O control operation */
     .pxCtrl        = eEFPortDriveSDIOCtrl,
+#if ( 0 != EF_CONF_NON_BLOCKING )
+    /* Pointer to function to Start reading Sector(s) */
+    .pxReadStart      = eEFPortDriveSDIOReadStart,
+    /* Pointer to function to Start writing Sector(s) */
+    .pxWriteStart     = eEFPortDriveSDIOWriteStart,
+    /* Pointer to function to Get the started transfer status */
+    .pxTransferStatus = eEFPortDriveSDIOTransferStatus,
+#endif
 };
 
@@ -30,7 +30,30 @@
 
 /* Includes -------------------------------------------------------------------------------------------------------- */
 #include <ef_prv_def.h>
+#include "ef_port_load_store.h"
+
 /* Local constant macros ------------------------------------------------------------------------------------------- */
+
+/**
+ *  Native accesses selection, the compiler tells whether the core is little-endian and handles unaligned accesses
+ */
+#if ( 2 == EF_CONF_PORT_NATIVE_LE )
+  #if    defined( __BYTE_ORDER__ ) && ( __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ )                                    \
+      && (    defined( __i386__ ) || defined( __x86_64__ ) || defined( __aarch64__ )                                   \
+           || defined( __ARM_FEATURE_UNALIGNED ) || defined( __riscv_misaligned_fast ) )
+    #define EF_PORT_LOAD_STORE_NATIVE ( 1 )
+  #else
+    #define EF_PORT_LOAD_STORE_NATIVE ( 0 )
+  #endif
+#else
+  #define EF_PORT_LOAD_STORE_NATIVE   ( EF_CONF_PORT_NATIVE_LE )
+#endif
+
+#if ( 0 != EF_PORT_LOAD_STORE_NATIVE )
+  /* A fixed size memcpy() is the access the compiler turns into one unaligned load or store */
+  #include <string.h>
+#endif
+
 /* Local function macros ------------------------------------------------------------------------------------------- */
 /* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
 /* Local variables ------------------------------------------------------------------------------------------------- */
@@ -52,12 +75,7 @@ ef_return_et eEFPortLoadu16 (
   EF_ASSERT_PRIVATE( 0 != pu8src );
   EF_ASSERT_PRIVATE( 0 != pu16Value );
 
-  ef_u16_t     u16Value;
-
-  u16Value = (ef_u16_t) pu8src[ 1 ];
-  u16Value = u16Value << 8 | (ef_u16_t) pu8src[ 0 ];
-
-  *pu16Value = u16Value;
+  *pu16Value = u16EFPortLoad( pu8src );
 
   return EF_RET_OK;
 }
@@ -71,14 +89,7 @@ ef_return_et eEFPortLoadu32(
   EF_ASSERT_PRIVATE( 0 != pu8src );
   EF_ASSERT_PRIVATE( 0 != pu32Value );
 
-  ef_u32_t     u32Value;
-
-  u32Value = (ef_u32_t) pu8src[ 3 ];
-  u32Value = u32Value << 8 | (ef_u32_t) pu8src[ 2 ];
-  u32Value = u32Value << 8 | (ef_u32_t) pu8src[ 1 ];
-  u32Value = u32Value << 8 | (ef_u32_t) pu8src[ 0 ];
-
-  *pu32Value = u32Value;
+  *pu32Value = u32EFPortLoad( pu8src );
 
   return EF_RET_OK;
 }
@@ -92,18 +103,7 @@ ef_return_et eEFPortLoadu64(
   EF_ASSERT_PRIVATE( 0 != pu8src );
   EF_ASSERT_PRIVATE( 0 != pu64Value );
 
-  ef_u64_t     u64Value;
-
-  u64Value = (ef_u64_t) pu8src[ 7 ];
-  u64Value = u64Value << 8 | (ef_u64_t) pu8src[ 6 ];
-  u64Value = u64Value << 8 | (ef_u64_t) pu8src[ 5 ];
-  u64Value = u64Value << 8 | (ef_u64_t) pu8src[ 4 ];
-  u64Value = u64Value << 8 | (ef_u64_t) pu8src[ 3 ];
-  u64Value = u64Value << 8 | (ef_u64_t) pu8src[ 2 ];
-  u64Value = u64Value << 8 | (ef_u64_t) pu8src[ 1 ];
-  u64Value = u64Value << 8 | (ef_u64_t) pu8src[ 0 ];
-
-  *pu64Value = u64Value;
+  *pu64Value = u64EFPortLoad( pu8src );
 
   return EF_RET_OK;
 }
@@ -114,8 +114,12 @@ ef_u16_t u16EFPortLoad( const ef_u08_t* pu8src )  /*   Load a 2-byte little-endi
 
   ef_u16_t u16RetVal;
 
+#if ( 0 != EF_PORT_LOAD_STORE_NATIVE )
+  (void) memcpy( &u16RetVal, pu8src, sizeof( u16RetVal ) );
+#else
   u16RetVal = (ef_u16_t) pu8src[ 1 ];
   u16RetVal = ( u16RetVal << 8 ) | (ef_u16_t) pu8src[ 0 ];
+#endif
 
   return u16RetVal;
 }
@@ -126,10 +130,14 @@ ef_u32_t u32EFPortLoad( const ef_u08_t* pu8src )  /* Load a 4-byte little-endian
 
   ef_u32_t u32RetVal;
 
+#if ( 0 != EF_PORT_LOAD_STORE_NATIVE )
+  (void) memcpy( &u32RetVal, pu8src, sizeof( u32RetVal ) );
+#else
   u32RetVal = (ef_u32_t) pu8src[ 3 ];
   u32RetVal = u32RetVal << 8 | (ef_u32_t) pu8src[ 2 ];
   u32RetVal = u32RetVal << 8 | (ef_u32_t) pu8src[ 1 ];
   u32RetVal = u32RetVal << 8 | (ef_u32_t) pu8src[ 0 ];
+#endif
 
   return u32RetVal;
 }
@@ -140,6 +148,9 @@ ef_u64_t u64EFPortLoad( const ef_u08_t* pu8src )  /* Load an 8-byte little-endia
 
   ef_u64_t u64RetVal;
 
+#if ( 0 != EF_PORT_LOAD_STORE_NATIVE )
+  (void) memcpy( &u64RetVal, pu8src, sizeof( u64RetVal ) );
+#else
   u64RetVal = (ef_u64_t) pu8src[ 7 ];
   u64RetVal = u64RetVal << 8 | (ef_u64_t) pu8src[ 6 ];
   u64RetVal = u64RetVal << 8 | (ef_u64_t) pu8src[ 5 ];
@@ -148,6 +159,7 @@ ef_u64_t u64EFPortLoad( const ef_u08_t* pu8src )  /* Load an 8-byte little-endia
   u64RetVal = u64RetVal << 8 | (ef_u64_t) pu8src[ 2 ];
   u64RetVal = u64RetVal << 8 | (ef_u64_t) pu8src[ 1 ];
   u64RetVal = u64RetVal << 8 | (ef_u64_t) pu8src[ 0 ];
+#endif
 
   return u64RetVal;
 }
@@ -157,9 +169,13 @@ ef_return_et eEFPortStoreu16( ef_u08_t* pu8dst, ef_u16_t u16value )
 {
   EF_ASSERT_PRIVATE( 0 != pu8dst );
 
+#if ( 0 != EF_PORT_LOAD_STORE_NATIVE )
+  (void) memcpy( pu8dst, &u16value, sizeof( u16value ) );
+#else
   *pu8dst++ = (ef_u08_t)u16value;
   u16value >>= 8;
   *pu8dst++ = (ef_u08_t)u16value;
+#endif
 
   return EF_RET_OK;
 }
@@ -169,6 +185,9 @@ ef_return_et eEFPortStoreu32( ef_u08_t* pu8dst, ef_u32_t u32value )
 {
   EF_ASSERT_PRIVATE( 0 != pu8dst );
 
+#if ( 0 != EF_PORT_LOAD_STORE_NATIVE )
+  (void) memcpy( pu8dst, &u32value, sizeof( u32value ) );
+#else
   *pu8dst++ = (ef_u08_t)u32value;
   u32value >>= 8;
   *pu8dst++ = (ef_u08_t)u32value;
@@ -176,6 +195,7 @@ ef_return_et eEFPortStoreu32( ef_u08_t* pu8dst, ef_u32_t u32value )
   *pu8dst++ = (ef_u08_t)u32value;
   u32value >>= 8;
   *pu8dst++ = (ef_u08_t)u32value;
+#endif
 
   return EF_RET_OK;
 }
@@ -185,6 +205,9 @@ ef_return_et eEFPortStoreu64( ef_u08_t* pu8dst, ef_u64_t u64value )
 {
   EF_ASSERT_PRIVATE( 0 != pu8dst );
 
+#if ( 0 != EF_PORT_LOAD_STORE_NATIVE )
+  (void) memcpy( pu8dst, &u64value, sizeof( u64value ) );
+#else
   *pu8dst++ = (ef_u08_t)u64value;
   u64value >>= 8;
   *pu8dst++ = (ef_u08_t)u64value;
@@ -200,10 +223,10 @@ ef_return_et eEFPortStoreu64( ef_u08_t* pu8dst, ef_u64_t u64value )
   *pu8dst++ = (ef_u08_t)u64value;
   u64value >>= 8;
   *pu8dst++ = (ef_u08_t)u64value;
+#endif
 
   return EF_RET_OK;
 }
 
-
 /* ***************************************************************************************************************** */
 /* END OF FILE ***************************************************************************************************** */
@@ -32,16 +32,80 @@
 /* Includes -------------------------------------------------------------------------------------------------------- */
 #include <ef_prv_def.h>
 #include "ef_port_types.h"
+#include "ef_port_memory.h"
 
 /* Local constant macros ------------------------------------------------------------------------------------------- */
+
+#define EF_PORT_MEM_WORD_SIZE ( sizeof( ef_u32_t ) )        /**< Size of the words handled by the memory loops */
+#define EF_PORT_MEM_WORD_MASK ( EF_PORT_MEM_WORD_SIZE - 1 ) /**< Mask of the offset in a word */
+
 /* Local function macros ------------------------------------------------------------------------------------------- */
+
+/**
+ *  Offset of a pointer in a word
+ */
+#define EF_PORT_MEM_MISALIGN( pv )  ( (ef_uptr_t) ( pv ) & EF_PORT_MEM_WORD_MASK )
+
 /* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
+
+#if ( 0 != EF_CONF_PORT_MEM_WORD )
+/**
+ *  Word of the memory loops, it is accessed at aligned addresses and may alias the bytes of the buffers
+ */
+typedef ef_u32_t __attribute__ ((may_alias)) ef_port_mem_word_t;
+#endif
+
 /* Local variables ------------------------------------------------------------------------------------------------- */
+
+#if ( 0 != EF_CONF_PORT_MEM_DMA )
+/**
+ *  Copy function of the DMA engine registered by the port (0: none)
+ */
+static xMemCopyDma * pxPortMemCopyDma = 0;
+#endif
+
 /* Public variables ------------------------------------------------------------------------------------------------ */
 /* Local function prototypes---------------------------------------------------------------------------------------- */
 /* Local functions ------------------------------------------------------------------------------------------------- */
 /* Public functions ------------------------------------------------------------------------------------------------ */
 
+#if ( 0 != EF_CONF_PORT_MEM_DMA )
+/* Register the copy function of a DMA engine */
+ef_return_et eEFPortMemDmaRegister (
+  xMemCopyDma * pxCopy
+)
+{
+  pxPortMemCopyDma = pxCopy;
+
+  return EF_RET_OK;
+}
+
+/* Copy memory with the DMA engine */
+ef_return_et eEFPortMemCopyDma (
+  const void  * pvSrc,
+  void        * pvDst,
+  ef_u32_t      u32BytesNb
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pvSrc );
+  EF_ASSERT_PRIVATE( 0 != pvDst );
+
+  ef_return_et  eRetVal;
+
+  /* If no engine is registered, the CPU does the copy */
+  if ( 0 == pxPortMemCopyDma )
+  {
+    eRetVal = EF_RET_NOT_ENABLED;
+  }
+  else
+  {
+    eRetVal = pxPortMemCopyDma( pvSrc, pvDst, u32BytesNb );
+  }
+
+  return eRetVal;
+}
+#endif
+
 /* Copy memory to memory */
 ef_return_et eEFPortMemCopy (
   const void  * pvSrc,
@@ -55,6 +119,43 @@ ef_return_et eEFPortMemCopy (
   ef_u08_t       * pu8Dst = (ef_u08_t*) pvDst;
   const ef_u08_t * pu8Src = (const ef_u08_t*) pvSrc;
 
+#if ( 0 != EF_CONF_PORT_MEM_DMA )
+  /* If the copy is large enough for the DMA engine and it did it */
+  if (    ( EF_CONF_PORT_MEM_DMA <= u32BytesNb )
+       && ( EF_RET_OK == eEFPortMemCopyDma( pvSrc, pvDst, u32BytesNb ) ) )
+  {
+    u32BytesNb = 0;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+#endif
+#if ( 0 != EF_CONF_PORT_MEM_WORD )
+  /* If both buffers reach a word boundary together */
+  if (    ( EF_PORT_MEM_WORD_SIZE <= u32BytesNb )
+       && ( EF_PORT_MEM_MISALIGN( pu8Src ) == EF_PORT_MEM_MISALIGN( pu8Dst ) ) )
+  {
+    /* Head bytes */
+    for ( ; 0 != EF_PORT_MEM_MISALIGN( pu8Dst ) ; u32BytesNb-- )
+    {
+      *pu8Dst++ = *pu8Src++;
+    }
+    /* Both buffers are now word aligned */
+    for ( ; EF_PORT_MEM_WORD_SIZE <= u32BytesNb ; u32BytesNb -= EF_PORT_MEM_WORD_SIZE )
+    {
+      *(ef_port_mem_word_t *) pu8Dst = *(const ef_port_mem_word_t *) pu8Src;
+      pu8Src += EF_PORT_MEM_WORD_SIZE;
+      pu8Dst += EF_PORT_MEM_WORD_SIZE;
+    }
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+#endif
+
+  /* Remaining bytes */
   for ( ef_u32_t i = u32BytesNb ; 0 != i ; i-- )
   {
     *pu8Dst++ = *pu8Src++;
@@ -71,14 +172,7 @@ ef_return_et eEFPortMemZero (
 {
   EF_ASSERT_PRIVATE( 0 != pvDst );
 
-  ef_u08_t * pu8Dst = (ef_u08_t*) pvDst;
-
-  for ( ef_u32_t i = u32BytesNb ; 0 != i ; i-- )
-  {
-    *pu8Dst++ = 0;
-  }
-
-  return EF_RET_OK;
+  return eEFPortMemSet( pvDst, 0, u32BytesNb );
 }
 
 /* Fill memory block */
@@ -92,6 +186,31 @@ ef_return_et eEFPortMemSet (
 
   ef_u08_t * pu8Dst = (ef_u08_t*) pvDst;
 
+#if ( 0 != EF_CONF_PORT_MEM_WORD )
+  /* If the buffer holds a whole word */
+  if ( ( 2 * EF_PORT_MEM_WORD_SIZE ) <= u32BytesNb )
+  {
+    ef_u32_t  u32Value = (ef_u32_t) u8Value * (ef_u32_t) 0x01010101UL;
+
+    /* Head bytes */
+    for ( ; 0 != EF_PORT_MEM_MISALIGN( pu8Dst ) ; u32BytesNb-- )
+    {
+      *pu8Dst++ = u8Value;
+    }
+    /* The buffer is now word aligned */
+    for ( ; EF_PORT_MEM_WORD_SIZE <= u32BytesNb ; u32BytesNb -= EF_PORT_MEM_WORD_SIZE )
+    {
+      *(ef_port_mem_word_t *) pu8Dst = u32Value;
+      pu8Dst += EF_PORT_MEM_WORD_SIZE;
+    }
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+#endif
+
+  /* Remaining bytes */
   for ( ef_u32_t i = u32BytesNb ; 0 != i ; i-- )
   {
     *pu8Dst++ = u8Value;
@@ -114,14 +233,46 @@ ef_return_et eEFPortMemCompare (
   const ef_u08_t *pu8BufferA = (const ef_u08_t *) pvBufferA;
   const ef_u08_t *pu8BufferB = (const ef_u08_t *) pvBufferB;
 
-  do
+#if ( 0 != EF_CONF_PORT_MEM_WORD )
+  /* If both buffers reach a word boundary together */
+  if (    ( EF_PORT_MEM_WORD_SIZE <= u32Count )
+       && ( EF_PORT_MEM_MISALIGN( pu8BufferA ) == EF_PORT_MEM_MISALIGN( pu8BufferB ) ) )
   {
-    if ( 0 != ( *pu8BufferA++ - *pu8BufferB++ ) )
+    /* Head bytes */
+    for ( ; 0 != EF_PORT_MEM_MISALIGN( pu8BufferA ) ; u32Count-- )
+    {
+      if ( *pu8BufferA++ != *pu8BufferB++ )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+        break;
+      }
+    }
+    /* Both buffers are now word aligned, a difference leaves its word to the byte loop */
+    for ( ; ( EF_RET_OK == eRetVal ) && ( EF_PORT_MEM_WORD_SIZE <= u32Count ) ; u32Count -= EF_PORT_MEM_WORD_SIZE )
+    {
+      if ( *(const ef_port_mem_word_t *) pu8BufferA != *(const ef_port_mem_word_t *) pu8BufferB )
+      {
+        break;
+      }
+      pu8BufferA += EF_PORT_MEM_WORD_SIZE;
+      pu8BufferB += EF_PORT_MEM_WORD_SIZE;
+    }
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+#endif
+
+  /* Remaining bytes */
+  for ( ; ( EF_RET_OK == eRetVal ) && ( 0 != u32Count ) ; u32Count-- )
+  {
+    if ( *pu8BufferA++ != *pu8BufferB++ )
     {
       eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
       break;
     }
-  } while ( 0 != (--u32Count) );
+  }
 
   return eRetVal;
 }
@@ -29,13 +29,23 @@
 #include "ef_prv_def.h"
 #include "stdio.h"
 
+#if ( EF_DEF_PORT_SYSTEM_BARE == EF_CONF_PORT_SYSTEM )
 /* FreeRTOS */
 //static const EF_SYNC_t xffSyncObjects[ EF_CONF_VOLUMES_NB ];  /** Table of FreeRTOS mutex */
 /* CMSIS-RTOS */
 //static const EF_SYNC_t xffSyncObjects[ EF_CONF_VOLUMES_NB ];  /** Table of CMSIS-RTOS mutex */
 /* DEFAULT NO RTOS */
 //const EF_SYNC_t xffSyncObjects[ EF_CONF_VOLUMES_NB ] = { 0 };
-ef_u08_t u8ffSyncObjects[ EF_CONF_VOLUMES_NB ] = { 0 };
+/* DEFAULT NO RTOS:  0 free, EF_PORT_SYNC_EXCLUSIVE taken exclusive, else number of shared holders */
+ef_u08_t u8ffSyncObjects[ EF_PORT_SYNC_OBJECTS_NB ] = { 0 };
+
+/**
+ *  Sync object value when taken exclusive (no RTOS)
+ */
+#define EF_PORT_SYNC_EXCLUSIVE  ( 0xFF )
+
+/* DEFAULT NO RTOS: a single task */
+static void * pvPortTaskBuffer = 0;
 
 /* Create a Synchronization Object */
 ef_return_et eEFPortSyncObjectCreate (
@@ -103,7 +113,7 @@ ef_return_et eEFPortSyncObjectTake (
   /* DEFAULT NO RTOS */
   if ( 0 == *xSyncObject )
   {
-    *xSyncObject = 1;
+    *xSyncObject = EF_PORT_SYNC_EXCLUSIVE;
   }
   else
   {
@@ -127,9 +137,53 @@ ef_return_et eEFPortSyncObjectGive (
 //  osMutexRelease(xSyncObject);
 
   /* DEFAULT NO RTOS */
-  if ( 0 < *xSyncObject )
+  if ( EF_PORT_SYNC_EXCLUSIVE == *xSyncObject )
+  {
+    *xSyncObject = 0;
+  }
+  else
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+  }
+  return eRetVal;
+}
+
+
+/* Request Shared Grant to Access the Volume */
+ef_return_et eEFPortSyncObjectTakeShared (
+  EF_SYNC_t xSyncObject
+)
+{
+  ef_return_et eRetVal = EF_RET_OK;
+
+  /* RTOS: reader-writer lock, or a mutex protected reader counter with
+   * the volume mutex taken by the first reader and given by the last one */
+
+  /* DEFAULT NO RTOS */
+  if ( ( EF_PORT_SYNC_EXCLUSIVE - 1 ) > *xSyncObject )
+  {
+    *xSyncObject += 1;
+  }
+  else
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+  }
+  return eRetVal;
+}
+
+
+/* Release Shared Grant to Access the Volume */
+ef_return_et eEFPortSyncObjectGiveShared (
+  EF_SYNC_t xSyncObject
+)
+{
+  ef_return_et eRetVal = EF_RET_OK;
+
+  /* DEFAULT NO RTOS */
+  if (    ( 0 < *xSyncObject )
+       && ( EF_PORT_SYNC_EXCLUSIVE > *xSyncObject ) )
   {
-    *((ef_u08_t**) xSyncObject ) -= 1;
+    *xSyncObject -= 1;
   }
   else
   {
@@ -138,6 +192,84 @@ ef_return_et eEFPortSyncObjectGive (
   return eRetVal;
 }
 
+/* Enter a short critical section */
+ef_return_et eEFPortCriticalSectionEnter (
+  void
+)
+{
+  /* FreeRTOS */
+//  taskENTER_CRITICAL();
+
+  /* CMSIS-RTOS */
+//  (void) osKernelLock();
+
+  /* DEFAULT NO RTOS */
+  return EF_RET_OK;
+}
+
+
+/* Leave a short critical section */
+ef_return_et eEFPortCriticalSectionExit (
+  void
+)
+{
+  /* FreeRTOS */
+//  taskEXIT_CRITICAL();
+
+  /* CMSIS-RTOS */
+//  (void) osKernelUnlock();
+
+  /* DEFAULT NO RTOS */
+  return EF_RET_OK;
+}
+
+/* Let the other tasks run */
+ef_return_et eEFPortTaskYield (
+  void
+)
+{
+  /* FreeRTOS */
+//  taskYIELD();
+
+  /* CMSIS-RTOS */
+//  (void) osThreadYield();
+
+  /* DEFAULT NO RTOS */
+  return EF_RET_OK;
+}
+
+/* Set the working buffer of the calling task */
+ef_return_et eEFPortTaskBufferSet (
+  void  * pvBuffer
+)
+{
+  /* FreeRTOS */
+//  vTaskSetThreadLocalStoragePointer( NULL, 0, pvBuffer );
+
+  /* DEFAULT NO RTOS */
+  pvPortTaskBuffer = pvBuffer;
+
+  return EF_RET_OK;
+}
+
+/* Get the working buffer of the calling task */
+ef_return_et eEFPortTaskBufferGet (
+  void  **  ppvBuffer
+)
+{
+  EF_ASSERT_PRIVATE( 0 != ppvBuffer );
+
+  /* FreeRTOS */
+//  *ppvBuffer = pvTaskGetThreadLocalStoragePointer( NULL, 0 );
+
+  /* DEFAULT NO RTOS */
+  *ppvBuffer = pvPortTaskBuffer;
+
+  return EF_RET_OK;
+}
+
+#endif /* EF_DEF_PORT_SYSTEM_BARE == EF_CONF_PORT_SYSTEM */
+
 ef_return_et eEFPrvPortAssertFailed (
   char  * pcFile,
   int     iLine
@@ -0,0 +1,689 @@
+/**
+ * ********************************************************************************************************************
+ *  @file     ef_port_systemPosix.c
+ *  @ingroup  group_eFAT_Portable
+ *  @author   ChaN
+ *  @author   Emmanuel AMADIO
+ *  @version  V0.1
+ *  @brief    Code file for POSIX threads OS Dependent Functions for eFAT (host builds).
+ *
+ * ********************************************************************************************************************
+ *  eFAT - embedded FAT Filesystem module
+ * ********************************************************************************************************************
+ *
+ *  Copyright (C) 2021, Amadio Emmanuel, all right reserved.
+ *  Copyright (C) 2019, ChaN, all right reserved.
+ *
+ *  eFAT module is an open source software. Redistribution and use of eFAT in source and binary forms, with or without
+ *  modification, are permitted provided that the following condition is met:
+ *
+ *  Redistributions of source code must retain the above copyright notice, this condition and the following disclaimer.
+ *
+ *  This software is provided by the copyright holders and contributors "AS IS" and any warranties related to this
+ *  software are DISCLAIMED.
+ *  The copyright owners or contributors be NOT LIABLE for any damages caused by use of this software.
+ * ********************************************************************************************************************
+ */
+
+
+/* START OF FILE *************************************************************************************************** */
+/* ***************************************************************************************************************** */
+
+/* Includes -------------------------------------------------------------------------------------------------------- */
+#define _POSIX_C_SOURCE 200809L
+
+#include <efat.h>
+#include "ef_prv_def.h"
+
+#if ( EF_DEF_PORT_SYSTEM_POSIX == EF_CONF_PORT_SYSTEM )
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+/* Local constant macros ------------------------------------------------------------------------------------------- */
+
+#define EF_PORT_NS_PER_MS ( 1000000L )     /**< Nanoseconds in a millisecond */
+#define EF_PORT_NS_PER_S  ( 1000000000L )  /**< Nanoseconds in a second */
+
+/* Local function macros ------------------------------------------------------------------------------------------- */
+/* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
+
+/**
+ *  @brief  POSIX threads sync object structure (ef_port_sync_st)
+ */
+typedef struct ef_port_sync_struct {
+  pthread_mutex_t       xMutex;           /**< Volume lock when EF_CONF_FS_LOCK_SHARED is disabled */
+  pthread_rwlock_t      xRWLock;          /**< Volume lock when EF_CONF_FS_LOCK_SHARED is enabled */
+  ef_bool_t             bCreated;         /**< The lock is initialized */
+  struct timespec       xHoldStart;       /**< Time the exclusive grant was given */
+  struct timespec       xHoldSharedStart; /**< Time the first shared grant was given */
+  ef_u32_t              u32SharedNb;      /**< Number of shared grants held */
+  ef_port_sync_stats_st xStats;           /**< Metrics of the sync object */
+} ef_port_sync_st;
+
+/* Local variables ------------------------------------------------------------------------------------------------- */
+
+/**
+ *  Table of sync objects, one volume lock and one filesystem window lock per volume
+ */
+static ef_port_sync_st xPortSyncObjects[ EF_PORT_SYNC_OBJECTS_NB ];
+
+/**
+ *  Mutex protecting the metrics and the shared grants counters of all the sync objects
+ */
+static pthread_mutex_t xPortSyncStatsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ *  Mutex of the critical sections
+ */
+static pthread_mutex_t xPortCriticalMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ *  Key of the working buffer of each thread
+ */
+static pthread_key_t xPortTaskBufferKey;
+
+/**
+ *  Creation of the key of the working buffer of each thread
+ */
+static pthread_once_t xPortTaskBufferOnce = PTHREAD_ONCE_INIT;
+
+/* Public variables ------------------------------------------------------------------------------------------------ */
+/* Local function prototypes---------------------------------------------------------------------------------------- */
+
+/**
+ *  @brief  Get the time elapsed since a monotonic time stamp
+ *
+ *  @param  pxStart       Pointer to the time stamp
+ *  @param  pu32Elapsed   Pointer to the elapsed time in microseconds (saturated)
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK     Success
+ */
+static ef_return_et eEFPortTimeElapsed (
+  const struct timespec * pxStart,
+  ef_u32_t              * pu32Elapsed
+);
+
+/**
+ *  @brief  Wait for a grant of a sync object within EF_CONF_TIMEOUT milliseconds and record the metrics
+ *
+ *  @param  pxSync    Pointer to the sync object
+ *  @param  bShared   Request the shared grant
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK         Success
+ *  @retval EF_RET_TIMEOUT    The grant was not given in time
+ *  @retval EF_RET_SYS_ERROR  An error occurred
+ */
+static ef_return_et eEFPortSyncAcquire (
+  ef_port_sync_st * pxSync,
+  ef_bool_t         bShared
+);
+
+/**
+ *  @brief  Release a grant of a sync object and record the metrics
+ *
+ *  @param  pxSync    Pointer to the sync object
+ *  @param  bShared   Release the shared grant
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK         Success
+ *  @retval EF_RET_SYS_ERROR  An error occurred
+ */
+static ef_return_et eEFPortSyncRelease (
+  ef_port_sync_st * pxSync,
+  ef_bool_t         bShared
+);
+
+/**
+ *  @brief  Create the key of the working buffer of each thread, once
+ */
+static void vEFPortTaskBufferKeyCreate (
+  void
+);
+
+/* Local functions ------------------------------------------------------------------------------------------------- */
+
+/* Create the key of the working buffer of each thread */
+static void vEFPortTaskBufferKeyCreate (
+  void
+)
+{
+  (void) pthread_key_create( &xPortTaskBufferKey, 0 );
+}
+
+/* Get the time elapsed since a monotonic time stamp */
+static ef_return_et eEFPortTimeElapsed (
+  const struct timespec * pxStart,
+  ef_u32_t              * pu32Elapsed
+)
+{
+  struct timespec xNow;
+  ef_u64_t        u64Elapsed;
+
+  (void) clock_gettime( CLOCK_MONOTONIC, &xNow );
+  u64Elapsed  = (ef_u64_t) ( xNow.tv_sec - pxStart->tv_sec ) * 1000000u;
+  u64Elapsed += (ef_u64_t) ( ( xNow.tv_nsec - pxStart->tv_nsec ) / 1000 );
+  if ( 0xFFFFFFFFu < u64Elapsed )
+  {
+    *pu32Elapsed = 0xFFFFFFFFu;
+  }
+  else
+  {
+    *pu32Elapsed = (ef_u32_t) u64Elapsed;
+  }
+
+  return EF_RET_OK;
+}
+
+/* Wait for a grant of a sync object and record the metrics */
+static ef_return_et eEFPortSyncAcquire (
+  ef_port_sync_st * pxSync,
+  ef_bool_t         bShared
+)
+{
+  ef_return_et    eRetVal = EF_RET_OK;
+  ef_bool_t       bContended = EF_BOOL_FALSE;
+  struct timespec xStart;
+  struct timespec xDeadline;
+  ef_u32_t        u32Waited;
+  int             iResult;
+
+  (void) clock_gettime( CLOCK_MONOTONIC, &xStart );
+
+  /* A free lock is taken at once, the wait only starts on contention */
+  if ( 0 == EF_CONF_FS_LOCK_SHARED )
+  {
+    iResult = pthread_mutex_trylock( &pxSync->xMutex );
+  }
+  else if ( EF_BOOL_FALSE == bShared )
+  {
+    iResult = pthread_rwlock_trywrlock( &pxSync->xRWLock );
+  }
+  else
+  {
+    iResult = pthread_rwlock_tryrdlock( &pxSync->xRWLock );
+  }
+
+  if ( EBUSY == iResult )
+  {
+    bContended = EF_BOOL_TRUE;
+    /* Timed functions expect an absolute CLOCK_REALTIME deadline */
+    (void) clock_gettime( CLOCK_REALTIME, &xDeadline );
+    xDeadline.tv_sec  += EF_CONF_TIMEOUT / 1000;
+    xDeadline.tv_nsec += ( EF_CONF_TIMEOUT % 1000 ) * EF_PORT_NS_PER_MS;
+    if ( EF_PORT_NS_PER_S <= xDeadline.tv_nsec )
+    {
+      xDeadline.tv_sec  += 1;
+      xDeadline.tv_nsec -= EF_PORT_NS_PER_S;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    if ( 0 == EF_CONF_FS_LOCK_SHARED )
+    {
+      iResult = pthread_mutex_timedlock( &pxSync->xMutex, &xDeadline );
+    }
+    else if ( EF_BOOL_FALSE == bShared )
+    {
+      iResult = pthread_rwlock_timedwrlock( &pxSync->xRWLock, &xDeadline );
+    }
+    else
+    {
+      iResult = pthread_rwlock_timedrdlock( &pxSync->xRWLock, &xDeadline );
+    }
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  if ( 0 == iResult )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( ETIMEDOUT == iResult )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_TIMEOUT );
+  }
+  else
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_SYS_ERROR );
+  }
+
+  if ( 0 != EF_CONF_PORT_SYNC_STATS )
+  {
+    (void) eEFPortTimeElapsed( &xStart, &u32Waited );
+    (void) pthread_mutex_lock( &xPortSyncStatsMutex );
+    if ( EF_BOOL_FALSE != bContended )
+    {
+      pxSync->xStats.u32ContentionNb++;
+      pxSync->xStats.u64WaitTotal += u32Waited;
+      if ( pxSync->xStats.u32WaitMax < u32Waited )
+      {
+        pxSync->xStats.u32WaitMax = u32Waited;
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    if ( EF_RET_TIMEOUT == eRetVal )
+    {
+      pxSync->xStats.u32TimeoutNb++;
+    }
+    else if ( EF_RET_OK != eRetVal )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    else if ( ( 0 == EF_CONF_FS_LOCK_SHARED ) || ( EF_BOOL_FALSE == bShared ) )
+    {
+      pxSync->xStats.u32TakeNb++;
+      (void) clock_gettime( CLOCK_MONOTONIC, &pxSync->xHoldStart );
+    }
+    else
+    {
+      pxSync->xStats.u32TakeSharedNb++;
+      /* The first shared holder opens the shared hold period */
+      if ( 0 == pxSync->u32SharedNb++ )
+      {
+        (void) clock_gettime( CLOCK_MONOTONIC, &pxSync->xHoldSharedStart );
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+    }
+    (void) pthread_mutex_unlock( &xPortSyncStatsMutex );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  return eRetVal;
+}
+
+/* Release a grant of a sync object and record the metrics */
+static ef_return_et eEFPortSyncRelease (
+  ef_port_sync_st * pxSync,
+  ef_bool_t         bShared
+)
+{
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u32_t      u32Held;
+  int           iResult;
+
+  /* Hold time is recorded while the grant is still held */
+  if ( 0 != EF_CONF_PORT_SYNC_STATS )
+  {
+    (void) pthread_mutex_lock( &xPortSyncStatsMutex );
+    if ( ( 0 == EF_CONF_FS_LOCK_SHARED ) || ( EF_BOOL_FALSE == bShared ) )
+    {
+      (void) eEFPortTimeElapsed( &pxSync->xHoldStart, &u32Held );
+      pxSync->xStats.u64HoldTotal += u32Held;
+      if ( pxSync->xStats.u32HoldMax < u32Held )
+      {
+        pxSync->xStats.u32HoldMax = u32Held;
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+    }
+    /* The last shared holder closes the shared hold period */
+    else if (    ( 0 != pxSync->u32SharedNb )
+              && ( 0 == --pxSync->u32SharedNb ) )
+    {
+      (void) eEFPortTimeElapsed( &pxSync->xHoldSharedStart, &u32Held );
+      pxSync->xStats.u64HoldSharedTotal += u32Held;
+      if ( pxSync->xStats.u32HoldSharedMax < u32Held )
+      {
+        pxSync->xStats.u32HoldSharedMax = u32Held;
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    (void) pthread_mutex_unlock( &xPortSyncStatsMutex );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  if ( 0 == EF_CONF_FS_LOCK_SHARED )
+  {
+    iResult = pthread_mutex_unlock( &pxSync->xMutex );
+  }
+  else
+  {
+    iResult = pthread_rwlock_unlock( &pxSync->xRWLock );
+  }
+  if ( 0 != iResult )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_SYS_ERROR );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  return eRetVal;
+}
+
+/* Public functions ------------------------------------------------------------------------------------------------ */
+
+/* Get RTC Time in FAT file system formating style */
+ef_u32_t u32EFPortFatTimeGet (
+  void
+)
+{
+  time_t    xTime = time( 0 );
+  struct tm xLocal;
+
+  (void) localtime_r( &xTime, &xLocal );
+
+  return   ( (ef_u32_t) ( xLocal.tm_year - 80 ) << 25 )
+         | ( (ef_u32_t) ( xLocal.tm_mon + 1 )   << 21 )
+         | ( (ef_u32_t) xLocal.tm_mday          << 16 )
+         | ( (ef_u32_t) xLocal.tm_hour          << 11 )
+         | ( (ef_u32_t) xLocal.tm_min           <<  5 )
+         | ( (ef_u32_t) xLocal.tm_sec           >>  1 );
+}
+
+/* Create a Synchronization Object */
+ef_return_et eEFPortSyncObjectCreate (
+  ef_u08_t    u8Volume,
+  EF_SYNC_t * pxSyncObject
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxSyncObject );
+
+  ef_return_et      eRetVal = EF_RET_OK;
+  ef_port_sync_st * pxSync;
+  int               iResult;
+
+  if ( EF_PORT_SYNC_OBJECTS_NB <= u8Volume )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_PARAMETER );
+  }
+  else
+  {
+    pxSync = &xPortSyncObjects[ u8Volume ];
+    /* Volume remounted without unmount */
+    if ( EF_BOOL_FALSE != pxSync->bCreated )
+    {
+      (void) eEFPortSyncObjectDelete( pxSync );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    if ( 0 == EF_CONF_FS_LOCK_SHARED )
+    {
+      iResult = pthread_mutex_init( &pxSync->xMutex, 0 );
+    }
+    else
+    {
+      iResult = pthread_rwlock_init( &pxSync->xRWLock, 0 );
+    }
+    if ( 0 != iResult )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_SYS_ERROR );
+    }
+    else
+    {
+      pxSync->u32SharedNb = 0;
+      pxSync->bCreated    = EF_BOOL_TRUE;
+      *pxSyncObject       = pxSync;
+    }
+  }
+
+  return eRetVal;
+}
+
+/* Delete a Synchronization Object */
+ef_return_et eEFPortSyncObjectDelete (
+  EF_SYNC_t xSyncObject
+)
+{
+  EF_ASSERT_PRIVATE( 0 != xSyncObject );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  int           iResult;
+
+  if ( EF_BOOL_FALSE == xSyncObject->bCreated )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else
+  {
+    if ( 0 == EF_CONF_FS_LOCK_SHARED )
+    {
+      iResult = pthread_mutex_destroy( &xSyncObject->xMutex );
+    }
+    else
+    {
+      iResult = pthread_rwlock_destroy( &xSyncObject->xRWLock );
+    }
+    xSyncObject->bCreated = EF_BOOL_FALSE;
+    if ( 0 != iResult )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_SYS_ERROR );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+
+  return eRetVal;
+}
+
+/* Request Grant to Access the Volume */
+ef_return_et eEFPortSyncObjectTake (
+  EF_SYNC_t xSyncObject
+)
+{
+  EF_ASSERT_PRIVATE( 0 != xSyncObject );
+
+  return eEFPortSyncAcquire( xSyncObject, EF_BOOL_FALSE );
+}
+
+/* Release Grant to Access the Volume */
+ef_return_et eEFPortSyncObjectGive (
+  EF_SYNC_t xSyncObject
+)
+{
+  EF_ASSERT_PRIVATE( 0 != xSyncObject );
+
+  return eEFPortSyncRelease( xSyncObject, EF_BOOL_FALSE );
+}
+
+/* Request Shared Grant to Access the Volume */
+ef_return_et eEFPortSyncObjectTakeShared (
+  EF_SYNC_t xSyncObject
+)
+{
+  EF_ASSERT_PRIVATE( 0 != xSyncObject );
+
+  /* Exclusive grant when the sync object is a mutex (EF_CONF_FS_LOCK_SHARED disabled) */
+  return eEFPortSyncAcquire( xSyncObject, EF_BOOL_TRUE );
+}
+
+/* Release Shared Grant to Access the Volume */
+ef_return_et eEFPortSyncObjectGiveShared (
+  EF_SYNC_t xSyncObject
+)
+{
+  EF_ASSERT_PRIVATE( 0 != xSyncObject );
+
+  return eEFPortSyncRelease( xSyncObject, EF_BOOL_TRUE );
+}
+
+/* Enter a short critical section */
+ef_return_et eEFPortCriticalSectionEnter (
+  void
+)
+{
+  ef_return_et eRetVal = EF_RET_OK;
+
+  if ( 0 != pthread_mutex_lock( &xPortCriticalMutex ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_SYS_ERROR );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  return eRetVal;
+}
+
+/* Leave a short critical section */
+ef_return_et eEFPortCriticalSectionExit (
+  void
+)
+{
+  ef_return_et eRetVal = EF_RET_OK;
+
+  if ( 0 != pthread_mutex_unlock( &xPortCriticalMutex ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_SYS_ERROR );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  return eRetVal;
+}
+
+/* Let the other tasks run */
+ef_return_et eEFPortTaskYield (
+  void
+)
+{
+  ef_return_et eRetVal = EF_RET_OK;
+
+  if ( 0 != sched_yield( ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_SYS_ERROR );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  return eRetVal;
+}
+
+/* Set the working buffer of the calling task */
+ef_return_et eEFPortTaskBufferSet (
+  void  * pvBuffer
+)
+{
+  ef_return_et eRetVal = EF_RET_OK;
+
+  if ( 0 != pthread_once( &xPortTaskBufferOnce, vEFPortTaskBufferKeyCreate ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_SYS_ERROR );
+  }
+  else if ( 0 != pthread_setspecific( xPortTaskBufferKey, pvBuffer ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_SYS_ERROR );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  return eRetVal;
+}
+
+/* Get the working buffer of the calling task */
+ef_return_et eEFPortTaskBufferGet (
+  void  **  ppvBuffer
+)
+{
+  EF_ASSERT_PRIVATE( 0 != ppvBuffer );
+
+  ef_return_et eRetVal = EF_RET_OK;
+
+  if ( 0 != pthread_once( &xPortTaskBufferOnce, vEFPortTaskBufferKeyCreate ) )
+  {
+    *ppvBuffer = 0;
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_SYS_ERROR );
+  }
+  else
+  {
+    *ppvBuffer = pthread_getspecific( xPortTaskBufferKey );
+  }
+
+  return eRetVal;
+}
+
+/* Get the metrics of a sync object */
+ef_return_et eEFPortSyncStatsGet (
+  ef_u08_t                u8SyncId,
+  ef_port_sync_stats_st * pxStats
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxStats );
+
+  ef_return_et eRetVal = EF_RET_OK;
+
+  if ( EF_PORT_SYNC_OBJECTS_NB <= u8SyncId )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_PARAMETER );
+  }
+  else
+  {
+    (void) pthread_mutex_lock( &xPortSyncStatsMutex );
+    *pxStats = xPortSyncObjects[ u8SyncId ].xStats;
+    (void) pthread_mutex_unlock( &xPortSyncStatsMutex );
+  }
+
+  return eRetVal;
+}
+
+/* Reset the metrics of a sync object */
+ef_return_et eEFPortSyncStatsReset (
+  ef_u08_t  u8SyncId
+)
+{
+  ef_return_et eRetVal = EF_RET_OK;
+
+  if ( EF_PORT_SYNC_OBJECTS_NB <= u8SyncId )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_PARAMETER );
+  }
+  else
+  {
+    (void) pthread_mutex_lock( &xPortSyncStatsMutex );
+    xPortSyncObjects[ u8SyncId ].xStats = (ef_port_sync_stats_st) { 0 };
+    /* Grants held keep their time stamps, the periods in progress are recorded at release */
+    (void) pthread_mutex_unlock( &xPortSyncStatsMutex );
+  }
+
+  return eRetVal;
+}
+
+#endif /* EF_DEF_PORT_SYSTEM_POSIX == EF_CONF_PORT_SYSTEM */
+
+/* ***************************************************************************************************************** */
+/* END OF FILE ***************************************************************************************************** */
@@ -66,7 +66,7 @@ ef_return_et eEFPrvNameCreateVFAT (
 #if ( 0 != EF_CONF_VFAT )
   ef_u08_t b;
   ef_u08_t cf;
-  ucs2_t  u16Char;
+  ucs2_t  u16Char = 0;
   ef_u32_t    i;
   ef_u32_t    ni;
   /* Create LFN into LFN working buffer */
@@ -74,7 +74,10 @@ ef_return_et eEFPrvNameCreateVFAT (
   ucs2_t      * lfn;
   ef_u32_t      di      = 0;
 
-  (void) EF_LFN_BUFFER_GET( pxDir->xObject.pxFS, lfn );
+  if ( EF_RET_OK != EF_LFN_BUFFER_GET( pxDir->xObject.pxFS, &lfn ) )
+  {
+    return EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
   /*
    * Create LFN segment until a separator or end of line is found
    */
@@ -82,7 +85,7 @@ ef_return_et eEFPrvNameCreateVFAT (
   {
     /* Get a character in UTF16 from current API encoding */
     ef_u32_t uc;
-    (void) u32xCharToUnicodes( &pxPath, &uc );
+    (void) eEFPrvu32xCharToUnicode( &pxPath, &uc );
     /* If code is invalid */
     if ( 0xFFFFFFFF == uc )
     {
@@ -159,7 +162,7 @@ ef_return_et eEFPrvNameCreateVFAT (
                    && ( '.' == lfn[ di - 1 ] ) )
               || (    ( 2 == di )
                    && ( '.' == lfn[ di - 1 ] )
-                   && ( '.' == lfn[ di - 1 ] ) ) ) )
+                   && ( '.' == lfn[ di - 2 ] ) ) ) )
     {
       lfn[ di ] = 0;
       /* Create dot name for SFN entry */
@@ -275,7 +278,7 @@ ef_return_et eEFPrvNameCreateVFAT (
         /* LFN entry needs to be created */
         cf |= EF_NS_LFN;
         /* Unicode ==> Upper convert ==> ANSI/OEM code */
-        u16Char = u16ffUnicodeToUpperANSIOEM( u16Char );
+        (void) eEFPrvUnicodeToUpperANSIOEM( u16Char, &u16Char );
       }
 
       /* Is this a DBC? */
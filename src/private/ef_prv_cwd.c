@@ -0,0 +1,514 @@
+/**
+ * ********************************************************************************************************************
+ *  @file     ef_prv_cwd.c
+ *  @ingroup  group_eFAT_Private
+ *  @author   ChaN
+ *  @author   Emmanuel AMADIO
+ *  @version  V0.1
+ *  @brief    Current directory path resolution and cache.
+ *
+ * ********************************************************************************************************************
+ *  eFAT - embedded FAT Filesystem module
+ * ********************************************************************************************************************
+ *
+ *  Copyright (C) 2021, Amadio Emmanuel, all right reserved.
+ *  Copyright (C) 2019, ChaN, all right reserved.
+ *
+ *  eFAT module is an open source software. Redistribution and use of eFAT in source and binary forms, with or without
+ *  modification, are permitted provided that the following condition is met:
+ *
+ *  Redistributions of source code must retain the above copyright notice, this condition and the following disclaimer.
+ *
+ *  This software is provided by the copyright holders and contributors "AS IS" and any warranties related to this
+ *  software are DISCLAIMED.
+ *  The copyright owners or contributors be NOT LIABLE for any damages caused by use of this software.
+ * ********************************************************************************************************************
+ */
+
+/* START OF FILE *************************************************************************************************** */
+/* ***************************************************************************************************************** */
+
+/* Includes -------------------------------------------------------------------------------------------------------- */
+#include <efat.h>
+#include "ef_prv_def.h"
+#include "ef_prv_cwd.h"
+#include "ef_prv_directory.h"
+#include "ef_prv_dirfunc.h"
+#include "ef_prv_file.h"
+#include "ef_prv_fs_window.h"
+
+/* Local constant macros ------------------------------------------------------------------------------------------- */
+/* Local function macros ------------------------------------------------------------------------------------------- */
+/* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
+/* Local variables ------------------------------------------------------------------------------------------------- */
+/* Public variables ------------------------------------------------------------------------------------------------ */
+/* Local function prototypes---------------------------------------------------------------------------------------- */
+/* Local functions ------------------------------------------------------------------------------------------------- */
+/* Public functions ------------------------------------------------------------------------------------------------ */
+
+/* Resolve the current directory path */
+ef_return_et eEFPrvCwdResolve (
+  ef_fs_st  * pxFS,
+  TCHAR     * pxString,
+  ef_u32_t    u32Size,
+  ef_u32_t  * pu32Index,
+  ef_u32_t  * pu32Clusters,
+  ef_u32_t    u32ClustersNb,
+  ef_u32_t  * pu32Depth
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+  EF_ASSERT_PRIVATE( 0 != pxString );
+  EF_ASSERT_PRIVATE( 0 != pu32Index );
+
+  ef_return_et    eRetVal = EF_RET_OK;
+  ef_directory_st xDir;
+  ef_file_info_st xFileInfo;
+  ef_u32_t        u32ClstChild;
+  ef_u32_t        u32Depth = 0;
+  ef_u32_t        i = u32Size;  /* Bottom of the string (directory stack base) */
+  ef_u32_t        n;
+
+  xDir.xObject.pxFS = pxFS;
+  /* Start to follow upper directory from current directory */
+  xDir.xObject.u32ClstStart = pxFS->u32DirClstCurrent;
+
+  /* Repeat while current directory is a sub-directory */
+  while (    ( EF_RET_OK == eRetVal )
+          && ( 0 != xDir.xObject.u32ClstStart ) )
+  {
+    u32ClstChild = xDir.xObject.u32ClstStart;
+
+    /* If directory clusters are requested and the directory clusters array is not full */
+    if (    ( 0 != pu32Clusters )
+         && ( u32Depth < u32ClustersNb ) )
+    {
+      pu32Clusters[ u32Depth ] = u32ClstChild;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    u32Depth++;
+
+    /* If getting the .. entry of the child directory failed */
+    if ( EF_RET_OK != eEFPrvDirectoryIndexSet( &xDir, 1 * EF_DIR_ENTRY_SIZE ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+    }
+    else if ( EF_RET_OK != eEFPrvFSWindowLoad( pxFS, xDir.xSector ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+    }
+    /* Else, if going to the parent directory failed */
+    else if ( EF_RET_OK != eEFPrvDirectoryClusterGet( pxFS, xDir.pu8Dir, &(xDir.xObject.u32ClstStart) ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+    }
+    else if ( EF_RET_OK != eEFPrvDirectoryIndexSet( &xDir, 0 ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+    }
+    else
+    {
+      /* Find the entry links to the child directory */
+      do
+      {
+        ef_bool_t bEmpty = EF_BOOL_FALSE;
+        ef_bool_t bStretched = EF_BOOL_FALSE;
+        ef_bool_t bMoved = EF_BOOL_FALSE;
+        ef_u32_t  u32Cluster;
+
+        eRetVal = eEFPrvDirRead( &xDir, &bEmpty );
+        if ( EF_RET_OK != eRetVal )
+        {
+          break;
+        }
+        else if ( EF_RET_OK != eEFPrvDirectoryClusterGet( pxFS, xDir.pu8Dir, &u32Cluster ) )
+        {
+          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+        }
+        else if ( u32ClstChild == u32Cluster )
+        {
+          /* Found the entry */
+          break;
+        }
+        else
+        {
+          eRetVal = eEFPrvDirectoryIndexNext( &xDir, EF_BOOL_FALSE, &bStretched, &bMoved );
+        }
+      } while ( EF_RET_OK == eRetVal );
+
+      if ( EF_RET_NO_FILE == eRetVal )
+      {
+        /* It cannot be 'not found'. */
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      }
+    }
+
+    if ( EF_RET_OK != eRetVal )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    /* Else, if getting the directory name failed */
+    else if ( EF_RET_OK != eEFPrvDirFileInfosGet( &xDir, &xFileInfo ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+    }
+    else
+    {
+      /* Name length */
+      for ( n = 0 ; 0 != xFileInfo.xName[ n ] ; n++ ) ;
+      /* Insufficient space to store the path name? */
+      if ( i < ( n + 1 ) )
+      {
+        eRetVal = EF_RET_NOT_ENOUGH_CORE;
+      }
+      else
+      {
+        while ( 0 != n )
+        {
+          /* Stack the name */
+          pxString[ --i ] = xFileInfo.xName[ --n ];
+        }
+        pxString[ --i ] = '/';
+      }
+    }
+  }
+
+  if ( EF_RET_OK != eRetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if it is the root-directory */
+  else if ( i == u32Size )
+  {
+    if ( 0 == i )
+    {
+      eRetVal = EF_RET_NOT_ENOUGH_CORE;
+    }
+    else
+    {
+      pxString[ --i ] = '/';
+    }
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  *pu32Index = i;
+  if ( 0 != pu32Depth )
+  {
+    *pu32Depth = u32Depth;
+  }
+
+  return eRetVal;
+}
+
+/* Start recording the path followed by eEF_chdir() */
+ef_return_et eEFPrvCwdCacheStart (
+  ef_fs_st    * pxFS,
+  const TCHAR * pxPath
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+  EF_ASSERT_PRIVATE( 0 != pxPath );
+
+#if ( 2 == EF_CONF_RELATIVE_PATH ) && ( 0 != EF_CONF_CWD_CACHE_SIZE )
+  /* If the path starts from the root directory */
+  if (    ( '/' == *pxPath )
+       || ( '\\' == *pxPath )
+       || ( 0 == pxFS->u32DirClstCurrent ) )
+  {
+    pxFS->xCwdPath[ 0 ] = '/';
+    pxFS->xCwdPath[ 1 ] = 0;
+    pxFS->u8CwdDepth = 0;
+    pxFS->bCwdValid = EF_BOOL_TRUE;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+  pxFS->bCwdFollow = EF_BOOL_TRUE;
+#else
+  (void) pxPath;
+#endif
+
+  return EF_RET_OK;
+}
+
+/* Record a segment found by eEFPrvPathFollow() */
+ef_return_et eEFPrvCwdCacheFollow (
+  ef_directory_st * pxDir
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxDir );
+
+  ef_return_et    eRetVal = EF_RET_OK;
+
+#if ( 2 == EF_CONF_RELATIVE_PATH ) && ( 0 != EF_CONF_CWD_CACHE_SIZE )
+  ef_fs_st        * pxFS = pxDir->xObject.pxFS;
+  ef_directory_st   xEntry;
+  ef_file_info_st   xFileInfo;
+  ef_return_et      eResult = EF_RET_OK;
+  ef_bool_t         bEmpty = EF_BOOL_FALSE;
+  ef_u32_t          u32Cluster;
+  ef_u32_t          u32Length;
+  ef_u32_t          n;
+
+  /* Path length */
+  for ( u32Length = 0 ; 0 != pxFS->xCwdPath[ u32Length ] ; u32Length++ ) ;
+
+  /* If the path is not known, the next eEF_getcwd() resolves it */
+  if ( EF_BOOL_FALSE == pxFS->bCwdValid )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if it is the dot entry, the directory does not change */
+  else if (    ( 0 != ( EF_NS_DOT & pxDir->u8Name[ EF_NSFLAG ] ) )
+            && ( '.' != pxDir->u8Name[ 1 ] ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if it is the dot dot entry, the last name and cluster are dropped */
+  else if ( 0 != ( EF_NS_DOT & pxDir->u8Name[ EF_NSFLAG ] ) )
+  {
+    while (    ( 0 != u32Length )
+            && ( '/' != pxFS->xCwdPath[ --u32Length ] ) ) ;
+    pxFS->xCwdPath[ ( 0 == u32Length ) ? 1 : u32Length ] = 0;
+    for ( n = 1 ; n < pxFS->u8CwdDepth ; n++ )
+    {
+      pxFS->u32CwdClst[ n - 1 ] = pxFS->u32CwdClst[ n ];
+    }
+    if ( 0 != pxFS->u8CwdDepth )
+    {
+      pxFS->u8CwdDepth--;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+  else
+  {
+    /* The name is read from the directory, the one searched for may differ in case or be the short name */
+    xEntry = *pxDir;
+#if ( 0 != EF_CONF_VFAT )
+    /* The long name is read from the start of the entry block */
+    if ( 0xFFFFFFFF != xEntry.u32BlkOffset )
+    {
+      eResult = eEFPrvDirectoryIndexSet( &xEntry, xEntry.u32BlkOffset );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+#endif
+    if (    ( EF_RET_OK != eResult )
+         || ( EF_RET_OK != eEFPrvDirRead( &xEntry, &bEmpty ) )
+         || ( EF_BOOL_FALSE != bEmpty )
+         || ( EF_RET_OK != eEFPrvDirFileInfosGet( &xEntry, &xFileInfo ) )
+         || ( EF_RET_OK != eEFPrvDirectoryClusterGet( pxFS, xEntry.pu8Dir, &u32Cluster ) ) )
+    {
+      (void) eEFPrvCwdCacheInvalidate( pxFS );
+    }
+    else
+    {
+      /* The root path has no trailing separator */
+      u32Length = ( 1 == u32Length ) ? 0 : u32Length;
+      /* Name length */
+      for ( n = 0 ; 0 != xFileInfo.xName[ n ] ; n++ ) ;
+      /* If the path does not fit in the cache */
+      if (    ( EF_CONF_CWD_CACHE_SIZE <= ( u32Length + 1 + n ) )
+           || ( EF_CONF_CWD_CACHE_DEPTH <= pxFS->u8CwdDepth ) )
+      {
+        (void) eEFPrvCwdCacheInvalidate( pxFS );
+      }
+      else
+      {
+        pxFS->xCwdPath[ u32Length++ ] = '/';
+        for ( n = 0 ; 0 != xFileInfo.xName[ n ] ; n++ )
+        {
+          pxFS->xCwdPath[ u32Length++ ] = xFileInfo.xName[ n ];
+        }
+        pxFS->xCwdPath[ u32Length ] = 0;
+        for ( n = pxFS->u8CwdDepth ; 0 != n ; n-- )
+        {
+          pxFS->u32CwdClst[ n ] = pxFS->u32CwdClst[ n - 1 ];
+        }
+        pxFS->u32CwdClst[ 0 ] = u32Cluster;
+        pxFS->u8CwdDepth++;
+      }
+    }
+
+    /* The path follow goes on from the entry found */
+    if ( EF_RET_OK != eEFPrvFSWindowLoad( pxFS, pxDir->xSector ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+#else
+  (void) pxDir;
+#endif
+
+  return eRetVal;
+}
+
+/* Stop recording the path followed by eEF_chdir() */
+ef_return_et eEFPrvCwdCacheEnd (
+  ef_fs_st      * pxFS,
+  ef_return_et    eResult
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+#if ( 2 == EF_CONF_RELATIVE_PATH ) && ( 0 != EF_CONF_CWD_CACHE_SIZE )
+  pxFS->bCwdFollow = EF_BOOL_FALSE;
+#endif
+  /* If eEF_chdir() failed, the cache may hold a part of its path */
+  if ( EF_RET_OK != eResult )
+  {
+    (void) eEFPrvCwdCacheInvalidate( pxFS );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  return EF_RET_OK;
+}
+
+/* Invalidate the current directory path cache */
+ef_return_et eEFPrvCwdCacheInvalidate (
+  ef_fs_st  * pxFS
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+#if ( 2 == EF_CONF_RELATIVE_PATH ) && ( 0 != EF_CONF_CWD_CACHE_SIZE )
+  pxFS->bCwdValid = EF_BOOL_FALSE;
+  pxFS->u8CwdDepth = 0;
+  /* The rest of the path followed by eEF_chdir() is not recorded */
+  pxFS->bCwdFollow = EF_BOOL_FALSE;
+#else
+  EF_CODE_COVERAGE( );
+#endif
+
+  return EF_RET_OK;
+}
+
+/* Invalidate the current directory path cache if it goes through a directory */
+ef_return_et eEFPrvCwdCacheCheck (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Cluster
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+#if ( 2 == EF_CONF_RELATIVE_PATH ) && ( 0 != EF_CONF_CWD_CACHE_SIZE )
+  ef_u32_t  u32Idx;
+
+  for ( u32Idx = 0 ; u32Idx < pxFS->u8CwdDepth ; u32Idx++ )
+  {
+    if ( u32Cluster == pxFS->u32CwdClst[ u32Idx ] )
+    {
+      (void) eEFPrvCwdCacheInvalidate( pxFS );
+      break;
+    }
+  }
+#else
+  (void) u32Cluster;
+#endif
+
+  return EF_RET_OK;
+}
+
+/* Copy the current directory path */
+ef_return_et eEFPrvCwdCopy (
+  ef_fs_st  * pxFS,
+  TCHAR     * pxString,
+  ef_u32_t    u32Size
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+  EF_ASSERT_PRIVATE( 0 != pxString );
+  EF_ASSERT_PRIVATE( 0 != u32Size );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_bool_t     bCopied = EF_BOOL_FALSE;
+  ef_u32_t      u32Index;
+  ef_u32_t      u32Depth;
+  ef_u32_t      n;
+
+#if ( 2 == EF_CONF_RELATIVE_PATH ) && ( 0 != EF_CONF_CWD_CACHE_SIZE )
+  if ( EF_BOOL_TRUE == pxFS->bCwdValid )
+  {
+    /* Path length */
+    for ( n = 0 ; 0 != pxFS->xCwdPath[ n ] ; n++ ) ;
+    /* Insufficient space to store the path name? */
+    if ( u32Size < ( n + 1 ) )
+    {
+      eRetVal = EF_RET_NOT_ENOUGH_CORE;
+    }
+    else
+    {
+      /* Copy path and terminator */
+      do
+      {
+        pxString[ n ] = pxFS->xCwdPath[ n ];
+      } while ( 0 != n-- );
+      bCopied = EF_BOOL_TRUE;
+    }
+  }
+#endif
+
+  if (    ( EF_RET_OK != eRetVal )
+       || ( EF_BOOL_TRUE == bCopied ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else
+  {
+    /* Follow parent directories in the given buffer, keep the last character for the terminator */
+#if ( 2 == EF_CONF_RELATIVE_PATH ) && ( 0 != EF_CONF_CWD_CACHE_SIZE )
+    eRetVal = eEFPrvCwdResolve( pxFS, pxString, u32Size - 1, &u32Index,
+                                pxFS->u32CwdClst, EF_CONF_CWD_CACHE_DEPTH, &u32Depth );
+#else
+    eRetVal = eEFPrvCwdResolve( pxFS, pxString, u32Size - 1, &u32Index, 0, 0, &u32Depth );
+#endif
+    if ( EF_RET_OK == eRetVal )
+    {
+      n = 0;
+      /* Move the stacked path to the head of the buffer */
+      while ( u32Index < ( u32Size - 1 ) )
+      {
+        pxString[ n++ ] = pxString[ u32Index++ ];
+      }
+      pxString[ n ] = 0;
+
+#if ( 2 == EF_CONF_RELATIVE_PATH ) && ( 0 != EF_CONF_CWD_CACHE_SIZE )
+      /* If the path fits in the cache, keep it for the next calls */
+      if (    ( EF_CONF_CWD_CACHE_SIZE > n )
+           && ( EF_CONF_CWD_CACHE_DEPTH >= u32Depth ) )
+      {
+        do
+        {
+          pxFS->xCwdPath[ n ] = pxString[ n ];
+        } while ( 0 != n-- );
+        pxFS->u8CwdDepth = (ef_u08_t) u32Depth;
+        pxFS->bCwdValid = EF_BOOL_TRUE;
+      }
+#endif
+    }
+  }
+
+  return eRetVal;
+}
+
+/* ***************************************************************************************************************** */
+/* END OF FILE ***************************************************************************************************** */
@@ -65,8 +65,6 @@ ef_return_et eEFPrvLabelRead (
   EF_ASSERT_PRIVATE( 0 != pxDir );
   EF_ASSERT_PRIVATE( 0 != pbFound );
 
-#if ( 0 == EF_CONF_VFAT )
-
   ef_return_et    eRetVal = EF_RET_OK;
   ef_bool_t       bFound = EF_BOOL_FALSE;
   ef_fs_st      * pxFS    = pxDir->xObject.pxFS;
@@ -150,94 +148,6 @@ ef_return_et eEFPrvLabelRead (
     EF_CODE_COVERAGE( );
   }
 
-#else
-  ef_return_et    eRetVal = EF_RET_NO_FILE;
-  ef_fs_st      * pxFS  = pxDir->xObject.pxFS;
-  ef_u08_t        u8Attrib;
-  ef_u08_t        ord = 0xFF;
-  ef_u08_t        sum = 0xFF;
-  int             vol = 1;
-
-  while ( pxDir->xSector )
-  {
-    eRetVal = eEFPrvFSWindowLoad( pxFS, pxDir->xSector );
-    if ( EF_RET_OK != eRetVal )
-    {
-      break;
-    }
-    ef_u08_t u8EntryType = pxDir->pu8Dir[ EF_DIR_NAME_START ];  /* Test for the entry type */
-    if ( 0 == u8EntryType )
-    {
-      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_NO_FILE );
-      break; /* Reached to end of the directory */
-    }
-    u8Attrib = pxDir->pu8Dir[ EF_DIR_ATTRIBUTES ] & EF_DIR_ATTRIB_BITS_DEFINED;
-    pxDir->xObject.u8Attrib = u8Attrib;
-    /* Get attribute */
-    /* Is it a valid entry? */
-    if (    ( EF_DIR_DELETED_MASK == u8EntryType )
-         || ( '.' == u8EntryType )
-//         || ((int)((u8Attrib & ~EF_DIR_ATTRIB_BIT_ARCHIVE) == EF_DIR_ATTRIB_BIT_VOLUME_ID) != vol ) )
-         || (    (    ( 0 == vol )
-                   && ( EF_DIR_ATTRIB_BIT_VOLUME_ID == ( ~EF_DIR_ATTRIB_BIT_ARCHIVE & u8Attrib ) ) )
-              || (    ( 0 != vol )
-                   && ( EF_DIR_ATTRIB_BIT_VOLUME_ID != ( ~EF_DIR_ATTRIB_BIT_ARCHIVE & u8Attrib ) ) ) ) )
-    {
-      ord = 0xFF;
-    }
-    /* Else, if An LFN entry is found */
-    else if ( EF_DIR_ATTRIB_BITS_LFN == u8Attrib )
-    {
-      /* Is it start of an LFN sequence? */
-      if ( EF_DIR_LFN_LAST & u8EntryType )
-      {
-        sum = pxDir->pu8Dir[EF_DIR_LFN_CHECKSUM];
-        u8EntryType &= (ef_u08_t)~EF_DIR_LFN_LAST;
-        ord = u8EntryType;
-        pxDir->u32BlkOffset = pxDir->u32Offset;
-      }
-      ucs2_t *    pxLFNBuffer;            /* LFN working buffer */
-      (void) EF_LFN_BUFFER_GET( pxDir->xObject.pxFS, pxLFNBuffer );
-      /* Check LFN validity and capture it */
-      if (    ( u8EntryType == ord )
-           && ( sum == pxDir->pu8Dir[ EF_DIR_LFN_CHECKSUM ] )
-           && ( EF_RET_OK == eEFPrvLFNPick( pxLFNBuffer, pxDir->pu8Dir ) ) )
-      {
-        ord = ord - 0x01;
-      }
-      else
-      {
-        ord = 0xFF;
-      }
-    }
-    else
-    {          /* An SFN entry is found */
-      ef_u08_t u8CheckSum = 0;
-      /* Is there a valid LFN? */
-      if (    ( 0 != ord )
-           || (    ( EF_RET_OK == eEFPrvSFNChecksumGet(  pxDir->pu8Dir,
-                                                          &u8CheckSum ) )
-                && ( sum != u8CheckSum ) ) )
-      {
-        /* It has no LFN. */
-        pxDir->u32BlkOffset = 0xFFFFFFFF;
-      }
-      break;
-    }
-    /* Next entry */
-    eRetVal = eEFPrvDirectoryIndexNext( pxDir, EF_BOOL_FALSE );
-    if ( EF_RET_OK != eRetVal )
-    {
-      break;
-    }
-  }
-
-  if ( EF_RET_OK != eRetVal )
-  {
-    pxDir->xSector = 0;    /* Terminate the read operation on error or EOT */
-  }
-#endif /* ( 0 != EF_CONF_VFAT ) */
-
   return eRetVal;
 }
 
@@ -356,7 +356,7 @@ ef_return_et eEFPrvDirectoryIndexNext (
         EF_CODE_COVERAGE( );
       }
       /* Else, if stretching is not requested */
-      if ( EF_BOOL_TRUE != bStretch )
+      else if ( EF_BOOL_TRUE != bStretch )
       {
         /* Report EOT */
         pxDir->xSector = 0;
@@ -155,90 +155,134 @@ ef_return_et eEFPrvDirRead (
 
 
 #else
-  ef_return_et eRetVal = EF_RET_NO_FILE;
-  ef_fs_st *  pxFS      = pxDir->xObject.pxFS;
-  ef_u08_t             u8Attrib;
-  ef_u08_t             ord = 0xFF;
-  ef_u08_t             sum = 0xFF;
 
-  while ( pxDir->xSector )
+  ef_return_et    eRetVal = EF_RET_OK;
+  ef_bool_t       bEmpty = EF_BOOL_FALSE;
+  ef_fs_st      * pxFS    = pxDir->xObject.pxFS;
+  ucs2_t        * pxLFNBuffer = 0;
+  ef_u08_t        u8Attrib;
+  ef_u08_t        u8Byte;
+  ef_u08_t        u8Order = 0xFF;
+  ef_u08_t        u8Sum = 0xFF;
+  ef_u08_t        u8CheckSum = 0;
+
+  if ( EF_RET_OK != EF_LFN_BUFFER_GET( pxFS, &pxLFNBuffer ) )
   {
-    eRetVal = eEFPrvFSWindowLoad( pxFS, pxDir->xSector );
-    if ( EF_RET_OK != eRetVal )
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  while (    ( EF_RET_OK == eRetVal )
+          && ( 0 != pxDir->xSector ) )
+  {
+    if ( EF_RET_OK != eEFPrvFSWindowLoad( pxFS, pxDir->xSector ) )
     {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
       break;
     }
-    ef_u08_t b = pxDir->pu8Dir[ EF_DIR_NAME_START ];  /* Test for the entry type */
-    if ( 0 == b )
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    /* Test for the entry type */
+    u8Byte = pxDir->pu8Dir[ EF_DIR_NAME_START ];
+    /* Reached to end of the directory */
+    if ( 0 == u8Byte )
     {
-      eRetVal = EF_RET_NO_FILE;
-      break; /* Reached to end of the directory */
+      bEmpty = EF_BOOL_TRUE;
+      break;
     }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    /* Get attribute */
     u8Attrib = pxDir->pu8Dir[ EF_DIR_ATTRIBUTES ] & EF_DIR_ATTRIB_BITS_DEFINED;
     pxDir->xObject.u8Attrib = u8Attrib;
-    /* Get attribute */
-    /* Is it a valid entry? */
-    if (    ( EF_DIR_DELETED_MASK == b )
-         || ( '.' == b )
-//         || ((int)((u8Attrib & ~EF_DIR_ATTRIB_BIT_ARCHIVE) == EF_DIR_ATTRIB_BIT_VOLUME_ID) != vol ) )
-         || (    (    ( 0 == vol )
-                   && ( EF_DIR_ATTRIB_BIT_VOLUME_ID == ( ~EF_DIR_ATTRIB_BIT_ARCHIVE & u8Attrib ) ) )
-              || (    ( 0 != vol )
-                   && ( EF_DIR_ATTRIB_BIT_VOLUME_ID != ( ~EF_DIR_ATTRIB_BIT_ARCHIVE & u8Attrib ) ) ) ) )
+    /* If it is not a valid entry */
+    if (    ( EF_DIR_DELETED_MASK == u8Byte )
+         || ( '.' == u8Byte )
+         || ( EF_DIR_ATTRIB_BIT_VOLUME_ID == ( ~EF_DIR_ATTRIB_BIT_ARCHIVE & u8Attrib ) ) )
     {
-      ord = 0xFF;
+      /* Reset LFN sequence */
+      u8Order = 0xFF;
     }
-    /* Else, if An LFN entry is found */
+    /* Else, if an LFN entry is found */
     else if ( EF_DIR_ATTRIB_BITS_LFN == u8Attrib )
     {
-      /* Is it start of an LFN sequence? */
-      if ( EF_DIR_LFN_LAST & b )
+      /* If it is the start of an LFN sequence */
+      if ( 0 != ( EF_DIR_LFN_LAST & u8Byte ) )
       {
-        sum = pxDir->pu8Dir[EF_DIR_LFN_CHECKSUM];
-        b &= (ef_u08_t)~EF_DIR_LFN_LAST;
-        ord = b;
+        u8Sum = pxDir->pu8Dir[ EF_DIR_LFN_CHECKSUM ];
+        u8Byte &= (ef_u08_t) ~EF_DIR_LFN_LAST;
+        u8Order = u8Byte;
         pxDir->u32BlkOffset = pxDir->u32Offset;
       }
-      ucs2_t *    pxLFNBuffer;            /* LFN working buffer */
-      (void) EF_LFN_BUFFER_GET( pxFS, pxLFNBuffer );
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
       /* Check LFN validity and capture it */
-      if (    ( b == ord )
-           && ( sum == pxDir->pu8Dir[ EF_DIR_LFN_CHECKSUM ] )
+      if (    ( u8Byte == u8Order )
+           && ( u8Sum == pxDir->pu8Dir[ EF_DIR_LFN_CHECKSUM ] )
            && ( EF_RET_OK == eEFPrvLFNPick( pxLFNBuffer, pxDir->pu8Dir ) ) )
       {
-        ord = ord - 0x01;
+        u8Order--;
       }
       else
       {
-        ord = 0xFF;
+        u8Order = 0xFF;
       }
     }
+    /* Else, an SFN entry is found */
     else
-    {          /* An SFN entry is found */
-      ef_u08_t u8CheckSum = 0;
-      /* Is there a valid LFN? */
-      if (    ( 0 != ord )
-           || (    ( EF_RET_OK == eEFPrvSFNChecksumGet(  pxDir->pu8Dir,
-                                                          &u8CheckSum ) )
-                && ( sum != u8CheckSum ) ) )
-      {
-        /* It has no LFN. */
+    {
+      /* If it has no valid LFN */
+      if (    ( 0 != u8Order )
+           || ( EF_RET_OK != eEFPrvSFNChecksumGet( pxDir->pu8Dir, &u8CheckSum ) )
+           || ( u8Sum != u8CheckSum ) )
+      {
         pxDir->u32BlkOffset = 0xFFFFFFFF;
       }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
       break;
     }
+    ef_bool_t     bStretched = EF_BOOL_FALSE;
+    ef_bool_t     bMoved = EF_BOOL_FALSE;
     /* Next entry */
-    eRetVal = eEFPrvDirectoryIndexNext( pxDir, EF_BOOL_FALSE );
-    if ( EF_RET_OK != eRetVal )
+    if ( EF_RET_OK != eEFPrvDirectoryIndexNext( pxDir, EF_BOOL_FALSE, &bStretched, &bMoved ) )
     {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+      break;
+    }
+    else if ( EF_BOOL_TRUE == bMoved )
+    {
+      bEmpty = EF_BOOL_TRUE;
       break;
     }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
   }
 
   if ( EF_RET_OK != eRetVal )
   {
-    pxDir->xSector = 0;    /* Terminate the read operation on error or EOT */
+    /* Terminate the read operation on error or EOT */
+    pxDir->xSector = 0;
   }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+  *pbEmpty = bEmpty;
+
 #endif /* ( 0 != EF_CONF_VFAT ) */
   return eRetVal;
 }
@@ -320,103 +364,142 @@ ef_return_et eEFPrvDirFind (
   *pbFound = bFound;
 
 #else
-  /* Rewind directory object */
-  eRetVal = eEFPrvDirectoryIndexSet( pxDir, 0 );
-  if ( EF_RET_OK == eRetVal )
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_bool_t     bFound = EF_BOOL_FALSE;
+  ef_fs_st    * pxFS = pxDir->xObject.pxFS;
+  ucs2_t      * pxLFNBuffer = 0;
+  ef_u08_t      u8Attrib;
+  ef_u08_t      u8Byte;
+  ef_u08_t      u8Order = 0xFF;
+  ef_u08_t      u8Sum = 0xFF;
+  ef_u08_t      u8CheckSum = 0;
+
+  if ( EF_RET_OK != EF_LFN_BUFFER_GET( pxFS, &pxLFNBuffer ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  /* Else, if rewinding directory object failed */
+  else if ( EF_RET_OK != eEFPrvDirectoryIndexSet( pxDir, 0 ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+  }
+  else
   {
-    ef_fs_st  * pxFS = pxDir->xObject.pxFS;
-    ef_u08_t c;
     /* Reset LFN sequence */
-    ef_u08_t ord = 0xFF;
-    ef_u08_t sum = 0xFF;
     pxDir->u32BlkOffset = 0xFFFFFFFF;
     do
     {
-      eRetVal = eEFPrvFSWindowLoad( pxFS, pxDir->xSector );
-      if ( EF_RET_OK != eRetVal )
+      /* If we Reached to end of table */
+      if ( 0 == pxDir->xSector )
+      {
+        break;
+      }
+      else if ( EF_RET_OK != eEFPrvFSWindowLoad( pxFS, pxDir->xSector ) )
       {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
         break;
       }
-      c = pxDir->pu8Dir[ EF_DIR_NAME_START ];
-      if ( 0 == c )
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+      u8Byte = pxDir->pu8Dir[ EF_DIR_NAME_START ];
+      /* If we Reached to end of table */
+      if ( 0 == u8Byte )
       {
-        eRetVal = EF_RET_NO_FILE;
         break;
-      }  /* Reached to end of table */
-      /* LFN configuration */
-      ef_u08_t u8Attrib = EF_DIR_ATTRIB_BITS_DEFINED & pxDir->pu8Dir[ EF_DIR_ATTRIBUTES ];
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+      u8Attrib = EF_DIR_ATTRIB_BITS_DEFINED & pxDir->pu8Dir[ EF_DIR_ATTRIBUTES ];
       pxDir->xObject.u8Attrib = u8Attrib;
-      /* If this entry without valid data */
-      if (    ( EF_DIR_DELETED_MASK == c )
+      /* If this entry is without valid data */
+      if (    ( EF_DIR_DELETED_MASK == u8Byte )
            || (    ( 0 != ( EF_DIR_ATTRIB_BIT_VOLUME_ID & u8Attrib ) )
                 && ( EF_DIR_ATTRIB_BITS_LFN != u8Attrib ) ) )
       {
         /* Reset LFN sequence */
-        ord = 0xFF;
+        u8Order = 0xFF;
         pxDir->u32BlkOffset = 0xFFFFFFFF;
       }
-      else
+      /* Else, if an LFN entry is found */
+      else if ( EF_DIR_ATTRIB_BITS_LFN == u8Attrib )
       {
-        if ( EF_DIR_ATTRIB_BITS_LFN == u8Attrib )
-        { /* An LFN entry is found */
-          /* If it is the start of LFN sequence? */
-          if ( 0 == ( EF_NS_NOLFN & pxDir->u8Name[ EF_NSFLAG ] ) )
+        /* If LFN entries are not to be matched */
+        if ( 0 != ( EF_NS_NOLFN & pxDir->u8Name[ EF_NSFLAG ] ) )
+        {
+          EF_CODE_COVERAGE( );
+        }
+        else
+        {
+          /* If it is the start of an LFN sequence */
+          if ( 0 != ( EF_DIR_LFN_LAST & u8Byte ) )
           {
-            if ( 0 != ( EF_DIR_LFN_LAST & c ) )
-            {
-              sum = pxDir->pu8Dir[ EF_DIR_LFN_CHECKSUM ];
-              c &= (ef_u08_t)~EF_DIR_LFN_LAST;
-              /* LFN start order */
-              ord = c;
-              /* Start offset of LFN */
-              pxDir->u32BlkOffset = pxDir->u32Offset;
-            }
-            ucs2_t *    pxLFNBuffer;            /* LFN working buffer */
-            (void) EF_LFN_BUFFER_GET( pxDir->xObject.pxFS, pxLFNBuffer );
-            /* Check validity of the LFN entry and compare it with given name */
-            if (    ( c == ord )
-                 && ( sum == pxDir->pu8Dir[ EF_DIR_LFN_CHECKSUM ] )
-                 && ( EF_RET_OK == eEFPrvLFNCompare(  pxLFNBuffer,
-                                                      pxDir->pu8Dir ) ) )
-            {
-              ord -= (ef_u08_t) 1;
-            }
-            else
-            {
-              ord = 0xFF;
-            }
+            u8Sum = pxDir->pu8Dir[ EF_DIR_LFN_CHECKSUM ];
+            u8Byte &= (ef_u08_t) ~EF_DIR_LFN_LAST;
+            /* LFN start order */
+            u8Order = u8Byte;
+            /* Start offset of LFN */
+            pxDir->u32BlkOffset = pxDir->u32Offset;
           }
-        } /* An LFN entry is found */
-        else
-        { /* An SFN entry is found */
-          ef_u08_t u8CheckSum = 0;
-          /* LFN matched? */
-          if (    ( 0 == ord )
-               || (    ( EF_RET_OK == eEFPrvSFNChecksumGet(  pxDir->pu8Dir,
-                                                              &u8CheckSum ) )
-                    && ( sum != u8CheckSum ) ) )
+          else
           {
-            break;
+            EF_CODE_COVERAGE( );
           }
-          /* SFN matched? */
-          /* If it is a NOT valid entry */
-          else if (   ( 0 == ( EF_NS_LOSS & pxDir->u8Name[ EF_NSFLAG ] ) )
-                   && ( EF_RET_OK == eEFPortMemCompare( pxDir->pu8Dir, pxDir->u8Name, 11 ) ) )
+          /* Check validity of the LFN entry and compare it with given name */
+          if (    ( u8Byte == u8Order )
+               && ( u8Sum == pxDir->pu8Dir[ EF_DIR_LFN_CHECKSUM ] )
+               && ( EF_RET_OK == eEFPrvLFNCompare( pxLFNBuffer, pxDir->pu8Dir ) ) )
           {
-            break;
+            u8Order--;
           }
           else
           {
-            /* Reset LFN sequence */
-            ord = 0xFF;
-            pxDir->u32BlkOffset = 0xFFFFFFFF;
+            u8Order = 0xFF;
           }
-        } /* An SFN entry is found */
+        }
+      }
+      /* Else, if the SFN entry closes the matching LFN */
+      else if (    ( 0 == u8Order )
+                && ( EF_RET_OK == eEFPrvSFNChecksumGet( pxDir->pu8Dir, &u8CheckSum ) )
+                && ( u8Sum == u8CheckSum ) )
+      {
+        bFound = EF_BOOL_TRUE;
+        break;
       }
+      /* Else, if the SFN matches */
+      else if (    ( 0 == ( EF_NS_LOSS & pxDir->u8Name[ EF_NSFLAG ] ) )
+                && ( EF_RET_OK == eEFPortMemCompare( pxDir->pu8Dir, pxDir->u8Name, 11 ) ) )
+      {
+        bFound = EF_BOOL_TRUE;
+        break;
+      }
+      else
+      {
+        /* Reset LFN sequence */
+        u8Order = 0xFF;
+        pxDir->u32BlkOffset = 0xFFFFFFFF;
+      }
+      ef_bool_t     bStretched = EF_BOOL_FALSE;
+      ef_bool_t     bMoved = EF_BOOL_FALSE;
       /* Next entry */
-      eRetVal = eEFPrvDirectoryIndexNext( pxDir, EF_BOOL_FALSE );
-    } while ( EF_RET_OK == eRetVal );
+      if ( EF_RET_OK != eEFPrvDirectoryIndexNext( pxDir, EF_BOOL_FALSE, &bStretched, &bMoved ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+    }
+    while ( EF_RET_OK == eRetVal );
   }
+
+  *pbFound = bFound;
+
 #endif /* ( 0 != EF_CONF_VFAT ) */
 
   return eRetVal;
@@ -461,112 +544,169 @@ ef_return_et eEFPrvDirRegister (
   }
 
 #else
-  ef_return_et  eRetVal = EF_RET_INT_ERR;
-  ef_fs_st    * pxFS = pxDir->xObject.pxFS;
 
-  ef_u32_t n;
-  ef_u32_t nlen;
-  ef_u32_t nent;
-  ef_u08_t sn[ 12 ];
-  ef_u08_t sum;
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_fs_st    * pxFS = pxDir->xObject.pxFS;
+  ucs2_t      * pxLFNBuffer = 0;
+  ef_u32_t      u32Length;
+  ef_u32_t      u32EntriesNb = 1;
+  ef_u32_t      u32Sequence;
+  ef_u08_t      u8SFN[ 12 ];
+  ef_u08_t      u8CheckSum = 0;
+  ef_bool_t     bFound = EF_BOOL_FALSE;
+  ef_bool_t     bStretched = EF_BOOL_FALSE;
+  ef_bool_t     bMoved = EF_BOOL_FALSE;
 
-  /* Check name validity */
+  /* If the name is a dot name or no name */
   if ( 0 != ( ( EF_NS_DOT | EF_NS_NONAME ) & pxDir->u8Name[ EF_NSFLAG ] ) )
   {
-    return EF_RET_INVALID_NAME;
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_NAME );
   }
-  ucs2_t *    pxLFNBuffer;            /* LFN working buffer */
-  (void) EF_LFN_BUFFER_GET( pxDir->xObject.pxFS, pxLFNBuffer );
-  /* Get lfn length */
-  for ( nlen = 0 ; 0 != pxLFNBuffer[ nlen ] ; nlen++ ) ;
-
-  /* On the FAT/FAT32 volume */
-  eEFPortMemCopy( pxDir->u8Name, sn, 12);
-  /* When LFN is out of 8.3 format, generate a numbered name */
-  if ( 0 != ( EF_NS_LOSS & sn[ EF_NSFLAG ] ) )
+  else if ( EF_RET_OK != EF_LFN_BUFFER_GET( pxFS, &pxLFNBuffer ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  else
   {
-    /* Find only SFN */
-    pxDir->u8Name[ EF_NSFLAG ] = EF_NS_NOLFN;
-    for ( n = 1 ; n < 100 ; n++ )
+    /* Get LFN length */
+    for ( u32Length = 0 ; 0 != pxLFNBuffer[ u32Length ] ; u32Length++ )
     {
-      /* Generate a numbered name */
-      (void) eEFPrvLFNCreateSFN( pxDir->u8Name, sn, pxLFNBuffer, n );
-      /* Check if the name collides with existing SFN */
-      eRetVal = eEFPrvDirFind( pxDir );
-      if ( EF_RET_OK != eRetVal )
+      ;
+    }
+    (void) eEFPortMemCopy( pxDir->u8Name, u8SFN, 12 );
+
+    /* If the LFN is out of 8.3 format, generate a numbered name */
+    if ( 0 != ( EF_NS_LOSS & u8SFN[ EF_NSFLAG ] ) )
+    {
+      /* Find only SFN */
+      pxDir->u8Name[ EF_NSFLAG ] = EF_NS_NOLFN;
+      for ( u32Sequence = 1 ; u32Sequence < 100 ; u32Sequence++ )
       {
-        break;
+        /* Generate a numbered name */
+        (void) eEFPrvLFNCreateSFN( pxDir->u8Name, u8SFN, pxLFNBuffer, u32Sequence );
+        /* If checking the collisions with existing SFN failed */
+        if ( EF_RET_OK != eEFPrvDirFind( pxDir, &bFound ) )
+        {
+          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+          break;
+        }
+        /* Else, if the name does not collide */
+        else if ( EF_BOOL_FALSE == bFound )
+        {
+          break;
+        }
+        else
+        {
+          EF_CODE_COVERAGE( );
+        }
       }
+      /* If too many collisions */
+      if (    ( EF_RET_OK == eRetVal )
+           && ( 100 == u32Sequence ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+      pxDir->u8Name[ EF_NSFLAG ] = u8SFN[ EF_NSFLAG ];
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
     }
-    /* Abort if too many collisions */
-    if ( 100 == n )
+
+    /* If an LFN is needed, add its entries to the SFN entry */
+    if ( 0 != ( EF_NS_LFN & u8SFN[ EF_NSFLAG ] ) )
     {
-      return EF_RET_DENIED;
+      u32EntriesNb += ( u32Length + 12 ) / 13;
     }
-    /* Abort if the result is other than 'not collided' */
-    if (eRetVal != EF_RET_NO_FILE)
+    else
     {
-      return eRetVal;
+      EF_CODE_COVERAGE( );
     }
-    pxDir->u8Name[ EF_NSFLAG ] = sn[ EF_NSFLAG ];
   }
 
-  /* Create an SFN with/without LFNs. */
-  if ( 0 != ( EF_NS_LFN & sn[ EF_NSFLAG ] ) )
+  if ( EF_RET_OK != eRetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if allocating the entries failed */
+  else if ( EF_RET_OK != eEFPrvDirectoryAllocate( pxDir, u32EntriesNb ) )
   {
-    /* Number of entries to allocate */
-    nent = ( ( nlen + 12 ) / 13 ) + 1;
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
   }
-  else
+  /* Else, if there is no LFN entry */
+  else if ( 1 == u32EntriesNb )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if going back to the first LFN entry failed */
+  else if ( EF_RET_OK != eEFPrvDirectoryIndexSet( pxDir, pxDir->u32Offset - ( ( u32EntriesNb - 1 ) * EF_DIR_ENTRY_SIZE ) ) )
   {
-    /* Number of entries to allocate */
-    nent = 1;
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
   }
-  /* Allocate entries */
-  eRetVal = eEFPrvDirectoryAllocate( pxDir, nent );
-  /* Set LFN entry if needed */
-  if (    ( EF_RET_OK == eRetVal )
-       && ( 0 != (--nent ) ) )
+  else
   {
-    eRetVal = eEFPrvDirectoryIndexSet( pxDir,
-                                      pxDir->u32Offset
-                                    - ( nent * EF_DIR_ENTRY_SIZE ) );
-    if ( EF_RET_OK == eRetVal )
+    /* Checksum value of the SFN tied to the LFN */
+    (void) eEFPrvSFNChecksumGet( pxDir->u8Name, &u8CheckSum );
+    /* Store LFN entries in bottom first */
+    for ( u32EntriesNb-- ; 0 != u32EntriesNb ; u32EntriesNb-- )
     {
-      /* Checksum value of the SFN tied to the LFN */
-      (void) eEFPrvSFNChecksumGet( pxDir->u8Name , &sum );
-      /* Store LFN entries in bottom first */
-      do {
-        eRetVal = eEFPrvFSWindowLoad( pxFS, pxDir->xSector );
-        if ( EF_RET_OK != eRetVal )
-        {
-          break;
-        }
-        (void) eEFPrvLFNPut( pxLFNBuffer, pxDir->pu8Dir, (ef_u08_t)nent, sum );
-        pxFS->u8WinFlags = 1;
-        /* Next entry */
-        eRetVal = eEFPrvDirectoryIndexNext( pxDir, EF_BOOL_FALSE );
+      if ( EF_RET_OK != eEFPrvFSWindowLoad( pxFS, pxDir->xSector ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+        break;
+      }
+      else if ( EF_RET_OK != eEFPrvLFNPut( pxLFNBuffer, pxDir->pu8Dir, (ef_u08_t) u32EntriesNb, u8CheckSum ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+        break;
+      }
+      else
+      {
+        pxFS->u8WinFlags = EF_FS_WIN_DIRTY;
+      }
+      /* Next entry */
+      if ( EF_RET_OK != eEFPrvDirectoryIndexNext( pxDir, EF_BOOL_FALSE, &bStretched, &bMoved ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+        break;
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
       }
-      while (    ( EF_RET_OK == eRetVal )
-              && ( 0 != (--nent ) ) );
     }
   }
 
+  if ( EF_RET_OK != eRetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
   /* Set SFN entry */
-  if ( EF_RET_OK == eRetVal )
+  else if ( EF_RET_OK != eEFPrvFSWindowLoad( pxFS, pxDir->xSector ) )
   {
-    eRetVal = eEFPrvFSWindowLoad( pxFS, pxDir->xSector );
-    if ( EF_RET_OK == eRetVal )
-    {
-      /* Clean the entry */
-      eEFPortMemZero( pxDir->pu8Dir, EF_DIR_ENTRY_SIZE );
-      /* Put SFN */
-      eEFPortMemCopy( pxDir->u8Name, pxDir->pu8Dir + EF_DIR_NAME_START, 11 );
-      /* Put NT u8StatusFlags */
-      pxDir->pu8Dir[EF_DIR_LFN_NTres] = (EF_NS_BODY | EF_NS_EXT) & pxDir->u8Name[EF_NSFLAG];
-      pxFS->u8WinFlags = 1;
-    }
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+  }
+  /* Clean the entry */
+  else if ( EF_RET_OK != eEFPortMemZero( pxDir->pu8Dir, EF_DIR_ENTRY_SIZE ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
   }
+  /* Put SFN */
+  else if ( EF_RET_OK != eEFPortMemCopy( pxDir->u8Name, pxDir->pu8Dir + EF_DIR_NAME_START, 11 ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  else
+  {
+    /* Put NT flags */
+    pxDir->pu8Dir[ EF_DIR_LFN_NTres ] = ( EF_NS_BODY | EF_NS_EXT ) & pxDir->u8Name[ EF_NSFLAG ];
+    pxFS->u8WinFlags = EF_FS_WIN_DIRTY;
+  }
+
 #endif /* ( 0 != EF_CONF_VFAT ) */
 
   return eRetVal;
@@ -597,47 +737,53 @@ ef_return_et eEFPrvDirRemove (
   }
 
 #else
-  ef_return_et  eRetVal = EF_RET_INT_ERR;
-  ef_fs_st    * pxFS = pxDir->xObject.pxFS;
 
-  ef_u32_t     last = pxDir->u32Offset;
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_fs_st    * pxFS = pxDir->xObject.pxFS;
+  ef_u32_t      u32Last = pxDir->u32Offset;
+  ef_bool_t     bStretched = EF_BOOL_FALSE;
+  ef_bool_t     bMoved = EF_BOOL_FALSE;
 
-  if ( 0xFFFFFFFF == pxDir->u32BlkOffset )
+  /* If there is an LFN, and going to the top of the entry block failed */
+  if (    ( 0xFFFFFFFF != pxDir->u32BlkOffset )
+       && ( EF_RET_OK != eEFPrvDirectoryIndexSet( pxDir, pxDir->u32BlkOffset ) ) )
   {
-    /* Goto top of the entry block if LFN is exist */
-    eRetVal = EF_RET_OK;
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
   }
   else
-  {
-    /* Goto top of the entry block if LFN is exist */
-    eRetVal = eEFPrvDirectoryIndexSet( pxDir, pxDir->u32BlkOffset );
-  }
-  if ( EF_RET_OK == eRetVal )
   {
     do
     {
-      eRetVal = eEFPrvFSWindowLoad( pxFS, pxDir->xSector );
-      if ( EF_RET_OK != eRetVal )
+      if ( EF_RET_OK != eEFPrvFSWindowLoad( pxFS, pxDir->xSector ) )
       {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
         break;
       }
       /* Mark the entry 'deleted'. */
       pxDir->pu8Dir[ EF_DIR_NAME_START ] = EF_DIR_DELETED_MASK;
-      pxFS->u8WinFlags = 1;
-      /* If reached last entry */
-      if ( pxDir->u32Offset >= last )
+      pxFS->u8WinFlags = EF_FS_WIN_DIRTY;
+      /* If the last entry of the object has been deleted */
+      if ( pxDir->u32Offset >= u32Last )
       {
-        /* then all entries of the object has been deleted. */
         break;
       }
-      /* Next entry */
-      eRetVal = eEFPrvDirectoryIndexNext( pxDir, EF_BOOL_FALSE );
+      /* Else, if going to the next entry failed */
+      else if ( EF_RET_OK != eEFPrvDirectoryIndexNext( pxDir, EF_BOOL_FALSE, &bStretched, &bMoved ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      }
+      /* Else, if the table ended before the last entry */
+      else if ( 0 == pxDir->xSector )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
     } while ( EF_RET_OK == eRetVal );
-    if ( EF_RET_NO_FILE == eRetVal )
-    {
-      eRetVal = EF_RET_INT_ERR;
-    }
   }
+
 #endif /* ( 0 != EF_CONF_VFAT ) */
 
   return eRetVal;
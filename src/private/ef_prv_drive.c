@@ -44,6 +44,10 @@
 #error Wrong EF_CONF_DRIVERS_NB setting
 #endif
 
+#define EF_DRIVE_TRANSFER_IDLE  ( 0 )   /**< No started transfer */
+#define EF_DRIVE_TRANSFER_BUSY  ( 1 )   /**< A started transfer is running */
+#define EF_DRIVE_TRANSFER_DONE  ( 2 )   /**< A started transfer ended, its result is not collected yet */
+
 /* Local function macros ------------------------------------------------------------------------------------------- */
 /* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
 /* Local variables ------------------------------------------------------------------------------------------------- */
@@ -56,11 +60,74 @@ static ef_u08_t u8FarFsDrivesNb = 0;
 /**
  *  Filesystem objects (logical drives)
  */
-static ef_drive_functions_st xFarFsDrives[ EF_CONF_DRIVERS_NB ] = { { 0, 0, 0, 0, 0 } };
+static ef_drive_functions_st xFarFsDrives[ EF_CONF_DRIVERS_NB ];
+
+#if ( 0 != EF_CONF_NON_BLOCKING )
+/**
+ *  State of the started transfer of each drive (EF_DRIVE_TRANSFER_xxx)
+ */
+static ef_u08_t u8FarFsDrivesTransfer[ EF_CONF_DRIVERS_NB ] = { EF_DRIVE_TRANSFER_IDLE };
+
+/**
+ *  Result of the ended transfer of each drive
+ */
+static ef_return_et eFarFsDrivesTransferResult[ EF_CONF_DRIVERS_NB ] = { EF_RET_OK };
+#endif
+
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+/**
+ *  Number of blocking commands issued to each drive (wraps around)
+ */
+static ef_u32_t u32FarFsDrivesCommands[ EF_CONF_DRIVERS_NB ] = { 0 };
+#endif
 
 /* Public variables ------------------------------------------------------------------------------------------------ */
 /* Local function prototypes---------------------------------------------------------------------------------------- */
+
+/**
+ *  @brief  Wait for the end of the started transfer of a drive before a blocking request
+ *
+ *  The result is kept for the non-blocking function polling the transfer.
+ *
+ *  @param  u8PhyDrvNb  8 bits unsigned integer identifying the physical drive number
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK   Success
+ */
+static ef_return_et eEFPrvDriveTransferWait (
+  ef_u08_t  u8PhyDrvNb
+);
+
 /* Local functions ------------------------------------------------------------------------------------------------- */
+
+/* Wait for the end of the started transfer of a drive */
+static ef_return_et eEFPrvDriveTransferWait (
+  ef_u08_t  u8PhyDrvNb
+)
+{
+#if ( 0 != EF_CONF_NON_BLOCKING )
+  ef_return_et  eResult;
+
+  while ( EF_DRIVE_TRANSFER_BUSY == u8FarFsDrivesTransfer[ u8PhyDrvNb ] )
+  {
+    eResult = xFarFsDrives[ u8PhyDrvNb ].pxTransferStatus( );
+    if ( EF_RET_PENDING != eResult )
+    {
+      eFarFsDrivesTransferResult[ u8PhyDrvNb ] = eResult;
+      u8FarFsDrivesTransfer[ u8PhyDrvNb ] = EF_DRIVE_TRANSFER_DONE;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+#else
+  (void) u8PhyDrvNb;
+#endif
+
+  return EF_RET_OK;
+}
+
 /* Public functions ------------------------------------------------------------------------------------------------ */
 
 /* Initialize a Drive */
@@ -90,6 +157,12 @@ ef_return_et  eEFPrvDriveRead (
 //  EF_ASSERT_PRIVATE( EF_CONF_DRIVERS_NB <= u8PhyDrvNb );
   EF_ASSERT_PRIVATE( 0 != pu8Buffer );
 
+  (void) eEFPrvDriveTransferWait( u8PhyDrvNb );
+
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+  u32FarFsDrivesCommands[ u8PhyDrvNb ]++;
+#endif
+
   return xFarFsDrives[ u8PhyDrvNb ].pxRead( pu8Buffer, xSector, u32Count );
 }
 
@@ -104,9 +177,125 @@ ef_return_et  eEFPrvDriveWrite (
 //  EF_ASSERT_PRIVATE( EF_CONF_DRIVERS_NB <= u8PhyDrvNb );
   EF_ASSERT_PRIVATE( 0 != pu8Buffer );
 
+  (void) eEFPrvDriveTransferWait( u8PhyDrvNb );
+
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+  u32FarFsDrivesCommands[ u8PhyDrvNb ]++;
+#endif
+
   return xFarFsDrives[ u8PhyDrvNb ].pxWrite( pu8Buffer, xSector, u32Count );
 }
 
+#if ( 0 != EF_CONF_NON_BLOCKING )
+/* Start reading Sector(s) */
+ef_return_et  eEFPrvDriveReadStart (
+  ef_u08_t    u8PhyDrvNb,
+  ef_u08_t  * pu8Buffer,
+  ef_lba_t    xSector,
+  ef_u32_t    u32Count
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pu8Buffer );
+
+  ef_return_et  eRetVal;
+
+  /* If the drive is still busy with another started transfer */
+  if ( EF_DRIVE_TRANSFER_IDLE != u8FarFsDrivesTransfer[ u8PhyDrvNb ] )
+  {
+    eRetVal = EF_RET_LOCKED;
+  }
+  /* Else, if the drive cannot start a transfer, do a blocking one */
+  else if (    ( 0 == xFarFsDrives[ u8PhyDrvNb ].pxReadStart )
+            || ( 0 == xFarFsDrives[ u8PhyDrvNb ].pxTransferStatus ) )
+  {
+    eRetVal = xFarFsDrives[ u8PhyDrvNb ].pxRead( pu8Buffer, xSector, u32Count );
+  }
+  /* Else, if starting the transfer failed */
+  else if ( EF_RET_OK != xFarFsDrives[ u8PhyDrvNb ].pxReadStart( pu8Buffer, xSector, u32Count ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+  }
+  else
+  {
+    u8FarFsDrivesTransfer[ u8PhyDrvNb ] = EF_DRIVE_TRANSFER_BUSY;
+    eRetVal = EF_RET_PENDING;
+  }
+
+  return eRetVal;
+}
+
+/* Start writing Sector(s) */
+ef_return_et  eEFPrvDriveWriteStart (
+  ef_u08_t          u8PhyDrvNb,
+  const ef_u08_t  * pu8Buffer,
+  ef_lba_t          xSector,
+  ef_u32_t          u32Count
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pu8Buffer );
+
+  ef_return_et  eRetVal;
+
+  /* If the drive is still busy with another started transfer */
+  if ( EF_DRIVE_TRANSFER_IDLE != u8FarFsDrivesTransfer[ u8PhyDrvNb ] )
+  {
+    eRetVal = EF_RET_LOCKED;
+  }
+  /* Else, if the drive cannot start a transfer, do a blocking one */
+  else if (    ( 0 == xFarFsDrives[ u8PhyDrvNb ].pxWriteStart )
+            || ( 0 == xFarFsDrives[ u8PhyDrvNb ].pxTransferStatus ) )
+  {
+    eRetVal = xFarFsDrives[ u8PhyDrvNb ].pxWrite( pu8Buffer, xSector, u32Count );
+  }
+  /* Else, if starting the transfer failed */
+  else if ( EF_RET_OK != xFarFsDrives[ u8PhyDrvNb ].pxWriteStart( pu8Buffer, xSector, u32Count ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+  }
+  else
+  {
+    u8FarFsDrivesTransfer[ u8PhyDrvNb ] = EF_DRIVE_TRANSFER_BUSY;
+    eRetVal = EF_RET_PENDING;
+  }
+
+  return eRetVal;
+}
+
+/* Poll the started transfer */
+ef_return_et  eEFPrvDriveTransferPoll (
+  ef_u08_t  u8PhyDrvNb
+)
+{
+  ef_return_et  eRetVal = EF_RET_OK;
+
+  /* If the transfer is running, ask the drive */
+  if ( EF_DRIVE_TRANSFER_BUSY == u8FarFsDrivesTransfer[ u8PhyDrvNb ] )
+  {
+    eRetVal = xFarFsDrives[ u8PhyDrvNb ].pxTransferStatus( );
+    if ( EF_RET_PENDING != eRetVal )
+    {
+      u8FarFsDrivesTransfer[ u8PhyDrvNb ] = EF_DRIVE_TRANSFER_IDLE;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+  /* Else, if the transfer ended during a blocking request, collect its result */
+  else if ( EF_DRIVE_TRANSFER_DONE == u8FarFsDrivesTransfer[ u8PhyDrvNb ] )
+  {
+    eRetVal = eFarFsDrivesTransferResult[ u8PhyDrvNb ];
+    u8FarFsDrivesTransfer[ u8PhyDrvNb ] = EF_DRIVE_TRANSFER_IDLE;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  return eRetVal;
+}
+#endif
+
 /* Miscellaneous Functions */
 ef_return_et  eEFPrvDriveIOCtrl (
   ef_u08_t    u8PhyDrvNb,
@@ -121,9 +310,30 @@ ef_return_et  eEFPrvDriveIOCtrl (
    */
   //  EF_ASSERT_PRIVATE( 0 != pvBuffer );
 
+  (void) eEFPrvDriveTransferWait( u8PhyDrvNb );
+
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+  u32FarFsDrivesCommands[ u8PhyDrvNb ]++;
+#endif
+
   return xFarFsDrives[ u8PhyDrvNb ].pxCtrl( u8Cmd, pvBuffer );
 }
 
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+/* Get the number of commands issued to a drive */
+ef_return_et  eEFPrvDriveCommandsGet (
+  ef_u08_t    u8PhyDrvNb,
+  ef_u32_t  * pu32Commands
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pu32Commands );
+
+  *pu32Commands = u32FarFsDrivesCommands[ u8PhyDrvNb ];
+
+  return EF_RET_OK;
+}
+#endif
+
 /* Register a Drive */
 ef_return_et eEFPrvDriveRegister (
   ef_drive_functions_st * pxDriveFunctions
@@ -145,6 +355,14 @@ ef_return_et eEFPrvDriveRegister (
     xFarFsDrives[ u8FarFsDrivesNb ].pxWrite       = pxDriveFunctions->pxWrite;
     /* Register function to I/O control operation */
     xFarFsDrives[ u8FarFsDrivesNb ].pxCtrl        = pxDriveFunctions->pxCtrl;
+#if ( 0 != EF_CONF_NON_BLOCKING )
+    /* Register the optional functions to start a transfer and get its status */
+    xFarFsDrives[ u8FarFsDrivesNb ].pxReadStart       = pxDriveFunctions->pxReadStart;
+    xFarFsDrives[ u8FarFsDrivesNb ].pxWriteStart      = pxDriveFunctions->pxWriteStart;
+    xFarFsDrives[ u8FarFsDrivesNb ].pxTransferStatus  = pxDriveFunctions->pxTransferStatus;
+#endif
+    /* Next drive */
+    u8FarFsDrivesNb++;
   }
   else
   {
@@ -76,7 +76,427 @@ static ef_return_et eEFPrvFATClusterFindFree (
   ef_u32_t      * pu32Cluster
 );
 
+#if ( 0 != EF_CONF_FREE_EXTENTS )
+/**
+ *  @brief  Free extents index - Sort the extents by increasing length, the empty ones are dropped
+ *
+ *  @param  pxFS  Pointer to the file system object
+ */
+static void vEFPrvFATFreeExtentsSort (
+  ef_fs_st  * pxFS
+);
+
+/**
+ *  @brief  Free extents index - Insert an extent, the smallest one is dropped when the index is full
+ *
+ *  @param  pxFS      Pointer to the file system object
+ *  @param  u32Start  First cluster of the extent
+ *  @param  u32Length Number of clusters of the extent
+ */
+static void vEFPrvFATFreeExtentsInsert (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Start,
+  ef_u32_t    u32Length
+);
+
+/**
+ *  @brief  Free extents index - Merge a run of freed clusters with the extents around it
+ *
+ *  @param  pxFS      Pointer to the file system object
+ *  @param  u32Start  First freed cluster
+ *  @param  u32Length Number of freed clusters
+ */
+static void vEFPrvFATFreeExtentsRelease (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Start,
+  ef_u32_t    u32Length
+);
+
+/**
+ *  @brief  Free extents index - Follow a change of a FAT entry
+ *
+ *  A cluster becoming used is removed from its extent, a cluster becoming free is merged with the extents around it.
+ *  A run which does not fit in the index is dropped and the index is flagged as partial.
+ *
+ *  @param  pxFS        Pointer to the file system object
+ *  @param  u32Cluster  Cluster number
+ *  @param  u32Value    New value of the FAT entry
+ */
+static void vEFPrvFATFreeExtentsUpdate (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Cluster,
+  ef_u32_t    u32Value
+);
+
+/**
+ *  @brief  Free extents index - Check in the FAT that the first clusters of an extent are free
+ *
+ *  The index is only a hint of the FAT content. When one of the clusters is in use, or out of the volume, the extent
+ *  is trimmed to the free clusters before it and the index is flagged as partial.
+ *
+ *  @param  pxFS      Pointer to the file system object
+ *  @param  u32Index  Index of the extent
+ *  @param  u32Count  Number of clusters to check
+ *  @param  pbFree    Pointer to the result, EF_BOOL_TRUE when all the clusters are free
+ *
+ *  @return Function result
+ *  @retval EF_RET_OK       Succeeded
+ *  @retval EF_RET_INT_ERR  Assertion failed
+ */
+static ef_return_et eEFPrvFATFreeExtentCheck (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Index,
+  ef_u32_t    u32Count,
+  ef_bool_t * pbFree
+);
+
+#if ( 0 != EF_CONF_ALLOC_SNAPSHOT )
+/**
+ *  @brief  Free extents index - Check in the FAT all the clusters of the extents taken back from the snapshot
+ *
+ *  The snapshot only matches the FSINFO fields, another system may have changed the FAT without them. Each extent is
+ *  split around its clusters in use before the index is searched for the first time.
+ *
+ *  @param  pxFS  Pointer to the file system object
+ *
+ *  @return Function result
+ *  @retval EF_RET_OK       Succeeded
+ *  @retval EF_RET_INT_ERR  Assertion failed
+ */
+static ef_return_et eEFPrvFATFreeExtentsVerify (
+  ef_fs_st  * pxFS
+);
+#endif
+#endif
+
+/**
+ *  @brief  FAT handling - Follow the runs of contiguous clusters freed while removing a chain
+ *
+ *  When a run ends, the storage is informed its data is no longer used, the free cluster count in progress follows it
+ *  and, when the FAT entries have been cleared without eEFPrvFATSet(), the run is added to the free extents index.
+ *
+ *  @param  pxFS          Pointer to the file system object
+ *  @param  u32Cluster    Freed cluster, 0 to end the current run
+ *  @param  pu32RunStart  Pointer to the first cluster of the current run
+ *  @param  pu32RunNb     Pointer to the number of clusters of the current run (0:none)
+ *  @param  bIndex        Add the runs to the free extents index
+ */
+static void vEFPrvFATChainRunTrack (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Cluster,
+  ef_u32_t  * pu32RunStart,
+  ef_u32_t  * pu32RunNb,
+  ef_bool_t   bIndex
+);
+
+/**
+ *  @brief  FAT handling - Follow a run of clusters allocated or freed while the free clusters are being counted
+ *
+ *  Only the clusters the count has already passed are taken into account, the others are counted when reached.
+ *
+ *  @param  pxFS        Pointer to the file system object
+ *  @param  u32Cluster  First cluster of the run
+ *  @param  u32Count    Number of clusters of the run
+ *  @param  bFreed      The clusters have been freed, else allocated
+ */
+static void vEFPrvFATFreeScanFollow (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Cluster,
+  ef_u32_t    u32Count,
+  ef_bool_t   bFreed
+);
+
+#if ( 1 < EF_CONF_ALLOC_GROUPS )
+/**
+ *  @brief  FAT access - Get the first cluster of the allocation group of a new chain
+ *
+ *  The groups are used in turn, the next call returns the following group.
+ *
+ *  @param  pxFS  Pointer to the file system object
+ *
+ *  @return First cluster of the group
+ */
+static ef_u32_t u32EFPrvFATGroupStart (
+  ef_fs_st  * pxFS
+);
+#endif
+
 /* Local functions ------------------------------------------------------------------------------------------------- */
+#if ( 0 != EF_CONF_FREE_EXTENTS )
+static void vEFPrvFATFreeExtentsSort (
+  ef_fs_st  * pxFS
+)
+{
+  ef_free_extent_st xExtent;
+  ef_u32_t          u32Index;
+  ef_u32_t          u32Move;
+  ef_u32_t          u32Empty = 0;
+
+  /* Insertion sort, the index is short and nearly sorted */
+  for ( u32Index = 1 ; u32Index < pxFS->u8FreeExtNb ; u32Index++ )
+  {
+    xExtent = pxFS->xFreeExt[ u32Index ];
+    for ( u32Move = u32Index ; ( 0 != u32Move ) && ( pxFS->xFreeExt[ u32Move - 1 ].u32Length > xExtent.u32Length ) ; u32Move-- )
+    {
+      pxFS->xFreeExt[ u32Move ] = pxFS->xFreeExt[ u32Move - 1 ];
+    }
+    pxFS->xFreeExt[ u32Move ] = xExtent;
+  }
+  /* The empty extents are the first ones */
+  while ( ( u32Empty < pxFS->u8FreeExtNb ) && ( 0 == pxFS->xFreeExt[ u32Empty ].u32Length ) )
+  {
+    u32Empty++;
+  }
+  for ( u32Index = u32Empty ; u32Index < pxFS->u8FreeExtNb ; u32Index++ )
+  {
+    pxFS->xFreeExt[ u32Index - u32Empty ] = pxFS->xFreeExt[ u32Index ];
+  }
+  pxFS->u8FreeExtNb = (ef_u08_t) ( pxFS->u8FreeExtNb - u32Empty );
+}
+
+static void vEFPrvFATFreeExtentsInsert (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Start,
+  ef_u32_t    u32Length
+)
+{
+  /* If there is room left */
+  if ( EF_CONF_FREE_EXTENTS > pxFS->u8FreeExtNb )
+  {
+    pxFS->xFreeExt[ pxFS->u8FreeExtNb ].u32Start  = u32Start;
+    pxFS->xFreeExt[ pxFS->u8FreeExtNb ].u32Length = u32Length;
+    pxFS->u8FreeExtNb++;
+    vEFPrvFATFreeExtentsSort( pxFS );
+  }
+  /* Else, if it is larger than the smallest extent, it takes its place */
+  else if ( pxFS->xFreeExt[ 0 ].u32Length < u32Length )
+  {
+    pxFS->xFreeExt[ 0 ].u32Start  = u32Start;
+    pxFS->xFreeExt[ 0 ].u32Length = u32Length;
+    pxFS->bFreeExtPartial = EF_BOOL_TRUE;
+    vEFPrvFATFreeExtentsSort( pxFS );
+  }
+  else
+  {
+    pxFS->bFreeExtPartial = EF_BOOL_TRUE;
+  }
+}
+
+static void vEFPrvFATFreeExtentsRelease (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Start,
+  ef_u32_t    u32Length
+)
+{
+  ef_u32_t  u32Index;
+  ef_u32_t  u32Before = EF_CONF_FREE_EXTENTS;
+  ef_u32_t  u32After = EF_CONF_FREE_EXTENTS;
+
+  for ( u32Index = 0 ; u32Index < pxFS->u8FreeExtNb ; u32Index++ )
+  {
+    u32Before = ( u32Start == ( pxFS->xFreeExt[ u32Index ].u32Start + pxFS->xFreeExt[ u32Index ].u32Length ) )
+              ? u32Index : u32Before;
+    u32After  = ( ( u32Start + u32Length ) == pxFS->xFreeExt[ u32Index ].u32Start ) ? u32Index : u32After;
+  }
+  /* If the run joins two extents */
+  if ( ( EF_CONF_FREE_EXTENTS != u32Before ) && ( EF_CONF_FREE_EXTENTS != u32After ) )
+  {
+    pxFS->xFreeExt[ u32Before ].u32Length += u32Length + pxFS->xFreeExt[ u32After ].u32Length;
+    pxFS->xFreeExt[ u32After ].u32Length = 0;
+  }
+  /* Else, if the run follows an extent */
+  else if ( EF_CONF_FREE_EXTENTS != u32Before )
+  {
+    pxFS->xFreeExt[ u32Before ].u32Length += u32Length;
+  }
+  /* Else, if the run precedes an extent */
+  else if ( EF_CONF_FREE_EXTENTS != u32After )
+  {
+    pxFS->xFreeExt[ u32After ].u32Start   = u32Start;
+    pxFS->xFreeExt[ u32After ].u32Length += u32Length;
+  }
+  else
+  {
+    vEFPrvFATFreeExtentsInsert( pxFS, u32Start, u32Length );
+  }
+  vEFPrvFATFreeExtentsSort( pxFS );
+}
+
+static void vEFPrvFATFreeExtentsUpdate (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Cluster,
+  ef_u32_t    u32Value
+)
+{
+  ef_u32_t  u32Index;
+  ef_u32_t  u32End;
+
+  /* If the index is not built */
+  if ( EF_BOOL_FALSE == pxFS->bFreeExtValid )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if the cluster is freed */
+  else if ( 0 == u32Value )
+  {
+    vEFPrvFATFreeExtentsRelease( pxFS, u32Cluster, 1 );
+  }
+  else
+  {
+    for ( u32Index = 0 ; u32Index < pxFS->u8FreeExtNb ; u32Index++ )
+    {
+      ef_free_extent_st * pxExtent = &pxFS->xFreeExt[ u32Index ];
+      u32End = pxExtent->u32Start + pxExtent->u32Length;
+      /* If the cluster is in this extent */
+      if ( ( u32Cluster >= pxExtent->u32Start ) && ( u32Cluster < u32End ) )
+      {
+        /* Keep the part before the cluster, then add the part after it */
+        pxExtent->u32Length = u32Cluster - pxExtent->u32Start;
+        vEFPrvFATFreeExtentsSort( pxFS );
+        if ( ( u32Cluster + 1 ) < u32End )
+        {
+          vEFPrvFATFreeExtentsInsert( pxFS, u32Cluster + 1, u32End - ( u32Cluster + 1 ) );
+        }
+        else
+        {
+          EF_CODE_COVERAGE( );
+        }
+        break;
+      }
+    }
+  }
+}
+
+static ef_return_et eEFPrvFATFreeExtentCheck (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Index,
+  ef_u32_t    u32Count,
+  ef_bool_t * pbFree
+)
+{
+  ef_return_et        eRetVal = EF_RET_OK;
+  ef_free_extent_st * pxExtent = &pxFS->xFreeExt[ u32Index ];
+  ef_u32_t            u32Offset;
+  ef_u32_t            u32Value = 0;
+
+  *pbFree = EF_BOOL_TRUE;
+  for ( u32Offset = 0 ; ( EF_BOOL_FALSE != *pbFree ) && ( u32Offset < u32Count ) ; u32Offset++ )
+  {
+    /* If the cluster is out of the volume, it is not free */
+    if ( EF_RET_OK != eEFPrvFATClusterNbCheck( pxFS->u32FatEntriesNb, pxExtent->u32Start + u32Offset ) )
+    {
+      u32Value = 1;
+    }
+    else if ( EF_RET_OK != eEFPrvFATGet( pxFS, pxExtent->u32Start + u32Offset, &u32Value ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      break;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+
+    /* If the cluster is in use, the extent keeps the free clusters before it */
+    if ( 0 != u32Value )
+    {
+      pxExtent->u32Length   = u32Offset;
+      pxFS->bFreeExtPartial = EF_BOOL_TRUE;
+      *pbFree               = EF_BOOL_FALSE;
+      vEFPrvFATFreeExtentsSort( pxFS );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+
+  return eRetVal;
+}
+
+#if ( 0 != EF_CONF_ALLOC_SNAPSHOT )
+static ef_return_et eEFPrvFATFreeExtentsVerify (
+  ef_fs_st  * pxFS
+)
+{
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u32_t      u32Start = 0;
+  ef_u32_t      u32Index;
+  ef_u32_t      u32Found;
+  ef_u32_t      u32Cluster;
+  ef_u32_t      u32End;
+  ef_u32_t      u32Value = 0;
+
+  /* The extents are taken by increasing first cluster, the part after a cluster in use is checked as a next extent */
+  do
+  {
+    u32Found = pxFS->u8FreeExtNb;
+    for ( u32Index = 0 ; u32Index < pxFS->u8FreeExtNb ; u32Index++ )
+    {
+      if (    ( pxFS->xFreeExt[ u32Index ].u32Start > u32Start )
+           && (    ( pxFS->u8FreeExtNb == u32Found )
+                || ( pxFS->xFreeExt[ u32Index ].u32Start < pxFS->xFreeExt[ u32Found ].u32Start ) ) )
+      {
+        u32Found = u32Index;
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+    }
+
+    /* If all the extents have been checked */
+    if ( pxFS->u8FreeExtNb == u32Found )
+    {
+      pxFS->bFreeExtRestored = EF_BOOL_FALSE;
+    }
+    else
+    {
+      u32Start = pxFS->xFreeExt[ u32Found ].u32Start;
+      u32End   = u32Start + pxFS->xFreeExt[ u32Found ].u32Length;
+      for ( u32Cluster = u32Start ; ( 0 == u32Value ) && ( u32Cluster < u32End ) ; u32Cluster++ )
+      {
+        if ( EF_RET_OK != eEFPrvFATGet( pxFS, u32Cluster, &u32Value ) )
+        {
+          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+          break;
+        }
+        /* Else, if the cluster is in use, the extent is split around it */
+        else if ( 0 != u32Value )
+        {
+          vEFPrvFATFreeExtentsUpdate( pxFS, u32Cluster, u32Value );
+        }
+        else
+        {
+          EF_CODE_COVERAGE( );
+        }
+      }
+      u32Value = 0;
+    }
+  } while ( ( EF_RET_OK == eRetVal ) && ( pxFS->u8FreeExtNb != u32Found ) );
+
+  return eRetVal;
+}
+#endif
+#endif
+
+#if ( 1 < EF_CONF_ALLOC_GROUPS )
+static ef_u32_t u32EFPrvFATGroupStart (
+  ef_fs_st  * pxFS
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_u32_t  u32GroupSize = ( pxFS->u32FatEntriesNb - 2 ) / EF_CONF_ALLOC_GROUPS;
+  ef_u32_t  u32Cluster = 2 + ( u32GroupSize * pxFS->u8AllocGroup );
+
+  /* Next group */
+  pxFS->u8AllocGroup = (ef_u08_t) ( ( pxFS->u8AllocGroup + 1 ) % EF_CONF_ALLOC_GROUPS );
+
+  return u32Cluster;
+}
+#endif
+
 static ef_return_et eEFPrvFATClusterFindFree (
   ef_object_st  * pxObject,
   ef_u32_t        u32Cluster,
@@ -171,6 +591,97 @@ static ef_return_et eEFPrvFATClusterFindFree (
   return eRetVal;
 }
 
+static void vEFPrvFATChainRunTrack (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Cluster,
+  ef_u32_t  * pu32RunStart,
+  ef_u32_t  * pu32RunNb,
+  ef_bool_t   bIndex
+)
+{
+#if ( 0 != EF_CONF_USE_TRIM )
+  ef_lba_t  xRange[ 2 ];
+#endif
+
+  /* If the cluster follows the current run */
+  if ( ( 0 != *pu32RunNb ) && ( ( *pu32RunStart + *pu32RunNb ) == u32Cluster ) )
+  {
+    (*pu32RunNb)++;
+  }
+  else
+  {
+    /* If a run ends */
+    if ( 0 != *pu32RunNb )
+    {
+#if ( 0 != EF_CONF_USE_TRIM )
+      /* Inform storage device that the data in the block may be erased */
+      (void) eEFPrvFATClusterToSector( pxFS, *pu32RunStart, &xRange[ 0 ] );
+      (void) eEFPrvFATClusterToSector( pxFS, *pu32RunStart + *pu32RunNb - 1, &xRange[ 1 ] );
+      xRange[ 1 ] += pxFS->u8ClstSize - 1;
+      (void) eEFPrvDriveIOCtrl( pxFS->u8PhysDrv, CTRL_TRIM, xRange );
+#endif
+      vEFPrvFATFreeScanFollow( pxFS, *pu32RunStart, *pu32RunNb, EF_BOOL_TRUE );
+#if ( 0 != EF_CONF_FREE_EXTENTS )
+      /* If the FAT entries have been cleared without eEFPrvFATSet() */
+      if ( ( EF_BOOL_FALSE != bIndex ) && ( EF_BOOL_FALSE != pxFS->bFreeExtValid ) )
+      {
+        vEFPrvFATFreeExtentsRelease( pxFS, *pu32RunStart, *pu32RunNb );
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+#else
+      (void) bIndex;
+#endif
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    /* The cluster starts a new run */
+    *pu32RunStart = u32Cluster;
+    *pu32RunNb = ( 0 != u32Cluster ) ? 1 : 0;
+  }
+}
+
+static void vEFPrvFATFreeScanFollow (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Cluster,
+  ef_u32_t    u32Count,
+  ef_bool_t   bFreed
+)
+{
+#if ( 0 != EF_CONF_LAZY_FREE_COUNT )
+  ef_u32_t  u32Counted;
+
+  /* If no count is in progress, or it has not reached the run yet */
+  if ( ( 0 == pxFS->u32FreeScanNext ) || ( u32Cluster >= pxFS->u32FreeScanNext ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else
+  {
+    /* Number of clusters of the run already counted */
+    u32Counted = pxFS->u32FreeScanNext - u32Cluster;
+    u32Counted = ( u32Counted < u32Count ) ? u32Counted : u32Count;
+    if ( EF_BOOL_FALSE != bFreed )
+    {
+      pxFS->u32FreeScanNb += u32Counted;
+    }
+    else
+    {
+      pxFS->u32FreeScanNb -= ( u32Counted < pxFS->u32FreeScanNb ) ? u32Counted : pxFS->u32FreeScanNb;
+    }
+  }
+#else
+  (void) pxFS;
+  (void) u32Cluster;
+  (void) u32Count;
+  (void) bFreed;
+#endif
+}
+
 /* Public functions ------------------------------------------------------------------------------------------------ */
 
 /* Check if cluster number is valid */
@@ -387,8 +898,7 @@ ef_return_et eEFPrvFATSet (
 {
   EF_ASSERT_PRIVATE( 0 != pxFS );
 
-  /* Check if in valid range */
-  ef_return_et eRetVal = EF_RET_INT_ERR;
+  ef_return_et eRetVal = EF_RET_OK;
 
   /* If Cluster not in valid range */
   if ( EF_RET_OK != eEFPrvFATClusterNbCheck( pxFS->u32FatEntriesNb, u32Cluster ) )
@@ -397,8 +907,6 @@ ef_return_et eEFPrvFATSet (
   }
   else if ( 0 != ( EF_FS_FAT32 & pxFS->u8FsType ) )
   {
-    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
-
       /* Load the FS window with the sector containing the FAT Cluster Number */
       if ( EF_RET_OK != eEFPrvFSWindowLoad(   pxFS,
                                               pxFS->xFatBase
@@ -486,9 +994,21 @@ ef_return_et eEFPrvFATSet (
     eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
   }
 
-  return eRetVal;
-}
-
+#if ( 0 != EF_CONF_FREE_EXTENTS )
+  /* Keep the free extents index in line with the FAT */
+  if ( EF_RET_OK == eRetVal )
+  {
+    vEFPrvFATFreeExtentsUpdate( pxFS, u32Cluster, u32NewValue );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+#endif
+
+  return eRetVal;
+}
+
 #if 0
 /* FAT handling - Remove a cluster chain */
 ef_return_et eEFPrvFATChainRemoveFAT (
@@ -667,90 +1187,136 @@ ef_return_et eEFPrvFATChainRemove (
   EF_ASSERT_PRIVATE( 0 != pxObject );
 
   ef_return_et  eRetVal = EF_RET_OK;
-  ef_fs_st *pxFS = pxObject->pxFS;
-
-  /* Check if in valid range */
+  ef_fs_st    * pxFS = pxObject->pxFS;
+  ef_bool_t     bWindow = ( 0 == ( EF_FS_FAT12 & pxFS->u8FsType ) ) ? EF_BOOL_TRUE : EF_BOOL_FALSE;
+  ef_u32_t      u32EntrySize = ( 0 != ( EF_FS_FAT32 & pxFS->u8FsType ) ) ? 4 : 2;
+  ef_u32_t      u32SectorEntries = EF_SECTOR_SIZE( pxFS ) / u32EntrySize;
+  ef_u32_t      u32SectorFirst;
+  ef_u32_t      u32Next = 0;
+  ef_u32_t      u32EndMin = ( 4 == u32EntrySize ) ? 0x0FFFFFF8 : ( EF_BOOL_FALSE != bWindow ) ? 0xFFF8 : 0xFF8;
+  ef_u32_t      u32RunStart = 0;
+  ef_u32_t      u32RunNb = 0;
+  ef_u32_t      u32FreedNb = 0;
+  ef_u08_t    * pu8Entry;
+
+  /* If cluster not in valid range */
   if ( EF_RET_OK != eEFPrvFATClusterNbCheck( pxFS->u32FatEntriesNb, u32Cluster ) )
   {
     eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
   }
+  /* Else, if marking the previous cluster 'EOC' on the FAT failed */
+  else if (    ( 0 != u32ClusterPrev )
+            && ( EF_RET_OK != eEFPrvFATSet( pxFS, u32ClusterPrev, EF_FAT_END_OF_CHAIN ) ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
   else
   {
-    /* Mark the previous cluster 'EOC' on the FAT if it exists */
-    if ( 0 != u32ClusterPrev )
-    {
-      eRetVal = eEFPrvFATSet( pxFS, u32ClusterPrev, EF_FAT_END_OF_CHAIN );
-    }
-    if ( EF_RET_OK != eRetVal )
+    /* Remove the chain, stop on its last link or on a free cluster */
+    while ( ( EF_RET_OK == eRetVal ) && ( 2 <= u32Cluster ) && ( pxFS->u32FatEntriesNb > u32Cluster ) )
     {
-      ; /* Error */
-    }
-    else
-    {
-      ef_u32_t  nxt;
-    #if ( 0 != EF_CONF_USE_TRIM )
-      ef_u32_t  scl = u32Cluster;
-      ef_u32_t  ecl = u32Cluster;
-    #endif
-
-      /* Remove the chain */
-      do
+      /* If FAT12, an entry can straddle two FAT sectors, each entry is freed on its own */
+      if ( EF_BOOL_FALSE == bWindow )
       {
-        /* Get cluster status */
-        eRetVal = eEFPrvFATGet( pxFS, u32Cluster, &nxt );
-        /* Empty cluster? */
-        if ( 0 == nxt )
+        if ( EF_RET_OK != eEFPrvFATGet( pxFS, u32Cluster, &u32Next ) )
         {
-          break;
+          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
         }
-        /* Else if an error */
-        else if ( EF_RET_OK != eRetVal )
+        /* Else, if the cluster is already free */
+        else if ( 0 == u32Next )
         {
-          return eRetVal;
+          EF_CODE_COVERAGE( );
         }
-        /* Mark the cluster 'free' on the FAT */
-        eRetVal = eEFPrvFATSet( pxFS, u32Cluster, 0 );
-        if ( EF_RET_OK != eRetVal )
+        else if ( EF_RET_OK != eEFPrvFATSet( pxFS, u32Cluster, 0 ) )
         {
-          return eRetVal;
-        }
-    //    else
-    //    {
-        if ( pxFS->u32ClstFreeNb < ( pxFS->u32FatEntriesNb - 2 ) )
-        {  /* Update FSINFO */
-          pxFS->u32ClstFreeNb++;
-          pxFS->u8FsInfoFlags |= 1;
-        }
-    #if EF_CONF_USE_TRIM
-        /* Is next cluster contiguous? */
-        if ( ecl + 1 == nxt )
-        {  /* Is next cluster contiguous? */
-          ecl = nxt;
+          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
         }
         else
-        {        /* End of contiguous cluster block */
-          ef_lba_t rt[ 2 ];
-          ef_lba_t xSector;
-          /* Start of data area to be freed */
-          (void) eEFPrvFATClusterToSector( pxFS, scl, &xSector );
-          rt[ 0 ] = xSector;
-          /* End of data area to be freed */
-          (void) eEFPrvFATClusterToSector( pxFS, ecl, &xSector );
-          rt[ 1 ] = xSector + pxFS->u8ClstSize - 1;
-          /* Inform storage device that the data in the block may be erased */
-          (void) eEFPrvDriveIOCtrl( pxFS->u8PhysDrv, CTRL_TRIM, rt );
-          scl = nxt;
-          ecl = nxt;
+        {
+          vEFPrvFATChainRunTrack( pxFS, u32Cluster, &u32RunStart, &u32RunNb, bWindow );
+          u32FreedNb++;
         }
-    #endif
-        /* Next cluster */
-        u32Cluster = nxt;
-      /* Repeat while not the last link */
-      } while ( u32Cluster < pxFS->u32FatEntriesNb );
+      }
+      /* Else, if loading the FAT sector holding the entry failed */
+      else if ( EF_RET_OK != eEFPrvFSWindowLoad(   pxFS,
+                                                   pxFS->xFatBase
+                                                 + ( u32Cluster / u32SectorEntries ) ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      }
+      else
+      {
+        /* Free all the entries of the chain held by this FAT sector directly in the window */
+        u32SectorFirst = u32Cluster - ( u32Cluster % u32SectorEntries );
+        do
+        {
+          pu8Entry = pxFS->pu8Window + ( u32Cluster - u32SectorFirst ) * u32EntrySize;
+          u32Next = ( 4 == u32EntrySize ) ? ( 0x0FFFFFFF & u32EFPortLoad( pu8Entry ) ) : u16EFPortLoad( pu8Entry );
+          /* If the cluster is already free */
+          if ( 0 == u32Next )
+          {
+            break;
+          }
+          /* Else, if FAT32, the upper 4 bits are kept */
+          else if ( 4 == u32EntrySize )
+          {
+            vEFPortStoreu32( pu8Entry, 0xF0000000 & u32EFPortLoad( pu8Entry ) );
+          }
+          else
+          {
+            vEFPortStoreu16( pu8Entry, 0 );
+          }
+          pxFS->u8WinFlags = EF_FS_WIN_DIRTY;
+          vEFPrvFATChainRunTrack( pxFS, u32Cluster, &u32RunStart, &u32RunNb, bWindow );
+          u32FreedNb++;
+          u32Cluster = u32Next;
+        /* Repeat while the next link is a cluster of this FAT sector */
+        } while (    ( 2 <= u32Next )
+                  && ( u32Next >= u32SectorFirst )
+                  && ( ( u32Next - u32SectorFirst ) < u32SectorEntries ) );
+      }
 
-      eRetVal = EF_RET_OK;
+      /* If the entry was read, follow the link */
+      if ( EF_RET_OK == eRetVal )
+      {
+        u32Cluster = u32Next;
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+    }
+    /* End the last run */
+    vEFPrvFATChainRunTrack( pxFS, 0, &u32RunStart, &u32RunNb, bWindow );
+
+    /* Update FSINFO once for the whole chain */
+    if ( pxFS->u32ClstFreeNb <= ( pxFS->u32FatEntriesNb - 2 ) )
+    {
+      pxFS->u32ClstFreeNb += u32FreedNb;
+      if ( pxFS->u32ClstFreeNb > ( pxFS->u32FatEntriesNb - 2 ) )
+      {
+        pxFS->u32ClstFreeNb = pxFS->u32FatEntriesNb - 2;
+      }
+      pxFS->u8FsInfoFlags |= 1;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+
+    /* If the chain ends neither on a free cluster nor on an end of chain mark, the FAT is broken */
+    if (    ( EF_RET_OK == eRetVal )
+         && ( 0 != u32Next )
+         && ( u32EndMin > u32Next ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
     }
   }
+
   return eRetVal;
 }
 
@@ -775,7 +1341,14 @@ ef_return_et eEFPrvFATChainCreate (
     /* GET THE CLUSTER FROM WHERE TO START SEARCHING BEGIN */
     /* If we create a new chain */
     /* Suggested cluster to start to find */
+#if ( 1 < EF_CONF_ALLOC_GROUPS )
+    /* The beginning of the next allocation group, unless a run has been prepared for this chain */
+    ef_u32_t  u32Cluster = ( EF_BOOL_FALSE != pxFS->bClstLastHint ) ? pxFS->u32ClstLast : u32EFPrvFATGroupStart( pxFS );
+
+    pxFS->bClstLastHint = EF_BOOL_FALSE;
+#else
     ef_u32_t  u32Cluster = pxFS->u32ClstLast;
+#endif
     /* If    last cluster is before the beginning of the FAT
      *    OR last cluster is after the end of the FAT
      */
@@ -813,6 +1386,7 @@ ef_return_et eEFPrvFATChainCreate (
       {
         pxFS->u32ClstFreeNb--;
       }
+      vEFPrvFATFreeScanFollow( pxFS, u32ClusterNew, 1, EF_BOOL_FALSE );
       pxFS->u8FsInfoFlags |= 1;
       /* Return new cluster numbers */
       *pu32Cluster = u32ClusterNew;
@@ -855,8 +1429,8 @@ ef_return_et eEFPrvFATChainStretch (
     /* There is an eror */
     eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
   }
-  /* Else, if we have a valid linked cluster */
-  else if ( pxFS->u32FatEntriesNb >= u32ClusterValue )
+  /* Else, if we have a valid linked cluster (a reserved or already written cluster) */
+  else if ( pxFS->u32FatEntriesNb > u32ClusterValue )
   {
     ef_u32_t  u32ClusterNew = u32ClusterValue;
     /* If getting the next cluster status failed */
@@ -884,22 +1458,41 @@ ef_return_et eEFPrvFATChainStretch (
     EF_CODE_COVERAGE( );
   }
   /* Else we have an End Of Chain cluster */
-  /* If there are free clusters */
-  if ( 0 == pxFS->u32ClstFreeNb )
-  //if ( pxFS->u32FatEntriesNb < u32ClusterValue )
+  /* If the chain has been followed, or the cluster status is wrong */
+  if ( EF_RET_FAT_FULL != eRetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if there are no free clusters */
+  else if ( 0 == pxFS->u32ClstFreeNb )
   {
     /* There is an eror */
     eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
   }
-  else //if ( pxFS->u32FatEntriesNb < u32ClusterValue )
+  else
   {
     /* Stretching an existing chain? */
-    /* Suggested cluster to start to find */
-    u32ClusterStart = pxFS->u32ClstLast;
+    /* Suggested cluster to start to find: the one following the chain keeps the object contiguous */
+    u32ClusterStart = u32Cluster + 1;
+    /* If    it is not a valid cluster
+     *    OR getting its status failed
+     *    OR it is not free
+     */
+    if (    ( EF_RET_OK != eEFPrvFATClusterNbCheck( pxFS->u32FatEntriesNb, u32ClusterStart ) )
+         || ( EF_RET_OK != eEFPrvFATGet( pxFS, u32ClusterStart, &u32ClusterValue ) )
+         || ( 0 != u32ClusterValue ) )
+    {
+      /* Fall back to the last allocated cluster of the volume */
+      u32ClusterStart = pxFS->u32ClstLast;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
     /* If    last cluster is null
      *    OR last cluster is not known
      */
-    if ( EF_RET_OK == eEFPrvFATClusterNbCheck( pxFS->u32FatEntriesNb, u32Cluster ) )
+    if ( EF_RET_OK != eEFPrvFATClusterNbCheck( pxFS->u32FatEntriesNb, u32ClusterStart ) )
     {
       /* Start searching from beggining of the FAT */
       u32ClusterStart = 2;
@@ -930,6 +1523,7 @@ ef_return_et eEFPrvFATChainStretch (
       {
         pxFS->u32ClstFreeNb--;
       }
+      vEFPrvFATFreeScanFollow( pxFS, u32ClusterNew, 1, EF_BOOL_FALSE );
       pxFS->u8FsInfoFlags |= 1;
       /* Function completed succesfully */
       eRetVal = EF_RET_OK;
@@ -942,5 +1536,591 @@ ef_return_et eEFPrvFATChainStretch (
   return eRetVal;
 }
 
+ef_return_et eEFPrvFATChainExtend (
+  ef_object_st  * pxObject,
+  ef_u32_t        u32Cluster,
+  ef_bool_t       bAdjacent,
+  ef_u32_t      * pu32Count,
+  ef_u32_t      * pu32Cluster
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxObject );
+  EF_ASSERT_PRIVATE( 0 != pu32Count );
+  EF_ASSERT_PRIVATE( 0 != pu32Cluster );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_fs_st    * pxFS = pxObject->pxFS;
+  ef_u32_t      u32Wanted = *pu32Count;
+  ef_u32_t      u32RunNb = 0;
+  ef_u32_t      u32RunLast = 0;
+  ef_u32_t      u32ClusterValue;
+  ef_u32_t      u32ClusterStop;
+
+  /* Search from the cluster following the chain, else from the last allocated cluster */
+  ef_u32_t      u32ClusterFind = u32Cluster + 1;
+#if ( 1 < EF_CONF_ALLOC_GROUPS )
+  /* A new chain starts in the next allocation group */
+  if ( 0 == u32Cluster )
+  {
+    u32ClusterFind = u32EFPrvFATGroupStart( pxFS );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+#endif
+  if ( EF_RET_OK != eEFPrvFATClusterNbCheck( pxFS->u32FatEntriesNb, u32ClusterFind ) )
+  {
+    u32ClusterFind = pxFS->u32ClstLast;
+    if ( EF_RET_OK != eEFPrvFATClusterNbCheck( pxFS->u32FatEntriesNb, u32ClusterFind ) )
+    {
+      u32ClusterFind = 2;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+  u32ClusterStop = u32ClusterFind;
+
+  /* SEARCH FOR A CONTIGUOUS FREE RUN BEGIN */
+  /* If there is nothing to link */
+  if ( 0 == u32Wanted )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if the chain is at the end of the FAT */
+  else if (    ( EF_BOOL_FALSE != bAdjacent )
+            && ( ( u32Cluster + 1 ) != u32ClusterFind ) )
+  {
+    u32Wanted = 0;
+  }
+  /* Else, if the free clusters are known and not enough */
+  else if (    ( pxFS->u32ClstFreeNb <= ( pxFS->u32FatEntriesNb - 2 ) )
+            && ( pxFS->u32ClstFreeNb < u32Wanted ) )
+  {
+    if ( EF_BOOL_FALSE != bAdjacent )
+    {
+      u32Wanted = pxFS->u32ClstFreeNb;
+    }
+    else
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+    }
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  while ( ( EF_RET_OK == eRetVal ) && ( u32RunNb < u32Wanted ) )
+  {
+    /* If getting the cluster status failed */
+    if ( EF_RET_OK != eEFPrvFATGet( pxFS, u32ClusterFind, &u32ClusterValue ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+    }
+    /* Else, if a free cluster, the run goes on */
+    else if ( 0 == u32ClusterValue )
+    {
+      u32RunNb++;
+      u32RunLast = u32ClusterFind;
+    }
+    /* Else, if the run must follow the chain, it ends here */
+    else if ( EF_BOOL_FALSE != bAdjacent )
+    {
+      u32Wanted = u32RunNb;
+    }
+    else
+    {
+      u32RunNb = 0;
+    }
+
+    /* If the run is complete */
+    if ( ( EF_RET_OK != eRetVal ) || ( u32RunNb == u32Wanted ) )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    /* Else, if the end of the FAT is reached, runs cannot wrap around */
+    else if ( pxFS->u32FatEntriesNb <= ++u32ClusterFind )
+    {
+      /* If the run must follow the chain, it ends here */
+      if ( EF_BOOL_FALSE != bAdjacent )
+      {
+        u32Wanted = u32RunNb;
+      }
+      /* Else, if the whole FAT has been scanned */
+      else if ( 2 == u32ClusterStop )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+      }
+      else
+      {
+        u32ClusterFind = 2;
+        u32RunNb = 0;
+      }
+    }
+    /* Else, if the whole FAT has been scanned */
+    else if ( u32ClusterStop == u32ClusterFind )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+  /* SEARCH FOR A CONTIGUOUS FREE RUN END */
+
+  /* LINK THE RUN BEGIN */
+  if ( ( EF_RET_OK == eRetVal ) && ( 0 != u32Wanted ) )
+  {
+    eRetVal = eEFPrvFATChainLink( pxFS, u32Cluster, u32RunLast + 1 - u32Wanted, u32Wanted );
+    *pu32Cluster = u32RunLast + 1 - u32Wanted;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* LINK THE RUN END */
+
+  *pu32Count = ( EF_RET_OK == eRetVal ) ? u32Wanted : 0;
+
+  return eRetVal;
+}
+
+ef_return_et eEFPrvFATChainLink (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Cluster,
+  ef_u32_t    u32ClusterFirst,
+  ef_u32_t    u32Count
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+  EF_ASSERT_PRIVATE( 0 != u32Count );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u32_t      u32RunLast = u32ClusterFirst + u32Count - 1;
+  ef_u32_t      u32ClusterLink;
+
+  for (  u32ClusterLink = u32ClusterFirst ;
+         ( EF_RET_OK == eRetVal ) && ( u32ClusterLink <= u32RunLast ) ;
+         u32ClusterLink++ )
+  {
+    /* Link to the next cluster of the run, or mark the end of chain 'EOC' */
+    if ( EF_RET_OK != eEFPrvFATSet(   pxFS,
+                                      u32ClusterLink,
+                                      ( u32ClusterLink == u32RunLast ) ? EF_FAT_END_OF_CHAIN : ( u32ClusterLink + 1 ) ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+
+  /* If linking the run from the chain failed */
+  if (    ( EF_RET_OK == eRetVal )
+       && ( 0 != u32Cluster )
+       && ( EF_RET_OK != eEFPrvFATSet( pxFS, u32Cluster, u32ClusterFirst ) ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  else if ( EF_RET_OK == eRetVal )
+  {
+    /* Update FSINFO */
+    pxFS->u32ClstLast = u32RunLast;
+    if ( pxFS->u32ClstFreeNb <= ( pxFS->u32FatEntriesNb - 2 ) )
+    {
+      pxFS->u32ClstFreeNb -= u32Count;
+    }
+    vEFPrvFATFreeScanFollow( pxFS, u32ClusterFirst, u32Count, EF_BOOL_FALSE );
+    pxFS->u8FsInfoFlags |= 1;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  return eRetVal;
+}
+
+#if ( 0 != EF_CONF_FREE_EXTENTS )
+ef_return_et eEFPrvFATFreeExtentsBuild (
+  ef_fs_st  * pxFS
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u32_t      u32Cluster;
+  ef_u32_t      u32Value;
+  ef_u32_t      u32RunStart = 0;
+  ef_u32_t      u32RunNb = 0;
+  ef_u32_t      u32FreeNb = 0;
+
+  pxFS->u8FreeExtNb     = 0;
+  pxFS->bFreeExtValid   = EF_BOOL_FALSE;
+  pxFS->bFreeExtPartial = EF_BOOL_FALSE;
+#if ( 0 != EF_CONF_ALLOC_SNAPSHOT )
+  pxFS->bFreeExtRestored = EF_BOOL_FALSE;
+#endif
+
+  /* One sequential pass over the FAT, the window keeps each FAT sector for all its entries */
+  for ( u32Cluster = 2 ; ( EF_RET_OK == eRetVal ) && ( u32Cluster <= pxFS->u32FatEntriesNb ) ; u32Cluster++ )
+  {
+    /* The end of the FAT closes the last run */
+    if ( pxFS->u32FatEntriesNb == u32Cluster )
+    {
+      u32Value = 1;
+    }
+    else if ( EF_RET_OK != eEFPrvFATGet( pxFS, u32Cluster, &u32Value ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+
+    /* If a free cluster */
+    if ( ( EF_RET_OK == eRetVal ) && ( 0 == u32Value ) )
+    {
+      u32RunStart = ( 0 == u32RunNb ) ? u32Cluster : u32RunStart;
+      u32RunNb++;
+      u32FreeNb++;
+    }
+    /* Else, if a run of free clusters ends */
+    else if ( ( EF_RET_OK == eRetVal ) && ( 0 != u32RunNb ) )
+    {
+      vEFPrvFATFreeExtentsInsert( pxFS, u32RunStart, u32RunNb );
+      u32RunNb = 0;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+
+  if ( EF_RET_OK == eRetVal )
+  {
+    pxFS->bFreeExtValid = EF_BOOL_TRUE;
+    /* The pass gives the exact number of free clusters, a count in progress is no longer needed */
+    pxFS->u32ClstFreeNb = u32FreeNb;
+    pxFS->u8FsInfoFlags |= 1;
+#if ( 0 != EF_CONF_LAZY_FREE_COUNT )
+    pxFS->u32FreeScanNext = 0;
+#endif
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  return eRetVal;
+}
+
+ef_return_et eEFPrvFATFreeExtentFind (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Count,
+  ef_u32_t    u32Cluster,
+  ef_u32_t  * pu32Cluster
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+  EF_ASSERT_PRIVATE( 0 != pu32Cluster );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u32_t      u32Low;
+  ef_u32_t      u32High;
+  ef_u32_t      u32Index;
+  ef_u32_t      u32Found;
+  ef_u32_t      u32Try = 0;
+  ef_bool_t     bFree;
+
+  *pu32Cluster = 0;
+  /* Build the index if needed, rebuild a partial index once when it has no fitting extent */
+  while ( ( EF_RET_OK == eRetVal ) && ( 0 == *pu32Cluster ) && ( 2 > u32Try ) )
+  {
+    if (    ( EF_BOOL_FALSE != pxFS->bFreeExtValid )
+         && ( ( 0 == u32Try ) || ( EF_BOOL_FALSE == pxFS->bFreeExtPartial ) ) )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    else if ( EF_RET_OK != eEFPrvFATFreeExtentsBuild( pxFS ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      break;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+#if ( 0 != EF_CONF_ALLOC_SNAPSHOT )
+    /* The extents taken back from the snapshot are checked in the FAT before the first search */
+    if ( ( EF_BOOL_FALSE != pxFS->bFreeExtRestored ) && ( EF_RET_OK != eEFPrvFATFreeExtentsVerify( pxFS ) ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      break;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+#endif
+
+    /* The extent following the chain is preferred, the object stays contiguous */
+    u32Found = pxFS->u8FreeExtNb;
+    for ( u32Index = 0 ; ( 0 != u32Cluster ) && ( u32Index < pxFS->u8FreeExtNb ) ; u32Index++ )
+    {
+      if (    ( ( u32Cluster + 1 ) == pxFS->xFreeExt[ u32Index ].u32Start )
+           && ( u32Count <= pxFS->xFreeExt[ u32Index ].u32Length ) )
+      {
+        u32Found = u32Index;
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+    }
+    /* Else, best fit: the smallest extent large enough, the index is sorted by length */
+    u32Low  = 0;
+    u32High = pxFS->u8FreeExtNb;
+    while ( u32Low < u32High )
+    {
+      u32Index = ( u32Low + u32High ) / 2;
+      if ( pxFS->xFreeExt[ u32Index ].u32Length < u32Count )
+      {
+        u32Low = u32Index + 1;
+      }
+      else
+      {
+        u32High = u32Index;
+      }
+    }
+    if ( ( pxFS->u8FreeExtNb == u32Found ) && ( u32Low < pxFS->u8FreeExtNb ) )
+    {
+      u32Found = u32Low;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+
+    /* If no extent is large enough, the next try rebuilds a partial index */
+    if ( pxFS->u8FreeExtNb == u32Found )
+    {
+      u32Try++;
+    }
+    /* Else, if the clusters are not all free in the FAT, the trimmed index is searched again */
+    else if ( EF_RET_OK != eEFPrvFATFreeExtentCheck( pxFS, u32Found, u32Count, &bFree ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+    }
+    else if ( EF_BOOL_FALSE == bFree )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    else
+    {
+      *pu32Cluster = pxFS->xFreeExt[ u32Found ].u32Start;
+    }
+  }
+
+  /* If no extent is large enough */
+  if ( ( EF_RET_OK == eRetVal ) && ( 0 == *pu32Cluster ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  return eRetVal;
+}
+
+#else
+
+ef_return_et eEFPrvFATFreeExtentFind (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Count,
+  ef_u32_t    u32Cluster,
+  ef_u32_t  * pu32Cluster
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+  EF_ASSERT_PRIVATE( 0 != pu32Cluster );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u32_t      u32Next;
+  ef_u32_t      u32Value;
+  ef_u32_t      u32RunStart = 0;
+  ef_u32_t      u32RunNb;
+  ef_u32_t      u32Try;
+
+  *pu32Cluster = 0;
+  /* The first try checks the run following the chain, the second one takes the first run large enough */
+  u32Try = ( 0 != u32Cluster ) ? 0 : 1;
+  for ( ; ( EF_RET_OK == eRetVal ) && ( 0 == *pu32Cluster ) && ( 2 > u32Try ) ; u32Try++ )
+  {
+    u32RunNb = 0;
+    u32Next  = ( 0 == u32Try ) ? ( u32Cluster + 1 ) : 2;
+    for ( ; ( u32Next < pxFS->u32FatEntriesNb ) && ( u32RunNb < u32Count ) ; u32Next++ )
+    {
+      if ( EF_RET_OK != eEFPrvFATGet( pxFS, u32Next, &u32Value ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+        break;
+      }
+      /* Else, if a free cluster */
+      else if ( 0 == u32Value )
+      {
+        u32RunStart = ( 0 == u32RunNb ) ? u32Next : u32RunStart;
+        u32RunNb++;
+      }
+      /* Else, if the run following the chain is too short */
+      else if ( 0 == u32Try )
+      {
+        break;
+      }
+      else
+      {
+        u32RunNb = 0;
+      }
+    }
+    if ( ( EF_RET_OK == eRetVal ) && ( u32RunNb >= u32Count ) )
+    {
+      *pu32Cluster = u32RunStart;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+
+  /* If no run is large enough */
+  if ( ( EF_RET_OK == eRetVal ) && ( 0 == *pu32Cluster ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  return eRetVal;
+}
+
+#endif /* ( 0 != EF_CONF_FREE_EXTENTS ) */
+
+#if ( 0 != EF_CONF_LAZY_FREE_COUNT )
+ef_return_et eEFPrvFATFreeCountScan (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32SectorsNb
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u32_t      u32SectorEntries;
+  ef_u32_t      u32EntriesNb;
+  ef_u32_t      u32Value;
+
+  /* Number of FAT entries held by a FAT sector */
+  if ( 0 != ( EF_FS_FAT12 & pxFS->u8FsType ) )
+  {
+    u32SectorEntries = ( (ef_u32_t) EF_SECTOR_SIZE( pxFS ) * 2 ) / 3;
+  }
+  else if ( 0 != ( EF_FS_FAT16 & pxFS->u8FsType ) )
+  {
+    u32SectorEntries = (ef_u32_t) EF_SECTOR_SIZE( pxFS ) / 2;
+  }
+  else
+  {
+    u32SectorEntries = (ef_u32_t) EF_SECTOR_SIZE( pxFS ) / 4;
+  }
+  /* Number of FAT entries to count by this call, the whole FAT when no limit is given */
+  if ( ( 0 == u32SectorsNb ) || ( u32SectorsNb > ( pxFS->u32FatEntriesNb / u32SectorEntries ) ) )
+  {
+    u32EntriesNb = pxFS->u32FatEntriesNb;
+  }
+  else
+  {
+    u32EntriesNb = u32SectorsNb * u32SectorEntries;
+  }
+
+  /* If the number of free clusters is known */
+  if ( pxFS->u32ClstFreeNb <= ( pxFS->u32FatEntriesNb - 2 ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else
+  {
+    /* If no count is in progress, start it from the first cluster */
+    if ( 0 == pxFS->u32FreeScanNext )
+    {
+      pxFS->u32FreeScanNext = 2;
+      pxFS->u32FreeScanNb   = 0;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    /* Count the free entries, the window keeps each FAT sector for all its entries */
+    while (    ( EF_RET_OK == eRetVal )
+            && ( 0 != u32EntriesNb )
+            && ( pxFS->u32FreeScanNext < pxFS->u32FatEntriesNb ) )
+    {
+      if ( EF_RET_OK != eEFPrvFATGet( pxFS, pxFS->u32FreeScanNext, &u32Value ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      }
+      else
+      {
+        /* If a free cluster */
+        if ( 0 == u32Value )
+        {
+          pxFS->u32FreeScanNb++;
+          /* Without a last allocated cluster, the search for a free cluster starts from the first one found */
+          if ( EF_RET_OK != eEFPrvFATClusterNbCheck( pxFS->u32FatEntriesNb, pxFS->u32ClstLast ) )
+          {
+            pxFS->u32ClstLast = pxFS->u32FreeScanNext - 1;
+          }
+          else
+          {
+            EF_CODE_COVERAGE( );
+          }
+        }
+        else
+        {
+          EF_CODE_COVERAGE( );
+        }
+        pxFS->u32FreeScanNext++;
+        u32EntriesNb--;
+      }
+    }
+    /* If the whole FAT has been counted */
+    if ( ( EF_RET_OK == eRetVal ) && ( pxFS->u32FreeScanNext >= pxFS->u32FatEntriesNb ) )
+    {
+      pxFS->u32ClstFreeNb   = pxFS->u32FreeScanNb;
+      pxFS->u8FsInfoFlags  |= 1;
+      pxFS->u32FreeScanNext = 0;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+
+  return eRetVal;
+}
+#endif
+
 /* ***************************************************************************************************************** */
 /* END OF FILE ***************************************************************************************************** */
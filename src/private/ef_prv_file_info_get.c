@@ -69,7 +69,7 @@ ef_return_et eEFPrvDirFileInfosGet (
   /* Invalidate file info */
   pxFileInfo->xName[ 0 ] = 0;
   /* If read pointer has reached end of directory */
-  if ( 0 != pxDir->xSector )
+  if ( 0 == pxDir->xSector )
   {
     eRetVal = EF_RET_ERROR;
   }
@@ -79,11 +79,6 @@ ef_return_et eEFPrvDirFileInfosGet (
     /* Copy name body and extension */
     for ( ef_u32_t u32IdxSrc = 0 ; 11 > u32IdxSrc ; u32IdxSrc++ )
     {
-      if ( 8 == u32IdxSrc )
-      {
-        /* Insert a . if extension is exist */
-        pxFileInfo->xName[ u32IdxDst++ ] = '.';
-      }
       TCHAR c = (TCHAR)pxDir->pu8Dir[ u32IdxSrc ];
       /* If a padding space */
       if ( ' ' == c )
@@ -101,7 +96,11 @@ ef_return_et eEFPrvDirFileInfosGet (
       {
         EF_CODE_COVERAGE( );
       }
-      /* Else, if a replaced EF_DIR_DELETED_MASK character */
+      if ( 8 == u32IdxSrc )
+      {
+        /* Insert a . if extension is exist */
+        pxFileInfo->xName[ u32IdxDst++ ] = '.';
+      }
       pxFileInfo->xName[ u32IdxDst++ ] = c;
     }
     pxFileInfo->xName[ u32IdxDst ] = 0;
@@ -118,166 +117,204 @@ ef_return_et eEFPrvDirFileInfosGet (
 
 #else
 
-  ef_return_et  eRetVal = EF_RET_ERROR;
-  ef_u32_t si, di;
-  ef_u08_t lcf;
-  ucs2_t u16Char, hs;
-  ef_fs_st *pxFS = pxDir->xObject.pxFS;
-
+  ef_return_et  eRetVal = EF_RET_OK;
+  ucs2_t      * pxLFNBuffer = 0;
+  ef_u32_t      u32IdxSrc;
+  ef_u32_t      u32IdxDst = 0;
+  ef_u32_t      u32Units = 0;
+  ef_u32_t      u32Char;
+  ef_u32_t      u32HighSurrogate = 0;
+  ef_u08_t      u8CaseFlag = EF_NS_BODY;
 
   /* Invalidate file info */
   pxFileInfo->xName[ 0 ] = 0;
-  ucs2_t *    pxLFNBuffer;            /* LFN working buffer */
-  (void) EF_LFN_BUFFER_GET( pxDir->xObject.pxFS, pxLFNBuffer );
-  /* If read pointer has not reached end of directory */
-  if ( 0 != pxDir->xSector )
+  pxFileInfo->xNameAlt[ 0 ] = 0;
+  /* If read pointer has reached end of directory */
+  if ( 0 == pxDir->xSector )
   {
-
-    /* Get LFN if available */
+    eRetVal = EF_RET_ERROR;
+  }
+  else if ( EF_RET_OK != EF_LFN_BUFFER_GET( pxDir->xObject.pxFS, &pxLFNBuffer ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  else
+  {
+    /* If an LFN is available */
     if ( 0xFFFFFFFF != pxDir->u32BlkOffset )
     {
-      si = 0;
-      di = 0;
-      hs = 0;
-      while ( 0 != pxLFNBuffer[ si ] )
+      for ( u32IdxSrc = 0 ; 0 != pxLFNBuffer[ u32IdxSrc ] ; u32IdxSrc++ )
       {
         /* Get an LFN character (UTF-16) */
-        u16Char = pxLFNBuffer[ si++ ];
-        /* Is it a surrogate? */
-        if (    ( 0 == hs )
-             && ( IsSurrogate(u16Char) ) )
+        u32Char = pxLFNBuffer[ u32IdxSrc ];
+        /* If it is the high surrogate of a pair */
+        if (    ( 0 == u32HighSurrogate )
+             && ( IsSurrogateH( u32Char ) ) )
         {
-          /* Get low surrogate */
-          hs = u16Char;
-          continue;
+          u32HighSurrogate = u32Char;
         }
-        /* Store it in UTF-16 or UTF-8 encoding */
-        u16Char = put_utf( ( (ef_u32_t)hs << 16  ) | u16Char,
-                      &pxFileInfo->xName[ di ],
-                      EF_LFN_BUF - di );
-        /* If Invalid char or buffer overflow? */
-        if ( 0 == u16Char )
+        /* Else, if storing it in the API encoding failed (invalid char or buffer overflow) */
+        else if (    ( EF_RET_OK != eEFPrvUnicodePut( ( u32HighSurrogate << 16 ) | u32Char,
+                                                      &pxFileInfo->xName[ u32IdxDst ],
+                                                      EF_LFN_BUF - u32IdxDst,
+                                                      &u32Units ) )
+                  || ( 0 == u32Units ) )
         {
-          di = 0;
+          u32IdxDst = 0;
           break;
         }
-        di += u16Char;
-        hs = 0;
+        else
+        {
+          u32IdxDst += u32Units;
+          u32HighSurrogate = 0;
+        }
+      }
+      /* If a surrogate pair is broken */
+      if ( 0 != u32HighSurrogate )
+      {
+        u32IdxDst = 0;
       }
-      /* Broken surrogate pair? */
-      if ( 0 != hs )
+      else
       {
-        di = 0;
+        EF_CODE_COVERAGE( );
       }
       /* Terminate the LFN (null string means LFN is invalid) */
-      pxFileInfo->xName[ di ] = 0;
+      pxFileInfo->xName[ u32IdxDst ] = 0;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
     }
 
-    si = di = 0;
     /* Get SFN from SFN entry */
-    while ( si < 11 )
+    u32IdxDst = 0;
+    for ( u32IdxSrc = 0 ; 11 > u32IdxSrc ; u32IdxSrc++ )
     {
-      /* Get a char */
-      u16Char = pxDir->pu8Dir[ si++ ];
-      if ( ' ' == u16Char )
+      u32Char = pxDir->pu8Dir[ u32IdxSrc ];
+      /* If a padding space */
+      if ( ' ' == u32Char )
       {
         /* Skip padding space */
         continue;
       }
       /* Else, if a replaced EF_DIR_DELETED_MASK character */
-      else if ( EF_DIR_REPLACEMENT_CHAR == u16Char )
+      else if ( EF_DIR_REPLACEMENT_CHAR == u32Char )
       {
         /* Restore replaced EF_DIR_DELETED_MASK character */
-        u16Char = EF_DIR_DELETED_MASK;
+        u32Char = EF_DIR_DELETED_MASK;
       }
       else
       {
-        ;
+        EF_CODE_COVERAGE( );
       }
-      /* if extension is exist */
-      if (    ( 9 == si )
-           && ( EF_SFN_BUF > di ) )
+      /* If it is the first character of the extension */
+      if (    ( 8 == u32IdxSrc )
+           && ( EF_SFN_BUF > u32IdxDst ) )
       {
-        pxFileInfo->xNameAlt[ di++ ] = '.';  /* Insert a '.'*/
+        /* Insert a . if extension is exist */
+        pxFileInfo->xNameAlt[ u32IdxDst++ ] = '.';
       }
-  #if EF_CONF_API_ENCODING >= 1  /* Unicode output */
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+#if ( EF_DEF_API_OEM != EF_CONF_API_ENCODING )
       /* Make a DBC if needed */
-      if (    ( 0 != eEFPrvByteInDBCRanges1((ef_u08_t)u16Char) )
-           && ( 8 = si )
-           && ( 11 = si )
-           && ( 0 != eEFPrvByteInDBCRanges2( pxDir->pu8Dir[si]) ) )
+      if (    ( 7 != u32IdxSrc )
+           && ( 10 != u32IdxSrc )
+           && ( EF_RET_OK == eEFPrvByteInDBCRanges1( (ef_u08_t) u32Char ) )
+           && ( EF_RET_OK == eEFPrvByteInDBCRanges2( pxDir->pu8Dir[ u32IdxSrc + 1 ] ) ) )
       {
-        u16Char = u16Char << 8 | pxDir->pu8Dir[ si++ ];
+        u32IdxSrc++;
+        u32Char = ( u32Char << 8 ) | pxDir->pu8Dir[ u32IdxSrc ];
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
       }
-      /* ANSI/OEM -> Unicode */
-      u16Char = ef_oem2uni( u16Char, u16ffCPGet( ) );
-      /* Wrong char in the current code page? */
-      if ( 0 == u16Char )
+      /* If ANSI/OEM -> Unicode failed (wrong char in the current code page) */
+      if ( EF_RET_OK != eEFPrvOEM2Unicode( (ucs2_t) u32Char, &u32Char, u16ffCPGet( ) ) )
       {
-        di = 0;
+        u32IdxDst = 0;
         break;
       }
-      /* Store it in Unicode */
-      u16Char = put_utf( u16Char, &pxFileInfo->xNameAlt[di], EF_SFN_BUF - di );
-      /* Buffer overflow? */
-      if ( 0 == u16Char )
+      /* Else, if storing it in Unicode failed (buffer overflow) */
+      else if (    ( EF_RET_OK != eEFPrvUnicodePut( u32Char,
+                                                    &pxFileInfo->xNameAlt[ u32IdxDst ],
+                                                    EF_SFN_BUF - u32IdxDst,
+                                                    &u32Units ) )
+                || ( 0 == u32Units ) )
       {
-        di = 0;
+        u32IdxDst = 0;
         break;
       }
-      di += u16Char;
-  #else          /* ANSI/OEM output */
+      else
+      {
+        u32IdxDst += u32Units;
+      }
+#else
       /* Store it without any conversion */
-      pxFileInfo->xNameAlt[ di++ ] = (TCHAR)u16Char;
-  #endif
+      pxFileInfo->xNameAlt[ u32IdxDst++ ] = (TCHAR) u32Char;
+#endif
     }
-    /* Terminate the SFN  (null string means SFN is invalid) */
-    pxFileInfo->xNameAlt[ di ] = 0;
+    /* Terminate the SFN (null string means SFN is invalid) */
+    pxFileInfo->xNameAlt[ u32IdxDst ] = 0;
 
     /* If LFN is invalid, xNameAlt[] needs to be copied to xName[] */
-    if ( 0 == pxFileInfo->xName[ 0 ] )
+    if ( 0 != pxFileInfo->xName[ 0 ] )
     {
-      if ( 0 == di )
-      {  /* If LFN and SFN both are invalid, this object is inaccesible */
-        pxFileInfo->xName[ di++ ] = '?';
-      }
-      else
+      EF_CODE_COVERAGE( );
+    }
+    /* Else, if LFN and SFN both are invalid, this object is inaccessible */
+    else if ( 0 == u32IdxDst )
+    {
+      pxFileInfo->xName[ 0 ] = '?';
+      pxFileInfo->xName[ 1 ] = 0;
+    }
+    else
+    {
+      /* Copy xNameAlt[] to xName[] with case information */
+      for ( u32IdxSrc = 0 ; 0 != pxFileInfo->xNameAlt[ u32IdxSrc ] ; u32IdxSrc++ )
       {
-        /* Copy xNameAlt[] to xName[] with case information */
-        for ( si = di = 0, lcf = EF_NS_BODY; pxFileInfo->xNameAlt[si]; si++, di++)
+        u32Char = (ucs2_t) pxFileInfo->xNameAlt[ u32IdxSrc ];
+        if ( '.' == u32Char )
+        {
+          u8CaseFlag = EF_NS_EXT;
+        }
+        else if (    ( IsUpper( u32Char ) )
+                  && ( 0 != ( u8CaseFlag & pxDir->pu8Dir[ EF_DIR_LFN_NTres ] ) ) )
         {
-          u16Char = (ucs2_t)pxFileInfo->xNameAlt[ si ];
-          if ( '.' == u16Char )
-          {
-            lcf = EF_NS_EXT;
-          }
-          if (    ( IsUpper( u16Char ) )
-               && ( 0 != ( pxDir->pu8Dir[ EF_DIR_LFN_NTres ] & lcf ) ) )
-          {
-            u16Char += (ucs2_t) 0x20;
-          pxFileInfo->xName[ di ] = (TCHAR)u16Char;
+          u32Char += 0x20;
         }
+        else
+        {
+          EF_CODE_COVERAGE( );
+        }
+        pxFileInfo->xName[ u32IdxSrc ] = (TCHAR) u32Char;
       }
-      pxFileInfo->xName[ di ] = 0;  /* Terminate the LFN */
+      /* Terminate the LFN */
+      pxFileInfo->xName[ u32IdxSrc ] = 0;
       /* Altname is not needed if neither LFN nor case info is exist. */
       if ( 0 == pxDir->pu8Dir[ EF_DIR_LFN_NTres ] )
       {
         pxFileInfo->xNameAlt[ 0 ] = 0;
       }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
     }
 
-    /* Attribute */
+    /* Attributes */
     pxFileInfo->u8Attrib    = pxDir->pu8Dir[ EF_DIR_ATTRIBUTES ];
     /* Size */
-    pxFileInfo->u32FileSize  = u32EFPortLoad( pxDir->pu8Dir + EF_DIR_FILE_SIZE );
+    pxFileInfo->u32FileSize = u32EFPortLoad( pxDir->pu8Dir + EF_DIR_FILE_SIZE );
     /* Time */
     pxFileInfo->u16Time     = u16EFPortLoad( pxDir->pu8Dir + EF_DIR_TIME_MODIFIED + 0 );
     /* Date */
     pxFileInfo->u16Date     = u16EFPortLoad( pxDir->pu8Dir + EF_DIR_TIME_MODIFIED + 2 );
-
-    eRetVal = EF_RET_OK;
-    }
   }
+
 #endif /* ( 0 != EF_CONF_VFAT ) */
 
   return eRetVal;
@@ -34,33 +34,137 @@
 #include "ef_prv_def.h"
 
 /* Local constant macros ------------------------------------------------------------------------------------------- */
+
+#define EF_LOCK_HASH_MASK ( (ef_u32_t) EF_CONF_FILE_LOCK_HASH_SIZE - 1 )  /**< Mask of the hash index slots */
+
 /* Local function macros ------------------------------------------------------------------------------------------- */
-/* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
 
 /**
- *  File lock control structure
+ *  Home slot of an object in the hash index: multiplicative hash of the containing directory cluster
+ *  and of the directory entry number (offsets are multiple of EF_DIR_ENTRY_SIZE)
  */
-typedef struct ef_flock_struct {
-  ef_fs_st  * pxFS;       /**< Object ID 1, volume (NULL:blank entry) */
-  ef_u32_t    u32Clst;    /**< Object ID 2, containing directory (0:root) */
-  ef_u32_t    u32Offset;  /**< Object ID 3, offset in the directory */
-  ef_u16_t    u16Cnt;     /**< Object open counter, 0:none, 0x01..0xFF:read mode open count, 0x100:write mode */
-} ef_flock_st;
+#define EF_LOCK_HASH( clst, ofs ) \
+  ( ( (ef_u32_t) ( ( (ef_u32_t) (clst) ^ ( ( (ef_u32_t) (ofs) / EF_DIR_ENTRY_SIZE ) * 0x85EBCA6BUL ) ) * 0x9E3779B1UL ) >> 16 ) & EF_LOCK_HASH_MASK )
 
+/* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
 /* Local variables ------------------------------------------------------------------------------------------------- */
 /* Public variables ------------------------------------------------------------------------------------------------ */
+/* Local function prototypes---------------------------------------------------------------------------------------- */
 
-#if 0 != EF_CONF_FILE_LOCK
+#if ( 0 != EF_CONF_FILE_LOCK )
 /**
- *  Opened files object locking table
+ *  @brief  Search an object in the hash index of the volume lock table
+ *
+ *  @param  pxFS        Pointer to the Filesystem object
+ *  @param  u32Clst     Containing directory start cluster of the object
+ *  @param  u32Offset   Offset of the object in the directory
+ *  @param  pu32Slot    Pointer to the slot of the object, or to the first empty slot of its probe sequence
+ *  @param  pu32Entry   Pointer to the lock table entry index origin from 1 (0:the object has not been opened)
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK   Succeeded
  */
-static  ef_flock_st Files[ EF_CONF_FILE_LOCK ];
-#else
-extern  ef_flock_st Files[ 1 ];
+static ef_return_et eEFPrvLockFind (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Clst,
+  ef_u32_t    u32Offset,
+  ef_u32_t  * pu32Slot,
+  ef_u32_t  * pu32Entry
+);
+
+/**
+ *  @brief  Remove an object from the hash index of the volume lock table (backward shift deletion)
+ *
+ *  @param  pxFS        Pointer to the Filesystem object
+ *  @param  u32Slot     Slot of the object in the hash index
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK   Succeeded
+ */
+static ef_return_et eEFPrvLockRemove (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Slot
+);
 #endif
 
-/* Local function prototypes---------------------------------------------------------------------------------------- */
 /* Local functions ------------------------------------------------------------------------------------------------- */
+
+#if ( 0 != EF_CONF_FILE_LOCK )
+/* Search an object in the hash index of the volume lock table */
+static ef_return_et eEFPrvLockFind (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Clst,
+  ef_u32_t    u32Offset,
+  ef_u32_t  * pu32Slot,
+  ef_u32_t  * pu32Entry
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+  EF_ASSERT_PRIVATE( 0 != pu32Slot );
+  EF_ASSERT_PRIVATE( 0 != pu32Entry );
+
+  ef_u32_t  u32Slot;
+  ef_u32_t  u32Entry;
+
+  *pu32Entry = 0;
+  /* The index always has empty slots (EF_CONF_FILE_LOCK_HASH_SIZE > EF_CONF_FILE_LOCK), the probe ends */
+  for ( u32Slot = EF_LOCK_HASH( u32Clst, u32Offset ) ;
+        0 != pxFS->u16LockHash[ u32Slot ] ;
+        u32Slot = ( u32Slot + 1 ) & EF_LOCK_HASH_MASK )
+  {
+    u32Entry = pxFS->u16LockHash[ u32Slot ];
+    if (    ( pxFS->xLock[ u32Entry - 1 ].u32Clst   == u32Clst )
+         && ( pxFS->xLock[ u32Entry - 1 ].u32Offset == u32Offset ) )
+    {
+      *pu32Entry = u32Entry;
+      break;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+  *pu32Slot = u32Slot;
+
+  return EF_RET_OK;
+}
+
+/* Remove an object from the hash index of the volume lock table */
+static ef_return_et eEFPrvLockRemove (
+  ef_fs_st  * pxFS,
+  ef_u32_t    u32Slot
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_u32_t      u32Next;
+  ef_u32_t      u32Home;
+  ef_flock_st * pxLock;
+
+  /* Move back the following entries of the cluster whose probe sequence crosses the freed slot */
+  for ( u32Next = ( u32Slot + 1 ) & EF_LOCK_HASH_MASK ;
+        0 != pxFS->u16LockHash[ u32Next ] ;
+        u32Next = ( u32Next + 1 ) & EF_LOCK_HASH_MASK )
+  {
+    pxLock  = &pxFS->xLock[ pxFS->u16LockHash[ u32Next ] - 1 ];
+    u32Home = EF_LOCK_HASH( pxLock->u32Clst, pxLock->u32Offset );
+    /* The home slot is not between the freed slot (excluded) and this slot */
+    if ( ( ( u32Next - u32Home ) & EF_LOCK_HASH_MASK ) >= ( ( u32Next - u32Slot ) & EF_LOCK_HASH_MASK ) )
+    {
+      pxFS->u16LockHash[ u32Slot ] = pxFS->u16LockHash[ u32Next ];
+      u32Slot = u32Next;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+  pxFS->u16LockHash[ u32Slot ] = 0;
+
+  return EF_RET_OK;
+}
+#endif
+
 /* Public functions ------------------------------------------------------------------------------------------------ */
 
 /*-----------------------------------------------------------------------*/
@@ -76,100 +180,71 @@ ef_return_et eEFPrvLockCheck (
 
   ef_return_et  eRetVal = EF_RET_OK;
 
-  if ( 0 == EF_CONF_FILE_LOCK )
+#if ( 0 == EF_CONF_FILE_LOCK )
+  (void) acc;
+  EF_CODE_COVERAGE( );
+#else
+  ef_fs_st    * pxFS = pxDir->xObject.pxFS;
+  ef_u32_t      u32Slot;
+  ef_u32_t      u32Entry;
+
+  /* Search open object table for the object */
+  (void) eEFPrvLockFind( pxFS, pxDir->xObject.u32ClstStart, pxDir->u32Offset, &u32Slot, &u32Entry );
+  if ( 0 == u32Entry )
   {
-    EF_CODE_COVERAGE( );
+    /* The object has not been opened */
+    /* Is there a blank entry for new object? */
+    if (    ( 0 == pxFS->u16LockFree )
+         && ( 2 != acc ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_TOO_MANY_OPEN_FILES );
+    }
+    else
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_OK );
+    }
   }
   else
   {
-    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
-
-    ef_u32_t  i;
-    ef_u32_t  be = 0;
-
-    /* Search open object table for the object */
-    be = 0;
-    for ( i = 0 ; i < EF_CONF_FILE_LOCK ; i++ )
+    /* The object was opened. Reject any open against writing file and all write mode open */
+    if (    ( 0 != acc )
+         || ( 0x100 == pxFS->xLock[ u32Entry - 1 ].u16Cnt ) )
     {
-      /* Existing entry */
-      if ( 0 != Files[ i ].pxFS )
-      {
-        /* Check if the object matches with an open object */
-        if (    ( Files[ i ].pxFS       == pxDir->xObject.pxFS )
-             && ( Files[ i ].u32Clst    == pxDir->xObject.u32ClstStart )
-             && ( Files[ i ].u32Offset  == pxDir->u32Offset ) )
-        {
-          break;
-        }
-        else
-        {
-          EF_CODE_COVERAGE( );
-        }
-      }
-      else
-      {      /* Blank entry */
-        be = 1;
-      }
-    }
-    if ( EF_CONF_FILE_LOCK == i )
-    {
-      /* The object has not been opened */
-      /* Is there a blank entry for new object? */
-      if (    ( 0 == be )
-           && ( 2 != acc ) )
-      {
-        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_TOO_MANY_OPEN_FILES );
-      }
-      else
-      {
-        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_OK );
-      }
+      /* Reject any open against writing file and all write mode open */
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_LOCKED );
     }
     else
     {
-      /* The object was opened. Reject any open against writing file and all write mode open */
-      if (    ( 0 != acc )
-           || ( 0x100 != Files[ i ].u16Cnt ) )
-      {
-        /* Reject any open against writing file and all write mode open */
-        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_LOCKED );
-      }
-      else
-      {
-        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_OK );
-      }
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_OK );
     }
   }
+#endif
 
   return eRetVal;
 }
 
 /* Check if an entry is available for a new object */
-ef_return_et eEFPrvLockEnq (void)
+ef_return_et eEFPrvLockEnq (
+  ef_fs_st  * pxFS
+)
 {
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
   ef_return_et eRetVal = EF_RET_OK;
 
   /* If there is no file locking mechanism */
-  if ( 0 == EF_CONF_FILE_LOCK )
+#if ( 0 == EF_CONF_FILE_LOCK )
+  EF_CODE_COVERAGE( );
+#else
+  if ( 0 == pxFS->u16LockFree )
   {
-    EF_CODE_COVERAGE( );
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_LOCKED );
   }
   else
   {
-    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_LOCKED );
-    for ( ef_u32_t i = 0 ; i < EF_CONF_FILE_LOCK ; i++ )
-    {
-      if ( 0 == Files[ i ].pxFS )
-      {
-        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_OK );
-        break;
-      }
-      else
-      {
-        EF_CODE_COVERAGE( );
-      }
-    }
+    EF_CODE_COVERAGE( );
   }
+#endif
   return eRetVal;
 }
 
@@ -181,144 +256,149 @@ ef_return_et eEFPrvLockInc (
 )
 {
   EF_ASSERT_PRIVATE( 0 != pxDir );
+  EF_ASSERT_PRIVATE( 0 != pu32LockId );
 
   ef_return_et  eRetVal = EF_RET_OK;
 
   /* If there is no file locking mechanism */
-  if ( 0 == EF_CONF_FILE_LOCK )
-  {
-    EF_CODE_COVERAGE( );
-  }
-  else
-  {
-    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
-    ef_u32_t i;
+#if ( 0 == EF_CONF_FILE_LOCK )
+  (void) iAccess;
+  EF_CODE_COVERAGE( );
+#else
+  ef_fs_st    * pxFS = pxDir->xObject.pxFS;
+  ef_flock_st * pxLock;
+  ef_u32_t      u32Slot;
+  ef_u32_t      u32Entry;
 
-    /* Find the object */
-    for ( i = 0; i < EF_CONF_FILE_LOCK; i++ )
-    {
-      if (    ( Files[ i ].pxFS       == pxDir->xObject.pxFS )
-           && ( Files[ i ].u32Clst    == pxDir->xObject.u32ClstStart )
-           && ( Files[ i ].u32Offset  == pxDir->u32Offset ) )
-      {
-        break;
-      }
-      else
-      {
-        EF_CODE_COVERAGE( );
-      }
-    }
+  /* Find the object */
+  (void) eEFPrvLockFind( pxFS, pxDir->xObject.u32ClstStart, pxDir->u32Offset, &u32Slot, &u32Entry );
 
-    /* Not opened. Register it as new. */
-    if ( EF_CONF_FILE_LOCK == i )
-    {
-      for ( i = 0 ; i < EF_CONF_FILE_LOCK ; i++ )
-      {
-        if ( 0 == Files[ i ].pxFS )
-        {
-          break;
-        }
-        else
-        {
-          EF_CODE_COVERAGE( );
-        }
-      }
-      /* No free entry to register (int u8ErrorCode) */
-      if ( EF_CONF_FILE_LOCK == i )
-      {
-        *pu32LockId = 0;
-        return EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
-      }
-      else
-      {
-        EF_CODE_COVERAGE( );
-      }
-      Files[ i ].pxFS       = pxDir->xObject.pxFS;
-      Files[ i ].u32Clst    = pxDir->xObject.u32ClstStart;
-      Files[ i ].u32Offset  = pxDir->u32Offset;
-      Files[ i ].u16Cnt     = 0;
-    }
-
-    if (    ( 1 <= iAccess )
-         && ( 0 != Files[ i ].u16Cnt ) )
+  /* Not opened. Register it as new. */
+  if ( 0 == u32Entry )
+  {
+    /* No free entry to register */
+    if ( 0 == pxFS->u16LockFree )
     {
-      *pu32LockId = 0;  /* Access violation (int u8ErrorCode) */
+      *pu32LockId = 0;
       return EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
     }
     else
     {
       EF_CODE_COVERAGE( );
     }
+    /* Take the first free entry and index it in the empty slot ending the probe */
+    u32Entry                      = pxFS->u16LockFree;
+    pxLock                        = &pxFS->xLock[ u32Entry - 1 ];
+    pxFS->u16LockFree             = pxLock->u16Next;
+    pxLock->u32Clst               = pxDir->xObject.u32ClstStart;
+    pxLock->u32Offset             = pxDir->u32Offset;
+    pxLock->u16Cnt                = 0;
+    pxLock->u16Next               = 0;
+    pxFS->u16LockHash[ u32Slot ]  = (ef_u16_t) u32Entry;
+  }
+  else
+  {
+    pxLock = &pxFS->xLock[ u32Entry - 1 ];
+  }
 
-    if ( 0 != iAccess )
-    {
-      /* Set semaphore value */
-      Files[ i ].u16Cnt = 0x100;
-    }
-    else
-    {
-      /* Set semaphore value */
-      Files[ i ].u16Cnt = Files[ i ].u16Cnt + 1;
-    }
+  if (    ( 1 <= iAccess )
+       && ( 0 != pxLock->u16Cnt ) )
+  {
+    *pu32LockId = 0;  /* Access violation (int u8ErrorCode) */
+    return EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
 
-    *pu32LockId = i + 1;
+  if ( 0 != iAccess )
+  {
+    /* Set semaphore value */
+    pxLock->u16Cnt = 0x100;
+  }
+  else
+  {
+    /* Set semaphore value */
+    pxLock->u16Cnt = pxLock->u16Cnt + 1;
   }
+
+  *pu32LockId = u32Entry;
+#endif
   return eRetVal;
 }
 
 /* Decrement object open counter */
 ef_return_et eEFPrvLockDec (
-  ef_u32_t  i
+  ef_fs_st  * pxFS,
+  ef_u32_t    i
 )
 {
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
   /* Invalid index nunber */
   ef_return_et eRetVal = EF_RET_OK;
 
   /* If there is no file locking mechanism */
-  if ( 0 == EF_CONF_FILE_LOCK )
-  {
-    EF_CODE_COVERAGE( );
-  }
-  else
-  {
-    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
-    ef_u16_t n;
+#if ( 0 == EF_CONF_FILE_LOCK )
+  (void) i;
+  EF_CODE_COVERAGE( );
+#else
+  ef_flock_st * pxLock;
+  ef_u32_t      u32Slot;
+  ef_u32_t      u32Entry;
+  ef_u16_t      n;
+
+  eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
 
-    /* Index number origin from 0 */
-    if ( --i < EF_CONF_FILE_LOCK )
+  /* Index number origin from 0 */
+  if (    ( 0 < i )
+       && ( i <= EF_CONF_FILE_LOCK )
+       && ( 0 != pxFS->xLock[ i - 1 ].u16Cnt ) )
+  {
+    pxLock = &pxFS->xLock[ i - 1 ];
+    n = pxLock->u16Cnt;
+    /* If write u8Mode open, delete the entry */
+    if ( 0x100 == n )
     {
-      n = Files[ i ].u16Cnt;
-      /* If write u8Mode open, delete the entry */
-      if ( 0x100 == n )
-      {
-        n = 0;
-      }
-      else
-      {
-        EF_CODE_COVERAGE( );
-      }
-      /* Decrement read u8Mode open count */
-      if ( 0 < n )
-      {
-        n--;
-      }
-      else
-      {
-        EF_CODE_COVERAGE( );
-      }
-      Files[ i ].u16Cnt = n;
-      /* Delete the entry if open count gets zero */
-      if ( 0 == n )
+      n = 0;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    /* Decrement read u8Mode open count */
+    if ( 0 < n )
+    {
+      n--;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    pxLock->u16Cnt = n;
+    /* Delete the entry if open count gets zero */
+    if ( 0 == n )
+    {
+      (void) eEFPrvLockFind( pxFS, pxLock->u32Clst, pxLock->u32Offset, &u32Slot, &u32Entry );
+      if ( i == u32Entry )
       {
-        Files[ i ].pxFS = 0;
+        (void) eEFPrvLockRemove( pxFS, u32Slot );
       }
       else
       {
         EF_CODE_COVERAGE( );
       }
-      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_OK );
+      pxLock->u16Next   = pxFS->u16LockFree;
+      pxFS->u16LockFree = (ef_u16_t) i;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
     }
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_OK );
   }
+#endif
 
   return eRetVal;
 }
@@ -333,27 +413,24 @@ ef_return_et eEFPrvLockClear (
   ef_return_et  eRetVal = EF_RET_OK;
 
   /* If there is no file locking mechanism */
-  if ( 0 == EF_CONF_FILE_LOCK )
+#if ( 0 == EF_CONF_FILE_LOCK )
+  EF_CODE_COVERAGE( );
+#else
+  ef_u32_t  i;
+
+  /* Empty the hash index */
+  for ( i = 0 ; i < EF_CONF_FILE_LOCK_HASH_SIZE ; i++ )
   {
-    EF_CODE_COVERAGE( );
+    pxFS->u16LockHash[ i ] = 0;
   }
-  else
+  /* Chain all the entries in the free list */
+  for ( i = 0 ; i < EF_CONF_FILE_LOCK ; i++ )
   {
-    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
-
-    for ( ef_u32_t i = 0 ; i < EF_CONF_FILE_LOCK ; i++ )
-    {
-      if ( Files[ i ].pxFS == pxFS )
-      {
-        Files[ i ].pxFS = 0;
-        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_OK );
-      }
-      else
-      {
-        EF_CODE_COVERAGE( );
-      }
-    }
+    pxFS->xLock[ i ].u16Cnt   = 0;
+    pxFS->xLock[ i ].u16Next  = (ef_u16_t) ( ( EF_CONF_FILE_LOCK - 1 ) == i ? 0 : ( i + 2 ) );
   }
+  pxFS->u16LockFree = 1;
+#endif
 
   return eRetVal;
 }
@@ -0,0 +1,421 @@
+/**
+ * ********************************************************************************************************************
+ *  @file     ef_prv_file_transfer.c
+ *  @ingroup  group_eFAT_Private
+ *  @author   ChaN
+ *  @author   Emmanuel AMADIO
+ *  @version  V0.1
+ *  @brief    File data transfer steps shared by the blocking and non-blocking read and write functions.
+ *
+ * ********************************************************************************************************************
+ *  eFAT - embedded FAT Filesystem module
+ * ********************************************************************************************************************
+ *
+ *  Copyright (C) 2021, Amadio Emmanuel, all right reserved.
+ *  Copyright (C) 2019, ChaN, all right reserved.
+ *
+ *  eFAT module is an open source software. Redistribution and use of eFAT in source and binary forms, with or without
+ *  modification, are permitted provided that the following condition is met:
+ *
+ *  Redistributions of source code must retain the above copyright notice, this condition and the following disclaimer.
+ *
+ *  This software is provided by the copyright holders and contributors "AS IS" and any warranties related to this
+ *  software are DISCLAIMED.
+ *  The copyright owners or contributors be NOT LIABLE for any damages caused by use of this software.
+ * ********************************************************************************************************************
+ */
+
+/* START OF FILE *************************************************************************************************** */
+/* ***************************************************************************************************************** */
+
+/* Includes -------------------------------------------------------------------------------------------------------- */
+#include <efat.h>
+#include <ef_prv_def.h>
+#include <ef_prv_fat.h>
+#include <ef_prv_file.h>
+#include <ef_port_memory.h>
+#include "ef_prv_drive.h"
+#include "ef_prv_lock.h"
+#include "ef_prv_validate.h"
+
+/* Local constant macros ------------------------------------------------------------------------------------------- */
+/* Local function macros ------------------------------------------------------------------------------------------- */
+/* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
+/* Local variables ------------------------------------------------------------------------------------------------- */
+/* Public variables ------------------------------------------------------------------------------------------------ */
+/* Local function prototypes---------------------------------------------------------------------------------------- */
+/* Local functions ------------------------------------------------------------------------------------------------- */
+/* Public functions ------------------------------------------------------------------------------------------------ */
+
+ef_return_et eEFPrvFileReadStep (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ef_u08_t    * pu8DataBuffer,
+  ef_u32_t      u32BytesToRead,
+  ef_lba_t    * pxSector,
+  ef_u32_t    * pu32SectorsNb,
+  ef_u32_t    * pu32Bytes
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFile );
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+  EF_ASSERT_PRIVATE( 0 != pu8DataBuffer );
+  EF_ASSERT_PRIVATE( 0 != pxSector );
+  EF_ASSERT_PRIVATE( 0 != pu32SectorsNb );
+  EF_ASSERT_PRIVATE( 0 != pu32Bytes );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  /* Offset in the sector */
+  ef_u32_t      u32OffsetInSector = (ef_u32_t)( pxFile->u32FileOffset ) % EF_SECTOR_SIZE( pxFS );
+  /* Sector offset in the cluster */
+  ef_u32_t      u32ClusterOffset = EF_CLUSTER_OFFSET_GET( pxFS );
+  /* Number of bytes remaining in the sector */
+  ef_u32_t      u32BytesRemaining = EF_SECTOR_SIZE( pxFS ) - u32OffsetInSector;
+
+  *pu32SectorsNb  = 0;
+  *pu32Bytes      = 0;
+
+  /* If Not on the sector boundary, the bytes remaining in the sector are in the window */
+  if ( 0 != u32OffsetInSector )
+  {
+    /* Clip it by u32BytesToRead if needed */
+    if ( u32BytesRemaining > u32BytesToRead )
+    {
+      u32BytesRemaining = u32BytesToRead;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    /* If extracting the remaining bytes from the sector failed */
+    if ( EF_RET_OK != eEFPortMemCopy( pxFile->u8Window + u32OffsetInSector, pu8DataBuffer, u32BytesRemaining ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+    }
+    else
+    {
+      *pu32Bytes = u32BytesRemaining;
+    }
+  }
+  /* Else, if     On the cluster boundary
+   *          AND Updating the current cluster failed
+   */
+  else if (    ( 0 == u32ClusterOffset )
+            && ( EF_RET_OK != eEFPrvFileReadClusterNbUpdate( pxFile ) ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  /* Else, if getting the base sector of the current cluster failed
+   * (the sector is computed at every boundary, a read ended inside the sector of the window) */
+  else if ( EF_RET_OK != eEFPrvFATClusterToSector( pxFS, pxFile->u32Clst, pxSector ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  else
+  {
+    /* Add the offset in the cluster to the Sector number to get the real value */
+    *pxSector += u32ClusterOffset;
+    /* Get the number of remaining whole sectors */
+    *pu32SectorsNb = u32BytesToRead / EF_SECTOR_SIZE( pxFS );
+
+    /* If the sectors remaining to read in the cluster is larger than the cluster size */
+    if ( ( *pu32SectorsNb + u32ClusterOffset ) > pxFS->u8ClstSize )
+    {
+      /* Clip at cluster boundary, Limit the number of sectors to what remains in the cluster */
+      *pu32SectorsNb = pxFS->u8ClstSize - u32ClusterOffset;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+
+  return eRetVal;
+}
+
+ef_return_et eEFPrvFileReadEnd (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ef_u08_t    * pu8DataBuffer,
+  ef_u32_t      u32BytesToRead,
+  ef_lba_t      xSector,
+  ef_return_et  eResult,
+  ef_u32_t    * pu32Bytes
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFile );
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+  EF_ASSERT_PRIVATE( 0 != pu8DataBuffer );
+  EF_ASSERT_PRIVATE( 0 != pu32Bytes );
+
+  ef_return_et  eRetVal = eResult;
+
+  *pu32Bytes = 0;
+
+  /* If a transfer is in progress */
+  if ( EF_RET_PENDING == eResult )
+  {
+    /* The window is left as is until the operation resumes */
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if something failed */
+  else if ( EF_RET_OK != eResult )
+  {
+    /* Invalidate the window */
+    pxFile->xSector = 0;
+  }
+  /* Else, if Data sector window update failed */
+  else if ( EF_RET_OK != eEFPrvFileWindowUpdate ( pxFile, pxFS, xSector ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+    pxFile->xSector = 0;
+  }
+  /* Else, if there are no more bytes to read */
+  else if ( 0 == u32BytesToRead )
+  {
+    /* We are done, now the sector in the window is where the FileOffset belong */
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if extracting the remaining bytes from the window failed */
+  else if ( EF_RET_OK != eEFPortMemCopy( pxFile->u8Window, pu8DataBuffer, u32BytesToRead ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+    pxFile->xSector = 0;
+  }
+  else
+  {
+    /* TRANSFERED PARTIAL SECTOR FROM BOUNDARY SUCCESS */
+    EF_FILE_DIGEST( pxFile, pu8DataBuffer, u32BytesToRead );
+    /* Update File offset */
+    pxFile->u32FileOffset += u32BytesToRead;
+    *pu32Bytes = u32BytesToRead;
+  }
+
+  return eRetVal;
+}
+
+ef_return_et eEFPrvFileWriteStep (
+  ef_file_st      * pxFile,
+  ef_fs_st        * pxFS,
+  const ef_u08_t  * pu8DataBuffer,
+  ef_u32_t          u32BytesToWrite,
+  ef_lba_t        * pxSector,
+  ef_u32_t        * pu32SectorsNb,
+  ef_u32_t        * pu32Bytes
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFile );
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+  EF_ASSERT_PRIVATE( 0 != pu8DataBuffer );
+  EF_ASSERT_PRIVATE( 0 != pxSector );
+  EF_ASSERT_PRIVATE( 0 != pu32SectorsNb );
+  EF_ASSERT_PRIVATE( 0 != pu32Bytes );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  /* Offset in the sector */
+  ef_u32_t      u32OffsetInSector = (ef_u32_t)( pxFile->u32FileOffset ) % EF_SECTOR_SIZE( pxFS );
+  /* Sector offset in the cluster */
+  ef_u32_t      u32ClusterOffset = EF_CLUSTER_OFFSET_GET( pxFS );
+  /* Number of bytes remaining in the sector */
+  ef_u32_t      u32BytesRemaining = EF_SECTOR_SIZE( pxFS ) - u32OffsetInSector;
+
+  *pu32SectorsNb  = 0;
+  *pu32Bytes      = 0;
+
+  /* If Not on the sector boundary, the bytes remaining in the sector go to the window */
+  if ( 0 != u32OffsetInSector )
+  {
+    /* Clip it by u32BytesToWrite if needed */
+    if ( u32BytesRemaining > u32BytesToWrite )
+    {
+      u32BytesRemaining = u32BytesToWrite;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    /* If     the bytes are not in place in the window yet (eEF_printf() puts them there)
+     *    AND filling the remaining bytes into the window failed
+     */
+    if (    ( pu8DataBuffer != ( pxFile->u8Window + u32OffsetInSector ) )
+         && ( EF_RET_OK != eEFPortMemCopy( pu8DataBuffer, pxFile->u8Window + u32OffsetInSector, u32BytesRemaining ) ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+    }
+    else
+    {
+      /* Flag the window as dirty */
+      pxFile->u8StatusFlags |= EF_FILE_WIN_DIRTY;
+      *pu32Bytes = u32BytesRemaining;
+    }
+  }
+  /* Else, if     On the cluster boundary
+   *          AND Updating (or allocating) the current cluster failed
+   */
+  else if (    ( 0 == u32ClusterOffset )
+            && ( EF_RET_OK != eEFPrvFileWriteClusterNbUpdate( pxFile ) ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  /* Else, if getting the base sector of the current cluster failed
+   * (the sector is computed at every boundary, a write ended at the end of the sector of the window) */
+  else if ( EF_RET_OK != eEFPrvFATClusterToSector( pxFS, pxFile->u32Clst, pxSector ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  else
+  {
+    /* Add the offset in the cluster to the Sector number to get the real value */
+    *pxSector += u32ClusterOffset;
+    /* Get the number of remaining whole sectors */
+    *pu32SectorsNb = u32BytesToWrite / EF_SECTOR_SIZE( pxFS );
+
+    /* If the sectors remaining to write in the cluster is larger than the cluster size */
+    if ( ( *pu32SectorsNb + u32ClusterOffset ) > pxFS->u8ClstSize )
+    {
+      /* Clip at cluster boundary, Limit the number of sectors to what remains in the cluster */
+      *pu32SectorsNb = pxFS->u8ClstSize - u32ClusterOffset;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+
+  return eRetVal;
+}
+
+ef_return_et eEFPrvFileWriteEnd (
+  ef_file_st      * pxFile,
+  ef_fs_st        * pxFS,
+  const ef_u08_t  * pu8DataBuffer,
+  ef_u32_t          u32BytesToWrite,
+  ef_lba_t          xSector,
+  ef_return_et      eResult,
+  ef_u32_t        * pu32Bytes
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFile );
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+  EF_ASSERT_PRIVATE( 0 != pu8DataBuffer );
+  EF_ASSERT_PRIVATE( 0 != pu32Bytes );
+
+  ef_return_et  eRetVal = eResult;
+
+  *pu32Bytes = 0;
+
+  /* If a transfer is in progress */
+  if ( EF_RET_PENDING == eResult )
+  {
+    /* The window is left as is until the operation resumes */
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if something failed */
+  else if ( EF_RET_OK != eResult )
+  {
+    /* Invalidate the window */
+    pxFile->xSector = 0;
+  }
+  /* Else, if the sector holds data of the file and the Data sector window update failed */
+  else if (    ( pxFile->u32FileOffset < pxFile->u32Size )
+            && ( EF_RET_OK != eEFPrvFileWindowUpdate ( pxFile, pxFS, xSector ) ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+    pxFile->xSector = 0;
+  }
+  /* Else, if the sector is past the end of the file and the window switch failed */
+  else if (    ( pxFile->u32FileOffset >= pxFile->u32Size )
+            && ( EF_RET_OK != eEFPrvFileWindowSet ( pxFile, pxFS, xSector ) ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+    pxFile->xSector = 0;
+  }
+  /* Else, if there are no more bytes to write */
+  else if ( 0 == u32BytesToWrite )
+  {
+    /* We are done, now the sector in the window is where the FileOffset belong */
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if filling the remaining bytes into the window failed */
+  else if ( EF_RET_OK != eEFPortMemCopy( pu8DataBuffer, pxFile->u8Window, u32BytesToWrite ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+    pxFile->xSector = 0;
+  }
+  else
+  {
+    /* TRANSFERED PARTIAL SECTOR FROM BOUNDARY SUCCESS */
+    /* Flag the window as dirty */
+    pxFile->u8StatusFlags |= (ef_u08_t) EF_FILE_WIN_DIRTY;
+    /* Update File offset */
+    pxFile->u32FileOffset += u32BytesToWrite;
+    *pu32Bytes = u32BytesToWrite;
+  }
+
+  /* If something failed */
+  if (    ( EF_RET_OK      != eRetVal )
+       && ( EF_RET_PENDING != eRetVal ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else
+  {
+    /* Set file change flags */
+    pxFile->u8StatusFlags |= EF_FILE_MODIFIED;
+    /* If file offset is bigger than file size */
+    if ( pxFile->u32FileOffset > pxFile->u32Size )
+    {
+      /* Update File size */
+      pxFile->u32Size = pxFile->u32FileOffset;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+
+  return eRetVal;
+}
+
+#if ( 0 != EF_CONF_NON_BLOCKING )
+ef_return_et eEFPrvFileNbCancel (
+  ef_file_st  * pxFile
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFile );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_fs_st    * pxFS;
+
+  /* If no non-blocking operation is in progress on the file */
+  if ( EF_FILE_NB_IDLE == pxFile->u8NbState )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if File object is not valid (the exclusive grant also protects the started transfer state of the drive) */
+  else if ( EF_RET_OK != eEFPrvValidateObject( &pxFile->xObject, &pxFS ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
+  }
+  else
+  {
+    /* Wait for the end of the transfer started by the operation, collecting its result frees the drive */
+    while (    ( EF_BOOL_FALSE != pxFile->bNbTransfer )
+            && ( EF_RET_PENDING == eEFPrvDriveTransferPoll( pxFS->u8PhysDrv ) ) )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    /* The operation is abandoned */
+    pxFile->bNbTransfer   = EF_BOOL_FALSE;
+    pxFile->u32NbSectors  = 0;
+    pxFile->u8NbState     = EF_FILE_NB_IDLE;
+
+    (void) eEFPrvFSUnlock( pxFS, eRetVal );
+  }
+
+  return eRetVal;
+}
+#endif
+
+/* ***************************************************************************************************************** */
+/* END OF FILE ***************************************************************************************************** */
@@ -110,6 +110,37 @@ ef_return_et eEFPrvFileWindowUpdate (
   return eRetVal;
 }
 
+ef_return_et eEFPrvFileWindowSet (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ef_lba_t      xSector
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFile );
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+
+  /* If Data sector is still the one in the window */
+  if ( pxFile->xSector == xSector )
+  {
+    /* Do nothing */
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if Write-back dirty sector cache if needed failed */
+  else if ( EF_RET_OK != eEFPrvFileWindowDirtyWriteBack ( pxFile, pxFS ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+  }
+  else
+  {
+    /* The sector holds no file data yet, it does not need to be read */
+    pxFile->xSector = xSector;
+  }
+
+  return eRetVal;
+}
+
 /* ***************************************************************************************************************** */
 /* END OF FILE ***************************************************************************************************** */
 
@@ -33,6 +33,49 @@
 #include <efat.h>
 #include "ef_prv_def.h"
 
+/* Local functions ------------------------------------------------------------------------------------------------- */
+
+/* Count the data transfers running with the volume lock released */
+static void vEFPrvFSTransfersCount (
+  ef_fs_st  * pxFS,
+  ef_bool_t   bStart
+)
+{
+#if ( 0 != EF_CONF_FS_LOCK ) && ( 0 != EF_CONF_FS_LOCK_TRANSFER_RELEASE )
+  (void) eEFPortCriticalSectionEnter( );
+  if ( EF_BOOL_TRUE == bStart )
+  {
+    pxFS->u16TransfersNb++;
+  }
+  else
+  {
+    pxFS->u16TransfersNb--;
+  }
+  (void) eEFPortCriticalSectionExit( );
+#else
+  (void) pxFS;
+  (void) bStart;
+#endif
+}
+
+/* Get the number of data transfers running with the volume lock released */
+static ef_u16_t u16EFPrvFSTransfersNbGet (
+  ef_fs_st  * pxFS
+)
+{
+  ef_u16_t  u16TransfersNb = 0;
+
+#if ( 0 != EF_CONF_FS_LOCK ) && ( 0 != EF_CONF_FS_LOCK_TRANSFER_RELEASE )
+  (void) eEFPortCriticalSectionEnter( );
+  u16TransfersNb = pxFS->u16TransfersNb;
+  (void) eEFPortCriticalSectionExit( );
+#else
+  (void) pxFS;
+#endif
+
+  return u16TransfersNb;
+}
+
 /* Public functions ------------------------------------------------------------------------------------------------ */
 
 /* Request/Release grant to access the volume */
@@ -126,5 +169,228 @@ ef_return_et eEFPrvFSUnlockForce (
   return eRetVal;
 }
 
+/* Request shared grant to access the volume */
+ef_return_et eEFPrvFSLockShared (
+  ef_fs_st *  pxFS
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+
+  /* If there is no file system locking mechanism */
+  if ( 0 == EF_CONF_FS_LOCK )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if there is no reader-writer locking */
+  else if ( 0 == EF_CONF_FS_LOCK_SHARED )
+  {
+    eRetVal = eEFPrvFSLock( pxFS );
+  }
+  else if ( EF_RET_OK == eEFPortSyncObjectTakeShared( pxFS->xSyncObject ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+  }
+
+  return eRetVal;
+}
+
+/* Release shared grant to access the volume */
+ef_return_et eEFPrvFSUnlockShared (
+  ef_fs_st      * pxFS,
+  ef_return_et    eResult
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+
+  /* If there is no file system locking mechanism */
+  if ( 0 == EF_CONF_FS_LOCK )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if there is no reader-writer locking */
+  else if ( 0 == EF_CONF_FS_LOCK_SHARED )
+  {
+    eRetVal = eEFPrvFSUnlock( pxFS, eResult );
+  }
+  else if ( EF_RET_NOT_ENABLED == eResult )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_INVALID_DRIVE == eResult )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_TIMEOUT == eResult )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK == eEFPortSyncObjectGiveShared( pxFS->xSyncObject ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+  }
+
+  return eRetVal;
+}
+
+/* Request grant to use the filesystem window */
+ef_return_et eEFPrvFSWindowLock (
+  ef_fs_st *  pxFS
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+
+#if ( 0 != EF_CONF_FS_LOCK ) && ( 0 != EF_CONF_FS_LOCK_SHARED )
+  if ( EF_RET_OK == eEFPortSyncObjectTake( pxFS->xWindowSyncObject ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_TIMEOUT );
+  }
+#else
+  /* The window is only used under the exclusive grant */
+  EF_CODE_COVERAGE( );
+#endif
+
+  return eRetVal;
+}
+
+/* Release grant to use the filesystem window */
+ef_return_et eEFPrvFSWindowUnlock (
+  ef_fs_st *  pxFS
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+
+#if ( 0 != EF_CONF_FS_LOCK ) && ( 0 != EF_CONF_FS_LOCK_SHARED )
+  if ( EF_RET_OK == eEFPortSyncObjectGive( pxFS->xWindowSyncObject ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+  }
+#else
+  /* The window is only used under the exclusive grant */
+  EF_CODE_COVERAGE( );
+#endif
+
+  return eRetVal;
+}
+
+/* Release the grant to access the volume before a data transfer */
+ef_return_et eEFPrvFSTransferUnlock (
+  ef_fs_st *  pxFS,
+  ef_bool_t   bShared
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+
+  /* If the volume stays locked during data transfers */
+  if (    ( 0 == EF_CONF_FS_LOCK )
+       || ( 0 == EF_CONF_FS_LOCK_TRANSFER_RELEASE ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_BOOL_TRUE == bShared )
+  {
+    vEFPrvFSTransfersCount( pxFS, EF_BOOL_TRUE );
+    eRetVal = eEFPrvFSUnlockShared( pxFS, EF_RET_OK );
+  }
+  else
+  {
+    vEFPrvFSTransfersCount( pxFS, EF_BOOL_TRUE );
+    eRetVal = eEFPrvFSUnlockForce( pxFS );
+  }
+
+  return eRetVal;
+}
+
+/* Request back the grant to access the volume after a data transfer */
+ef_return_et eEFPrvFSTransferLock (
+  ef_fs_st *  pxFS,
+  ef_bool_t   bShared
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+
+  /* If the volume stays locked during data transfers */
+  if (    ( 0 == EF_CONF_FS_LOCK )
+       || ( 0 == EF_CONF_FS_LOCK_TRANSFER_RELEASE ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if (    ( EF_BOOL_TRUE == bShared )
+            && ( EF_RET_OK != eEFPrvFSLockShared( pxFS ) ) )
+  {
+    /* The transfer is over: the caller does not touch the volume anymore */
+    vEFPrvFSTransfersCount( pxFS, EF_BOOL_FALSE );
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_TIMEOUT );
+  }
+  else if (    ( EF_BOOL_FALSE == bShared )
+            && ( EF_RET_OK != eEFPrvFSLock( pxFS ) ) )
+  {
+    vEFPrvFSTransfersCount( pxFS, EF_BOOL_FALSE );
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_TIMEOUT );
+  }
+  else
+  {
+    vEFPrvFSTransfersCount( pxFS, EF_BOOL_FALSE );
+  }
+
+  return eRetVal;
+}
+
+/* Wait for the data transfers running with the volume lock released */
+ef_return_et eEFPrvFSTransferWait (
+  ef_fs_st  * pxFS
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+
+  /* Each transfer needs the lock back to end: give it while some are running */
+  while (    ( EF_RET_OK == eRetVal )
+          && ( 0 != u16EFPrvFSTransfersNbGet( pxFS ) ) )
+  {
+    /* If the lock can not be released or taken back */
+    if (    ( EF_RET_OK != eEFPrvFSUnlockForce( pxFS ) )
+         || ( EF_RET_OK != eEFPortTaskYield( ) )
+         || ( EF_RET_OK != eEFPrvFSLock( pxFS ) ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_TIMEOUT );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+
+  return eRetVal;
+}
+
 /* ***************************************************************************************************************** */
 /* END OF FILE ***************************************************************************************************** */
@@ -55,24 +55,34 @@ typedef struct LFN_Buffer_struct {
 } LFN_Buffer_st;
 
 /* Local variables ------------------------------------------------------------------------------------------------- */
-/* Public variables ------------------------------------------------------------------------------------------------ */
 
+#if ( EF_DEF_VFAT_BUFFER_POOL != EF_CONF_VFAT_BUFFER )
 /**
- *  LFN working buffers 32-Byte aligned for cache maintenance
+ *  LFN working buffers pointers
  */
-static LFN_Buffer_st xLFNBuffers[ EF_CONF_VOLUMES_NB ] __attribute__ ((aligned (32)));
+static ucs2_t * pxLFNBuffers[ EF_CONF_VOLUMES_NB ];
+#endif
 
+#if ( 0 != EF_CONF_VFAT ) && ( EF_DEF_VFAT_BUFFER_POOL == EF_CONF_VFAT_BUFFER )
 /**
- *  LFN working buffers pointers
+ *  Pool of LFN working buffers 32-Byte aligned for cache maintenance
+ */
+static LFN_Buffer_st xLFNBufferPool[ EF_CONF_VFAT_BUFFER_POOL_NB ] __attribute__ ((aligned (32)));
+
+/**
+ *  Checked out flags of the pool of LFN working buffers
  */
-static LFN_Buffer_st * pxLFNBuffers[ EF_CONF_VOLUMES_NB ];
+static ef_bool_t bLFNBufferPoolUsed[ EF_CONF_VFAT_BUFFER_POOL_NB ];
+#endif
 
+/* Public variables ------------------------------------------------------------------------------------------------ */
 /* Local function prototypes---------------------------------------------------------------------------------------- */
 /* Local functions ------------------------------------------------------------------------------------------------- */
 /* Public functions ------------------------------------------------------------------------------------------------ */
+#if ( EF_DEF_VFAT_BUFFER_POOL != EF_CONF_VFAT_BUFFER )
 ef_return_et eEFPrvLFNBufferPtrGet (
-  ef_fs_st      *   pxFS,
-  const ucs2_t  **  ppxBuffer
+  ef_fs_st  *   pxFS,
+  ucs2_t    **  ppxBuffer
 )
 {
   EF_ASSERT_PRIVATE( 0 != pxFS );
@@ -80,8 +90,7 @@ ef_return_et eEFPrvLFNBufferPtrGet (
 
   ef_return_et  eRetVal = EF_RET_OK;
 
-  if (    ( 0 <= pxFS->u8LogicNumber )
-       && ( EF_CONF_VOLUMES_NB > pxFS->u8LogicNumber ) )
+  if ( EF_CONF_VOLUMES_NB > pxFS->u8LogicNumber )
   {
     /* Volume number */
     *ppxBuffer = pxLFNBuffers[ pxFS->u8LogicNumber ];
@@ -94,8 +103,8 @@ ef_return_et eEFPrvLFNBufferPtrGet (
 }
 
 ef_return_et eEFPrvLFNBufferPtrSet (
-  ef_fs_st      * pxFS,
-  const ucs2_t  * pxBuffer
+  ef_fs_st  * pxFS,
+  ucs2_t    * pxBuffer
 )
 {
   EF_ASSERT_PRIVATE( 0 != pxFS );
@@ -103,8 +112,7 @@ ef_return_et eEFPrvLFNBufferPtrSet (
 
   ef_return_et  eRetVal = EF_RET_OK;
 
-  if (    ( 0 <= pxFS->u8LogicNumber )
-       && ( EF_CONF_VOLUMES_NB > pxFS->u8LogicNumber ) )
+  if ( EF_CONF_VOLUMES_NB > pxFS->u8LogicNumber )
   {
     /* Volume number */
     pxLFNBuffers[ pxFS->u8LogicNumber ] = pxBuffer;
@@ -115,6 +123,125 @@ ef_return_et eEFPrvLFNBufferPtrSet (
   }
   return eRetVal;
 }
+#endif
+
+#if ( 0 != EF_CONF_VFAT ) && ( EF_DEF_VFAT_BUFFER_POOL == EF_CONF_VFAT_BUFFER )
+/* Check out an LFN working buffer from the pool */
+ef_return_et eEFPrvLFNBufferTake (
+  ucs2_t  **  ppxBuffer
+)
+{
+  EF_ASSERT_PRIVATE( 0 != ppxBuffer );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u32_t      u32Idx;
+
+  *ppxBuffer = 0;
+
+  /* The pool is shared by all the tasks and all the volumes */
+  (void) eEFPortCriticalSectionEnter( );
+  for ( u32Idx = 0 ; u32Idx < EF_CONF_VFAT_BUFFER_POOL_NB ; u32Idx++ )
+  {
+    if ( EF_BOOL_FALSE == bLFNBufferPoolUsed[ u32Idx ] )
+    {
+      bLFNBufferPoolUsed[ u32Idx ] = EF_BOOL_TRUE;
+      *ppxBuffer = xLFNBufferPool[ u32Idx ].xBuffer;
+      break;
+    }
+  }
+  (void) eEFPortCriticalSectionExit( );
+
+  /* If the pool is empty */
+  if ( 0 == *ppxBuffer )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_NOT_ENOUGH_CORE );
+  }
+  /* Else, if the buffer cannot be used by the calling task */
+  else if ( EF_RET_OK != eEFPortTaskBufferSet( *ppxBuffer ) )
+  {
+    (void) eEFPrvLFNBufferGive( *ppxBuffer );
+    *ppxBuffer = 0;
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_SYS_ERROR );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  return eRetVal;
+}
+
+/* Get the LFN working buffer of the calling task */
+ef_return_et eEFPrvLFNBufferTaskGet (
+  ucs2_t  **  ppxBuffer
+)
+{
+  EF_ASSERT_PRIVATE( 0 != ppxBuffer );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  void        * pvBuffer = 0;
+
+  if ( EF_RET_OK != eEFPortTaskBufferGet( &pvBuffer ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+  }
+  /* Else, if the calling task did not check out a buffer */
+  else if ( 0 == pvBuffer )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+  *ppxBuffer = (ucs2_t *) pvBuffer;
+
+  return eRetVal;
+}
+
+/* Give back an LFN working buffer to the pool */
+ef_return_et eEFPrvLFNBufferGive (
+  ucs2_t  * pxBuffer
+)
+{
+  ef_return_et  eRetVal = EF_RET_ERROR;
+  ef_u32_t      u32Idx;
+
+  /* If no buffer was checked out */
+  if ( 0 == pxBuffer )
+  {
+    eRetVal = EF_RET_OK;
+  }
+  else
+  {
+    (void) eEFPortTaskBufferSet( 0 );
+
+    (void) eEFPortCriticalSectionEnter( );
+    for ( u32Idx = 0 ; u32Idx < EF_CONF_VFAT_BUFFER_POOL_NB ; u32Idx++ )
+    {
+      if ( pxBuffer == xLFNBufferPool[ u32Idx ].xBuffer )
+      {
+        bLFNBufferPoolUsed[ u32Idx ] = EF_BOOL_FALSE;
+        eRetVal = EF_RET_OK;
+        break;
+      }
+    }
+    (void) eEFPortCriticalSectionExit( );
+
+    /* If the buffer does not belong to the pool */
+    if ( EF_RET_OK != eRetVal )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+
+  return eRetVal;
+}
+#endif
 
 /* VFAT-LFN: Compare a part of file name with an LFN entry */
 ef_return_et eEFPrvLFNCompare (
@@ -149,9 +276,25 @@ ef_return_et eEFPrvLFNCompare (
       ucs2_t uc = u16EFPortLoad( pu8Dir + LfnOfs[ s ] );
       if ( 0 != u16Char )
       {
+        ef_u32_t  u32CharEntry = uc;
+        ef_u32_t  u32CharName = 0;
+        ef_bool_t bTooLong = ( i >= ( EF_LFN_UNITS_MAX + 1 ) );
+
+        /* If the name is not too long */
+        if ( EF_BOOL_FALSE == bTooLong )
+        {
+          u32CharName = pxLFNBuffer[ i++ ];
+          /* Up-case both characters */
+          (void) eEFPrvUnicodeToUpper( u32CharEntry, &u32CharEntry );
+          (void) eEFPrvUnicodeToUpper( u32CharName, &u32CharName );
+        }
+        else
+        {
+          EF_CODE_COVERAGE( );
+        }
         /* Compare it */
-        if (    ( i >= ( EF_LFN_UNITS_MAX + 1 ) )
-             || ( ef_wtoupper( uc ) != ef_wtoupper( pxLFNBuffer[ i++ ] ) ) )
+        if (    ( EF_BOOL_FALSE != bTooLong )
+             || ( u32CharEntry != u32CharName ) )
         {
           /* Not matched */
           eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
@@ -291,8 +434,8 @@ ef_return_et eEFPrvLFNPut (
 
   ef_return_et  eRetVal = EF_RET_ERROR;
 
-  if (    ( 0 == u8Order )
-       || ( 20 < u8Order ) )
+  if (    ( 0 != u8Order )
+       && ( 20 >= u8Order ) )
   {
     /* Set checksum */
     pu8Dir[ EF_DIR_LFN_CHECKSUM ] = u8CheckSum;
@@ -406,7 +549,7 @@ ef_return_et eEFPrvLFNCreateSFN (
   /* Append the number to the SFN body */
   for ( j = 0 ; ( j < i ) && ( pu8SFNNumBuffer[ j ] != ' ' ) ; j++ )
   {
-    if ( EF_RET_OK != eEFPrvByteInDBCRanges1( pu8SFNNumBuffer[ j ] ) )
+    if ( EF_RET_OK == eEFPrvByteInDBCRanges1( pu8SFNNumBuffer[ j ] ) )
     {
       if ( j == ( i - 1 ) )
       {
@@ -36,6 +36,7 @@
 #include "ef_port_diskio.h"
 #include "ef_prv_def.h"
 #include "ef_prv_create_name.h"
+#include "ef_prv_cwd.h"
 #include "ef_prv_directory.h"
 #include "ef_prv_dirfunc.h"
 #include "ef_prv_directory.h"
@@ -108,7 +109,7 @@ ef_return_et eEFPrvPathFollow (
     /* Follow path */
     for ( ; ; )
     {
-      ef_bool_t bFound = EF_BOOL_FALSE;
+      bFound = EF_BOOL_FALSE;
 
       /* Get a segment name of the pxPath failed */
       if ( EF_RET_OK != eEFPrvNameCreate( pxDir, &pxPath ) )
@@ -157,6 +158,15 @@ ef_return_et eEFPrvPathFollow (
         }
         break;
       } /* Object is not found */
+#if ( 2 == EF_CONF_RELATIVE_PATH ) && ( 0 != EF_CONF_CWD_CACHE_SIZE )
+      /* Else, if recording the segment followed by eEF_chdir() failed */
+      else if (    ( EF_BOOL_FALSE != pxFS->bCwdFollow )
+                && ( EF_RET_OK != eEFPrvCwdCacheFollow( pxDir ) ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+        break;
+      }
+#endif
       /* Else, if it is last segment */
       else if ( 0 != ( EF_NS_LAST & pxDir->u8Name[ EF_NSFLAG ] ) )
       {
@@ -69,13 +69,13 @@ static ef_u32_t u32StringCharGet (
   if (    ( 0 != EF_CONF_VFAT )
        && ( EF_DEF_API_OEM != EF_CONF_API_ENCODING ) )
   { /* Unicode input */
-    (void) eEFPrvu32xCharToUnicode( ppxString, chr );
+    (void) eEFPrvu32xCharToUnicode( ppxString, &chr );
     if ( 0xFFFFFFFF == chr )
     {
       /* Wrong UTF encoding is recognized as end of the string */
       chr = 0;
     }
-    chr = ef_wtoupper( chr );
+    (void) eEFPrvUnicodeToUpper( chr, &chr );
   } /* Unicode input */
   else
   { /* ANSI/OEM input */
@@ -88,7 +88,7 @@ static ef_u32_t u32StringCharGet (
       chr -= 0x20;
     }
     /* To upper SBCS extended char */
-    chr = u32ffToUpperExtendedCharacter( chr );
+    (void) eEFPrvu32ToUpperExtendedCharacter( chr, &chr );
     /* If character is in the range of DBCS first byte */
     if ( EF_RET_OK == eEFPrvByteInDBCRanges1( (ef_u08_t) chr ) )
     {
@@ -85,7 +85,7 @@ static ef_return_et eEFPrvConvertOEMToUnicode (
     EF_CODE_COVERAGE( );
   }
   /* Else, if next byte NOT in double byte code range */
-  else if ( EF_RET_OK == eEFPrvByteInDBCRanges2( (ef_u08_t)*pxString ) )
+  else if ( EF_RET_OK != eEFPrvByteInDBCRanges2( (ef_u08_t)*pxString ) )
   {
     /* code error */
     u16Char = 0;
@@ -98,20 +98,25 @@ static ef_return_et eEFPrvConvertOEMToUnicode (
     u16Char <<= 8;
     u16Char  |= (ef_u08_t) *pxString++;
   }
-  if ( 0 != u16Char )
+  ef_u32_t u32Char = (ef_u32_t) u16Char;
+  if ( EF_RET_OK != eRetVal )
   {
-    ef_u32_t u32Char = (ef_u32_t) u16Char;
-    /* ANSI/OEM ==> Unicode */
-    if ( EF_RET_OK != eEFPrvOEM2Unicode( u32Char, &u32Char, u16ffCPGet( ) ) )
-    {
-      u16Char = 0;
-      /* Invalid code? */
-      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_NAME );
-    }
-    else
-    {
-      *pu32UnicodeOut = (ef_u16_t) u32Char;
-    }
+    *pu32UnicodeOut = 0xFFFFFFFF;
+  }
+  /* Else, if it is the end of the string */
+  else if ( 0 == u16Char )
+  {
+    *pu32UnicodeOut = 0;
+  }
+  /* Else, if ANSI/OEM ==> Unicode failed (invalid code) */
+  else if ( EF_RET_OK != eEFPrvOEM2Unicode( u16Char, &u32Char, u16ffCPGet( ) ) )
+  {
+    *pu32UnicodeOut = 0xFFFFFFFF;
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_NAME );
+  }
+  else
+  {
+    *pu32UnicodeOut = (ef_u16_t) u32Char;
   }
 
   *ppxString = pxString;  /* Next read pointer */
@@ -327,8 +332,7 @@ static ef_return_et eEFPrvConvertUTF16ToOEM (  /* Returns number of encoding uni
   ef_return_et  eRetVal = EF_RET_OK;
 
   /* ANSI/OEM output */
-  ucs2_t    u16Char;
-  ef_u32_t  u32Temp;
+  ef_u32_t  u32Temp = 0;
 
   /* If converting from unicode to OEM failed */
   if ( EF_RET_OK != eEFPrvUnicode2OEM( u32Char, &u32Temp, u16ffCPGet( ) ) )  /* UTF-16 ==> ANSI/OEM */
@@ -337,7 +341,7 @@ static ef_return_et eEFPrvConvertUTF16ToOEM (  /* Returns number of encoding uni
     eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_NAME );
   }
   /* Is this a DBC? */
-  else if ( 0x100 <= u16Char )
+  else if ( 0x100 <= u32Temp )
   { /* DBC */
     if ( 2 > u32BufferSize )
     {
@@ -348,8 +352,8 @@ static ef_return_et eEFPrvConvertUTF16ToOEM (  /* Returns number of encoding uni
     else
     {
       *pu32EncodingUnits = 2;
-      *pxBufferOut++ = (char)(u16Char >> 8);  /* Store DBC 1st byte */
-      *pxBufferOut++ = (TCHAR)u16Char;      /* Store DBC 2nd byte */
+      *pxBufferOut++ = (char)(u32Temp >> 8);  /* Store DBC 1st byte */
+      *pxBufferOut++ = (TCHAR)u32Temp;      /* Store DBC 2nd byte */
     }
   } /* DBC */
   else
@@ -363,7 +367,7 @@ static ef_return_et eEFPrvConvertUTF16ToOEM (  /* Returns number of encoding uni
     else
     {
       *pu32EncodingUnits = 1;
-      *pxBufferOut++ = (TCHAR)u16Char;          /* Store the character */
+      *pxBufferOut++ = (TCHAR)u32Temp;          /* Store the character */
     }
   } /* SBC */
   return eRetVal;
@@ -1164,7 +1164,6 @@ ef_return_et eEFPrvUnicodeToUpperANSIOEM (
   EF_ASSERT_PUBLIC( 0 != pu16OEMOut );
 
   ef_return_et  eRetVal = EF_RET_OK;
-  ef_u16_t      u16RetVal = u16UnicodeIn;
 
   /* At SBCS */
   if ( 0 != ExCvt )
@@ -1207,7 +1206,7 @@ ef_return_et eEFPrvUnicodeToUpperANSIOEM (
     }
   } /* DBCS */
 
-  return u16RetVal;
+  return eRetVal;
 }
 
 /* Test if the byte is DBC 1st byte */
@@ -1512,7 +1511,7 @@ ef_return_et eEFPrvUnicodeToUpper (
   ef_return_et  eRetVal = EF_RET_OK;
 
   /* If it is in BMP (Basic Multilingual Plane) */
-  if ( 0x10000 < u32UnicodeIn )
+  if ( 0x10000 > u32UnicodeIn )
   {
     const ef_u16_t *  pu16Ptr;
     ef_u16_t u16UnitCode = (ef_u16_t)u32UnicodeIn;
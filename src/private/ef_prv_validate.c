@@ -45,11 +45,32 @@
 #include "ef_prv_unicode.h"
 #include "ef_prv_drive.h"
 
-/* Public functions ------------------------------------------------------------------------------------------------ */
+/* Local function prototypes---------------------------------------------------------------------------------------- */
 
-ef_return_et eEFPrvValidateObject (
+/**
+ *  @brief   Check if the file/directory object is valid or not and lock its volume
+ *
+ *  @param  pxObject  Pointer to the ef_object_st, the 1st member in the ef_file_st/ef_directory_st object, to check validity
+ *  @param  ppxFS     Pointer to pointer to the owner filesystem object to return
+ *  @param  bShared   Take the volume lock shared (EF_BOOL_TRUE) or exclusive (EF_BOOL_FALSE)
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK               Succeeded
+ *  @retval EF_RET_INVALID_OBJECT   The file/directory object is invalid
+ *  @retval EF_RET_TIMEOUT          Could not get a grant to access the volume
+ */
+static ef_return_et eEFPrvValidateObjectLock (
   ef_object_st   * pxObject,
-  ef_fs_st      ** ppxFS
+  ef_fs_st      ** ppxFS,
+  ef_bool_t        bShared
+);
+
+/* Local functions ------------------------------------------------------------------------------------------------- */
+
+static ef_return_et eEFPrvValidateObjectLock (
+  ef_object_st   * pxObject,
+  ef_fs_st      ** ppxFS,
+  ef_bool_t        bShared
 )
 {
   EF_ASSERT_PRIVATE( 0 != pxObject );
@@ -73,8 +94,15 @@ ef_return_et eEFPrvValidateObject (
   {
     eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
   }
-  /* Else, if we cannot obtain the file system object */
-  else if ( EF_RET_OK != eEFPrvFSLock( pxObject->pxFS ) )
+  /* Else, if we cannot obtain the file system object exclusively */
+  else if (    ( EF_BOOL_FALSE == bShared )
+            && ( EF_RET_OK != eEFPrvFSLock( pxObject->pxFS ) ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_TIMEOUT );
+  }
+  /* Else, if we cannot obtain the file system object shared */
+  else if (    ( EF_BOOL_TRUE == bShared )
+            && ( EF_RET_OK != eEFPrvFSLockShared( pxObject->pxFS ) ) )
   {
     eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_TIMEOUT );
   }
@@ -82,7 +110,14 @@ ef_return_et eEFPrvValidateObject (
   else if ( 0 != ( EF_RET_DISK_NOINIT & eEFPrvDriveStatus( pxObject->pxFS->u8PhysDrv ) ) )
   {
     eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
-    (void) eEFPrvFSUnlockForce( pxObject->pxFS );
+    if ( EF_BOOL_TRUE == bShared )
+    {
+      (void) eEFPrvFSUnlockShared( pxObject->pxFS, EF_RET_OK );
+    }
+    else
+    {
+      (void) eEFPrvFSUnlockForce( pxObject->pxFS );
+    }
   }
   else
   {
@@ -95,5 +130,29 @@ ef_return_et eEFPrvValidateObject (
   return eRetVal;
 }
 
+/* Public functions ------------------------------------------------------------------------------------------------ */
+
+ef_return_et eEFPrvValidateObject (
+  ef_object_st   * pxObject,
+  ef_fs_st      ** ppxFS
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxObject );
+  EF_ASSERT_PRIVATE( 0 != ppxFS );
+
+  return eEFPrvValidateObjectLock( pxObject, ppxFS, EF_BOOL_FALSE );
+}
+
+ef_return_et eEFPrvValidateObjectShared (
+  ef_object_st   * pxObject,
+  ef_fs_st      ** ppxFS
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxObject );
+  EF_ASSERT_PRIVATE( 0 != ppxFS );
+
+  return eEFPrvValidateObjectLock( pxObject, ppxFS, EF_BOOL_TRUE );
+}
+
 /* ***************************************************************************************************************** */
 /* END OF FILE ***************************************************************************************************** */
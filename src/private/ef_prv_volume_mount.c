@@ -36,6 +36,7 @@
 #include <ef_prv_fat.h>
 #include "ef_prv_drive.h"
 #include "ef_prv_def.h"
+#include "ef_prv_cwd.h"
 #include "ef_prv_directory.h"
 #include "ef_prv_dirfunc.h"
 #include "ef_prv_fs_window.h"
@@ -48,6 +49,7 @@
 #include "ef_prv_validate.h"
 #include "ef_prv_volume_nb.h"
 #include "ef_prv_volume.h"
+#include "ef_prv_volume_snapshot.h"
 #include "ef_prv_def_mbr.h"
 #include "ef_prv_def_bpb_fat.h"
 
@@ -69,10 +71,6 @@
 #define EF_CLUSTER_NB_MAX_FAT32  ( 0x0FFFFFF5 )
 
 
-/* Directory entry block scratchpad buffer */
-#if ( 0 != EF_CONF_VFAT )
-static ef_u08_t  DirBuf[ MAXDIRB( EF_LFN_UNITS_MAX ) ];
-#endif
 /* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
 
 /**
@@ -153,6 +151,25 @@ static  ef_return_et eEFPrvBPBFATAnalyze (
   ef_fs_st  * pxFS
 );
 
+/**
+ *  @brief  Check the volume of a path and lock it
+ *
+ *  @param  ppxPath Pointer to pointer to the pxPath name (drive number)
+ *  @param  ppxFS   Pointer to pointer to the found filesystem object
+ *  @param  bShared Take the volume lock shared (EF_BOOL_TRUE) or exclusive (EF_BOOL_FALSE)
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK               Succeeded
+ *  @retval EF_RET_INVALID_DRIVE    The logical drive number is invalid
+ *  @retval EF_RET_NOT_ENABLED      The volume has no work area
+ *  @retval EF_RET_TIMEOUT          Could not get a grant to access the volume within defined period
+ */
+static  ef_return_et eEFPrvVolumeMountCheckLock (
+  const TCHAR **  ppxPath,
+  ef_fs_st    **  ppxFS,
+  ef_bool_t       bShared
+);
+
 
 /* Local functions ------------------------------------------------------------------------------------------------- */
 
@@ -208,8 +225,8 @@ ef_return_et eEFPrvVolumeMountFinishFAT12 (
   {
     EF_CODE_COVERAGE( );
   }
-  /* Root directory start sector */
-  pxFS->xDirBase = pxFS->xFatBase + pxFS->u32FatSize;
+  /* Root directory start sector, past all the FATs */
+  pxFS->xDirBase = pxFS->xFatBase + ( pxFS->u32FatSize * pxFS->u8FatsNb );
   /* (Needed FAT size) */
   ef_u32_t  u32FATSizeBytes = pxFS->u32FatEntriesNb;
   u32FATSizeBytes *= 3;
@@ -229,7 +246,19 @@ ef_return_et eEFPrvVolumeMountFinishFAT12 (
   /* Get FSInfo if available */
   /* Initialize cluster allocation information */
   pxFS->u32ClstLast   = 0xFFFFFFFF;
+#if ( 1 < EF_CONF_ALLOC_GROUPS )
+  pxFS->u8AllocGroup  = 0;
+  pxFS->bClstLastHint = EF_BOOL_FALSE;
+#endif
   pxFS->u32ClstFreeNb = 0xFFFFFFFF;
+#if ( 0 != EF_CONF_FREE_EXTENTS )
+  pxFS->u8FreeExtNb   = 0;
+  pxFS->bFreeExtValid = EF_BOOL_FALSE;
+#endif
+#if ( 0 != EF_CONF_LAZY_FREE_COUNT )
+  pxFS->u32FreeScanNext = 0;
+  pxFS->u32FreeScanNb   = 0;
+#endif
   pxFS->u8FsInfoFlags = 0x80;
 
   return eRetVal;
@@ -253,8 +282,8 @@ ef_return_et eEFPrvVolumeMountFinishFAT16 (
   {
     EF_CODE_COVERAGE( );
   }
-  /* Root directory start sector */
-  pxFS->xDirBase = pxFS->xFatBase + pxFS->u32FatSize;
+  /* Root directory start sector, past all the FATs */
+  pxFS->xDirBase = pxFS->xFatBase + ( pxFS->u32FatSize * pxFS->u8FatsNb );
   /* (Needed FAT size) */
   ef_u32_t  u32FATSizeBytes = pxFS->u32FatEntriesNb;
   u32FATSizeBytes *= 2;
@@ -273,7 +302,19 @@ ef_return_et eEFPrvVolumeMountFinishFAT16 (
   /* Get FSInfo if available */
   /* Initialize cluster allocation information */
   pxFS->u32ClstLast   = 0xFFFFFFFF;
+#if ( 1 < EF_CONF_ALLOC_GROUPS )
+  pxFS->u8AllocGroup  = 0;
+  pxFS->bClstLastHint = EF_BOOL_FALSE;
+#endif
   pxFS->u32ClstFreeNb = 0xFFFFFFFF;
+#if ( 0 != EF_CONF_FREE_EXTENTS )
+  pxFS->u8FreeExtNb   = 0;
+  pxFS->bFreeExtValid = EF_BOOL_FALSE;
+#endif
+#if ( 0 != EF_CONF_LAZY_FREE_COUNT )
+  pxFS->u32FreeScanNext = 0;
+  pxFS->u32FreeScanNb   = 0;
+#endif
   pxFS->u8FsInfoFlags = 0x80;
 
   return eRetVal;
@@ -341,7 +382,19 @@ ef_return_et eEFPrvVolumeMountFinishFAT32 (
   /* Get FSInfo if available */
   /* Initialize cluster allocation information */
   pxFS->u32ClstLast   = 0xFFFFFFFF;
+#if ( 1 < EF_CONF_ALLOC_GROUPS )
+  pxFS->u8AllocGroup  = 0;
+  pxFS->bClstLastHint = EF_BOOL_FALSE;
+#endif
   pxFS->u32ClstFreeNb = 0xFFFFFFFF;
+#if ( 0 != EF_CONF_FREE_EXTENTS )
+  pxFS->u8FreeExtNb   = 0;
+  pxFS->bFreeExtValid = EF_BOOL_FALSE;
+#endif
+#if ( 0 != EF_CONF_LAZY_FREE_COUNT )
+  pxFS->u32FreeScanNext = 0;
+  pxFS->u32FreeScanNb   = 0;
+#endif
   pxFS->u8FsInfoFlags = 0x80;
 
   if (    ( 0 != EF_CONF_USE_FAT32_FSINFO_CLUSTER_FREE )
@@ -684,6 +737,14 @@ ef_return_et eEFPrvVolumeMount (
       {
         eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_NO_FILESYSTEM );
       }
+#if ( 0 != EF_CONF_ALLOC_SNAPSHOT )
+      /* Else, if taking back the allocation snapshot of the FAT32 volume failed */
+      else if (    ( 0 != ( EF_FS_FAT32 & pxFS->u8FsType ) )
+                && ( EF_RET_OK != eEFPrvVolumeSnapshotLoad( pxFS, u8ReadOnly ) ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+      }
+#endif
       else
       {
         /* Everything went fine */
@@ -703,6 +764,7 @@ ef_return_et eEFPrvVolumeMount (
         {
           /* Initialize current directory */
           pxFS->u32DirClstCurrent = 0;
+          (void) eEFPrvCwdCacheInvalidate( pxFS );
         }
         else
         {
@@ -738,6 +800,7 @@ ef_return_et eEFPrvVolumeMount (
     {
       /* Initialize current directory */
       pxFS->u32DirClstCurrent = 0;
+      (void) eEFPrvCwdCacheInvalidate( pxFS );
     }
     else
     {
@@ -782,9 +845,11 @@ ef_return_et eEFPrvVolumeFSPtrSet (
   return eRetVal;
 }
 
-ef_return_et eEFPrvVolumeMountCheck (
+/* Check the volume of a path and lock it */
+static  ef_return_et eEFPrvVolumeMountCheckLock (
   const TCHAR **  ppxPath,
-  ef_fs_st    **  ppxFS
+  ef_fs_st    **  ppxFS,
+  ef_bool_t       bShared
 )
 {
   EF_ASSERT_PRIVATE( 0 != ppxPath );
@@ -812,8 +877,15 @@ ef_return_et eEFPrvVolumeMountCheck (
   {
     eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_NOT_ENABLED );
   }
-  /* Else, if we cannot lock the volume */
-  else if ( EF_RET_OK != eEFPrvFSLock( pxFS ) )
+  /* Else, if we cannot lock the volume exclusively */
+  else if (    ( EF_BOOL_FALSE == bShared )
+            && ( EF_RET_OK != eEFPrvFSLock( pxFS ) ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_TIMEOUT );
+  }
+  /* Else, if we cannot lock the volume shared */
+  else if (    ( EF_BOOL_TRUE == bShared )
+            && ( EF_RET_OK != eEFPrvFSLockShared( pxFS ) ) )
   {
     eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_TIMEOUT );
   }
@@ -848,5 +920,21 @@ ef_return_et eEFPrvVolumeMountCheck (
   return eRetVal;
 }
 
+ef_return_et eEFPrvVolumeMountCheck (
+  const TCHAR **  ppxPath,
+  ef_fs_st    **  ppxFS
+)
+{
+  return eEFPrvVolumeMountCheckLock( ppxPath, ppxFS, EF_BOOL_FALSE );
+}
+
+ef_return_et eEFPrvVolumeMountCheckShared (
+  const TCHAR **  ppxPath,
+  ef_fs_st    **  ppxFS
+)
+{
+  return eEFPrvVolumeMountCheckLock( ppxPath, ppxFS, EF_BOOL_TRUE );
+}
+
 /* ***************************************************************************************************************** */
 /* END OF FILE ***************************************************************************************************** */
@@ -0,0 +1,394 @@
+/**
+ * ********************************************************************************************************************
+ *  @file     ef_prv_volume_snapshot.c
+ *  @ingroup  group_eFAT_Private
+ *  @author   ChaN
+ *  @author   Emmanuel AMADIO
+ *  @version  V0.1
+ *  @brief    Allocation snapshot of a volume, kept across unmount and mount.
+ *
+ * ********************************************************************************************************************
+ *  eFAT - embedded FAT Filesystem module
+ * ********************************************************************************************************************
+ *
+ *  Copyright (C) 2021, Amadio Emmanuel, all right reserved.
+ *  Copyright (C) 2019, ChaN, all right reserved.
+ *
+ *  eFAT module is an open source software. Redistribution and use of eFAT in source and binary forms, with or without
+ *  modification, are permitted provided that the following condition is met:
+ *
+ *  Redistributions of source code must retain the above copyright notice, this condition and the following disclaimer.
+ *
+ *  This software is provided by the copyright holders and contributors "AS IS" and any warranties related to this
+ *  software are DISCLAIMED.
+ *  The copyright owners or contributors be NOT LIABLE for any damages caused by use of this software.
+ * ********************************************************************************************************************
+ */
+
+/* START OF FILE *************************************************************************************************** */
+/* ***************************************************************************************************************** */
+
+/* Includes -------------------------------------------------------------------------------------------------------- */
+#include <efat.h>
+#include <ef_port_load_store.h>
+#include <ef_port_memory.h>
+#include "ef_prv_def.h"
+#include "ef_prv_def_bpb_fat.h"
+#include "ef_prv_drive.h"
+#include "ef_prv_fs_window.h"
+#include "ef_prv_lock.h"
+#include "ef_prv_volume_snapshot.h"
+
+#if ( 0 != EF_CONF_ALLOC_SNAPSHOT )
+
+/* Local constant macros ------------------------------------------------------------------------------------------- */
+
+/**
+ *  The snapshot is held by the main reserved bytes of the FSINFO sector, which are left untouched by the other systems
+ */
+#define EF_SNAPSHOT_OFFSET                ( EF_BS_FAT32_FSI_OFFSET_RESERVED_MAIN )
+
+#define EF_SNAPSHOT_OFFSET_SIGNATURE      ( EF_SNAPSHOT_OFFSET +  0 ) /**< Signature (4 bytes) */
+#define EF_SNAPSHOT_OFFSET_GENERATION     ( EF_SNAPSHOT_OFFSET +  4 ) /**< Generation number of the snapshot (4 bytes) */
+#define EF_SNAPSHOT_OFFSET_FREE_CLUSTERS  ( EF_SNAPSHOT_OFFSET +  8 ) /**< Number of free clusters (4 bytes) */
+#define EF_SNAPSHOT_OFFSET_CLUSTER_LAST   ( EF_SNAPSHOT_OFFSET + 12 ) /**< Last allocated cluster (4 bytes) */
+#define EF_SNAPSHOT_OFFSET_EXTENTS_NB     ( EF_SNAPSHOT_OFFSET + 16 ) /**< Number of free extents (1 byte) */
+#define EF_SNAPSHOT_OFFSET_FLAGS          ( EF_SNAPSHOT_OFFSET + 17 ) /**< Flags (1 byte) */
+#define EF_SNAPSHOT_OFFSET_EXTENTS        ( EF_SNAPSHOT_OFFSET + 20 ) /**< Free extents, start and length (8 bytes each) */
+#define EF_SNAPSHOT_OFFSET_MOUNT          ( EF_BS_FAT32_FSI_OFFSET_SIGNATURE_NEXT - 8 ) /**< Generation number of the last
+                                                                                           mount (4 bytes) */
+#define EF_SNAPSHOT_OFFSET_CHECKSUM       ( EF_BS_FAT32_FSI_OFFSET_SIGNATURE_NEXT - 4 ) /**< Checksum (4 bytes) */
+
+/**
+ *  Maximum number of free extents held by the snapshot
+ */
+#define EF_SNAPSHOT_EXTENTS_MAX           ( ( EF_SNAPSHOT_OFFSET_MOUNT - EF_SNAPSHOT_OFFSET_EXTENTS ) / 8 )
+
+#define EF_SNAPSHOT_SIGNATURE             ( 0x50414E53 )  /**< "SNAP" */
+#define EF_SNAPSHOT_FLAG_INDEX            ( 0x01 )        /**< The free extents index was built */
+#define EF_SNAPSHOT_FLAG_PARTIAL          ( 0x02 )        /**< Free runs may be missing from the index */
+
+/* Local function macros ------------------------------------------------------------------------------------------- */
+/* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
+/* Local variables ------------------------------------------------------------------------------------------------- */
+/* Public variables ------------------------------------------------------------------------------------------------ */
+/* Local function prototypes---------------------------------------------------------------------------------------- */
+
+/**
+ *  @brief  Compute the checksum of the snapshot held by the window
+ *
+ *  @param  pu8Window Pointer to the window holding the FSINFO sector
+ *
+ *  @return Checksum of the snapshot, from its signature to the generation number of the last mount excluded
+ */
+static ef_u32_t u32EFPrvSnapshotSum (
+  const ef_u08_t  * pu8Window
+);
+
+/**
+ *  @brief  Check the snapshot held by the window
+ *
+ *  The snapshot must be complete, no writable mount must have followed it: the generation number of the last mount is
+ *  the one of the snapshot. It must match the FSINFO fields, which the other systems update when they change the
+ *  volume, and its extents must be runs of clusters of the volume. Whether they are still free is only known from the
+ *  FAT, they are checked there before the first allocation from the index.
+ *
+ *  @param  pxFS  Pointer to the file system object, its window holding the FSINFO sector
+ *
+ *  @return EF_BOOL_TRUE when the snapshot can be taken back
+ */
+static ef_bool_t bEFPrvSnapshotValid (
+  ef_fs_st  * pxFS
+);
+
+/* Local functions ------------------------------------------------------------------------------------------------- */
+
+static ef_u32_t u32EFPrvSnapshotSum (
+  const ef_u08_t  * pu8Window
+)
+{
+  ef_u32_t  u32Sum = 0;
+
+  for ( ef_u32_t u32Index = EF_SNAPSHOT_OFFSET ; u32Index < EF_SNAPSHOT_OFFSET_MOUNT ; u32Index++ )
+  {
+    u32Sum = ( ( u32Sum & 1 ) ? 0x80000000 : 0 ) + ( u32Sum >> 1 ) + pu8Window[ u32Index ];
+  }
+
+  return u32Sum;
+}
+
+static ef_bool_t bEFPrvSnapshotValid (
+  ef_fs_st  * pxFS
+)
+{
+  ef_u08_t  * pu8Window = pxFS->pu8Window;
+  ef_bool_t   bValid = EF_BOOL_TRUE;
+  ef_u32_t    u32FreeNb = u32EFPortLoad( pu8Window + EF_SNAPSHOT_OFFSET_FREE_CLUSTERS );
+  ef_u32_t    u32ExtentsNb = pu8Window[ EF_SNAPSHOT_OFFSET_EXTENTS_NB ];
+  ef_u32_t    u32Total = 0;
+  ef_u32_t    u32Start;
+  ef_u32_t    u32Length;
+
+  /* If there is no snapshot */
+  if (    ( EF_SNAPSHOT_SIGNATURE != u32EFPortLoad( pu8Window + EF_SNAPSHOT_OFFSET_SIGNATURE ) )
+       || ( u32EFPrvSnapshotSum( pu8Window ) != u32EFPortLoad( pu8Window + EF_SNAPSHOT_OFFSET_CHECKSUM ) ) )
+  {
+    bValid = EF_BOOL_FALSE;
+  }
+  /* Else, if a writable mount has taken it back since it was saved, the FAT may have changed then */
+  else if (    u32EFPortLoad( pu8Window + EF_SNAPSHOT_OFFSET_GENERATION )
+            != u32EFPortLoad( pu8Window + EF_SNAPSHOT_OFFSET_MOUNT ) )
+  {
+    bValid = EF_BOOL_FALSE;
+  }
+  /* Else, if the volume has been changed since the snapshot was saved */
+  else if (    ( u32FreeNb != u32EFPortLoad( pu8Window + EF_BS_FAT32_FSI_OFFSET_FREE_CLUSTERS ) )
+            || (    u32EFPortLoad( pu8Window + EF_SNAPSHOT_OFFSET_CLUSTER_LAST )
+                 != u32EFPortLoad( pu8Window + EF_BS_FAT32_FSI_OFFSET_CLUSTER_LAST_ALLOC ) ) )
+  {
+    bValid = EF_BOOL_FALSE;
+  }
+  /* Else, if the snapshot does not fit the volume */
+  else if ( ( u32FreeNb > ( pxFS->u32FatEntriesNb - 2 ) ) || ( u32ExtentsNb > EF_SNAPSHOT_EXTENTS_MAX ) )
+  {
+    bValid = EF_BOOL_FALSE;
+  }
+  else
+  {
+    /* Every extent must be a run of clusters of the volume, sorted by increasing length */
+    for ( ef_u32_t u32Index = 0 ; ( EF_BOOL_FALSE != bValid ) && ( u32Index < u32ExtentsNb ) ; u32Index++ )
+    {
+      u32Start  = u32EFPortLoad( pu8Window + EF_SNAPSHOT_OFFSET_EXTENTS + ( u32Index * 8 ) );
+      u32Length = u32EFPortLoad( pu8Window + EF_SNAPSHOT_OFFSET_EXTENTS + ( u32Index * 8 ) + 4 );
+      if (    ( 2 > u32Start )
+           || ( u32Start >= pxFS->u32FatEntriesNb )
+           || ( 0 == u32Length )
+           || ( u32Length > ( pxFS->u32FatEntriesNb - u32Start ) )
+           || ( u32Length > ( u32FreeNb - u32Total ) ) )
+      {
+        bValid = EF_BOOL_FALSE;
+      }
+      else if (    ( 0 != u32Index )
+                && ( u32Length < u32EFPortLoad( pu8Window + EF_SNAPSHOT_OFFSET_EXTENTS + ( u32Index * 8 ) - 4 ) ) )
+      {
+        bValid = EF_BOOL_FALSE;
+      }
+      else
+      {
+        u32Total += u32Length;
+      }
+    }
+  }
+
+  return bValid;
+}
+
+/* Public functions ------------------------------------------------------------------------------------------------ */
+
+ef_return_et eEFPrvVolumeSnapshotLoad (
+  ef_fs_st  * pxFS,
+  ef_u08_t    u8ReadOnly
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u08_t    * pu8Window = pxFS->pu8Window;
+#if ( 0 != EF_CONF_FREE_EXTENTS )
+  ef_u32_t      u32ExtentsNb;
+  ef_u32_t      u32Skip;
+#endif
+
+  pxFS->u32SnapGeneration = 0;
+  pxFS->bSnapSave         = EF_BOOL_FALSE;
+  /* If reading the boot sector failed */
+  if ( EF_RET_OK != eEFPrvFSWindowLoad( pxFS, pxFS->xVolBase ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+  }
+  /* Else, if the FSINFO sector does not follow the boot sector, it is not used */
+  else if ( 1 != u16EFPortLoad( pu8Window + EF_BS_EBPB_FAT32_OFFSET_FS_INFO_SECTOR ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if reading the FSINFO sector failed */
+  else if ( EF_RET_OK != eEFPrvFSWindowLoad( pxFS, pxFS->xVolBase + 1 ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+  }
+  /* Else, if the FSINFO sector is not valid */
+  else if (    ( 0xAA55 != u16EFPortLoad( pu8Window + EF_BS_OFFSET_SIGNATURE ) )
+            || ( 0x41615252 != u32EFPortLoad( pu8Window + EF_BS_FAT32_FSI_OFFSET_SIGNATURE_LEAD ) )
+            || ( 0x61417272 != u32EFPortLoad( pu8Window + EF_BS_FAT32_FSI_OFFSET_SIGNATURE_NEXT ) ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else
+  {
+    pxFS->bSnapSave = ( 0 == u8ReadOnly ) ? EF_BOOL_TRUE : EF_BOOL_FALSE;
+    /* The generations go on from the last snapshot saved or the last mount, even when it cannot be taken back */
+    if ( EF_SNAPSHOT_SIGNATURE == u32EFPortLoad( pu8Window + EF_SNAPSHOT_OFFSET_SIGNATURE ) )
+    {
+      pxFS->u32SnapGeneration = u32EFPortLoad( pu8Window + EF_SNAPSHOT_OFFSET_GENERATION );
+      if ( pxFS->u32SnapGeneration < u32EFPortLoad( pu8Window + EF_SNAPSHOT_OFFSET_MOUNT ) )
+      {
+        pxFS->u32SnapGeneration = u32EFPortLoad( pu8Window + EF_SNAPSHOT_OFFSET_MOUNT );
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+
+    /* If the snapshot cannot be taken back */
+    if ( EF_BOOL_FALSE == bEFPrvSnapshotValid( pxFS ) )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    else
+    {
+      pxFS->u32ClstFreeNb = u32EFPortLoad( pu8Window + EF_SNAPSHOT_OFFSET_FREE_CLUSTERS );
+      pxFS->u32ClstLast   = u32EFPortLoad( pu8Window + EF_SNAPSHOT_OFFSET_CLUSTER_LAST );
+#if ( 0 != EF_CONF_FREE_EXTENTS )
+      /* If the free extents index was built, its largest extents are kept */
+      if ( 0 != ( EF_SNAPSHOT_FLAG_INDEX & pu8Window[ EF_SNAPSHOT_OFFSET_FLAGS ] ) )
+      {
+        u32ExtentsNb = pu8Window[ EF_SNAPSHOT_OFFSET_EXTENTS_NB ];
+        u32Skip = ( u32ExtentsNb > EF_CONF_FREE_EXTENTS ) ? ( u32ExtentsNb - EF_CONF_FREE_EXTENTS ) : 0;
+        for ( ef_u32_t u32Index = u32Skip ; u32Index < u32ExtentsNb ; u32Index++ )
+        {
+          pxFS->xFreeExt[ u32Index - u32Skip ].u32Start  =
+            u32EFPortLoad( pu8Window + EF_SNAPSHOT_OFFSET_EXTENTS + ( u32Index * 8 ) );
+          pxFS->xFreeExt[ u32Index - u32Skip ].u32Length =
+            u32EFPortLoad( pu8Window + EF_SNAPSHOT_OFFSET_EXTENTS + ( u32Index * 8 ) + 4 );
+        }
+        pxFS->u8FreeExtNb      = (ef_u08_t) ( u32ExtentsNb - u32Skip );
+        pxFS->bFreeExtValid    = EF_BOOL_TRUE;
+        pxFS->bFreeExtRestored = EF_BOOL_TRUE;
+        pxFS->bFreeExtPartial  = (    ( 0 != u32Skip )
+                                   || ( 0 != ( EF_SNAPSHOT_FLAG_PARTIAL & pu8Window[ EF_SNAPSHOT_OFFSET_FLAGS ] ) ) )
+                                 ? EF_BOOL_TRUE : EF_BOOL_FALSE;
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+#endif
+
+      /* If the volume is writable, a power loss must not leave the snapshot valid once the FAT has changed */
+      if ( EF_BOOL_FALSE == pxFS->bSnapSave )
+      {
+        EF_CODE_COVERAGE( );
+      }
+      else
+      {
+        /* The mount takes the next generation, the snapshot does not match it any more */
+        pxFS->u32SnapGeneration++;
+        vEFPortStoreu32( pu8Window + EF_SNAPSHOT_OFFSET_MOUNT, pxFS->u32SnapGeneration );
+        pxFS->u8WinFlags |= EF_FS_WIN_DIRTY;
+        if (    ( EF_RET_OK != eEFPrvFSWindowStore( pxFS ) )
+             || ( EF_RET_OK != eEFPrvDriveIOCtrl( pxFS->u8PhysDrv, CTRL_SYNC, 0 ) ) )
+        {
+          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+        }
+        else
+        {
+          EF_CODE_COVERAGE( );
+        }
+      }
+    }
+  }
+
+  return eRetVal;
+}
+
+ef_return_et eEFPrvVolumeSnapshotSave (
+  ef_fs_st  * pxFS
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u08_t    * pu8Window = pxFS->pu8Window;
+#if ( 0 != EF_CONF_FREE_EXTENTS )
+  ef_u32_t      u32ExtentsNb;
+  ef_u32_t      u32Skip;
+#endif
+
+  /* If no snapshot is saved for this volume */
+  if ( EF_BOOL_FALSE == pxFS->bSnapSave )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if the number of free clusters is not known, there is nothing worth saving */
+  else if ( pxFS->u32ClstFreeNb > ( pxFS->u32FatEntriesNb - 2 ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if reading the FSINFO sector failed, the window being flushed first */
+  else if ( EF_RET_OK != eEFPrvFSWindowLoad( pxFS, pxFS->xVolBase + 1 ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+  }
+  else
+  {
+    /* The FSINFO fields are updated with the snapshot, the mount compares them */
+    eEFPortMemZero( pu8Window + EF_SNAPSHOT_OFFSET, EF_BS_FAT32_FSI_OFFSET_SIGNATURE_NEXT - EF_SNAPSHOT_OFFSET );
+    vEFPortStoreu32( pu8Window + EF_BS_FAT32_FSI_OFFSET_FREE_CLUSTERS, pxFS->u32ClstFreeNb );
+    vEFPortStoreu32( pu8Window + EF_BS_FAT32_FSI_OFFSET_CLUSTER_LAST_ALLOC, pxFS->u32ClstLast );
+    vEFPortStoreu32( pu8Window + EF_SNAPSHOT_OFFSET_SIGNATURE, EF_SNAPSHOT_SIGNATURE );
+    vEFPortStoreu32( pu8Window + EF_SNAPSHOT_OFFSET_GENERATION, pxFS->u32SnapGeneration + 1 );
+    vEFPortStoreu32( pu8Window + EF_SNAPSHOT_OFFSET_MOUNT, pxFS->u32SnapGeneration + 1 );
+    vEFPortStoreu32( pu8Window + EF_SNAPSHOT_OFFSET_FREE_CLUSTERS, pxFS->u32ClstFreeNb );
+    vEFPortStoreu32( pu8Window + EF_SNAPSHOT_OFFSET_CLUSTER_LAST, pxFS->u32ClstLast );
+#if ( 0 != EF_CONF_FREE_EXTENTS )
+    /* If the free extents index is built, its largest extents are saved */
+    if ( EF_BOOL_FALSE != pxFS->bFreeExtValid )
+    {
+      u32ExtentsNb = pxFS->u8FreeExtNb;
+      u32Skip = ( u32ExtentsNb > EF_SNAPSHOT_EXTENTS_MAX ) ? ( u32ExtentsNb - EF_SNAPSHOT_EXTENTS_MAX ) : 0;
+      for ( ef_u32_t u32Index = u32Skip ; u32Index < u32ExtentsNb ; u32Index++ )
+      {
+        vEFPortStoreu32(  pu8Window + EF_SNAPSHOT_OFFSET_EXTENTS + ( ( u32Index - u32Skip ) * 8 ),
+                          pxFS->xFreeExt[ u32Index ].u32Start );
+        vEFPortStoreu32(  pu8Window + EF_SNAPSHOT_OFFSET_EXTENTS + ( ( u32Index - u32Skip ) * 8 ) + 4,
+                          pxFS->xFreeExt[ u32Index ].u32Length );
+      }
+      pu8Window[ EF_SNAPSHOT_OFFSET_EXTENTS_NB ] = (ef_u08_t) ( u32ExtentsNb - u32Skip );
+      pu8Window[ EF_SNAPSHOT_OFFSET_FLAGS ] =
+        ( ( 0 != u32Skip ) || ( EF_BOOL_FALSE != pxFS->bFreeExtPartial ) )
+        ? ( EF_SNAPSHOT_FLAG_INDEX | EF_SNAPSHOT_FLAG_PARTIAL ) : EF_SNAPSHOT_FLAG_INDEX;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+#endif
+    vEFPortStoreu32( pu8Window + EF_SNAPSHOT_OFFSET_CHECKSUM, u32EFPrvSnapshotSum( pu8Window ) );
+    pxFS->u8WinFlags |= EF_FS_WIN_DIRTY;
+
+    /* If writing the FSINFO sector failed */
+    if (    ( EF_RET_OK != eEFPrvFSWindowStore( pxFS ) )
+         || ( EF_RET_OK != eEFPrvDriveIOCtrl( pxFS->u8PhysDrv, CTRL_SYNC, 0 ) ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+    }
+    else
+    {
+      pxFS->u32SnapGeneration++;
+      /* The FSINFO sector is up to date */
+      pxFS->u8FsInfoFlags &= (ef_u08_t) ~0x01;
+    }
+  }
+
+  return eRetVal;
+}
+
+#endif /* ( 0 != EF_CONF_ALLOC_SNAPSHOT ) */
+
+/* ***************************************************************************************************************** */
+/* END OF FILE ***************************************************************************************************** */
@@ -31,6 +31,8 @@
 /* Includes -------------------------------------------------------------------------------------------------------- */
 
 #include <efat.h>
+#include <ef_prv_def.h>
+#include <ef_prv_file.h>
 #include "ef_prv_lock.h"
 #include "ef_prv_validate.h"
 
@@ -52,7 +54,34 @@ ef_return_et eEF_fclose (
   ef_return_et  eRetVal = EF_RET_OK;
   ef_fs_st    * pxFS;
 
-  /* Flush cached data */
+#if ( 0 != EF_CONF_NON_BLOCKING )
+  /* If the non-blocking operation in progress on the file cannot be abandoned (its transfer is waited for) */
+  if ( EF_RET_OK != eEFPrvFileNbCancel( pxFile ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+  }
+  else
+#endif
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+  /* If in bounded latency write mode, give the unused pool clusters back */
+  if (    ( 0 != pxFile->u32PoolSize )
+       && ( EF_RET_OK != eEF_fbounded( pxFile, 0 ) ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+  }
+  /* Else, flush cached data */
+  else
+#endif
+#if ( 0 != EF_CONF_FILE_RESERVE )
+  /* If clusters are reserved past the end of the file, give them back */
+  if (    ( EF_BOOL_FALSE != pxFile->bReserved )
+       && ( EF_RET_OK != eEF_reserve( pxFile, 0 ) ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+  }
+  /* Else, flush cached data */
+  else
+#endif
   if ( EF_RET_OK != eEF_fsync( pxFile ) )
   {
     eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
@@ -65,7 +94,7 @@ ef_return_et eEF_fclose (
     eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
   }
   /* Decrement file open counter */
-  else if ( EF_RET_OK != eEFPrvLockDec( pxFile->xObject.u32LockId ) )
+  else if ( EF_RET_OK != eEFPrvLockDec( pxFS, pxFile->xObject.u32LockId ) )
   {
     /* Invalidate file object */
     pxFile->xObject.pxFS = 0;
@@ -73,7 +102,8 @@ ef_return_et eEF_fclose (
   }
   else
   {
-    EF_CODE_COVERAGE( );
+    /* Invalidate file object, a second close does not release its lock entry again */
+    pxFile->xObject.pxFS = 0;
   }
 
   /* Unlock volume */
@@ -53,6 +53,14 @@
 
 /* Local constant macros ------------------------------------------------------------------------------------------- */
 /* Local function macros ------------------------------------------------------------------------------------------- */
+
+/**
+ *  The cluster chain of a file truncated on opening is kept when the option is enabled and the file is written
+ */
+#define EF_FILE_TRUNCATE_KEEP( u8Mode )                                                                               \
+  ( (    ( 0 != EF_CONF_TRUNCATE_REUSE )                                                                              \
+      && ( ( EF_FILE_OPEN_TRUNCATE | EF_FILE_OPEN_WRITE )                                                             \
+           == ( ( u8Mode ) & ( EF_FILE_OPEN_TRUNCATE | EF_FILE_OPEN_WRITE ) ) ) ) ? EF_BOOL_TRUE : EF_BOOL_FALSE )
 /* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
 /* Local variables ------------------------------------------------------------------------------------------------- */
 /* Public variables ------------------------------------------------------------------------------------------------ */
@@ -64,6 +72,7 @@
  *  @param  pxFile  Pointer to the blank file object
  *  @param  pxFS    Pointer to the file system object
  *  @param  pxDir   Pointer to directory object to update
+ *  @param  bKeepChain  Keep the cluster chain for the next writes, its tail is freed on closing
  *
  *  @return Function completion
  *  @retval EF_RET_OK                   Succeeded
@@ -90,7 +99,8 @@
 ef_return_et eEF_file_truncate (
   ef_file_st      * pxFile,
   ef_fs_st        * pxFS,
-  ef_directory_st * pxDir
+  ef_directory_st * pxDir,
+  ef_bool_t         bKeepChain
 );
 
 /* Local functions ------------------------------------------------------------------------------------------------- */
@@ -98,46 +108,71 @@ ef_return_et eEF_file_truncate (
 ef_return_et eEF_file_truncate (
   ef_file_st      * pxFile,
   ef_fs_st        * pxFS,
-  ef_directory_st * pxDir
+  ef_directory_st * pxDir,
+  ef_bool_t         bKeepChain
 )
 {
   EF_ASSERT_PRIVATE( 0 != pxFile );
   EF_ASSERT_PRIVATE( 0 != pxFS );
 
-  ef_return_et  eRetVal = EF_RET_ERROR;
+  ef_return_et  eRetVal = EF_RET_OK;
 
   ef_u32_t  u32Cluster;
   ef_lba_t  xSector;
 
   /* Set directory entry initial state */
   /* Get current cluster chain */
-  //u32Cluster = eEFPrvDirectoryClusterGet( pxFS, pxDir->pu8Dir );
   if ( EF_RET_OK != eEFPrvDirectoryClusterGet(  pxFS,
                                                 pxDir->pu8Dir,
                                                 &u32Cluster ) )
   {
     eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
   }
-  /* Set created time */
-  vEFPortStoreu32( pxDir->pu8Dir + EF_DIR_TIME_CREATED, EF_FATTIME_GET( ) );
-  /* Reset attribute */
-  pxDir->pu8Dir[ EF_DIR_ATTRIBUTES ] = EF_DIR_ATTRIB_BIT_ARCHIVE;
-  /* Reset file allocation info */
-  (void) eEFPrvDirectoryClusterSet( pxFS, pxDir->pu8Dir, 0 );
-  vEFPortStoreu32( pxDir->pu8Dir + EF_DIR_FILE_SIZE, 0 );
-  pxFS->u8WinFlags = EF_FS_WIN_DIRTY;
-  /* Remove the cluster chain if exist */
-  if ( 0 != u32Cluster )
+  else
+  {
+    /* Set created time */
+    vEFPortStoreu32( pxDir->pu8Dir + EF_DIR_TIME_CREATED, EF_FATTIME_GET( ) );
+    /* Reset attribute */
+    pxDir->pu8Dir[ EF_DIR_ATTRIBUTES ] = EF_DIR_ATTRIB_BIT_ARCHIVE;
+    /* Reset file allocation info */
+    if ( EF_BOOL_FALSE == bKeepChain )
+    {
+      (void) eEFPrvDirectoryClusterSet( pxFS, pxDir->pu8Dir, 0 );
+    }
+    vEFPortStoreu32( pxDir->pu8Dir + EF_DIR_FILE_SIZE, 0 );
+    pxFS->u8WinFlags = EF_FS_WIN_DIRTY;
+  }
+  /* If the cluster chain is kept, the writes reuse it and the file closing frees its tail */
+  if ( EF_BOOL_FALSE != bKeepChain )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, remove the cluster chain if exist */
+  else if (    ( EF_RET_OK == eRetVal )
+            && ( 0 != u32Cluster ) )
   {
     xSector = pxFS->xWindowSector;
-    if ( EF_RET_OK == eEFPrvFATChainRemove( &(pxDir->xObject), u32Cluster, 0 ) )
+    if ( EF_RET_OK != eEFPrvFATChainRemove( &(pxDir->xObject), u32Cluster, 0 ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+    }
+    else if ( EF_RET_OK != eEFPrvFSWindowLoad( pxFS, xSector ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+    }
+    else
     {
-      eRetVal = eEFPrvFSWindowLoad( pxFS, xSector );
-      if ( EF_RET_OK != eRetVal ) { (void) EF_RETURN_CODE_HANDLER( eRetVal );}
       /* Reuse the cluster hole */
       pxFS->u32ClstLast = u32Cluster - 1;
+#if ( 1 < EF_CONF_ALLOC_GROUPS )
+      pxFS->bClstLastHint = EF_BOOL_TRUE;
+#endif
     }
   }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
 
   return eRetVal;
 }
@@ -251,7 +286,7 @@ ef_return_et eEF_fopen (
       { /* Create or Open a file */
 
         /* If there is NOT file lock available */
-        if ( EF_RET_OK != eEFPrvLockEnq( ) )
+        if ( EF_RET_OK != eEFPrvLockEnq( pxFS ) )
         {
           eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_TOO_MANY_OPEN_FILES );
         }
@@ -291,13 +326,12 @@ ef_return_et eEF_fopen (
         EF_CODE_COVERAGE( );
       }
       /* Else, if truncating the file failed (FAT filesystem) */
-      else if ( EF_RET_OK != eEF_file_truncate( pxFile,pxFS, &xDir ) )
+      else if ( EF_RET_OK != eEF_file_truncate( pxFile,pxFS, &xDir, EF_FILE_TRUNCATE_KEEP( u8Mode ) ) )
       {
         eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
       }
       else
       {
-        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
         EF_CODE_COVERAGE( );
       }
 
@@ -307,8 +341,8 @@ ef_return_et eEF_fopen (
       }
       else
       {
-        /* Set file change u8StatusFlags if created or overwritten */
-        if ( 0 != ( u8Mode & EF_FILE_MODIFIED ) )
+        /* Set file change u8StatusFlags if created or truncated, the directory entry is written back by the sync */
+        if ( 0 != ( u8Mode & EF_FILE_OPEN_TRUNCATE ) )
         {
           u8Mode |= EF_FILE_MODIFIED;
         }
@@ -361,6 +395,32 @@ ef_return_et eEF_fopen (
         pxFile->xSector = 0;
         /* Set file pointer top of the file */
         pxFile->u32FileOffset = 0;
+#if ( 0 != EF_CONF_FILE_RESERVE )
+        /* The chain kept by truncating is reserved past the end of the file until the file is closed */
+        pxFile->bReserved = (    ( EF_BOOL_FALSE != EF_FILE_TRUNCATE_KEEP( u8Mode ) )
+                              && ( 0 != pxFile->xObject.u32ClstStart ) ) ? EF_BOOL_TRUE : EF_BOOL_FALSE;
+#endif
+#if ( 0 != EF_CONF_NON_BLOCKING )
+        /* No non-blocking operation in progress */
+        pxFile->u8NbState     = EF_FILE_NB_IDLE;
+        pxFile->bNbTransfer   = EF_BOOL_FALSE;
+#endif
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+        /* Not in bounded latency write mode */
+        pxFile->u32PoolSize   = 0;
+        pxFile->u32PoolNext   = 0;
+        pxFile->u32PoolNb     = 0;
+        pxFile->u32PoolPrev   = 0;
+        pxFile->u32BwWritesNb = 0;
+        pxFile->u32BwShortNb  = 0;
+        pxFile->u32BwCmdsMax  = 0;
+#endif
+#if ( 0 != EF_CONF_FILE_DIGEST )
+        /* No digest attached */
+        pxFile->pxDigest        = 0;
+        pxFile->pvDigestContext = 0;
+        pxFile->u32DigestOffset = 0;
+#endif
         /* Clear sector buffer */
         eEFPortMemZero( pxFile->u8Window, sizeof(pxFile->u8Window) );
 
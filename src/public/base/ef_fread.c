@@ -57,21 +57,6 @@
 /* Local variables ------------------------------------------------------------------------------------------------- */
 /* Public variables ------------------------------------------------------------------------------------------------ */
 /* Local function prototypes---------------------------------------------------------------------------------------- */
-
-/**
- *  @brief  Update the file structure cluster number for next read access (on cluster crossing)
- *
- *  @param  pxFile  Pointer to the file object
- *
- *  @return Operation result
- *  @retval EF_RET_OK     Success
- *  @retval EF_RET_ERROR  An error occurred
- *  @retval EF_RET_ASSERT Assertion failed
- */
-ef_return_et eEFPrvFileReadClusterNbUpdate (
-  ef_file_st  * pxFile
-);
-
 /* Local functions ------------------------------------------------------------------------------------------------- */
 
 ef_return_et eEFPrvFileReadClusterNbUpdate (
@@ -90,17 +75,26 @@ ef_return_et eEFPrvFileReadClusterNbUpdate (
     /* Follow cluster chain from the origin */
     pxFile->u32Clst = pxFile->xObject.u32ClstStart;
   }
-  /* Else, if Following cluster chain on the FAT failed (Middle or end of the file) */
-  else if ( EF_RET_OK != eEFPrvFATGet( pxFile->xObject.pxFS, pxFile->u32Clst, &u32ClusterNb ) )
+  /* Else, if the filesystem window cannot be used to follow the chain */
+  else if ( EF_RET_OK != eEFPrvFSWindowLock( pxFile->xObject.pxFS ) )
   {
-    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
-    /* Update current cluster */
-    pxFile->u32Clst = 0;
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_TIMEOUT );
   }
   else
   {
-    /* Update current cluster */
-    pxFile->u32Clst = u32ClusterNb;
+    /* If Following cluster chain on the FAT failed (Middle or end of the file) */
+    if ( EF_RET_OK != eEFPrvFATGet( pxFile->xObject.pxFS, pxFile->u32Clst, &u32ClusterNb ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+      /* Update current cluster */
+      pxFile->u32Clst = 0;
+    }
+    else
+    {
+      /* Update current cluster */
+      pxFile->u32Clst = u32ClusterNb;
+    }
+    (void) eEFPrvFSWindowUnlock( pxFile->xObject.pxFS );
   }
 
   return eRetVal;
@@ -121,12 +115,20 @@ ef_return_et eEF_fread (
 
   ef_return_et  eRetVal = EF_RET_OK;
   ef_fs_st    * pxFS;
+  /* A file not opened for writing only needs the shared grant */
+  ef_bool_t     bShared = ( 0 == ( EF_FILE_OPEN_WRITE & pxFile->u8StatusFlags ) ) ? EF_BOOL_TRUE : EF_BOOL_FALSE;
 
   /* Clear read byte counter */
   *pu32BytesRead = 0;
   /* Check validity of the file object */
   /* If File object is not valid */
-  if ( EF_RET_OK != eEFPrvValidateObject( &pxFile->xObject, &pxFS ) )
+  if (    ( EF_BOOL_TRUE == bShared )
+       && ( EF_RET_OK != eEFPrvValidateObjectShared( &pxFile->xObject, &pxFS ) ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
+  }
+  else if (    ( EF_BOOL_FALSE == bShared )
+            && ( EF_RET_OK != eEFPrvValidateObject( &pxFile->xObject, &pxFS ) ) )
   {
     eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
   }
@@ -143,19 +145,6 @@ ef_return_et eEF_fread (
   }
   else
   {
-
-    /* On the top of the file? */
-    if ( 0 == pxFile->u32FileOffset )
-    {
-      /* Follow from the origin */
-      /* Update current cluster */
-      pxFile->u32Clst = pxFile->xObject.u32ClstStart;
-    }
-    else
-    {
-      EF_CODE_COVERAGE( );
-    }
-
     ef_u08_t * pu8DataBuffer = (ef_u08_t*) pvDataPtr;
 
     /* Number of bytes readable */
@@ -180,127 +169,80 @@ ef_return_et eEF_fread (
       EF_CODE_COVERAGE( );
     }
 
-    /* Assume everything will go well */
-//    *pu32BytesRead = u32BytesToRead;
-
-    ef_lba_t xSector = pxFile->xSector;
-
-    /* Unless something goes wrong it will be a success */
-//    eRetVal = EF_RET_OK;
+    ef_lba_t  xSector = pxFile->xSector;
+    /* Number of bytes transferred */
+    ef_u32_t  u32BytesTransfered;
 
     /* Repeat until u32BytesToRead gets down to zero (or we breaked out of the loop) */
     while ( 0 != u32BytesToRead )
     { /* Loop */
 
-      /* Number of bytes transferred */
-      ef_u32_t  u32BytesTransfered = 0;
-
-      /* Offset in the sector */
-      ef_u32_t  u32OffsetInSector = (ef_u32_t)( pxFile->u32FileOffset ) % EF_SECTOR_SIZE( pxFS );
-
-      /* If Not on the sector boundary */
-      if ( 0 != u32OffsetInSector )
-      { /* TRANSFER NOT ON THE SECTOR BOUNDARY BEGIN */
-
-        /* Number of bytes remaining in the sector */
-        ef_u32_t u32BytesRemaining =  EF_SECTOR_SIZE( pxFS ) - u32OffsetInSector;
-        if ( u32BytesRemaining > u32BytesToRead )
-        {
-          /* Clip it by u32BytesToRead if needed */
-          u32BytesRemaining = u32BytesToRead;
-        }
-        else
-        {
-          EF_CODE_COVERAGE( );
-        }
-        /* If extracting the remaining bytes from the sector failed */
-        if ( EF_RET_OK != eEFPortMemCopy( pxFile->u8Window + u32OffsetInSector, pu8DataBuffer, u32BytesRemaining ) )
-        {
-          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
-          break;
-        }
-        else
-        {
-          /* Number of bytes transferred */
-          u32BytesTransfered = u32BytesRemaining;
-        }
-      } /* TRANSFER NOT ON THE SECTOR BOUNDARY END */
-      /* Else we are on the sector boundary */
+      ef_u32_t      u32SectorsNb;
+      ef_return_et  eResult;
+
+      /* If the next step of the read failed */
+      if ( EF_RET_OK != eEFPrvFileReadStep( pxFile,
+                                            pxFS,
+                                            pu8DataBuffer,
+                                            u32BytesToRead,
+                                            &xSector,
+                                            &u32SectorsNb,
+                                            &u32BytesTransfered ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+        break;
+      }
+      /* Else, if the bytes have been taken from the window */
+      else if ( 0 != u32BytesTransfered )
+      {
+        EF_CODE_COVERAGE( );
+      }
+      /* Else, if there is a partial sector to read which start at sector boundary */
+      else if ( 0 == u32SectorsNb )
+      {
+        /* Get out of the loop, this happens out of the loop */
+        break;
+      }
+      /* Else, the sector run is resolved, if the volume cannot be released during the transfer */
+      else if ( EF_RET_OK != eEFPrvFSTransferUnlock( pxFS, bShared ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+        break;
+      }
       else
-      { /* TRANSFER ON THE SECTOR BOUNDARY BEGIN */
+      {
+        /* Reading whole sectors */
+        eResult = eEFPrvDriveRead( pxFS->u8PhysDrv, pu8DataBuffer, xSector, u32SectorsNb );
 
-        /* Sector offset in the cluster */
-        ef_u32_t  u32ClusterOffset = EF_CLUSTER_OFFSET_GET( pxFS );
-
-        /* If     On the cluster boundary
-         *    AND (    Updating the current cluster failed
-         *          OR Getting the base sector of the cluster failed )
-         */
-        if ( 0 != u32ClusterOffset )
-        {
-          EF_CODE_COVERAGE( );
-        }
-        else if ( EF_RET_OK != eEFPrvFileReadClusterNbUpdate( pxFile ) )
+        /* If the volume cannot be locked back */
+        if ( EF_RET_OK != eEFPrvFSTransferLock( pxFS, bShared ) )
         {
-          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_TIMEOUT );
           break;
         }
-        else if ( EF_RET_OK != eEFPrvFATClusterToSector( pxFS, pxFile->u32Clst, &xSector ) )
+        /* Else, if the volume has been unmounted meanwhile */
+        else if ( pxFile->xObject.u16MountId != pxFS->u16MountId )
         {
-          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
           break;
         }
-        else
+        /* Else, if reading the maximum contiguous sectors directly failed */
+        else if ( EF_RET_OK != eResult )
         {
-          EF_CODE_COVERAGE( );
+          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+          break;
         }
-
-        /* Get the number of remaining sectors */
-        ef_u32_t  u32SectorsNb = u32BytesToRead / EF_SECTOR_SIZE( pxFS );
-
-        /* If there is full sectors to read */
-        if ( 0 != u32SectorsNb )
-        { /* TRANSFER WHOLE SECTORS ONLY BEGIN */
-
-          /* Add the offset in the cluster to the Sector number to get the real value */
-          xSector += u32ClusterOffset;
-
-          /* If the sectors remaining to read in the cluster is larger than the cluster size */
-          if ( ( u32SectorsNb + u32ClusterOffset ) > pxFS->u8ClstSize )
-          {
-            /* Clip at cluster boundary, Limit the number of sectors to what remains in the cluster */
-            u32SectorsNb = pxFS->u8ClstSize - u32ClusterOffset;
-          }
-          else
-          {
-            EF_CODE_COVERAGE( );
-          }
-
-          /* Reading whole sectors */
-          /* If reading the maximum contiguous sectors directly failed */
-          if ( EF_RET_OK != eEFPrvDriveRead( pxFS->u8PhysDrv, pu8DataBuffer, xSector, u32SectorsNb ) )
-          {
-            eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
-            break;
-          }
-          else
-          {
-            /* Number of bytes transferred */
-            u32BytesTransfered = EF_SECTOR_SIZE( pxFS ) * u32SectorsNb;
-            /* Add the sector offset in the cluster to the sector number */
-            xSector += u32ClusterOffset;
-          }
-
-        } /* TRANSFER WHOLE SECTORS ONLY END */
-        /* Else, there is a partial sector to read which start at sector boundary */
         else
         {
-          /* Get out of the loop, this happens out of the loop */
-          break;
+          /* Number of bytes transferred */
+          u32BytesTransfered = EF_SECTOR_SIZE( pxFS ) * u32SectorsNb;
+          /* Next sector to access */
+          xSector += u32SectorsNb;
         }
+      }
 
-      } /* TRANSFER ON THE SECTOR BOUNDARY END */
-
+      /* Digest the bytes while they are still in the cache */
+      EF_FILE_DIGEST( pxFile, pu8DataBuffer, u32BytesTransfered );
       /* Update counters and pointers */
       u32BytesToRead        -= u32BytesTransfered; /* Bytes remaining to read */
       pu8DataBuffer         += u32BytesTransfered; /* Read data buffer pointer */
@@ -310,46 +252,21 @@ ef_return_et eEF_fread (
 
     } /* Loop */
 
-    /* If something failed */
-    if ( EF_RET_OK != eRetVal )
-    {
-      /* Invalidate the window */
-      xSector = 0;
-    }
-    /* Else, if Data sector window update failed */
-    else if ( EF_RET_OK != eEFPrvFileWindowUpdate ( pxFile, pxFS, xSector ) )
-    {
-      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
-    }
-    /* Else, if there are no more bytes to read */
-    else if ( 0 == u32BytesToRead )
-    {
-      /* We are done */
-      EF_CODE_COVERAGE( );
-    }
-    /* Else, if filling the remaining bytes into the window */
-    else if ( EF_RET_OK != eEFPortMemCopy( pxFile->u8Window, pu8DataBuffer, u32BytesToRead ) )
-    {
-      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
-    }
-    else
-    {
-      /* TRANSFERED PARTIAL SECTOR FROM BOUNDARY SUCCESS */
-      /* Update File offset */
-      pxFile->u32FileOffset += u32BytesToRead;
-      /* Update bytes effectively read */
-      *pu32BytesRead += u32BytesToRead; /* Bytes effectively read */
-      /* No more bytes to read */
-      u32BytesToRead = 0;
-    }
-
-    /* Now the sector in the window is where the FileOffset belong */
-    pxFile->xSector = xSector;
-
+    /* Read the remaining bytes of a partial sector through the window */
+    eRetVal = eEFPrvFileReadEnd( pxFile, pxFS, pu8DataBuffer, u32BytesToRead, xSector, eRetVal, &u32BytesTransfered );
+    /* Update bytes effectively read */
+    *pu32BytesRead += u32BytesTransfered;
   }
 
   /* Unlock filesystem if eRetVal allows */
-  (void) eEFPrvFSUnlock( pxFS, eRetVal );
+  if ( EF_BOOL_TRUE == bShared )
+  {
+    (void) eEFPrvFSUnlockShared( pxFS, eRetVal );
+  }
+  else
+  {
+    (void) eEFPrvFSUnlock( pxFS, eRetVal );
+  }
 
   return eRetVal;
 }
@@ -0,0 +1,314 @@
+/**
+ * ********************************************************************************************************************
+ *  @file     ef_fread_nb.c
+ *  @ingroup  group_eFAT_Public
+ *  @author   ChaN
+ *  @author   Emmanuel AMADIO
+ *  @version  V0.1
+ *  @brief    Read File without waiting for the data transfers
+ *
+ * ********************************************************************************************************************
+ *  eFAT - embedded FAT Filesystem module
+ * ********************************************************************************************************************
+ *
+ *  Copyright (C) 2021, Amadio Emmanuel, all right reserved.
+ *  Copyright (C) 2019, ChaN, all right reserved.
+ *
+ *  eFAT module is an open source software. Redistribution and use of eFAT in source and binary forms, with or without
+ *  modification, are permitted provided that the following condition is met:
+ *
+ *  Redistributions of source code must retain the above copyright notice, this condition and the following disclaimer.
+ *
+ *  This software is provided by the copyright holders and contributors "AS IS" and any warranties related to this
+ *  software are DISCLAIMED.
+ *  The copyright owners or contributors be NOT LIABLE for any damages caused by use of this software.
+ * ********************************************************************************************************************
+ */
+
+/* START OF FILE *************************************************************************************************** */
+/* ***************************************************************************************************************** */
+
+/* Includes -------------------------------------------------------------------------------------------------------- */
+
+#include <efat.h>
+#include <ef_prv_def.h>
+#include <ef_prv_file.h>
+#include "ef_prv_drive.h"
+#include "ef_prv_lock.h"
+#include "ef_prv_validate.h"
+
+#if ( 0 != EF_CONF_NON_BLOCKING )
+
+/* Local constant macros ------------------------------------------------------------------------------------------- */
+/* Local function macros ------------------------------------------------------------------------------------------- */
+/* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
+/* Local variables ------------------------------------------------------------------------------------------------- */
+/* Public variables ------------------------------------------------------------------------------------------------ */
+/* Local function prototypes---------------------------------------------------------------------------------------- */
+
+/**
+ *  @brief  Start or poll the whole sectors read run of the file (pxFile->xNbSector, pxFile->u32NbSectors)
+ *
+ *  @param  pxFile        Pointer to the file object
+ *  @param  pxFS          Pointer to the Filesystem object
+ *  @param  pu8DataBuffer Pointer to the buffer receiving the run
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       The run is read
+ *  @retval EF_RET_PENDING  The run is not read yet
+ *  @retval EF_RET_DISK_ERR The transfer failed
+ */
+static ef_return_et eEFPrvFileReadNbRun (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ef_u08_t    * pu8DataBuffer
+);
+
+/* Local functions ------------------------------------------------------------------------------------------------- */
+
+/* Start or poll the whole sectors read run of the file */
+static ef_return_et eEFPrvFileReadNbRun (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ef_u08_t    * pu8DataBuffer
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFile );
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+  EF_ASSERT_PRIVATE( 0 != pu8DataBuffer );
+
+  ef_return_et  eRetVal;
+  ef_return_et  eResult;
+
+  /* If the transfer of the run is started, poll it */
+  if ( EF_BOOL_FALSE != pxFile->bNbTransfer )
+  {
+    eResult = eEFPrvDriveTransferPoll( pxFS->u8PhysDrv );
+  }
+  /* Else, start it */
+  else
+  {
+    eResult = eEFPrvDriveReadStart( pxFS->u8PhysDrv, pu8DataBuffer, pxFile->xNbSector, pxFile->u32NbSectors );
+  }
+
+  /* If the drive is busy with the transfer of another file, start it on next call */
+  if ( EF_RET_LOCKED == eResult )
+  {
+    eRetVal = EF_RET_PENDING;
+  }
+  /* Else, if the transfer is running */
+  else if ( EF_RET_PENDING == eResult )
+  {
+    pxFile->bNbTransfer = EF_BOOL_TRUE;
+    eRetVal = EF_RET_PENDING;
+  }
+  /* Else, if the transfer failed */
+  else if ( EF_RET_OK != eResult )
+  {
+    pxFile->bNbTransfer  = EF_BOOL_FALSE;
+    pxFile->u32NbSectors = 0;
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+  }
+  else
+  {
+    pxFile->bNbTransfer = EF_BOOL_FALSE;
+    eRetVal = EF_RET_OK;
+  }
+
+  return eRetVal;
+}
+
+/* Public functions ------------------------------------------------------------------------------------------------ */
+
+ef_return_et eEF_fread_nb (
+  EF_FILE   * pxFile,
+  void      * pvDataPtr,
+  ef_u32_t    u32BytesToRead,
+  ef_u32_t  * pu32BytesRead
+)
+{
+  EF_ASSERT_PUBLIC( 0 != pxFile );
+  EF_ASSERT_PUBLIC( 0 != pvDataPtr );
+  EF_ASSERT_PUBLIC( 0 != pu32BytesRead );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_fs_st    * pxFS;
+
+  /* Clear read byte counter */
+  *pu32BytesRead = 0;
+  /* If File object is not valid (the exclusive grant also protects the started transfer state of the drive) */
+  if ( EF_RET_OK != eEFPrvValidateObject( &pxFile->xObject, &pxFS ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
+  }
+  /* Else, if another non-blocking operation is in progress on the file */
+  else if (    ( EF_FILE_NB_IDLE != pxFile->u8NbState )
+            && ( EF_FILE_NB_READ != pxFile->u8NbState ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+  }
+  /* Else, if Nothing to read */
+  else if ( 0 == u32BytesToRead )
+  {
+    /* Nothing to do, success */
+    EF_CODE_COVERAGE( );
+  }
+  else if ( 0 == ( pxFile->u32Size - pxFile->u32FileOffset ) )
+  {
+    /* Nothing to do, success */
+    *pu32BytesRead = ( EF_FILE_NB_READ == pxFile->u8NbState ) ? pxFile->u32NbDone : 0;
+    pxFile->u8NbState = EF_FILE_NB_IDLE;
+  }
+  else
+  {
+    /* If this is the first call of the operation */
+    if ( EF_FILE_NB_IDLE == pxFile->u8NbState )
+    {
+      pxFile->u8NbState     = EF_FILE_NB_READ;
+      pxFile->bNbTransfer   = EF_BOOL_FALSE;
+      pxFile->u32NbDone     = 0;
+      pxFile->u32NbSectors  = 0;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+
+    /* Resume after the bytes read by the previous calls */
+    ef_u08_t * pu8DataBuffer = (ef_u08_t*) pvDataPtr + pxFile->u32NbDone;
+    if ( u32BytesToRead > pxFile->u32NbDone )
+    {
+      u32BytesToRead -= pxFile->u32NbDone;
+    }
+    else
+    {
+      u32BytesToRead = 0;
+    }
+
+    /* Truncate u32BytesToRead by remaining bytes */
+    if ( u32BytesToRead > ( pxFile->u32Size - pxFile->u32FileOffset ) )
+    {
+      u32BytesToRead = pxFile->u32Size - pxFile->u32FileOffset;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+
+    ef_lba_t  xSector = pxFile->xSector;
+    /* Number of bytes transferred */
+    ef_u32_t  u32BytesTransfered;
+
+    /* If a whole sectors run is started by a previous call */
+    if ( 0 == pxFile->u32NbSectors )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    /* Else, if it is not read yet */
+    else if ( EF_RET_OK != ( eRetVal = eEFPrvFileReadNbRun( pxFile, pxFS, pu8DataBuffer ) ) )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    else
+    {
+      /* Number of bytes transferred by the run */
+      u32BytesTransfered = EF_SECTOR_SIZE( pxFS ) * pxFile->u32NbSectors;
+
+      /* Continue after the run */
+      EF_FILE_DIGEST( pxFile, pu8DataBuffer, u32BytesTransfered );
+      xSector               = pxFile->xNbSector + pxFile->u32NbSectors;
+      pxFile->u32NbSectors  = 0;
+      u32BytesToRead        -= u32BytesTransfered;
+      pu8DataBuffer         += u32BytesTransfered;
+      pxFile->u32FileOffset += u32BytesTransfered;
+      pxFile->u32NbDone     += u32BytesTransfered;
+    }
+
+    /* Repeat until u32BytesToRead gets down to zero (or we breaked out of the loop) */
+    while ( ( EF_RET_OK == eRetVal ) && ( 0 != u32BytesToRead ) )
+    { /* Loop */
+
+      ef_u32_t  u32SectorsNb;
+
+      /* If the next step of the read failed */
+      if ( EF_RET_OK != eEFPrvFileReadStep( pxFile,
+                                            pxFS,
+                                            pu8DataBuffer,
+                                            u32BytesToRead,
+                                            &xSector,
+                                            &u32SectorsNb,
+                                            &u32BytesTransfered ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+        break;
+      }
+      /* Else, if the bytes have been taken from the window */
+      else if ( 0 != u32BytesTransfered )
+      {
+        EF_CODE_COVERAGE( );
+      }
+      /* Else, if there is a partial sector to read which start at sector boundary */
+      else if ( 0 == u32SectorsNb )
+      {
+        /* Get out of the loop, this happens out of the loop */
+        break;
+      }
+      else
+      {
+        /* Record the run, it is resumed by the next call if the transfer does not end immediately */
+        pxFile->xNbSector     = xSector;
+        pxFile->u32NbSectors  = u32SectorsNb;
+
+        /* If the run is not read yet */
+        if ( EF_RET_OK != ( eRetVal = eEFPrvFileReadNbRun( pxFile, pxFS, pu8DataBuffer ) ) )
+        {
+          break;
+        }
+        else
+        {
+          /* Number of bytes transferred */
+          u32BytesTransfered = EF_SECTOR_SIZE( pxFS ) * u32SectorsNb;
+          /* Next sector to access */
+          xSector += u32SectorsNb;
+          pxFile->u32NbSectors = 0;
+        }
+      }
+
+      /* Digest the bytes while they are still in the cache */
+      EF_FILE_DIGEST( pxFile, pu8DataBuffer, u32BytesTransfered );
+      /* Update counters and pointers */
+      u32BytesToRead        -= u32BytesTransfered; /* Bytes remaining to read */
+      pu8DataBuffer         += u32BytesTransfered; /* Read data buffer pointer */
+      pxFile->u32FileOffset += u32BytesTransfered; /* File offset */
+      pxFile->u32NbDone     += u32BytesTransfered; /* Bytes read since the first call */
+
+    } /* Loop */
+
+    /* Read the remaining bytes of a partial sector through the window, unless a transfer is in progress */
+    eRetVal = eEFPrvFileReadEnd( pxFile, pxFS, pu8DataBuffer, u32BytesToRead, xSector, eRetVal, &u32BytesTransfered );
+    pxFile->u32NbDone += u32BytesTransfered;
+
+    /* Bytes effectively read since the first call */
+    *pu32BytesRead = pxFile->u32NbDone;
+
+    /* If the operation is over */
+    if ( EF_RET_PENDING != eRetVal )
+    {
+      pxFile->u8NbState = EF_FILE_NB_IDLE;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+
+  /* Unlock filesystem if eRetVal allows */
+  (void) eEFPrvFSUnlock( pxFS, eRetVal );
+
+  return eRetVal;
+}
+
+#endif /* EF_CONF_NON_BLOCKING */
+
+/* ***************************************************************************************************************** */
+/* END OF FILE ***************************************************************************************************** */
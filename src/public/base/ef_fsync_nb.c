@@ -0,0 +1,147 @@
+/**
+ * ********************************************************************************************************************
+ *  @file     ef_fsync_nb.c
+ *  @ingroup  group_eFAT_Public
+ *  @author   ChaN
+ *  @author   Emmanuel AMADIO
+ *  @version  V0.1
+ *  @brief    Synchronize the File without waiting for the data window write-back
+ *
+ * ********************************************************************************************************************
+ *  eFAT - embedded FAT Filesystem module
+ * ********************************************************************************************************************
+ *
+ *  Copyright (C) 2021, Amadio Emmanuel, all right reserved.
+ *  Copyright (C) 2019, ChaN, all right reserved.
+ *
+ *  eFAT module is an open source software. Redistribution and use of eFAT in source and binary forms, with or without
+ *  modification, are permitted provided that the following condition is met:
+ *
+ *  Redistributions of source code must retain the above copyright notice, this condition and the following disclaimer.
+ *
+ *  This software is provided by the copyright holders and contributors "AS IS" and any warranties related to this
+ *  software are DISCLAIMED.
+ *  The copyright owners or contributors be NOT LIABLE for any damages caused by use of this software.
+ * ********************************************************************************************************************
+ */
+
+/* START OF FILE *************************************************************************************************** */
+/* ***************************************************************************************************************** */
+
+/* Includes -------------------------------------------------------------------------------------------------------- */
+
+#include <efat.h>
+#include <ef_prv_def.h>
+#include <ef_prv_file.h>
+#include "ef_prv_drive.h"
+#include "ef_prv_lock.h"
+#include "ef_prv_validate.h"
+
+#if ( 0 != EF_CONF_NON_BLOCKING )
+
+/* Local constant macros ------------------------------------------------------------------------------------------- */
+/* Local function macros ------------------------------------------------------------------------------------------- */
+/* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
+/* Local variables ------------------------------------------------------------------------------------------------- */
+/* Public variables ------------------------------------------------------------------------------------------------ */
+/* Local function prototypes---------------------------------------------------------------------------------------- */
+/* Local functions ------------------------------------------------------------------------------------------------- */
+/* Public functions ------------------------------------------------------------------------------------------------ */
+
+ef_return_et eEF_fsync_nb (
+  EF_FILE  * pxFile
+)
+{
+  EF_ASSERT_PUBLIC( 0 != pxFile );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_return_et  eResult;
+  ef_fs_st    * pxFS;
+
+  /* If File object is not valid */
+  if ( EF_RET_OK != eEFPrvValidateObject( &pxFile->xObject, &pxFS ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
+  }
+  /* Else, if another non-blocking operation is in progress on the file */
+  else if (    ( EF_FILE_NB_IDLE != pxFile->u8NbState )
+            && ( EF_FILE_NB_SYNC != pxFile->u8NbState ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+  }
+  /* Else, if the cached data sector is clean */
+  else if ( 0 == ( EF_FILE_WIN_DIRTY & pxFile->u8StatusFlags ) )
+  {
+    pxFile->u8NbState = EF_FILE_NB_IDLE;
+  }
+  else
+  {
+    /* If this is the first call of the operation, write-back the cached data sector */
+    if ( EF_FILE_NB_IDLE == pxFile->u8NbState )
+    {
+      pxFile->u8NbState   = EF_FILE_NB_SYNC;
+      pxFile->bNbTransfer = EF_BOOL_FALSE;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+
+    /* If the write-back is started, poll it */
+    if ( EF_BOOL_FALSE != pxFile->bNbTransfer )
+    {
+      eResult = eEFPrvDriveTransferPoll( pxFS->u8PhysDrv );
+    }
+    /* Else, start it */
+    else
+    {
+      eResult = eEFPrvDriveWriteStart( pxFS->u8PhysDrv, pxFile->u8Window, pxFile->xSector, 1 );
+    }
+
+    /* If the drive is busy with the transfer of another file, start it on next call */
+    if ( EF_RET_LOCKED == eResult )
+    {
+      eRetVal = EF_RET_PENDING;
+    }
+    /* Else, if the write-back is running */
+    else if ( EF_RET_PENDING == eResult )
+    {
+      pxFile->bNbTransfer = EF_BOOL_TRUE;
+      eRetVal = EF_RET_PENDING;
+    }
+    /* Else, if the write-back failed */
+    else if ( EF_RET_OK != eResult )
+    {
+      pxFile->bNbTransfer = EF_BOOL_FALSE;
+      pxFile->u8NbState   = EF_FILE_NB_IDLE;
+      pxFile->u8ErrorCode = (ef_u08_t) EF_RET_DISK_ERR;
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+    }
+    else
+    {
+      pxFile->bNbTransfer   = EF_BOOL_FALSE;
+      pxFile->u8NbState     = EF_FILE_NB_IDLE;
+      pxFile->u8StatusFlags &= (ef_u08_t)~EF_FILE_WIN_DIRTY;
+    }
+  }
+
+  /* Unlock filesystem if eRetVal allows */
+  (void) eEFPrvFSUnlock( pxFS, eRetVal );
+
+  /* If the cached data sector is written back, update the directory entry with blocking requests */
+  if ( EF_RET_OK == eRetVal )
+  {
+    eRetVal = eEF_fsync( pxFile );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  return eRetVal;
+}
+
+#endif /* EF_CONF_NON_BLOCKING */
+
+/* ***************************************************************************************************************** */
+/* END OF FILE ***************************************************************************************************** */
@@ -54,25 +54,20 @@
 
 /* Local constant macros ------------------------------------------------------------------------------------------- */
 /* Local function macros ------------------------------------------------------------------------------------------- */
+
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+/**
+ *  The cluster following the current one of the file is the first one of its pool
+ */
+#define EF_FILE_POOL_NEXT_READY( pxFile )                                                                             \
+  (    ( 0 != (pxFile)->u32PoolNb )                                                                                   \
+    && ( ( 0 == (pxFile)->u32FileOffset ) ? ( 0 == (pxFile)->u32PoolPrev )                                            \
+                                          : ( (pxFile)->u32Clst == (pxFile)->u32PoolPrev ) ) )
+#endif
 /* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
 /* Local variables ------------------------------------------------------------------------------------------------- */
 /* Public variables ------------------------------------------------------------------------------------------------ */
 /* Local function prototypes---------------------------------------------------------------------------------------- */
-
-/**
- *  @brief  Update the file structure cluster number for next write access (on cluster crossing)
- *
- *  @param  pxFile  Pointer to the file object
- *
- *  @return Operation result
- *  @retval EF_RET_OK     Success
- *  @retval EF_RET_ERROR  An error occurred
- *  @retval EF_RET_ASSERT Assertion failed
- */
-ef_return_et eEFPrvFileWriteClusterNbUpdate (
-  ef_file_st  * pxFile
-);
-
 /* Local functions ------------------------------------------------------------------------------------------------- */
 
 //static ef_return_et eEFPrvFileWriteClusterNbUpdate (
@@ -85,6 +80,18 @@ ef_return_et eEFPrvFileWriteClusterNbUpdate (
   ef_return_et  eRetVal = EF_RET_OK;
 
   ef_u32_t u32ClusterNb;
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+  /* If the next cluster is the first one of the pool */
+  if ( EF_FILE_POOL_NEXT_READY( pxFile ) )
+  {
+    /* Take it without accessing the FAT, the pool is already linked to the chain */
+    u32ClusterNb        = pxFile->u32PoolNext;
+    pxFile->u32PoolPrev = u32ClusterNb;
+    pxFile->u32PoolNext++;
+    pxFile->u32PoolNb--;
+  }
+  else
+#endif
   /* On the top of the file? */
   if ( 0 == pxFile->u32FileOffset )
   {
@@ -192,125 +199,121 @@ ef_return_et eEF_fwrite (
 
     ef_lba_t xSector = pxFile->xSector;
 
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+    /* Drive commands counter at the beginning of the call */
+    ef_u32_t  u32CmdsStart = 0;
+    ef_u32_t  u32Cmds = 0;
+    /* The call stops before the end of the data (bounded latency write mode) */
+    ef_bool_t bShort = EF_BOOL_FALSE;
+
+    (void) eEFPrvDriveCommandsGet( pxFS->u8PhysDrv, &u32CmdsStart );
+#endif
+
     /* Unless something goes wrong it will be a success */
     eRetVal = EF_RET_OK;
 
+    /* Number of bytes transferred */
+    ef_u32_t  u32BytesTransfered;
+
     /* Repeat until u32BytesToWrite gets down to zero (or we breaked out of the loop) */
     while ( 0 != u32BytesToWrite )
     { /* Loop */
 
-      /* Number of bytes transferred */
-      ef_u32_t  u32BytesTransfered = 0;
-
-      /* Offset in the sector */
-      ef_u32_t  u32OffsetInSector = (ef_u32_t)( pxFile->u32FileOffset ) % EF_SECTOR_SIZE( pxFS );
+      ef_u32_t      u32SectorsNb;
+      ef_return_et  eResult;
 
-      /* If on the sector boundary */
-      if ( 0 != u32OffsetInSector )
-      { /* TRANSFER NOT ON THE SECTOR BOUNDARY BEGIN */
-
-        /* Number of bytes remaining in the sector */
-        ef_u32_t  u32BytesRemaining = EF_SECTOR_SIZE( pxFS ) - u32OffsetInSector;
-        if ( u32BytesRemaining >= u32BytesToWrite )
-        {
-          /* Clip it by u32BytesToWrite if needed */
-          u32BytesRemaining = u32BytesToWrite;
-        }
-        else
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+      /* If on the sector boundary in bounded latency write mode */
+      if (    ( 0 != pxFile->u32PoolSize )
+           && ( 0 == ( pxFile->u32FileOffset % EF_SECTOR_SIZE( pxFS ) ) ) )
+      {
+        (void) eEFPrvDriveCommandsGet( pxFS->u8PhysDrv, &u32Cmds );
+        /* If a whole sector run does not leave two commands for the window update at the end of the call,
+         * check it before moving to the next cluster */
+        if (    ( u32BytesToWrite >= EF_SECTOR_SIZE( pxFS ) )
+             && ( ( u32Cmds - u32CmdsStart + 1 + 2 ) > EF_CONF_BOUNDED_WRITE_CMDS ) )
         {
-          /* More bytes to write than what remains in the sector, we'll jump to next sector on next write */
-          xSector++;
-//          EF_CODE_COVERAGE( );
+          bShort = EF_BOOL_TRUE;
+          break;
         }
-        /* If filling the remaining bytes into the window failed */
-        if ( EF_RET_OK != eEFPortMemCopy(  pu8DataBuffer,
-                                          pxFile->u8Window + u32OffsetInSector,
-                                          u32BytesRemaining ) )
+        /* Else, if on the cluster boundary and the next cluster cannot be taken from the pool */
+        else if ( ( 0 == EF_CLUSTER_OFFSET_GET( pxFS ) ) && ( !EF_FILE_POOL_NEXT_READY( pxFile ) ) )
         {
-          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+          /* Stop here, eEF_fmaintain() refills the pool */
+          bShort = EF_BOOL_TRUE;
           break;
         }
         else
         {
           EF_CODE_COVERAGE( );
         }
-        /* Flag the window as dirty */
-        pxFile->u8StatusFlags |= EF_FILE_WIN_DIRTY;
-        /* Number of bytes transferred */
-        u32BytesTransfered = u32BytesRemaining;
-
-      } /* TRANSFER NOT ON THE SECTOR BOUNDARY END */
-      /* Else we are not on the sector boundary */
+      }
       else
-      { /* TRANSFER ON THE SECTOR BOUNDARY BEGIN */
-
-        /* Sector offset in the cluster */
-        ef_u32_t  u32ClusterOffset = EF_CLUSTER_OFFSET_GET( pxFS );
+      {
+        EF_CODE_COVERAGE( );
+      }
+#endif
+
+      /* If the next step of the write failed */
+      if ( EF_RET_OK != eEFPrvFileWriteStep( pxFile,
+                                             pxFS,
+                                             pu8DataBuffer,
+                                             u32BytesToWrite,
+                                             &xSector,
+                                             &u32SectorsNb,
+                                             &u32BytesTransfered ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+        break;
+      }
+      /* Else, if the bytes have been put in the window */
+      else if ( 0 != u32BytesTransfered )
+      {
+        EF_CODE_COVERAGE( );
+      }
+      /* Else, if there is a partial sector to write which start at sector boundary */
+      else if ( 0 == u32SectorsNb )
+      {
+        /* Get out of the loop, this happens out of the loop */
+        break;
+      }
+      /* Else, the sector run is allocated and resolved, if the volume cannot be released during the transfer */
+      else if ( EF_RET_OK != eEFPrvFSTransferUnlock( pxFS, EF_BOOL_FALSE ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+        break;
+      }
+      else
+      {
+        /* Writing whole sectors */
+        eResult = eEFPrvDriveWrite( pxFS->u8PhysDrv, pu8DataBuffer, xSector, u32SectorsNb );
 
-        /* If     On the cluster boundary
-         *    AND (    Updating the current cluster failed
-         *          OR Getting the base sector of the cluster failed )
-         */
-        if ( 0 != u32ClusterOffset )
-        {
-          EF_CODE_COVERAGE( );
-        }
-        else if ( EF_RET_OK != eEFPrvFileWriteClusterNbUpdate( pxFile ) )
+        /* If the volume cannot be locked back */
+        if ( EF_RET_OK != eEFPrvFSTransferLock( pxFS, EF_BOOL_FALSE ) )
         {
-          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_TIMEOUT );
           break;
         }
-        else if ( EF_RET_OK != eEFPrvFATClusterToSector( pxFS, pxFile->u32Clst, &xSector ) )
+        /* Else, if the volume has been unmounted meanwhile */
+        else if ( pxFile->xObject.u16MountId != pxFS->u16MountId )
         {
-          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
           break;
         }
-        else
+        /* Else, if writing the maximum contiguous sectors directly failed */
+        else if ( EF_RET_OK != eResult )
         {
-          EF_CODE_COVERAGE( );
+          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR);
+          break;
         }
-
-        /* Get the number of remaining sectors */
-        ef_u32_t  u32SectorsNb = u32BytesToWrite / EF_SECTOR_SIZE( pxFS );
-
-        /* If there is full sectors to write */
-        if ( 0 != u32SectorsNb )
-        { /* TRANSFER WHOLE SECTORS ONLY BEGIN */
-
-          /* If the sectors remaining to write in the cluster is larger than the cluster size */
-          if ( ( u32SectorsNb + u32ClusterOffset ) > pxFS->u8ClstSize )
-          {
-            /* Clip at cluster boundary, Limit the number of sectors to what remains in the cluster */
-            u32SectorsNb = pxFS->u8ClstSize - u32ClusterOffset;
-          }
-          else
-          {
-            EF_CODE_COVERAGE( );
-          }
-
-          /* Writing whole sectors */
-          /* If writing the maximum contiguous sectors directly failed */
-          if ( EF_RET_OK != eEFPrvDriveWrite( pxFS->u8PhysDrv, pu8DataBuffer, xSector, u32SectorsNb ) )
-          {
-            eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR);
-            break;
-          }
-          else
-          {
-            /* Number of bytes transferred */
-            u32BytesTransfered = EF_SECTOR_SIZE( pxFS ) * u32SectorsNb;
-            /* Add the sector offset in the cluster to the sector number */
-            xSector += u32SectorsNb;
-          }
-
-        } /* TRANSFER WHOLE SECTORS ONLY END */
-        /* Else, there is a partial sector to write which start at sector boundary */
         else
         {
-          /* Get out of the loop, this happens out of the loop */
-          break;
+          /* Number of bytes transferred */
+          u32BytesTransfered = EF_SECTOR_SIZE( pxFS ) * u32SectorsNb;
+          /* Add the sector offset in the cluster to the sector number */
+          xSector += u32SectorsNb;
         }
-      } /* TRANSFER ON THE SECTOR BOUNDARY END */
+      }
 
       /* Update counters and pointers */
       u32BytesToWrite       -= u32BytesTransfered; /* Bytes remaining to write */
@@ -320,65 +323,40 @@ ef_return_et eEF_fwrite (
       *pu32BytesWritten     += u32BytesTransfered; /* Bytes effectively written */
     } /* Loop */
 
-    /* If something failed */
-    if ( EF_RET_OK != eRetVal )
-    {
-      /* Invalidate the window */
-      xSector = 0;
-    }
-    /* Else, if Data sector window update failed */
-    else if ( EF_RET_OK != eEFPrvFileWindowUpdate ( pxFile, pxFS, xSector ) )
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+    /* If the call stopped before the end of the data */
+    if ( EF_BOOL_FALSE != bShort )
     {
-      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
-    }
-    /* Else, if there are no more bytes to write */
-    else if ( 0 == u32BytesToWrite )
-    {
-      /* We are done */
-      EF_CODE_COVERAGE( );
-    }
-    /* Else, if filling the remaining bytes into the window */
-    else if ( EF_RET_OK != eEFPortMemCopy( pu8DataBuffer, pxFile->u8Window, u32BytesToWrite ) )
-    {
-      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      /* The window is left as is, the next call continues from the sector boundary */
+      xSector         = pxFile->xSector;
+      u32BytesToWrite = 0;
     }
     else
     {
-      /* TRANSFERED PARTIAL SECTOR FROM BOUNDARY SUCCESS */
-      /* Flag the window as dirty */
-      pxFile->u8StatusFlags |= (ef_u08_t) EF_FILE_WIN_DIRTY;
-      /* Update File offset */
-      pxFile->u32FileOffset += u32BytesToWrite;
-      *pu32BytesWritten     += u32BytesToWrite; /* Bytes effectively written */
-      /* No more bytes to write */
-      u32BytesToWrite = 0;
+      EF_CODE_COVERAGE( );
     }
+#endif
 
-    /* Now the sector in the window is where the FileOffset belong */
-    pxFile->xSector = xSector;
+    /* Write the remaining bytes of a partial sector through the window, update the file size */
+    eRetVal = eEFPrvFileWriteEnd( pxFile, pxFS, pu8DataBuffer, u32BytesToWrite, xSector, eRetVal, &u32BytesTransfered );
+    /* Update bytes effectively written */
+    *pu32BytesWritten += u32BytesTransfered;
 
-    /* If something failed */
-    if ( EF_RET_OK != eRetVal )
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+    /* Bounded latency write mode statistics */
+    if ( 0 != pxFile->u32PoolSize )
     {
-      EF_CODE_COVERAGE( );
+      (void) eEFPrvDriveCommandsGet( pxFS->u8PhysDrv, &u32Cmds );
+      u32Cmds -= u32CmdsStart;
+      pxFile->u32BwWritesNb++;
+      pxFile->u32BwShortNb += ( EF_BOOL_FALSE != bShort ) ? 1 : 0;
+      pxFile->u32BwCmdsMax = ( u32Cmds > pxFile->u32BwCmdsMax ) ? u32Cmds : pxFile->u32BwCmdsMax;
     }
     else
     {
-      /* Set file change flags */
-      pxFile->u8StatusFlags |= EF_FILE_MODIFIED;
-      /* If file offset is bigger than file size */
-      if ( pxFile->u32FileOffset > pxFile->u32Size )
-      {
-        /* Update File size */
-        pxFile->u32Size = pxFile->u32FileOffset;
-      }
-      else
-      {
-        EF_CODE_COVERAGE( );
-      }
+      EF_CODE_COVERAGE( );
     }
-    /* Update bytes effectively written */
-//    *pu32BytesWritten -= u32BytesToWrite; /* Bytes effectively written */
+#endif
   }
 
   /* Unlock filesystem if eRetVal allows */
@@ -0,0 +1,305 @@
+/**
+ * ********************************************************************************************************************
+ *  @file     ef_fwrite_nb.c
+ *  @ingroup  group_eFAT_Public
+ *  @author   ChaN
+ *  @author   Emmanuel AMADIO
+ *  @version  V0.1
+ *  @brief    Write File without waiting for the data transfers
+ *
+ * ********************************************************************************************************************
+ *  eFAT - embedded FAT Filesystem module
+ * ********************************************************************************************************************
+ *
+ *  Copyright (C) 2021, Amadio Emmanuel, all right reserved.
+ *  Copyright (C) 2019, ChaN, all right reserved.
+ *
+ *  eFAT module is an open source software. Redistribution and use of eFAT in source and binary forms, with or without
+ *  modification, are permitted provided that the following condition is met:
+ *
+ *  Redistributions of source code must retain the above copyright notice, this condition and the following disclaimer.
+ *
+ *  This software is provided by the copyright holders and contributors "AS IS" and any warranties related to this
+ *  software are DISCLAIMED.
+ *  The copyright owners or contributors be NOT LIABLE for any damages caused by use of this software.
+ * ********************************************************************************************************************
+ */
+
+/* START OF FILE *************************************************************************************************** */
+/* ***************************************************************************************************************** */
+
+/* Includes -------------------------------------------------------------------------------------------------------- */
+
+#include <efat.h>
+#include <ef_prv_def.h>
+#include <ef_prv_file.h>
+#include "ef_prv_drive.h"
+#include "ef_prv_lock.h"
+#include "ef_prv_validate.h"
+
+#if ( 0 != EF_CONF_NON_BLOCKING )
+
+/* Local constant macros ------------------------------------------------------------------------------------------- */
+/* Local function macros ------------------------------------------------------------------------------------------- */
+/* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
+/* Local variables ------------------------------------------------------------------------------------------------- */
+/* Public variables ------------------------------------------------------------------------------------------------ */
+/* Local function prototypes---------------------------------------------------------------------------------------- */
+
+/**
+ *  @brief  Start or poll the whole sectors write run of the file (pxFile->xNbSector, pxFile->u32NbSectors)
+ *
+ *  @param  pxFile        Pointer to the file object
+ *  @param  pxFS          Pointer to the Filesystem object
+ *  @param  pu8DataBuffer Pointer to the data of the run
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       The run is written
+ *  @retval EF_RET_PENDING  The run is not written yet
+ *  @retval EF_RET_DISK_ERR The transfer failed
+ */
+static ef_return_et eEFPrvFileWriteNbRun (
+  ef_file_st      * pxFile,
+  ef_fs_st        * pxFS,
+  const ef_u08_t  * pu8DataBuffer
+);
+
+/* Local functions ------------------------------------------------------------------------------------------------- */
+
+/* Start or poll the whole sectors write run of the file */
+static ef_return_et eEFPrvFileWriteNbRun (
+  ef_file_st      * pxFile,
+  ef_fs_st        * pxFS,
+  const ef_u08_t  * pu8DataBuffer
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFile );
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+  EF_ASSERT_PRIVATE( 0 != pu8DataBuffer );
+
+  ef_return_et  eRetVal;
+  ef_return_et  eResult;
+
+  /* If the transfer of the run is started, poll it */
+  if ( EF_BOOL_FALSE != pxFile->bNbTransfer )
+  {
+    eResult = eEFPrvDriveTransferPoll( pxFS->u8PhysDrv );
+  }
+  /* Else, start it */
+  else
+  {
+    eResult = eEFPrvDriveWriteStart( pxFS->u8PhysDrv, pu8DataBuffer, pxFile->xNbSector, pxFile->u32NbSectors );
+  }
+
+  /* If the drive is busy with the transfer of another file, start it on next call */
+  if ( EF_RET_LOCKED == eResult )
+  {
+    eRetVal = EF_RET_PENDING;
+  }
+  /* Else, if the transfer is running */
+  else if ( EF_RET_PENDING == eResult )
+  {
+    pxFile->bNbTransfer = EF_BOOL_TRUE;
+    eRetVal = EF_RET_PENDING;
+  }
+  /* Else, if the transfer failed */
+  else if ( EF_RET_OK != eResult )
+  {
+    pxFile->bNbTransfer  = EF_BOOL_FALSE;
+    pxFile->u32NbSectors = 0;
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+  }
+  else
+  {
+    pxFile->bNbTransfer = EF_BOOL_FALSE;
+    eRetVal = EF_RET_OK;
+  }
+
+  return eRetVal;
+}
+
+/* Public functions ------------------------------------------------------------------------------------------------ */
+
+ef_return_et eEF_fwrite_nb (
+  EF_FILE     * pxFile,
+  const void  * pvDataPtr,
+  ef_u32_t      u32BytesToWrite,
+  ef_u32_t    * pu32BytesWritten
+)
+{
+  EF_ASSERT_PUBLIC( 0 != pxFile );
+  EF_ASSERT_PUBLIC( 0 != pvDataPtr );
+  EF_ASSERT_PUBLIC( 0 != pu32BytesWritten );
+
+  ef_return_et    eRetVal = EF_RET_OK;
+  ef_fs_st      * pxFS;
+
+  /* Clear written bytes counter */
+  *pu32BytesWritten = 0;
+
+  /* If access mode is not compatible */
+  if ( 0 == ( pxFile->u8StatusFlags & EF_FILE_OPEN_WRITE ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+  }
+  /* Else, if File object is not valid */
+  else if ( EF_RET_OK != eEFPrvValidateObject( &pxFile->xObject, &pxFS ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
+  }
+  /* Else, if another non-blocking operation is in progress on the file */
+  else if (    ( EF_FILE_NB_IDLE  != pxFile->u8NbState )
+            && ( EF_FILE_NB_WRITE != pxFile->u8NbState ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+  }
+  else
+  {
+    /* If this is the first call of the operation */
+    if ( EF_FILE_NB_IDLE == pxFile->u8NbState )
+    {
+      pxFile->u8NbState     = EF_FILE_NB_WRITE;
+      pxFile->bNbTransfer   = EF_BOOL_FALSE;
+      pxFile->u32NbDone     = 0;
+      pxFile->u32NbSectors  = 0;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+
+    /* Resume after the bytes written by the previous calls */
+    const ef_u08_t * pu8DataBuffer = (const ef_u08_t*) pvDataPtr + pxFile->u32NbDone;
+    if ( u32BytesToWrite > pxFile->u32NbDone )
+    {
+      u32BytesToWrite -= pxFile->u32NbDone;
+    }
+    else
+    {
+      u32BytesToWrite = 0;
+    }
+
+    /* Check u32FileOffset wrap-around (file size cannot reach 4 GiB at FAT volume) */
+    if ( pxFile->u32FileOffset > ( (ef_u32_t) EF_FILE_SIZE_MAX - ((ef_u32_t) u32BytesToWrite) ) )
+    {
+      u32BytesToWrite = (ef_u32_t)( EF_FILE_SIZE_MAX - pxFile->u32FileOffset );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+
+    ef_lba_t  xSector = pxFile->xSector;
+    /* Number of bytes transferred */
+    ef_u32_t  u32BytesTransfered;
+
+    /* If a whole sectors run is started by a previous call */
+    if ( 0 == pxFile->u32NbSectors )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    /* Else, if it is not written yet */
+    else if ( EF_RET_OK != ( eRetVal = eEFPrvFileWriteNbRun( pxFile, pxFS, pu8DataBuffer ) ) )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    else
+    {
+      /* Number of bytes transferred by the run */
+      u32BytesTransfered = EF_SECTOR_SIZE( pxFS ) * pxFile->u32NbSectors;
+
+      /* Continue after the run */
+      xSector               = pxFile->xNbSector + pxFile->u32NbSectors;
+      pxFile->u32NbSectors  = 0;
+      u32BytesToWrite       -= u32BytesTransfered;
+      pu8DataBuffer         += u32BytesTransfered;
+      pxFile->u32FileOffset += u32BytesTransfered;
+      pxFile->u32NbDone     += u32BytesTransfered;
+    }
+
+    /* Repeat until u32BytesToWrite gets down to zero (or we breaked out of the loop) */
+    while ( ( EF_RET_OK == eRetVal ) && ( 0 != u32BytesToWrite ) )
+    { /* Loop */
+
+      ef_u32_t  u32SectorsNb;
+
+      /* If the next step of the write failed */
+      if ( EF_RET_OK != eEFPrvFileWriteStep( pxFile,
+                                             pxFS,
+                                             pu8DataBuffer,
+                                             u32BytesToWrite,
+                                             &xSector,
+                                             &u32SectorsNb,
+                                             &u32BytesTransfered ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+        break;
+      }
+      /* Else, if the bytes have been put in the window */
+      else if ( 0 != u32BytesTransfered )
+      {
+        EF_CODE_COVERAGE( );
+      }
+      /* Else, if there is a partial sector to write which start at sector boundary */
+      else if ( 0 == u32SectorsNb )
+      {
+        /* Get out of the loop, this happens out of the loop */
+        break;
+      }
+      else
+      {
+        /* Record the run, it is resumed by the next call if the transfer does not end immediately */
+        pxFile->xNbSector     = xSector;
+        pxFile->u32NbSectors  = u32SectorsNb;
+
+        /* If the run is not written yet */
+        if ( EF_RET_OK != ( eRetVal = eEFPrvFileWriteNbRun( pxFile, pxFS, pu8DataBuffer ) ) )
+        {
+          break;
+        }
+        else
+        {
+          /* Number of bytes transferred */
+          u32BytesTransfered = EF_SECTOR_SIZE( pxFS ) * u32SectorsNb;
+          /* Add the sector offset in the cluster to the sector number */
+          xSector += u32SectorsNb;
+          pxFile->u32NbSectors = 0;
+        }
+      }
+
+      /* Update counters and pointers */
+      u32BytesToWrite       -= u32BytesTransfered; /* Bytes remaining to write */
+      pu8DataBuffer         += u32BytesTransfered; /* Write data buffer pointer */
+      pxFile->u32FileOffset += u32BytesTransfered; /* File offset */
+      pxFile->u32NbDone     += u32BytesTransfered; /* Bytes written since the first call */
+    } /* Loop */
+
+    /* Write the remaining bytes of a partial sector through the window unless a transfer is in progress, update the
+     * file size */
+    eRetVal = eEFPrvFileWriteEnd( pxFile, pxFS, pu8DataBuffer, u32BytesToWrite, xSector, eRetVal, &u32BytesTransfered );
+    pxFile->u32NbDone += u32BytesTransfered;
+
+    /* Bytes effectively written since the first call */
+    *pu32BytesWritten = pxFile->u32NbDone;
+
+    /* If the operation is over */
+    if ( EF_RET_PENDING != eRetVal )
+    {
+      pxFile->u8NbState = EF_FILE_NB_IDLE;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+
+  /* Unlock filesystem if eRetVal allows */
+  (void) eEFPrvFSUnlock( pxFS, eRetVal );
+
+  return eRetVal;
+}
+
+#endif /* EF_CONF_NON_BLOCKING */
+
+/* ***************************************************************************************************************** */
+/* END OF FILE ***************************************************************************************************** */
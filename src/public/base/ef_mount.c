@@ -48,6 +48,7 @@
 #include <ef_prv_volume_mount.h>
 #include "ef_prv_volume_nb.h"
 #include "ef_prv_volume.h"
+#include "ef_prv_volume_snapshot.h"
 
 /* Local constant macros ------------------------------------------------------------------------------------------- */
 /* Local function macros ------------------------------------------------------------------------------------------- */
@@ -120,6 +121,14 @@ ef_return_et eEF_mount (
   {
     eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
   }
+#if ( 0 != EF_CONF_FS_LOCK_SHARED )
+  /* Create sync object for the window of the new volume, used by shared lock holders */
+  else if ( EF_RET_OK != eEFPortSyncObjectCreate( (ef_u08_t) EF_PORT_SYNC_WINDOW_ID( s8VolumeNb ),
+                                                  &(xeFAT[ s8VolumeNb ].xWindowSyncObject) ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+#endif
   /* Lock the volume */
   else if ( EF_RET_OK != eEFPrvFSLock( &xeFAT[ s8VolumeNb ] ) )
   {
@@ -148,6 +157,13 @@ ef_return_et eEF_mount (
       {
         eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
       }
+#if ( 0 != EF_CONF_FS_LOCK_SHARED )
+      /* Discard sync object of the window of the current volume */
+      else if ( EF_RET_OK != eEFPortSyncObjectDelete( xeFAT[ s8VolumeNb ].xWindowSyncObject ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      }
+#endif
       else
       {
         eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_DRIVE );
@@ -204,21 +220,59 @@ ef_return_et eEF_umount (
   {
     eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_EXIST );
   }
-  /* Unlock filesystem */
-  else if ( EF_RET_OK !=  eEFPrvLockClear( &xeFAT[ s8VolumeNb ] ) )
+  /* Else, if locking the volume failed */
+  else if ( EF_RET_OK != eEFPrvFSLock( pxFS ) )
   {
-    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_TIMEOUT );
   }
-  /* Clear old pxFS object */
-  else if ( EF_RET_OK != eEFPrvVolumeFSPtrSet( s8VolumeNb, 0 ) )
+  else
   {
-    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_PARAMETER );
+    /* If the transfers running with the volume lock released did not end, they still use the sync object */
+    if ( EF_RET_OK != eEFPrvFSTransferWait( pxFS ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_TIMEOUT );
+    }
+#if ( 0 != EF_CONF_ALLOC_SNAPSHOT )
+    /* Else, if saving the allocation snapshot for the next mount failed */
+    else if ( EF_RET_OK != eEFPrvVolumeSnapshotSave( pxFS ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+    }
+#endif
+    /* Unlock filesystem */
+    else if ( EF_RET_OK !=  eEFPrvLockClear( &xeFAT[ s8VolumeNb ] ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+    }
+    /* Clear old pxFS object */
+    else if ( EF_RET_OK != eEFPrvVolumeFSPtrSet( s8VolumeNb, 0 ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_PARAMETER );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    (void) eEFPrvFSUnlock( pxFS, eRetVal );
+  }
+
+  /* If the volume is not released */
+  if ( EF_RET_OK != eRetVal )
+  {
+    EF_CODE_COVERAGE( );
   }
   /* Discard sync object of the current volume */
   else if ( EF_RET_OK != eEFPortSyncObjectDelete( pxFS->xSyncObject ) )
   {
     eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
   }
+#if ( 0 != EF_CONF_FS_LOCK_SHARED )
+  /* Discard sync object of the window of the current volume */
+  else if ( EF_RET_OK != eEFPortSyncObjectDelete( pxFS->xWindowSyncObject ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+#endif
   else
   {
     EF_CODE_COVERAGE( );
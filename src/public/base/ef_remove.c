@@ -36,6 +36,7 @@
 #include <ef_prv_def.h>
 #include <ef_prv_fat.h>
 #include <ef_prv_volume_mount.h>
+#include "ef_prv_cwd.h"
 #include "ef_prv_directory.h"
 #include "ef_prv_dirfunc.h"
 #include "ef_prv_fs_window.h"
@@ -190,6 +191,12 @@ ef_return_et eEF_remove (
       {
         eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
       }
+      /* Else, if a sub-directory was removed */
+      else if ( 0 != ( xDir.xObject.u8Attrib & EF_DIR_ATTRIB_BIT_DIRECTORY ) )
+      {
+        /* Current directory path cache is stale if the directory is on it */
+        (void) eEFPrvCwdCacheCheck( pxFS, u32DirCluster );
+      }
       else
       {
         EF_CODE_COVERAGE( );
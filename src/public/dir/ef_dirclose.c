@@ -76,7 +76,7 @@ ef_return_et eEF_dirclose (
     pxDir->xObject.pxFS = 0;
   }
   /* Decrement sub-directory open counter */
-  else if ( EF_RET_OK != eEFPrvLockDec( pxDir->xObject.u32LockId ) )
+  else if ( EF_RET_OK != eEFPrvLockDec( pxFS, pxDir->xObject.u32LockId ) )
   {
     eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
   }
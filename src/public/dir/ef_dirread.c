@@ -49,10 +49,16 @@ ef_return_et eEF_dirread (
 
 
   /* Check validity of the directory object */
-  if ( EF_RET_OK != eEFPrvValidateObject( &pxDir->xObject, &pxFS ) )
+  if ( EF_RET_OK != eEFPrvValidateObjectShared( &pxDir->xObject, &pxFS ) )
   {
     eRetVal = EF_RET_INVALID_OBJECT;
   }
+  /* Else, if the filesystem window cannot be used */
+  else if ( EF_RET_OK != eEFPrvFSWindowLock( pxFS ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_TIMEOUT );
+    (void) eEFPrvFSUnlockShared( pxFS, EF_RET_OK );
+  }
   else
   {
     if ( 0 == pxFileInfo )
@@ -105,8 +111,9 @@ ef_return_et eEF_dirread (
       }
       EF_LFN_BUFFER_FREE();
     }
+    (void) eEFPrvFSWindowUnlock( pxFS );
   }
-  (void) eEFPrvFSUnlock( pxFS, eRetVal );
+  (void) eEFPrvFSUnlockShared( pxFS, eRetVal );
   return eRetVal;
 }
 
@@ -35,9 +35,11 @@
 #include <efat_level3.h>
 #include <ef_prv_def.h>
 #include <ef_prv_fat.h>
+#include <ef_port_memory.h>
 #include "ef_prv_drive.h"
 #include "ef_prv_def.h"
 #include "ef_prv_directory.h"
+#include "ef_prv_file.h"
 #include "ef_prv_dirfunc.h"
 #include "ef_prv_lock.h"
 #include "ef_prv_string.h"
@@ -55,7 +57,281 @@
 /* Local variables ------------------------------------------------------------------------------------------------- */
 /* Public variables ------------------------------------------------------------------------------------------------ */
 /* Local function prototypes---------------------------------------------------------------------------------------- */
+
+/**
+ *  @brief  Forward the contiguous runs of a file from a sector boundary, through a caller buffer
+ *
+ *  @param  pxFile        Pointer to the file object, its offset is on a sector boundary
+ *  @param  pxFunc        Pointer to the streaming function
+ *  @param  pu8Buffer     Pointer to the buffer receiving the runs
+ *  @param  u32BufferSize Size of the buffer [byte], at least one sector
+ *  @param  u32BFw        Number of bytes to forward
+ *  @param  pu32BFw       Pointer to number of bytes forwarded, incremented
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK             Success, the stream may have gone busy
+ *  @retval EF_RET_INVALID_OBJECT The file object is invalid
+ *  @retval ...                   The error code the file has been aborted with
+ *  @retval EF_RET_DISK_ERR       A hard error occurred in the low level disk I/O layer
+ *  @retval EF_RET_INT_ERR        The chain is broken or the stream did not take any byte
+ */
+static ef_return_et eEFPrvFileForwardRuns (
+  EF_FILE   * pxFile,
+  StreamFn  * pxFunc,
+  ef_u08_t  * pu8Buffer,
+  ef_u32_t    u32BufferSize,
+  ef_u32_t    u32BFw,
+  ef_u32_t  * pu32BFw
+);
+
 /* Local functions ------------------------------------------------------------------------------------------------- */
+
+static ef_return_et eEFPrvFileForwardRuns (
+  EF_FILE   * pxFile,
+  StreamFn  * pxFunc,
+  ef_u08_t  * pu8Buffer,
+  ef_u32_t    u32BufferSize,
+  ef_u32_t    u32BFw,
+  ef_u32_t  * pu32BFw
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFile );
+  EF_ASSERT_PRIVATE( 0 != pxFunc );
+  EF_ASSERT_PRIVATE( 0 != pu8Buffer );
+  EF_ASSERT_PRIVATE( 0 != pu32BFw );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_fs_st    * pxFS;
+  ef_u32_t      u32SectorSize;
+  ef_u32_t      u32ClusterSize;
+  ef_u32_t      u32Cluster;
+  ef_u32_t      u32Last;
+  ef_u32_t      u32Next;
+  ef_u32_t      u32SectorOffset;
+  ef_u32_t      u32SectorsMax;
+  ef_u32_t      u32SectorsNb;
+  ef_u32_t      u32Chunk;
+  ef_u32_t      u32Position;
+  ef_u32_t      u32Count;
+  ef_lba_t      xSector;
+
+  /* If the file object is not valid */
+  if ( EF_RET_OK != eEFPrvValidateObject( &pxFile->xObject, &pxFS ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
+    return eRetVal;
+  }
+  /* If the file has been aborted */
+  if ( EF_RET_OK != (ef_return_et) pxFile->u8ErrorCode )
+  {
+    eRetVal = (ef_return_et) pxFile->u8ErrorCode;
+    (void) eEFPrvFSUnlock( pxFS, eRetVal );
+    return eRetVal;
+  }
+
+  u32SectorSize  = EF_SECTOR_SIZE( pxFS );
+  u32ClusterSize = (ef_u32_t) pxFS->u8ClstSize * u32SectorSize;
+  /* Truncate u32BFw by remaining bytes */
+  if ( u32BFw > ( pxFile->u32Size - pxFile->u32FileOffset ) )
+  {
+    u32BFw = pxFile->u32Size - pxFile->u32FileOffset;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  /* Repeat until all data transferred, the stream goes busy or something fails */
+  while ( ( EF_RET_OK == eRetVal ) && ( 0 != u32BFw ) && ( 0 != (*pxFunc)( 0, 0 ) ) )
+  {
+    /* Sector offset in the cluster */
+    u32SectorOffset = ( pxFile->u32FileOffset / u32SectorSize ) & ( pxFS->u8ClstSize - 1 );
+    u32Cluster = pxFile->u32Clst;
+
+    /* If on the top of the file */
+    if ( 0 == pxFile->u32FileOffset )
+    {
+      u32Cluster = pxFile->xObject.u32ClstStart;
+    }
+    /* Else, if on the cluster boundary and following the chain failed */
+    else if (    ( 0 == u32SectorOffset )
+              && ( EF_RET_OK != eEFPrvFATGet( pxFS, pxFile->u32Clst, &u32Cluster ) ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      break;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+
+    /* If the cluster is not a data cluster */
+    if ( EF_RET_OK != eEFPrvFATClusterNbCheck( pxFS->u32FatEntriesNb, u32Cluster ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      break;
+    }
+    /* Else, if getting the base sector of the cluster failed */
+    else if ( EF_RET_OK != eEFPrvFATClusterToSector( pxFS, u32Cluster, &xSector ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      break;
+    }
+    else
+    {
+      xSector += u32SectorOffset;
+    }
+
+    /* The run is bounded by the buffer and by the bytes left to forward */
+    u32SectorsMax = u32BufferSize / u32SectorSize;
+    if ( u32SectorsMax > ( ( u32BFw + u32SectorSize - 1 ) / u32SectorSize ) )
+    {
+      u32SectorsMax = ( u32BFw + u32SectorSize - 1 ) / u32SectorSize;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    /* Extend the run while the chain goes on with the next cluster */
+    u32SectorsNb = pxFS->u8ClstSize - u32SectorOffset;
+    u32Last = u32Cluster;
+    while ( u32SectorsNb < u32SectorsMax )
+    {
+      /* If following the chain failed */
+      if ( EF_RET_OK != eEFPrvFATGet( pxFS, u32Last, &u32Next ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+        break;
+      }
+      /* Else, if the chain is fragmented here */
+      else if ( ( u32Last + 1 ) != u32Next )
+      {
+        break;
+      }
+      else
+      {
+        u32Last = u32Next;
+        u32SectorsNb += pxFS->u8ClstSize;
+      }
+    }
+    if ( u32SectorsNb > u32SectorsMax )
+    {
+      u32SectorsNb = u32SectorsMax;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+
+    /* If following the chain failed */
+    if ( EF_RET_OK != eRetVal )
+    {
+      break;
+    }
+    /* Else, if the window holds a dirty sector of the run and writing it back failed */
+    else if (    ( xSector <= pxFile->xSector )
+              && ( ( xSector + u32SectorsNb ) > pxFile->xSector )
+              && ( EF_RET_OK != eEFPrvFileWindowDirtyWriteBack( pxFile, pxFS ) ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+      break;
+    }
+    /* Else, if reading the run failed */
+    else if ( EF_RET_OK != eEFPrvDriveRead( pxFS->u8PhysDrv, pu8Buffer, xSector, u32SectorsNb ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+      break;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+
+    /* Hand the run to the stream until it is consumed or the stream goes busy */
+    u32Chunk = ( u32BFw < ( u32SectorsNb * u32SectorSize ) ) ? u32BFw : ( u32SectorsNb * u32SectorSize );
+    u32Position = 0;
+    do
+    {
+      u32Count = (*pxFunc)( pu8Buffer + u32Position, u32Chunk - u32Position );
+      /* If the stream did not take any byte */
+      if ( 0 == u32Count )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      }
+      else
+      {
+        /* Digest the bytes taken by the stream */
+        EF_FILE_DIGEST( pxFile, pu8Buffer + u32Position, u32Count );
+        pxFile->u32FileOffset += u32Count;
+        u32Position += u32Count;
+      }
+    } while ( ( EF_RET_OK == eRetVal ) && ( u32Position < u32Chunk ) && ( 0 != (*pxFunc)( 0, 0 ) ) );
+
+    /* If some bytes have been forwarded */
+    if ( 0 != u32Position )
+    {
+      *pu32BFw              += u32Position;
+      u32BFw                -= u32Position;
+      /* The run is contiguous, the cluster holding the last byte forwarded is computed */
+      pxFile->u32Clst = u32Cluster + ( ( ( u32SectorOffset * u32SectorSize ) + u32Position - 1 ) / u32ClusterSize );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+
+    /* If the offset is on a sector boundary, the window is not needed */
+    if ( 0 == ( pxFile->u32FileOffset % u32SectorSize ) )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    /* Else, if the window already holds the sector of the offset */
+    else if ( pxFile->xSector == ( xSector + ( u32Position / u32SectorSize ) ) )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    /* Else, if writing back the window failed */
+    else if ( EF_RET_OK != eEFPrvFileWindowDirtyWriteBack( pxFile, pxFS ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+    }
+    /* Else, if loading the window from the run failed */
+    else if ( EF_RET_OK != eEFPortMemCopy( pu8Buffer + ( ( u32Position / u32SectorSize ) * u32SectorSize ),
+                                           pxFile->u8Window, u32SectorSize ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+    }
+    else
+    {
+      /* Now the sector in the window is where the FileOffset belong */
+      pxFile->xSector = xSector + ( u32Position / u32SectorSize );
+    }
+
+    /* If the stream went busy inside the run */
+    if ( u32Position < u32Chunk )
+    {
+      break;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+
+  /* If something failed, the file is aborted */
+  if ( EF_RET_OK != eRetVal )
+  {
+    pxFile->u8ErrorCode = (ef_u08_t) eRetVal;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+  (void) eEFPrvFSUnlock( pxFS, eRetVal );
+
+  return eRetVal;
+}
+
 /* Public functions ------------------------------------------------------------------------------------------------ */
 
 ef_return_et eEF_forward (
@@ -177,6 +453,8 @@ ef_return_et eEF_forward (
       (void) eEFPrvFSUnlock( pxFS, eRetVal );
       return eRetVal;
     }
+    /* Digest the bytes taken by the stream */
+    EF_FILE_DIGEST( pxFile, pu8dbuf + ( (ef_u32_t)pxFile->u32FileOffset % EF_SECTOR_SIZE( pxFS ) ), rcnt );
   }
 
   eRetVal = EF_RET_OK;
@@ -184,6 +462,82 @@ ef_return_et eEF_forward (
   return eRetVal;
 }
 
+ef_return_et eEF_forward_buffered (
+  EF_FILE   * pxFile,
+  StreamFn  * pxFunc,
+  ef_u08_t  * pu8Buffer,
+  ef_u32_t    u32BufferSize,
+  ef_u32_t    u32BFw,
+  ef_u32_t  * pu32BFw
+)
+{
+  EF_ASSERT_PUBLIC( 0 != pxFile );
+  EF_ASSERT_PUBLIC( 0 != pxFunc );
+  EF_ASSERT_PUBLIC( 0 != pu32BFw );
+
+  ef_return_et  eRetVal;
+  ef_fs_st    * pxFS;
+  ef_u32_t      u32Head = u32BFw;
+  ef_u32_t      u32Done = 0;
+
+  /* Clear transfer byte counter */
+  *pu32BFw = 0;
+  /* If the file object is not valid */
+  if ( EF_RET_OK != eEFPrvValidateObject( &pxFile->xObject, &pxFS ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
+    return eRetVal;
+  }
+  /* If the file has been aborted */
+  if ( EF_RET_OK != (ef_return_et) pxFile->u8ErrorCode )
+  {
+    eRetVal = (ef_return_et) pxFile->u8ErrorCode;
+    (void) eEFPrvFSUnlock( pxFS, eRetVal );
+    return eRetVal;
+  }
+
+  /* If the buffer holds a sector, only the bytes up to the next sector boundary go through the window */
+  if ( ( 0 != pu8Buffer ) && ( EF_SECTOR_SIZE( pxFS ) <= u32BufferSize ) )
+  {
+    u32Head = EF_SECTOR_SIZE( pxFS ) - ( pxFile->u32FileOffset % EF_SECTOR_SIZE( pxFS ) );
+    u32Head = ( EF_SECTOR_SIZE( pxFS ) == u32Head ) ? 0 : u32Head;
+    u32Head = ( u32BFw < u32Head ) ? u32BFw : u32Head;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+  (void) eEFPrvFSUnlock( pxFS, EF_RET_OK );
+
+  /* If there is no head to forward through the window */
+  if ( 0 == u32Head )
+  {
+    eRetVal = EF_RET_OK;
+  }
+  else
+  {
+    eRetVal = eEF_forward( pxFile, pxFunc, u32Head, &u32Done );
+    *pu32BFw = u32Done;
+  }
+
+  /* If     forwarding the head failed
+   *     OR the stream went busy or the file ended in the head
+   *     OR there is nothing left to forward
+   */
+  if (    ( EF_RET_OK != eRetVal )
+       || ( u32Done != u32Head )
+       || ( u32BFw == u32Head ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else
+  {
+    eRetVal = eEFPrvFileForwardRuns( pxFile, pxFunc, pu8Buffer, u32BufferSize, u32BFw - u32Head, pu32BFw );
+  }
+
+  return eRetVal;
+}
+
 /* ***************************************************************************************************************** */
 /* END OF FILE ***************************************************************************************************** */
 
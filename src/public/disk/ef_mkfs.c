@@ -31,25 +31,17 @@
 /* Includes -------------------------------------------------------------------------------------------------------- */
 
 #include <ef_port_load_store.h>
+#include <ef_port_memory.h>
 #include <efat.h>
 #include <efat_level3.h>
 #include <ef_prv_def.h>
 #include <ef_prv_def_bpb_fat.h>
-#include <ef_prv_def_gpt.h>
 #include <ef_prv_def_mbr.h>
-#include <ef_prv_fat.h>
-#include "ef_port_diskio.h"
 #include "ef_prv_drive.h"
-#include "ef_prv_directory.h"
-#include "ef_prv_dirfunc.h"
-#include "ef_prv_lock.h"
-#include "ef_prv_string.h"
 #include "ef_prv_volume.h"
-#include "ef_prv_volume_nb.h"
-#include "ef_prv_gpt.h"
-#include "ef_prv_lfn.h"
-#include "ef_prv_unicode.h"
-#include "ef_port_diskio.h"
+#include "ef_prv_volume_mount.h"
+
+#if ( 0 != EF_CONF_USE_MKFS )
 
 /* Local constant macros ------------------------------------------------------------------------------------------- */
 
@@ -58,574 +50,944 @@
 #define EF_CLUTER_NB_MAX_FAT16  ( 0xFFF5 )      /**< Max FAT16 clusters (differs from specs, but right for real DOS/Windows behavior) */
 #define EF_CLUTER_NB_MAX_FAT32  ( 0x0FFFFFF5 )  /**< Max FAT32 clusters (not specified, practical limit) */
 
+/* FAT sub-types of the created volume */
+#define EF_MKFS_FAT12           ( 1 )           /**< The volume is formatted as FAT12 */
+#define EF_MKFS_FAT16           ( 2 )           /**< The volume is formatted as FAT16 */
+#define EF_MKFS_FAT32           ( 3 )           /**< The volume is formatted as FAT32 */
+
 /* Local function macros ------------------------------------------------------------------------------------------- */
 /* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
+
+/**
+ *  @brief  Layout of the volume being created
+ */
+typedef struct {
+  ef_u08_t  u8Type;         /**< FAT sub-type (EF_MKFS_FAT12, EF_MKFS_FAT16 or EF_MKFS_FAT32) */
+  ef_u08_t  u8FatsNb;       /**< Number of FATs */
+  ef_u32_t  u32RootEntries; /**< Number of root directory entries (FAT12/16) */
+  ef_u32_t  u32ClstSize;    /**< Cluster size [sector] */
+  ef_u32_t  u32ClstNb;      /**< Number of clusters */
+  ef_u32_t  u32Reserved;    /**< Size of the reserved area [sector] */
+  ef_u32_t  u32FatSize;     /**< Size of a FAT [sector] */
+  ef_u32_t  u32RootSize;    /**< Size of the root directory area [sector], 0 on FAT32 */
+  ef_u32_t  u32Size;        /**< Size of the volume [sector] */
+  ef_lba_t  xVolume;        /**< First sector of the volume */
+  ef_lba_t  xFat;           /**< First sector of the FAT area */
+  ef_lba_t  xData;          /**< First sector of the data area */
+} ef_mkfs_layout_st;
+
 /* Local variables ------------------------------------------------------------------------------------------------- */
+
+/**
+ *  Cluster size boundaries of a FAT12/16 volume [4K sectors]
+ */
+static const ef_u16_t u16MkfsClusterSizes[ ] = { 1, 4, 16, 64, 256, 512, 0 };
+
+/**
+ *  Cluster size boundaries of a FAT32 volume [128K sectors]
+ */
+static const ef_u16_t u16MkfsClusterSizes32[ ] = { 1, 2, 4, 8, 16, 32, 0 };
+
+/**
+ *  Default format parameters
+ */
+static const ef_mkfs_param_st xMkfsParametersDefault = { FM_ANY, 0, 0, 0, 0 };
+
 /* Public variables ------------------------------------------------------------------------------------------------ */
 /* Local function prototypes---------------------------------------------------------------------------------------- */
-/* Local functions ------------------------------------------------------------------------------------------------- */
-/* Public functions ------------------------------------------------------------------------------------------------ */
 
 /**
- *  This option switches f_mkfs() function. (0:Disable or 1:Enable)
+ *  @brief  Check that no mounted volume lies on the physical drive
+ *
+ *  @param  u8PhysDrvNb Physical drive number
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK       Succeeded
+ *  @retval EF_RET_LOCKED   A volume of the drive is mounted
+ */
+static ef_return_et eEFPrvMkfsDriveCheck (
+  ef_u08_t  u8PhysDrvNb
+);
+
+/**
+ *  @brief  Find where the volume is to be located on the drive
+ *
+ *  The volume is the existing MBR partition, or the whole drive. In the latter case, a single partition starting
+ *  after the first track is created afterwards unless FM_SFD is given.
+ *
+ *  @param  u8PhysDrvNb   Physical drive number
+ *  @param  u8PartitionNb Partition number (0: whole drive, 1-4: MBR partition)
+ *  @param  u8Format      Format options
+ *  @param  pu8Buffer     Pointer to the working buffer, one sector at least
+ *  @param  pxLayout      Pointer to the layout, its volume location is set
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK             Succeeded
+ *  @retval EF_RET_DISK_ERR       A hard error occurred in the low level disk I/O layer
+ *  @retval EF_RET_MKFS_ABORTED   No such partition, or the volume size is out of range
+ */
+static ef_return_et eEFPrvMkfsVolumeLocate (
+  ef_u08_t            u8PhysDrvNb,
+  ef_u08_t            u8PartitionNb,
+  ef_u08_t            u8Format,
+  ef_u08_t          * pu8Buffer,
+  ef_mkfs_layout_st * pxLayout
+);
+
+/**
+ *  @brief  Compute the FAT sub-type and the areas of the volume
+ *
+ *  Only the FAT sub-types the module is configured for are selected. The data area starts on an erase block
+ *  boundary of the drive, the reserved area (FAT32) or the FATs (FAT12/16) take up the gap.
+ *
+ *  @param  pxParameters  Pointer to the format parameters
+ *  @param  u32SectorSize Sector size [byte]
+ *  @param  u32BlockSize  Erase block size [sector], a power of 2
+ *  @param  pxLayout      Pointer to the layout, the volume location being set
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK                 Succeeded
+ *  @retval EF_RET_MKFS_ABORTED       No valid cluster configuration fits the volume
+ *  @retval EF_RET_INVALID_PARAMETER  No FAT sub-type is allowed
  */
-#define EF_USE_MKFS ( 0 )
+static ef_return_et eEFPrvMkfsLayoutCompute (
+  const ef_mkfs_param_st  * pxParameters,
+  ef_u32_t                  u32SectorSize,
+  ef_u32_t                  u32BlockSize,
+  ef_mkfs_layout_st       * pxLayout
+);
 
-#if ( 0 != EF_USE_MKFS )
-/*-----------------------------------------------------------------------*/
-/* Create an FAT volume                                            */
-/*-----------------------------------------------------------------------*/
+/**
+ *  @brief  Prepare the data area of the volume
+ *
+ *  A quick format trims the data area when EF_CONF_USE_TRIM is enabled. Else, the drive clears it with the
+ *  CTRL_WRITE_ZEROES command, or it is written with the zeroed working buffer.
+ *
+ *  @param  u8PhysDrvNb       Physical drive number
+ *  @param  pxLayout          Pointer to the layout
+ *  @param  bQuick            Quick format
+ *  @param  pu8Buffer         Pointer to the working buffer
+ *  @param  u32BufferSectors  Size of the working buffer [sector]
+ *  @param  u32SectorSize     Sector size [byte]
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK         Succeeded
+ *  @retval EF_RET_DISK_ERR   A hard error occurred in the low level disk I/O layer
+ */
+static ef_return_et eEFPrvMkfsDataPrepare (
+  ef_u08_t                  u8PhysDrvNb,
+  const ef_mkfs_layout_st * pxLayout,
+  ef_bool_t                 bQuick,
+  ef_u08_t                * pu8Buffer,
+  ef_u32_t                  u32BufferSectors,
+  ef_u32_t                  u32SectorSize
+);
 
 /**
- *  Sectors per track for determination of drive CHS
+ *  @brief  Write the FATs and the root directory
+ *
+ *  The area from the first FAT up to the end of the root directory is contiguous, it is written with the whole
+ *  working buffer per command. A command stops at the start of the next FAT only, as the first sector of each FAT
+ *  holds the reserved entries.
+ *
+ *  @param  u8PhysDrvNb       Physical drive number
+ *  @param  pxLayout          Pointer to the layout
+ *  @param  pu8Buffer         Pointer to the working buffer
+ *  @param  u32BufferSectors  Size of the working buffer [sector]
+ *  @param  u32SectorSize     Sector size [byte]
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK         Succeeded
+ *  @retval EF_RET_DISK_ERR   A hard error occurred in the low level disk I/O layer
  */
-#define N_SEC_TRACK 63
+static ef_return_et eEFPrvMkfsTablesWrite (
+  ef_u08_t                  u8PhysDrvNb,
+  const ef_mkfs_layout_st * pxLayout,
+  ef_u08_t                * pu8Buffer,
+  ef_u32_t                  u32BufferSectors,
+  ef_u32_t                  u32SectorSize
+);
 
 /**
- *  Alignment of partitions in GPT [byte] (>=128KB)
+ *  @brief  Write the volume boot record, and the FSINFO sector and the backups on FAT32
+ *
+ *  The volume boot record is written last, an interrupted format does not leave a valid looking volume.
+ *
+ *  @param  u8PhysDrvNb   Physical drive number
+ *  @param  pxLayout      Pointer to the layout
+ *  @param  pu8Buffer     Pointer to the working buffer, one sector at least
+ *  @param  u32SectorSize Sector size [byte]
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK         Succeeded
+ *  @retval EF_RET_DISK_ERR   A hard error occurred in the low level disk I/O layer
  */
-#define GPT_ALIGN  0x100000
+static ef_return_et eEFPrvMkfsBootWrite (
+  ef_u08_t                  u8PhysDrvNb,
+  const ef_mkfs_layout_st * pxLayout,
+  ef_u08_t                * pu8Buffer,
+  ef_u32_t                  u32SectorSize
+);
 
 /**
- *  Number of GPT table size (>=128, sector aligned)
+ *  @brief  Update the partition table for the new volume
+ *
+ *  @param  u8PhysDrvNb   Physical drive number
+ *  @param  u8PartitionNb Partition number (0: whole drive, 1-4: MBR partition)
+ *  @param  u8Format      Format options
+ *  @param  pxLayout      Pointer to the layout
+ *  @param  pu8Buffer     Pointer to the working buffer, one sector at least
+ *
+ *  @return Function completion
+ *  @retval EF_RET_OK         Succeeded
+ *  @retval EF_RET_DISK_ERR   A hard error occurred in the low level disk I/O layer
  */
-#define GPT_ITEMS  128
+static ef_return_et eEFPrvMkfsPartitionUpdate (
+  ef_u08_t                  u8PhysDrvNb,
+  ef_u08_t                  u8PartitionNb,
+  ef_u08_t                  u8Format,
+  const ef_mkfs_layout_st * pxLayout,
+  ef_u08_t                * pu8Buffer
+);
 
+/* Local functions ------------------------------------------------------------------------------------------------- */
 
+static ef_return_et eEFPrvMkfsDriveCheck (
+  ef_u08_t  u8PhysDrvNb
+)
+{
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_fs_st    * pxFS;
+  int8_t        s8VolumeNb;
+
+  for ( s8VolumeNb = 0 ; s8VolumeNb < EF_CONF_VOLUMES_NB ; s8VolumeNb++ )
+  {
+    /* If the volume is mounted on the drive */
+    if (    ( EF_RET_OK == eEFPrvVolumeFSPtrGet( s8VolumeNb, &pxFS ) )
+         && ( 0 != pxFS )
+         && ( u8PhysDrvNb == pxFS->u8PhysDrv ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_LOCKED );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
 
+  return eRetVal;
+}
 
-ef_return_et eEF_mkfs (
-  const TCHAR*            pxPath,       /* Logical drive number */
-  const ef_mkfs_param_st* pxParameters, /* Format options */
-  void*                   work,         /* Pointer to working buffer (null: use heap memory) */
-  ef_u32_t                len           /* Size of working buffer [byte] */
+static ef_return_et eEFPrvMkfsVolumeLocate (
+  ef_u08_t            u8PhysDrvNb,
+  ef_u08_t            u8PartitionNb,
+  ef_u08_t            u8Format,
+  ef_u08_t          * pu8Buffer,
+  ef_mkfs_layout_st * pxLayout
 )
 {
-  static const ef_u16_t cst[] = {1, 4, 16, 64, 256, 512, 0};  /* Cluster size boundary for FAT volume (4Ks unit) */
-  static const ef_u16_t cst32[] = {1, 2, 4, 8, 16, 32, 0};    /* Cluster size boundary for FAT32 volume (128Ks unit) */
-  static const ef_mkfs_param_st xParametersDefault = {FM_ANY, 0, 0, 0, 0};  /* Default parameter */
-  ef_u08_t fsopt, fsty, sys, *buf, *pte, u8PhyDrvNb, ipart;
-  ef_u16_t ss;  /* Sector size */
-  ef_u32_t sz_buf, sz_blk, n_clst, pau, nsect, n;
-  ef_lba_t sz_vol, b_vol, b_fat, b_data;    /* Size of volume, Base LBA of volume, fat, data */
-  ef_lba_t xSector, lba[2];
-  ef_u32_t sz_rsv, sz_fat, sz_dir, sz_au;  /* Size of reserved, fat, pu8Dir, data, cluster */
-  ef_u32_t u8FatsNb, u32RootDirNb, i;          /* Index, Number of FATs and Number of root pu8Dir entries */
-  int vol;
-  ef_u08_t ds;
-  ef_return_et fr;
+  EF_ASSERT_PRIVATE( 0 != pu8Buffer );
+  EF_ASSERT_PRIVATE( 0 != pxLayout );
 
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u08_t    * pu8Entry;
+  ef_lba_t      xSize = 0;
 
-  /* Check mounted drive and clear work area */
-  vol = eEFPrvVolumeNbPathRemove( &pxPath );          /* Get target logical drive */
-  if (vol < 0)
+  pxLayout->xVolume = 0;
+  /* If the volume is the whole drive */
+  if ( 0 == u8PartitionNb )
+  {
+    if ( EF_RET_OK != eEFPrvDriveIOCtrl( u8PhysDrvNb, GET_SECTOR_COUNT, &xSize ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+    }
+#if ( 0 != EF_CONF_LBA64 )
+    /* Else, if the partition to be created would be in GPT */
+    else if (    ( 0 == ( u8Format & FM_SFD ) )
+              && ( EF_CONF_GPT_MIN <= xSize ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_MKFS_ABORTED );
+    }
+#endif
+    /* Else, if a partition is created, it starts after the first track as eEFPrvPartitionCreate() does */
+    else if ( ( 0 == ( u8Format & FM_SFD ) ) && ( N_SEC_TRACK < xSize ) )
+    {
+      pxLayout->xVolume = N_SEC_TRACK;
+      xSize -= N_SEC_TRACK;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+  /* Else, if the MBR cannot be read */
+  else if ( EF_RET_OK != eEFPrvDriveRead( u8PhysDrvNb, pu8Buffer, 0, 1 ) )
   {
-    return EF_RET_INVALID_DRIVE;
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
   }
-  if (eFAT[vol]) eFAT[vol]->u8FsType = 0;  /* Clear the fs object if mounted */
-  u8PhyDrvNb = LD2PD(vol);      /* Physical drive */
-  ipart = LD2PT(vol);      /* Partition (0:create as new, 1..:get from partition table) */
-  if (!pxParameters)
+  /* Else, if it is not a MBR, or a protective MBR of GPT */
+  else if (    ( 0xAA55 != u16EFPortLoad( pu8Buffer + EF_BS_OFFSET_SIGNATURE ) )
+            || ( 0xEE == pu8Buffer[ EF_MBR_OFFSET_PTE_ARRAY + EF_MBR_PTE_OFFSET_PARTITION_TYPE ] )
+            || ( 4 < u8PartitionNb ) )
   {
-    pxParameters = &xParametersDefault;  /* Use default parameter if it is not given */
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_MKFS_ABORTED );
+  }
+  else
+  {
+    pu8Entry = pu8Buffer + EF_MBR_OFFSET_PTE_ARRAY + ( ( u8PartitionNb - 1 ) * EF_MBR_PTE_SIZE );
+    /* If the partition does not exist */
+    if ( 0 == pu8Entry[ EF_MBR_PTE_OFFSET_PARTITION_TYPE ] )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_MKFS_ABORTED );
+    }
+    else
+    {
+      pxLayout->xVolume = u32EFPortLoad( pu8Entry + EF_MBR_PTE_OFFSET_LBA_START );
+      xSize = u32EFPortLoad( pu8Entry + EF_MBR_PTE_OFFSET_LBA_SIZE );
+    }
   }
 
-  /* Get physical drive status (sz_drv, sz_blk, ss) */
-  ds =  eEFPrvDriveInitialize(u8PhyDrvNb);
-  if ( 0 != ( ds & EF_RET_DISK_NOINIT ) )
+  /* If the volume is too small */
+  if ( ( EF_RET_OK == eRetVal ) && ( 128 > xSize ) )
   {
-    return EF_RET_NOT_READY;
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_MKFS_ABORTED );
   }
-  if ( 0 != ( ds & EF_RET_DISK_PROTECT ) )
+#if ( 0 != EF_CONF_LBA64 )
+  /* Else, if the volume is too large for FAT32 */
+  else if ( ( EF_RET_OK == eRetVal ) && ( 0xFFFFFFFF < xSize ) )
   {
-    return EF_RET_WRITE_PROTECTED;
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_MKFS_ABORTED );
   }
-  sz_blk = pxParameters->u32DataAlign;
-  if (sz_blk == 0 &&  eEFPrvDriveIOCtrl(u8PhyDrvNb, GET_BLOCK_SIZE, &sz_blk) != EF_RET_OK)
+#endif
+  else
   {
-    sz_blk = 1;
+    pxLayout->u32Size = (ef_u32_t) xSize;
   }
-  if (sz_blk == 0 || sz_blk > 0x8000 || (sz_blk & (sz_blk - 1)))
+
+  return eRetVal;
+}
+
+static ef_return_et eEFPrvMkfsLayoutCompute (
+  const ef_mkfs_param_st  * pxParameters,
+  ef_u32_t                  u32SectorSize,
+  ef_u32_t                  u32BlockSize,
+  ef_mkfs_layout_st       * pxLayout
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxParameters );
+  EF_ASSERT_PRIVATE( 0 != pxLayout );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u08_t      u8Format = pxParameters->u8Format;
+  ef_u32_t      u32Unit;
+  ef_u32_t      u32Nb;
+  ef_u32_t      i;
+  ef_bool_t     bRetry = EF_BOOL_TRUE;
+
+  /* Only the FAT sub-types the module can mount are candidates */
+  if ( 0 == EF_FS_FAT32 )
   {
-    sz_blk = 1;
+    u8Format &= (ef_u08_t) ~FM_FAT32;
   }
-#if EF_CONF_SS_MAX != EF_CONF_SS_MIN
-  if ( eEFPrvDriveIOCtrl(u8PhyDrvNb, GET_SECTOR_SIZE, &ss) != EF_RET_OK)
+  if ( 0 == ( EF_FS_FAT12 | EF_FS_FAT16 ) )
   {
-    return EF_RET_DISK_ERR;
+    u8Format &= (ef_u08_t) ~FM_FAT;
   }
-  if (ss > EF_CONF_SS_MAX || ss < EF_CONF_SS_MIN || (ss & (ss - 1)))
+  pxLayout->u8FatsNb = ( ( 1 <= pxParameters->u8FatsNb ) && ( 2 >= pxParameters->u8FatsNb ) )
+                     ? pxParameters->u8FatsNb : 1;
+  pxLayout->u32RootEntries = (    ( 1 <= pxParameters->u32RootDirNb )
+                               && ( 32768 >= pxParameters->u32RootDirNb )
+                               && ( 0 == ( pxParameters->u32RootDirNb % ( u32SectorSize / EF_DIR_ENTRY_SIZE ) ) ) )
+                           ? pxParameters->u32RootDirNb : 512;
+  /* Requested cluster size [sector], 0 for the automatic selection */
+  u32Unit = (    ( 0x1000000 >= pxParameters->u32ClusterSize )
+              && ( 0 == ( pxParameters->u32ClusterSize & ( pxParameters->u32ClusterSize - 1 ) ) ) )
+          ? ( pxParameters->u32ClusterSize / u32SectorSize ) : 0;
+  u32Unit = ( 128 < u32Unit ) ? 128 : u32Unit;
+
+  /* If no FAT sub-type is allowed */
+  if ( 0 == ( u8Format & ( FM_FAT | FM_FAT32 ) ) )
   {
-    return EF_RET_DISK_ERR;
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_PARAMETER );
+    bRetry = EF_BOOL_FALSE;
   }
-#else
-  ss = EF_CONF_SS_MAX;
-#endif
-  /* Options for FAT sub-type and FAT parameters */
-  fsopt       = pxParameters->u8Format & (FM_ANY | FM_SFD);
-  u8FatsNb    = (pxParameters->u8FatsNb >= 1 && pxParameters->u8FatsNb <= 2) ? pxParameters->u8FatsNb : 1;
-  u32RootDirNb = (pxParameters->u32RootDirNb >= 1 && pxParameters->u32RootDirNb <= 32768 && (pxParameters->u32RootDirNb % (ss / EF_DIR_ENTRY_SIZE)) == 0) ? pxParameters->u32RootDirNb : 512;
-  sz_au = (pxParameters->u32ClusterSize <= 0x1000000 && (pxParameters->u32ClusterSize & (pxParameters->u32ClusterSize - 1)) == 0) ? pxParameters->u32ClusterSize : 0;
-  sz_au /= ss;  /* Byte --> Sector */
-
-  /* Get working buffer */
-  sz_buf = len / ss;    /* Size of working buffer [sector] */
-  if (sz_buf == 0)
-  {
-    return EF_RET_NOT_ENOUGH_CORE;
-  }
-  buf = (ef_u08_t*)work;    /* Working buffer */
-#if EF_CONF_VFAT == 3
-  if (!buf) buf = ef_memalloc(sz_buf * ss);  /* Use heap memory for working buffer */
-#endif
-  if (!buf)
+  else
   {
-    return EF_RET_NOT_ENOUGH_CORE;
+    pxLayout->u8Type = ( 0 != ( u8Format & FM_FAT ) ) ? EF_MKFS_FAT16 : EF_MKFS_FAT32;
   }
 
-  /* Determine where the volume to be located (b_vol, sz_vol) */
-  b_vol = sz_vol = 0;
-  /* Is the volume associated with any specific partition? */
-  if ( ( 0 != ipart ) )
+  while ( EF_BOOL_FALSE != bRetry )
   {
-    /* Get partition location from the existing partition table */
-    if ( eEFPrvDriveRead(u8PhyDrvNb, buf, 0, 1) != EF_RET_OK)
-    {
-      LEAVE_MKFS(EF_RET_DISK_ERR);  /* Load MBR */
-    }
-    if (u16EFPortLoad(buf + EF_BS_OFFSET_SIGNATURE) != 0xAA55)
+    bRetry = EF_BOOL_FALSE;
+    pxLayout->u32ClstSize = u32Unit;
+    /* Pre-determine the number of clusters and the FAT sub-type */
+    if ( EF_MKFS_FAT32 == pxLayout->u8Type )
     {
-      LEAVE_MKFS(EF_RET_MKFS_ABORTED);  /* Check if MBR is valid */
-    }
-#if EF_CONF_LBA64
-    /* GPT protective MBR? */
-    if (buf[EF_MBR_OFFSET_PTE_ARRAY + EF_MBR_PTE_OFFSET_PARTITION_TYPE] == 0xEE)
-    {
-      ef_u32_t n_ent, ofs;
-      ef_u64_t pt_lba;
-
-      /* Get the partition location from GPT */
-      if ( eEFPrvDriveRead(u8PhyDrvNb, buf, 1, 1) != EF_RET_OK)
+      if ( 0 == pxLayout->u32ClstSize )
       {
-        LEAVE_MKFS(EF_RET_DISK_ERR);  /* Load GPT header sector (next to MBR) */
+        u32Nb = pxLayout->u32Size / 0x20000;
+        for ( i = 0, pxLayout->u32ClstSize = 1 ;
+              ( 0 != u16MkfsClusterSizes32[ i ] ) && ( u16MkfsClusterSizes32[ i ] <= u32Nb ) ;
+              i++, pxLayout->u32ClstSize <<= 1 ) ;
       }
-      if ( EF_RET_OK != eEFPrvGPTHeaderTest( buf ) )
+      pxLayout->u32ClstNb   = pxLayout->u32Size / pxLayout->u32ClstSize;
+      pxLayout->u32FatSize  = ( ( pxLayout->u32ClstNb * 4 ) + 8 + u32SectorSize - 1 ) / u32SectorSize;
+      pxLayout->u32Reserved = 32;
+      pxLayout->u32RootSize = 0;
+    }
+    else
+    {
+      if ( 0 == pxLayout->u32ClstSize )
       {
-        LEAVE_MKFS(EF_RET_MKFS_ABORTED);  /* Check if GPT header is valid */
-      }
-      n_ent = u32EFPortLoad(buf + EF_GPT_HEADER_OFFSET_PTE_NB);    /* Number of entries */
-      pt_lba = u64EFPortLoad(buf + EF_GPT_HEADER_OFFSET_PTE_LBA_START);  /* Table start sector */
-      ofs = i = 0;
-      while (n_ent) {    /* Find MS Basic partition with order of ipart */
-        if (ofs == 0 &&  eEFPrvDriveRead(u8PhyDrvNb, buf, pt_lba++, 1) != EF_RET_OK)
-        {
-          LEAVE_MKFS(EF_RET_DISK_ERR);  /* Get PT sector */
-        }
-        /* MS basic data partition? */
-        if (!effMemCompare(buf + ofs + EF_GPT_PTE_OFFSET_TYPE_GUID, u8GUIDBasicDataPartition, 16) && ++i == ipart)
-        {
-          b_vol = u64EFPortLoad(buf + ofs + EF_GPT_PTE_OFFSET_LBA_FIRST);
-          sz_vol = u64EFPortLoad(buf + ofs + EF_GPT_PTE_OFFSET_LBA_LAST) - b_vol + 1;
-          break;
-        }
-        n_ent--; ofs = (ofs + EF_GPT_PTE_SIZE) % ss;  /* Next entry */
+        u32Nb = pxLayout->u32Size / 0x1000;
+        for ( i = 0, pxLayout->u32ClstSize = 1 ;
+              ( 0 != u16MkfsClusterSizes[ i ] ) && ( u16MkfsClusterSizes[ i ] <= u32Nb ) ;
+              i++, pxLayout->u32ClstSize <<= 1 ) ;
       }
-      if (n_ent == 0)
+      pxLayout->u32ClstNb = pxLayout->u32Size / pxLayout->u32ClstSize;
+      if ( EF_CLUTER_NB_MAX_FAT12 < pxLayout->u32ClstNb )
       {
-        LEAVE_MKFS(EF_RET_MKFS_ABORTED);  /* Partition not found */
+        u32Nb = ( pxLayout->u32ClstNb * 2 ) + 4;
       }
-      fsopt |= 0x80;  /* Partitioning is in GPT */
-    } else
-#endif
-    {  /* Get the partition location from MBR partition table */
-      pte = buf + (EF_MBR_OFFSET_PTE_ARRAY + (ipart - 1) * EF_MBR_PTE_SIZE);
-      if (ipart > 4 || pte[EF_MBR_PTE_OFFSET_PARTITION_TYPE] == 0)
+      else
       {
-        LEAVE_MKFS(EF_RET_MKFS_ABORTED);  /* No partition? */
+        pxLayout->u8Type = EF_MKFS_FAT12;
+        u32Nb = ( ( ( pxLayout->u32ClstNb * 3 ) + 1 ) / 2 ) + 3;
       }
-      b_vol = u32EFPortLoad(pte + EF_MBR_PTE_OFFSET_LBA_START);    /* Get volume start sector */
-      sz_vol = u32EFPortLoad(pte + EF_MBR_PTE_OFFSET_LBA_SIZE);  /* Get volume size */
+      pxLayout->u32FatSize  = ( u32Nb + u32SectorSize - 1 ) / u32SectorSize;
+      pxLayout->u32Reserved = 1;
+      pxLayout->u32RootSize = ( pxLayout->u32RootEntries * EF_DIR_ENTRY_SIZE ) / u32SectorSize;
     }
-  }
-  else
-  {  /* The volume is associated with a physical drive */
-    if ( eEFPrvDriveIOCtrl(u8PhyDrvNb, GET_SECTOR_COUNT, &sz_vol) != EF_RET_OK)
+    pxLayout->xFat  = pxLayout->xVolume + pxLayout->u32Reserved;
+    pxLayout->xData = pxLayout->xFat + ( pxLayout->u32FatSize * pxLayout->u8FatsNb ) + pxLayout->u32RootSize;
+
+    /* Align the data area to the erase block boundary */
+    u32Nb = (ef_u32_t) ( ( ( pxLayout->xData + u32BlockSize - 1 ) & ~( (ef_lba_t) u32BlockSize - 1 ) )
+                         - pxLayout->xData );
+    /* If FAT32, the FATs are moved */
+    if ( EF_MKFS_FAT32 == pxLayout->u8Type )
     {
-      LEAVE_MKFS(EF_RET_DISK_ERR);
+      pxLayout->u32Reserved += u32Nb;
+      pxLayout->xFat        += u32Nb;
     }
-    /* To be partitioned? */
-    if (!(fsopt & FM_SFD))
+    /* Else, the FATs are expanded, a fractional sector goes to the reserved area */
+    else
     {
-      /* Create a single-partition on the drive in this function */
-      if (    ( 0 != EF_CONF_LBA64 )
-           && (sz_vol >= EF_CONF_GPT_MIN) )
+      if ( 0 != ( u32Nb % pxLayout->u8FatsNb ) )
       {
-        /* Which partition type to create, MBR or GPT? */
-        fsopt |= 0x80;    /* Partitioning is in GPT */
-        b_vol = GPT_ALIGN / ss; sz_vol -= b_vol + GPT_ITEMS * EF_GPT_PTE_SIZE / ss + 1;  /* Estimated partition offset and size */
-      }
-      else
-      {
-        /* Partitioning is in MBR */
-        if (sz_vol > N_SEC_TRACK)
-        {
-          b_vol = N_SEC_TRACK; sz_vol -= b_vol;  /* Estimated partition offset and size */
-        }
+        u32Nb--;
+        pxLayout->u32Reserved++;
+        pxLayout->xFat++;
       }
+      pxLayout->u32FatSize += u32Nb / pxLayout->u8FatsNb;
     }
-  }
-  if (sz_vol < 128) LEAVE_MKFS(EF_RET_MKFS_ABORTED);  /* Check if volume size is >=128s */
-
-  /* Now start to create a FAT volume at b_vol and sz_vol */
+    pxLayout->xData = pxLayout->xFat + ( pxLayout->u32FatSize * pxLayout->u8FatsNb ) + pxLayout->u32RootSize;
 
-  do {  /* Pre-determine the FAT type */
-    if (    ( 0 != EF_CONF_LBA64 )
-         && ( sz_vol >= 0x100000000 ) )
+    /* If the volume is too small */
+    if ( pxLayout->u32Size < ( ( pxLayout->xData - pxLayout->xVolume ) + ( pxLayout->u32ClstSize * 16 ) ) )
     {
-      LEAVE_MKFS(EF_RET_MKFS_ABORTED);  /* Too large volume for FAT/FAT32 */
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_MKFS_ABORTED );
     }
-    if (sz_au > 128)
-    {
-      sz_au = 128;  /* Invalid AU for FAT/FAT32? */
-    }
-    /* FAT32 possible? */
-    if ( 0 != ( fsopt & FM_FAT32 ) )
+    else
     {
-      /* no-FAT? */
-      if ( 0 == ( fsopt & FM_FAT ) )
+      pxLayout->u32ClstNb = (ef_u32_t) ( pxLayout->u32Size - ( pxLayout->xData - pxLayout->xVolume ) )
+                          / pxLayout->u32ClstSize;
+      /* If too few clusters for FAT32 */
+      if (    ( EF_MKFS_FAT32 == pxLayout->u8Type )
+           && ( EF_CLUTER_NB_MAX_FAT16 >= pxLayout->u32ClstNb ) )
       {
-        fsty = FS_FAT32; break;
-      }
-    }
-    if (!(fsopt & FM_FAT))
-      LEAVE_MKFS(EF_RET_INVALID_PARAMETER);  /* no-FAT? */
-    fsty = FS_FAT16;
-  } while (0);
-
-  {  /* Create an FAT/FAT32 volume */
-    do {
-      pau = sz_au;
-      /* Pre-determine number of clusters and FAT sub-type */
-      if ( FS_FAT32 == fsty )
-      {  /* FAT32 volume */
-        if ( 0 == pau )
-        {  /* AU auto-selection */
-          n = (ef_u32_t)sz_vol / 0x20000;  /* Volume size in unit of 128KS */
-          for ( i = 0, pau = 1; cst32[i] && cst32[i] <= n; i++, pau <<= 1 ) ;  /* Get from table */
+        /* Retry with smaller clusters if automatic */
+        if ( ( 0 == u32Unit ) && ( 1 < pxLayout->u32ClstSize ) )
+        {
+          u32Unit = pxLayout->u32ClstSize / 2;
+          bRetry = EF_BOOL_TRUE;
         }
-        n_clst = (ef_u32_t)sz_vol / pau;  /* Number of clusters */
-        sz_fat = (n_clst * 4 + 8 + ss - 1) / ss;  /* FAT size [sector] */
-        sz_rsv = 32;  /* Number of reserved sectors */
-        sz_dir = 0;    /* No static directory */
-        if (    ( n_clst <= EF_CLUTER_NB_MAX_FAT16 )
-             || ( n_clst > EF_CLUTER_NB_MAX_FAT32 ) )
+        else
         {
-          LEAVE_MKFS( EF_RET_MKFS_ABORTED );
+          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_MKFS_ABORTED );
         }
       }
-      else
-      {        /* FAT volume */
-        /* au auto-selection */
-        if ( 0 == pau )
+      /* Else, if too many clusters for FAT16 */
+      else if (    ( EF_MKFS_FAT16 == pxLayout->u8Type )
+                && ( EF_CLUTER_NB_MAX_FAT16 < pxLayout->u32ClstNb ) )
+      {
+        /* Retry with larger clusters if automatic, then with FAT32 if allowed */
+        if ( ( 0 == u32Unit ) && ( 64 >= ( pxLayout->u32ClstSize * 2 ) ) )
         {
-          n = (ef_u32_t)sz_vol / 0x1000;  /* Volume size in unit of 4KS */
-          for ( i = 0, pau = 1; cst[i] && cst[i] <= n; i++, pau <<= 1 ) ;  /* Get from table */
+          u32Unit = pxLayout->u32ClstSize * 2;
+          bRetry = EF_BOOL_TRUE;
         }
-        n_clst = (ef_u32_t)sz_vol / pau;
-        if ( n_clst > EF_CLUTER_NB_MAX_FAT12 )
+        else if ( 0 != ( u8Format & FM_FAT32 ) )
         {
-          n = n_clst * 2 + 4;    /* FAT size [byte] */
+          pxLayout->u8Type = EF_MKFS_FAT32;
+          bRetry = EF_BOOL_TRUE;
         }
-        else
+        else if ( ( 0 == u32Unit ) && ( 128 >= ( pxLayout->u32ClstSize * 2 ) ) )
         {
-          fsty = FS_FAT12;
-          n = (n_clst * 3 + 1) / 2 + 3;  /* FAT size [byte] */
+          u32Unit = pxLayout->u32ClstSize * 2;
+          bRetry = EF_BOOL_TRUE;
         }
-        sz_fat = (n + ss - 1) / ss;    /* FAT size [sector] */
-        sz_rsv = 1;            /* Number of reserved sectors */
-        sz_dir = (ef_u32_t)u32RootDirNb * EF_DIR_ENTRY_SIZE / ss;  /* Root pu8Dir size [sector] */
-      }
-      b_fat = b_vol + sz_rsv;            /* FAT base */
-      b_data = b_fat + sz_fat * u8FatsNb + sz_dir;  /* Data base */
-
-      /* Align data area to erase block boundary (for flash memory media) */
-      n = (ef_u32_t)(((b_data + sz_blk - 1) & ~(sz_blk - 1)) - b_data);  /* Sectors to next nearest from current data base */
-      if ( FS_FAT32 == fsty )
-      {    /* FAT32: Move FAT */
-        sz_rsv += n; b_fat += n;
-      }
-      else
-      {          /* FAT: Expand FAT */
-        if ( 0 != ( n % u8FatsNb ) )
+        else
         {
-          /* Adjust fractional error if needed */
-          n--;
-          sz_rsv++;
-          b_fat++;
+          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_MKFS_ABORTED );
         }
-        sz_fat += n / u8FatsNb;
       }
-
-      /* Determine number of clusters and final check of validity of the FAT sub-type */
-      if ( sz_vol < ( b_data + pau * 16 - b_vol ) )
+      /* Else, if too few clusters for FAT16 */
+      else if (    ( EF_MKFS_FAT16 == pxLayout->u8Type )
+                && ( EF_CLUTER_NB_MAX_FAT12 >= pxLayout->u32ClstNb ) )
       {
-        LEAVE_MKFS(EF_RET_MKFS_ABORTED);  /* Too small volume? */
-      }
-      n_clst = ((ef_u32_t)sz_vol - sz_rsv - sz_fat * u8FatsNb - sz_dir) / pau;
-      if ( FS_FAT32 == fsty )
-      {
-        if ( n_clst <= EF_CLUTER_NB_MAX_FAT16 )
+        if ( ( 0 == u32Unit ) && ( 128 >= ( pxLayout->u32ClstSize * 2 ) ) )
         {
-          /* Too few clusters for FAT32? */
-          if ( ( sz_au == 0 ) && ( 0 != (sz_au = pau / 2) ) )
-          {
-            continue;  /* Adjust cluster size and retry */
-          }
-          LEAVE_MKFS(EF_RET_MKFS_ABORTED);
+          u32Unit = pxLayout->u32ClstSize * 2;
+          bRetry = EF_BOOL_TRUE;
+        }
+        else
+        {
+          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_MKFS_ABORTED );
         }
       }
-      if ( FS_FAT16 == fsty )
+      /* Else, if too many clusters for FAT12, or too many for FAT32 */
+      else if (    (    ( EF_MKFS_FAT12 == pxLayout->u8Type )
+                     && ( EF_CLUTER_NB_MAX_FAT12 < pxLayout->u32ClstNb ) )
+                || ( EF_CLUTER_NB_MAX_FAT32 < pxLayout->u32ClstNb ) )
       {
-        if ( n_clst > EF_CLUTER_NB_MAX_FAT16 )
-        {  /* Too many clusters for FAT16 */
-          if (sz_au == 0 && (pau * 2) <= 64)
-          {
-            sz_au = pau * 2;
-            continue;    /* Adjust cluster size and retry */
-          }
-          if ( 0 != ( fsopt & FM_FAT32 ) )
-          {
-            fsty = FS_FAT32;
-            continue;  /* Switch type to FAT32 and retry */
-          }
-          if (    ( 0 == sz_au )
-               && ( (sz_au = pau * 2) <= 128 ) )
-          {
-            continue;  /* Adjust cluster size and retry */
-          }
-          LEAVE_MKFS(EF_RET_MKFS_ABORTED);
-        }
-        if  (n_clst <= EF_CLUTER_NB_MAX_FAT12)
-        {  /* Too few clusters for FAT16 */
-          if (    ( 0 == sz_au )
-               && ( (sz_au = pau * 2) <= 128 ) )
-          {
-            continue;  /* Adjust cluster size and retry */
-          }
-          LEAVE_MKFS(EF_RET_MKFS_ABORTED);
-        }
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_MKFS_ABORTED );
       }
-      if (    ( FS_FAT12 == fsty )
-           && ( n_clst > EF_CLUTER_NB_MAX_FAT12 ) )
+      /* Else, if the FAT sub-type cannot be mounted by this configuration */
+      else if (    ( ( EF_MKFS_FAT12 == pxLayout->u8Type ) && ( 0 == EF_FS_FAT12 ) )
+                || ( ( EF_MKFS_FAT16 == pxLayout->u8Type ) && ( 0 == EF_FS_FAT16 ) ) )
       {
-        LEAVE_MKFS(EF_RET_MKFS_ABORTED);  /* Too many clusters for FAT12 */
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_MKFS_ABORTED );
       }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+    }
+  }
 
-      /* Ok, it is the valid cluster configuration */
-      break;
-    } while ( 1 );
+  return eRetVal;
+}
 
-    if ( 0 != EF_CONF_USE_TRIM )
+static ef_return_et eEFPrvMkfsDataPrepare (
+  ef_u08_t                  u8PhysDrvNb,
+  const ef_mkfs_layout_st * pxLayout,
+  ef_bool_t                 bQuick,
+  ef_u08_t                * pu8Buffer,
+  ef_u32_t                  u32BufferSectors,
+  ef_u32_t                  u32SectorSize
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxLayout );
+  EF_ASSERT_PRIVATE( 0 != pu8Buffer );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_lba_t      xRange[ 2 ];
+  ef_lba_t      xSector = pxLayout->xData;
+  ef_u32_t      u32Count = (ef_u32_t) ( ( pxLayout->xVolume + pxLayout->u32Size ) - pxLayout->xData );
+  ef_u32_t      u32Nb;
+
+  xRange[ 0 ] = xSector;
+  xRange[ 1 ] = xSector + u32Count - 1;
+  /* If quick format, the former data are only discarded */
+  if ( EF_BOOL_FALSE != bQuick )
+  {
+#if ( 0 != EF_CONF_USE_TRIM )
+    /* Inform storage device that the data area may be erased */
+    (void) eEFPrvDriveIOCtrl( u8PhysDrvNb, CTRL_TRIM, xRange );
+#endif
+  }
+  /* Else, if the drive clears the sectors itself */
+  else if ( EF_RET_OK == eEFPrvDriveIOCtrl( u8PhysDrvNb, CTRL_WRITE_ZEROES, xRange ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else
+  {
+    (void) eEFPortMemZero( pu8Buffer, u32BufferSectors * u32SectorSize );
+    while ( ( EF_RET_OK == eRetVal ) && ( 0 != u32Count ) )
     {
-      /* Inform storage device that the volume area may be erased */
-      lba[0] = b_vol;
-      lba[1] = b_vol + sz_vol - 1;
-       eEFPrvDriveIOCtrl( u8PhyDrvNb, CTRL_TRIM, lba );
+      u32Nb = ( u32Count < u32BufferSectors ) ? u32Count : u32BufferSectors;
+      if ( EF_RET_OK != eEFPrvDriveWrite( u8PhysDrvNb, pu8Buffer, xSector, u32Nb ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+      }
+      else
+      {
+        xSector  += u32Nb;
+        u32Count -= u32Nb;
+      }
     }
-    /* Create FAT VBR */
-    mem_set( buf, 0, ss );
-    mem_cpy( buf + EF_BS_OFFSET_JMP_INST, "\xEB\xFE\x90" "MSDOS5.0", 11 );/* Boot jump code (x86), OEM name */
-    vEFPortStoreu16( buf + EF_BS_BPB_FAT_OFFSET_SECTOR_SIZE, ss );        /* Sector size [byte] */
-    buf[EF_BS_BPB_FAT_OFFSET_CLUSTER_SIZE] = (ef_u08_t)pau;        /* Cluster size [sector] */
-    vEFPortStoreu16( buf + EF_BS_BPB_FAT_OFFSET_SECTORS_RESERVED_NB, (ef_u16_t)sz_rsv );  /* Size of reserved area */
-    buf[EF_BS_BPB_FAT_OFFSET_FATS_NB] = (ef_u08_t)u8FatsNb;          /* Number of FATs */
-    if ( FS_FAT32 == fsty )
+  }
+
+  return eRetVal;
+}
+
+static ef_return_et eEFPrvMkfsTablesWrite (
+  ef_u08_t                  u8PhysDrvNb,
+  const ef_mkfs_layout_st * pxLayout,
+  ef_u08_t                * pu8Buffer,
+  ef_u32_t                  u32BufferSectors,
+  ef_u32_t                  u32SectorSize
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxLayout );
+  EF_ASSERT_PRIVATE( 0 != pu8Buffer );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u32_t      u32FatArea = pxLayout->u32FatSize * pxLayout->u8FatsNb;
+  ef_u32_t      u32Offset = 0;
+  ef_u32_t      u32Count;
+  ef_u32_t      u32Nb;
+
+  /* FATs, root directory area on FAT12/16, or root directory cluster on FAT32 */
+  u32Count = u32FatArea + pxLayout->u32RootSize;
+  u32Count += ( EF_MKFS_FAT32 == pxLayout->u8Type ) ? pxLayout->u32ClstSize : 0;
+  (void) eEFPortMemZero( pu8Buffer, u32BufferSectors * u32SectorSize );
+  while ( ( EF_RET_OK == eRetVal ) && ( u32Offset < u32Count ) )
+  {
+    u32Nb = u32Count - u32Offset;
+    u32Nb = ( u32Nb < u32BufferSectors ) ? u32Nb : u32BufferSectors;
+    /* If the command is within a FAT but the last one, it stops at the start of the next FAT */
+    if ( u32Offset < ( u32FatArea - pxLayout->u32FatSize ) )
     {
-      vEFPortStoreu16( buf + EF_BS_BPB_FAT_OFFSET_ROOT_ENTRIES, (ef_u16_t) 0 );  /* Number of root directory entries */
+      u32Nb = ( u32Nb < ( pxLayout->u32FatSize - ( u32Offset % pxLayout->u32FatSize ) ) )
+            ? u32Nb : ( pxLayout->u32FatSize - ( u32Offset % pxLayout->u32FatSize ) );
     }
     else
     {
-      vEFPortStoreu16( buf + EF_BS_BPB_FAT_OFFSET_ROOT_ENTRIES, (ef_u16_t) u32RootDirNb );  /* Number of root directory entries */
+      EF_CODE_COVERAGE( );
     }
-    if ( 0x10000 > sz_vol )
+    /* If the command starts a FAT, the media and the end of chain entries are set */
+    if ( ( u32Offset < u32FatArea ) && ( 0 == ( u32Offset % pxLayout->u32FatSize ) ) )
     {
-      vEFPortStoreu16( buf + EF_BS_BPB_FAT_OFFSET_SECTORS_COUNT, (ef_u16_t)sz_vol );  /* Volume size in 16-bit LBA */
+      if ( EF_MKFS_FAT32 == pxLayout->u8Type )
+      {
+        vEFPortStoreu32( pu8Buffer + 0, 0xFFFFFFF8 );
+        vEFPortStoreu32( pu8Buffer + 4, 0xFFFFFFFF );
+        /* Root directory cluster */
+        vEFPortStoreu32( pu8Buffer + 8, 0x0FFFFFFF );
+      }
+      else
+      {
+        vEFPortStoreu32( pu8Buffer + 0, ( EF_MKFS_FAT12 == pxLayout->u8Type ) ? 0x00FFFFF8 : 0xFFFFFFF8 );
+      }
     }
     else
     {
-      vEFPortStoreu32( buf + EF_BS_BPB_FAT_OFFSET_SECTORS_LARGE_COUNT, (ef_u32_t)sz_vol );  /* Volume size in 32-bit LBA */
+      EF_CODE_COVERAGE( );
     }
-    buf[EF_BS_BPB_FAT_OFFSET_MEDIA_DESCRIPTOR] = 0xF8;                          /* Media descriptor byte */
-    vEFPortStoreu16( buf + EF_BS_BPB_FAT_OFFSET_TRACK_SIZE, 63 );             /* Number of sectors per track (for int13) */
-    vEFPortStoreu16( buf + EF_BS_BPB_FAT_OFFSET_HEADS_NB, 255 );             /* Number of heads (for int13) */
-    vEFPortStoreu32( buf + EF_BS_BPB_FAT_OFFSET_SECTORS_HIDDEN_NB, (ef_u32_t)b_vol );  /* Volume offset in the physical drive [sector] */
-    if ( FS_FAT32 == fsty )
+    if ( EF_RET_OK != eEFPrvDriveWrite( u8PhysDrvNb, pu8Buffer, pxLayout->xFat + u32Offset, u32Nb ) )
     {
-      vEFPortStoreu32( buf + EF_BS_EBPB_FAT32_OFFSET_VOLUME_ID, EF_FATTIME_GET( ) ); /* VSN */
-      vEFPortStoreu32( buf + EF_BS_EBPB_FAT32_OFFSET_FAT_SIZE, sz_fat );       /* FAT size [sector] */
-      vEFPortStoreu32( buf + EF_BS_EBPB_FAT32_OFFSET_ROOT_DIRECTORY_NB, 2 );         /* Root directory cluster # (2) */
-      vEFPortStoreu16( buf + EF_BS_EBPB_FAT32_OFFSET_FS_INFO_SECTOR, 1 );           /* Offset of FSINFO sector (VBR + 1) */
-      vEFPortStoreu16( buf + EF_BS_EBPB_FAT32_OFFSET_BACKUPBOOT_SECTOR, 6 );        /* Offset of backup VBR (VBR + 6) */
-      buf[EF_BS_EBPB_FAT32_OFFSET_DRIVE_NB] = 0x80;                    /* Drive number (for int13) */
-      buf[EF_BS_EBPB_FAT32_OFFSET_SIGNATURE] = 0x29;                   /* Extended boot signature */
-      mem_cpy( buf + EF_BS_EBPB_FAT32_OFFSET_VOLUME_LABEL, "NO NAME    " "FAT32   ", 19 );  /* Volume pxLabel, FAT signature */
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
     }
     else
     {
-      vEFPortStoreu32( buf + EF_BS_EBPB_FAT16_OFFSET_VOLUME_ID, EF_FATTIME_GET( ) );  /* VSN */
-      vEFPortStoreu16( buf + EF_BS_BPB_FAT_OFFSET_FAT16_SIZE, (ef_u16_t)sz_fat );  /* FAT size [sector] */
-      buf[EF_BS_EBPB_FAT16_OFFSET_DRIVE_NB] = 0x80;            /* Drive number (for int13) */
-      buf[EF_BS_EBPB_FAT16_OFFSET_SIGNATURE] = 0x29;            /* Extended boot signature */
-      mem_cpy( buf + EF_BS_EBPB_FAT16_OFFSET_VOLUME_LABEL, "NO NAME    " "FAT     ", 19 );  /* Volume pxLabel, FAT signature */
-    }
-    vEFPortStoreu16( buf + EF_BS_OFFSET_SIGNATURE, 0xAA55 );          /* Signature (offset is fixed here regardless of sector size) */
-    if ( EF_RET_OK !=  eEFPrvDriveWrite( u8PhyDrvNb, buf, b_vol, 1 ) )
-    {
-      LEAVE_MKFS(EF_RET_DISK_ERR);  /* Write it to the VBR sector */
+      (void) eEFPortMemZero( pu8Buffer, 12 );
+      u32Offset += u32Nb;
     }
+  }
 
-    /* Create FSINFO record if needed */
-    if ( FS_FAT32 == fsty )
+  return eRetVal;
+}
+
+static ef_return_et eEFPrvMkfsBootWrite (
+  ef_u08_t                  u8PhysDrvNb,
+  const ef_mkfs_layout_st * pxLayout,
+  ef_u08_t                * pu8Buffer,
+  ef_u32_t                  u32SectorSize
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxLayout );
+  EF_ASSERT_PRIVATE( 0 != pu8Buffer );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+
+  /* If FAT32, create the FSINFO record and its backup */
+  if ( EF_MKFS_FAT32 == pxLayout->u8Type )
+  {
+    (void) eEFPortMemZero( pu8Buffer, u32SectorSize );
+    vEFPortStoreu32( pu8Buffer + EF_BS_FAT32_FSI_OFFSET_SIGNATURE_LEAD, 0x41615252 );
+    vEFPortStoreu32( pu8Buffer + EF_BS_FAT32_FSI_OFFSET_SIGNATURE_NEXT, 0x61417272 );
+    /* If the module keeps the FSINFO fields up to date, the root directory takes the first cluster */
+    if (    ( 0 != EF_CONF_USE_FAT32_FSINFO_CLUSTER_FREE )
+         || ( 0 != EF_CONF_USE_FAT32_FSINFO_CLUSTER_ALLOCATED ) )
     {
-       eEFPrvDriveWrite( u8PhyDrvNb, buf, b_vol + 6, 1 );    /* Write backup VBR (VBR + 6) */
-      mem_set( buf, 0, ss );
-      vEFPortStoreu32( buf + EF_BS_FAT32_FSI_OFFSET_SIGNATURE_LEAD, 0x41615252 );
-      vEFPortStoreu32( buf + EF_BS_FAT32_FSI_OFFSET_SIGNATURE_NEXT, 0x61417272 );
-      vEFPortStoreu32( buf + EF_BS_FAT32_FSI_OFFSET_FREE_CLUSTERS, n_clst - 1 );  /* Number of free clusters */
-      vEFPortStoreu32( buf + EF_BS_FAT32_FSI_OFFSET_CLUSTER_LAST_ALLOC, 2 );      /* Last allocated cluster# */
-      vEFPortStoreu16( buf + EF_BS_OFFSET_SIGNATURE, 0xAA55 );
-       eEFPrvDriveWrite( u8PhyDrvNb, buf, b_vol + 7, 1 );    /* Write backup FSINFO (VBR + 7) */
-       eEFPrvDriveWrite( u8PhyDrvNb, buf, b_vol + 1, 1 );    /* Write original FSINFO (VBR + 1) */
+      vEFPortStoreu32( pu8Buffer + EF_BS_FAT32_FSI_OFFSET_FREE_CLUSTERS, pxLayout->u32ClstNb - 1 );
+      vEFPortStoreu32( pu8Buffer + EF_BS_FAT32_FSI_OFFSET_CLUSTER_LAST_ALLOC, 2 );
     }
-
-    /* Initialize FAT area */
-    mem_set( buf, 0, sz_buf * ss );
-    xSector = b_fat;    /* FAT start sector */
-    for (i = 0; i < u8FatsNb; i++)      /* Initialize FATs each */
+    /* Else, the fields are left unknown: the next writes would make them stale */
+    else
     {
-      if ( FS_FAT32 == fsty )
-      {
-        vEFPortStoreu32( buf + 0, 0xFFFFFFF8 );  /* FAT[0] */
-        vEFPortStoreu32( buf + 4, 0xFFFFFFFF );  /* FAT[1] */
-        vEFPortStoreu32( buf + 8, 0x0FFFFFFF );  /* FAT[2] (root directory) */
-      }
-      else
-      {
-        vEFPortStoreu32( buf + 0, (fsty == FS_FAT12) ? 0xFFFFF8 : 0xFFFFFFF8 );  /* FAT[0] and FAT[1] */
-      }
-      nsect = sz_fat;    /* Number of FAT sectors */
-      do {  /* Fill FAT sectors */
-        if ( nsect > sz_buf )
-        {
-          n = sz_buf;
-        }
-        else
-        {
-          n = nsect;
-        }
-        if ( EF_RET_OK !=  eEFPrvDriveWrite( u8PhyDrvNb, buf, xSector, (ef_u32_t)n ) )
-        {
-          LEAVE_MKFS( EF_RET_DISK_ERR );
-        }
-        mem_set( buf, 0, ss );  /* Rest of FAT all are cleared */
-        xSector += n; nsect -= n;
-      } while ( 0 != nsect );
+      vEFPortStoreu32( pu8Buffer + EF_BS_FAT32_FSI_OFFSET_FREE_CLUSTERS, 0xFFFFFFFF );
+      vEFPortStoreu32( pu8Buffer + EF_BS_FAT32_FSI_OFFSET_CLUSTER_LAST_ALLOC, 0xFFFFFFFF );
     }
-
-    /* Initialize root directory (fill with zero) */
-    if ( FS_FAT32 == fsty )
+    vEFPortStoreu16( pu8Buffer + EF_BS_OFFSET_SIGNATURE, 0xAA55 );
+    if (    ( EF_RET_OK != eEFPrvDriveWrite( u8PhysDrvNb, pu8Buffer, pxLayout->xVolume + 7, 1 ) )
+         || ( EF_RET_OK != eEFPrvDriveWrite( u8PhysDrvNb, pu8Buffer, pxLayout->xVolume + 1, 1 ) ) )
     {
-      nsect = pau;  /* Number of root directory sectors */
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
     }
     else
     {
-      nsect = sz_dir;  /* Number of root directory sectors */
+      EF_CODE_COVERAGE( );
     }
-    do {
-      if ( nsect > sz_buf )
-      {
-        n = sz_buf;
-      }
-      else
-      {
-        n = nsect;
-      }
-      if ( EF_RET_OK !=  eEFPrvDriveWrite( u8PhyDrvNb, buf, xSector, (ef_u32_t) n ) )
-      {
-        LEAVE_MKFS(EF_RET_DISK_ERR);
-      }
-      xSector += n; nsect -= n;
-    } while ( 0 != nsect );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
   }
 
-  /* A FAT volume has been created here */
+  /* Create the volume boot record */
+  (void) eEFPortMemZero( pu8Buffer, u32SectorSize );
+  /* Boot jump code (x86) and OEM name */
+  (void) eEFPortMemCopy( "\xEB\xFE\x90" "MSDOS5.0", pu8Buffer + EF_BS_OFFSET_JMP_INST, 11 );
+  vEFPortStoreu16( pu8Buffer + EF_BS_BPB_FAT_OFFSET_SECTOR_SIZE, (ef_u16_t) u32SectorSize );
+  pu8Buffer[ EF_BS_BPB_FAT_OFFSET_CLUSTER_SIZE ] = (ef_u08_t) pxLayout->u32ClstSize;
+  vEFPortStoreu16( pu8Buffer + EF_BS_BPB_FAT_OFFSET_SECTORS_RESERVED_NB, (ef_u16_t) pxLayout->u32Reserved );
+  pu8Buffer[ EF_BS_BPB_FAT_OFFSET_FATS_NB ] = pxLayout->u8FatsNb;
+  vEFPortStoreu16( pu8Buffer + EF_BS_BPB_FAT_OFFSET_ROOT_ENTRIES,
+                   ( EF_MKFS_FAT32 == pxLayout->u8Type ) ? 0 : (ef_u16_t) pxLayout->u32RootEntries );
+  if ( 0x10000 > pxLayout->u32Size )
+  {
+    vEFPortStoreu16( pu8Buffer + EF_BS_BPB_FAT_OFFSET_SECTORS_COUNT, (ef_u16_t) pxLayout->u32Size );
+  }
+  else
+  {
+    vEFPortStoreu32( pu8Buffer + EF_BS_BPB_FAT_OFFSET_SECTORS_LARGE_COUNT, pxLayout->u32Size );
+  }
+  pu8Buffer[ EF_BS_BPB_FAT_OFFSET_MEDIA_DESCRIPTOR ] = 0xF8;
+  /* Number of sectors per track and of heads (for int13) */
+  vEFPortStoreu16( pu8Buffer + EF_BS_BPB_FAT_OFFSET_TRACK_SIZE, 63 );
+  vEFPortStoreu16( pu8Buffer + EF_BS_BPB_FAT_OFFSET_HEADS_NB, 255 );
+  /* Volume offset in the physical drive [sector] */
+  vEFPortStoreu32( pu8Buffer + EF_BS_BPB_FAT_OFFSET_SECTORS_HIDDEN_NB, (ef_u32_t) pxLayout->xVolume );
+  if ( EF_MKFS_FAT32 == pxLayout->u8Type )
+  {
+    vEFPortStoreu32( pu8Buffer + EF_BS_EBPB_FAT32_OFFSET_VOLUME_ID, EF_FATTIME_GET( ) );
+    vEFPortStoreu32( pu8Buffer + EF_BS_EBPB_FAT32_OFFSET_FAT_SIZE, pxLayout->u32FatSize );
+    vEFPortStoreu32( pu8Buffer + EF_BS_EBPB_FAT32_OFFSET_ROOT_DIRECTORY_NB, 2 );
+    /* FSINFO sector at VBR + 1, backup VBR at VBR + 6 */
+    vEFPortStoreu16( pu8Buffer + EF_BS_EBPB_FAT32_OFFSET_FS_INFO_SECTOR, 1 );
+    vEFPortStoreu16( pu8Buffer + EF_BS_EBPB_FAT32_OFFSET_BACKUPBOOT_SECTOR, 6 );
+    pu8Buffer[ EF_BS_EBPB_FAT32_OFFSET_DRIVE_NB ] = 0x80;
+    pu8Buffer[ EF_BS_EBPB_FAT32_OFFSET_SIGNATURE ] = 0x29;
+    (void) eEFPortMemCopy( "NO NAME    " "FAT32   ", pu8Buffer + EF_BS_EBPB_FAT32_OFFSET_VOLUME_LABEL, 19 );
+  }
+  else
+  {
+    vEFPortStoreu32( pu8Buffer + EF_BS_EBPB_FAT16_OFFSET_VOLUME_ID, EF_FATTIME_GET( ) );
+    vEFPortStoreu16( pu8Buffer + EF_BS_BPB_FAT_OFFSET_FAT16_SIZE, (ef_u16_t) pxLayout->u32FatSize );
+    pu8Buffer[ EF_BS_EBPB_FAT16_OFFSET_DRIVE_NB ] = 0x80;
+    pu8Buffer[ EF_BS_EBPB_FAT16_OFFSET_SIGNATURE ] = 0x29;
+    (void) eEFPortMemCopy( "NO NAME    " "FAT     ", pu8Buffer + EF_BS_EBPB_FAT16_OFFSET_VOLUME_LABEL, 19 );
+  }
+  /* Signature, its offset is fixed regardless of the sector size */
+  vEFPortStoreu16( pu8Buffer + EF_BS_OFFSET_SIGNATURE, 0xAA55 );
 
-  /* Determine system ID in the MBR partition table */
-  if ( FS_FAT32 == fsty )
+  /* If writing the FSINFO records failed */
+  if ( EF_RET_OK != eRetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if writing the backup VBR failed */
+  else if (    ( EF_MKFS_FAT32 == pxLayout->u8Type )
+            && ( EF_RET_OK != eEFPrvDriveWrite( u8PhysDrvNb, pu8Buffer, pxLayout->xVolume + 6, 1 ) ) )
   {
-    sys = 0x0C;    /* FAT32X */
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+  }
+  /* Else, if writing the VBR failed */
+  else if ( EF_RET_OK != eEFPrvDriveWrite( u8PhysDrvNb, pu8Buffer, pxLayout->xVolume, 1 ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  return eRetVal;
+}
+
+static ef_return_et eEFPrvMkfsPartitionUpdate (
+  ef_u08_t                  u8PhysDrvNb,
+  ef_u08_t                  u8PartitionNb,
+  ef_u08_t                  u8Format,
+  const ef_mkfs_layout_st * pxLayout,
+  ef_u08_t                * pu8Buffer
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxLayout );
+  EF_ASSERT_PRIVATE( 0 != pu8Buffer );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u08_t      u8SystemId;
+  ef_lba_t      xSizes[ 2 ];
+
+  /* Determine the system ID in the MBR partition table */
+  if ( EF_MKFS_FAT32 == pxLayout->u8Type )
+  {
+    /* FAT32X */
+    u8SystemId = 0x0C;
+  }
+  else if ( 0x10000 <= pxLayout->u32Size )
+  {
+    /* FAT12/16 (large) */
+    u8SystemId = 0x06;
   }
   else
   {
-    if ( 0x10000 <= sz_vol )
+    u8SystemId = ( EF_MKFS_FAT16 == pxLayout->u8Type ) ? 0x04 : 0x01;
+  }
+
+  /* If the volume is in an existing partition, its system ID is updated */
+  if ( 0 != u8PartitionNb )
+  {
+    if ( EF_RET_OK != eEFPrvDriveRead( u8PhysDrvNb, pu8Buffer, 0, 1 ) )
     {
-      sys = 0x06;  /* FAT12/16 (large) */
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
     }
     else
     {
-      if ( FS_FAT16 == fsty )
+      pu8Buffer[   EF_MBR_OFFSET_PTE_ARRAY + ( ( u8PartitionNb - 1 ) * EF_MBR_PTE_SIZE )
+                 + EF_MBR_PTE_OFFSET_PARTITION_TYPE ] = u8SystemId;
+      if ( EF_RET_OK != eEFPrvDriveWrite( u8PhysDrvNb, pu8Buffer, 0, 1 ) )
       {
-        sys = 0x04; /* FAT16 */
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
       }
       else
       {
-        sys = 0x01; /* FAT12 */
+        EF_CODE_COVERAGE( );
       }
     }
   }
-
-  /* Update partition information */
-  if ( ( 0 != ipart ) )  /* Volume is in the existing partition */
+  /* Else, if the volume is a new single partition */
+  else if ( 0 == ( u8Format & FM_SFD ) )
   {
-    if (    ( 0 == EF_CONF_LBA64 )
-         || ( 0 == ( fsopt & 0x80 ) ) )
+    xSizes[ 0 ] = pxLayout->u32Size;
+    xSizes[ 1 ] = 0;
+    if ( EF_RET_OK != eEFPrvPartitionCreate( u8PhysDrvNb, xSizes, u8SystemId, pu8Buffer ) )
     {
-      /* Update system ID in the partition table */
-      if ( EF_RET_OK !=  eEFPrvDriveRead( u8PhyDrvNb, buf, 0, 1 ) )
-      {
-        LEAVE_MKFS(EF_RET_DISK_ERR);  /* Read the MBR */
-      }
-      buf[EF_MBR_OFFSET_PTE_ARRAY + (ipart - 1) * EF_MBR_PTE_SIZE + EF_MBR_PTE_OFFSET_PARTITION_TYPE] = sys;      /* Set system ID */
-      if ( EF_RET_OK !=  eEFPrvDriveWrite( u8PhyDrvNb, buf, 0, 1 ) )
-      {
-        LEAVE_MKFS( EF_RET_DISK_ERR );  /* Write it back to the MBR */
-      }
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
     }
   }
   else
   {
-    /* Volume as a new single partition */
-    if ( 0 == ( fsopt & FM_SFD ) )
-    {
-      /* Create partition table if not in SFD */
-      lba[0] = sz_vol, lba[1] = 0;
-      fr = eEFPrvPartitionCreate( u8PhyDrvNb, lba, sys, buf );
-      if ( EF_RET_OK != fr )
-      {
-        LEAVE_MKFS( fr );
-      }
-    }
+    EF_CODE_COVERAGE( );
   }
 
-  if ( EF_RET_OK !=  eEFPrvDriveIOCtrl( u8PhyDrvNb, CTRL_SYNC, 0 ) )
+  return eRetVal;
+}
+
+/* Public functions ------------------------------------------------------------------------------------------------ */
+
+ef_return_et eEF_mkfs (
+  ef_u08_t                  u8PhysDrvNb,
+  ef_u08_t                  u8PartitionNb,
+  const ef_mkfs_param_st  * pxParameters,
+  void                    * pvBuffer,
+  ef_u32_t                  u32Size
+)
+{
+  ef_return_et      eRetVal;
+  ef_u08_t        * pu8Buffer = (ef_u08_t *) pvBuffer;
+  ef_u16_t          u16SectorSize = EF_CONF_SECTOR_SIZE;
+  ef_u32_t          u32BlockSize;
+  ef_u32_t          u32BufferSectors;
+  ef_bool_t         bQuick;
+  ef_mkfs_layout_st xLayout = { 0 };
+
+  /* Use the default parameters if they are not given */
+  pxParameters = ( 0 != pxParameters ) ? pxParameters : &xMkfsParametersDefault;
+
+  eRetVal = eEFPrvDriveInitialize( u8PhysDrvNb );
+  if ( EF_RET_DISK_NOINIT == eRetVal )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_NOT_READY );
+  }
+  else if ( EF_RET_DISK_PROTECT == eRetVal )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_WRITE_PROTECTED );
+  }
+  /* Else, if a volume of the drive is mounted */
+  else if ( EF_RET_OK != eEFPrvMkfsDriveCheck( u8PhysDrvNb ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_LOCKED );
+  }
+  /* Get sector size (multiple sector size cfg only) */
+  else if (    ( 0 == EF_CONF_SECTOR_SIZE_FIXED )
+            && ( EF_RET_OK != eEFPrvDriveIOCtrl( u8PhysDrvNb, GET_SECTOR_SIZE, &u16SectorSize ) ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+  }
+  else if (    ( EF_CONF_SECTOR_SIZE < u16SectorSize )
+            || ( 0 == u16SectorSize )
+            || ( 0 != ( u16SectorSize & ( u16SectorSize - 1 ) ) ) )
   {
-    LEAVE_MKFS( EF_RET_DISK_ERR );
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+  }
+  /* Else, if the working buffer cannot hold a sector */
+  else if ( ( 0 == pu8Buffer ) || ( u16SectorSize > u32Size ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_NOT_ENOUGH_CORE );
+  }
+  else
+  {
+    /* Erase block size [sector], the data area is aligned on it */
+    u32BlockSize = pxParameters->u32DataAlign;
+    if (    ( 0 == u32BlockSize )
+         && ( EF_RET_OK != eEFPrvDriveIOCtrl( u8PhysDrvNb, GET_BLOCK_SIZE, &u32BlockSize ) ) )
+    {
+      u32BlockSize = 1;
+    }
+    else if ( ( 0 == u32BlockSize ) || ( 0x8000 < u32BlockSize ) || ( 0 != ( u32BlockSize & ( u32BlockSize - 1 ) ) ) )
+    {
+      u32BlockSize = 1;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+
+    u32BufferSectors = u32Size / u16SectorSize;
+    bQuick = ( 0 != ( pxParameters->u8Format & FM_QUICK ) ) ? EF_BOOL_TRUE : EF_BOOL_FALSE;
+
+    eRetVal = eEFPrvMkfsVolumeLocate( u8PhysDrvNb, u8PartitionNb, pxParameters->u8Format, pu8Buffer, &xLayout );
+    if ( EF_RET_OK == eRetVal )
+    {
+      eRetVal = eEFPrvMkfsLayoutCompute( pxParameters, u16SectorSize, u32BlockSize, &xLayout );
+    }
+    /* The data area first, then the FATs and the root directory, then the boot records */
+    if ( EF_RET_OK == eRetVal )
+    {
+      eRetVal = eEFPrvMkfsDataPrepare( u8PhysDrvNb, &xLayout, bQuick, pu8Buffer, u32BufferSectors, u16SectorSize );
+    }
+    if ( EF_RET_OK == eRetVal )
+    {
+      eRetVal = eEFPrvMkfsTablesWrite( u8PhysDrvNb, &xLayout, pu8Buffer, u32BufferSectors, u16SectorSize );
+    }
+    if ( EF_RET_OK == eRetVal )
+    {
+      eRetVal = eEFPrvMkfsBootWrite( u8PhysDrvNb, &xLayout, pu8Buffer, u16SectorSize );
+    }
+    if ( EF_RET_OK == eRetVal )
+    {
+      eRetVal = eEFPrvMkfsPartitionUpdate( u8PhysDrvNb, u8PartitionNb, pxParameters->u8Format, &xLayout, pu8Buffer );
+    }
+    if ( ( EF_RET_OK == eRetVal ) && ( EF_RET_OK != eEFPrvDriveIOCtrl( u8PhysDrvNb, CTRL_SYNC, 0 ) ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+    }
   }
 
-  LEAVE_MKFS( EF_RET_OK );
+  return eRetVal;
 }
 
-#endif /* && EF_USE_MKFS */
+#endif /* ( 0 != EF_CONF_USE_MKFS ) */
 
 /* ***************************************************************************************************************** */
 /* END OF FILE ***************************************************************************************************** */
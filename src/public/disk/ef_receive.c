@@ -0,0 +1,626 @@
+/**
+ * ********************************************************************************************************************
+ *  @file     ef_receive.c
+ *  @ingroup  group_eFAT_Public
+ *  @author   ChaN
+ *  @author   Emmanuel AMADIO
+ *  @version  V0.1
+ *  @brief    Receive Data from a Producer Directly
+ *
+ * ********************************************************************************************************************
+ *  eFAT - embedded FAT Filesystem module
+ * ********************************************************************************************************************
+ *
+ *  Copyright (C) 2021, Amadio Emmanuel, all right reserved.
+ *  Copyright (C) 2019, ChaN, all right reserved.
+ *
+ *  eFAT module is an open source software. Redistribution and use of eFAT in source and binary forms, with or without
+ *  modification, are permitted provided that the following condition is met:
+ *
+ *  Redistributions of source code must retain the above copyright notice, this condition and the following disclaimer.
+ *
+ *  This software is provided by the copyright holders and contributors "AS IS" and any warranties related to this
+ *  software are DISCLAIMED.
+ *  The copyright owners or contributors be NOT LIABLE for any damages caused by use of this software.
+ * ********************************************************************************************************************
+ */
+
+/* START OF FILE *************************************************************************************************** */
+/* ***************************************************************************************************************** */
+
+/* Includes -------------------------------------------------------------------------------------------------------- */
+
+#include <ef_port_memory.h>
+#include <efat.h>
+#include <efat_level3.h>
+#include <ef_prv_fat.h>
+#include "ef_prv_def.h"
+#include "ef_prv_drive.h"
+#include "ef_prv_file.h"
+#include "ef_prv_lock.h"
+#include "ef_prv_validate.h"
+
+/* Local constant macros ------------------------------------------------------------------------------------------- */
+/* Local function macros ------------------------------------------------------------------------------------------- */
+/* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
+/* Local variables ------------------------------------------------------------------------------------------------- */
+/* Public variables ------------------------------------------------------------------------------------------------ */
+/* Local function prototypes---------------------------------------------------------------------------------------- */
+
+/**
+ *  @brief  Ask the producer to fill a buffer, until it is full or the producer has no more data
+ *
+ *  @param  pxFunc    Pointer to the producing function
+ *  @param  pu8Buffer Pointer to the buffer to fill
+ *  @param  u32Size   Size of the buffer [byte]
+ *  @param  pbEnd     Pointer to the end of data flag, set when the producer returned no byte
+ *
+ *  @return Number of bytes produced
+ */
+static ef_u32_t u32EFPrvFileReceiveProduce (
+  ProduceFn * pxFunc,
+  ef_u08_t  * pu8Buffer,
+  ef_u32_t    u32Size,
+  ef_bool_t * pbEnd
+);
+
+/**
+ *  @brief  Resolve the sector of the file offset, on a sector boundary
+ *
+ *  On a cluster boundary, the chain is followed or stretched. The previous current cluster is returned so that it can
+ *  be restored if no byte is received in the new one.
+ *
+ *  @param  pxFile      Pointer to the file object
+ *  @param  pxFS        Pointer to the file system object
+ *  @param  pxSector    Pointer to the sector of the file offset
+ *  @param  pu32Cluster Pointer to the current cluster before the call
+ *  @param  pbLinked    Pointer to the chain change flag, set when a cluster may have been linked past the file end
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       Success
+ *  @retval EF_RET_INT_ERR  Following or stretching the chain failed
+ */
+static ef_return_et eEFPrvFileReceiveSector (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ef_lba_t    * pxSector,
+  ef_u32_t    * pu32Cluster,
+  ef_bool_t   * pbLinked
+);
+
+/**
+ *  @brief  Receive the bytes of the current sector of a file directly into its window
+ *
+ *  @param  pxFile    Pointer to the file object
+ *  @param  pxFS      Pointer to the file system object
+ *  @param  pxFunc    Pointer to the producing function
+ *  @param  u32Max    Maximum number of bytes to receive
+ *  @param  pu32Count Pointer to the number of bytes received
+ *  @param  pbLinked  Pointer to the chain change flag
+ *  @param  pbEnd     Pointer to the end of data flag
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       Success
+ *  @retval EF_RET_DISK_ERR Updating the window failed
+ *  @retval EF_RET_INT_ERR  Following or stretching the chain failed
+ */
+static ef_return_et eEFPrvFileReceiveWindow (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ProduceFn   * pxFunc,
+  ef_u32_t      u32Max,
+  ef_u32_t    * pu32Count,
+  ef_bool_t   * pbLinked,
+  ef_bool_t   * pbEnd
+);
+
+/**
+ *  @brief  Receive a contiguous run of sectors of a file into the caller buffer, then write it by one disk access
+ *
+ *  The file offset is on a sector boundary. At the end of the chain, the run is extended with the free clusters
+ *  directly following it. A last partial sector is left in the window.
+ *
+ *  @param  pxFile        Pointer to the file object
+ *  @param  pxFS          Pointer to the file system object
+ *  @param  pxFunc        Pointer to the producing function
+ *  @param  pu8Buffer     Pointer to the run buffer
+ *  @param  u32BufferSize Size of the run buffer [byte], at least one sector
+ *  @param  u32Max        Maximum number of bytes to receive
+ *  @param  pu32Count     Pointer to the number of bytes received
+ *  @param  pbLinked      Pointer to the chain change flag
+ *  @param  pbEnd         Pointer to the end of data flag
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       Success
+ *  @retval EF_RET_DISK_ERR Writing the run or updating the window failed
+ *  @retval EF_RET_INT_ERR  Following or extending the chain failed
+ */
+static ef_return_et eEFPrvFileReceiveRun (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ProduceFn   * pxFunc,
+  ef_u08_t    * pu8Buffer,
+  ef_u32_t      u32BufferSize,
+  ef_u32_t      u32Max,
+  ef_u32_t    * pu32Count,
+  ef_bool_t   * pbLinked,
+  ef_bool_t   * pbEnd
+);
+
+/* Local functions ------------------------------------------------------------------------------------------------- */
+
+static ef_u32_t u32EFPrvFileReceiveProduce (
+  ProduceFn * pxFunc,
+  ef_u08_t  * pu8Buffer,
+  ef_u32_t    u32Size,
+  ef_bool_t * pbEnd
+)
+{
+  ef_u32_t  u32Count = 0;
+  ef_u32_t  u32Produced;
+
+  while ( ( EF_BOOL_FALSE == *pbEnd ) && ( u32Count < u32Size ) )
+  {
+    u32Produced = (*pxFunc)( pu8Buffer + u32Count, u32Size - u32Count );
+    /* If the producer has no more data */
+    if ( 0 == u32Produced )
+    {
+      *pbEnd = EF_BOOL_TRUE;
+    }
+    else
+    {
+      u32Count += u32Produced;
+    }
+  }
+
+  return u32Count;
+}
+
+static ef_return_et eEFPrvFileReceiveSector (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ef_lba_t    * pxSector,
+  ef_u32_t    * pu32Cluster,
+  ef_bool_t   * pbLinked
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFile );
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u32_t      u32ClusterOffset = EF_CLUSTER_OFFSET_GET( pxFS );
+
+  *pu32Cluster = pxFile->u32Clst;
+  /* If not on a cluster boundary */
+  if ( 0 != u32ClusterOffset )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if following or stretching the chain failed */
+  else if ( EF_RET_OK != eEFPrvFileWriteClusterNbUpdate( pxFile ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  else
+  {
+    /* Past the end of the file, the cluster may be a new one */
+    if ( pxFile->u32FileOffset >= pxFile->u32Size )
+    {
+      *pbLinked = EF_BOOL_TRUE;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+
+  /* If the cluster is not known */
+  if ( EF_RET_OK != eRetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if getting the base sector of the cluster failed */
+  else if ( EF_RET_OK != eEFPrvFATClusterToSector( pxFS, pxFile->u32Clst, pxSector ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  else
+  {
+    *pxSector += u32ClusterOffset;
+  }
+
+  return eRetVal;
+}
+
+static ef_return_et eEFPrvFileReceiveWindow (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ProduceFn   * pxFunc,
+  ef_u32_t      u32Max,
+  ef_u32_t    * pu32Count,
+  ef_bool_t   * pbLinked,
+  ef_bool_t   * pbEnd
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFile );
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u32_t      u32OffsetInSector = pxFile->u32FileOffset % EF_SECTOR_SIZE( pxFS );
+  ef_u32_t      u32Cluster = pxFile->u32Clst;
+  ef_lba_t      xSector;
+
+  *pu32Count = 0;
+  /* If not on a sector boundary, the window already holds the sector of the file offset */
+  if ( 0 != u32OffsetInSector )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if the sector of the file offset cannot be resolved */
+  else if ( EF_RET_OK != eEFPrvFileReceiveSector( pxFile, pxFS, &xSector, &u32Cluster, pbLinked ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  /* Else, if the sector holds data of the file and the window update failed */
+  else if (    ( pxFile->u32FileOffset < pxFile->u32Size )
+            && ( EF_RET_OK != eEFPrvFileWindowUpdate( pxFile, pxFS, xSector ) ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+  }
+  /* Else, if the sector is past the end of the file and the window switch failed */
+  else if (    ( pxFile->u32FileOffset >= pxFile->u32Size )
+            && ( EF_RET_OK != eEFPrvFileWindowSet( pxFile, pxFS, xSector ) ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  /* If the window is ready */
+  if ( EF_RET_OK == eRetVal )
+  {
+    /* Clip the request at the sector end */
+    if ( u32Max > ( EF_SECTOR_SIZE( pxFS ) - u32OffsetInSector ) )
+    {
+      u32Max = EF_SECTOR_SIZE( pxFS ) - u32OffsetInSector;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    *pu32Count = u32EFPrvFileReceiveProduce( pxFunc, pxFile->u8Window + u32OffsetInSector, u32Max, pbEnd );
+    /* If bytes have been received */
+    if ( 0 != *pu32Count )
+    {
+      /* Flag the window as dirty */
+      pxFile->u8StatusFlags |= EF_FILE_WIN_DIRTY;
+    }
+    else
+    {
+      /* The current cluster still holds the last byte of the file offset */
+      pxFile->u32Clst = u32Cluster;
+    }
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  return eRetVal;
+}
+
+static ef_return_et eEFPrvFileReceiveRun (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ProduceFn   * pxFunc,
+  ef_u08_t    * pu8Buffer,
+  ef_u32_t      u32BufferSize,
+  ef_u32_t      u32Max,
+  ef_u32_t    * pu32Count,
+  ef_bool_t   * pbLinked,
+  ef_bool_t   * pbEnd
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFile );
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_return_et  eRetVal;
+  ef_u32_t      u32SectorSize = EF_SECTOR_SIZE( pxFS );
+  ef_u32_t      u32ClusterOffset = EF_CLUSTER_OFFSET_GET( pxFS );
+  ef_u32_t      u32Cluster;
+  ef_u32_t      u32Last;
+  ef_u32_t      u32Next;
+  ef_u32_t      u32Count;
+  ef_u32_t      u32SectorsMax;
+  ef_u32_t      u32SectorsNb;
+  ef_u32_t      u32Full;
+  ef_lba_t      xSector;
+
+  *pu32Count = 0;
+  eRetVal = eEFPrvFileReceiveSector( pxFile, pxFS, &xSector, &u32Cluster, pbLinked );
+  /* If the sector of the file offset cannot be resolved */
+  if ( EF_RET_OK != eRetVal )
+  {
+    return eRetVal;
+  }
+
+  /* The run is bounded by the buffer and by the bytes to receive */
+  u32SectorsMax = u32BufferSize / u32SectorSize;
+  if ( u32SectorsMax > ( ( u32Max + u32SectorSize - 1 ) / u32SectorSize ) )
+  {
+    u32SectorsMax = ( u32Max + u32SectorSize - 1 ) / u32SectorSize;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Extend the run while the chain goes on with the next cluster */
+  u32SectorsNb = pxFS->u8ClstSize - u32ClusterOffset;
+  u32Last = pxFile->u32Clst;
+  while ( u32SectorsNb < u32SectorsMax )
+  {
+    /* If following the chain failed */
+    if ( EF_RET_OK != eEFPrvFATGet( pxFS, u32Last, &u32Next ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      break;
+    }
+    /* Else, if the chain goes on with the next cluster */
+    else if ( ( u32Last + 1 ) == u32Next )
+    {
+      u32Last = u32Next;
+      u32SectorsNb += pxFS->u8ClstSize;
+    }
+    /* Else, if the chain is fragmented here */
+    else if ( EF_RET_OK == eEFPrvFATClusterNbCheck( pxFS->u32FatEntriesNb, u32Next ) )
+    {
+      break;
+    }
+    else
+    {
+      /* End of the chain, link the free clusters directly following it */
+      u32Count = ( ( u32SectorsMax - u32SectorsNb ) + pxFS->u8ClstSize - 1 ) / pxFS->u8ClstSize;
+      if ( EF_RET_OK != eEFPrvFATChainExtend( &pxFile->xObject, u32Last, EF_BOOL_TRUE, &u32Count, &u32Next ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      }
+      else if ( 0 != u32Count )
+      {
+        *pbLinked = EF_BOOL_TRUE;
+        u32SectorsNb += u32Count * pxFS->u8ClstSize;
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+      break;
+    }
+  }
+  if ( u32SectorsNb > u32SectorsMax )
+  {
+    u32SectorsNb = u32SectorsMax;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+  if ( u32Max > ( u32SectorsNb * u32SectorSize ) )
+  {
+    u32Max = u32SectorsNb * u32SectorSize;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  /* If the run is resolved, ask the producer to fill it */
+  if ( EF_RET_OK == eRetVal )
+  {
+    *pu32Count = u32EFPrvFileReceiveProduce( pxFunc, pu8Buffer, u32Max, pbEnd );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+  u32Full = *pu32Count / u32SectorSize;
+
+  /* If nothing has been received */
+  if ( 0 == *pu32Count )
+  {
+    /* The current cluster still holds the last byte of the file offset */
+    pxFile->u32Clst = u32Cluster;
+  }
+  /* Else, if the whole sectors of the run cannot be written */
+  else if (    ( 0 != u32Full )
+            && ( EF_RET_OK != eEFPrvDriveWrite( pxFS->u8PhysDrv, pu8Buffer, xSector, u32Full ) ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+  }
+  else
+  {
+    /* If the window holds a sector which has just been written, its content is outdated */
+    if ( ( xSector <= pxFile->xSector ) && ( ( xSector + u32Full ) > pxFile->xSector ) )
+    {
+      pxFile->u8StatusFlags &= (ef_u08_t) ~EF_FILE_WIN_DIRTY;
+      pxFile->xSector = 0;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    /* The run is contiguous, the cluster holding the last byte received is computed */
+    pxFile->u32Clst += ( ( u32ClusterOffset * u32SectorSize ) + *pu32Count - 1 ) / ( pxFS->u8ClstSize * u32SectorSize );
+    xSector += u32Full;
+
+    /* If the run ends on a sector boundary */
+    if ( 0 == ( *pu32Count % u32SectorSize ) )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    /* Else, if the last sector holds data of the file and the window update failed */
+    else if (    ( ( pxFile->u32FileOffset + *pu32Count ) < pxFile->u32Size )
+              && ( EF_RET_OK != eEFPrvFileWindowUpdate( pxFile, pxFS, xSector ) ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+    }
+    /* Else, if the last sector is past the end of the file and the window switch failed */
+    else if (    ( ( pxFile->u32FileOffset + *pu32Count ) >= pxFile->u32Size )
+              && ( EF_RET_OK != eEFPrvFileWindowSet( pxFile, pxFS, xSector ) ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+    }
+    /* Else, if moving the last partial sector into the window failed */
+    else if ( EF_RET_OK != eEFPortMemCopy( pu8Buffer + ( u32Full * u32SectorSize ), pxFile->u8Window,
+                                           *pu32Count % u32SectorSize ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+    }
+    else
+    {
+      /* Flag the window as dirty */
+      pxFile->u8StatusFlags |= EF_FILE_WIN_DIRTY;
+    }
+  }
+
+  return eRetVal;
+}
+
+/* Public functions ------------------------------------------------------------------------------------------------ */
+
+ef_return_et eEF_receive (
+  EF_FILE   * pxFile,
+  ProduceFn * pxFunc,
+  ef_u08_t  * pu8Buffer,
+  ef_u32_t    u32BufferSize,
+  ef_u32_t    u32BTr,
+  ef_u32_t  * pu32BTr
+)
+{
+  EF_ASSERT_PUBLIC( 0 != pxFile );
+  EF_ASSERT_PUBLIC( 0 != pxFunc );
+  EF_ASSERT_PUBLIC( 0 != pu32BTr );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_fs_st    * pxFS;
+  ef_u32_t      u32Count = 0;
+  ef_bool_t     bLinked = EF_BOOL_FALSE;
+  ef_bool_t     bEnd = EF_BOOL_FALSE;
+
+  /* Clear received byte counter */
+  *pu32BTr = 0;
+  /* If the file object is not valid */
+  if ( EF_RET_OK != eEFPrvValidateObject( &pxFile->xObject, &pxFS ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
+    return eRetVal;
+  }
+
+  /* If the file has been aborted */
+  if ( EF_RET_OK != (ef_return_et) pxFile->u8ErrorCode )
+  {
+    eRetVal = (ef_return_et) pxFile->u8ErrorCode;
+  }
+  /* Else, if access mode is not compatible */
+  else if ( 0 == ( pxFile->u8StatusFlags & EF_FILE_OPEN_WRITE ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+  }
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+  /* Else, if in bounded latency write mode, the runs would not be taken from the pool */
+  else if ( 0 != pxFile->u32PoolSize )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+  }
+#endif
+  else
+  {
+    /* Check u32FileOffset wrap-around (file size cannot reach 4 GiB at FAT volume) */
+    if ( pxFile->u32FileOffset > ( (ef_u32_t) EF_FILE_SIZE_MAX - u32BTr ) )
+    {
+      u32BTr = (ef_u32_t)( EF_FILE_SIZE_MAX - pxFile->u32FileOffset );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+
+    /* Repeat until all data received, the producer has no more data or something fails */
+    while ( ( EF_RET_OK == eRetVal ) && ( 0 != u32BTr ) && ( EF_BOOL_FALSE == bEnd ) )
+    {
+      /* If     there is no run buffer
+       *     OR not on a sector boundary
+       *     OR less than a sector to receive
+       */
+      if (    ( 0 == pu8Buffer )
+           || ( EF_SECTOR_SIZE( pxFS ) > u32BufferSize )
+           || ( 0 != ( pxFile->u32FileOffset % EF_SECTOR_SIZE( pxFS ) ) )
+           || ( EF_SECTOR_SIZE( pxFS ) > u32BTr ) )
+      {
+        eRetVal = eEFPrvFileReceiveWindow( pxFile, pxFS, pxFunc, u32BTr, &u32Count, &bLinked, &bEnd );
+      }
+      else
+      {
+        eRetVal = eEFPrvFileReceiveRun( pxFile, pxFS, pxFunc, pu8Buffer, u32BufferSize, u32BTr,
+                                        &u32Count, &bLinked, &bEnd );
+      }
+
+      /* If bytes have been received */
+      if ( ( EF_RET_OK == eRetVal ) && ( 0 != u32Count ) )
+      {
+        pxFile->u32FileOffset += u32Count;
+        *pu32BTr              += u32Count;
+        u32BTr                -= u32Count;
+        /* Set file change flags */
+        pxFile->u8StatusFlags |= EF_FILE_MODIFIED;
+        /* If file offset is bigger than file size */
+        if ( pxFile->u32FileOffset > pxFile->u32Size )
+        {
+          /* Update File size */
+          pxFile->u32Size = pxFile->u32FileOffset;
+        }
+        else
+        {
+          EF_CODE_COVERAGE( );
+        }
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+    }
+
+    /* If     clusters may have been linked past the data received
+     *    AND they are not reserved for the file
+     *    AND releasing them failed
+     */
+    if (    ( EF_RET_OK == eRetVal )
+         && ( EF_BOOL_FALSE != bLinked )
+         && ( EF_BOOL_FALSE == EF_FILE_RESERVED( pxFile ) )
+         && ( EF_RET_OK != eEFPrvFileReserveRelease( pxFile ) ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+
+    /* If something failed, the file is aborted */
+    if ( EF_RET_OK != eRetVal )
+    {
+      pxFile->u8ErrorCode = (ef_u08_t) eRetVal;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+
+  (void) eEFPrvFSUnlock( pxFS, eRetVal );
+  return eRetVal;
+}
+
+/* ***************************************************************************************************************** */
+/* END OF FILE ***************************************************************************************************** */
@@ -30,22 +30,12 @@
 
 /* Includes -------------------------------------------------------------------------------------------------------- */
 
-#include <ef_port_load_store.h>
 #include <efat.h>
-#include <ef_prv_def.h>
 #include <ef_prv_fat.h>
-#include "ef_port_diskio.h"
 #include "ef_prv_def.h"
-#include "ef_prv_directory.h"
-#include "ef_prv_dirfunc.h"
+#include "ef_prv_file.h"
 #include "ef_prv_lock.h"
-#include "ef_prv_string.h"
-#include "ef_prv_volume.h"
-#include "ef_prv_gpt.h"
-#include "ef_prv_lfn.h"
-#include "ef_prv_unicode.h"
 #include "ef_prv_validate.h"
-#include "ef_port_diskio.h"
 
 /* Local constant macros ------------------------------------------------------------------------------------------- */
 /* Local function macros ------------------------------------------------------------------------------------------- */
@@ -57,122 +47,103 @@
 /* Public functions ------------------------------------------------------------------------------------------------ */
 
 ef_return_et eEF_expand (
-  EF_FILE * pxFile, /* Pointer to the file object */
-  ef_u32_t  fsz,    /* File size to be expanded to */
-  ef_u08_t  opt     /* Operation u8Mode 0:Find and prepare or 1:Find and allocate */
+  EF_FILE   * pxFile,
+  ef_u32_t    u32Size,
+  ef_u08_t    u8Opt
 )
 {
   EF_ASSERT_PUBLIC( 0 != pxFile );
 
   ef_return_et  eRetVal;
   ef_fs_st    * pxFS;
-  ef_u32_t      n;
-  ef_u32_t      clst;
-  ef_u32_t      stcl;
-  ef_u32_t      scl;
-  ef_u32_t      ncl;
-  ef_u32_t      tcl;
-  ef_u32_t      lclst;
+  ef_u32_t      u32ClusterSize;
+  ef_u32_t      u32Wanted;
+  ef_u32_t      u32Cluster;
+  ef_u32_t      u32Count;
+  ef_u32_t      u32First;
 
-
-  eRetVal = eEFPrvValidateObject( &pxFile->xObject, &pxFS );    /* Check validity of the file object */
-  if (( EF_RET_OK != eRetVal ) || (eRetVal = (ef_return_et)pxFile->u8ErrorCode) != EF_RET_OK)
+  /* If the file object is not valid */
+  if ( EF_RET_OK != eEFPrvValidateObject( &pxFile->xObject, &pxFS ) )
   {
-    (void) eEFPrvFSUnlock( pxFS, eRetVal );
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
     return eRetVal;
   }
-  if (    ( 0 == fsz )
-       || ( 0 != pxFile->u32Size )
-       || ( 0 == ( pxFile->u8StatusFlags & EF_FILE_OPEN_WRITE ) ) )
+
+  u32ClusterSize = (ef_u32_t) pxFS->u8ClstSize * EF_SECTOR_SIZE( pxFS );
+  /* If the file has been aborted */
+  if ( EF_RET_OK != (ef_return_et) pxFile->u8ErrorCode )
+  {
+    eRetVal = (ef_return_et) pxFile->u8ErrorCode;
+  }
+  /* Else, if access mode is not compatible */
+  else if ( 0 == ( pxFile->u8StatusFlags & EF_FILE_OPEN_WRITE ) )
   {
     eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
-    (void) eEFPrvFSUnlock( pxFS, eRetVal );
-    return eRetVal;
   }
-  if ( EF_FILE_SIZE_MAX < fsz )
+  /* Else, if the file would not grow, or grow past its size limit */
+  else if ( ( pxFile->u32Size >= u32Size ) || ( EF_FILE_SIZE_MAX < u32Size ) )
   {
-    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );  /* Check if in size limit */
-    (void) eEFPrvFSUnlock( pxFS, eRetVal );
-    return eRetVal;
-   }
-  n = (ef_u32_t)pxFS->u8ClstSize * EF_SECTOR_SIZE( pxFS );  /* Cluster size */
-  tcl = (ef_u32_t)(fsz / n) + ((fsz & (n - 1)) ? 1 : 0);  /* Number of clusters needed */
-  stcl = pxFS->u32ClstLast; lclst = 0;
-  if ( EF_RET_OK != eEFPrvFATClusterNbCheck( pxFS->u32FatEntriesNb, stcl ) )
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+  }
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+  /* Else, if in bounded latency write mode, the pool already follows the end of the chain */
+  else if ( 0 != pxFile->u32PoolSize )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+  }
+#endif
+  /* Else, if the end of the chain cannot be found */
+  else if ( EF_RET_OK != eEFPrvFileChainLast( pxFile, pxFS, &u32Cluster, &u32Count ) )
   {
-    stcl = 2;
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
   }
-
-  scl   = stcl;
-  clst  = stcl;
-  ncl = 0;
-  for ( ; ; )
-  {  /* Find a contiguous cluster block */
-    eRetVal = eEFPrvFATGet( pxFS, clst, &n );
-    if ( ++clst >= pxFS->u32FatEntriesNb )
+  else
+  {
+    /* Number of clusters holding the expanded file */
+    u32Wanted = ( u32Size / u32ClusterSize ) + ( ( 0 != ( u32Size % u32ClusterSize ) ) ? 1 : 0 );
+    /* If the chain is already long enough, reserved clusters for example */
+    if ( u32Count >= u32Wanted )
     {
-      clst = 2;
+      eRetVal = EF_RET_OK;
     }
-    if ( EF_RET_OK != eRetVal )
+    /* Else, if no contiguous run of the missing clusters is free */
+    else if ( EF_RET_OK != ( eRetVal = eEFPrvFATFreeExtentFind( pxFS, u32Wanted - u32Count, u32Cluster, &u32First ) ) )
     {
-      break;
+      EF_CODE_COVERAGE( );
     }
-    /* If it is a free cluster? */
-    if ( 0 == n )
+    /* Else, if the run is only prepared for the next allocations */
+    else if ( 0 == u8Opt )
     {
-      /* If a contiguous cluster block is found */
-      if ( ++ncl == tcl )
-      {
-        break;
-      }
+      pxFS->u32ClstLast = u32First - 1;
+#if ( 1 < EF_CONF_ALLOC_GROUPS )
+      /* A new chain must start in the run, not in the next allocation group */
+      pxFS->bClstLastHint = ( 0 == u32Cluster ) ? EF_BOOL_TRUE : EF_BOOL_FALSE;
+#endif
     }
-    else
+    /* Else, if linking the run at the end of the chain failed */
+    else if ( EF_RET_OK != eEFPrvFATChainLink( pxFS, u32Cluster, u32First, u32Wanted - u32Count ) )
     {
-      /* Not a free cluster */
-      scl = clst;
-      ncl = 0;
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
     }
-    if ( clst == stcl )
-    {
-      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
-      break;
-    }  /* No contiguous cluster? */
-  }
-  if ( EF_RET_OK == eRetVal )  /* A contiguous free area is found */
-  {
-    if ( 0 != opt )    /* Allocate it now */
+    /* Else, if the file had no cluster */
+    else if ( 0 == u32Cluster )
     {
-      for ( clst = scl, n = tcl; n; clst++, n-- )  /* Create a cluster chain on the FAT */
-      {
-        eRetVal = eEFPrvFATSet( pxFS, clst, (n == 1) ? 0xFFFFFFFF : clst + 1);
-        if ( EF_RET_OK != eRetVal )
-        {
-          break;
-        }
-        lclst = clst;
-      }
+      pxFile->xObject.u32ClstStart = u32First;
     }
     else
     {
-      /* Set it as suggested point for next allocation */
-      lclst = scl - 1;
+      EF_CODE_COVERAGE( );
     }
-  }
 
-  if ( EF_RET_OK == eRetVal )
-  {
-    pxFS->u32ClstLast = lclst;    /* Set suggested start cluster to start next */
-    /* Is it allocated now? */
-    if ( 0 != opt )
+    /* If the clusters are allocated, the file takes its new size */
+    if ( ( EF_RET_OK == eRetVal ) && ( 0 != u8Opt ) )
     {
-      pxFile->xObject.u32ClstStart = scl;    /* Update object allocation information */
-      pxFile->u32Size = fsz;
+      pxFile->u32Size = u32Size;
       pxFile->u8StatusFlags |= EF_FILE_MODIFIED;
-      if ( pxFS->u32ClstFreeNb <= ( pxFS->u32FatEntriesNb - 2 ) ) /* Update FSINFO */
-      {
-        pxFS->u32ClstFreeNb -= tcl;
-        pxFS->u8FsInfoFlags |= 1;
-      }
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
     }
   }
 
@@ -182,4 +153,3 @@ ef_return_et eEF_expand (
 
 /* ***************************************************************************************************************** */
 /* END OF FILE ***************************************************************************************************** */
-
@@ -0,0 +1,326 @@
+/**
+ * ********************************************************************************************************************
+ *  @file     ef_fbounded.c
+ *  @ingroup  group_eFAT_Public
+ *  @author   ChaN
+ *  @author   Emmanuel AMADIO
+ *  @version  V0.1
+ *  @brief    Bounded latency write mode of a file
+ *
+ * ********************************************************************************************************************
+ *  eFAT - embedded FAT Filesystem module
+ * ********************************************************************************************************************
+ *
+ *  Copyright (C) 2021, Amadio Emmanuel, all right reserved.
+ *  Copyright (C) 2019, ChaN, all right reserved.
+ *
+ *  eFAT module is an open source software. Redistribution and use of eFAT in source and binary forms, with or without
+ *  modification, are permitted provided that the following condition is met:
+ *
+ *  Redistributions of source code must retain the above copyright notice, this condition and the following disclaimer.
+ *
+ *  This software is provided by the copyright holders and contributors "AS IS" and any warranties related to this
+ *  software are DISCLAIMED.
+ *  The copyright owners or contributors be NOT LIABLE for any damages caused by use of this software.
+ * ********************************************************************************************************************
+ */
+
+/* START OF FILE *************************************************************************************************** */
+/* ***************************************************************************************************************** */
+
+/* Includes -------------------------------------------------------------------------------------------------------- */
+
+#include <efat.h>
+#include <ef_prv_fat.h>
+#include "ef_prv_def.h"
+#include "ef_prv_file.h"
+#include "ef_prv_lock.h"
+#include "ef_prv_validate.h"
+
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+
+/* Local constant macros ------------------------------------------------------------------------------------------- */
+/* Local function macros ------------------------------------------------------------------------------------------- */
+/* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
+/* Local variables ------------------------------------------------------------------------------------------------- */
+/* Public variables ------------------------------------------------------------------------------------------------ */
+/* Local function prototypes---------------------------------------------------------------------------------------- */
+/* Local functions ------------------------------------------------------------------------------------------------- */
+
+/**
+ *  @brief  Refill the cluster pool of a file
+ *
+ *  The volume must be locked by the caller.
+ *
+ *  @param  pxFile  Pointer to the file object
+ *  @param  pxFS    Pointer to the file system object
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       Success, the pool may still be partly filled
+ *  @retval EF_RET_DENIED   No contiguous free clusters for an empty pool
+ *  @retval EF_RET_INT_ERR  Accessing the FAT failed
+ */
+static ef_return_et eEFPrvFilePoolRefill (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFile );
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u32_t      u32Count = pxFile->u32PoolSize - pxFile->u32PoolNb;
+  ef_u32_t      u32Cluster = 0;
+  ef_u32_t      u32First = 0;
+
+  /* If the pool is full */
+  if ( 0 == u32Count )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if the pool is not empty */
+  else if ( 0 != pxFile->u32PoolNb )
+  {
+    /* The pool must stay contiguous, only the clusters following its last one can be added */
+    u32Cluster = pxFile->u32PoolNext + pxFile->u32PoolNb - 1;
+    if ( EF_RET_OK != eEFPrvFATChainExtend( &pxFile->xObject, u32Cluster, EF_BOOL_TRUE, &u32Count, &u32First ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+    }
+    else
+    {
+      pxFile->u32PoolNb += u32Count;
+    }
+  }
+  /* Else, the pool is empty, it is a new run linked at the end of the chain */
+  else
+  {
+    ef_u32_t  u32Value;
+
+    /* Find the end of the chain from the last pool link, or from the beginning of the file */
+    u32Value = ( 0 != pxFile->u32PoolPrev ) ? pxFile->u32PoolPrev : pxFile->xObject.u32ClstStart;
+    while ( ( EF_RET_OK == eRetVal ) && ( 2 <= u32Value ) && ( pxFS->u32FatEntriesNb > u32Value ) )
+    {
+      u32Cluster = u32Value;
+      if ( EF_RET_OK != eEFPrvFATGet( pxFS, u32Cluster, &u32Value ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+    }
+    /* If following the chain failed */
+    if ( EF_RET_OK != eRetVal )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    /* Else, if there is no contiguous run of the pool size */
+    else if ( EF_RET_OK != eEFPrvFATChainExtend( &pxFile->xObject, u32Cluster, EF_BOOL_FALSE, &u32Count, &u32First ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+    }
+    else
+    {
+      pxFile->u32PoolNext = u32First;
+      pxFile->u32PoolNb   = u32Count;
+      pxFile->u32PoolPrev = u32Cluster;
+      /* If the file had no cluster, the pool starts the chain */
+      if ( 0 == u32Cluster )
+      {
+        pxFile->xObject.u32ClstStart = u32First;
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+    }
+  }
+  /* If the FAT has been changed, the directory entry must follow */
+  if ( 0 != u32First )
+  {
+    pxFile->u8StatusFlags |= EF_FILE_MODIFIED;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  return eRetVal;
+}
+
+/* Public functions ------------------------------------------------------------------------------------------------ */
+
+ef_return_et eEFPrvFileBoundedRelease (
+  ef_file_st  * pxFile
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFile );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+
+  /* If the pool is empty */
+  if ( 0 == pxFile->u32PoolNb )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if removing the pool from the end of the chain failed */
+  else if ( EF_RET_OK != eEFPrvFATChainRemove( &pxFile->xObject, pxFile->u32PoolNext, pxFile->u32PoolPrev ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  else
+  {
+    /* If the pool was the whole chain */
+    if ( 0 == pxFile->u32PoolPrev )
+    {
+      pxFile->xObject.u32ClstStart = 0;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    pxFile->u8StatusFlags |= EF_FILE_MODIFIED;
+  }
+  /* The pool is released, even partly on error */
+  pxFile->u32PoolNb = 0;
+
+  return eRetVal;
+}
+
+ef_return_et eEF_fbounded (
+  EF_FILE   * pxFile,
+  ef_u32_t    u32PoolClusters
+)
+{
+  EF_ASSERT_PUBLIC( 0 != pxFile );
+
+  ef_return_et  eRetVal;
+  ef_fs_st    * pxFS;
+
+  /* If the file object is not valid */
+  if ( EF_RET_OK != eEFPrvValidateObject( &pxFile->xObject, &pxFS ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
+  }
+  /* Else, if access mode is not compatible */
+  else if ( 0 == ( pxFile->u8StatusFlags & EF_FILE_OPEN_WRITE ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+    (void) eEFPrvFSUnlock( pxFS, eRetVal );
+  }
+#if ( 0 != EF_CONF_FILE_RESERVE )
+  /* Else, if clusters are reserved past the end of the file, the pool would follow them */
+  else if ( ( 0 != u32PoolClusters ) && ( EF_BOOL_FALSE != pxFile->bReserved ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+    (void) eEFPrvFSUnlock( pxFS, eRetVal );
+  }
+#endif
+  /* Else, if leaving the bounded latency write mode */
+  else if ( 0 == u32PoolClusters )
+  {
+    eRetVal = eEFPrvFileBoundedRelease( pxFile );
+    pxFile->u32PoolSize = 0;
+    (void) eEFPrvFSUnlock( pxFS, eRetVal );
+  }
+  else
+  {
+    /* A smaller pool keeps its extra clusters until they are used */
+    pxFile->u32PoolSize = u32PoolClusters;
+    (void) eEFPrvFSUnlock( pxFS, EF_RET_OK );
+    /* Fill the pool */
+    eRetVal = eEF_fmaintain( pxFile );
+  }
+
+  return eRetVal;
+}
+
+ef_return_et eEF_fmaintain (
+  EF_FILE   * pxFile
+)
+{
+  EF_ASSERT_PUBLIC( 0 != pxFile );
+
+  ef_return_et  eRetVal;
+  ef_fs_st    * pxFS;
+
+  /* If the file object is not valid */
+  if ( EF_RET_OK != eEFPrvValidateObject( &pxFile->xObject, &pxFS ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
+  }
+  else
+  {
+    /* If not in bounded latency write mode */
+    if ( 0 == pxFile->u32PoolSize )
+    {
+      eRetVal = EF_RET_OK;
+    }
+    else
+    {
+      eRetVal = eEFPrvFilePoolRefill( pxFile, pxFS );
+    }
+    (void) eEFPrvFSUnlock( pxFS, eRetVal );
+
+    /* If refilling the pool succeeded, update the directory entry */
+    if ( EF_RET_OK == eRetVal )
+    {
+      eRetVal = eEF_fsync( pxFile );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+
+  return eRetVal;
+}
+
+ef_return_et eEF_fbounded_stats (
+  EF_FILE               * pxFile,
+  ef_fbounded_stats_st  * pxStats,
+  ef_bool_t               bReset
+)
+{
+  EF_ASSERT_PUBLIC( 0 != pxFile );
+  EF_ASSERT_PUBLIC( 0 != pxStats );
+
+  ef_return_et  eRetVal;
+  ef_fs_st    * pxFS;
+
+  /* If the file object is not valid */
+  if ( EF_RET_OK != eEFPrvValidateObject( &pxFile->xObject, &pxFS ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
+  }
+  else
+  {
+    eRetVal = EF_RET_OK;
+    pxStats->u32WritesNb      = pxFile->u32BwWritesNb;
+    pxStats->u32ShortNb       = pxFile->u32BwShortNb;
+    pxStats->u32CommandsMax   = pxFile->u32BwCmdsMax;
+    pxStats->u32CommandsLimit = EF_CONF_BOUNDED_WRITE_CMDS;
+    pxStats->u32PoolNb        = pxFile->u32PoolNb;
+    /* If the counters are restarted */
+    if ( EF_BOOL_FALSE != bReset )
+    {
+      pxFile->u32BwWritesNb = 0;
+      pxFile->u32BwShortNb  = 0;
+      pxFile->u32BwCmdsMax  = 0;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    (void) eEFPrvFSUnlock( pxFS, eRetVal );
+  }
+
+  return eRetVal;
+}
+
+#endif /* ( 0 != EF_CONF_BOUNDED_WRITE ) */
+
+/* ***************************************************************************************************************** */
+/* END OF FILE ***************************************************************************************************** */
@@ -0,0 +1,135 @@
+/**
+ * ********************************************************************************************************************
+ *  @file     ef_fdigest.c
+ *  @ingroup  group_eFAT_Public
+ *  @author   ChaN
+ *  @author   Emmanuel AMADIO
+ *  @version  V0.1
+ *  @brief    Digest of the data read from a file
+ *
+ * ********************************************************************************************************************
+ *  eFAT - embedded FAT Filesystem module
+ * ********************************************************************************************************************
+ *
+ *  Copyright (C) 2021, Amadio Emmanuel, all right reserved.
+ *  Copyright (C) 2019, ChaN, all right reserved.
+ *
+ *  eFAT module is an open source software. Redistribution and use of eFAT in source and binary forms, with or without
+ *  modification, are permitted provided that the following condition is met:
+ *
+ *  Redistributions of source code must retain the above copyright notice, this condition and the following disclaimer.
+ *
+ *  This software is provided by the copyright holders and contributors "AS IS" and any warranties related to this
+ *  software are DISCLAIMED.
+ *  The copyright owners or contributors be NOT LIABLE for any damages caused by use of this software.
+ * ********************************************************************************************************************
+ */
+
+/* START OF FILE *************************************************************************************************** */
+/* ***************************************************************************************************************** */
+
+/* Includes -------------------------------------------------------------------------------------------------------- */
+
+#include <efat.h>
+#include "ef_prv_def.h"
+#include "ef_prv_file.h"
+#include "ef_prv_lock.h"
+#include "ef_prv_validate.h"
+
+#if ( 0 != EF_CONF_FILE_DIGEST )
+
+/* Local constant macros ------------------------------------------------------------------------------------------- */
+/* Local function macros ------------------------------------------------------------------------------------------- */
+/* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
+/* Local variables ------------------------------------------------------------------------------------------------- */
+/* Public variables ------------------------------------------------------------------------------------------------ */
+/* Local function prototypes---------------------------------------------------------------------------------------- */
+/* Local functions ------------------------------------------------------------------------------------------------- */
+/* Public functions ------------------------------------------------------------------------------------------------ */
+
+void vEFPrvFileDigest (
+  ef_file_st      * pxFile,
+  const ef_u08_t  * pu8Data,
+  ef_u32_t          u32Size
+)
+{
+  ef_u32_t  u32Skip;
+
+  /* If     no digest is attached
+   *     OR the bytes have all been digested already
+   *     OR they start past the digested ones
+   */
+  if (    ( 0 == pxFile->pxDigest )
+       || ( ( pxFile->u32FileOffset + u32Size ) <= pxFile->u32DigestOffset )
+       || ( pxFile->u32FileOffset > pxFile->u32DigestOffset ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else
+  {
+    /* Skip the bytes digested before a backward seek */
+    u32Skip = pxFile->u32DigestOffset - pxFile->u32FileOffset;
+    (*pxFile->pxDigest)( pxFile->pvDigestContext, pu8Data + u32Skip, u32Size - u32Skip );
+    pxFile->u32DigestOffset = pxFile->u32FileOffset + u32Size;
+  }
+}
+
+ef_return_et eEF_fdigest (
+  EF_FILE     * pxFile,
+  xFileDigest * pxFunc,
+  void        * pvContext
+)
+{
+  EF_ASSERT_PUBLIC( 0 != pxFile );
+
+  ef_return_et  eRetVal;
+  ef_fs_st    * pxFS;
+
+  /* If the file object is not valid */
+  if ( EF_RET_OK != eEFPrvValidateObject( &pxFile->xObject, &pxFS ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
+  }
+  else
+  {
+    eRetVal = EF_RET_OK;
+    pxFile->pxDigest        = pxFunc;
+    pxFile->pvDigestContext = pvContext;
+    /* The digest starts at the current file offset */
+    pxFile->u32DigestOffset = pxFile->u32FileOffset;
+    (void) eEFPrvFSUnlock( pxFS, eRetVal );
+  }
+
+  return eRetVal;
+}
+
+ef_return_et eEF_fdigest_offset (
+  EF_FILE   * pxFile,
+  ef_u32_t  * pu32Offset
+)
+{
+  EF_ASSERT_PUBLIC( 0 != pxFile );
+  EF_ASSERT_PUBLIC( 0 != pu32Offset );
+
+  ef_return_et  eRetVal;
+  ef_fs_st    * pxFS;
+
+  /* If the file object is not valid */
+  if ( EF_RET_OK != eEFPrvValidateObject( &pxFile->xObject, &pxFS ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
+  }
+  else
+  {
+    eRetVal = EF_RET_OK;
+    *pu32Offset = pxFile->u32DigestOffset;
+    (void) eEFPrvFSUnlock( pxFS, eRetVal );
+  }
+
+  return eRetVal;
+}
+
+#endif /* ( 0 != EF_CONF_FILE_DIGEST ) */
+
+/* ***************************************************************************************************************** */
+/* END OF FILE ***************************************************************************************************** */
@@ -48,14 +48,330 @@
 #include "ef_prv_validate.h"
 #include "ef_prv_volume_nb.h"
 #include "ef_prv_volume.h"
+#include <ef_port_memory.h>
 
 /* Local constant macros ------------------------------------------------------------------------------------------- */
 /* Local function macros ------------------------------------------------------------------------------------------- */
 /* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
 /* Local variables ------------------------------------------------------------------------------------------------- */
+
+#if ( 0 != EF_CONF_SEEK_ZERO_FILL )
+/**
+ *  Zeroed sectors written over the data of an extended file, constant to stay out of RAM
+ */
+static const ef_u08_t u8SeekZeroes[ EF_CONF_SEEK_ZERO_FILL * EF_CONF_SECTOR_SIZE ] = { 0 };
+#endif
+
 /* Public variables ------------------------------------------------------------------------------------------------ */
 /* Local function prototypes---------------------------------------------------------------------------------------- */
+
+/**
+ *  @brief  Link the clusters missing to hold a new file size as one contiguous run
+ *
+ *  When no free run is large enough, or in bounded latency write mode, nothing is linked and the seek stretches the
+ *  chain cluster by cluster.
+ *
+ *  @param  pxFile  Pointer to the file object
+ *  @param  pxFS    Pointer to the file system object
+ *  @param  u32Size New size of the file
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       Success
+ *  @retval EF_RET_INT_ERR  Accessing the FAT failed
+ */
+static ef_return_et eEFPrvFileChainGrow (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ef_u32_t      u32Size
+);
+
+#if ( 0 != EF_CONF_SEEK_ZERO_FILL )
+/**
+ *  @brief  Clear a run of contiguous sectors of a file
+ *
+ *  The drive clears them itself when it implements CTRL_WRITE_ZEROES, else zeroed sectors are written.
+ *
+ *  @param  pxFile    Pointer to the file object
+ *  @param  pxFS      Pointer to the file system object
+ *  @param  xSector   First sector of the run
+ *  @param  u32Count  Number of sectors of the run
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       Success
+ *  @retval EF_RET_DISK_ERR Writing the sectors failed
+ */
+static ef_return_et eEFPrvFileSectorsZero (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ef_lba_t      xSector,
+  ef_u32_t      u32Count
+);
+
+/**
+ *  @brief  Clear the data of a file between two offsets
+ *
+ *  The sector holding the first byte is cleared in the file window, the following ones a run of contiguous
+ *  sectors at a time.
+ *
+ *  @param  pxFile    Pointer to the file object
+ *  @param  pxFS      Pointer to the file system object
+ *  @param  u32From   Offset of the first byte to clear
+ *  @param  u32To     Offset following the last byte to clear
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK       Success
+ *  @retval EF_RET_INT_ERR  Following the chain failed
+ *  @retval EF_RET_DISK_ERR Accessing the data failed
+ */
+static ef_return_et eEFPrvFileZeroFill (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ef_u32_t      u32From,
+  ef_u32_t      u32To
+);
+#endif
+
 /* Local functions ------------------------------------------------------------------------------------------------- */
+
+static ef_return_et eEFPrvFileChainGrow (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ef_u32_t      u32Size
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFile );
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u32_t      u32ClusterSize = (ef_u32_t) pxFS->u8ClstSize * EF_SECTOR_SIZE( pxFS );
+  ef_u32_t      u32Wanted = ( u32Size / u32ClusterSize ) + ( ( 0 != ( u32Size % u32ClusterSize ) ) ? 1 : 0 );
+  ef_u32_t      u32Cluster;
+  ef_u32_t      u32Count;
+  ef_u32_t      u32First;
+
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+  /* If in bounded latency write mode, the pool must stay at the end of the chain */
+  if ( 0 != pxFile->u32PoolSize )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if the end of the chain cannot be found */
+  else if ( EF_RET_OK != eEFPrvFileChainLast( pxFile, pxFS, &u32Cluster, &u32Count ) )
+#else
+  /* If the end of the chain cannot be found */
+  if ( EF_RET_OK != eEFPrvFileChainLast( pxFile, pxFS, &u32Cluster, &u32Count ) )
+#endif
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  /* Else, if the chain is already long enough, reserved clusters for example */
+  else if ( u32Count >= u32Wanted )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if no free run is large enough, or the FAT cannot be read */
+  else if ( EF_RET_OK != ( eRetVal = eEFPrvFATFreeExtentFind( pxFS, u32Wanted - u32Count, u32Cluster, &u32First ) ) )
+  {
+    eRetVal = ( EF_RET_DENIED == eRetVal ) ? EF_RET_OK : EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  /* Else, if linking the run at the end of the chain failed */
+  else if ( EF_RET_OK != eEFPrvFATChainLink( pxFS, u32Cluster, u32First, u32Wanted - u32Count ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  else
+  {
+    /* If the file had no cluster */
+    if ( 0 == u32Cluster )
+    {
+      pxFile->xObject.u32ClstStart = u32First;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    pxFile->u8StatusFlags |= EF_FILE_MODIFIED;
+  }
+
+  return eRetVal;
+}
+
+#if ( 0 != EF_CONF_SEEK_ZERO_FILL )
+static ef_return_et eEFPrvFileSectorsZero (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ef_lba_t      xSector,
+  ef_u32_t      u32Count
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFile );
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u32_t      u32Chunk = sizeof( u8SeekZeroes ) / EF_SECTOR_SIZE( pxFS );
+  ef_u32_t      u32Nb;
+  ef_lba_t      xRange[ 2 ];
+
+  /* The window must not write its former data back over the cleared sectors */
+  if ( ( pxFile->xSector >= xSector ) && ( pxFile->xSector < ( xSector + u32Count ) ) )
+  {
+    pxFile->u8StatusFlags &= (ef_u08_t) ~EF_FILE_WIN_DIRTY;
+    pxFile->xSector = 0;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  xRange[ 0 ] = xSector;
+  xRange[ 1 ] = xSector + u32Count - 1;
+  /* If the drive clears the sectors itself */
+  if ( EF_RET_OK == eEFPrvDriveIOCtrl( pxFS->u8PhysDrv, CTRL_WRITE_ZEROES, xRange ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else
+  {
+    while ( ( EF_RET_OK == eRetVal ) && ( 0 != u32Count ) )
+    {
+      u32Nb = ( u32Count < u32Chunk ) ? u32Count : u32Chunk;
+      if ( EF_RET_OK != eEFPrvDriveWrite( pxFS->u8PhysDrv, u8SeekZeroes, xSector, u32Nb ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+      }
+      else
+      {
+        xSector  += u32Nb;
+        u32Count -= u32Nb;
+      }
+    }
+  }
+
+  return eRetVal;
+}
+
+static ef_return_et eEFPrvFileZeroFill (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ef_u32_t      u32From,
+  ef_u32_t      u32To
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFile );
+  EF_ASSERT_PRIVATE( 0 != pxFS );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u32_t      u32SectorSize = EF_SECTOR_SIZE( pxFS );
+  ef_u32_t      u32ClusterSize = (ef_u32_t) pxFS->u8ClstSize * u32SectorSize;
+  ef_u32_t      u32Cluster = pxFile->xObject.u32ClstStart;
+  ef_u32_t      u32ClusterIndex = u32From / u32ClusterSize;
+  ef_u32_t      u32Offset = u32From;
+  ef_u32_t      u32Index;
+  ef_u32_t      u32Nb;
+  ef_u32_t      u32Left;
+  ef_u32_t      u32RunNb = 0;
+  ef_lba_t      xRunSector = 0;
+  ef_lba_t      xSector;
+
+  /* Find the cluster holding the first byte to clear */
+  for ( u32Index = u32ClusterIndex ; ( EF_RET_OK == eRetVal ) && ( 0 != u32Index ) ; u32Index-- )
+  {
+    if (    ( EF_RET_OK != eEFPrvFATGet( pxFS, u32Cluster, &u32Cluster ) )
+         || ( EF_RET_OK != eEFPrvFATClusterNbCheck( pxFS->u32FatEntriesNb, u32Cluster ) ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+
+  /* If the first byte is inside a sector, the end of the sector is cleared in the window */
+  if ( ( EF_RET_OK != eRetVal ) || ( 0 == ( u32From % u32SectorSize ) ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEFPrvFATClusterToSector( pxFS, u32Cluster, &xSector ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  else if ( EF_RET_OK != eEFPrvFileWindowUpdate(   pxFile,
+                                                   pxFS,
+                                                   xSector + ( ( u32From % u32ClusterSize ) / u32SectorSize ) ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+  }
+  else
+  {
+    eEFPortMemZero( pxFile->u8Window + ( u32From % u32SectorSize ), u32SectorSize - ( u32From % u32SectorSize ) );
+    pxFile->u8StatusFlags |= EF_FILE_WIN_DIRTY;
+    u32Offset += u32SectorSize - ( u32From % u32SectorSize );
+  }
+
+  /* Clear the following sectors, the sectors of contiguous clusters are cleared together */
+  while ( ( EF_RET_OK == eRetVal ) && ( u32Offset < u32To ) )
+  {
+    /* If the offset enters the next cluster */
+    if ( ( u32Offset / u32ClusterSize ) != u32ClusterIndex )
+    {
+      u32ClusterIndex++;
+      if (    ( EF_RET_OK != eEFPrvFATGet( pxFS, u32Cluster, &u32Cluster ) )
+           || ( EF_RET_OK != eEFPrvFATClusterNbCheck( pxFS->u32FatEntriesNb, u32Cluster ) ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+    }
+    else if ( EF_RET_OK != eEFPrvFATClusterToSector( pxFS, u32Cluster, &xSector ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+    }
+    else
+    {
+      /* Sectors to clear in this cluster */
+      xSector += ( u32Offset % u32ClusterSize ) / u32SectorSize;
+      u32Nb    = ( u32ClusterSize - ( u32Offset % u32ClusterSize ) ) / u32SectorSize;
+      u32Left  = ( ( u32To - u32Offset - 1 ) / u32SectorSize ) + 1;
+      u32Nb    = ( u32Left < u32Nb ) ? u32Left : u32Nb;
+      /* If they follow the current run */
+      if ( ( 0 != u32RunNb ) && ( ( xRunSector + u32RunNb ) == xSector ) )
+      {
+        u32RunNb += u32Nb;
+      }
+      else
+      {
+        if ( 0 != u32RunNb )
+        {
+          eRetVal = eEFPrvFileSectorsZero( pxFile, pxFS, xRunSector, u32RunNb );
+        }
+        else
+        {
+          EF_CODE_COVERAGE( );
+        }
+        xRunSector = xSector;
+        u32RunNb = u32Nb;
+      }
+      u32Offset += u32Nb * u32SectorSize;
+    }
+  }
+  /* Clear the last run */
+  if ( ( EF_RET_OK == eRetVal ) && ( 0 != u32RunNb ) )
+  {
+    eRetVal = eEFPrvFileSectorsZero( pxFile, pxFS, xRunSector, u32RunNb );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  return eRetVal;
+}
+#endif
+
 /* Public functions ------------------------------------------------------------------------------------------------ */
 
 ef_return_et eEF_fseek (
@@ -68,6 +384,14 @@ ef_return_et eEF_fseek (
   ef_return_et  eRetVal = EF_RET_OK;
   ef_fs_st    * pxFS;
 
+#if ( 0 != EF_CONF_NON_BLOCKING )
+  /* If the non-blocking operation in progress on the file cannot be abandoned (its transfer is waited for) */
+  if ( EF_RET_OK != eEFPrvFileNbCancel( pxFile ) )
+  {
+    return EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+  }
+#endif
+
   /* If File object is not valid */
   if ( EF_RET_OK != eEFPrvValidateObject( &pxFile->xObject, &pxFS ) )
   {
@@ -99,6 +423,23 @@ ef_return_et eEF_fseek (
     ef_u32_t  u32ClusterNb;
     ef_lba_t  xSectorNb = 0;
     ef_u32_t  u32FileOffset = pxFile->u32FileOffset;
+#if ( 0 != EF_CONF_SEEK_ZERO_FILL )
+    ef_u32_t  u32SizeOld = pxFile->u32Size;
+#endif
+
+    /* If the file is extended, link the missing clusters in one step */
+    if (    ( 0 != ( EF_FILE_OPEN_WRITE & pxFile->u8StatusFlags ) )
+         && ( u32Offset > pxFile->u32Size )
+         && ( EF_RET_OK != eEFPrvFileChainGrow( pxFile, pxFS, u32Offset ) ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      (void) eEFPrvFSUnlock(pxFS, eRetVal);
+      return eRetVal;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
 
     pxFile->u32FileOffset = 0;
 
@@ -216,6 +557,20 @@ ef_return_et eEF_fseek (
       }
     }
 
+#if ( 0 != EF_CONF_SEEK_ZERO_FILL )
+    /* If the file has been extended, clear its new data */
+    if (    ( EF_RET_OK == eRetVal )
+         && ( pxFile->u32FileOffset > u32SizeOld )
+         && ( EF_RET_OK != eEFPrvFileZeroFill( pxFile, pxFS, u32SizeOld, pxFile->u32FileOffset ) ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DISK_ERR );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+#endif
+
     if ( EF_RET_OK != eRetVal )
     {
       EF_CODE_COVERAGE( );
@@ -77,22 +77,30 @@ ef_return_et eEF_getfree (
   }
   else
   {
-    ef_u32_t  u32ClusterCounter = 0;
-
     /* If u32ClstFreeNb is valid, return it without full FAT scan */
     if ( pxFS->u32ClstFreeNb <= ( pxFS->u32FatEntriesNb - 2 ) )
     {
       *pu32ClusterNb = pxFS->u32ClstFreeNb;
     }
+#if ( 0 != EF_CONF_LAZY_FREE_COUNT )
+    /* Else, if counting the part of the FAT left by eEF_getfree_slice() failed */
+    else if ( EF_RET_OK != eEFPrvFATFreeCountScan( pxFS, 0 ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+    }
     else
     {
-      ef_object_st  xObject;
+      *pu32ClusterNb = pxFS->u32ClstFreeNb;
+    }
+#else
+    else
+    {
+      ef_u32_t      u32ClusterCounter = 0;
 
       /* If filesystem is FAT12: Scan bit field FAT entries */
       if ( 0 != ( EF_FS_FAT12 & pxFS->u8FsType ) )
       {
         ef_u32_t  u32Status;
-        xObject.pxFS = pxFS;
 
         /* FAT12: Scan bit field FAT entries */
         for ( ef_u32_t u32Cluster = 2 ; u32Cluster < pxFS->u32FatEntriesNb ; u32Cluster++ )
@@ -151,11 +159,50 @@ ef_return_et eEF_getfree (
       /* FAT32: FSInfo is to be updated */
       pxFS->u8FsInfoFlags |= 1;
     }
+#endif
+  }
+
+  (void) eEFPrvFSUnlock( pxFS, eRetVal );
+  return eRetVal;
+}
+
+#if ( 0 != EF_CONF_LAZY_FREE_COUNT )
+ef_return_et eEF_getfree_slice (
+  const TCHAR * pxPath,
+  ef_u32_t      u32SectorsNb,
+  ef_u32_t    * pu32ClusterNb
+)
+{
+  EF_ASSERT_PUBLIC( 0 != pxPath );
+  EF_ASSERT_PUBLIC( 0 != pu32ClusterNb );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_fs_st    * pxFS;
+
+  /* Get logical drive, Return ptr to the pxFS object */
+  if ( EF_RET_OK != eEFPrvVolumeMountCheck( &pxPath, &pxFS ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+  }
+  /* Else, if counting the next FAT sectors failed */
+  else if ( EF_RET_OK != eEFPrvFATFreeCountScan( pxFS, u32SectorsNb ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
+  }
+  /* Else, if the whole FAT has been counted */
+  else if ( pxFS->u32ClstFreeNb <= ( pxFS->u32FatEntriesNb - 2 ) )
+  {
+    *pu32ClusterNb = pxFS->u32ClstFreeNb;
+  }
+  else
+  {
+    *pu32ClusterNb = 0xFFFFFFFF;
   }
 
   (void) eEFPrvFSUnlock( pxFS, eRetVal );
   return eRetVal;
 }
+#endif
 
 /* ***************************************************************************************************************** */
 /* END OF FILE ***************************************************************************************************** */
@@ -39,6 +39,7 @@
 #include <ef_prv_volume_mount.h>
 #include "ef_port_diskio.h"
 #include "ef_prv_def.h"
+#include "ef_prv_cwd.h"
 #include "ef_prv_directory.h"
 #include "ef_prv_dirfunc.h"
 #include "ef_prv_fs_window.h"
@@ -219,6 +220,21 @@ ef_return_et eEF_rename (
         {
           eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
         }
+        /* Else, if a directory was renamed */
+        else if ( 0 != ( EF_DIR_ATTRIB_BIT_DIRECTORY & buf[ EF_DIR_ATTRIBUTES ] ) )
+        {
+          ef_u32_t  u32Cluster;
+
+          /* Current directory path cache is stale if the directory is on it */
+          if ( EF_RET_OK != eEFPrvDirectoryClusterGet( pxFS, buf, &u32Cluster ) )
+          {
+            (void) eEFPrvCwdCacheInvalidate( pxFS );
+          }
+          else
+          {
+            (void) eEFPrvCwdCacheCheck( pxFS, u32Cluster );
+          }
+        }
         else
         {
           EF_CODE_COVERAGE( );
@@ -0,0 +1,288 @@
+/**
+ * ********************************************************************************************************************
+ *  @file     ef_reserve.c
+ *  @ingroup  group_eFAT_Public
+ *  @author   ChaN
+ *  @author   Emmanuel AMADIO
+ *  @version  V0.1
+ *  @brief    Reserve a contiguous extent for the future appends of a file
+ *
+ * ********************************************************************************************************************
+ *  eFAT - embedded FAT Filesystem module
+ * ********************************************************************************************************************
+ *
+ *  Copyright (C) 2021, Amadio Emmanuel, all right reserved.
+ *  Copyright (C) 2019, ChaN, all right reserved.
+ *
+ *  eFAT module is an open source software. Redistribution and use of eFAT in source and binary forms, with or without
+ *  modification, are permitted provided that the following condition is met:
+ *
+ *  Redistributions of source code must retain the above copyright notice, this condition and the following disclaimer.
+ *
+ *  This software is provided by the copyright holders and contributors "AS IS" and any warranties related to this
+ *  software are DISCLAIMED.
+ *  The copyright owners or contributors be NOT LIABLE for any damages caused by use of this software.
+ * ********************************************************************************************************************
+ */
+
+/* START OF FILE *************************************************************************************************** */
+/* ***************************************************************************************************************** */
+
+/* Includes -------------------------------------------------------------------------------------------------------- */
+
+#include <efat.h>
+#include <ef_prv_fat.h>
+#include "ef_prv_def.h"
+#include "ef_prv_file.h"
+#include "ef_prv_lock.h"
+#include "ef_prv_validate.h"
+
+/* Local constant macros ------------------------------------------------------------------------------------------- */
+/* Local function macros ------------------------------------------------------------------------------------------- */
+/* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
+/* Local variables ------------------------------------------------------------------------------------------------- */
+/* Public variables ------------------------------------------------------------------------------------------------ */
+/* Local function prototypes---------------------------------------------------------------------------------------- */
+/* Local functions ------------------------------------------------------------------------------------------------- */
+
+/* Public functions ------------------------------------------------------------------------------------------------ */
+
+ef_return_et eEFPrvFileChainLast (
+  ef_file_st  * pxFile,
+  ef_fs_st    * pxFS,
+  ef_u32_t    * pu32Cluster,
+  ef_u32_t    * pu32Count
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFile );
+  EF_ASSERT_PRIVATE( 0 != pu32Cluster );
+  EF_ASSERT_PRIVATE( 0 != pu32Count );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u32_t      u32ClusterSize = (ef_u32_t) pxFS->u8ClstSize * EF_SECTOR_SIZE( pxFS );
+  ef_u32_t      u32Value;
+
+  *pu32Cluster = 0;
+  *pu32Count = 0;
+  /* If the current cluster is known, it saves following the beginning of the chain */
+  if ( 0 != pxFile->u32FileOffset )
+  {
+    u32Value = pxFile->u32Clst;
+    *pu32Count = ( ( pxFile->u32FileOffset - 1 ) / u32ClusterSize );
+  }
+  else
+  {
+    u32Value = pxFile->xObject.u32ClstStart;
+  }
+  while ( ( EF_RET_OK == eRetVal ) && ( 2 <= u32Value ) && ( pxFS->u32FatEntriesNb > u32Value ) )
+  {
+    *pu32Cluster = u32Value;
+    (*pu32Count)++;
+    if ( EF_RET_OK != eEFPrvFATGet( pxFS, u32Value, &u32Value ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+
+  return eRetVal;
+}
+
+ef_return_et eEFPrvFileReserveRelease (
+  ef_file_st  * pxFile
+)
+{
+  EF_ASSERT_PRIVATE( 0 != pxFile );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_fs_st    * pxFS = pxFile->xObject.pxFS;
+  ef_u32_t      u32ClusterSize = (ef_u32_t) pxFS->u8ClstSize * EF_SECTOR_SIZE( pxFS );
+  ef_u32_t      u32Cluster;
+  ef_u32_t      u32Next = 0;
+  ef_u32_t      u32Count;
+
+  /* Find the cluster holding the last byte of the file */
+  if ( 0 == pxFile->u32Size )
+  {
+    /* The whole chain is reserved */
+    u32Cluster = 0;
+    u32Next = pxFile->xObject.u32ClstStart;
+  }
+  /* Else, if the current cluster holds it */
+  else if ( pxFile->u32FileOffset == pxFile->u32Size )
+  {
+    u32Cluster = pxFile->u32Clst;
+  }
+  else
+  {
+    /* Follow the chain from its beginning */
+    u32Cluster = pxFile->xObject.u32ClstStart;
+    u32Count = ( pxFile->u32Size - 1 ) / u32ClusterSize;
+    while ( ( EF_RET_OK == eRetVal ) && ( 0 != u32Count ) )
+    {
+      u32Count--;
+      if ( EF_RET_OK != eEFPrvFATGet( pxFS, u32Cluster, &u32Cluster ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      }
+      else if ( EF_RET_OK != eEFPrvFATClusterNbCheck( pxFS->u32FatEntriesNb, u32Cluster ) )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+    }
+  }
+
+  /* If following the chain failed */
+  if ( EF_RET_OK != eRetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if getting the cluster following the end of the file failed */
+  else if (    ( 0 != u32Cluster )
+            && ( EF_RET_OK != eEFPrvFATGet( pxFS, u32Cluster, &u32Next ) ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  /* Else, if there is no cluster past the end of the file */
+  else if ( EF_RET_OK != eEFPrvFATClusterNbCheck( pxFS->u32FatEntriesNb, u32Next ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  /* Else, if removing the clusters past the end of the file failed */
+  else if ( EF_RET_OK != eEFPrvFATChainRemove( &pxFile->xObject, u32Next, u32Cluster ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  else
+  {
+    /* If the whole chain has been removed */
+    if ( 0 == u32Cluster )
+    {
+      pxFile->xObject.u32ClstStart = 0;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    pxFile->u8StatusFlags |= EF_FILE_MODIFIED;
+  }
+#if ( 0 != EF_CONF_FILE_RESERVE )
+  pxFile->bReserved = EF_BOOL_FALSE;
+#endif
+
+  return eRetVal;
+}
+
+#if ( 0 != EF_CONF_FILE_RESERVE )
+ef_return_et eEF_reserve (
+  EF_FILE   * pxFile,
+  ef_u32_t    u32Bytes
+)
+{
+  EF_ASSERT_PUBLIC( 0 != pxFile );
+
+  ef_return_et  eRetVal;
+  ef_fs_st    * pxFS;
+  ef_u32_t      u32ClusterSize;
+  ef_u32_t      u32Wanted;
+  ef_u32_t      u32Cluster;
+  ef_u32_t      u32Count;
+  ef_u32_t      u32First = 0;
+
+  /* If the file object is not valid */
+  if ( EF_RET_OK != eEFPrvValidateObject( &pxFile->xObject, &pxFS ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
+    return eRetVal;
+  }
+
+  u32ClusterSize = (ef_u32_t) pxFS->u8ClstSize * EF_SECTOR_SIZE( pxFS );
+  /* If the file has been aborted */
+  if ( EF_RET_OK != (ef_return_et) pxFile->u8ErrorCode )
+  {
+    eRetVal = (ef_return_et) pxFile->u8ErrorCode;
+  }
+  /* Else, if access mode is not compatible */
+  else if ( 0 == ( pxFile->u8StatusFlags & EF_FILE_OPEN_WRITE ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+  }
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+  /* Else, if in bounded latency write mode, the pool already follows the end of the chain */
+  else if ( 0 != pxFile->u32PoolSize )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+  }
+#endif
+  /* Else, if releasing the reservation */
+  else if ( 0 == u32Bytes )
+  {
+    eRetVal = ( EF_BOOL_FALSE != pxFile->bReserved ) ? eEFPrvFileReserveRelease( pxFile ) : EF_RET_OK;
+  }
+  /* Else, if the file would grow past its size limit */
+  else if ( ( EF_FILE_SIZE_MAX - pxFile->u32Size ) < u32Bytes )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+  }
+  /* Else, if the end of the chain cannot be found */
+  else if ( EF_RET_OK != eEFPrvFileChainLast( pxFile, pxFS, &u32Cluster, &u32Count ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
+  }
+  else
+  {
+    /* Number of clusters holding the file and the reserved bytes */
+    u32Wanted = ( pxFile->u32Size / u32ClusterSize ) + ( u32Bytes / u32ClusterSize )
+              + ( ( ( pxFile->u32Size % u32ClusterSize ) + ( u32Bytes % u32ClusterSize ) + u32ClusterSize - 1 )
+                  / u32ClusterSize );
+    /* If the chain is long enough */
+    if ( u32Count >= u32Wanted )
+    {
+      eRetVal = EF_RET_OK;
+    }
+    else
+    {
+      /* The run is searched for from the end of the chain, it follows it when these clusters are free */
+      u32Wanted -= u32Count;
+      eRetVal = eEFPrvFATChainExtend( &pxFile->xObject, u32Cluster, EF_BOOL_FALSE, &u32Wanted, &u32First );
+      /* If no contiguous run is large enough */
+      if ( EF_RET_OK != eRetVal )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_DENIED );
+      }
+      /* Else, if the file had no cluster */
+      else if ( 0 == u32Cluster )
+      {
+        pxFile->xObject.u32ClstStart = u32First;
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+    }
+    /* If clusters have been linked past the end of the file */
+    if ( ( EF_RET_OK == eRetVal ) && ( 0 != u32First ) )
+    {
+      pxFile->bReserved = EF_BOOL_TRUE;
+      pxFile->u8StatusFlags |= EF_FILE_MODIFIED;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+
+  (void) eEFPrvFSUnlock( pxFS, eRetVal );
+  return eRetVal;
+}
+#endif /* ( 0 != EF_CONF_FILE_RESERVE ) */
+
+/* ***************************************************************************************************************** */
+/* END OF FILE ***************************************************************************************************** */
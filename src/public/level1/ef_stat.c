@@ -63,10 +63,16 @@ ef_return_et eEF_stat (
   ef_fs_st    * pxFS;
 
 
-  if ( EF_RET_OK != eEFPrvVolumeMountCheck( &pxPath, &pxFS ) )
+  if ( EF_RET_OK != eEFPrvVolumeMountCheckShared( &pxPath, &pxFS ) )
   {
     eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
   }
+  /* Else, if the filesystem window cannot be used */
+  else if ( EF_RET_OK != eEFPrvFSWindowLock( pxFS ) )
+  {
+    eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_TIMEOUT );
+    (void) eEFPrvFSUnlockShared( pxFS, EF_RET_OK );
+  }
   else
   {
     ef_directory_st xDir;
@@ -106,9 +112,10 @@ ef_return_et eEF_stat (
       EF_CODE_COVERAGE( );
     }
     EF_LFN_BUFFER_FREE();
+    (void) eEFPrvFSWindowUnlock( pxFS );
   }
 
-  (void) eEFPrvFSUnlock( pxFS, eRetVal );
+  (void) eEFPrvFSUnlockShared( pxFS, eRetVal );
   return eRetVal;
 }
 
@@ -33,6 +33,7 @@
 #include <efat.h>
 #include <ef_prv_fat.h>
 #include "ef_prv_def.h"
+#include "ef_prv_file.h"
 #include "ef_prv_lock.h"
 #include "ef_prv_validate.h"
 
@@ -56,6 +57,14 @@ ef_return_et eEF_truncate (
   ef_u32_t     ncl;
 
 
+#if ( 0 != EF_CONF_NON_BLOCKING )
+  /* Abandon the non-blocking operation in progress on the file (its transfer is waited for) */
+  eRetVal = eEFPrvFileNbCancel( pxFile );
+  if ( EF_RET_OK != eRetVal )
+  {
+    return eRetVal;
+  }
+#endif
   /* Check validity of the file object */
   eRetVal = eEFPrvValidateObject( &pxFile->xObject, &pxFS );
   if ( EF_RET_OK != eRetVal )
@@ -94,6 +103,11 @@ ef_return_et eEF_truncate (
         eRetVal = eEFPrvFATChainRemove( &pxFile->xObject, ncl, pxFile->u32Clst );
       }
     }
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+    /* The pool follows the end of the file, it has been removed with the chain */
+    pxFile->u32PoolNb = 0;
+    pxFile->u32PoolPrev = 0;
+#endif
     /* Set file size to current read/write point */
     pxFile->u32Size = pxFile->u32FileOffset;
     pxFile->u8StatusFlags |= EF_FILE_MODIFIED;
@@ -105,6 +119,14 @@ ef_return_et eEF_truncate (
     }
   }
 
+#if ( 0 != EF_CONF_FILE_RESERVE )
+  /* The reserved clusters past the new end of the file are released */
+  if ( EF_BOOL_FALSE != pxFile->bReserved )
+  {
+    eRetVal = eEFPrvFileReserveRelease( pxFile );
+  }
+#endif
+
   (void) eEFPrvFSUnlock( pxFS, eRetVal );
   return eRetVal;
 }
@@ -45,6 +45,12 @@
 #include "ef_prv_gpt.h"
 #include "ef_prv_lfn.h"
 #include "ef_prv_unicode.h"
+#include "ef_prv_validate.h"
+
+#if ( 0 == EF_CONF_VFAT ) || ( 0 == EF_CONF_STRF_ENCODING )
+  /* A fixed size memcpy() is the word access the compiler emits without breaking the aliasing rules */
+  #include <string.h>
+#endif
 
 #if (    ( 0 != EF_CONF_VFAT ) \
       && ( 0 != EF_CONF_STRF_ENCODING ) \
@@ -54,6 +60,10 @@
 #endif
 
 /* Local constant macros ------------------------------------------------------------------------------------------- */
+
+#define EF_STRF_LINE_WORD_ONES  ( (ef_u32_t) 0x01010101UL ) /**< One in each byte of a word */
+#define EF_STRF_LINE_WORD_HIGHS ( (ef_u32_t) 0x80808080UL ) /**< Top bit of each byte of a word */
+
 /* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
 
 /**
@@ -70,7 +80,12 @@ typedef struct {
   ef_u32_t    wi;
   ef_u32_t    ct;
 #endif
+#if ( 0 != EF_CONF_VFAT ) && ( 0 != EF_CONF_STRF_ENCODING )
   ef_u08_t buf[ 64 ];  /* Write buffer */
+#else
+  ef_u08_t *buf;      /* Characters put in place in the file window, from the file offset (0:none) */
+  int      size;      /* Room of buf[], up to the end of the sector of the window */
+#endif
 } putbuff;
 
 /* Local function macros ------------------------------------------------------------------------------------------- */
@@ -92,24 +107,53 @@ static  int putc_flush ( putbuff* pb );
 /* Initialize write buffer */
 static  void putc_init ( putbuff* pb, ef_file_st* pxFile );
 
+/* Buffered write of a run of characters */
+static  void putc_str ( putbuff* pb, const TCHAR* str, ef_u32_t n );
+
+/* Write the buffered characters to the file */
+static  void putc_drain ( putbuff* pb );
+
+#if ( 0 == EF_CONF_VFAT ) || ( 0 == EF_CONF_STRF_ENCODING )
+/* Point the buffer at the room left in the file window */
+static  void putc_window ( putbuff* pb );
+
+/* Buffered write of a run of bytes */
+static  void putc_run ( putbuff* pb, const ef_u08_t* data, ef_u32_t n );
+#endif
+
+#if ( 0 == EF_CONF_VFAT ) || ( 0 == EF_CONF_STRF_ENCODING )
+/**
+ *  @brief  Find the end of a line in a block of bytes
+ *
+ *  The bytes are scanned a word at a time once aligned.
+ *
+ *  @param  pu8Data   Pointer to the bytes to scan
+ *  @param  u32Count  Number of bytes to scan
+ *
+ *  @return Index of the first line feed, u32Count when there is none
+ */
+static ef_u32_t u32EFPrvStrfLineEnd (
+  const ef_u08_t  * pu8Data,
+  ef_u32_t          u32Count
+);
+#endif
+
 /* Local functions --------------------------------------------------------- */
 
+#if ( 0 != EF_CONF_VFAT ) && EF_CONF_STRF_ENCODING
 /* Buffered write with code conversion */
 static void putc_bfd (
     putbuff* pb,
     TCHAR c
 )
 {
-  ef_u32_t n;
   int       i;
   int       nc;
-#if ( 0 != EF_CONF_VFAT ) && EF_CONF_STRF_ENCODING
   ucs2_t hs;
   ucs2_t u16Char;
 #if EF_CONF_STRF_ENCODING == 2
   ef_u32_t dc;
   TCHAR *tp;
-#endif
 #endif
 
   if (    ( 0 != EF_CONF_CONVERT_LF_CRLF )
@@ -124,7 +168,6 @@ static void putc_bfd (
   if (i < 0) return;
   nc = pb->nchr;      /* Write unit counter */
 
-#if ( 0 != EF_CONF_VFAT ) && EF_CONF_STRF_ENCODING
 #if EF_CONF_STRF_ENCODING == 1    /* UTF-16 input */
   if (IsSurrogateH(c)) {  /* High surrogate? */
     pb->hs = c; return;  /* Save it for next */
@@ -221,36 +264,206 @@ static void putc_bfd (
   pb->buf[i++] = (ef_u08_t)u16Char;
 #endif
 
-#else                  /* ANSI/OEM input (without re-encoding) */
-  pb->buf[i++] = (ef_u08_t)c;
-#endif
-
+  pb->idx = i;
+  pb->nchr = nc + 1;
   if ( i >= (int)(sizeof pb->buf) - 4 )
   {
     /* Write buffered characters to the file */
-    eEF_fwrite( pb->pxFile, pb->buf, (ef_u32_t)i, &n );
-    i = (n == (ef_u32_t)i) ? 0 : -1;
+    putc_drain( pb );
   }
-  pb->idx = i;
-  pb->nchr = nc + 1;
 }
+#else
+/* Buffered write of a character (ANSI/OEM input without re-encoding) */
+static void putc_bfd (
+    putbuff* pb,
+    TCHAR c
+)
+{
+  putc_str( pb, &c, 1 );
+}
+#endif
 
+/* Buffered write of a run of characters */
+static void putc_str (
+  putbuff     * pb,
+  const TCHAR * str,
+  ef_u32_t      n
+)
+{
+#if ( 0 != EF_CONF_VFAT ) && EF_CONF_STRF_ENCODING
+  /* The code conversion goes character by character */
+  while ( 0 != n-- )
+  {
+    putc_bfd( pb, *str++ );
+  }
+#else
+  ef_u32_t  u32Run;
 
-/* Flush remaining characters in the buffer */
-static  int putc_flush (
+  while ( ( 0 <= pb->idx ) && ( 0 != n ) )
+  {
+    u32Run = n;
+#if ( 0 != EF_CONF_CONVERT_LF_CRLF )
+    /* The characters up to the next line feed go in one run */
+    u32Run = u32EFPrvStrfLineEnd( (const ef_u08_t *) str, n );
+    /* LF -> CRLF conversion */
+    if ( 0 == u32Run )
+    {
+      putc_run( pb, (const ef_u08_t *) "\r\n", 2 );
+      pb->nchr++;
+      u32Run = 1;
+    }
+    else
+#endif
+    {
+      putc_run( pb, (const ef_u08_t *) str, u32Run );
+    }
+    pb->nchr += (int) u32Run;
+    str += u32Run;
+    n -= u32Run;
+  }
+#endif
+}
+
+#if ( 0 != EF_CONF_VFAT ) && EF_CONF_STRF_ENCODING
+/* Write the buffered characters to the file */
+static void putc_drain (
   putbuff * pb
 )
 {
   ef_u32_t nw;
 
-/* Flush buffered characters to the file */
-  if (    ( 0 <= pb->idx )
-       && ( EF_RET_OK == eEF_fwrite( pb->pxFile, pb->buf, (ef_u32_t)pb->idx, &nw ) )
-       && ( nw == ( ef_u32_t)pb->idx ) )
+  if (    ( EF_RET_OK != eEF_fwrite( pb->pxFile, pb->buf, (ef_u32_t) pb->idx, &nw ) )
+       || ( nw != (ef_u32_t) pb->idx ) )
+  {
+    pb->idx = -1;
+  }
+  else
+  {
+    pb->idx = 0;
+  }
+}
+#else
+/* Write the characters put in the file window to the file */
+static void putc_drain (
+  putbuff * pb
+)
+{
+  ef_u32_t nw;
+
+  /* The bytes are in place, eEF_fwrite() only moves the file offset and the size on, and flags the window as dirty.
+   * It is written to the drive when the writes move to the next sector, one sector at a time. */
+  if ( ( 0 >= pb->idx ) || ( 0 == pb->buf ) )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if (    ( EF_RET_OK != eEF_fwrite( pb->pxFile, pb->buf, (ef_u32_t) pb->idx, &nw ) )
+            || ( nw != (ef_u32_t) pb->idx ) )
+  {
+    pb->idx = -1;
+  }
+  else
+  {
+    pb->idx = 0;
+  }
+  if ( 0 <= pb->idx )
+  {
+    putc_window( pb );
+  }
+}
+
+/* Point the buffer at the room left in the file window */
+static void putc_window (
+  putbuff * pb
+)
+{
+  ef_file_st  * pxFile = pb->pxFile;
+  ef_fs_st    * pxFS = pxFile->xObject.pxFS;
+  ef_u32_t      u32InSector;
+
+  pb->buf = 0;
+  pb->size = 0;
+  /* The window holds the sector of the file offset when the offset is inside it, the characters are put there. At a
+   * sector boundary the next run goes through eEF_fwrite(), which moves the window on. */
+  if (    ( 0 != pxFS )
+       && ( 0 != ( EF_FILE_OPEN_WRITE & pxFile->u8StatusFlags ) )
+       && ( 0 != pxFile->xSector ) )
+  {
+    u32InSector = pxFile->u32FileOffset % EF_SECTOR_SIZE( pxFS );
+    if ( 0 != u32InSector )
     {
-      return pb->nchr;
+      pb->buf = &pxFile->u8Window[ u32InSector ];
+      pb->size = (int) ( EF_SECTOR_SIZE( pxFS ) - u32InSector );
     }
-  return EF_EOF;
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+}
+
+/* Buffered write of a run of bytes */
+static void putc_run (
+  putbuff         * pb,
+  const ef_u08_t  * data,
+  ef_u32_t          n
+)
+{
+  ef_u32_t  nw;
+  ef_u32_t  u32Room;
+
+  while ( ( 0 <= pb->idx ) && ( 0 != n ) )
+  {
+    /* If there is no room in the window, the run is written: whole sectors go to the drive, the rest to the window */
+    if ( 0 == pb->buf )
+    {
+      if (    ( EF_RET_OK != eEF_fwrite( pb->pxFile, data, n, &nw ) )
+           || ( nw != n ) )
+      {
+        pb->idx = -1;
+      }
+      else
+      {
+        n = 0;
+        putc_window( pb );
+      }
+    }
+    else
+    {
+      u32Room = (ef_u32_t) ( pb->size - pb->idx );
+      u32Room = ( n < u32Room ) ? n : u32Room;
+      (void) eEFPortMemCopy( data, &pb->buf[ pb->idx ], u32Room );
+      pb->idx += (int) u32Room;
+      data += u32Room;
+      n -= u32Room;
+      /* If the sector is full */
+      if ( pb->idx >= pb->size )
+      {
+        putc_drain( pb );
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+    }
+  }
+}
+#endif
+
+/* Flush remaining characters in the buffer */
+static  int putc_flush (
+  putbuff * pb
+)
+{
+  /* Flush buffered characters to the file */
+  if ( 0 <= pb->idx )
+  {
+    putc_drain( pb );
+  }
+  return ( 0 <= pb->idx ) ? pb->nchr : EF_EOF;
 }
 
 /* Initialize write buffer */
@@ -259,13 +472,199 @@ static  void putc_init (
   ef_file_st  * pxFile
 )
 {
-  eEFPortMemZero( pb, sizeof (putbuff) );
+#if ( 0 != EF_CONF_VFAT ) && EF_CONF_STRF_ENCODING
+  /* The write buffer itself needs no clearing */
+  eEFPortMemZero( pb, (ef_u32_t) ( sizeof (putbuff) - sizeof pb->buf ) );
+  pb->pxFile = pxFile;
+#else
+  eEFPortMemZero( pb, (ef_u32_t) sizeof (putbuff) );
   pb->pxFile = pxFile;
+  putc_window( pb );
+#endif
 }
 
 
+#if ( 0 == EF_CONF_VFAT ) || ( 0 == EF_CONF_STRF_ENCODING )
+static ef_u32_t u32EFPrvStrfLineEnd (
+  const ef_u08_t  * pu8Data,
+  ef_u32_t          u32Count
+)
+{
+  ef_u32_t          u32Index = 0;
+  ef_u32_t          u32Word;
+  ef_bool_t         bFound = EF_BOOL_FALSE;
+
+  /* Head bytes up to a word boundary */
+  while (    ( EF_BOOL_FALSE == bFound )
+          && ( u32Index < u32Count )
+          && ( 0 != ( (ef_uptr_t) &pu8Data[ u32Index ] & ( sizeof( ef_u32_t ) - 1 ) ) ) )
+  {
+    /* If the line feed is found */
+    if ( '\n' == pu8Data[ u32Index ] )
+    {
+      bFound = EF_BOOL_TRUE;
+    }
+    else
+    {
+      u32Index++;
+    }
+  }
+  /* Whole words, a word holding a line feed has a null byte once XORed with line feeds */
+  while ( ( EF_BOOL_FALSE == bFound ) && ( sizeof( ef_u32_t ) <= ( u32Count - u32Index ) ) )
+  {
+    (void) memcpy( &u32Word, &pu8Data[ u32Index ], sizeof( u32Word ) );
+    u32Word ^= EF_STRF_LINE_WORD_ONES * '\n';
+    if ( 0 != ( ( u32Word - EF_STRF_LINE_WORD_ONES ) & ~u32Word & EF_STRF_LINE_WORD_HIGHS ) )
+    {
+      break;
+    }
+    u32Index += sizeof( ef_u32_t );
+  }
+  /* Remaining bytes, or the word holding the line feed */
+  while ( ( u32Index < u32Count ) && ( '\n' != pu8Data[ u32Index ] ) )
+  {
+    u32Index++;
+  }
+
+  return u32Index;
+}
+#endif
+
 /* Public functions ------------------------------------------------------------------------------------------------ */
 
+ef_return_et eEF_getline (
+  EF_FILE   * pxFile,
+  TCHAR     * pxBuffer,
+  ef_u32_t    u32Size,
+  ef_u32_t  * pu32Length
+)
+{
+  EF_ASSERT_PUBLIC( 0 != pxFile );
+  EF_ASSERT_PUBLIC( 0 != pxBuffer );
+  EF_ASSERT_PUBLIC( 0 != u32Size );
+  EF_ASSERT_PUBLIC( 0 != pu32Length );
+
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u32_t      u32Length = 0;
+
+#if ( 0 != EF_CONF_VFAT ) && ( 0 != EF_CONF_STRF_ENCODING )
+  /* The code conversion reads the line character by character */
+  if ( 0 != eEF_gets( pxBuffer, (int) u32Size, pxFile ) )
+  {
+    while ( 0 != pxBuffer[ u32Length ] )
+    {
+      u32Length++;
+    }
+  }
+  else
+  {
+    pxBuffer[ 0 ] = 0;
+  }
+#else
+  ef_u08_t    * pu8Line = (ef_u08_t *) pxBuffer;
+  ef_fs_st    * pxFS;
+  ef_u32_t      u32InSector;
+  ef_u32_t      u32Chunk;
+  ef_u32_t      u32Read = 0;
+  ef_u32_t      u32Index;
+  ef_bool_t     bEnd = EF_BOOL_FALSE;
+  /* The volume is locked as eEF_fread() does */
+  ef_bool_t     bShared = ( 0 == ( EF_FILE_OPEN_WRITE & pxFile->u8StatusFlags ) ) ? EF_BOOL_TRUE : EF_BOOL_FALSE;
+
+  /* Make a room for the terminator */
+  u32Size--;
+  while ( ( EF_RET_OK == eRetVal ) && ( EF_BOOL_FALSE == bEnd ) && ( u32Length < u32Size ) )
+  {
+    u32Chunk = u32Size - u32Length;
+    /* If the file object is not valid, its window cannot be looked at */
+    if (    ( EF_BOOL_TRUE == bShared )
+         && ( EF_RET_OK != eEFPrvValidateObjectShared( &pxFile->xObject, &pxFS ) ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
+    }
+    else if (    ( EF_BOOL_FALSE == bShared )
+              && ( EF_RET_OK != eEFPrvValidateObject( &pxFile->xObject, &pxFS ) ) )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INVALID_OBJECT );
+    }
+    else
+    {
+      /* If the file offset is inside a sector, the file window holds it: the line end is looked for in the
+       * window, then only the bytes up to it are read, from the window */
+      if ( 0 != ( pxFile->u32FileOffset % EF_SECTOR_SIZE( pxFS ) ) )
+      {
+        u32InSector = pxFile->u32FileOffset % EF_SECTOR_SIZE( pxFS );
+        u32Chunk = ( ( EF_SECTOR_SIZE( pxFS ) - u32InSector ) < u32Chunk ) ? ( EF_SECTOR_SIZE( pxFS ) - u32InSector ) : u32Chunk;
+        u32Chunk = ( ( pxFile->u32Size - pxFile->u32FileOffset ) < u32Chunk ) ? ( pxFile->u32Size - pxFile->u32FileOffset ) : u32Chunk;
+        u32Index = u32EFPrvStrfLineEnd( &pxFile->u8Window[ u32InSector ], u32Chunk );
+        u32Chunk = ( u32Index < u32Chunk ) ? ( u32Index + 1 ) : u32Chunk;
+      }
+      /* Else, at a sector boundary, reading the first byte loads the sector into the window */
+      else
+      {
+        u32Chunk = 1;
+      }
+      /* eEF_fread() takes the volume lock again */
+      if ( EF_BOOL_TRUE == bShared )
+      {
+        (void) eEFPrvFSUnlockShared( pxFS, EF_RET_OK );
+      }
+      else
+      {
+        (void) eEFPrvFSUnlock( pxFS, EF_RET_OK );
+      }
+      eRetVal = eEF_fread( pxFile, &pu8Line[ u32Length ], u32Chunk, &u32Read );
+    }
+    /* If reading failed */
+    if ( EF_RET_OK != eRetVal )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    /* Else, if the end of the file is reached */
+    else if ( 0 == u32Read )
+    {
+      bEnd = EF_BOOL_TRUE;
+    }
+    else
+    {
+      /* If the line ends with these bytes */
+      if ( '\n' == pu8Line[ u32Length + u32Read - 1 ] )
+      {
+        bEnd = EF_BOOL_TRUE;
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+#if ( 0 != EF_CONF_CONVERT_LF_CRLF )
+      /* Strip the carriage returns off */
+      u32Chunk = u32Read;
+      u32Read = u32Length;
+      for ( u32Index = u32Length ; u32Index < ( u32Length + u32Chunk ) ; u32Index++ )
+      {
+        if ( '\r' != pu8Line[ u32Index ] )
+        {
+          pu8Line[ u32Read++ ] = pu8Line[ u32Index ];
+        }
+        else
+        {
+          EF_CODE_COVERAGE( );
+        }
+      }
+      u32Length = u32Read;
+#else
+      u32Length += u32Read;
+#endif
+    }
+  }
+  /* Terminate the string */
+  pu8Line[ u32Length ] = 0;
+#endif
+  *pu32Length = u32Length;
+
+  return eRetVal;
+}
+
 /* Get a String from the File */
 TCHAR* eEF_gets (
   TCHAR       * buff,   /* Pointer to the buffer to store read string */
@@ -275,9 +674,11 @@ TCHAR* eEF_gets (
 {
   int       nc = 0;
   TCHAR *   p = buff;
-  ef_u08_t   s[4];
   ef_u32_t      rc;
+#if ( 0 != EF_CONF_VFAT ) && ( 0 != EF_CONF_STRF_ENCODING )
+  ef_u08_t   s[4];
   ef_u32_t  dc;
+#endif
 #if ( 0 != EF_CONF_VFAT ) && EF_CONF_STRF_ENCODING && EF_CONF_STRF_ENCODING <= 2
   ucs2_t u16Char;
 #endif
@@ -428,30 +829,20 @@ TCHAR* eEF_gets (
   }
 
 #else
-  /* Byte-by-byte read without any conversion (ANSI/OEM API) */
-  len -= 1;  /* Make a room for the terminator */
-  while ( nc < len )
+  /* Read without any conversion (ANSI/OEM API) */
+  if (    ( 0 < len )
+       && ( EF_RET_OK == eEF_getline( pxFile, buff, (ef_u32_t) len, &rc ) ) )
   {
-    /* Get a byte */
-    eEF_fread( pxFile, s, 1, &rc );
-    /* EF_EOF? */
-    if (rc != 1)
-      break;
-    dc = s[ 0 ];
-    if (    ( 0 != EF_CONF_CONVERT_LF_CRLF )
-         && ( '\r' == dc ) )
-    {
-      continue;
-    }
-    *p++ = (TCHAR)dc;
-    nc++;
-    if ( dc == '\n' )
-      break;
+    nc = (int) rc;
   }
+  p = buff + nc;
 #endif
 
   /* Terminate the string */
-  *p = 0;
+  if ( 0 < len )
+  {
+    *p = 0;
+  }
   /* When no data read due to EF_EOF or error, return with error. */
   return nc ? buff : 0;
 }
@@ -487,11 +878,10 @@ int eEF_putc (
 )
 {
   putbuff pb;
-  int iRetVal = -1;
 
   putc_init( &pb, pxFile );
   /* Put the character */
-  putc_bfd( &pb, c );
+  putc_str( &pb, &c, 1 );
   return putc_flush( &pb );
 }
 
@@ -507,15 +897,16 @@ int eEF_puts (
   ef_file_st  * pxFile  /* Pointer to the file object */
 )
 {
-  putbuff pb;
-
+  putbuff   pb;
+  ef_u32_t  n = 0;
 
   putc_init( &pb, pxFile );
-  while ( 0 != (*str) )
+  while ( 0 != str[ n ] )
   {
-    /* Put the string */
-    putc_bfd( &pb, *str++ );
+    n++;
   }
+  /* Put the string */
+  putc_str( &pb, str, n );
   return putc_flush( &pb );
 }
 
@@ -549,16 +940,18 @@ int eEF_printf (
 
   for (;;)
   {
+    /* Non escape characters */
+    for ( j = 0 ; ( 0 != u8Format[ j ] ) && ( '%' != u8Format[ j ] ) ; j++ )
+    {
+      ;
+    }
+    putc_str( &pb, u8Format, j );
+    u8Format += j;
     c = *u8Format++;
     if ( 0 == c )
     {
       break;      /* End of string */
     }
-    if ( '%' != c )
-    {        /* Non escape character */
-      putc_bfd(&pb, c);
-      continue;
-    }
     w = f = 0;
     c = *u8Format++;
     if ( '0' == c )
@@ -609,6 +1002,7 @@ int eEF_printf (
       {
         ;
       }
+      i = j;
       if ( 0 == ( 2 & f ) )
       {            /* Right padded */
         while ( j++ < w )
@@ -616,10 +1010,7 @@ int eEF_printf (
           putc_bfd( &pb, ' ' );
         }
       }
-      while ( 0 != *p )
-      {
-        putc_bfd( &pb, *p++ );    /* String body */
-      }
+      putc_str( &pb, p, i );    /* String body */
       while ( j++ < w )
       {
         putc_bfd( &pb, ' ' );  /* Left padded */
@@ -676,7 +1067,8 @@ int eEF_printf (
       v  = 0 - v;
       f |= 8;
     }
-    i = 0;
+    /* The numeral is built from its end */
+    i = sizeof(str) / sizeof (*str);
     do {
       d = (TCHAR)(v % r);
       v /= r;
@@ -691,13 +1083,13 @@ int eEF_printf (
           d += 0x07;
         }
       }
-      str[ i++ ] = d + '0';
-    } while ( ( 0 != v ) && ( i < ( sizeof(str) / sizeof (*str) ) ) );
+      str[ --i ] = d + '0';
+    } while ( ( 0 != v ) && ( 1 < i ) );
     if ( 0 != ( 8 & f ) )
     {
-      str[ i++ ] = '-';
+      str[ --i ] = '-';
     }
-    j = i;
+    j = ( sizeof(str) / sizeof (*str) ) - i;
     if ( 0 !=  ( 1 & f ) )
     {
       d = '0';
@@ -713,9 +1105,7 @@ int eEF_printf (
         putc_bfd( &pb, d );  /* Right pad */
       }
     }
-    do {
-      putc_bfd( &pb, str[ --i ] );      /* Number body */
-    } while ( 0 != i );
+    putc_str( &pb, &str[ i ], ( sizeof(str) / sizeof (*str) ) - i );      /* Number body */
     while ( j++ < w )
     {
       putc_bfd( &pb, d );    /* Left pad */
@@ -36,6 +36,7 @@
 #include <ef_prv_fat.h>
 #include <ef_prv_lfn.h>
 #include <ef_prv_volume_mount.h>
+#include "ef_prv_cwd.h"
 #include "ef_prv_directory.h"
 #include "ef_prv_lock.h"
 #include "ef_prv_path_follow.h"
@@ -77,8 +78,9 @@ ef_return_et eEF_chdir (
     {
       eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
     }
-    /* Else, if following file path failed */
-    else if ( EF_RET_OK != eEFPrvPathFollow( pxPath, &xDir, &bFound ) )
+    /* Else, if following file path failed, its segments are recorded in the current directory path cache */
+    else if (    ( EF_RET_OK != eEFPrvCwdCacheStart( pxFS, pxPath ) )
+              || ( EF_RET_OK != eEFPrvPathFollow( pxPath, &xDir, &bFound ) ) )
     {
       eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
     }
@@ -92,7 +94,7 @@ ef_return_et eEF_chdir (
       pxFS->u32DirClstCurrent = xDir.xObject.u32ClstStart;
     }
     /* Else, if it is not a sub-directory */
-    else if ( 0 != ( EF_DIR_ATTRIB_BIT_DIRECTORY & xDir.xObject.u8Attrib ) )
+    else if ( 0 == ( EF_DIR_ATTRIB_BIT_DIRECTORY & xDir.xObject.u8Attrib ) )
     {
       /* Reached but a file */
       eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_NO_PATH );
@@ -106,6 +108,7 @@ ef_return_et eEF_chdir (
     {
       EF_CODE_COVERAGE( );
     }
+    (void) eEFPrvCwdCacheEnd( pxFS, eRetVal );
     EF_LFN_BUFFER_FREE( );
   }
 
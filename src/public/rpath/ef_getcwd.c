@@ -51,6 +51,7 @@
 #include "ef_prv_volume_nb.h"
 #include "ef_prv_volume.h"
 #include "ef_port_diskio.h"
+#include "ef_prv_cwd.h"
 
 /* Local constant macros ------------------------------------------------------------------------------------------- */
 /* Local function macros ------------------------------------------------------------------------------------------- */
@@ -83,154 +84,56 @@ ef_return_et eEF_getcwd (
   }
   else
   {
-    ef_directory_st xDir;
-    ef_u32_t        i;
-    ef_u32_t        n;
-    ef_u32_t        ccl;
-    ef_file_info_st xFileInfo;
+    ef_u32_t  u32Size = len;
 
     EF_LFN_BUFFER_DEFINE
 
-    xDir.xObject.pxFS = pxFS;
+    /* Put drive prefix */
+    if ( EF_CONF_VOLUMES_NB >= 2 )
+    {
+      /* Numeric volume ID */
+      if ( len < 3 )
+      {
+        eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_NOT_ENOUGH_CORE );
+      }
+      else
+      {
+        int8_t  s8VolumeNb;
+        (void) eEFPrvVolumeNbCurrentGet( &s8VolumeNb );
+        *pxTempString++ = (TCHAR)'A' + s8VolumeNb;
+        *pxTempString++ = (TCHAR)':';
+        u32Size -= 2;
+      }
+    }
 
-    /* If LFN BUFFER initialization failed */
-    if ( EF_RET_OK != EF_LFN_BUFFER_SET( pxFS ) )
+    if ( EF_RET_OK != eRetVal )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    else if ( 0 == u32Size )
+    {
+      eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_NOT_ENOUGH_CORE );
+    }
+    /* Else, if LFN BUFFER initialization failed */
+    else if ( EF_RET_OK != EF_LFN_BUFFER_SET( pxFS ) )
     {
       eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
     }
     else
     {
-      /* Follow parent directories and create the pxPath */
-      i = len;      /* Bottom of pxStringer (directory stack base) */
-      /* Start to follow upper directory from current directory */
-      xDir.xObject.u32ClstStart = pxFS->u32DirClstCurrent;
-
-      /* Repeat while current directory is a sub-directory */
-      while ( 0 != ( xDir.xObject.u32ClstStart ) )
-      {
-        /* Get parent directory */
-        eRetVal = eEFPrvDirectoryIndexSet( &xDir, 1 * EF_DIR_ENTRY_SIZE );
-        if ( EF_RET_OK != eRetVal )
-        {
-          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
-          break;
-        }
-        eRetVal = eEFPrvFSWindowLoad( pxFS, xDir.xSector );
-        if ( EF_RET_OK != eRetVal )
-        {
-          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_ERROR );
-          break;
-        }
-        /* Goto parent directory */
-        //xDir.xObject.u32ClstStart = eEFPrvDirectoryClusterGet( pxFS, xDir.pu8Dir );
-        if ( EF_RET_OK != eEFPrvDirectoryClusterGet( pxFS, xDir.pu8Dir, &(xDir.xObject.u32ClstStart) ) )
-        {
-          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
-        }
-        eRetVal = eEFPrvDirectoryIndexSet( &xDir, 0 );
-        if ( EF_RET_OK != eRetVal )
-        {
-          break;
-        }
-        do {
-          ef_bool_t bEmpty = EF_BOOL_FALSE;
-          /* Find the entry links to the child directory */
-          eRetVal = eEFPrvDirRead( &xDir, &bEmpty );
-          if ( EF_RET_OK != eRetVal )
-          {
-            break;
-          }
-          else
-          {
-            ef_u32_t  u32Cluster;
-            if ( EF_RET_OK != eEFPrvDirectoryClusterGet( pxFS, xDir.pu8Dir, &u32Cluster ) )
-            {
-              eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
-            }
-            //if ( ccl == eEFPrvDirectoryClusterGet( pxFS, xDir.pu8Dir ) )
-            if ( ccl == u32Cluster )
-            {
-              break; /* Found the entry */
-            }
-          }
-          ef_bool_t     bStretched = EF_BOOL_FALSE;
-          ef_bool_t     bMoved = EF_BOOL_FALSE;
-          eRetVal = eEFPrvDirectoryIndexNext( &xDir, EF_BOOL_FALSE, &bStretched, &bMoved );
-        } while ( EF_RET_OK == eRetVal );
-
-        if  (EF_RET_NO_FILE == eRetVal )
-        {
-          /* It cannot be 'not found'. */
-          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_INT_ERR );
-        }
-        if ( EF_RET_OK != eRetVal )
-        {
-          break;
-        }
-        /* Get the directory name and push it to the pxStringer */
-        (void) eEFPrvDirFileInfosGet( &xDir, &xFileInfo );
-        /* Name length */
-        for ( n = 0 ; xFileInfo.xName[ n ] ; n++ ) ;
-        /* Insufficient space to store the path name? */
-        if ( i < ( n + 1 ) )
-        {
-          eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_NOT_ENOUGH_CORE );
-          break;
-        }
-        while ( 0 != n )
-        {
-          /* Stack the name */
-          pxString[ --i ] = xFileInfo.xName[ --n ];
-        }
-        pxString[ --i ] = '/';
-      }
-      if ( EF_RET_OK == eRetVal )
+      eRetVal = eEFPrvCwdCopy( pxFS, pxTempString, u32Size );
+      if ( EF_RET_OK != eRetVal )
       {
-        if ( i == len )
-        {
-          pxString[--i] = '/';  /* Is it the root-directory? */
-        }
-        if ( EF_CONF_VOLUMES_NB >= 2 )     /* Put drive prefix */
-        {
-          ef_u32_t vl = 0;
-          /* Numeric volume ID */
-          if ( i >= 3 )
-          {
-            int8_t  s8VolumeNb;
-            (void) eEFPrvVolumeNbCurrentGet( &s8VolumeNb );
-            *pxTempString++ = (TCHAR)'A' + s8VolumeNb;
-            *pxTempString++ = (TCHAR)':';
-            vl = 2;
-          }
-          if ( 0 == vl )
-          {
-            eRetVal = EF_RETURN_CODE_HANDLER( EF_RET_NOT_ENOUGH_CORE );
-          }
-          else
-          {
-            EF_CODE_COVERAGE( );
-          }
-
-        }
-        /* Add current directory pxPath */
-        if ( EF_RET_OK != eRetVal )
-        {
-          EF_CODE_COVERAGE( );
-        }
-        else
-        {
-          do
-          {
-            *pxTempString++ = pxString[ i++ ];
-          }
-          while ( i < len );  /* Copy stacked pxPath string */
-        }
+        eRetVal = EF_RETURN_CODE_HANDLER( eRetVal );
       }
     }
     EF_LFN_BUFFER_FREE();
   }
 
-  *pxTempString = 0;
+  if ( EF_RET_OK != eRetVal )
+  {
+    pxString[ 0 ] = 0;
+  }
 
   (void) eEFPrvFSUnlock( pxFS, eRetVal );
   return eRetVal;
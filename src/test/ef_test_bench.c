@@ -0,0 +1,1430 @@
+/**
+ * ********************************************************************************************************************
+ *  @file     ef_test_bench.c
+ *  @ingroup  GroupeFATTest
+ *  @author   Emmanuel AMADIO
+ *  @version  V0.1
+ *  @brief    Multi-threaded stress and scaling benchmark on RAM drives (host builds).
+ *
+ * ********************************************************************************************************************
+ *  eFAT - embedded FAT Filesystem module
+ * ********************************************************************************************************************
+ *
+ *  Copyright (C) 2021, Amadio Emmanuel, all right reserved.
+ *  Copyright (C) 2019, ChaN, all right reserved.
+ *
+ *  eFAT module is an open source software. Redistribution and use of eFAT in source and binary forms, with or without
+ *  modification, are permitted provided that the following condition is met:
+ *
+ *  Redistributions of source code must retain the above copyright notice, this condition and the following disclaimer.
+ *
+ *  This software is provided by the copyright holders and contributors "AS IS" and any warranties related to this
+ *  software are DISCLAIMED.
+ *  The copyright owners or contributors be NOT LIABLE for any damages caused by use of this software.
+ * ********************************************************************************************************************
+ */
+
+/* START OF FILE *************************************************************************************************** */
+/* ***************************************************************************************************************** */
+
+/* Includes -------------------------------------------------------------------------------------------------------- */
+#define _POSIX_C_SOURCE 200809L
+
+#include "efat.h"
+#include "efat_level3.h"
+#include "ef_prv_def.h"
+
+#if ( EF_DEF_PORT_SYSTEM_POSIX == EF_CONF_PORT_SYSTEM )
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <ef_port_load_store.h>
+#include <ef_port_memory.h>
+#include "ef_prv_def_bpb_fat.h"
+#include "ef_test_bench.h"
+
+/* Local constant macros ------------------------------------------------------------------------------------------- */
+
+#define EF_TEST_BENCH_SECTOR_SIZE     ( 512 )   /**< Sector size of the RAM drives */
+#define EF_TEST_BENCH_FAT16_CLST_MIN  ( 4085 )  /**< Minimum number of clusters of a FAT16 volume */
+#define EF_TEST_BENCH_FAT32_CLST_MIN  ( 65525 ) /**< Minimum number of clusters of a FAT32 volume */
+#define EF_TEST_BENCH_PATH_SIZE       ( 24 )    /**< Size of the file path buffers */
+#define EF_TEST_BENCH_MEM_SIZE        ( 512 )   /**< Size of the blocks handled by the memory benchmark */
+#define EF_TEST_BENCH_MEM_CHECK       ( 72 )    /**< Largest block checked at each misalignment */
+#define EF_TEST_BENCH_FIELDS_SIZE     ( 4096 )  /**< Size of the buffer the load and store benchmark goes through */
+
+/* Local function macros ------------------------------------------------------------------------------------------- */
+
+/**
+ *  Drive functions of the RAM drive n, the drive functions do not get the physical drive number
+ */
+#define EF_TEST_BENCH_RAM_DRIVE_DEFINE( n )                                                                           \
+  static ef_return_et eTestBenchRamInitialize##n ( void )                                                             \
+  { return eTestBenchRamInitialize( n ); }                                                                            \
+  static ef_return_et eTestBenchRamStatus##n ( void )                                                                 \
+  { return eTestBenchRamStatus( n ); }                                                                                \
+  static ef_return_et eTestBenchRamRead##n ( ef_u08_t * pu8Buffer, ef_lba_t xSector, ef_u32_t u32Count )              \
+  { return eTestBenchRamRead( n, pu8Buffer, xSector, u32Count ); }                                                    \
+  static ef_return_et eTestBenchRamWrite##n ( const ef_u08_t * pu8Buffer, ef_lba_t xSector, ef_u32_t u32Count )       \
+  { return eTestBenchRamWrite( n, pu8Buffer, xSector, u32Count ); }                                                   \
+  static ef_return_et eTestBenchRamCtrl##n ( ef_u08_t u8Cmd, void * pvBuffer )                                        \
+  { return eTestBenchRamCtrl( n, u8Cmd, pvBuffer ); }
+
+/* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
+
+/**
+ *  @brief  Benchmarked operations (ef_test_bench_op_et)
+ */
+typedef enum {
+  EF_TEST_BENCH_OP_OPEN_WRITE = 0,  /**< eEF_fopen() to create the file */
+  EF_TEST_BENCH_OP_WRITE,           /**< eEF_fwrite() of a chunk */
+  EF_TEST_BENCH_OP_SYNC,            /**< eEF_fsync() of the written file */
+  EF_TEST_BENCH_OP_CLOSE,           /**< eEF_fclose() */
+  EF_TEST_BENCH_OP_OPEN_READ,       /**< eEF_fopen() to read the file */
+  EF_TEST_BENCH_OP_READ,            /**< eEF_fread() of a chunk */
+  EF_TEST_BENCH_OP_REMOVE,          /**< eEF_remove() of the file */
+  EF_TEST_BENCH_OP_NB               /**< Number of benchmarked operations */
+} ef_test_bench_op_et;
+
+/**
+ *  @brief  Benchmark thread context structure (ef_test_bench_thread_st)
+ */
+typedef struct ef_test_bench_thread_struct {
+  pthread_t                       xThread;                                  /**< Thread identifier */
+  ef_u32_t                        u32Index;                                 /**< Thread index */
+  const ef_test_bench_config_st * pxConfig;                                 /**< Benchmark configuration */
+  ef_u08_t                      * pu8Buffer;                                /**< Chunk buffer */
+  ef_u32_t                      * pu32Samples[ EF_TEST_BENCH_OP_NB ];       /**< Latencies in nanoseconds */
+  ef_u32_t                        u32SamplesNb[ EF_TEST_BENCH_OP_NB ];      /**< Number of latencies recorded */
+  ef_u64_t                        u64Bytes;                                 /**< Number of bytes written and read */
+  ef_return_et                    eFailure;                                 /**< Return code of the failed operation */
+  int32_t                         s32Result;                                /**< Failure Id (0: none) */
+} ef_test_bench_thread_st;
+
+/* Local variables ------------------------------------------------------------------------------------------------- */
+
+/**
+ *  Names of the benchmarked operations
+ */
+static const char * const pcTestBenchOpNames[ EF_TEST_BENCH_OP_NB ] = {
+  "open(w)", "write", "sync", "close", "open(r)", "read", "remove"
+};
+
+/**
+ *  RAM drives storage
+ */
+static ef_u08_t * pu8TestBenchRam[ EF_TEST_BENCH_DRIVES_NB ];
+
+/**
+ *  RAM drives size in sectors
+ */
+static ef_u32_t u32TestBenchRamSectors[ EF_TEST_BENCH_DRIVES_NB ];
+
+/**
+ *  Emulated drive access time in microseconds
+ */
+static ef_u32_t u32TestBenchRamLatency;
+
+/**
+ *  Number of read commands and of discontiguous read extents of the RAM drives
+ */
+static ef_u32_t u32TestBenchRamReads;
+static ef_u32_t u32TestBenchRamExtents;
+
+/**
+ *  Sector following the last data area read of the RAM drives
+ */
+static ef_lba_t xTestBenchRamReadNext;
+
+/**
+ *  Guard of the read counters of the RAM drives, updated by all the benchmark threads
+ */
+static pthread_mutex_t xTestBenchRamCountMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ *  First sector of the data area of the RAM drives, set by eTestBenchRamFormat()
+ */
+static ef_lba_t xTestBenchRamDataBase[ EF_TEST_BENCH_DRIVES_NB ];
+
+/**
+ *  RAM drives are registered
+ */
+static ef_bool_t bTestBenchRamRegistered = EF_BOOL_FALSE;
+
+/**
+ *  Start line of the benchmark threads
+ */
+static pthread_barrier_t xTestBenchBarrier;
+
+#if ( 0 != EF_CONF_PORT_MEM_DMA )
+/**
+ *  Number of copies done by the DMA engine of the memory benchmark
+ */
+static ef_u32_t u32TestBenchDmaCopies;
+#endif
+
+/* Public variables ------------------------------------------------------------------------------------------------ */
+/* Local function prototypes---------------------------------------------------------------------------------------- */
+
+static ef_return_et eTestBenchRamInitialize ( ef_u08_t u8Drive );
+static ef_return_et eTestBenchRamStatus ( ef_u08_t u8Drive );
+static ef_return_et eTestBenchRamRead ( ef_u08_t u8Drive, ef_u08_t * pu8Buffer, ef_lba_t xSector, ef_u32_t u32Count );
+static ef_return_et eTestBenchRamWrite ( ef_u08_t u8Drive, const ef_u08_t * pu8Buffer, ef_lba_t xSector, ef_u32_t u32Count );
+static ef_return_et eTestBenchRamCtrl ( ef_u08_t u8Drive, ef_u08_t u8Cmd, void * pvBuffer );
+
+/**
+ *  @brief  Format a RAM drive as a single FAT16 or FAT32 volume without partition table, with eEF_mkfs() when it is
+ *          enabled
+ *
+ *  @param  u8Drive   RAM drive number
+ *
+ *  @return Operation result
+ *  @retval EF_RET_OK                 Success
+ *  @retval EF_RET_INVALID_PARAMETER  The drive size does not fit a FAT type enabled in ef_conf.h
+ *  @retval ...                       The error code of eEF_mkfs()
+ */
+static ef_return_et eTestBenchRamFormat (
+  ef_u08_t  u8Drive
+);
+
+/**
+ *  @brief  Benchmark thread: file cycles on the volume of the thread
+ *
+ *  @param  pvContext Pointer to the thread context (ef_test_bench_thread_st)
+ *
+ *  @return Always 0
+ */
+static void * pvTestBenchThread (
+  void * pvContext
+);
+
+/**
+ *  @brief  Get the nanoseconds elapsed since a monotonic time stamp (saturated to 32 bits)
+ *
+ *  @param  pxStart   Pointer to the time stamp
+ *
+ *  @return Elapsed time in nanoseconds
+ */
+static ef_u32_t u32TestBenchElapsed (
+  const struct timespec * pxStart
+);
+
+/**
+ *  @brief  Sort comparison of two latencies
+ *
+ *  @param  pvA   Pointer to the first latency
+ *  @param  pvB   Pointer to the second latency
+ *
+ *  @return <0, 0 or >0 as the first latency is lower, equal or greater
+ */
+static int iTestBenchCompare (
+  const void * pvA,
+  const void * pvB
+);
+
+/**
+ *  @brief  Print the latency percentiles of an operation over all the threads of a run
+ *
+ *  @param  pxThreads     Pointer to the thread contexts
+ *  @param  u32ThreadsNb  Number of threads
+ *  @param  eOp           Operation
+ *
+ *  @return Failure Id (0: none, 2: not enough memory)
+ */
+static int32_t s32TestBenchLatencyPrint (
+  ef_test_bench_thread_st * pxThreads,
+  ef_u32_t                  u32ThreadsNb,
+  ef_test_bench_op_et       eOp
+);
+
+/**
+ *  @brief  Print the metrics of a sync object
+ *
+ *  @param  pcName    Name of the sync object
+ *  @param  u8SyncId  Sync object identifier
+ */
+static void vTestBenchLockPrint (
+  const char  * pcName,
+  ef_u08_t      u8SyncId
+);
+
+/**
+ *  @brief  Run the benchmark with a number of threads
+ *
+ *  @param  pxConfig      Pointer to the benchmark configuration
+ *  @param  u32ThreadsNb  Number of threads
+ *
+ *  @return The test check Failure Id (see s32TestBenchConcurrency())
+ */
+static int32_t s32TestBenchRun (
+  const ef_test_bench_config_st * pxConfig,
+  ef_u32_t                        u32ThreadsNb
+);
+
+/**
+ *  @brief  Allocate the RAM drives and register them on the first call
+ *
+ *  @param  u8VolumesNb       Number of RAM drives to allocate
+ *  @param  u32VolumeSectors  Size of each RAM drive in sectors
+ *
+ *  @return Failure Id (0: none, 2: not enough memory, 3: registration failed)
+ */
+static int32_t s32TestBenchRamSetup (
+  ef_u08_t  u8VolumesNb,
+  ef_u32_t  u32VolumeSectors
+);
+
+#if ( 0 != EF_CONF_PORT_MEM_DMA )
+/**
+ *  @brief  DMA engine of the memory benchmark, it counts its copies and does them with the C library
+ */
+static ef_return_et eTestBenchMemCopyDma (
+  const void  * pvSrc,
+  void        * pvDst,
+  ef_u32_t      u32BytesNb
+);
+#endif
+
+/* Local functions ------------------------------------------------------------------------------------------------- */
+
+EF_TEST_BENCH_RAM_DRIVE_DEFINE( 0 )
+EF_TEST_BENCH_RAM_DRIVE_DEFINE( 1 )
+
+/**
+ *  Drive functions of the RAM drives
+ */
+static ef_drive_functions_st xTestBenchRamFunctions[ EF_TEST_BENCH_DRIVES_NB ] = {
+  {
+    .pxInitialize = eTestBenchRamInitialize0,
+    .pxStatus     = eTestBenchRamStatus0,
+    .pxRead       = eTestBenchRamRead0,
+    .pxWrite      = eTestBenchRamWrite0,
+    .pxCtrl       = eTestBenchRamCtrl0
+  },
+  {
+    .pxInitialize = eTestBenchRamInitialize1,
+    .pxStatus     = eTestBenchRamStatus1,
+    .pxRead       = eTestBenchRamRead1,
+    .pxWrite      = eTestBenchRamWrite1,
+    .pxCtrl       = eTestBenchRamCtrl1
+  }
+};
+
+/* Emulate the drive access time */
+static void vTestBenchRamWait (
+  void
+)
+{
+  struct timespec xDelay;
+
+  if ( 0 != u32TestBenchRamLatency )
+  {
+    xDelay.tv_sec   = u32TestBenchRamLatency / 1000000u;
+    xDelay.tv_nsec  = (long) ( u32TestBenchRamLatency % 1000000u ) * 1000;
+    (void) nanosleep( &xDelay, 0 );
+  }
+}
+
+/* Initialize a RAM drive */
+static ef_return_et eTestBenchRamInitialize (
+  ef_u08_t u8Drive
+)
+{
+  return ( 0 != pu8TestBenchRam[ u8Drive ] ) ? EF_RET_OK : EF_RET_DISK_NOINIT;
+}
+
+/* Get a RAM drive status */
+static ef_return_et eTestBenchRamStatus (
+  ef_u08_t u8Drive
+)
+{
+  return ( 0 != pu8TestBenchRam[ u8Drive ] ) ? EF_RET_OK : EF_RET_DISK_NOINIT;
+}
+
+/* Read sectors of a RAM drive */
+static ef_return_et eTestBenchRamRead (
+  ef_u08_t    u8Drive,
+  ef_u08_t  * pu8Buffer,
+  ef_lba_t    xSector,
+  ef_u32_t    u32Count
+)
+{
+  ef_return_et eRetVal = EF_RET_OK;
+
+  if ( ( xSector + u32Count ) > u32TestBenchRamSectors[ u8Drive ] )
+  {
+    eRetVal = EF_RET_DISK_PARERR;
+  }
+  else
+  {
+    vTestBenchRamWait( );
+    (void) pthread_mutex_lock( &xTestBenchRamCountMutex );
+    u32TestBenchRamReads++;
+    /* The FAT and directory reads do not break the extents of the data */
+    if ( xSector >= xTestBenchRamDataBase[ u8Drive ] )
+    {
+      u32TestBenchRamExtents += ( xSector != xTestBenchRamReadNext ) ? 1 : 0;
+      xTestBenchRamReadNext   = xSector + u32Count;
+    }
+    (void) pthread_mutex_unlock( &xTestBenchRamCountMutex );
+    (void) memcpy( pu8Buffer,
+                   pu8TestBenchRam[ u8Drive ] + ( (size_t) xSector * EF_TEST_BENCH_SECTOR_SIZE ),
+                   (size_t) u32Count * EF_TEST_BENCH_SECTOR_SIZE );
+  }
+
+  return eRetVal;
+}
+
+/* Write sectors of a RAM drive */
+static ef_return_et eTestBenchRamWrite (
+  ef_u08_t          u8Drive,
+  const ef_u08_t  * pu8Buffer,
+  ef_lba_t          xSector,
+  ef_u32_t          u32Count
+)
+{
+  ef_return_et eRetVal = EF_RET_OK;
+
+  if ( ( xSector + u32Count ) > u32TestBenchRamSectors[ u8Drive ] )
+  {
+    eRetVal = EF_RET_DISK_PARERR;
+  }
+  else
+  {
+    vTestBenchRamWait( );
+    (void) memcpy( pu8TestBenchRam[ u8Drive ] + ( (size_t) xSector * EF_TEST_BENCH_SECTOR_SIZE ),
+                   pu8Buffer,
+                   (size_t) u32Count * EF_TEST_BENCH_SECTOR_SIZE );
+  }
+
+  return eRetVal;
+}
+
+/* I/O control of a RAM drive */
+static ef_return_et eTestBenchRamCtrl (
+  ef_u08_t    u8Drive,
+  ef_u08_t    u8Cmd,
+  void      * pvBuffer
+)
+{
+  ef_return_et eRetVal = EF_RET_OK;
+
+  switch ( u8Cmd )
+  {
+    case CTRL_SYNC:
+    case CTRL_TRIM:
+      break;
+    case CTRL_WRITE_ZEROES:
+      (void) memset( pu8TestBenchRam[ u8Drive ] + ( (size_t) ( (ef_lba_t *) pvBuffer )[ 0 ] * EF_TEST_BENCH_SECTOR_SIZE ),
+                     0,
+                     (size_t) ( ( (ef_lba_t *) pvBuffer )[ 1 ] - ( (ef_lba_t *) pvBuffer )[ 0 ] + 1 )
+                     * EF_TEST_BENCH_SECTOR_SIZE );
+      break;
+    case GET_SECTOR_COUNT:
+      *(ef_u32_t *) pvBuffer = u32TestBenchRamSectors[ u8Drive ];
+      break;
+    case GET_SECTOR_SIZE:
+      *(ef_u16_t *) pvBuffer = EF_TEST_BENCH_SECTOR_SIZE;
+      break;
+    case GET_BLOCK_SIZE:
+      *(ef_u32_t *) pvBuffer = 1;
+      break;
+    default:
+      eRetVal = EF_RET_DISK_PARERR;
+      break;
+  }
+
+  return eRetVal;
+}
+
+#if ( 0 != EF_CONF_USE_MKFS )
+/* Format a RAM drive with eEF_mkfs() */
+static ef_return_et eTestBenchRamFormat (
+  ef_u08_t  u8Drive
+)
+{
+  /* One sector clusters, the FAT type fitting the drive, the data area is trimmed only */
+  static const ef_mkfs_param_st xParameters = {
+    .u8Format       = FM_FAT | FM_FAT32 | FM_SFD | FM_QUICK,
+    .u8FatsNb       = 2,
+    .u32DataAlign   = 1,
+    .u32RootDirNb   = 512,
+    .u32ClusterSize = EF_TEST_BENCH_SECTOR_SIZE
+  };
+  ef_return_et  eRetVal;
+  ef_u08_t    * pu8Ram = pu8TestBenchRam[ u8Drive ];
+  ef_u08_t      u8Work[ 8 * EF_TEST_BENCH_SECTOR_SIZE ];
+  ef_u32_t      u32FatSize;
+
+  eRetVal = eEF_mkfs( u8Drive, 0, &xParameters, u8Work, sizeof( u8Work ) );
+  if ( EF_RET_OK == eRetVal )
+  {
+    /* The data area follows the reserved sectors, the FATs and the root directory of the boot record */
+    u32FatSize = u16EFPortLoad( pu8Ram + EF_BS_BPB_FAT_OFFSET_FAT16_SIZE );
+    u32FatSize = ( 0 != u32FatSize ) ? u32FatSize : u32EFPortLoad( pu8Ram + EF_BS_EBPB_FAT32_OFFSET_FAT_SIZE );
+    xTestBenchRamDataBase[ u8Drive ] =   u16EFPortLoad( pu8Ram + EF_BS_BPB_FAT_OFFSET_SECTORS_RESERVED_NB )
+                                       + ( pu8Ram[ EF_BS_BPB_FAT_OFFSET_FATS_NB ] * u32FatSize )
+                                       + (   ( u16EFPortLoad( pu8Ram + EF_BS_BPB_FAT_OFFSET_ROOT_ENTRIES )
+                                             * EF_DIR_ENTRY_SIZE )
+                                           / EF_TEST_BENCH_SECTOR_SIZE );
+  }
+
+  return eRetVal;
+}
+#else
+/* Format a RAM drive */
+static ef_return_et eTestBenchRamFormat (
+  ef_u08_t  u8Drive
+)
+{
+  ef_return_et  eRetVal = EF_RET_OK;
+  ef_u08_t    * pu8Ram = pu8TestBenchRam[ u8Drive ];
+  ef_u32_t      u32Sectors = u32TestBenchRamSectors[ u8Drive ];
+  ef_u32_t      u32ClstSize;
+  ef_u32_t      u32Reserved;
+  ef_u32_t      u32RootSectors;
+  ef_u32_t      u32FatSize = 0;
+  ef_u32_t      u32ClstNb = 0;
+  ef_u32_t      u32EntrySize;
+  ef_bool_t     bFAT32 = EF_BOOL_FALSE;
+  ef_u08_t    * pu8Fat;
+
+  /* One sector clusters: FAT32 when the drive holds enough clusters, else FAT16 */
+  u32ClstSize = 1;
+  for ( ef_u32_t u32Type = 0 ; ( u32Type < 2 ) && ( EF_BOOL_FALSE == bFAT32 ) ; u32Type++ )
+  {
+    bFAT32          = ( 0 == u32Type ) ? EF_BOOL_TRUE : EF_BOOL_FALSE;
+    u32Reserved     = ( 0 == u32Type ) ? 32 : 1;
+    u32RootSectors  = ( 0 == u32Type ) ? 0 : ( 512 * EF_DIR_ENTRY_SIZE ) / EF_TEST_BENCH_SECTOR_SIZE;
+    u32EntrySize    = ( 0 == u32Type ) ? 4 : 2;
+    u32FatSize      = 0;
+    /* Converge the FAT size and the number of clusters */
+    for ( ef_u32_t i = 0 ; ( i < 4 ) && ( u32Sectors > ( u32Reserved + u32RootSectors + ( 2 * u32FatSize ) ) ) ; i++ )
+    {
+      u32ClstNb   = ( u32Sectors - u32Reserved - u32RootSectors - ( 2 * u32FatSize ) ) / u32ClstSize;
+      u32FatSize  = ( ( ( u32ClstNb + 2 ) * u32EntrySize ) + EF_TEST_BENCH_SECTOR_SIZE - 1 ) / EF_TEST_BENCH_SECTOR_SIZE;
+    }
+    u32ClstNb = 0;
+    if ( u32Sectors > ( u32Reserved + u32RootSectors + ( 2 * u32FatSize ) ) )
+    {
+      u32ClstNb = ( u32Sectors - u32Reserved - u32RootSectors - ( 2 * u32FatSize ) ) / u32ClstSize;
+    }
+    if ( ( EF_BOOL_FALSE != bFAT32 ) && ( EF_TEST_BENCH_FAT32_CLST_MIN > u32ClstNb ) )
+    {
+      bFAT32 = EF_BOOL_FALSE;
+    }
+  }
+
+  if (    ( EF_TEST_BENCH_FAT16_CLST_MIN > u32ClstNb )
+       || (    ( EF_BOOL_FALSE != bFAT32 )
+            && ( 0 == EF_FS_FAT32 ) )
+       || (    ( EF_BOOL_FALSE == bFAT32 )
+            && ( 0 == EF_FS_FAT16 ) ) )
+  {
+    eRetVal = EF_RET_INVALID_PARAMETER;
+  }
+  else
+  {
+    (void) memset( pu8Ram, 0, (size_t) ( u32Reserved + ( 2 * u32FatSize ) + u32RootSectors + u32ClstSize )
+                              * EF_TEST_BENCH_SECTOR_SIZE );
+    xTestBenchRamDataBase[ u8Drive ] = u32Reserved + ( 2 * u32FatSize ) + u32RootSectors;
+    /* Volume boot record */
+    pu8Ram[ EF_BS_OFFSET_JMP_INST + 0 ] = 0xEB;
+    pu8Ram[ EF_BS_OFFSET_JMP_INST + 1 ] = ( EF_BOOL_FALSE != bFAT32 ) ? 0x58 : 0x3C;
+    pu8Ram[ EF_BS_OFFSET_JMP_INST + 2 ] = 0x90;
+    (void) memcpy( pu8Ram + EF_BS_OFFSET_OEM_NAME, "EFATBNCH", 8 );
+    vEFPortStoreu16( pu8Ram + EF_BS_BPB_FAT_OFFSET_SECTOR_SIZE, EF_TEST_BENCH_SECTOR_SIZE );
+    pu8Ram[ EF_BS_BPB_FAT_OFFSET_CLUSTER_SIZE ] = (ef_u08_t) u32ClstSize;
+    vEFPortStoreu16( pu8Ram + EF_BS_BPB_FAT_OFFSET_SECTORS_RESERVED_NB, (ef_u16_t) u32Reserved );
+    pu8Ram[ EF_BS_BPB_FAT_OFFSET_FATS_NB ] = 2;
+    vEFPortStoreu16( pu8Ram + EF_BS_BPB_FAT_OFFSET_ROOT_ENTRIES,
+                     (ef_u16_t) ( ( u32RootSectors * EF_TEST_BENCH_SECTOR_SIZE ) / EF_DIR_ENTRY_SIZE ) );
+    pu8Ram[ EF_BS_BPB_FAT_OFFSET_MEDIA_DESCRIPTOR ] = 0xF8;
+    vEFPortStoreu16( pu8Ram + EF_BS_BPB_FAT_OFFSET_TRACK_SIZE, 63 );
+    vEFPortStoreu16( pu8Ram + EF_BS_BPB_FAT_OFFSET_HEADS_NB, 255 );
+    if ( 0x10000 > u32Sectors )
+    {
+      vEFPortStoreu16( pu8Ram + EF_BS_BPB_FAT_OFFSET_SECTORS_COUNT, (ef_u16_t) u32Sectors );
+    }
+    else
+    {
+      vEFPortStoreu32( pu8Ram + EF_BS_BPB_FAT_OFFSET_SECTORS_LARGE_COUNT, u32Sectors );
+    }
+    if ( EF_BOOL_FALSE != bFAT32 )
+    {
+      vEFPortStoreu32( pu8Ram + EF_BS_EBPB_FAT32_OFFSET_FAT_SIZE, u32FatSize );
+      vEFPortStoreu32( pu8Ram + EF_BS_EBPB_FAT32_OFFSET_ROOT_DIRECTORY_NB, 2 );
+      vEFPortStoreu16( pu8Ram + EF_BS_EBPB_FAT32_OFFSET_FS_INFO_SECTOR, 1 );
+      vEFPortStoreu16( pu8Ram + EF_BS_EBPB_FAT32_OFFSET_BACKUPBOOT_SECTOR, 6 );
+      pu8Ram[ EF_BS_EBPB_FAT32_OFFSET_DRIVE_NB ] = 0x80;
+      pu8Ram[ EF_BS_EBPB_FAT32_OFFSET_SIGNATURE ] = 0x29;
+      vEFPortStoreu32( pu8Ram + EF_BS_EBPB_FAT32_OFFSET_VOLUME_ID, 0x20210000u + u8Drive );
+      (void) memcpy( pu8Ram + EF_BS_EBPB_FAT32_OFFSET_VOLUME_LABEL, "NO NAME    FAT32   ", 19 );
+      /* FSINFO sector, free count and next free cluster unknown */
+      vEFPortStoreu32( pu8Ram + EF_TEST_BENCH_SECTOR_SIZE + EF_BS_FAT32_FSI_OFFSET_SIGNATURE_LEAD, 0x41615252 );
+      vEFPortStoreu32( pu8Ram + EF_TEST_BENCH_SECTOR_SIZE + EF_BS_FAT32_FSI_OFFSET_SIGNATURE_NEXT, 0x61417272 );
+      vEFPortStoreu32( pu8Ram + EF_TEST_BENCH_SECTOR_SIZE + EF_BS_FAT32_FSI_OFFSET_FREE_CLUSTERS, 0xFFFFFFFF );
+      vEFPortStoreu32( pu8Ram + EF_TEST_BENCH_SECTOR_SIZE + EF_BS_FAT32_FSI_OFFSET_CLUSTER_LAST_ALLOC, 0xFFFFFFFF );
+      vEFPortStoreu16( pu8Ram + EF_TEST_BENCH_SECTOR_SIZE + EF_BS_OFFSET_SIGNATURE, 0xAA55 );
+    }
+    else
+    {
+      vEFPortStoreu16( pu8Ram + EF_BS_BPB_FAT_OFFSET_FAT16_SIZE, (ef_u16_t) u32FatSize );
+      pu8Ram[ EF_BS_EBPB_FAT16_OFFSET_DRIVE_NB ] = 0x80;
+      pu8Ram[ EF_BS_EBPB_FAT16_OFFSET_SIGNATURE ] = 0x29;
+      vEFPortStoreu32( pu8Ram + EF_BS_EBPB_FAT16_OFFSET_VOLUME_ID, 0x20210000u + u8Drive );
+      (void) memcpy( pu8Ram + EF_BS_EBPB_FAT16_OFFSET_VOLUME_LABEL, "NO NAME    FAT16   ", 19 );
+    }
+    vEFPortStoreu16( pu8Ram + EF_BS_OFFSET_SIGNATURE, 0xAA55 );
+    if ( EF_BOOL_FALSE != bFAT32 )
+    {
+      /* Backup boot record */
+      (void) memcpy( pu8Ram + ( 6 * EF_TEST_BENCH_SECTOR_SIZE ), pu8Ram, 2 * EF_TEST_BENCH_SECTOR_SIZE );
+    }
+    /* Both FATs: media and end of chain entries, root directory cluster on FAT32 */
+    for ( ef_u32_t i = 0 ; i < 2 ; i++ )
+    {
+      pu8Fat = pu8Ram + ( (size_t) ( u32Reserved + ( i * u32FatSize ) ) * EF_TEST_BENCH_SECTOR_SIZE );
+      if ( EF_BOOL_FALSE != bFAT32 )
+      {
+        vEFPortStoreu32( pu8Fat + 0, 0x0FFFFFF8 );
+        vEFPortStoreu32( pu8Fat + 4, 0x0FFFFFFF );
+        vEFPortStoreu32( pu8Fat + 8, 0x0FFFFFFF );
+      }
+      else
+      {
+        vEFPortStoreu16( pu8Fat + 0, 0xFFF8 );
+        vEFPortStoreu16( pu8Fat + 2, 0xFFFF );
+      }
+    }
+  }
+
+  return eRetVal;
+}
+#endif
+
+#if ( 0 != EF_CONF_PORT_MEM_DMA )
+/* DMA engine of the memory benchmark */
+static ef_return_et eTestBenchMemCopyDma (
+  const void  * pvSrc,
+  void        * pvDst,
+  ef_u32_t      u32BytesNb
+)
+{
+  u32TestBenchDmaCopies++;
+  (void) memcpy( pvDst, pvSrc, u32BytesNb );
+
+  return EF_RET_OK;
+}
+#endif
+
+/* Get the nanoseconds elapsed since a monotonic time stamp */
+static ef_u32_t u32TestBenchElapsed (
+  const struct timespec * pxStart
+)
+{
+  struct timespec xNow;
+  ef_u64_t        u64Elapsed;
+
+  (void) clock_gettime( CLOCK_MONOTONIC, &xNow );
+  u64Elapsed = ( (ef_u64_t) ( xNow.tv_sec - pxStart->tv_sec ) * 1000000000u ) + (ef_u64_t) xNow.tv_nsec;
+  u64Elapsed -= (ef_u64_t) pxStart->tv_nsec;
+
+  return ( 0xFFFFFFFFu < u64Elapsed ) ? 0xFFFFFFFFu : (ef_u32_t) u64Elapsed;
+}
+
+/* Benchmark thread */
+static void * pvTestBenchThread (
+  void * pvContext
+)
+{
+  ef_test_bench_thread_st       * pxThread = (ef_test_bench_thread_st *) pvContext;
+  const ef_test_bench_config_st * pxConfig = pxThread->pxConfig;
+  EF_FILE                         xFile;
+  char                            cPath[ EF_TEST_BENCH_PATH_SIZE ];
+  struct timespec                 xStart;
+  ef_return_et                    eRetVal = EF_RET_OK;
+  ef_test_bench_op_et             eOp = EF_TEST_BENCH_OP_OPEN_WRITE;
+  ef_u32_t                        u32Done;
+  ef_u32_t                        u32Length;
+  ef_u32_t                        u32Offset;
+  ef_u32_t                        i;
+
+  (void) snprintf( cPath, sizeof( cPath ), "%c:/T%04u.BIN",
+                   'A' + (int) ( pxThread->u32Index % pxConfig->u8VolumesNb ),
+                   (unsigned) pxThread->u32Index );
+
+  (void) pthread_barrier_wait( &xTestBenchBarrier );
+
+  for ( ef_u32_t u32Cycle = 0 ; ( u32Cycle < pxConfig->u32CyclesNb ) && ( 0 == pxThread->s32Result ) ; u32Cycle++ )
+  {
+    /* Create and write the file */
+    eOp = EF_TEST_BENCH_OP_OPEN_WRITE;
+    (void) clock_gettime( CLOCK_MONOTONIC, &xStart );
+    eRetVal = eEF_fopen( &xFile, cPath, EF_FILE_OPEN_WRITE | EF_FILE_OPEN_ANYWAY | EF_FILE_OPEN_TRUNCATE );
+    pxThread->pu32Samples[ eOp ][ pxThread->u32SamplesNb[ eOp ]++ ] = u32TestBenchElapsed( &xStart );
+    for ( u32Offset = 0 ; ( EF_RET_OK == eRetVal ) && ( u32Offset < pxConfig->u32FileSize ) ; u32Offset += u32Length )
+    {
+      eOp = EF_TEST_BENCH_OP_WRITE;
+      u32Length = pxConfig->u32FileSize - u32Offset;
+      if ( u32Length > pxConfig->u32ChunkSize )
+      {
+        u32Length = pxConfig->u32ChunkSize;
+      }
+      for ( i = 0 ; i < u32Length ; i++ )
+      {
+        pxThread->pu8Buffer[ i ] = (ef_u08_t) ( ( pxThread->u32Index * 31 ) + ( u32Cycle * 7 ) + u32Offset + i );
+      }
+      (void) clock_gettime( CLOCK_MONOTONIC, &xStart );
+      eRetVal = eEF_fwrite( &xFile, pxThread->pu8Buffer, u32Length, &u32Done );
+      pxThread->pu32Samples[ eOp ][ pxThread->u32SamplesNb[ eOp ]++ ] = u32TestBenchElapsed( &xStart );
+      if ( ( EF_RET_OK == eRetVal ) && ( u32Done != u32Length ) )
+      {
+        eRetVal = EF_RET_DENIED;
+      }
+      pxThread->u64Bytes += u32Done;
+    }
+    if ( EF_RET_OK == eRetVal )
+    {
+      eOp = EF_TEST_BENCH_OP_SYNC;
+      (void) clock_gettime( CLOCK_MONOTONIC, &xStart );
+      eRetVal = eEF_fsync( &xFile );
+      pxThread->pu32Samples[ eOp ][ pxThread->u32SamplesNb[ eOp ]++ ] = u32TestBenchElapsed( &xStart );
+    }
+    if ( EF_RET_OK == eRetVal )
+    {
+      eOp = EF_TEST_BENCH_OP_CLOSE;
+      (void) clock_gettime( CLOCK_MONOTONIC, &xStart );
+      eRetVal = eEF_fclose( &xFile );
+      pxThread->pu32Samples[ eOp ][ pxThread->u32SamplesNb[ eOp ]++ ] = u32TestBenchElapsed( &xStart );
+    }
+
+    /* Read back and check the file */
+    if ( EF_RET_OK == eRetVal )
+    {
+      eOp = EF_TEST_BENCH_OP_OPEN_READ;
+      (void) clock_gettime( CLOCK_MONOTONIC, &xStart );
+      eRetVal = eEF_fopen( &xFile, cPath, EF_FILE_OPEN_EXISTING );
+      pxThread->pu32Samples[ eOp ][ pxThread->u32SamplesNb[ eOp ]++ ] = u32TestBenchElapsed( &xStart );
+    }
+    for ( u32Offset = 0 ; ( EF_RET_OK == eRetVal ) && ( u32Offset < pxConfig->u32FileSize ) ; u32Offset += u32Length )
+    {
+      eOp = EF_TEST_BENCH_OP_READ;
+      u32Length = pxConfig->u32FileSize - u32Offset;
+      if ( u32Length > pxConfig->u32ChunkSize )
+      {
+        u32Length = pxConfig->u32ChunkSize;
+      }
+      (void) clock_gettime( CLOCK_MONOTONIC, &xStart );
+      eRetVal = eEF_fread( &xFile, pxThread->pu8Buffer, u32Length, &u32Done );
+      pxThread->pu32Samples[ eOp ][ pxThread->u32SamplesNb[ eOp ]++ ] = u32TestBenchElapsed( &xStart );
+      if ( ( EF_RET_OK == eRetVal ) && ( u32Done != u32Length ) )
+      {
+        eRetVal = EF_RET_DENIED;
+      }
+      for ( i = 0 ; ( EF_RET_OK == eRetVal ) && ( i < u32Length ) ; i++ )
+      {
+        if ( pxThread->pu8Buffer[ i ] != (ef_u08_t) ( ( pxThread->u32Index * 31 ) + ( u32Cycle * 7 ) + u32Offset + i ) )
+        {
+          pxThread->s32Result = 7;
+          eRetVal = EF_RET_ERROR;
+        }
+      }
+      pxThread->u64Bytes += u32Done;
+    }
+    if ( EF_RET_OK == eRetVal )
+    {
+      eOp = EF_TEST_BENCH_OP_CLOSE;
+      (void) clock_gettime( CLOCK_MONOTONIC, &xStart );
+      eRetVal = eEF_fclose( &xFile );
+      pxThread->pu32Samples[ eOp ][ pxThread->u32SamplesNb[ eOp ]++ ] = u32TestBenchElapsed( &xStart );
+    }
+    if ( EF_RET_OK == eRetVal )
+    {
+      eOp = EF_TEST_BENCH_OP_REMOVE;
+      (void) clock_gettime( CLOCK_MONOTONIC, &xStart );
+      eRetVal = eEF_remove( cPath );
+      pxThread->pu32Samples[ eOp ][ pxThread->u32SamplesNb[ eOp ]++ ] = u32TestBenchElapsed( &xStart );
+    }
+
+    if ( EF_RET_OK != eRetVal )
+    {
+      if ( 0 == pxThread->s32Result )
+      {
+        pxThread->s32Result = 6;
+      }
+      pxThread->eFailure = eRetVal;
+      printf( "Thread %u: %s of %s failed (%d)\r\n",
+              (unsigned) pxThread->u32Index, pcTestBenchOpNames[ eOp ], cPath, (int) eRetVal );
+    }
+  }
+
+  return 0;
+}
+
+/* Sort comparison of two latencies */
+static int iTestBenchCompare (
+  const void * pvA,
+  const void * pvB
+)
+{
+  ef_u32_t u32A = *(const ef_u32_t *) pvA;
+  ef_u32_t u32B = *(const ef_u32_t *) pvB;
+
+  return ( u32A > u32B ) - ( u32A < u32B );
+}
+
+/* Print the latency percentiles of an operation */
+static int32_t s32TestBenchLatencyPrint (
+  ef_test_bench_thread_st * pxThreads,
+  ef_u32_t                  u32ThreadsNb,
+  ef_test_bench_op_et       eOp
+)
+{
+  ef_u32_t    u32SamplesNb = 0;
+  ef_u32_t  * pu32Samples;
+  ef_u32_t    t;
+
+  for ( t = 0 ; t < u32ThreadsNb ; t++ )
+  {
+    u32SamplesNb += pxThreads[ t ].u32SamplesNb[ eOp ];
+  }
+  if ( 0 == u32SamplesNb )
+  {
+    return 0;
+  }
+  pu32Samples = malloc( (size_t) u32SamplesNb * sizeof( ef_u32_t ) );
+  if ( 0 == pu32Samples )
+  {
+    return 2;
+  }
+  u32SamplesNb = 0;
+  for ( t = 0 ; t < u32ThreadsNb ; t++ )
+  {
+    (void) memcpy( pu32Samples + u32SamplesNb,
+                   pxThreads[ t ].pu32Samples[ eOp ],
+                   (size_t) pxThreads[ t ].u32SamplesNb[ eOp ] * sizeof( ef_u32_t ) );
+    u32SamplesNb += pxThreads[ t ].u32SamplesNb[ eOp ];
+  }
+  qsort( pu32Samples, u32SamplesNb, sizeof( ef_u32_t ), iTestBenchCompare );
+  printf( "  %-8s %9u %10.1f %10.1f %10.1f %10.1f\r\n",
+          pcTestBenchOpNames[ eOp ],
+          (unsigned) u32SamplesNb,
+          (double) pu32Samples[ ( u32SamplesNb * 50 ) / 100 ] / 1000.0,
+          (double) pu32Samples[ ( u32SamplesNb * 90 ) / 100 ] / 1000.0,
+          (double) pu32Samples[ ( u32SamplesNb * 99 ) / 100 ] / 1000.0,
+          (double) pu32Samples[ u32SamplesNb - 1 ] / 1000.0 );
+  free( pu32Samples );
+
+  return 0;
+}
+
+/* Print the metrics of a sync object */
+static void vTestBenchLockPrint (
+  const char  * pcName,
+  ef_u08_t      u8SyncId
+)
+{
+  ef_port_sync_stats_st xStats;
+
+  if ( EF_RET_OK == eEFPortSyncStatsGet( u8SyncId, &xStats ) )
+  {
+    printf( "  %-8s %9u %9u %9u %8u %10.1f %10.1f %10.1f %10.1f\r\n",
+            pcName,
+            (unsigned) xStats.u32TakeNb,
+            (unsigned) xStats.u32TakeSharedNb,
+            (unsigned) xStats.u32ContentionNb,
+            (unsigned) xStats.u32TimeoutNb,
+            ( 0 != xStats.u32ContentionNb ) ? (double) xStats.u64WaitTotal / xStats.u32ContentionNb : 0.0,
+            (double) xStats.u32WaitMax,
+            ( 0 != xStats.u32TakeNb ) ? (double) xStats.u64HoldTotal / xStats.u32TakeNb : 0.0,
+            (double) xStats.u32HoldMax );
+  }
+}
+
+/* Run the benchmark with a number of threads */
+static int32_t s32TestBenchRun (
+  const ef_test_bench_config_st * pxConfig,
+  ef_u32_t                        u32ThreadsNb
+)
+{
+  int32_t                   s32RetVal = 0;
+  ef_test_bench_thread_st * pxThreads;
+  ef_u32_t                  u32ChunksNb = ( pxConfig->u32FileSize + pxConfig->u32ChunkSize - 1 ) / pxConfig->u32ChunkSize;
+  ef_u32_t                  u32ThreadsStarted = 0;
+  ef_u64_t                  u64Bytes = 0;
+  double                    dElapsed;
+  struct timespec           xStart;
+  struct timespec           xEnd;
+  char                      cVolume[ 3 ] = "A:";
+  ef_u08_t                  v;
+  ef_u32_t                  t;
+  ef_u32_t                  o;
+
+  pxThreads = calloc( u32ThreadsNb, sizeof( ef_test_bench_thread_st ) );
+  if ( 0 == pxThreads )
+  {
+    return 2;
+  }
+  for ( t = 0 ; ( t < u32ThreadsNb ) && ( 0 == s32RetVal ) ; t++ )
+  {
+    pxThreads[ t ].u32Index   = t;
+    pxThreads[ t ].pxConfig   = pxConfig;
+    pxThreads[ t ].pu8Buffer  = malloc( pxConfig->u32ChunkSize );
+    s32RetVal = ( 0 == pxThreads[ t ].pu8Buffer ) ? 2 : 0;
+    for ( o = 0 ; ( o < EF_TEST_BENCH_OP_NB ) && ( 0 == s32RetVal ) ; o++ )
+    {
+      /* Close is recorded twice per cycle, write and read once per chunk */
+      pxThreads[ t ].pu32Samples[ o ] = malloc(   (size_t) pxConfig->u32CyclesNb * ( 2 + u32ChunksNb )
+                                                * sizeof( ef_u32_t ) );
+      s32RetVal = ( 0 == pxThreads[ t ].pu32Samples[ o ] ) ? 2 : 0;
+    }
+  }
+
+  /* Fresh volumes and metrics */
+  for ( v = 0 ; ( v < pxConfig->u8VolumesNb ) && ( 0 == s32RetVal ) ; v++ )
+  {
+    cVolume[ 0 ] = (char) ( 'A' + v );
+    if (    ( EF_RET_OK != eTestBenchRamFormat( v ) )
+         || ( EF_RET_OK != eEF_mount( cVolume, v, 0, 0 ) ) )
+    {
+      s32RetVal = 4;
+    }
+    else
+    {
+      (void) eEFPortSyncStatsReset( v );
+      (void) eEFPortSyncStatsReset( (ef_u08_t) EF_PORT_SYNC_WINDOW_ID( v ) );
+    }
+  }
+
+  if ( 0 == s32RetVal )
+  {
+    (void) pthread_barrier_init( &xTestBenchBarrier, 0, u32ThreadsNb + 1 );
+    for ( t = 0 ; ( t < u32ThreadsNb ) && ( 0 == s32RetVal ) ; t++ )
+    {
+      if ( 0 != pthread_create( &pxThreads[ t ].xThread, 0, pvTestBenchThread, &pxThreads[ t ] ) )
+      {
+        s32RetVal = 5;
+      }
+      else
+      {
+        u32ThreadsStarted++;
+      }
+    }
+    if ( 0 == s32RetVal )
+    {
+      (void) pthread_barrier_wait( &xTestBenchBarrier );
+      (void) clock_gettime( CLOCK_MONOTONIC, &xStart );
+      for ( t = 0 ; t < u32ThreadsStarted ; t++ )
+      {
+        (void) pthread_join( pxThreads[ t ].xThread, 0 );
+        u64Bytes += pxThreads[ t ].u64Bytes;
+        if ( 0 == s32RetVal )
+        {
+          s32RetVal = pxThreads[ t ].s32Result;
+        }
+      }
+      (void) clock_gettime( CLOCK_MONOTONIC, &xEnd );
+      dElapsed = (double) ( xEnd.tv_sec - xStart.tv_sec ) + ( (double) ( xEnd.tv_nsec - xStart.tv_nsec ) / 1e9 );
+
+      printf( "\r\n%u thread(s), %u volume(s): %.1f MB/s, %.0f cycles/s\r\n",
+              (unsigned) u32ThreadsNb,
+              (unsigned) pxConfig->u8VolumesNb,
+              ( (double) u64Bytes / ( 1024.0 * 1024.0 ) ) / dElapsed,
+              ( (double) u32ThreadsNb * pxConfig->u32CyclesNb ) / dElapsed );
+      printf( "  %-8s %9s %10s %10s %10s %10s\r\n", "op", "count", "p50[us]", "p90[us]", "p99[us]", "max[us]" );
+      for ( o = 0 ; ( o < EF_TEST_BENCH_OP_NB ) && ( 2 != s32RetVal ) ; o++ )
+      {
+        if ( 0 != s32TestBenchLatencyPrint( pxThreads, u32ThreadsNb, (ef_test_bench_op_et) o ) )
+        {
+          s32RetVal = 2;
+        }
+      }
+      if ( 0 != EF_CONF_PORT_SYNC_STATS )
+      {
+        printf( "  %-8s %9s %9s %9s %8s %10s %10s %10s %10s\r\n",
+                "lock", "excl", "shared", "contended", "timeout", "wait[us]", "wmax[us]", "hold[us]", "hmax[us]" );
+      }
+      for ( v = 0 ; ( 0 != EF_CONF_PORT_SYNC_STATS ) && ( v < pxConfig->u8VolumesNb ) ; v++ )
+      {
+        char cName[ 8 ] = "vol A";
+        cName[ 4 ] = (char) ( 'A' + v );
+        vTestBenchLockPrint( cName, v );
+        if ( 0 != EF_CONF_FS_LOCK_SHARED )
+        {
+          (void) memcpy( cName, "win A", 6 );
+          cName[ 4 ] = (char) ( 'A' + v );
+          vTestBenchLockPrint( cName, (ef_u08_t) EF_PORT_SYNC_WINDOW_ID( v ) );
+        }
+      }
+    }
+    else
+    {
+      /* Release the started threads waiting at the start line */
+      (void) pthread_barrier_wait( &xTestBenchBarrier );
+      for ( t = 0 ; t < u32ThreadsStarted ; t++ )
+      {
+        (void) pthread_join( pxThreads[ t ].xThread, 0 );
+      }
+    }
+    (void) pthread_barrier_destroy( &xTestBenchBarrier );
+  }
+
+  for ( v = 0 ; v < pxConfig->u8VolumesNb ; v++ )
+  {
+    cVolume[ 0 ] = (char) ( 'A' + v );
+    (void) eEF_umount( cVolume );
+  }
+  for ( t = 0 ; t < u32ThreadsNb ; t++ )
+  {
+    free( pxThreads[ t ].pu8Buffer );
+    for ( o = 0 ; o < EF_TEST_BENCH_OP_NB ; o++ )
+    {
+      free( pxThreads[ t ].pu32Samples[ o ] );
+    }
+  }
+  free( pxThreads );
+
+  return s32RetVal;
+}
+
+static int32_t s32TestBenchRamSetup (
+  ef_u08_t  u8VolumesNb,
+  ef_u32_t  u32VolumeSectors
+)
+{
+  int32_t   s32RetVal = 0;
+
+  for ( ef_u08_t v = 0 ; ( v < u8VolumesNb ) && ( 0 == s32RetVal ) ; v++ )
+  {
+    if ( u32TestBenchRamSectors[ v ] != u32VolumeSectors )
+    {
+      free( pu8TestBenchRam[ v ] );
+      pu8TestBenchRam[ v ]        = malloc( (size_t) u32VolumeSectors * EF_TEST_BENCH_SECTOR_SIZE );
+      u32TestBenchRamSectors[ v ] = ( 0 != pu8TestBenchRam[ v ] ) ? u32VolumeSectors : 0;
+      s32RetVal = ( 0 == pu8TestBenchRam[ v ] ) ? 2 : 0;
+    }
+  }
+  for ( ef_u08_t v = 0 ; ( v < EF_TEST_BENCH_DRIVES_NB ) && ( EF_BOOL_FALSE == bTestBenchRamRegistered ) && ( 0 == s32RetVal ) ; v++ )
+  {
+    if ( EF_RET_OK != eEF_drive_register( &xTestBenchRamFunctions[ v ] ) )
+    {
+      s32RetVal = 3;
+    }
+  }
+  bTestBenchRamRegistered = ( 0 == s32RetVal ) ? EF_BOOL_TRUE : bTestBenchRamRegistered;
+
+  return s32RetVal;
+}
+
+/* Public functions ------------------------------------------------------------------------------------------------ */
+
+int32_t s32TestBenchConcurrency (
+  const ef_test_bench_config_st * pxConfig
+)
+{
+  int32_t   s32RetVal = 0;
+  ef_u32_t  u32ThreadsMax;
+
+  if (    ( 0 == pxConfig )
+       || ( 0 == pxConfig->u8VolumesNb )
+       || ( EF_TEST_BENCH_DRIVES_NB < pxConfig->u8VolumesNb )
+       || ( EF_CONF_VOLUMES_NB < pxConfig->u8VolumesNb )
+       || ( 0 == pxConfig->u32ThreadsMax )
+       || ( 0 == pxConfig->u32CyclesNb )
+       || ( 0 == pxConfig->u32ChunkSize )
+       || ( EF_CONF_SECTOR_SIZE != EF_TEST_BENCH_SECTOR_SIZE ) )
+  {
+    return 1;
+  }
+
+  u32ThreadsMax = pxConfig->u32ThreadsMax;
+  if ( ( 0 == EF_CONF_FS_LOCK ) && ( 1 < u32ThreadsMax ) )
+  {
+    printf( "EF_CONF_FS_LOCK is disabled, running with a single thread\r\n" );
+    u32ThreadsMax = 1;
+  }
+
+  /* RAM drives */
+  u32TestBenchRamLatency = pxConfig->u32DriveLatency;
+  s32RetVal = s32TestBenchRamSetup( pxConfig->u8VolumesNb, pxConfig->u32VolumeSectors );
+
+  /* Scaling runs */
+  for ( ef_u32_t u32ThreadsNb = 1 ; ( u32ThreadsNb <= u32ThreadsMax ) && ( 0 == s32RetVal ) ; u32ThreadsNb *= 2 )
+  {
+    s32RetVal = s32TestBenchRun( pxConfig, u32ThreadsNb );
+    if (    ( 0 == s32RetVal )
+         && ( u32ThreadsNb < u32ThreadsMax )
+         && ( ( u32ThreadsNb * 2 ) > u32ThreadsMax ) )
+    {
+      /* Last run with the requested maximum */
+      s32RetVal = s32TestBenchRun( pxConfig, u32ThreadsMax );
+      break;
+    }
+  }
+
+  return s32RetVal;
+}
+
+int32_t s32TestBenchFragmentation (
+  ef_u32_t  u32VolumeSectors,
+  ef_u32_t  u32FilesNb,
+  ef_u32_t  u32FileSize,
+  ef_u32_t  u32ChunkSize
+)
+{
+  int32_t     s32RetVal = 0;
+  EF_FILE   * pxFiles;
+  ef_u08_t  * pu8Buffer;
+  ef_u32_t    u32Done;
+  ef_u32_t    u32Bytes;
+  ef_u32_t    u32Extents = 0;
+  ef_u32_t    u32Reads = 0;
+  char        cPath[ EF_TEST_BENCH_PATH_SIZE ];
+  ef_u32_t    f;
+
+  if (    ( 0 == u32FilesNb )
+       || ( 0 == u32FileSize )
+       || ( 0 == u32ChunkSize )
+       || ( EF_CONF_SECTOR_SIZE != EF_TEST_BENCH_SECTOR_SIZE ) )
+  {
+    return 1;
+  }
+
+  pxFiles   = calloc( u32FilesNb, sizeof( EF_FILE ) );
+  pu8Buffer = malloc( ( u32FileSize > u32ChunkSize ) ? u32FileSize : u32ChunkSize );
+  s32RetVal = ( ( 0 == pxFiles ) || ( 0 == pu8Buffer ) ) ? 2 : 0;
+  u32TestBenchRamLatency = 0;
+  if ( 0 == s32RetVal )
+  {
+    s32RetVal = s32TestBenchRamSetup( 1, u32VolumeSectors );
+  }
+  if (    ( 0 == s32RetVal )
+       && (    ( EF_RET_OK != eTestBenchRamFormat( 0 ) )
+            || ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) ) ) )
+  {
+    s32RetVal = 4;
+  }
+
+  /* The files grow side by side, one chunk each in turn */
+  for ( f = 0 ; ( f < u32FilesNb ) && ( 0 == s32RetVal ) ; f++ )
+  {
+    (void) snprintf( cPath, sizeof( cPath ), "A:/F%u.BIN", (unsigned) f );
+    if ( EF_RET_OK != eEF_fopen( &pxFiles[ f ], cPath, EF_FILE_OPEN_WRITE | EF_FILE_OPEN_ANYWAY | EF_FILE_OPEN_TRUNCATE ) )
+    {
+      s32RetVal = 6;
+    }
+  }
+  for ( u32Done = 0 ; ( u32Done < u32FileSize ) && ( 0 == s32RetVal ) ; u32Done += u32Bytes )
+  {
+    u32Bytes = ( ( u32FileSize - u32Done ) < u32ChunkSize ) ? ( u32FileSize - u32Done ) : u32ChunkSize;
+    (void) memset( pu8Buffer, (int) ( u32Done / u32ChunkSize ), u32Bytes );
+    for ( f = 0 ; ( f < u32FilesNb ) && ( 0 == s32RetVal ) ; f++ )
+    {
+      ef_u32_t  u32Written;
+      if (    ( EF_RET_OK != eEF_fwrite( &pxFiles[ f ], pu8Buffer, u32Bytes, &u32Written ) )
+           || ( u32Bytes != u32Written ) )
+      {
+        s32RetVal = 6;
+      }
+    }
+  }
+  for ( f = 0 ; f < u32FilesNb ; f++ )
+  {
+    if ( ( 0 != pxFiles[ f ].xObject.pxFS ) && ( EF_RET_OK != eEF_fclose( &pxFiles[ f ] ) ) )
+    {
+      s32RetVal = 6;
+    }
+  }
+
+  /* Each file is read back in one call, every discontinuity of its sectors is one more extent */
+  for ( f = 0 ; ( f < u32FilesNb ) && ( 0 == s32RetVal ) ; f++ )
+  {
+    (void) snprintf( cPath, sizeof( cPath ), "A:/F%u.BIN", (unsigned) f );
+    if ( EF_RET_OK != eEF_fopen( &pxFiles[ f ], cPath, EF_FILE_OPEN_EXISTING ) )
+    {
+      s32RetVal = 6;
+    }
+    else
+    {
+      u32TestBenchRamReads    = 0;
+      u32TestBenchRamExtents  = 0;
+      xTestBenchRamReadNext   = 0;
+      if (    ( EF_RET_OK != eEF_fread( &pxFiles[ f ], pu8Buffer, u32FileSize, &u32Bytes ) )
+           || ( u32FileSize != u32Bytes ) )
+      {
+        s32RetVal = 6;
+      }
+      else if ( pu8Buffer[ u32FileSize - 1 ] != (ef_u08_t) ( ( u32FileSize - 1 ) / u32ChunkSize ) )
+      {
+        s32RetVal = 7;
+      }
+      else
+      {
+        u32Extents  += u32TestBenchRamExtents;
+        u32Reads    += u32TestBenchRamReads;
+      }
+      (void) eEF_fclose( &pxFiles[ f ] );
+    }
+  }
+
+  if ( 0 == s32RetVal )
+  {
+    printf( "\r\n%u files of %u bytes appended by %u bytes in turn, EF_CONF_ALLOC_GROUPS %u:\r\n",
+            (unsigned) u32FilesNb,
+            (unsigned) u32FileSize,
+            (unsigned) u32ChunkSize,
+            (unsigned) EF_CONF_ALLOC_GROUPS );
+    printf( "  %.1f extents and %.1f read commands per file\r\n",
+            (double) u32Extents / u32FilesNb,
+            (double) u32Reads / u32FilesNb );
+  }
+
+  (void) eEF_umount( "A:" );
+  free( pu8Buffer );
+  free( pxFiles );
+
+  return s32RetVal;
+}
+
+int32_t s32TestBenchMemory (
+  ef_u32_t  u32LoopsNb
+)
+{
+  int32_t           s32RetVal = 0;
+  static ef_u08_t   u8Src[ EF_TEST_BENCH_MEM_SIZE + 8 ];
+  static ef_u08_t   u8Dst[ EF_TEST_BENCH_MEM_SIZE + 8 ];
+  static ef_u08_t   u8Ref[ EF_TEST_BENCH_MEM_SIZE + 8 ];
+  volatile ef_u08_t u8Sink = 0;
+  struct timespec   xStart;
+  ef_u32_t          u32Time[ 4 ];
+  ef_u32_t          u32SrcOffset;
+  ef_u32_t          u32DstOffset;
+  ef_u32_t          u32Size;
+  ef_u32_t          i;
+
+  if ( 0 == u32LoopsNb )
+  {
+    return 1;
+  }
+
+  for ( i = 0 ; i < sizeof( u8Src ) ; i++ )
+  {
+    u8Src[ i ] = (ef_u08_t) ( ( i * 7u ) + ( i >> 8 ) + 1u );
+  }
+
+  /* Every size up to a few words at every misalignment, against the C library */
+  for ( u32SrcOffset = 0 ; ( u32SrcOffset < 8 ) && ( 0 == s32RetVal ) ; u32SrcOffset++ )
+  {
+    for ( u32DstOffset = 0 ; ( u32DstOffset < 8 ) && ( 0 == s32RetVal ) ; u32DstOffset++ )
+    {
+      for ( u32Size = 0 ; ( u32Size <= EF_TEST_BENCH_MEM_CHECK ) && ( 0 == s32RetVal ) ; u32Size++ )
+      {
+        (void) memset( u8Dst, 0xEE, sizeof( u8Dst ) );
+        (void) memset( u8Ref, 0xEE, sizeof( u8Ref ) );
+        (void) eEFPortMemCopy( &u8Src[ u32SrcOffset ], &u8Dst[ u32DstOffset ], u32Size );
+        (void) memcpy( &u8Ref[ u32DstOffset ], &u8Src[ u32SrcOffset ], u32Size );
+        if ( 0 != memcmp( u8Dst, u8Ref, sizeof( u8Dst ) ) )
+        {
+          s32RetVal = 7;
+        }
+        else if ( EF_RET_OK != eEFPortMemCompare( &u8Src[ u32SrcOffset ], &u8Dst[ u32DstOffset ], u32Size ) )
+        {
+          s32RetVal = 7;
+        }
+        else
+        {
+          EF_CODE_COVERAGE( );
+        }
+        /* Each byte differing in turn */
+        for ( i = 0 ; ( i < u32Size ) && ( 0 == s32RetVal ) ; i++ )
+        {
+          u8Dst[ u32DstOffset + i ] ^= 0x10;
+          if ( EF_RET_OK == eEFPortMemCompare( &u8Src[ u32SrcOffset ], &u8Dst[ u32DstOffset ], u32Size ) )
+          {
+            s32RetVal = 7;
+          }
+          u8Dst[ u32DstOffset + i ] ^= 0x10;
+        }
+        (void) eEFPortMemSet( &u8Dst[ u32DstOffset ], (ef_u08_t) u32Size, u32Size );
+        (void) memset( &u8Ref[ u32DstOffset ], (int) u32Size, u32Size );
+        if ( ( 0 == s32RetVal ) && ( 0 != memcmp( u8Dst, u8Ref, sizeof( u8Dst ) ) ) )
+        {
+          s32RetVal = 7;
+        }
+      }
+    }
+  }
+
+#if ( 0 != EF_CONF_PORT_MEM_DMA )
+  /* Only the copies of EF_CONF_PORT_MEM_DMA bytes or more go to a registered engine */
+  if ( ( 0 == s32RetVal ) && ( EF_CONF_PORT_MEM_DMA <= EF_TEST_BENCH_MEM_SIZE ) )
+  {
+    u32TestBenchDmaCopies = 0;
+    (void) eEFPortMemDmaRegister( eTestBenchMemCopyDma );
+    (void) memset( u8Dst, 0xEE, sizeof( u8Dst ) );
+    (void) eEFPortMemCopy( &u8Src[ 1 ], u8Dst, EF_CONF_PORT_MEM_DMA - 1 );
+    if ( 0 != u32TestBenchDmaCopies )
+    {
+      s32RetVal = 7;
+    }
+    (void) eEFPortMemCopy( &u8Src[ 1 ], u8Dst, EF_CONF_PORT_MEM_DMA );
+    if ( ( 1 != u32TestBenchDmaCopies ) || ( 0 != memcmp( u8Dst, &u8Src[ 1 ], EF_CONF_PORT_MEM_DMA ) ) )
+    {
+      s32RetVal = 7;
+    }
+    /* The timings below are the CPU ones */
+    (void) eEFPortMemDmaRegister( 0 );
+    (void) eEFPortMemCopy( u8Src, u8Dst, EF_CONF_PORT_MEM_DMA );
+    if ( ( 1 != u32TestBenchDmaCopies ) || ( 0 != memcmp( u8Dst, u8Src, EF_CONF_PORT_MEM_DMA ) ) )
+    {
+      s32RetVal = 7;
+    }
+  }
+#endif
+
+  /* Sector sized blocks */
+  if ( 0 == s32RetVal )
+  {
+    (void) clock_gettime( CLOCK_MONOTONIC, &xStart );
+    for ( i = 0 ; i < u32LoopsNb ; i++ )
+    {
+      (void) eEFPortMemCopy( u8Src, u8Dst, EF_TEST_BENCH_MEM_SIZE );
+      u8Sink = u8Dst[ i % EF_TEST_BENCH_MEM_SIZE ];
+    }
+    u32Time[ 0 ] = u32TestBenchElapsed( &xStart );
+    (void) clock_gettime( CLOCK_MONOTONIC, &xStart );
+    for ( i = 0 ; i < u32LoopsNb ; i++ )
+    {
+      (void) eEFPortMemCopy( &u8Src[ 1 ], &u8Dst[ 3 ], EF_TEST_BENCH_MEM_SIZE );
+      u8Sink = u8Dst[ i % EF_TEST_BENCH_MEM_SIZE ];
+    }
+    u32Time[ 1 ] = u32TestBenchElapsed( &xStart );
+    (void) clock_gettime( CLOCK_MONOTONIC, &xStart );
+    for ( i = 0 ; i < u32LoopsNb ; i++ )
+    {
+      (void) eEFPortMemZero( u8Dst, EF_TEST_BENCH_MEM_SIZE );
+      u8Sink = u8Dst[ i % EF_TEST_BENCH_MEM_SIZE ];
+    }
+    u32Time[ 2 ] = u32TestBenchElapsed( &xStart );
+    (void) memcpy( u8Dst, u8Src, EF_TEST_BENCH_MEM_SIZE );
+    (void) clock_gettime( CLOCK_MONOTONIC, &xStart );
+    for ( i = 0 ; i < u32LoopsNb ; i++ )
+    {
+      u8Sink = (ef_u08_t) eEFPortMemCompare( u8Src, u8Dst, EF_TEST_BENCH_MEM_SIZE );
+    }
+    u32Time[ 3 ] = u32TestBenchElapsed( &xStart );
+    (void) u8Sink;
+
+    printf( "\r\nMemory functions on %u bytes, EF_CONF_PORT_MEM_WORD %u:\r\n",
+            (unsigned) EF_TEST_BENCH_MEM_SIZE,
+            (unsigned) EF_CONF_PORT_MEM_WORD );
+    printf( "  copy aligned %.1f ns, copy misaligned %.1f ns, zero %.1f ns, compare %.1f ns\r\n",
+            (double) u32Time[ 0 ] / u32LoopsNb,
+            (double) u32Time[ 1 ] / u32LoopsNb,
+            (double) u32Time[ 2 ] / u32LoopsNb,
+            (double) u32Time[ 3 ] / u32LoopsNb );
+  }
+
+  return s32RetVal;
+}
+
+int32_t s32TestBenchLoadStore (
+  ef_u32_t  u32LoopsNb
+)
+{
+  int32_t           s32RetVal = 0;
+  static ef_u08_t   u8Fields[ EF_TEST_BENCH_FIELDS_SIZE ];
+  volatile ef_u32_t u32Sink = 0;
+  struct timespec   xStart;
+  ef_u32_t          u32Time[ 3 ];
+  ef_u32_t          u32Sum;
+  ef_u32_t          u32Loop;
+  ef_u32_t          i;
+
+  if ( 0 == u32LoopsNb )
+  {
+    return 1;
+  }
+
+  for ( i = 0 ; i < sizeof( u8Fields ) ; i++ )
+  {
+    u8Fields[ i ] = (ef_u08_t) ( ( i * 13u ) + ( i >> 8 ) );
+  }
+
+  /* Little-endian at every offset, whatever the core */
+  for ( i = 0 ; ( i < 8 ) && ( 0 == s32RetVal ) ; i++ )
+  {
+    ef_u32_t  u32Expected = (ef_u32_t) u8Fields[ i ] | ( (ef_u32_t) u8Fields[ i + 1 ] << 8 )
+                          | ( (ef_u32_t) u8Fields[ i + 2 ] << 16 ) | ( (ef_u32_t) u8Fields[ i + 3 ] << 24 );
+    if (    ( u32Expected != u32EFPortLoad( &u8Fields[ i ] ) )
+         || ( (ef_u16_t) u32Expected != u16EFPortLoad( &u8Fields[ i ] ) ) )
+    {
+      s32RetVal = 7;
+    }
+    (void) eEFPortStoreu32( &u8Fields[ i ], 0x04030201UL );
+    if (    ( 0x01 != u8Fields[ i ] ) || ( 0x02 != u8Fields[ i + 1 ] )
+         || ( 0x03 != u8Fields[ i + 2 ] ) || ( 0x04 != u8Fields[ i + 3 ] ) )
+    {
+      s32RetVal = 7;
+    }
+    (void) eEFPortStoreu32( &u8Fields[ i ], u32Expected );
+  }
+
+  /* Every offset of the buffer in turn, the aligned and the unaligned fields */
+  if ( 0 == s32RetVal )
+  {
+    (void) clock_gettime( CLOCK_MONOTONIC, &xStart );
+    for ( u32Loop = 0 ; u32Loop < u32LoopsNb ; u32Loop++ )
+    {
+      u32Sum = 0;
+      for ( i = 0 ; i <= ( EF_TEST_BENCH_FIELDS_SIZE - 4 ) ; i++ )
+      {
+        u32Sum += u32EFPortLoad( &u8Fields[ i ] );
+      }
+      u32Sink = u32Sum;
+    }
+    u32Time[ 0 ] = u32TestBenchElapsed( &xStart );
+    (void) clock_gettime( CLOCK_MONOTONIC, &xStart );
+    for ( u32Loop = 0 ; u32Loop < u32LoopsNb ; u32Loop++ )
+    {
+      u32Sum = 0;
+      for ( i = 0 ; i <= ( EF_TEST_BENCH_FIELDS_SIZE - 2 ) ; i++ )
+      {
+        u32Sum += u16EFPortLoad( &u8Fields[ i ] );
+      }
+      u32Sink = u32Sum;
+    }
+    u32Time[ 1 ] = u32TestBenchElapsed( &xStart );
+    (void) clock_gettime( CLOCK_MONOTONIC, &xStart );
+    for ( u32Loop = 0 ; u32Loop < u32LoopsNb ; u32Loop++ )
+    {
+      for ( i = 0 ; i <= ( EF_TEST_BENCH_FIELDS_SIZE - 4 ) ; i++ )
+      {
+        (void) eEFPortStoreu32( &u8Fields[ i ], i + u32Loop );
+      }
+      u32Sink = u8Fields[ u32Loop % EF_TEST_BENCH_FIELDS_SIZE ];
+    }
+    u32Time[ 2 ] = u32TestBenchElapsed( &xStart );
+    (void) u32Sink;
+
+    printf( "\r\nLoad and store of the FAT fields in a %u bytes buffer, EF_CONF_PORT_NATIVE_LE %u:\r\n",
+            (unsigned) EF_TEST_BENCH_FIELDS_SIZE,
+            (unsigned) EF_CONF_PORT_NATIVE_LE );
+    printf( "  load32 %.2f ns, load16 %.2f ns, store32 %.2f ns\r\n",
+            (double) u32Time[ 0 ] / ( (double) u32LoopsNb * ( EF_TEST_BENCH_FIELDS_SIZE - 3 ) ),
+            (double) u32Time[ 1 ] / ( (double) u32LoopsNb * ( EF_TEST_BENCH_FIELDS_SIZE - 1 ) ),
+            (double) u32Time[ 2 ] / ( (double) u32LoopsNb * ( EF_TEST_BENCH_FIELDS_SIZE - 3 ) ) );
+  }
+
+  return s32RetVal;
+}
+
+#endif /* EF_DEF_PORT_SYSTEM_POSIX == EF_CONF_PORT_SYSTEM */
+
+/* ***************************************************************************************************************** */
+/* END OF FILE ***************************************************************************************************** */
@@ -0,0 +1,3397 @@
+/**
+ * ********************************************************************************************************************
+ *  @file     ef_test_file.c
+ *  @ingroup  GroupeFATTest
+ *  @author   Emmanuel AMADIO
+ *  @version  V0.1
+ *  @brief    Functional tests of the file system on RAM drives (host builds).
+ *
+ * ********************************************************************************************************************
+ *  eFAT - embedded FAT Filesystem module
+ * ********************************************************************************************************************
+ *
+ *  Copyright (C) 2021, Amadio Emmanuel, all right reserved.
+ *  Copyright (C) 2019, ChaN, all right reserved.
+ *
+ *  eFAT module is an open source software. Redistribution and use of eFAT in source and binary forms, with or without
+ *  modification, are permitted provided that the following condition is met:
+ *
+ *  Redistributions of source code must retain the above copyright notice, this condition and the following disclaimer.
+ *
+ *  This software is provided by the copyright holders and contributors "AS IS" and any warranties related to this
+ *  software are DISCLAIMED.
+ *  The copyright owners or contributors be NOT LIABLE for any damages caused by use of this software.
+ * ********************************************************************************************************************
+ */
+
+/* START OF FILE *************************************************************************************************** */
+/* ***************************************************************************************************************** */
+
+/* Includes -------------------------------------------------------------------------------------------------------- */
+#include <stdlib.h>
+#include <string.h>
+
+#include "efat.h"
+#include "efat_level3.h"
+#include "ef_prv_def.h"
+
+#include <ef_port_load_store.h>
+#include "ef_prv_def_bpb_fat.h"
+#include "ef_prv_def_mbr.h"
+#include "ef_test_file.h"
+
+/* Local constant macros ------------------------------------------------------------------------------------------- */
+
+#define EF_TEST_FILE_SECTOR_SIZE    ( 512 )     /**< Sector size of the RAM drives */
+#define EF_TEST_FILE_RESERVED_NB    ( 32 )      /**< Number of reserved sectors of the volumes */
+#define EF_TEST_FILE_CLST_NB        ( 65600u )  /**< Number of clusters of the volumes (FAT32 from 65525) */
+#define EF_TEST_FILE_BUFFER_SIZE    ( 65536 )   /**< Size of the data buffer */
+#define EF_TEST_FILE_LINES_NB       ( 60 )      /**< Number of lines of the text file */
+#define EF_TEST_FILE_LINE_SIZE      ( 80 )      /**< Size of the line buffer, larger than the longest line */
+#define EF_TEST_FILE_PRINTF_NB      ( 1500 )    /**< Number of lines written by eEF_printf() */
+#define EF_TEST_FILE_TRANSFER_POLLS ( 3 )       /**< Number of status polls a started transfer of the RAM drives takes */
+
+/* Local function macros ------------------------------------------------------------------------------------------- */
+
+/**
+ *  Drive functions of the RAM drive n, the drive functions do not get the physical drive number
+ */
+#define EF_TEST_FILE_RAM_DRIVE_DEFINE( n )                                                                            \
+  static ef_return_et eTestFileRamInitialize##n ( void )                                                              \
+  { return eTestFileRamStatus( n ); }                                                                                 \
+  static ef_return_et eTestFileRamStatus##n ( void )                                                                  \
+  { return eTestFileRamStatus( n ); }                                                                                 \
+  static ef_return_et eTestFileRamRead##n ( ef_u08_t * pu8Buffer, ef_lba_t xSector, ef_u32_t u32Count )               \
+  { return eTestFileRamRead( n, pu8Buffer, xSector, u32Count ); }                                                     \
+  static ef_return_et eTestFileRamWrite##n ( const ef_u08_t * pu8Buffer, ef_lba_t xSector, ef_u32_t u32Count )        \
+  { return eTestFileRamWrite( n, pu8Buffer, xSector, u32Count ); }                                                    \
+  static ef_return_et eTestFileRamCtrl##n ( ef_u08_t u8Cmd, void * pvBuffer )                                         \
+  { return eTestFileRamCtrl( n, u8Cmd, pvBuffer ); }
+
+#if ( 0 != EF_CONF_NON_BLOCKING )
+/**
+ *  Started transfer functions of the RAM drive n
+ */
+#define EF_TEST_FILE_RAM_DRIVE_NB_DEFINE( n )                                                                         \
+  static ef_return_et eTestFileRamReadStart##n ( ef_u08_t * pu8Buffer, ef_lba_t xSector, ef_u32_t u32Count )          \
+  { return eTestFileRamTransferStart( n, pu8Buffer, xSector, u32Count, EF_BOOL_FALSE ); }                             \
+  static ef_return_et eTestFileRamWriteStart##n ( const ef_u08_t * pu8Buffer, ef_lba_t xSector, ef_u32_t u32Count )   \
+  { return eTestFileRamTransferStart( n, pu8Buffer, xSector, u32Count, EF_BOOL_TRUE ); }                              \
+  static ef_return_et eTestFileRamTransferStatus##n ( void )                                                          \
+  { return eTestFileRamTransferStatus( n ); }
+#endif
+
+/* Local typedefs, structures, unions and enums -------------------------------------------------------------------- */
+
+#if ( 0 != EF_CONF_NON_BLOCKING )
+/**
+ *  Transfer started on a RAM drive, the sectors are copied when it ends after EF_TEST_FILE_TRANSFER_POLLS polls
+ */
+typedef struct
+{
+  const ef_u08_t  * pu8Buffer;  /**< Data buffer of the transfer */
+  ef_lba_t          xSector;    /**< Start sector in LBA */
+  ef_u32_t          u32Count;   /**< Number of sectors */
+  ef_u32_t          u32Polls;   /**< Number of polls up to the end of the transfer (0: no started transfer) */
+  ef_bool_t         bWrite;     /**< The transfer writes the sectors */
+} ef_test_file_transfer_st;
+#endif
+
+/**
+ *  Layout of a FAT volume of a RAM drive, as checked by s32TestFileFatCheck()
+ */
+typedef struct
+{
+  const ef_u08_t  * pu8Fat;       /**< Pointer to the first FAT */
+  const ef_u08_t  * pu8Root;      /**< Pointer to the fixed root directory (FAT12/16) */
+  const ef_u08_t  * pu8Data;      /**< Pointer to the data area */
+  ef_u08_t        * pu8Used;      /**< Clusters found in a chain, one byte per cluster */
+  ef_u32_t          u32ClstNb;    /**< Number of clusters of the volume */
+  ef_u32_t          u32ClstBytes; /**< Cluster size in bytes */
+  ef_u32_t          u32RootNb;    /**< Number of entries of the fixed root directory (FAT12/16) */
+  ef_u32_t          u32EndMin;    /**< Smallest end of chain mark */
+  ef_u08_t          u8FatBits;    /**< Size of a FAT entry in bits */
+} ef_test_file_fat_st;
+
+#if ( 0 != EF_CONF_USE_MKFS )
+/**
+ *  Volume created by s32TestFileMkfs()
+ */
+typedef struct
+{
+  ef_u32_t          u32Sectors;   /**< Size of the RAM drive in sectors */
+  ef_u08_t          u8Format;     /**< Format options given to eEF_mkfs() */
+  ef_u08_t          u8FatBits;    /**< Size of a FAT entry in bits of the volume expected */
+} ef_test_file_mkfs_st;
+#endif
+
+/* Local variables ------------------------------------------------------------------------------------------------- */
+
+/**
+ *  RAM drives storage
+ */
+static ef_u08_t * pu8TestFileRam[ EF_TEST_FILE_DRIVES_NB ];
+
+/**
+ *  RAM drives size in sectors
+ */
+static ef_u32_t u32TestFileRamSectors[ EF_TEST_FILE_DRIVES_NB ];
+
+/**
+ *  RAM drives are registered
+ */
+static ef_bool_t bTestFileRamRegistered = EF_BOOL_FALSE;
+
+/**
+ *  Data buffer of the file transfers
+ */
+static ef_u08_t u8TestFileBuffer[ EF_TEST_FILE_BUFFER_SIZE ];
+
+/**
+ *  File offset of the next byte expected by the test stream
+ */
+static ef_u32_t u32TestFileStreamOffset;
+
+/**
+ *  Failure Id of the test stream (0: none, 7: a byte forwarded differs from the test data)
+ */
+static int32_t s32TestFileStreamFail;
+
+/**
+ *  File offset of the next byte given by the test producer
+ */
+static ef_u32_t u32TestFileProduceOffset;
+
+/**
+ *  File offset the test producer stops at
+ */
+static ef_u32_t u32TestFileProduceEnd;
+
+#if ( 0 != EF_CONF_FILE_LOCK )
+/**
+ *  Files kept open to fill the lock table
+ */
+static EF_FILE xTestFileLockFiles[ EF_CONF_FILE_LOCK ];
+#endif
+
+#if ( 0 != EF_CONF_NON_BLOCKING )
+/**
+ *  Transfers started on the RAM drives
+ */
+static ef_test_file_transfer_st xTestFileTransfers[ EF_TEST_FILE_DRIVES_NB ];
+
+/**
+ *  Number of transfers started on the RAM drives
+ */
+static ef_u32_t u32TestFileTransferStarts;
+#endif
+
+#if ( 0 != EF_CONF_FILE_DIGEST )
+/**
+ *  Digest of the test, a hash of the bytes in order and their number
+ */
+typedef struct
+{
+  ef_u32_t  u32Hash;    /**< Hash of the bytes digested */
+  ef_u32_t  u32Count;   /**< Number of bytes digested */
+} ef_test_file_digest_st;
+#endif
+
+/* Public variables ------------------------------------------------------------------------------------------------ */
+/* Local function prototypes---------------------------------------------------------------------------------------- */
+
+static ef_return_et eTestFileRamStatus ( ef_u08_t u8Drive );
+static ef_return_et eTestFileRamRead ( ef_u08_t u8Drive, ef_u08_t * pu8Buffer, ef_lba_t xSector, ef_u32_t u32Count );
+static ef_return_et eTestFileRamWrite ( ef_u08_t u8Drive, const ef_u08_t * pu8Buffer, ef_lba_t xSector, ef_u32_t u32Count );
+static ef_return_et eTestFileRamCtrl ( ef_u08_t u8Drive, ef_u08_t u8Cmd, void * pvBuffer );
+#if ( 0 != EF_CONF_NON_BLOCKING )
+static ef_return_et eTestFileRamTransferStart ( ef_u08_t u8Drive, const ef_u08_t * pu8Buffer, ef_lba_t xSector,
+                                                ef_u32_t u32Count, ef_bool_t bWrite );
+static ef_return_et eTestFileRamTransferStatus ( ef_u08_t u8Drive );
+#endif
+
+/**
+ *  @brief  Register the RAM drives if needed, then allocate a blank RAM drive
+ *
+ *  @param  u8Drive     RAM drive number
+ *  @param  u32Sectors  Size of the RAM drive in sectors
+ *
+ *  @return Failure Id (0: none, 1: not enough memory, 2: RAM drive registration failed)
+ */
+static int32_t s32TestFileRam (
+  ef_u08_t  u8Drive,
+  ef_u32_t  u32Sectors
+);
+
+/**
+ *  @brief  Register the RAM drives if needed, then format a RAM drive as a FAT32 volume without partition table
+ *
+ *  @param  u8Drive     RAM drive number
+ *  @param  u32ClstNb   Number of clusters of the volume
+ *  @param  u8ClstSize  Cluster size in sectors
+ *
+ *  @return Failure Id (0: none, 1: not enough memory, 2: RAM drive registration failed)
+ */
+static int32_t s32TestFileVolume (
+  ef_u08_t  u8Drive,
+  ef_u32_t  u32ClstNb,
+  ef_u08_t  u8ClstSize
+);
+
+/**
+ *  @brief  Get the byte of the test data at an offset of a file, a sector never holds the data of another one
+ *
+ *  @param  u32Offset File offset
+ *
+ *  @return Data byte
+ */
+static ef_u08_t u8TestFileData (
+  ef_u32_t  u32Offset
+);
+
+/**
+ *  @brief  Create a file with the test data, written in chunks
+ *
+ *  @param  pxPath        Pointer to the file path
+ *  @param  u8Mode        Opening mode of eEF_fopen()
+ *  @param  u32Size       File size
+ *  @param  u32ChunkSize  Number of bytes given to each eEF_fwrite() (up to EF_TEST_FILE_BUFFER_SIZE)
+ *
+ *  @return Operation result (EF_RET_ERROR: a chunk was not fully written)
+ */
+static ef_return_et eTestFileWrite (
+  const TCHAR * pxPath,
+  ef_u08_t      u8Mode,
+  ef_u32_t      u32Size,
+  ef_u32_t      u32ChunkSize
+);
+
+/**
+ *  @brief  Read a file back in chunks and check its test data
+ *
+ *  @param  pxPath        Pointer to the file path
+ *  @param  u32Size       Expected file size
+ *  @param  pu32Chunks    Pointer to the numbers of bytes given to each eEF_fread(), used in turn (up to
+ *                        EF_TEST_FILE_BUFFER_SIZE)
+ *  @param  u32ChunksNb   Number of chunk sizes
+ *
+ *  @return Failure Id (0: none, 5: a file operation failed, 7: read data differs from the test data)
+ */
+static int32_t s32TestFileCheck (
+  const TCHAR     * pxPath,
+  ef_u32_t          u32Size,
+  const ef_u32_t  * pu32Chunks,
+  ef_u32_t          u32ChunksNb
+);
+
+/**
+ *  @brief  Check the FAT of a volume of a RAM drive: the chains of the directory entries are valid, do not cross and
+ *          match the sizes of the files, no cluster is lost, the FAT copies are the same and the free count of the
+ *          FSINFO sector, when known, is the number of free clusters
+ *
+ *  @param  u8Drive   RAM drive number
+ *  @param  u32Sector First sector of the volume
+ *
+ *  @return Failure Id (0: none, 1: not enough memory, 14: the FAT is not consistent)
+ */
+static int32_t s32TestFileFatCheck (
+  ef_u08_t  u8Drive,
+  ef_u32_t  u32Sector
+);
+
+/**
+ *  @brief  Get the value of a FAT entry of a volume checked by s32TestFileFatCheck()
+ *
+ *  @param  pxFat       Pointer to the layout of the volume
+ *  @param  u32Cluster  Cluster number
+ *
+ *  @return Value of the FAT entry
+ */
+static ef_u32_t u32TestFileFatGet (
+  const ef_test_file_fat_st * pxFat,
+  ef_u32_t                    u32Cluster
+);
+
+/**
+ *  @brief  Follow a cluster chain of a volume checked by s32TestFileFatCheck(), its clusters are marked as used
+ *
+ *  @param  pxFat       Pointer to the layout of the volume
+ *  @param  u32Cluster  First cluster of the chain
+ *  @param  pu32Nb      Pointer to the number of clusters of the chain
+ *
+ *  @return Failure Id (0: none, 14: a link is out of the volume or the chain crosses another one)
+ */
+static int32_t s32TestFileFatChain (
+  ef_test_file_fat_st * pxFat,
+  ef_u32_t              u32Cluster,
+  ef_u32_t            * pu32Nb
+);
+
+/**
+ *  @brief  Check the chains of the entries of a directory of a volume checked by s32TestFileFatCheck(), the
+ *          sub-directories are checked in turn
+ *
+ *  @param  pxFat       Pointer to the layout of the volume
+ *  @param  u32Cluster  First cluster of the directory, its chain is already checked (0: fixed root directory)
+ *
+ *  @return Failure Id (0: none, 14: a chain is not valid or does not match its entry)
+ */
+static int32_t s32TestFileFatDirectory (
+  ef_test_file_fat_st * pxFat,
+  ef_u32_t              u32Cluster
+);
+
+/**
+ *  @brief  Stream function checking the bytes forwarded against the test data, it takes up to 700 bytes at a time
+ *
+ *  @param  pu8Data   Pointer to the bytes forwarded (0: sense call)
+ *  @param  u32Count  Number of bytes forwarded
+ *
+ *  @return Number of bytes taken (sense call: 1, ready)
+ */
+static ef_u32_t u32TestFileStream (
+  const ef_u08_t  * pu8Data,
+  ef_u32_t          u32Count
+);
+
+/**
+ *  @brief  Producer function giving the inverted test data up to u32TestFileProduceEnd, up to 900 bytes at a time
+ *
+ *  @param  pu8Data   Pointer to the bytes to fill
+ *  @param  u32Count  Number of bytes to fill
+ *
+ *  @return Number of bytes filled (0: no more data)
+ */
+static ef_u32_t u32TestFileProduce (
+  ef_u08_t  * pu8Data,
+  ef_u32_t    u32Count
+);
+
+/**
+ *  @brief  Read a file back and check it holds the inverted test data in a range, the test data elsewhere
+ *
+ *  @param  pxPath      Pointer to the file path
+ *  @param  u32Size     Expected file size
+ *  @param  u32First    File offset of the first inverted byte
+ *  @param  u32End      File offset past the last inverted byte
+ *
+ *  @return Failure Id (0: none, 5: a file operation failed, 7: read data differs from the expected data)
+ */
+static int32_t s32TestFileCheckInverted (
+  const TCHAR * pxPath,
+  ef_u32_t      u32Size,
+  ef_u32_t      u32First,
+  ef_u32_t      u32End
+);
+
+#if ( 0 != EF_CONF_FILE_DIGEST )
+/**
+ *  @brief  Digest function of the test, it hashes the bytes in order
+ *
+ *  @param  pvContext Pointer to the digest, ef_test_file_digest_st
+ *  @param  pu8Data   Pointer to the bytes to digest
+ *  @param  u32Size   Number of bytes to digest
+ */
+static void vTestFileDigest (
+  void            * pvContext,
+  const ef_u08_t  * pu8Data,
+  ef_u32_t          u32Size
+);
+#endif
+
+/* Local functions ------------------------------------------------------------------------------------------------- */
+
+EF_TEST_FILE_RAM_DRIVE_DEFINE( 0 )
+EF_TEST_FILE_RAM_DRIVE_DEFINE( 1 )
+#if ( 0 != EF_CONF_NON_BLOCKING )
+EF_TEST_FILE_RAM_DRIVE_NB_DEFINE( 0 )
+EF_TEST_FILE_RAM_DRIVE_NB_DEFINE( 1 )
+#endif
+
+/**
+ *  Drive functions of the RAM drives
+ */
+static ef_drive_functions_st xTestFileRamFunctions[ EF_TEST_FILE_DRIVES_NB ] = {
+  {
+    .pxInitialize = eTestFileRamInitialize0,
+    .pxStatus     = eTestFileRamStatus0,
+    .pxRead       = eTestFileRamRead0,
+    .pxWrite      = eTestFileRamWrite0,
+    .pxCtrl       = eTestFileRamCtrl0,
+#if ( 0 != EF_CONF_NON_BLOCKING )
+    .pxReadStart      = eTestFileRamReadStart0,
+    .pxWriteStart     = eTestFileRamWriteStart0,
+    .pxTransferStatus = eTestFileRamTransferStatus0
+#endif
+  },
+  {
+    .pxInitialize = eTestFileRamInitialize1,
+    .pxStatus     = eTestFileRamStatus1,
+    .pxRead       = eTestFileRamRead1,
+    .pxWrite      = eTestFileRamWrite1,
+    .pxCtrl       = eTestFileRamCtrl1,
+#if ( 0 != EF_CONF_NON_BLOCKING )
+    .pxReadStart      = eTestFileRamReadStart1,
+    .pxWriteStart     = eTestFileRamWriteStart1,
+    .pxTransferStatus = eTestFileRamTransferStatus1
+#endif
+  }
+};
+
+/* Get a RAM drive status */
+static ef_return_et eTestFileRamStatus (
+  ef_u08_t u8Drive
+)
+{
+  return ( 0 != pu8TestFileRam[ u8Drive ] ) ? EF_RET_OK : EF_RET_DISK_NOINIT;
+}
+
+/* Read sectors of a RAM drive */
+static ef_return_et eTestFileRamRead (
+  ef_u08_t    u8Drive,
+  ef_u08_t  * pu8Buffer,
+  ef_lba_t    xSector,
+  ef_u32_t    u32Count
+)
+{
+  ef_return_et eRetVal = EF_RET_OK;
+
+  if ( ( xSector + u32Count ) > u32TestFileRamSectors[ u8Drive ] )
+  {
+    eRetVal = EF_RET_DISK_PARERR;
+  }
+  else
+  {
+    (void) memcpy( pu8Buffer,
+                   pu8TestFileRam[ u8Drive ] + ( (size_t) xSector * EF_TEST_FILE_SECTOR_SIZE ),
+                   (size_t) u32Count * EF_TEST_FILE_SECTOR_SIZE );
+  }
+
+  return eRetVal;
+}
+
+/* Write sectors of a RAM drive */
+static ef_return_et eTestFileRamWrite (
+  ef_u08_t          u8Drive,
+  const ef_u08_t  * pu8Buffer,
+  ef_lba_t          xSector,
+  ef_u32_t          u32Count
+)
+{
+  ef_return_et eRetVal = EF_RET_OK;
+
+  if ( ( xSector + u32Count ) > u32TestFileRamSectors[ u8Drive ] )
+  {
+    eRetVal = EF_RET_DISK_PARERR;
+  }
+  else
+  {
+    (void) memcpy( pu8TestFileRam[ u8Drive ] + ( (size_t) xSector * EF_TEST_FILE_SECTOR_SIZE ),
+                   pu8Buffer,
+                   (size_t) u32Count * EF_TEST_FILE_SECTOR_SIZE );
+  }
+
+  return eRetVal;
+}
+
+/* I/O control of a RAM drive */
+static ef_return_et eTestFileRamCtrl (
+  ef_u08_t    u8Drive,
+  ef_u08_t    u8Cmd,
+  void      * pvBuffer
+)
+{
+  ef_return_et eRetVal = EF_RET_OK;
+
+  switch ( u8Cmd )
+  {
+    case CTRL_SYNC:
+    case CTRL_TRIM:
+      break;
+    case GET_SECTOR_COUNT:
+      *(ef_u32_t *) pvBuffer = u32TestFileRamSectors[ u8Drive ];
+      break;
+    case GET_SECTOR_SIZE:
+      *(ef_u16_t *) pvBuffer = EF_TEST_FILE_SECTOR_SIZE;
+      break;
+    case GET_BLOCK_SIZE:
+      *(ef_u32_t *) pvBuffer = 1;
+      break;
+    default:
+      eRetVal = EF_RET_DISK_PARERR;
+      break;
+  }
+
+  return eRetVal;
+}
+
+#if ( 0 != EF_CONF_NON_BLOCKING )
+/* Start a transfer on a RAM drive */
+static ef_return_et eTestFileRamTransferStart (
+  ef_u08_t          u8Drive,
+  const ef_u08_t  * pu8Buffer,
+  ef_lba_t          xSector,
+  ef_u32_t          u32Count,
+  ef_bool_t         bWrite
+)
+{
+  ef_return_et eRetVal = EF_RET_OK;
+
+  if ( ( xSector + u32Count ) > u32TestFileRamSectors[ u8Drive ] )
+  {
+    eRetVal = EF_RET_DISK_PARERR;
+  }
+  else
+  {
+    xTestFileTransfers[ u8Drive ].pu8Buffer = pu8Buffer;
+    xTestFileTransfers[ u8Drive ].xSector   = xSector;
+    xTestFileTransfers[ u8Drive ].u32Count  = u32Count;
+    xTestFileTransfers[ u8Drive ].u32Polls  = EF_TEST_FILE_TRANSFER_POLLS;
+    xTestFileTransfers[ u8Drive ].bWrite    = bWrite;
+    u32TestFileTransferStarts++;
+  }
+
+  return eRetVal;
+}
+
+/* Get the status of the transfer started on a RAM drive, the sectors are copied when it ends */
+static ef_return_et eTestFileRamTransferStatus (
+  ef_u08_t  u8Drive
+)
+{
+  ef_return_et                eRetVal = EF_RET_OK;
+  ef_test_file_transfer_st  * pxTransfer = &xTestFileTransfers[ u8Drive ];
+
+  if ( 0 == pxTransfer->u32Polls )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( 0 != --pxTransfer->u32Polls )
+  {
+    eRetVal = EF_RET_PENDING;
+  }
+  else if ( EF_BOOL_FALSE != pxTransfer->bWrite )
+  {
+    eRetVal = eTestFileRamWrite( u8Drive, pxTransfer->pu8Buffer, pxTransfer->xSector, pxTransfer->u32Count );
+  }
+  else
+  {
+    eRetVal = eTestFileRamRead( u8Drive,
+                                (ef_u08_t *) pxTransfer->pu8Buffer,
+                                pxTransfer->xSector,
+                                pxTransfer->u32Count );
+  }
+
+  return eRetVal;
+}
+#endif
+
+/* Register the RAM drives and allocate a blank RAM drive */
+static int32_t s32TestFileRam (
+  ef_u08_t  u8Drive,
+  ef_u32_t  u32Sectors
+)
+{
+  int32_t     s32RetVal = 0;
+
+  for ( ef_u08_t v = 0 ; ( v < EF_TEST_FILE_DRIVES_NB ) && ( EF_BOOL_FALSE == bTestFileRamRegistered ) && ( 0 == s32RetVal ) ; v++ )
+  {
+    if ( EF_RET_OK != eEF_drive_register( &xTestFileRamFunctions[ v ] ) )
+    {
+      s32RetVal = 2;
+    }
+  }
+  bTestFileRamRegistered = ( 0 == s32RetVal ) ? EF_BOOL_TRUE : bTestFileRamRegistered;
+
+  /* Blank drive, the pages of the host are only committed when written */
+  if ( 0 == s32RetVal )
+  {
+    free( pu8TestFileRam[ u8Drive ] );
+    pu8TestFileRam[ u8Drive ]         = calloc( u32Sectors, EF_TEST_FILE_SECTOR_SIZE );
+    u32TestFileRamSectors[ u8Drive ]  = ( 0 != pu8TestFileRam[ u8Drive ] ) ? u32Sectors : 0;
+    s32RetVal = ( 0 == pu8TestFileRam[ u8Drive ] ) ? 1 : 0;
+  }
+
+  return s32RetVal;
+}
+
+/* Register the RAM drives and format a RAM drive */
+static int32_t s32TestFileVolume (
+  ef_u08_t  u8Drive,
+  ef_u32_t  u32ClstNb,
+  ef_u08_t  u8ClstSize
+)
+{
+  int32_t     s32RetVal;
+  ef_u32_t    u32FatSize = ( ( ( u32ClstNb + 2 ) * 4 ) + EF_TEST_FILE_SECTOR_SIZE - 1 ) / EF_TEST_FILE_SECTOR_SIZE;
+  ef_u32_t    u32Sectors = EF_TEST_FILE_RESERVED_NB + ( 2 * u32FatSize ) + ( u32ClstNb * u8ClstSize );
+  ef_u08_t  * pu8Ram;
+  ef_u08_t  * pu8Fat;
+
+  s32RetVal = s32TestFileRam( u8Drive, u32Sectors );
+  if ( 0 == s32RetVal )
+  {
+    pu8Ram = pu8TestFileRam[ u8Drive ];
+    /* Volume boot record */
+    pu8Ram[ EF_BS_OFFSET_JMP_INST + 0 ] = 0xEB;
+    pu8Ram[ EF_BS_OFFSET_JMP_INST + 1 ] = 0x58;
+    pu8Ram[ EF_BS_OFFSET_JMP_INST + 2 ] = 0x90;
+    (void) memcpy( pu8Ram + EF_BS_OFFSET_OEM_NAME, "EFATTEST", 8 );
+    vEFPortStoreu16( pu8Ram + EF_BS_BPB_FAT_OFFSET_SECTOR_SIZE, EF_TEST_FILE_SECTOR_SIZE );
+    pu8Ram[ EF_BS_BPB_FAT_OFFSET_CLUSTER_SIZE ] = u8ClstSize;
+    vEFPortStoreu16( pu8Ram + EF_BS_BPB_FAT_OFFSET_SECTORS_RESERVED_NB, EF_TEST_FILE_RESERVED_NB );
+    pu8Ram[ EF_BS_BPB_FAT_OFFSET_FATS_NB ] = 2;
+    pu8Ram[ EF_BS_BPB_FAT_OFFSET_MEDIA_DESCRIPTOR ] = 0xF8;
+    vEFPortStoreu16( pu8Ram + EF_BS_BPB_FAT_OFFSET_TRACK_SIZE, 63 );
+    vEFPortStoreu16( pu8Ram + EF_BS_BPB_FAT_OFFSET_HEADS_NB, 255 );
+    vEFPortStoreu32( pu8Ram + EF_BS_BPB_FAT_OFFSET_SECTORS_LARGE_COUNT, u32Sectors );
+    vEFPortStoreu32( pu8Ram + EF_BS_EBPB_FAT32_OFFSET_FAT_SIZE, u32FatSize );
+    vEFPortStoreu32( pu8Ram + EF_BS_EBPB_FAT32_OFFSET_ROOT_DIRECTORY_NB, 2 );
+    vEFPortStoreu16( pu8Ram + EF_BS_EBPB_FAT32_OFFSET_FS_INFO_SECTOR, 1 );
+    vEFPortStoreu16( pu8Ram + EF_BS_EBPB_FAT32_OFFSET_BACKUPBOOT_SECTOR, 6 );
+    pu8Ram[ EF_BS_EBPB_FAT32_OFFSET_DRIVE_NB ] = 0x80;
+    pu8Ram[ EF_BS_EBPB_FAT32_OFFSET_SIGNATURE ] = 0x29;
+    vEFPortStoreu32( pu8Ram + EF_BS_EBPB_FAT32_OFFSET_VOLUME_ID, 0x20210000u + u8Drive );
+    (void) memcpy( pu8Ram + EF_BS_EBPB_FAT32_OFFSET_VOLUME_LABEL, "NO NAME    FAT32   ", 19 );
+    vEFPortStoreu16( pu8Ram + EF_BS_OFFSET_SIGNATURE, 0xAA55 );
+    /* FSINFO sector, free count and next free cluster unknown */
+    vEFPortStoreu32( pu8Ram + EF_TEST_FILE_SECTOR_SIZE + EF_BS_FAT32_FSI_OFFSET_SIGNATURE_LEAD, 0x41615252 );
+    vEFPortStoreu32( pu8Ram + EF_TEST_FILE_SECTOR_SIZE + EF_BS_FAT32_FSI_OFFSET_SIGNATURE_NEXT, 0x61417272 );
+    vEFPortStoreu32( pu8Ram + EF_TEST_FILE_SECTOR_SIZE + EF_BS_FAT32_FSI_OFFSET_FREE_CLUSTERS, 0xFFFFFFFF );
+    vEFPortStoreu32( pu8Ram + EF_TEST_FILE_SECTOR_SIZE + EF_BS_FAT32_FSI_OFFSET_CLUSTER_LAST_ALLOC, 0xFFFFFFFF );
+    vEFPortStoreu16( pu8Ram + EF_TEST_FILE_SECTOR_SIZE + EF_BS_OFFSET_SIGNATURE, 0xAA55 );
+    /* Backup boot record */
+    (void) memcpy( pu8Ram + ( 6 * EF_TEST_FILE_SECTOR_SIZE ), pu8Ram, 2 * EF_TEST_FILE_SECTOR_SIZE );
+    /* Both FATs: media, end of chain and root directory cluster entries */
+    for ( ef_u32_t i = 0 ; i < 2 ; i++ )
+    {
+      pu8Fat = pu8Ram + ( (size_t) ( EF_TEST_FILE_RESERVED_NB + ( i * u32FatSize ) ) * EF_TEST_FILE_SECTOR_SIZE );
+      vEFPortStoreu32( pu8Fat + 0, 0x0FFFFFF8 );
+      vEFPortStoreu32( pu8Fat + 4, 0x0FFFFFFF );
+      vEFPortStoreu32( pu8Fat + 8, 0x0FFFFFFF );
+    }
+  }
+
+  return s32RetVal;
+}
+
+/* Get the byte of the test data */
+static ef_u08_t u8TestFileData (
+  ef_u32_t  u32Offset
+)
+{
+  return (ef_u08_t) ( u32Offset + ( ( u32Offset / EF_TEST_FILE_SECTOR_SIZE ) * 7 ) );
+}
+
+/* Create a file with the test data */
+static ef_return_et eTestFileWrite (
+  const TCHAR * pxPath,
+  ef_u08_t      u8Mode,
+  ef_u32_t      u32Size,
+  ef_u32_t      u32ChunkSize
+)
+{
+  ef_return_et  eRetVal;
+  EF_FILE       xFile;
+  ef_u32_t      u32Length;
+  ef_u32_t      u32Done;
+
+  eRetVal = eEF_fopen( &xFile, pxPath, u8Mode );
+  for ( ef_u32_t u32Offset = 0 ; ( EF_RET_OK == eRetVal ) && ( u32Offset < u32Size ) ; u32Offset += u32Length )
+  {
+    u32Length = u32Size - u32Offset;
+    if ( u32Length > u32ChunkSize )
+    {
+      u32Length = u32ChunkSize;
+    }
+    for ( ef_u32_t i = 0 ; i < u32Length ; i++ )
+    {
+      u8TestFileBuffer[ i ] = u8TestFileData( u32Offset + i );
+    }
+    eRetVal = eEF_fwrite( &xFile, u8TestFileBuffer, u32Length, &u32Done );
+    if ( ( EF_RET_OK == eRetVal ) && ( u32Done != u32Length ) )
+    {
+      eRetVal = EF_RET_ERROR;
+    }
+  }
+  if ( EF_RET_OK == eRetVal )
+  {
+    eRetVal = eEF_fclose( &xFile );
+  }
+
+  return eRetVal;
+}
+
+/* Read a file back and check its test data */
+static int32_t s32TestFileCheck (
+  const TCHAR     * pxPath,
+  ef_u32_t          u32Size,
+  const ef_u32_t  * pu32Chunks,
+  ef_u32_t          u32ChunksNb
+)
+{
+  int32_t   s32RetVal = 0;
+  EF_FILE   xFile;
+  ef_u32_t  u32Offset = 0;
+  ef_u32_t  u32Length;
+  ef_u32_t  u32Done = 0;
+  ef_u32_t  u32Chunk = 0;
+
+  if ( EF_RET_OK != eEF_fopen( &xFile, pxPath, EF_FILE_OPEN_EXISTING ) )
+  {
+    s32RetVal = 5;
+  }
+  else
+  {
+    /* Read up to an empty read at the end of the file */
+    do
+    {
+      u32Length = pu32Chunks[ u32Chunk ];
+      u32Chunk  = ( u32Chunk + 1 ) % u32ChunksNb;
+      if (    ( EF_RET_OK != eEF_fread( &xFile, u8TestFileBuffer, u32Length, &u32Done ) )
+           || ( u32Done != ( ( u32Length < ( u32Size - u32Offset ) ) ? u32Length : ( u32Size - u32Offset ) ) ) )
+      {
+        s32RetVal = 5;
+      }
+      for ( ef_u32_t i = 0 ; ( 0 == s32RetVal ) && ( i < u32Done ) ; i++ )
+      {
+        if ( u8TestFileBuffer[ i ] != u8TestFileData( u32Offset + i ) )
+        {
+          s32RetVal = 7;
+        }
+      }
+      u32Offset += u32Done;
+    } while ( ( 0 == s32RetVal ) && ( 0 != u32Done ) );
+
+    if ( ( EF_RET_OK != eEF_fclose( &xFile ) ) && ( 0 == s32RetVal ) )
+    {
+      s32RetVal = 5;
+    }
+  }
+
+  return s32RetVal;
+}
+
+/* Check the FAT of a volume of a RAM drive */
+static int32_t s32TestFileFatCheck (
+  ef_u08_t  u8Drive,
+  ef_u32_t  u32Sector
+)
+{
+  int32_t             s32RetVal = 0;
+  ef_test_file_fat_st xFat;
+  const ef_u08_t    * pu8Volume = pu8TestFileRam[ u8Drive ] + ( (size_t) u32Sector * EF_TEST_FILE_SECTOR_SIZE );
+  ef_u32_t            u32SectorSize = u16EFPortLoad( pu8Volume + EF_BS_BPB_FAT_OFFSET_SECTOR_SIZE );
+  ef_u32_t            u32FatSize = u16EFPortLoad( pu8Volume + EF_BS_BPB_FAT_OFFSET_FAT16_SIZE );
+  ef_u32_t            u32Sectors = u16EFPortLoad( pu8Volume + EF_BS_BPB_FAT_OFFSET_SECTORS_COUNT );
+  ef_u32_t            u32FatsNb = pu8Volume[ EF_BS_BPB_FAT_OFFSET_FATS_NB ];
+  ef_u32_t            u32DataStart;
+  ef_u32_t            u32ClstFree = 0;
+  ef_u32_t            u32FsInfoFree;
+  ef_u32_t            u32Nb;
+
+  u32FatSize    = ( 0 != u32FatSize ) ? u32FatSize : u32EFPortLoad( pu8Volume + EF_BS_EBPB_FAT32_OFFSET_FAT_SIZE );
+  u32Sectors    = ( 0 != u32Sectors ) ? u32Sectors : u32EFPortLoad( pu8Volume + EF_BS_BPB_FAT_OFFSET_SECTORS_LARGE_COUNT );
+  xFat.u32RootNb    = u16EFPortLoad( pu8Volume + EF_BS_BPB_FAT_OFFSET_ROOT_ENTRIES );
+  xFat.u32ClstBytes = u32SectorSize * pu8Volume[ EF_BS_BPB_FAT_OFFSET_CLUSTER_SIZE ];
+  xFat.pu8Fat       = pu8Volume + ( u16EFPortLoad( pu8Volume + EF_BS_BPB_FAT_OFFSET_SECTORS_RESERVED_NB ) * u32SectorSize );
+  xFat.pu8Root      = xFat.pu8Fat + ( u32FatsNb * u32FatSize * u32SectorSize );
+  xFat.pu8Data      = xFat.pu8Root + ( ( ( ( xFat.u32RootNb * EF_DIR_ENTRY_SIZE ) + u32SectorSize - 1 ) / u32SectorSize )
+                                       * u32SectorSize );
+  u32DataStart      = (ef_u32_t) ( xFat.pu8Data - pu8Volume ) / u32SectorSize;
+  xFat.u32ClstNb    = ( u32Sectors - u32DataStart ) / pu8Volume[ EF_BS_BPB_FAT_OFFSET_CLUSTER_SIZE ];
+  /* The FAT type is given by the number of clusters */
+  xFat.u8FatBits    = ( 4085 > xFat.u32ClstNb ) ? 12 : ( 65525 > xFat.u32ClstNb ) ? 16 : 32;
+  xFat.u32EndMin    = ( 12 == xFat.u8FatBits ) ? 0xFF8 : ( 16 == xFat.u8FatBits ) ? 0xFFF8 : 0x0FFFFFF8;
+  xFat.pu8Used      = calloc( xFat.u32ClstNb + 2, 1 );
+
+  if ( 0 == xFat.pu8Used )
+  {
+    s32RetVal = 1;
+  }
+  /* Else, if FAT12/16, the root directory has a fixed area */
+  else if ( 32 != xFat.u8FatBits )
+  {
+    s32RetVal = s32TestFileFatDirectory( &xFat, 0 );
+  }
+  /* Else, if the chain of the root directory is not valid */
+  else if ( 0 != s32TestFileFatChain( &xFat, u32EFPortLoad( pu8Volume + EF_BS_EBPB_FAT32_OFFSET_ROOT_DIRECTORY_NB ),
+                                      &u32Nb ) )
+  {
+    s32RetVal = 14;
+  }
+  else
+  {
+    s32RetVal = s32TestFileFatDirectory( &xFat, u32EFPortLoad( pu8Volume + EF_BS_EBPB_FAT32_OFFSET_ROOT_DIRECTORY_NB ) );
+  }
+
+  /* A cluster in use is in a chain */
+  for ( ef_u32_t u32Cluster = 2 ; ( 0 == s32RetVal ) && ( u32Cluster < ( xFat.u32ClstNb + 2 ) ) ; u32Cluster++ )
+  {
+    if ( 0 == u32TestFileFatGet( &xFat, u32Cluster ) )
+    {
+      u32ClstFree++;
+    }
+    else if ( 0 == xFat.pu8Used[ u32Cluster ] )
+    {
+      s32RetVal = 14;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+  /* The FAT copies are the same */
+  for ( ef_u32_t u32Fat = 1 ; ( 0 == s32RetVal ) && ( u32Fat < u32FatsNb ) ; u32Fat++ )
+  {
+    if ( 0 != memcmp( xFat.pu8Fat, xFat.pu8Fat + ( u32Fat * u32FatSize * u32SectorSize ), u32FatSize * u32SectorSize ) )
+    {
+      s32RetVal = 14;
+    }
+  }
+  /* The free count of the FSINFO sector is unknown or exact */
+  if ( ( 0 == s32RetVal ) && ( 32 == xFat.u8FatBits ) )
+  {
+    u32FsInfoFree = u32EFPortLoad(   pu8Volume
+                                   + ( u16EFPortLoad( pu8Volume + EF_BS_EBPB_FAT32_OFFSET_FS_INFO_SECTOR ) * u32SectorSize )
+                                   + EF_BS_FAT32_FSI_OFFSET_FREE_CLUSTERS );
+    s32RetVal = ( ( 0xFFFFFFFF != u32FsInfoFree ) && ( u32ClstFree != u32FsInfoFree ) ) ? 14 : 0;
+  }
+  free( xFat.pu8Used );
+
+  return s32RetVal;
+}
+
+/* Get the value of a FAT entry */
+static ef_u32_t u32TestFileFatGet (
+  const ef_test_file_fat_st * pxFat,
+  ef_u32_t                    u32Cluster
+)
+{
+  ef_u32_t  u32Value;
+
+  if ( 32 == pxFat->u8FatBits )
+  {
+    u32Value = 0x0FFFFFFF & u32EFPortLoad( pxFat->pu8Fat + ( u32Cluster * 4 ) );
+  }
+  else if ( 16 == pxFat->u8FatBits )
+  {
+    u32Value = u16EFPortLoad( pxFat->pu8Fat + ( u32Cluster * 2 ) );
+  }
+  /* Else, FAT12, two entries share three bytes */
+  else
+  {
+    u32Value = u16EFPortLoad( pxFat->pu8Fat + u32Cluster + ( u32Cluster / 2 ) );
+    u32Value = ( 0 != ( u32Cluster & 1 ) ) ? ( u32Value >> 4 ) : ( u32Value & 0xFFF );
+  }
+
+  return u32Value;
+}
+
+/* Follow a cluster chain and mark its clusters as used */
+static int32_t s32TestFileFatChain (
+  ef_test_file_fat_st * pxFat,
+  ef_u32_t              u32Cluster,
+  ef_u32_t            * pu32Nb
+)
+{
+  int32_t   s32RetVal = 0;
+  ef_bool_t bEnd = EF_BOOL_FALSE;
+
+  *pu32Nb = 0;
+  while ( ( 0 == s32RetVal ) && ( EF_BOOL_FALSE == bEnd ) )
+  {
+    /* If the link is out of the volume, or the cluster is already in a chain */
+    if (    ( 2 > u32Cluster )
+         || ( ( pxFat->u32ClstNb + 2 ) <= u32Cluster )
+         || ( 0 != pxFat->pu8Used[ u32Cluster ] ) )
+    {
+      s32RetVal = 14;
+    }
+    else
+    {
+      pxFat->pu8Used[ u32Cluster ] = 1;
+      ( *pu32Nb )++;
+      u32Cluster  = u32TestFileFatGet( pxFat, u32Cluster );
+      bEnd        = ( pxFat->u32EndMin <= u32Cluster ) ? EF_BOOL_TRUE : EF_BOOL_FALSE;
+    }
+  }
+
+  return s32RetVal;
+}
+
+/* Check the chains of the entries of a directory */
+static int32_t s32TestFileFatDirectory (
+  ef_test_file_fat_st * pxFat,
+  ef_u32_t              u32Cluster
+)
+{
+  int32_t           s32RetVal = 0;
+  ef_bool_t         bEnd = EF_BOOL_FALSE;
+  const ef_u08_t  * pu8Entries = ( 0 == u32Cluster ) ? pxFat->pu8Root
+                                                     : ( pxFat->pu8Data + ( ( u32Cluster - 2 ) * pxFat->u32ClstBytes ) );
+  ef_u32_t          u32EntriesNb = ( 0 == u32Cluster ) ? pxFat->u32RootNb : ( pxFat->u32ClstBytes / EF_DIR_ENTRY_SIZE );
+  const ef_u08_t  * pu8Entry;
+  ef_u32_t          u32First;
+  ef_u32_t          u32Size;
+  ef_u32_t          u32Nb;
+
+  while ( ( 0 == s32RetVal ) && ( EF_BOOL_FALSE == bEnd ) )
+  {
+    for ( ef_u32_t u32Entry = 0 ; ( 0 == s32RetVal ) && ( EF_BOOL_FALSE == bEnd ) && ( u32Entry < u32EntriesNb ) ; u32Entry++ )
+    {
+      pu8Entry  = pu8Entries + ( u32Entry * EF_DIR_ENTRY_SIZE );
+      u32First  = u16EFPortLoad( pu8Entry + EF_DIR_FIRST_CLUSTER_LOW );
+      u32First |= ( 32 == pxFat->u8FatBits ) ? ( (ef_u32_t) u16EFPortLoad( pu8Entry + EF_DIR_FIRST_CLUSTER_HI ) << 16 ) : 0;
+      u32Size   = u32EFPortLoad( pu8Entry + EF_DIR_FILE_SIZE );
+      /* If the end of the directory */
+      if ( 0 == pu8Entry[ EF_DIR_NAME_START ] )
+      {
+        bEnd = EF_BOOL_TRUE;
+      }
+      /* Else, if a deleted entry, a long name entry, the volume label or a dot entry */
+      else if (    ( EF_DIR_DELETED_MASK == pu8Entry[ EF_DIR_NAME_START ] )
+                || ( '.' == pu8Entry[ EF_DIR_NAME_START ] )
+                || ( 0 != ( EF_DIR_ATTRIB_BIT_VOLUME_ID & pu8Entry[ EF_DIR_ATTRIBUTES ] ) ) )
+      {
+        EF_CODE_COVERAGE( );
+      }
+      /* Else, if a sub-directory */
+      else if ( 0 != ( EF_DIR_ATTRIB_BIT_DIRECTORY & pu8Entry[ EF_DIR_ATTRIBUTES ] ) )
+      {
+        s32RetVal = s32TestFileFatChain( pxFat, u32First, &u32Nb );
+        s32RetVal = ( 0 == s32RetVal ) ? s32TestFileFatDirectory( pxFat, u32First ) : s32RetVal;
+      }
+      /* Else, if a file without cluster */
+      else if ( 0 == u32First )
+      {
+        s32RetVal = ( 0 != u32Size ) ? 14 : 0;
+      }
+      /* Else, the chain of the file holds its data and nothing more */
+      else
+      {
+        s32RetVal = s32TestFileFatChain( pxFat, u32First, &u32Nb );
+        if ( ( 0 == s32RetVal ) && ( u32Nb != ( ( 0 == u32Size ) ? 1 : ( ( u32Size - 1 ) / pxFat->u32ClstBytes ) + 1 ) ) )
+        {
+          s32RetVal = 14;
+        }
+      }
+    }
+
+    /* The next cluster of the directory, its chain is already checked */
+    if ( ( 0 != s32RetVal ) || ( EF_BOOL_FALSE != bEnd ) || ( 0 == u32Cluster ) )
+    {
+      bEnd = EF_BOOL_TRUE;
+    }
+    else if ( pxFat->u32EndMin <= u32TestFileFatGet( pxFat, u32Cluster ) )
+    {
+      bEnd = EF_BOOL_TRUE;
+    }
+    else
+    {
+      u32Cluster  = u32TestFileFatGet( pxFat, u32Cluster );
+      pu8Entries  = pxFat->pu8Data + ( ( u32Cluster - 2 ) * pxFat->u32ClstBytes );
+    }
+  }
+
+  return s32RetVal;
+}
+
+/* Check the bytes forwarded against the test data */
+static ef_u32_t u32TestFileStream (
+  const ef_u08_t  * pu8Data,
+  ef_u32_t          u32Count
+)
+{
+  /* If this is the sense call */
+  if ( 0 == pu8Data )
+  {
+    u32Count = 1;
+  }
+  else
+  {
+    u32Count = ( 700 < u32Count ) ? 700 : u32Count;
+    for ( ef_u32_t i = 0 ; i < u32Count ; i++ )
+    {
+      if ( pu8Data[ i ] != u8TestFileData( u32TestFileStreamOffset + i ) )
+      {
+        s32TestFileStreamFail = 7;
+      }
+    }
+    u32TestFileStreamOffset += u32Count;
+  }
+
+  return u32Count;
+}
+
+/* Give the inverted test data */
+static ef_u32_t u32TestFileProduce (
+  ef_u08_t  * pu8Data,
+  ef_u32_t    u32Count
+)
+{
+  u32Count = ( 900 < u32Count ) ? 900 : u32Count;
+  u32Count = ( ( u32TestFileProduceEnd - u32TestFileProduceOffset ) < u32Count )
+           ? ( u32TestFileProduceEnd - u32TestFileProduceOffset ) : u32Count;
+  for ( ef_u32_t i = 0 ; i < u32Count ; i++ )
+  {
+    pu8Data[ i ] = (ef_u08_t) ~u8TestFileData( u32TestFileProduceOffset + i );
+  }
+  u32TestFileProduceOffset += u32Count;
+
+  return u32Count;
+}
+
+/* Read a file back and check the inverted range */
+static int32_t s32TestFileCheckInverted (
+  const TCHAR * pxPath,
+  ef_u32_t      u32Size,
+  ef_u32_t      u32First,
+  ef_u32_t      u32End
+)
+{
+  int32_t   s32RetVal = 0;
+  EF_FILE   xFile;
+  ef_u32_t  u32Offset = 0;
+  ef_u32_t  u32Done = 0;
+  ef_u08_t  u8Expected;
+
+  if ( EF_RET_OK != eEF_fopen( &xFile, pxPath, EF_FILE_OPEN_EXISTING ) )
+  {
+    s32RetVal = 5;
+  }
+  else
+  {
+    /* Read up to an empty read at the end of the file */
+    do
+    {
+      if (    ( EF_RET_OK != eEF_fread( &xFile, u8TestFileBuffer, 4096, &u32Done ) )
+           || ( u32Done != ( ( 4096 < ( u32Size - u32Offset ) ) ? 4096 : ( u32Size - u32Offset ) ) ) )
+      {
+        s32RetVal = 5;
+      }
+      for ( ef_u32_t i = 0 ; ( 0 == s32RetVal ) && ( i < u32Done ) ; i++ )
+      {
+        u8Expected = u8TestFileData( u32Offset + i );
+        if ( ( u32First <= ( u32Offset + i ) ) && ( u32End > ( u32Offset + i ) ) )
+        {
+          u8Expected = (ef_u08_t) ~u8Expected;
+        }
+        if ( u8TestFileBuffer[ i ] != u8Expected )
+        {
+          s32RetVal = 7;
+        }
+      }
+      u32Offset += u32Done;
+    } while ( ( 0 == s32RetVal ) && ( 0 != u32Done ) );
+
+    if ( ( EF_RET_OK != eEF_fclose( &xFile ) ) && ( 0 == s32RetVal ) )
+    {
+      s32RetVal = 5;
+    }
+  }
+
+  return s32RetVal;
+}
+
+#if ( 0 != EF_CONF_FILE_DIGEST )
+/* Hash the bytes in order */
+static void vTestFileDigest (
+  void            * pvContext,
+  const ef_u08_t  * pu8Data,
+  ef_u32_t          u32Size
+)
+{
+  ef_test_file_digest_st  * pxDigest = (ef_test_file_digest_st *) pvContext;
+
+  for ( ef_u32_t i = 0 ; i < u32Size ; i++ )
+  {
+    pxDigest->u32Hash = ( pxDigest->u32Hash * 31 ) + pu8Data[ i ];
+  }
+  pxDigest->u32Count += u32Size;
+}
+#endif
+
+/* Public functions ------------------------------------------------------------------------------------------------ */
+
+/* Check that each registered drive gets its own physical drive number */
+int32_t s32TestFileDriveRegister (
+  void
+)
+{
+  int32_t   s32RetVal;
+  ef_u32_t  u32ClstFree;
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 1 );
+  if ( 0 == s32RetVal )
+  {
+    s32RetVal = s32TestFileVolume( 1, EF_TEST_FILE_CLST_NB + 100, 1 );
+  }
+
+  /* The root directory takes one cluster of each volume */
+  for ( ef_u08_t v = 0 ; ( v < EF_TEST_FILE_DRIVES_NB ) && ( 0 == s32RetVal ) ; v++ )
+  {
+    if (    ( EF_RET_OK != eEF_mount( "A:", v, 0, 0 ) )
+         || ( EF_RET_OK != eEF_getfree( "A:", &u32ClstFree ) ) )
+    {
+      s32RetVal = 3;
+    }
+    else if ( ( EF_TEST_FILE_CLST_NB + ( 100u * v ) - 1 ) != u32ClstFree )
+    {
+      s32RetVal = 4;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    (void) eEF_umount( "A:" );
+  }
+
+  return s32RetVal;
+}
+
+/* Check that the clusters of a written file are allocated in the FAT */
+int32_t s32TestFileWrite (
+  void
+)
+{
+  int32_t   s32RetVal;
+  ef_u32_t  u32ClstFree;
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 1 );
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+  {
+    s32RetVal = 3;
+  }
+  else if ( EF_RET_OK != eTestFileWrite( "A:FILE.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW, 10000, 700 ) )
+  {
+    s32RetVal = 5;
+  }
+  else if ( EF_RET_OK != eEF_getfree( "A:", &u32ClstFree ) )
+  {
+    s32RetVal = 5;
+  }
+  /* The root directory and the 20 sectors of the file */
+  else if ( ( EF_TEST_FILE_CLST_NB - 1 - 20 ) != u32ClstFree )
+  {
+    s32RetVal = 6;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+  (void) eEF_umount( "A:" );
+
+  return s32RetVal;
+}
+
+/* Check that an existing file is found and read back */
+int32_t s32TestFileRead (
+  void
+)
+{
+  const ef_u32_t  u32Chunks[ ] = { 700, 512, 3000 };
+  int32_t         s32RetVal;
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 1 );
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+  {
+    s32RetVal = 3;
+  }
+  else if (    ( EF_RET_OK != eTestFileWrite( "A:FILE1.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW, 10000, 700 ) )
+            || ( EF_RET_OK != eTestFileWrite( "A:FILE2.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW, 5000, 1024 ) ) )
+  {
+    s32RetVal = 5;
+  }
+  else
+  {
+    s32RetVal = s32TestFileCheck( "A:FILE1.BIN", 10000, u32Chunks, 3 );
+    if ( 0 == s32RetVal )
+    {
+      s32RetVal = s32TestFileCheck( "A:FILE2.BIN", 5000, u32Chunks, 3 );
+    }
+  }
+  (void) eEF_umount( "A:" );
+
+  return s32RetVal;
+}
+
+/* Check that a file opened in truncate mode is emptied and its clusters freed */
+int32_t s32TestFileTruncate (
+  void
+)
+{
+  const ef_u08_t  u8Mode = EF_FILE_OPEN_WRITE | EF_FILE_OPEN_ANYWAY | EF_FILE_OPEN_TRUNCATE;
+  const ef_u32_t  u32Chunk = 1000;
+  int32_t         s32RetVal;
+  ef_u32_t        u32ClstFree;
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 1 );
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+  {
+    s32RetVal = 3;
+  }
+  /* A file truncated then rewritten shorter, and an empty file truncated */
+  else if (    ( EF_RET_OK != eTestFileWrite( "A:FILE.BIN", u8Mode, 10000, 700 ) )
+            || ( EF_RET_OK != eTestFileWrite( "A:FILE.BIN", u8Mode, 3000, 700 ) )
+            || ( EF_RET_OK != eTestFileWrite( "A:EMPTY.BIN", u8Mode, 0, 700 ) )
+            || ( EF_RET_OK != eTestFileWrite( "A:EMPTY.BIN", u8Mode, 0, 700 ) )
+            || ( EF_RET_OK != eEF_getfree( "A:", &u32ClstFree ) ) )
+  {
+    s32RetVal = 5;
+  }
+  /* The root directory and the 6 sectors of the file */
+  else if ( ( EF_TEST_FILE_CLST_NB - 1 - 6 ) != u32ClstFree )
+  {
+    s32RetVal = 6;
+  }
+  else
+  {
+    s32RetVal = s32TestFileCheck( "A:FILE.BIN", 3000, &u32Chunk, 1 );
+    if ( 0 == s32RetVal )
+    {
+      s32RetVal = s32TestFileCheck( "A:EMPTY.BIN", 0, &u32Chunk, 1 );
+    }
+  }
+  (void) eEF_umount( "A:" );
+  if ( 0 == s32RetVal )
+  {
+    s32RetVal = s32TestFileFatCheck( 0, 0 );
+  }
+
+  return s32RetVal;
+}
+
+/* Check unaligned sequential reads through multi-sector clusters */
+int32_t s32TestFileReadUnaligned (
+  void
+)
+{
+  const ef_u32_t  u32Chunks[ ] = { 1000, 60000, 333, 4096, 513, 2048 };
+  int32_t         s32RetVal;
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 4 );
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+  {
+    s32RetVal = 3;
+  }
+  else if ( EF_RET_OK != eTestFileWrite( "A:FILE.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW, 300000, 65536 ) )
+  {
+    s32RetVal = 5;
+  }
+  else
+  {
+    s32RetVal = s32TestFileCheck( "A:FILE.BIN", 300000, u32Chunks, sizeof( u32Chunks ) / sizeof( u32Chunks[ 0 ] ) );
+  }
+  (void) eEF_umount( "A:" );
+
+  return s32RetVal;
+}
+
+#if ( 0 != EF_CONF_FILE_RESERVE )
+/* Check the clusters reserved for two files growing side by side */
+int32_t s32TestFileReserve (
+  void
+)
+{
+  /* Clusters reserved and written for each file */
+  static const ef_u32_t u32Clusters[ 2 ][ 2 ] = { { 20, 12 }, { 20, 24 } };
+  static const TCHAR * const pxPaths[ 2 ] = { "A:LOG1.BIN", "A:LOG2.BIN" };
+  const ef_u32_t  u32Chunks[ ] = { 700 };
+  int32_t         s32RetVal;
+  EF_FILE         xFiles[ 2 ];
+  ef_u32_t        u32ClstFree;
+  ef_u32_t        u32ClstFreeOrg = 0;
+  ef_u32_t        u32Done;
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 1 );
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if (    ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+            || ( EF_RET_OK != eEF_getfree( "A:", &u32ClstFreeOrg ) ) )
+  {
+    s32RetVal = 3;
+  }
+  else if (    ( EF_RET_OK != eEF_fopen( &xFiles[ 0 ], pxPaths[ 0 ], EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW ) )
+            || ( EF_RET_OK != eEF_fopen( &xFiles[ 1 ], pxPaths[ 1 ], EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW ) )
+            || ( EF_RET_OK != eEF_reserve( &xFiles[ 0 ], u32Clusters[ 0 ][ 0 ] * EF_TEST_FILE_SECTOR_SIZE ) )
+            || ( EF_RET_OK != eEF_reserve( &xFiles[ 1 ], u32Clusters[ 1 ][ 0 ] * EF_TEST_FILE_SECTOR_SIZE ) )
+            || ( EF_RET_OK != eEF_getfree( "A:", &u32ClstFree ) ) )
+  {
+    s32RetVal = 5;
+  }
+  /* The reserved clusters are allocated */
+  else if ( ( u32ClstFreeOrg - u32Clusters[ 0 ][ 0 ] - u32Clusters[ 1 ][ 0 ] ) != u32ClstFree )
+  {
+    s32RetVal = 6;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  /* Write a cluster to each file in turn, the second file grows past its reservation */
+  for ( ef_u32_t u32Clst = 0 ; ( 0 == s32RetVal ) && ( u32Clst < u32Clusters[ 1 ][ 1 ] ) ; u32Clst++ )
+  {
+    for ( ef_u32_t f = 0 ; ( 0 == s32RetVal ) && ( f < 2 ) ; f++ )
+    {
+      for ( ef_u32_t i = 0 ; i < EF_TEST_FILE_SECTOR_SIZE ; i++ )
+      {
+        u8TestFileBuffer[ i ] = u8TestFileData( ( u32Clst * EF_TEST_FILE_SECTOR_SIZE ) + i );
+      }
+      if (    ( u32Clst < u32Clusters[ f ][ 1 ] )
+           && (    ( EF_RET_OK != eEF_fwrite( &xFiles[ f ], u8TestFileBuffer, EF_TEST_FILE_SECTOR_SIZE, &u32Done ) )
+                || ( EF_TEST_FILE_SECTOR_SIZE != u32Done ) ) )
+      {
+        s32RetVal = 5;
+      }
+    }
+  }
+
+  /* The clusters not written are given back on closing */
+  if (    ( 0 == s32RetVal )
+       && (    ( EF_RET_OK != eEF_fclose( &xFiles[ 0 ] ) )
+            || ( EF_RET_OK != eEF_fclose( &xFiles[ 1 ] ) )
+            || ( EF_RET_OK != eEF_getfree( "A:", &u32ClstFree ) ) ) )
+  {
+    s32RetVal = 5;
+  }
+  else if (    ( 0 == s32RetVal )
+            && ( ( u32ClstFreeOrg - u32Clusters[ 0 ][ 1 ] - u32Clusters[ 1 ][ 1 ] ) != u32ClstFree ) )
+  {
+    s32RetVal = 6;
+  }
+  else if (    ( 0 == s32RetVal )
+            && (    ( 0 != s32TestFileCheck( pxPaths[ 0 ], u32Clusters[ 0 ][ 1 ] * EF_TEST_FILE_SECTOR_SIZE, u32Chunks, 1 ) )
+                 || ( 0 != s32TestFileCheck( pxPaths[ 1 ], u32Clusters[ 1 ][ 1 ] * EF_TEST_FILE_SECTOR_SIZE, u32Chunks, 1 ) ) ) )
+  {
+    s32RetVal = 7;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  /* A file opened for reading cannot reserve, a reservation is released with 0 */
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if (    ( EF_RET_OK != eEF_fopen( &xFiles[ 0 ], pxPaths[ 0 ], EF_FILE_OPEN_EXISTING ) )
+            || ( EF_RET_DENIED != eEF_reserve( &xFiles[ 0 ], EF_TEST_FILE_SECTOR_SIZE ) )
+            || ( EF_RET_OK != eEF_fclose( &xFiles[ 0 ] ) )
+            || ( EF_RET_OK != eEF_fopen( &xFiles[ 0 ], pxPaths[ 0 ], EF_FILE_OPEN_WRITE | EF_FILE_OPEN_EXISTING ) )
+            || ( EF_RET_OK != eEF_reserve( &xFiles[ 0 ], 10 * EF_TEST_FILE_SECTOR_SIZE ) )
+            || ( EF_RET_OK != eEF_reserve( &xFiles[ 0 ], 0 ) )
+            || ( EF_RET_OK != eEF_fclose( &xFiles[ 0 ] ) )
+            || ( EF_RET_OK != eEF_getfree( "A:", &u32ClstFreeOrg ) ) )
+  {
+    s32RetVal = 5;
+  }
+  else if ( u32ClstFreeOrg != u32ClstFree )
+  {
+    s32RetVal = 6;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+  (void) eEF_umount( "A:" );
+
+  return s32RetVal;
+}
+#endif
+
+#if ( 0 != EF_CONF_NON_BLOCKING )
+/* Check unaligned sequential non-blocking reads through multi-sector clusters */
+int32_t s32TestFileReadNbUnaligned (
+  void
+)
+{
+  const ef_u32_t  u32Chunks[ ] = { 1000, 60000, 333, 4096, 513, 2048 };
+  int32_t         s32RetVal;
+  EF_FILE         xFile;
+  ef_return_et    eResult;
+  ef_u32_t        u32Offset = 0;
+  ef_u32_t        u32Done = 0;
+  ef_u32_t        u32Chunk = 0;
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 4 );
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+  {
+    s32RetVal = 3;
+  }
+  else if (    ( EF_RET_OK != eTestFileWrite( "A:FILE.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW, 300000, 65536 ) )
+            || ( EF_RET_OK != eEF_fopen( &xFile, "A:FILE.BIN", EF_FILE_OPEN_EXISTING ) ) )
+  {
+    s32RetVal = 5;
+  }
+  else
+  {
+    /* Read up to an empty read at the end of the file */
+    do
+    {
+      do
+      {
+        eResult = eEF_fread_nb( &xFile, u8TestFileBuffer, u32Chunks[ u32Chunk ], &u32Done );
+      } while ( EF_RET_PENDING == eResult );
+      if ( EF_RET_OK != eResult )
+      {
+        s32RetVal = 5;
+      }
+      for ( ef_u32_t i = 0 ; ( 0 == s32RetVal ) && ( i < u32Done ) ; i++ )
+      {
+        if ( u8TestFileBuffer[ i ] != u8TestFileData( u32Offset + i ) )
+        {
+          s32RetVal = 7;
+        }
+      }
+      u32Offset += u32Done;
+      u32Chunk   = ( u32Chunk + 1 ) % ( sizeof( u32Chunks ) / sizeof( u32Chunks[ 0 ] ) );
+    } while ( ( 0 == s32RetVal ) && ( 0 != u32Done ) );
+
+    if ( ( 0 == s32RetVal ) && ( 300000 != u32Offset ) )
+    {
+      s32RetVal = 7;
+    }
+    if ( ( EF_RET_OK != eEF_fclose( &xFile ) ) && ( 0 == s32RetVal ) )
+    {
+      s32RetVal = 5;
+    }
+  }
+  (void) eEF_umount( "A:" );
+
+  return s32RetVal;
+}
+#endif
+
+#if ( 2 == EF_CONF_RELATIVE_PATH )
+/* Check the current directory path through changes of directory */
+int32_t s32TestFileCwd (
+  void
+)
+{
+  /* New current directory and expected path */
+  static const char * const pcSteps[ ][ 2 ] = {
+    { "A:D1/D2",  "/D1/D2" },
+    { "A:/",      "/" },
+    { "A:D1",     "/D1" },
+    { "D2",       "/D1/D2" },
+    { "..",       "/D1" },
+    { "./d2",     "/D1/D2" },
+    { "../..",    "/" },
+    { "/D1/D2/..", "/D1" },
+#if ( 0 != EF_CONF_VFAT )
+    { "long DIR", "/D1/Long dir" },
+    { "../LONGDI~1/..", "/D1" }
+#else
+    { "D2/../.",  "/D1" }
+#endif
+  };
+  const ef_u32_t  u32Prefix = ( 2 <= EF_CONF_VOLUMES_NB ) ? 2 : 0;
+  int32_t         s32RetVal;
+  TCHAR           xPath[ 32 ];
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 1 );
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+  {
+    s32RetVal = 3;
+  }
+  else if (    ( EF_RET_OK != eEF_dirmake( "A:D1" ) )
+            || ( EF_RET_OK != eEF_dirmake( "A:D1/D2" ) )
+#if ( 0 != EF_CONF_VFAT )
+            || ( EF_RET_OK != eEF_dirmake( "A:D1/Long dir" ) )
+#endif
+          )
+  {
+    s32RetVal = 5;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  for ( ef_u32_t u32Step = 0 ; ( 0 == s32RetVal ) && ( u32Step < ( sizeof( pcSteps ) / sizeof( pcSteps[ 0 ] ) ) ) ; u32Step++ )
+  {
+    s32RetVal = ( EF_RET_OK != eEF_chdir( pcSteps[ u32Step ][ 0 ] ) ) ? 5 : 0;
+    /* Twice, the second time from the cache when enabled */
+    for ( ef_u32_t i = 0 ; ( 0 == s32RetVal ) && ( i < 2 ) ; i++ )
+    {
+      if ( EF_RET_OK != eEF_getcwd( xPath, sizeof( xPath ) ) )
+      {
+        s32RetVal = 5;
+      }
+      else if ( 0 != strcmp( xPath + u32Prefix, pcSteps[ u32Step ][ 1 ] ) )
+      {
+        s32RetVal = 8;
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+    }
+  }
+
+  /* The path does not fit in the buffer */
+  if (    ( 0 == s32RetVal )
+       && ( EF_RET_NOT_ENOUGH_CORE != eEF_getcwd( xPath, u32Prefix + 3 ) ) )
+  {
+    s32RetVal = 8;
+  }
+  /* A failed change of directory keeps the current directory */
+  else if (    ( 0 == s32RetVal )
+            && (    ( EF_RET_OK == eEF_chdir( "D2/NONE" ) )
+                 || ( EF_RET_OK != eEF_getcwd( xPath, sizeof( xPath ) ) )
+                 || ( 0 != strcmp( xPath + u32Prefix, "/D1" ) ) ) )
+  {
+    s32RetVal = 8;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+  (void) eEF_umount( "A:" );
+
+  return s32RetVal;
+}
+#endif
+
+#if ( 0 != EF_CONF_VFAT )
+/* Check long file names, and the return of the LFN working buffers after each name operation */
+int32_t s32TestFileLongName (
+  void
+)
+{
+  static const ef_u32_t u32Chunks[ ] = { 100 };
+  int32_t         s32RetVal;
+  EF_FILE         xFile;
+  ef_file_info_st xInfo;
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 1 );
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+  {
+    s32RetVal = 3;
+  }
+  /* Two names with the same short name, in a directory with a long name */
+  else if (    ( EF_RET_OK != eEF_dirmake( "A:Long Directory" ) )
+            || ( EF_RET_OK != eTestFileWrite( "A:Long Directory/Long File Name.text", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW, 1000, 100 ) )
+            || ( EF_RET_OK != eTestFileWrite( "A:Long Directory/Long File Number Two.text", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW, 600, 100 ) ) )
+  {
+    s32RetVal = 5;
+  }
+  /* The names are found whatever their case */
+  else if (    ( 0 != s32TestFileCheck( "A:long directory/LONG FILE NAME.TEXT", 1000, u32Chunks, 1 ) )
+            || ( 0 != s32TestFileCheck( "A:LONG DIRECTORY/long file number two.text", 600, u32Chunks, 1 ) ) )
+  {
+    s32RetVal = 7;
+  }
+  else if ( EF_RET_OK != eEF_stat( "A:Long Directory/LONG FILE NUMBER TWO.TEXT", &xInfo ) )
+  {
+    s32RetVal = 5;
+  }
+  /* The long name is reported as looked up, the short names are numbered */
+  else if (    ( 0 != strcmp( xInfo.xName, "LONG FILE NUMBER TWO.TEXT" ) )
+            || ( 0 != strcmp( xInfo.xNameAlt, "LONGFI~2.TEX" ) )
+            || ( 600 != xInfo.u32FileSize ) )
+  {
+    s32RetVal = 7;
+  }
+  else if (    ( EF_RET_OK != eEF_remove( "A:Long Directory/Long File Name.text" ) )
+            || ( EF_RET_OK == eEF_stat( "A:Long Directory/Long File Name.text", &xInfo ) ) )
+  {
+    s32RetVal = 5;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  /* More name operations, failing ones too, than buffers in a pool */
+  for ( ef_u32_t i = 0 ; ( 0 == s32RetVal ) && ( i < 8 ) ; i++ )
+  {
+    if (    ( EF_RET_OK == eEF_fopen( &xFile, "A:Long Directory/Long File Name.text", EF_FILE_OPEN_EXISTING ) )
+         || ( EF_RET_OK != eEF_stat( "A:Long Directory/Long File Number Two.text", &xInfo ) ) )
+    {
+      s32RetVal = 5;
+    }
+  }
+  (void) eEF_umount( "A:" );
+
+  return s32RetVal;
+}
+#endif
+
+/* Check the lines read from a text file spread over several sectors and clusters */
+int32_t s32TestFileGetline (
+  void
+)
+{
+  /* Line buffer sizes: whole lines, then lines split over several calls */
+  static const ef_u32_t u32Sizes[ ] = { EF_TEST_FILE_LINE_SIZE, 10 };
+  int32_t   s32RetVal;
+  EF_FILE   xFile;
+  TCHAR     xLine[ EF_TEST_FILE_LINE_SIZE ];
+  ef_u32_t  u32TextSize = 0;
+  ef_u32_t  u32Offset;
+  ef_u32_t  u32Length;
+  ef_u32_t  u32Done;
+
+  /* "Line nn " followed by a run of letters of varying length */
+  for ( ef_u32_t i = 0 ; i < EF_TEST_FILE_LINES_NB ; i++ )
+  {
+    (void) memcpy( &u8TestFileBuffer[ u32TextSize ], "Line ", 5 );
+    u8TestFileBuffer[ u32TextSize + 5 ] = (ef_u08_t) ( '0' + ( i / 10 ) );
+    u8TestFileBuffer[ u32TextSize + 6 ] = (ef_u08_t) ( '0' + ( i % 10 ) );
+    u8TestFileBuffer[ u32TextSize + 7 ] = ' ';
+    u32TextSize += 8;
+    for ( ef_u32_t j = 0 ; j < ( ( i * 13 ) % 47 ) ; j++ )
+    {
+      u8TestFileBuffer[ u32TextSize++ ] = (ef_u08_t) ( 'a' + ( i % 26 ) );
+    }
+    u8TestFileBuffer[ u32TextSize++ ] = '\n';
+  }
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 1 );
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+  {
+    s32RetVal = 3;
+  }
+  else if (    ( EF_RET_OK != eEF_fopen( &xFile, "A:TEXT.TXT", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW ) )
+            || ( EF_RET_OK != eEF_fwrite( &xFile, u8TestFileBuffer, u32TextSize, &u32Done ) )
+            || ( u32TextSize != u32Done )
+            || ( EF_RET_OK != eEF_fclose( &xFile ) ) )
+  {
+    s32RetVal = 5;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  for ( ef_u32_t s = 0 ; ( 0 == s32RetVal ) && ( s < ( sizeof( u32Sizes ) / sizeof( u32Sizes[ 0 ] ) ) ) ; s++ )
+  {
+    u32Offset = 0;
+    if ( EF_RET_OK != eEF_fopen( &xFile, "A:TEXT.TXT", EF_FILE_OPEN_EXISTING ) )
+    {
+      s32RetVal = 5;
+    }
+    /* Read up to an empty line at the end of the file, each line continues the text */
+    do
+    {
+      if (    ( 0 == s32RetVal )
+           && ( EF_RET_OK != eEF_getline( &xFile, xLine, u32Sizes[ s ], &u32Length ) ) )
+      {
+        s32RetVal = 5;
+      }
+      else if (    ( 0 == s32RetVal )
+                && (    ( u32Length >= u32Sizes[ s ] )
+                     || ( ( u32Offset + u32Length ) > u32TextSize )
+                     || ( 0 != xLine[ u32Length ] )
+                     || ( 0 != memcmp( xLine, &u8TestFileBuffer[ u32Offset ], u32Length ) ) ) )
+      {
+        s32RetVal = 7;
+      }
+      /* A line is only cut short by the buffer */
+      else if (    ( 0 == s32RetVal )
+                && ( 0 != u32Length )
+                && ( '\n' != xLine[ u32Length - 1 ] )
+                && ( ( u32Sizes[ s ] - 1 ) != u32Length ) )
+      {
+        s32RetVal = 7;
+      }
+      else
+      {
+        u32Offset += u32Length;
+      }
+    } while ( ( 0 == s32RetVal ) && ( 0 != u32Length ) );
+
+    if ( ( 0 == s32RetVal ) && ( u32TextSize != u32Offset ) )
+    {
+      s32RetVal = 7;
+    }
+    (void) eEF_fclose( &xFile );
+  }
+
+  /* A closed file is rejected before its window is looked at, inside a sector too */
+  if (    ( 0 == s32RetVal )
+       && (    ( EF_RET_OK != eEF_fopen( &xFile, "A:TEXT.TXT", EF_FILE_OPEN_EXISTING ) )
+            || ( EF_RET_OK != eEF_getline( &xFile, xLine, 4, &u32Length ) )
+            || ( EF_RET_OK != eEF_fclose( &xFile ) )
+            || ( EF_RET_INVALID_OBJECT != eEF_getline( &xFile, xLine, u32Sizes[ 0 ], &u32Length ) ) ) )
+  {
+    s32RetVal = 5;
+  }
+  (void) eEF_umount( "A:" );
+
+  return s32RetVal;
+}
+
+/* Check the data forwarded to a stream, and that an aborted file forwards nothing */
+int32_t s32TestFileForward (
+  void
+)
+{
+  int32_t   s32RetVal;
+  EF_FILE   xFile;
+  ef_u32_t  u32Done = 0;
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 2 );
+  u32TestFileStreamOffset = 100;
+  s32TestFileStreamFail = 0;
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+  {
+    s32RetVal = 3;
+  }
+  else if (    ( EF_RET_OK != eTestFileWrite( "A:FWD.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW, 20000, 4096 ) )
+            || ( EF_RET_OK != eEF_fopen( &xFile, "A:FWD.BIN", EF_FILE_OPEN_EXISTING ) ) )
+  {
+    s32RetVal = 5;
+  }
+  /* Forward from the middle of a sector, through the window then by runs */
+  else if (    ( EF_RET_OK != eEF_fseek( &xFile, 100 ) )
+            || ( EF_RET_OK != eEF_forward( &xFile, u32TestFileStream, 1000, &u32Done ) )
+            || ( 1000 != u32Done )
+            || ( EF_RET_OK != eEF_forward_buffered( &xFile, u32TestFileStream, u8TestFileBuffer, 4096, 30000, &u32Done ) )
+            || ( ( 20000 - 1100 ) != u32Done ) )
+  {
+    s32RetVal = 5;
+  }
+  else if ( ( 0 != s32TestFileStreamFail ) || ( 20000 != u32TestFileStreamOffset ) )
+  {
+    s32RetVal = 7;
+  }
+  else
+  {
+    /* Once aborted, the file forwards nothing, from the middle of a sector or from a sector boundary */
+    xFile.u8ErrorCode = (ef_u08_t) EF_RET_DISK_ERR;
+    u32TestFileStreamOffset = 100;
+    if (    ( EF_RET_OK != eEF_fseek( &xFile, 100 ) )
+         || ( EF_RET_DISK_ERR != eEF_forward( &xFile, u32TestFileStream, 1000, &u32Done ) )
+         || ( 0 != u32Done )
+         || ( EF_RET_DISK_ERR != eEF_forward_buffered( &xFile, u32TestFileStream, u8TestFileBuffer, 4096, 1000,
+                                                       &u32Done ) )
+         || ( 0 != u32Done )
+         || ( EF_RET_OK != eEF_fseek( &xFile, 512 ) )
+         || ( EF_RET_DISK_ERR != eEF_forward_buffered( &xFile, u32TestFileStream, u8TestFileBuffer, 4096, 1000,
+                                                       &u32Done ) )
+         || ( 0 != u32Done )
+         || ( 100 != u32TestFileStreamOffset ) )
+    {
+      s32RetVal = 5;
+    }
+    xFile.u8ErrorCode = (ef_u08_t) EF_RET_OK;
+    (void) eEF_fclose( &xFile );
+  }
+  (void) eEF_umount( "A:" );
+
+  return s32RetVal;
+}
+
+/* Check the data received at the end of a file, and over the middle of a file */
+int32_t s32TestFileReceive (
+  void
+)
+{
+  /* Ranges received: appended with a run buffer, over the file with and without a run buffer */
+  static const ef_u32_t u32Ranges[ 3 ][ 2 ] = { { 3000, 23000 }, { 5077, 15077 }, { 15077, 15777 } };
+  int32_t   s32RetVal;
+  EF_FILE   xFile;
+  ef_u32_t  u32ClstFree;
+  ef_u32_t  u32ClstFreeOrg = 0;
+  ef_u32_t  u32Done = 0;
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 2 );
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if (    ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+            || ( EF_RET_OK != eEF_getfree( "A:", &u32ClstFreeOrg ) ) )
+  {
+    s32RetVal = 3;
+  }
+  else if ( EF_RET_OK != eTestFileWrite( "A:RCV.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW, u32Ranges[ 0 ][ 0 ],
+                                         4096 ) )
+  {
+    s32RetVal = 5;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  /* Append from the middle of a sector, the data received past the producer end is not requested */
+  u32TestFileProduceOffset = u32Ranges[ 0 ][ 0 ];
+  u32TestFileProduceEnd = u32Ranges[ 0 ][ 1 ];
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if (    ( EF_RET_OK != eEF_fopen( &xFile, "A:RCV.BIN",
+                                         EF_FILE_OPEN_WRITE | EF_FILE_OPEN_EXISTING | EF_FILE_OPEN_APPEND ) )
+            || ( EF_RET_OK != eEF_receive( &xFile, u32TestFileProduce, u8TestFileBuffer, 4096, 30000, &u32Done ) )
+            || ( ( u32Ranges[ 0 ][ 1 ] - u32Ranges[ 0 ][ 0 ] ) != u32Done )
+            || ( EF_RET_OK != eEF_fclose( &xFile ) )
+            || ( EF_RET_OK != eEF_getfree( "A:", &u32ClstFree ) ) )
+  {
+    s32RetVal = 5;
+  }
+  /* The clusters linked past the data are released */
+  else if ( ( u32ClstFreeOrg - ( ( u32Ranges[ 0 ][ 1 ] + 1023 ) / 1024 ) ) != u32ClstFree )
+  {
+    s32RetVal = 6;
+  }
+  else
+  {
+    s32RetVal = s32TestFileCheckInverted( "A:RCV.BIN", u32Ranges[ 0 ][ 1 ], u32Ranges[ 0 ][ 0 ], u32Ranges[ 0 ][ 1 ] );
+  }
+
+  /* Overwrite the middle of the file from the middle of a sector, with a run buffer then sector by sector in the
+   * window, the size and the clusters of the file are kept */
+  for ( ef_u32_t r = 1 ; ( 0 == s32RetVal ) && ( r < 3 ) ; r++ )
+  {
+    u32TestFileProduceOffset = u32Ranges[ r ][ 0 ];
+    u32TestFileProduceEnd = u32Ranges[ r ][ 1 ];
+    if (    ( EF_RET_OK != eTestFileWrite( "A:RCV.BIN",
+                                           EF_FILE_OPEN_WRITE | EF_FILE_OPEN_EXISTING | EF_FILE_OPEN_TRUNCATE,
+                                           u32Ranges[ 0 ][ 1 ], 4096 ) )
+         || ( EF_RET_OK != eEF_fopen( &xFile, "A:RCV.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_EXISTING ) )
+         || ( EF_RET_OK != eEF_fseek( &xFile, u32Ranges[ r ][ 0 ] ) )
+         || ( EF_RET_OK != eEF_receive( &xFile, u32TestFileProduce, ( 1 == r ) ? u8TestFileBuffer : 0, 4096,
+                                        u32Ranges[ r ][ 1 ] - u32Ranges[ r ][ 0 ], &u32Done ) )
+         || ( ( u32Ranges[ r ][ 1 ] - u32Ranges[ r ][ 0 ] ) != u32Done )
+         || ( EF_RET_OK != eEF_fclose( &xFile ) )
+         || ( EF_RET_OK != eEF_getfree( "A:", &u32ClstFree ) ) )
+    {
+      s32RetVal = 5;
+    }
+    else if ( ( u32ClstFreeOrg - ( ( u32Ranges[ 0 ][ 1 ] + 1023 ) / 1024 ) ) != u32ClstFree )
+    {
+      s32RetVal = 6;
+    }
+    else
+    {
+      s32RetVal = s32TestFileCheckInverted( "A:RCV.BIN", u32Ranges[ 0 ][ 1 ], u32Ranges[ r ][ 0 ],
+                                            u32Ranges[ r ][ 1 ] );
+    }
+  }
+  (void) eEF_umount( "A:" );
+
+  return s32RetVal;
+}
+
+#if ( 0 != EF_CONF_FILE_DIGEST )
+/* Check the digest of the bytes read, forwarded, read again and skipped */
+int32_t s32TestFileDigest (
+  void
+)
+{
+  int32_t                 s32RetVal;
+  EF_FILE                 xFile;
+  ef_test_file_digest_st  xDigest = { 0, 0 };
+  ef_test_file_digest_st  xExpected = { 0, 0 };
+  ef_u32_t                u32Done = 0;
+  ef_u32_t                u32Offset = 0;
+
+  /* The digest covers the bytes from 100 to 8000 */
+  for ( ef_u32_t i = 100 ; i < 8000 ; i++ )
+  {
+    xExpected.u32Hash = ( xExpected.u32Hash * 31 ) + u8TestFileData( i );
+  }
+  xExpected.u32Count = 8000 - 100;
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 2 );
+  u32TestFileStreamOffset = 4000;
+  s32TestFileStreamFail = 0;
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+  {
+    s32RetVal = 3;
+  }
+  /* Attach in the middle of a sector, read through the window and the whole sectors read directly */
+  else if (    ( EF_RET_OK != eTestFileWrite( "A:DIGEST.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW, 10000, 4096 ) )
+            || ( EF_RET_OK != eEF_fopen( &xFile, "A:DIGEST.BIN", EF_FILE_OPEN_EXISTING ) )
+            || ( EF_RET_OK != eEF_fseek( &xFile, 100 ) )
+            || ( EF_RET_OK != eEF_fdigest( &xFile, vTestFileDigest, &xDigest ) )
+            || ( EF_RET_OK != eEF_fdigest_offset( &xFile, &u32Offset ) )
+            || ( 100 != u32Offset )
+            || ( EF_RET_OK != eEF_fread( &xFile, u8TestFileBuffer, 3000, &u32Done ) )
+            || ( EF_RET_OK != eEF_fdigest_offset( &xFile, &u32Offset ) )
+            || ( 3100 != u32Offset ) )
+  {
+    s32RetVal = 5;
+  }
+  /* Read again after a backward seek, then forward, the bytes are digested once */
+  else if (    ( EF_RET_OK != eEF_fseek( &xFile, 2000 ) )
+            || ( EF_RET_OK != eEF_fread( &xFile, u8TestFileBuffer, 2000, &u32Done ) )
+            || ( EF_RET_OK != eEF_fdigest_offset( &xFile, &u32Offset ) )
+            || ( 4000 != u32Offset )
+            || ( EF_RET_OK != eEF_forward( &xFile, u32TestFileStream, 1000, &u32Done ) )
+            || ( EF_RET_OK != eEF_forward_buffered( &xFile, u32TestFileStream, u8TestFileBuffer, 4096, 3000,
+                                                    &u32Done ) )
+            || ( EF_RET_OK != eEF_fdigest_offset( &xFile, &u32Offset ) )
+            || ( 8000 != u32Offset )
+            || ( 0 != s32TestFileStreamFail ) )
+  {
+    s32RetVal = 5;
+  }
+  /* The bytes read after a forward seek are not digested */
+  else if (    ( EF_RET_OK != eEF_fseek( &xFile, 9000 ) )
+            || ( EF_RET_OK != eEF_fread( &xFile, u8TestFileBuffer, 500, &u32Done ) )
+            || ( EF_RET_OK != eEF_fdigest_offset( &xFile, &u32Offset ) )
+            || ( 8000 != u32Offset )
+            || ( EF_RET_OK != eEF_fclose( &xFile ) ) )
+  {
+    s32RetVal = 5;
+  }
+  else if (    ( xExpected.u32Hash != xDigest.u32Hash )
+            || ( xExpected.u32Count != xDigest.u32Count ) )
+  {
+    s32RetVal = 7;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+  (void) eEF_umount( "A:" );
+
+  return s32RetVal;
+}
+#endif
+
+/* Check writes ending at a sector boundary followed by small writes, and the formatted output functions */
+int32_t s32TestFilePrintf (
+  void
+)
+{
+  static const ef_u32_t u32Writes[ ] = { 500, 12, 100 };
+  static const char     cText[ ] = "abcdefghijklmnopqrstuv";
+  static const char     cHex[ ] = "0123456789ABCDEF";
+  const ef_u32_t  u32Chunks[ ] = { 100 };
+  int32_t         s32RetVal;
+  EF_FILE         xFile;
+  ef_u08_t        u8Read[ EF_TEST_FILE_SECTOR_SIZE ];
+  ef_u32_t        u32TextSize = 0;
+  ef_u32_t        u32Offset = 0;
+  ef_u32_t        u32Done = 0;
+  ef_u32_t        u32Digits;
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 2 );
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if (    ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+            || ( EF_RET_OK != eEF_fopen( &xFile, "A:SMALL.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW ) ) )
+  {
+    s32RetVal = 3;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  /* The first write ends at the sector boundary, the following ones start the next sector */
+  for ( ef_u32_t w = 0 ; ( 0 == s32RetVal ) && ( w < ( sizeof( u32Writes ) / sizeof( u32Writes[ 0 ] ) ) ) ; w++ )
+  {
+    for ( ef_u32_t i = 0 ; i < u32Writes[ w ] ; i++ )
+    {
+      u8TestFileBuffer[ i ] = u8TestFileData( u32Offset + i );
+    }
+    if (    ( EF_RET_OK != eEF_fwrite( &xFile, u8TestFileBuffer, u32Writes[ w ], &u32Done ) )
+         || ( u32Writes[ w ] != u32Done ) )
+    {
+      s32RetVal = 5;
+    }
+    u32Offset += u32Writes[ w ];
+  }
+  if ( ( 0 == s32RetVal ) && ( EF_RET_OK != eEF_fclose( &xFile ) ) )
+  {
+    s32RetVal = 5;
+  }
+  else if ( 0 == s32RetVal )
+  {
+    s32RetVal = s32TestFileCheck( "A:SMALL.BIN", u32Offset, u32Chunks, 1 );
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  /* Lines of a decimal, a hexadecimal and a string field, their length varies */
+  if (    ( 0 == s32RetVal )
+       && ( EF_RET_OK != eEF_fopen( &xFile, "A:LOG.CSV", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW ) ) )
+  {
+    s32RetVal = 5;
+  }
+  for ( ef_u32_t l = 0 ; ( 0 == s32RetVal ) && ( l < EF_TEST_FILE_PRINTF_NB ) ; l++ )
+  {
+    if ( 0 > eEF_printf( &xFile, "%u,%04X,%s", l, ( l * 7 ) & 0xFFFF, &cText[ l % sizeof( cText ) ] ) )
+    {
+      s32RetVal = 5;
+    }
+    else if ( ( 0 == ( l % 3 ) ) && ( 0 > eEF_puts( ";\n", &xFile ) ) )
+    {
+      s32RetVal = 5;
+    }
+    else if ( ( 0 != ( l % 3 ) ) && ( 0 > eEF_putc( '\n', &xFile ) ) )
+    {
+      s32RetVal = 5;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    /* The expected line */
+    for ( u32Digits = 1 ; ( l / u32Digits ) >= 10 ; u32Digits *= 10 )
+    {
+      ;
+    }
+    for ( ; 0 != u32Digits ; u32Digits /= 10 )
+    {
+      u8TestFileBuffer[ u32TextSize++ ] = (ef_u08_t) ( '0' + ( ( l / u32Digits ) % 10 ) );
+    }
+    u8TestFileBuffer[ u32TextSize++ ] = ',';
+    for ( ef_u32_t i = 0 ; i < 4 ; i++ )
+    {
+      u8TestFileBuffer[ u32TextSize++ ] = (ef_u08_t) cHex[ ( ( l * 7 ) >> ( 12 - ( 4 * i ) ) ) & 0xF ];
+    }
+    u8TestFileBuffer[ u32TextSize++ ] = ',';
+    for ( ef_u32_t i = l % sizeof( cText ) ; 0 != cText[ i ] ; i++ )
+    {
+      u8TestFileBuffer[ u32TextSize++ ] = (ef_u08_t) cText[ i ];
+    }
+    if ( 0 == ( l % 3 ) )
+    {
+      u8TestFileBuffer[ u32TextSize++ ] = ';';
+    }
+    if ( 0 != EF_CONF_CONVERT_LF_CRLF )
+    {
+      u8TestFileBuffer[ u32TextSize++ ] = '\r';
+    }
+    u8TestFileBuffer[ u32TextSize++ ] = '\n';
+  }
+  if ( ( 0 == s32RetVal ) && ( EF_RET_OK != eEF_fclose( &xFile ) ) )
+  {
+    s32RetVal = 5;
+  }
+  else if (    ( 0 == s32RetVal )
+            && ( EF_RET_OK != eEF_fopen( &xFile, "A:LOG.CSV", EF_FILE_OPEN_EXISTING ) ) )
+  {
+    s32RetVal = 5;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  /* Read back a sector at a time */
+  for ( u32Offset = 0 ; ( 0 == s32RetVal ) && ( u32Offset <= u32TextSize ) ; u32Offset += EF_TEST_FILE_SECTOR_SIZE )
+  {
+    u32Digits = ( ( u32TextSize - u32Offset ) < EF_TEST_FILE_SECTOR_SIZE ) ? ( u32TextSize - u32Offset ) : EF_TEST_FILE_SECTOR_SIZE;
+    if (    ( EF_RET_OK != eEF_fread( &xFile, u8Read, EF_TEST_FILE_SECTOR_SIZE, &u32Done ) )
+         || ( u32Digits != u32Done ) )
+    {
+      s32RetVal = 7;
+    }
+    else if ( 0 != memcmp( u8Read, &u8TestFileBuffer[ u32Offset ], u32Done ) )
+    {
+      s32RetVal = 7;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+  if ( 0 == s32RetVal )
+  {
+    (void) eEF_fclose( &xFile );
+  }
+  (void) eEF_umount( "A:" );
+
+  return s32RetVal;
+}
+
+#if ( 0 != EF_CONF_ALLOC_SNAPSHOT )
+/* Check the allocation snapshot is taken back by a remount, and not after a mount whose unmount was lost, and that
+   its free extents are checked in the FAT */
+int32_t s32TestFileSnapshot (
+  void
+)
+{
+  int32_t   s32RetVal;
+  EF_FILE   xFile;
+  ef_u32_t  u32ClstFree = 0;
+  ef_u32_t  u32ClstFreeNext = 0;
+  ef_u08_t  u8FsInfo[ EF_TEST_FILE_SECTOR_SIZE ];
+  ef_u08_t  * pu8Entry;
+  ef_u08_t  * pu8Fat = 0;
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 1 );
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+  {
+    s32RetVal = 3;
+  }
+  /* The unmount saves the snapshot of a scanned FAT */
+  else if (    ( EF_RET_OK != eTestFileWrite( "A:SNAP.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW, 10000, 4096 ) )
+            || ( EF_RET_OK != eEF_getfree( "A:", &u32ClstFree ) )
+            || ( EF_RET_OK != eEF_umount( "A:" ) ) )
+  {
+    s32RetVal = 5;
+  }
+  else
+  {
+    /* The last cluster is allocated behind the snapshot, only a FAT scan can count it */
+    pu8Fat   = pu8TestFileRam[ 0 ] + ( EF_TEST_FILE_RESERVED_NB * EF_TEST_FILE_SECTOR_SIZE );
+    pu8Entry = pu8Fat + ( ( EF_TEST_FILE_CLST_NB + 1 ) * 4 );
+    vEFPortStoreu32( pu8Entry, 0x0FFFFFFF );
+
+    /* The remount takes the snapshot back */
+    if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+    {
+      s32RetVal = 3;
+    }
+    else if ( EF_RET_OK != eEF_getfree( "A:", &u32ClstFreeNext ) )
+    {
+      s32RetVal = 5;
+    }
+    else if ( u32ClstFree != u32ClstFreeNext )
+    {
+      s32RetVal = 6;
+    }
+    else
+    {
+      /* The unmount is lost, the FSINFO sector keeps the snapshot written before the mount */
+      (void) memcpy( u8FsInfo, pu8TestFileRam[ 0 ] + EF_TEST_FILE_SECTOR_SIZE, EF_TEST_FILE_SECTOR_SIZE );
+      if ( EF_RET_OK != eEF_umount( "A:" ) )
+      {
+        s32RetVal = 5;
+      }
+      else
+      {
+        (void) memcpy( pu8TestFileRam[ 0 ] + EF_TEST_FILE_SECTOR_SIZE, u8FsInfo, EF_TEST_FILE_SECTOR_SIZE );
+      }
+    }
+
+    /* The mount which followed the snapshot was stored on the volume, the FAT is scanned again */
+    if ( 0 != s32RetVal )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+    {
+      s32RetVal = 3;
+    }
+    else if ( EF_RET_OK != eEF_getfree( "A:", &u32ClstFreeNext ) )
+    {
+      s32RetVal = 5;
+    }
+    else if ( ( u32ClstFree - 1 ) != u32ClstFreeNext )
+    {
+      s32RetVal = 6;
+    }
+    /* The unmount saves the snapshot of a built free extents index */
+    else if (    ( EF_RET_OK != eEF_fopen( &xFile, "A:EXT.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW ) )
+              || ( EF_RET_OK != eEF_expand( &xFile, 100 * EF_TEST_FILE_SECTOR_SIZE, 1 ) )
+              || ( EF_RET_OK != eEF_fclose( &xFile ) )
+              || ( EF_RET_OK != eEF_umount( "A:" ) ) )
+    {
+      s32RetVal = 5;
+    }
+    else
+    {
+      /* A cluster near the end of the largest free run is allocated behind the snapshot, and the last cluster freed:
+         the FSINFO fields still match it */
+      vEFPortStoreu32( pu8Fat + ( 60000 * 4 ), 0x0FFFFFFF );
+      vEFPortStoreu32( pu8Fat + ( ( EF_TEST_FILE_CLST_NB + 1 ) * 4 ), 0 );
+    }
+
+    /* The best fitting run is the one after the allocated cluster, not the start of the run of the snapshot */
+    if ( 0 != s32RetVal )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+    {
+      s32RetVal = 3;
+    }
+    else if (    ( EF_RET_OK != eEF_fopen( &xFile, "A:EXTNEXT.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW ) )
+              || ( EF_RET_OK != eEF_expand( &xFile, 5000 * EF_TEST_FILE_SECTOR_SIZE, 1 ) ) )
+    {
+      s32RetVal = 5;
+    }
+    /* Else, if the run is not the best fitting one, or it is linked to the allocated cluster */
+    else if (    ( 60001 != xFile.xObject.u32ClstStart )
+              || ( 0x0FFFFFFF != ( 0x0FFFFFFF & u32EFPortLoad( pu8Fat + ( 60000 * 4 ) ) ) ) )
+    {
+      s32RetVal = 16;
+      (void) eEF_fclose( &xFile );
+    }
+    else if ( EF_RET_OK != eEF_fclose( &xFile ) )
+    {
+      s32RetVal = 5;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+  (void) eEF_umount( "A:" );
+
+  return s32RetVal;
+}
+#endif
+
+#if ( 0 != EF_CONF_FILE_LOCK )
+/* Check the sharing rules of the file lock table, and its entries removed from colliding hash probe sequences */
+int32_t s32TestFileLock (
+  void
+)
+{
+  const ef_u08_t  u8Read = EF_FILE_OPEN_EXISTING;
+  const ef_u08_t  u8Write = EF_FILE_OPEN_WRITE | EF_FILE_OPEN_EXISTING;
+  int32_t         s32RetVal;
+  EF_FILE         xFile;
+  EF_FILE         xFileNext;
+  EF_FILE         xFileOther;
+  TCHAR           xPath[ ] = "A:LKAA.BIN";
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 1 );
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+  {
+    s32RetVal = 3;
+  }
+  else
+  {
+    /* One file more than the lock table entries, named LKAA.BIN, LKAB.BIN... */
+    for ( ef_u32_t u32Index = 0 ; ( 0 == s32RetVal ) && ( u32Index <= EF_CONF_FILE_LOCK ) ; u32Index++ )
+    {
+      xPath[ 4 ] = (TCHAR) ( 'A' + ( u32Index / 26 ) );
+      xPath[ 5 ] = (TCHAR) ( 'A' + ( u32Index % 26 ) );
+      if ( EF_RET_OK != eTestFileWrite( xPath, EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW, 100, 100 ) )
+      {
+        s32RetVal = 5;
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+    }
+  }
+
+  /* A file open for writing is not opened again, for reading or for writing */
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_fopen( &xFile, "A:LKAA.BIN", u8Write ) )
+  {
+    s32RetVal = 5;
+  }
+  else
+  {
+    if (    ( EF_RET_LOCKED != eEF_fopen( &xFileOther, "A:LKAA.BIN", u8Read ) )
+         || ( EF_RET_LOCKED != eEF_fopen( &xFileOther, "A:LKAA.BIN", u8Write ) ) )
+    {
+      s32RetVal = 9;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    (void) eEF_fclose( &xFile );
+  }
+
+  /* A file open for reading is shared with readers only, and it is neither removed nor renamed */
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if (    ( EF_RET_OK != eEF_fopen( &xFile, "A:LKAA.BIN", u8Read ) )
+            || ( EF_RET_OK != eEF_fopen( &xFileNext, "A:LKAA.BIN", u8Read ) ) )
+  {
+    s32RetVal = 9;
+  }
+  else
+  {
+    if (    ( EF_RET_LOCKED != eEF_fopen( &xFileOther, "A:LKAA.BIN", u8Write ) )
+         || ( EF_RET_OK == eEF_remove( "A:LKAA.BIN" ) )
+         || ( EF_RET_OK == eEF_rename( "A:LKAA.BIN", "A:OTHER.BIN" ) ) )
+    {
+      s32RetVal = 9;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    (void) eEF_fclose( &xFile );
+    (void) eEF_fclose( &xFileNext );
+  }
+
+  /* Once closed by every reader, the file kept its name and it is opened for writing */
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_fopen( &xFile, "A:LKAA.BIN", u8Write ) )
+  {
+    s32RetVal = 9;
+  }
+  else
+  {
+    (void) eEF_fclose( &xFile );
+  }
+
+  /* Fill the lock table: the next file is not opened, but a file which is not open is still removed */
+  for ( ef_u32_t u32Index = 0 ; ( 0 == s32RetVal ) && ( u32Index < EF_CONF_FILE_LOCK ) ; u32Index++ )
+  {
+    xPath[ 4 ] = (TCHAR) ( 'A' + ( u32Index / 26 ) );
+    xPath[ 5 ] = (TCHAR) ( 'A' + ( u32Index % 26 ) );
+    if ( EF_RET_OK != eEF_fopen( &xTestFileLockFiles[ u32Index ], xPath, u8Read ) )
+    {
+      s32RetVal = 5;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+  }
+  xPath[ 4 ] = (TCHAR) ( 'A' + ( EF_CONF_FILE_LOCK / 26 ) );
+  xPath[ 5 ] = (TCHAR) ( 'A' + ( EF_CONF_FILE_LOCK % 26 ) );
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_TOO_MANY_OPEN_FILES != eEF_fopen( &xFile, xPath, u8Read ) )
+  {
+    s32RetVal = 9;
+  }
+  else if ( EF_RET_OK != eEF_remove( xPath ) )
+  {
+    s32RetVal = 5;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  /* The even files are closed first, then the odd ones, removing entries from the middle of the probe sequences:
+   * each closed file is opened again for writing, each file still open is not */
+  for ( ef_u32_t u32Step = 0 ; ( 0 == s32RetVal ) && ( u32Step < EF_CONF_FILE_LOCK ) ; u32Step++ )
+  {
+    ef_u32_t  u32Closed = ( ( u32Step * 2 ) < EF_CONF_FILE_LOCK ) ? ( u32Step * 2 )
+                          : ( ( ( u32Step * 2 ) - EF_CONF_FILE_LOCK ) | 1 );
+
+    if ( EF_RET_OK != eEF_fclose( &xTestFileLockFiles[ u32Closed ] ) )
+    {
+      s32RetVal = 5;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    for ( ef_u32_t u32Index = 0 ; ( 0 == s32RetVal ) && ( u32Index < EF_CONF_FILE_LOCK ) ; u32Index++ )
+    {
+      xPath[ 4 ] = (TCHAR) ( 'A' + ( u32Index / 26 ) );
+      xPath[ 5 ] = (TCHAR) ( 'A' + ( u32Index % 26 ) );
+      /* If the file is still open */
+      if ( 0 != xTestFileLockFiles[ u32Index ].xObject.pxFS )
+      {
+        if ( EF_RET_LOCKED != eEF_fopen( &xFile, xPath, u8Write ) )
+        {
+          s32RetVal = 9;
+        }
+        else
+        {
+          EF_CODE_COVERAGE( );
+        }
+      }
+      else if ( EF_RET_OK != eEF_fopen( &xFile, xPath, u8Write ) )
+      {
+        s32RetVal = 9;
+      }
+      else
+      {
+        (void) eEF_fclose( &xFile );
+      }
+    }
+  }
+  (void) eEF_umount( "A:" );
+
+  return s32RetVal;
+}
+#endif
+
+#if ( 0 != EF_CONF_NON_BLOCKING )
+/* Check non-blocking writes, synchronizations and reads across sector and cluster boundaries with started transfers */
+int32_t s32TestFileNbTransfer (
+  void
+)
+{
+  const ef_u32_t  u32Chunks[ ] = { 13, 5000, 2048, 65536, 700, 3000, 1536 };
+  const ef_u32_t  u32ChunksNb = sizeof( u32Chunks ) / sizeof( u32Chunks[ 0 ] );
+  int32_t         s32RetVal;
+  EF_FILE         xFile;
+  ef_return_et    eResult;
+  ef_u32_t        u32Offset = 0;
+  ef_u32_t        u32Length;
+  ef_u32_t        u32Done = 0;
+  ef_u32_t        u32Chunk = 0;
+  ef_u32_t        u32Pendings = 0;
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 4 );
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+  {
+    s32RetVal = 3;
+  }
+  else if ( EF_RET_OK != eEF_fopen( &xFile, "A:NB.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW ) )
+  {
+    s32RetVal = 5;
+  }
+  else
+  {
+    /* Write the test data in chunks, the window is written back after each chunk */
+    while ( ( 0 == s32RetVal ) && ( u32Offset < 300000 ) )
+    {
+      u32Length = ( u32Chunks[ u32Chunk ] < ( 300000 - u32Offset ) ) ? u32Chunks[ u32Chunk ] : ( 300000 - u32Offset );
+      u32Chunk  = ( u32Chunk + 1 ) % u32ChunksNb;
+      for ( ef_u32_t i = 0 ; i < u32Length ; i++ )
+      {
+        u8TestFileBuffer[ i ] = u8TestFileData( u32Offset + i );
+      }
+      do
+      {
+        eResult = eEF_fwrite_nb( &xFile, u8TestFileBuffer, u32Length, &u32Done );
+        u32Pendings += ( EF_RET_PENDING == eResult ) ? 1 : 0;
+      } while ( EF_RET_PENDING == eResult );
+      if ( ( EF_RET_OK != eResult ) || ( u32Length != u32Done ) )
+      {
+        s32RetVal = 5;
+      }
+      do
+      {
+        eResult = eEF_fsync_nb( &xFile );
+        u32Pendings += ( EF_RET_PENDING == eResult ) ? 1 : 0;
+      } while ( EF_RET_PENDING == eResult );
+      if ( EF_RET_OK != eResult )
+      {
+        s32RetVal = 5;
+      }
+      u32Offset += u32Length;
+    }
+    if ( ( EF_RET_OK != eEF_fclose( &xFile ) ) && ( 0 == s32RetVal ) )
+    {
+      s32RetVal = 5;
+    }
+
+    /* Read the file back in the same chunks up to an empty read at the end of the file */
+    u32Offset = 0;
+    u32Chunk  = 0;
+    if ( 0 != s32RetVal )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    else if ( EF_RET_OK != eEF_fopen( &xFile, "A:NB.BIN", EF_FILE_OPEN_EXISTING ) )
+    {
+      s32RetVal = 5;
+    }
+    else
+    {
+      do
+      {
+        do
+        {
+          eResult = eEF_fread_nb( &xFile, u8TestFileBuffer, u32Chunks[ u32Chunk ], &u32Done );
+          u32Pendings += ( EF_RET_PENDING == eResult ) ? 1 : 0;
+        } while ( EF_RET_PENDING == eResult );
+        if ( EF_RET_OK != eResult )
+        {
+          s32RetVal = 5;
+        }
+        for ( ef_u32_t i = 0 ; ( 0 == s32RetVal ) && ( i < u32Done ) ; i++ )
+        {
+          if ( u8TestFileBuffer[ i ] != u8TestFileData( u32Offset + i ) )
+          {
+            s32RetVal = 7;
+          }
+        }
+        u32Offset += u32Done;
+        u32Chunk   = ( u32Chunk + 1 ) % u32ChunksNb;
+      } while ( ( 0 == s32RetVal ) && ( 0 != u32Done ) );
+
+      if ( ( 0 == s32RetVal ) && ( 300000 != u32Offset ) )
+      {
+        s32RetVal = 7;
+      }
+      if ( ( EF_RET_OK != eEF_fclose( &xFile ) ) && ( 0 == s32RetVal ) )
+      {
+        s32RetVal = 5;
+      }
+    }
+
+    /* The whole sectors runs and the window write-backs have been left pending */
+    if ( ( 0 == s32RetVal ) && ( 0 == u32Pendings ) )
+    {
+      s32RetVal = 10;
+    }
+    /* The data written is read back by blocking reads */
+    if ( 0 == s32RetVal )
+    {
+      s32RetVal = s32TestFileCheck( "A:NB.BIN", 300000, u32Chunks, u32ChunksNb );
+    }
+  }
+  (void) eEF_umount( "A:" );
+
+  return s32RetVal;
+}
+
+/* Check that closing, seeking or truncating a file abandons its non-blocking operation and its started transfer */
+int32_t s32TestFileNbAbandon (
+  void
+)
+{
+  const ef_u32_t  u32Chunks[ ] = { 4096, 1000 };
+  int32_t         s32RetVal;
+  EF_FILE         xFile;
+  EF_FILE         xFileNext;
+  ef_return_et    eResult;
+  ef_u32_t        u32Done = 0;
+  ef_u32_t        u32Calls = 0;
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 4 );
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+  {
+    s32RetVal = 3;
+  }
+  else if (    ( EF_RET_OK != eTestFileWrite( "A:NBA.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW, 300000, 65536 ) )
+            || ( EF_RET_OK != eTestFileWrite( "A:NBB.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW, 300000, 65536 ) )
+            || ( EF_RET_OK != eEF_fopen( &xFile, "A:NBA.BIN", EF_FILE_OPEN_EXISTING ) )
+            || ( EF_RET_OK != eEF_fopen( &xFileNext, "A:NBB.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_EXISTING ) ) )
+  {
+    s32RetVal = 5;
+  }
+  else
+  {
+    /* Close a file while the first run of its read is pending */
+    if ( EF_RET_PENDING != eEF_fread_nb( &xFile, u8TestFileBuffer, 65536, &u32Done ) )
+    {
+      s32RetVal = 10;
+    }
+    else if ( EF_RET_OK != eEF_fclose( &xFile ) )
+    {
+      s32RetVal = 5;
+    }
+    else
+    {
+      /* The run has ended within the close, it no longer writes its buffer */
+      (void) memset( u8TestFileBuffer, 0x5A, 2048 );
+    }
+
+    /* A read of another file is not blocked by the abandoned transfer */
+    if ( 0 == s32RetVal )
+    {
+      do
+      {
+        eResult = eEF_fread_nb( &xFileNext, u8TestFileBuffer + 32768, 30000, &u32Done );
+        u32Calls++;
+      } while ( ( EF_RET_PENDING == eResult ) && ( u32Calls < 10000 ) );
+      if ( ( EF_RET_OK != eResult ) || ( 30000 != u32Done ) )
+      {
+        s32RetVal = 10;
+      }
+      for ( ef_u32_t i = 0 ; ( 0 == s32RetVal ) && ( i < 30000 ) ; i++ )
+      {
+        if ( u8TestFileBuffer[ 32768 + i ] != u8TestFileData( i ) )
+        {
+          s32RetVal = 7;
+        }
+      }
+      for ( ef_u32_t i = 0 ; ( 0 == s32RetVal ) && ( i < 2048 ) ; i++ )
+      {
+        if ( 0x5A != u8TestFileBuffer[ i ] )
+        {
+          s32RetVal = 10;
+        }
+      }
+    }
+
+    /* Seek back while a write is pending, then read the file: the write is no longer in progress */
+    for ( ef_u32_t i = 0 ; i < 65536 ; i++ )
+    {
+      u8TestFileBuffer[ i ] = u8TestFileData( i );
+    }
+    if ( 0 != s32RetVal )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    else if (    ( EF_RET_OK != eEF_fseek( &xFileNext, 0 ) )
+              || ( EF_RET_PENDING != eEF_fwrite_nb( &xFileNext, u8TestFileBuffer, 65536, &u32Done ) ) )
+    {
+      s32RetVal = 10;
+    }
+    else if ( EF_RET_OK != eEF_fseek( &xFileNext, 0 ) )
+    {
+      s32RetVal = 5;
+    }
+    else
+    {
+      do
+      {
+        eResult = eEF_fread_nb( &xFileNext, u8TestFileBuffer + 32768, 1000, &u32Done );
+      } while ( EF_RET_PENDING == eResult );
+      if ( ( EF_RET_OK != eResult ) || ( 1000 != u32Done ) )
+      {
+        s32RetVal = 10;
+      }
+      for ( ef_u32_t i = 0 ; ( 0 == s32RetVal ) && ( i < 1000 ) ; i++ )
+      {
+        if ( u8TestFileBuffer[ 32768 + i ] != u8TestFileData( i ) )
+        {
+          s32RetVal = 7;
+        }
+      }
+    }
+
+    /* Truncate the file while a write inside a sector then at the next sector boundary is pending */
+    for ( ef_u32_t i = 0 ; i < 65536 ; i++ )
+    {
+      u8TestFileBuffer[ i ] = u8TestFileData( 100000 + i );
+    }
+    if ( 0 != s32RetVal )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    else if (    ( EF_RET_OK != eEF_fseek( &xFileNext, 100000 ) )
+              || ( EF_RET_PENDING != eEF_fwrite_nb( &xFileNext, u8TestFileBuffer, 65536, &u32Done ) ) )
+    {
+      s32RetVal = 10;
+    }
+    else if (    ( EF_RET_OK != eEF_truncate( &xFileNext ) )
+              || ( 100352 != xFileNext.u32Size ) )
+    {
+      s32RetVal = 5;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+    if ( ( EF_RET_OK != eEF_fclose( &xFileNext ) ) && ( 0 == s32RetVal ) )
+    {
+      s32RetVal = 5;
+    }
+    if ( 0 == s32RetVal )
+    {
+      s32RetVal = s32TestFileCheck( "A:NBB.BIN", 100352, u32Chunks, 2 );
+    }
+  }
+  (void) eEF_umount( "A:" );
+
+  return s32RetVal;
+}
+#endif
+
+#if ( 0 != EF_CONF_BOUNDED_WRITE )
+/* Check the command budget and the pool of the bounded latency write mode, and the directory entry it maintains */
+int32_t s32TestFileBounded (
+  void
+)
+{
+  const ef_u32_t        u32Chunks[ ] = { 65536, 777 };
+  int32_t               s32RetVal;
+  EF_FILE               xFile;
+  ef_fbounded_stats_st  xStats;
+  ef_file_info_st       xInfo;
+  ef_u32_t              u32Offset = 0;
+  ef_u32_t              u32Length;
+  ef_u32_t              u32Done = 0;
+
+  for ( ef_u32_t i = 0 ; i < 65536 ; i++ )
+  {
+    u8TestFileBuffer[ i ] = u8TestFileData( i );
+  }
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 4 );
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+  {
+    s32RetVal = 3;
+  }
+  else if (    ( EF_RET_OK != eEF_fopen( &xFile, "A:BW.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW ) )
+            || ( EF_RET_OK != eEF_fbounded( &xFile, 8 ) ) )
+  {
+    s32RetVal = 5;
+  }
+  /* Else, if a large write is not stopped by the command budget */
+  else if (    ( EF_RET_OK != eEF_fwrite( &xFile, u8TestFileBuffer, 65536, &u32Done ) )
+            || ( EF_RET_OK != eEF_fbounded_stats( &xFile, &xStats, EF_BOOL_FALSE ) ) )
+  {
+    s32RetVal = 5;
+  }
+  else if (    ( 0 == u32Done )
+            || ( 65536 <= u32Done )
+            || ( 1 != xStats.u32ShortNb )
+            || ( xStats.u32CommandsMax > xStats.u32CommandsLimit ) )
+  {
+    s32RetVal = 11;
+  }
+  else
+  {
+    /* Write up to the end of the pool without maintaining the file, the last call writes nothing */
+    u32Offset = u32Done;
+    while ( ( 0 == s32RetVal ) && ( 0 != u32Done ) )
+    {
+      if ( EF_RET_OK != eEF_fwrite( &xFile, u8TestFileBuffer + u32Offset, 65536 - u32Offset, &u32Done ) )
+      {
+        s32RetVal = 5;
+      }
+      u32Offset += u32Done;
+    }
+    if ( 0 != s32RetVal )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    else if ( EF_RET_OK != eEF_fbounded_stats( &xFile, &xStats, EF_BOOL_FALSE ) )
+    {
+      s32RetVal = 5;
+    }
+    else if (    ( ( 8 * 4 * EF_TEST_FILE_SECTOR_SIZE ) != u32Offset )
+              || ( 0 != xStats.u32PoolNb )
+              || ( xStats.u32CommandsMax > xStats.u32CommandsLimit ) )
+    {
+      s32RetVal = 11;
+    }
+    /* Else, if the directory entry is not updated by the maintenance */
+    else if (    ( EF_RET_OK != eEF_stat( "A:BW.BIN", &xInfo ) )
+              || ( 0 != xInfo.u32FileSize )
+              || ( EF_RET_OK != eEF_fmaintain( &xFile ) )
+              || ( EF_RET_OK != eEF_stat( "A:BW.BIN", &xInfo ) ) )
+    {
+      s32RetVal = 5;
+    }
+    else if ( u32Offset != xInfo.u32FileSize )
+    {
+      s32RetVal = 12;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+
+    /* Complete the file, maintaining it after each short write */
+    while ( ( 0 == s32RetVal ) && ( u32Offset < 300000 ) )
+    {
+      u32Length = ( 300000 - u32Offset ) < 5000 ? ( 300000 - u32Offset ) : 5000;
+      for ( ef_u32_t i = 0 ; i < u32Length ; i++ )
+      {
+        u8TestFileBuffer[ i ] = u8TestFileData( u32Offset + i );
+      }
+      for ( ef_u32_t u32Chunk = 0 ; ( 0 == s32RetVal ) && ( u32Chunk < u32Length ) ; u32Chunk += u32Done )
+      {
+        if (    ( EF_RET_OK != eEF_fwrite( &xFile, u8TestFileBuffer + u32Chunk, u32Length - u32Chunk, &u32Done ) )
+             || ( ( ( u32Length - u32Chunk ) != u32Done ) && ( EF_RET_OK != eEF_fmaintain( &xFile ) ) ) )
+        {
+          s32RetVal = 5;
+        }
+      }
+      u32Offset += u32Length;
+    }
+    if (    ( 0 == s32RetVal )
+         && (    ( EF_RET_OK != eEF_fbounded_stats( &xFile, &xStats, EF_BOOL_FALSE ) )
+              || ( EF_RET_OK != eEF_fmaintain( &xFile ) ) ) )
+    {
+      s32RetVal = 5;
+    }
+    else if ( ( 0 == s32RetVal ) && ( xStats.u32CommandsMax > xStats.u32CommandsLimit ) )
+    {
+      s32RetVal = 11;
+    }
+    else
+    {
+      EF_CODE_COVERAGE( );
+    }
+
+    /* The volume is unmounted without closing the file, the maintained directory entry gives the whole file */
+    (void) eEF_umount( "A:" );
+    if ( 0 != s32RetVal )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    else if (    ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+              || ( EF_RET_OK != eEF_stat( "A:BW.BIN", &xInfo ) ) )
+    {
+      s32RetVal = 3;
+    }
+    else if ( 300000 != xInfo.u32FileSize )
+    {
+      s32RetVal = 12;
+    }
+    else
+    {
+      s32RetVal = s32TestFileCheck( "A:BW.BIN", 300000, u32Chunks, 2 );
+    }
+  }
+  (void) eEF_umount( "A:" );
+
+  return s32RetVal;
+}
+#endif
+
+/* Check the removal of a file whose cluster chain holds an invalid link fails */
+int32_t s32TestFileChainBroken (
+  void
+)
+{
+  int32_t     s32RetVal;
+  EF_FILE     xFile;
+  ef_u32_t    u32Cluster = 0;
+  ef_u08_t  * pu8Fat;
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 1 );
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+  {
+    s32RetVal = 3;
+  }
+  else if (    ( EF_RET_OK != eTestFileWrite( "A:BROKEN.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW, 3 * 512, 512 ) )
+            || ( EF_RET_OK != eEF_fopen( &xFile, "A:BROKEN.BIN", EF_FILE_OPEN_EXISTING ) ) )
+  {
+    s32RetVal = 5;
+  }
+  else
+  {
+    u32Cluster = xFile.xObject.u32ClstStart;
+    if (    ( EF_RET_OK != eEF_fclose( &xFile ) )
+         || ( EF_RET_OK != eEF_umount( "A:" ) ) )
+    {
+      s32RetVal = 5;
+    }
+    else
+    {
+      /* The second cluster of the chain links to the reserved cluster 1 */
+      pu8Fat      = pu8TestFileRam[ 0 ] + ( EF_TEST_FILE_RESERVED_NB * EF_TEST_FILE_SECTOR_SIZE );
+      u32Cluster  = 0x0FFFFFFF & u32EFPortLoad( pu8Fat + ( u32Cluster * 4 ) );
+      vEFPortStoreu32( pu8Fat + ( u32Cluster * 4 ), 1 );
+    }
+  }
+
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+  {
+    s32RetVal = 3;
+  }
+  else if ( EF_RET_OK == eEF_remove( "A:BROKEN.BIN" ) )
+  {
+    s32RetVal = 13;
+  }
+  else
+  {
+    /* The reserved entry the broken link points to is kept */
+    (void) eEF_umount( "A:" );
+    if ( 0 == ( 0x0FFFFFFF & u32EFPortLoad( pu8Fat + 4 ) ) )
+    {
+      s32RetVal = 13;
+    }
+  }
+  (void) eEF_umount( "A:" );
+
+  return s32RetVal;
+}
+
+#if ( 0 != EF_CONF_TRUNCATE_REUSE )
+/* Check a file truncated on opening keeps its cluster chain, and the rewrite reuses it */
+int32_t s32TestFileTruncateKeep (
+  void
+)
+{
+  const ef_u08_t  u8Mode = EF_FILE_OPEN_WRITE | EF_FILE_OPEN_ANYWAY | EF_FILE_OPEN_TRUNCATE;
+  const ef_u32_t  u32Chunk = 1000;
+  const ef_u32_t  u32FatSize = ( ( ( EF_TEST_FILE_CLST_NB + 2 ) * 4 ) + EF_TEST_FILE_SECTOR_SIZE - 1 )
+                             / EF_TEST_FILE_SECTOR_SIZE;
+  int32_t         s32RetVal;
+  EF_FILE         xFile;
+  ef_u32_t        u32Cluster = 0;
+  ef_u32_t        u32ClstFree = 0;
+  ef_u32_t        u32ClstFreeNext = 0;
+  ef_u32_t        u32Done;
+  const ef_u08_t  * pu8Entry = 0;
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 1 );
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+  {
+    s32RetVal = 3;
+  }
+  /* A file of 20 clusters */
+  else if (    ( EF_RET_OK != eTestFileWrite( "A:KEEP.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW, 10000, u32Chunk ) )
+            || ( EF_RET_OK != eEF_fopen( &xFile, "A:KEEP.BIN", EF_FILE_OPEN_EXISTING ) ) )
+  {
+    s32RetVal = 5;
+  }
+  else
+  {
+    u32Cluster = xFile.xObject.u32ClstStart;
+    if (    ( EF_RET_OK != eEF_fclose( &xFile ) )
+         || ( EF_RET_OK != eEF_getfree( "A:", &u32ClstFree ) )
+         || ( EF_RET_OK != eEF_fopen( &xFile, "A:KEEP.BIN", u8Mode ) )
+         || ( EF_RET_OK != eEF_fsync( &xFile ) ) )
+    {
+      s32RetVal = 5;
+    }
+    else
+    {
+      /* The directory entry is the only one of the first sector of the root directory */
+      for ( ef_u32_t u32Entry = 0 ; u32Entry < ( EF_TEST_FILE_SECTOR_SIZE / EF_DIR_ENTRY_SIZE ) ; u32Entry++ )
+      {
+        const ef_u08_t * pu8Dir = pu8TestFileRam[ 0 ]
+                                + ( ( EF_TEST_FILE_RESERVED_NB + ( 2 * u32FatSize ) ) * EF_TEST_FILE_SECTOR_SIZE )
+                                + ( u32Entry * EF_DIR_ENTRY_SIZE );
+        pu8Entry = ( 0 == memcmp( pu8Dir + EF_DIR_NAME_START, "KEEP    BIN", 11 ) ) ? pu8Dir : pu8Entry;
+      }
+    }
+
+    /* The directory entry keeps the first cluster of the chain with a size of 0 */
+    if ( 0 != s32RetVal )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    else if (    ( 0 == pu8Entry )
+              || ( 0 != u32EFPortLoad( pu8Entry + EF_DIR_FILE_SIZE ) )
+              || (    u32Cluster
+                   != (    ( (ef_u32_t) u16EFPortLoad( pu8Entry + EF_DIR_FIRST_CLUSTER_HI ) << 16 )
+                        |  u16EFPortLoad( pu8Entry + EF_DIR_FIRST_CLUSTER_LOW ) ) ) )
+    {
+      s32RetVal = 12;
+    }
+    else
+    {
+      /* The rewrite of 12 clusters overwrites the chain */
+      for ( ef_u32_t u32Offset = 0 ; ( 0 == s32RetVal ) && ( u32Offset < 6000 ) ; u32Offset += u32Chunk )
+      {
+        for ( ef_u32_t i = 0 ; i < u32Chunk ; i++ )
+        {
+          u8TestFileBuffer[ i ] = u8TestFileData( u32Offset + i );
+        }
+        if (    ( EF_RET_OK != eEF_fwrite( &xFile, u8TestFileBuffer, u32Chunk, &u32Done ) )
+             || ( u32Chunk != u32Done ) )
+        {
+          s32RetVal = 5;
+        }
+      }
+    }
+
+    /* No cluster is allocated by the rewrite, the closing frees the 8 clusters past the end of the file */
+    if ( 0 != s32RetVal )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    else if ( EF_RET_OK != eEF_getfree( "A:", &u32ClstFreeNext ) )
+    {
+      s32RetVal = 5;
+    }
+    else if ( u32ClstFree != u32ClstFreeNext )
+    {
+      s32RetVal = 6;
+    }
+    else if (    ( EF_RET_OK != eEF_fclose( &xFile ) )
+              || ( EF_RET_OK != eEF_getfree( "A:", &u32ClstFreeNext ) ) )
+    {
+      s32RetVal = 5;
+    }
+    else if ( ( u32ClstFree + 8 ) != u32ClstFreeNext )
+    {
+      s32RetVal = 6;
+    }
+    else
+    {
+      s32RetVal = s32TestFileCheck( "A:KEEP.BIN", 6000, &u32Chunk, 1 );
+    }
+  }
+  (void) eEF_umount( "A:" );
+  if ( 0 == s32RetVal )
+  {
+    s32RetVal = s32TestFileFatCheck( 0, 0 );
+  }
+
+  return s32RetVal;
+}
+#endif
+
+#if ( 0 != EF_CONF_SEEK_ZERO_FILL )
+/* Check the data of a file extended by a seek past its end read back as zeroes over dirty free clusters */
+int32_t s32TestFileSeekZero (
+  void
+)
+{
+  const ef_u32_t  u32FatSize = ( ( ( EF_TEST_FILE_CLST_NB + 2 ) * 4 ) + EF_TEST_FILE_SECTOR_SIZE - 1 )
+                             / EF_TEST_FILE_SECTOR_SIZE;
+  const ef_u32_t  u32Head = 100;
+  const ef_u32_t  u32Gap = 30000;
+  int32_t         s32RetVal;
+  EF_FILE         xFile;
+  ef_u32_t        u32Offset = 0;
+  ef_u32_t        u32Done = 0;
+  ef_u08_t        u8Expected;
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 1 );
+  if ( 0 == s32RetVal )
+  {
+    /* The free clusters, past the root directory, hold stale data */
+    (void) memset(   pu8TestFileRam[ 0 ]
+                   + ( ( EF_TEST_FILE_RESERVED_NB + ( 2 * u32FatSize ) + 1 ) * EF_TEST_FILE_SECTOR_SIZE ),
+                   0xA5,
+                   ( u32TestFileRamSectors[ 0 ] - ( EF_TEST_FILE_RESERVED_NB + ( 2 * u32FatSize ) + 1 ) )
+                 * EF_TEST_FILE_SECTOR_SIZE );
+  }
+
+  for ( ef_u32_t i = 0 ; i < u32Head ; i++ )
+  {
+    u8TestFileBuffer[ i ] = u8TestFileData( i );
+  }
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+  {
+    s32RetVal = 3;
+  }
+  /* A head ending inside a sector, a gap made by a seek past the end of the file, then a tail */
+  else if (    ( EF_RET_OK != eEF_fopen( &xFile, "A:SPARSE.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW ) )
+            || ( EF_RET_OK != eEF_fwrite( &xFile, u8TestFileBuffer, u32Head, &u32Done ) )
+            || ( EF_RET_OK != eEF_fseek( &xFile, u32Head + u32Gap ) ) )
+  {
+    s32RetVal = 5;
+  }
+  else
+  {
+    for ( ef_u32_t i = 0 ; i < u32Head ; i++ )
+    {
+      u8TestFileBuffer[ i ] = u8TestFileData( u32Head + u32Gap + i );
+    }
+    if (    ( EF_RET_OK != eEF_fwrite( &xFile, u8TestFileBuffer, u32Head, &u32Done ) )
+         || ( EF_RET_OK != eEF_fclose( &xFile ) )
+         || ( EF_RET_OK != eEF_fopen( &xFile, "A:SPARSE.BIN", EF_FILE_OPEN_EXISTING ) ) )
+    {
+      s32RetVal = 5;
+    }
+    else
+    {
+      /* Read the whole file back */
+      do
+      {
+        if ( EF_RET_OK != eEF_fread( &xFile, u8TestFileBuffer, 4096, &u32Done ) )
+        {
+          s32RetVal = 5;
+        }
+        for ( ef_u32_t i = 0 ; ( 0 == s32RetVal ) && ( i < u32Done ) ; i++ )
+        {
+          u8Expected = (    ( ( u32Offset + i ) < u32Head )
+                         || ( ( u32Offset + i ) >= ( u32Head + u32Gap ) ) ) ? u8TestFileData( u32Offset + i ) : 0;
+          s32RetVal  = ( u8Expected != u8TestFileBuffer[ i ] ) ? 7 : 0;
+        }
+        u32Offset += u32Done;
+      } while ( ( 0 == s32RetVal ) && ( 0 != u32Done ) );
+
+      if ( ( EF_RET_OK != eEF_fclose( &xFile ) ) && ( 0 == s32RetVal ) )
+      {
+        s32RetVal = 5;
+      }
+      else if ( ( 0 == s32RetVal ) && ( ( u32Head + u32Gap + u32Head ) != u32Offset ) )
+      {
+        s32RetVal = 7;
+      }
+      else
+      {
+        EF_CODE_COVERAGE( );
+      }
+    }
+  }
+  (void) eEF_umount( "A:" );
+  if ( 0 == s32RetVal )
+  {
+    s32RetVal = s32TestFileFatCheck( 0, 0 );
+  }
+
+  return s32RetVal;
+}
+#endif
+
+#if ( 0 != EF_CONF_USE_MKFS )
+/* Check the FAT12, FAT16 and FAT32 volumes created by eEF_mkfs() */
+int32_t s32TestFileMkfs (
+  void
+)
+{
+  /* The FAT type follows from the number of one sector clusters, the FAT16 volume goes in an MBR partition, each
+   * sub-type the configuration mounts is checked */
+  static const ef_test_file_mkfs_st xVolumes[ ] = {
+#if ( 0 != EF_FS_FAT12 )
+    { 4000,   FM_FAT | FM_SFD,              12 },
+#endif
+#if ( 0 != EF_FS_FAT16 )
+    { 40000,  FM_FAT,                       16 },
+#endif
+#if ( 0 != EF_FS_FAT32 )
+    { 68000,  FM_FAT32 | FM_SFD | FM_QUICK, 32 },
+#endif
+  };
+  const ef_u32_t    u32Chunk = 700;
+  int32_t           s32RetVal = 0;
+  ef_mkfs_param_st  xParameters;
+  const ef_u08_t  * pu8Boot;
+  ef_u32_t          u32Sector;
+  ef_u32_t          u32FatSize;
+  ef_u32_t          u32ClstNb;
+  ef_u08_t          u8Partition;
+
+  for ( ef_u32_t v = 0 ; ( 0 == s32RetVal ) && ( v < ( sizeof( xVolumes ) / sizeof( xVolumes[ 0 ] ) ) ) ; v++ )
+  {
+    xParameters.u8Format        = xVolumes[ v ].u8Format;
+    xParameters.u8FatsNb        = 2;
+    xParameters.u32DataAlign    = 1;
+    xParameters.u32RootDirNb    = 512;
+    xParameters.u32ClusterSize  = EF_TEST_FILE_SECTOR_SIZE;
+    u8Partition = ( 0 != ( FM_SFD & xVolumes[ v ].u8Format ) ) ? 0 : 1;
+
+    s32RetVal = s32TestFileRam( 0, xVolumes[ v ].u32Sectors );
+    if ( 0 != s32RetVal )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    else if ( EF_RET_OK != eEF_mkfs( 0, 0, &xParameters, u8TestFileBuffer, EF_TEST_FILE_BUFFER_SIZE ) )
+    {
+      s32RetVal = 15;
+    }
+    else
+    {
+      /* The volume starts at the drive start, or at the partition start of the MBR */
+      u32Sector = ( 0 == u8Partition )
+                ? 0 : u32EFPortLoad( pu8TestFileRam[ 0 ] + EF_MBR_OFFSET_PTE_ARRAY + EF_MBR_PTE_OFFSET_LBA_START );
+      pu8Boot   = pu8TestFileRam[ 0 ] + ( (size_t) u32Sector * EF_TEST_FILE_SECTOR_SIZE );
+      /* The FAT type is given by the number of clusters of the boot record */
+      u32FatSize  = u16EFPortLoad( pu8Boot + EF_BS_BPB_FAT_OFFSET_FAT16_SIZE );
+      u32FatSize  = ( 0 != u32FatSize ) ? u32FatSize : u32EFPortLoad( pu8Boot + EF_BS_EBPB_FAT32_OFFSET_FAT_SIZE );
+      u32ClstNb   = u16EFPortLoad( pu8Boot + EF_BS_BPB_FAT_OFFSET_SECTORS_COUNT );
+      u32ClstNb   = ( 0 != u32ClstNb ) ? u32ClstNb : u32EFPortLoad( pu8Boot + EF_BS_BPB_FAT_OFFSET_SECTORS_LARGE_COUNT );
+      u32ClstNb  -=   u16EFPortLoad( pu8Boot + EF_BS_BPB_FAT_OFFSET_SECTORS_RESERVED_NB )
+                    + ( pu8Boot[ EF_BS_BPB_FAT_OFFSET_FATS_NB ] * u32FatSize )
+                    + ( ( u16EFPortLoad( pu8Boot + EF_BS_BPB_FAT_OFFSET_ROOT_ENTRIES ) * EF_DIR_ENTRY_SIZE )
+                      / EF_TEST_FILE_SECTOR_SIZE );
+      u32ClstNb  /= pu8Boot[ EF_BS_BPB_FAT_OFFSET_CLUSTER_SIZE ];
+      if ( xVolumes[ v ].u8FatBits != ( ( 4085 > u32ClstNb ) ? 12 : ( 65525 > u32ClstNb ) ? 16 : 32 ) )
+      {
+        s32RetVal = 15;
+      }
+    }
+
+    if ( 0 != s32RetVal )
+    {
+      EF_CODE_COVERAGE( );
+    }
+    else if ( EF_RET_OK != eEF_mount( "A:", 0, u8Partition, 0 ) )
+    {
+      s32RetVal = 3;
+    }
+    else if (    ( EF_RET_OK != eEF_dirmake( "A:DIR" ) )
+              || ( EF_RET_OK != eTestFileWrite( "A:DIR/FILE.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW, 10000, u32Chunk ) ) )
+    {
+      s32RetVal = 5;
+    }
+    else
+    {
+      s32RetVal = s32TestFileCheck( "A:DIR/FILE.BIN", 10000, &u32Chunk, 1 );
+    }
+    (void) eEF_umount( "A:" );
+    if ( 0 == s32RetVal )
+    {
+      s32RetVal = s32TestFileFatCheck( 0, u32Sector );
+    }
+  }
+
+  return s32RetVal;
+}
+#endif
+
+#if ( 0 != EF_CONF_LAZY_FREE_COUNT )
+/* Check the free cluster count by slices against a full count, with allocations and frees between the slices */
+int32_t s32TestFileLazyFree (
+  void
+)
+{
+  int32_t   s32RetVal;
+  ef_u32_t  u32ClstFree = 0xFFFFFFFF;
+  ef_u32_t  u32ClstFull = 0;
+  ef_u32_t  u32Slices = 0;
+
+  s32RetVal = s32TestFileVolume( 0, EF_TEST_FILE_CLST_NB, 1 );
+  /* A file at the start of the volume, freed once its clusters are counted */
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+  {
+    s32RetVal = 3;
+  }
+  else if ( EF_RET_OK != eTestFileWrite( "A:HEAD.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW, 100000, 4096 ) )
+  {
+    s32RetVal = 5;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+  (void) eEF_umount( "A:" );
+
+  /* The FSINFO free count is unknown, each slice counts 4 FAT sectors */
+  if ( ( 0 == s32RetVal ) && ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) ) )
+  {
+    s32RetVal = 3;
+  }
+  while ( ( 0 == s32RetVal ) && ( 0xFFFFFFFF == u32ClstFree ) )
+  {
+    if ( EF_RET_OK != eEF_getfree_slice( "A:", 4, &u32ClstFree ) )
+    {
+      s32RetVal = 5;
+    }
+    /* Else, if the count is complete before the end of the FAT */
+    else if ( ( 0xFFFFFFFF != u32ClstFree ) && ( ( EF_TEST_FILE_CLST_NB / ( 4 * 128 ) ) > u32Slices ) )
+    {
+      s32RetVal = 6;
+    }
+    /* Else, allocations on both sides of the counted part, then frees in it */
+    else if (    (    ( 2 == u32Slices )
+                   && ( EF_RET_OK != eTestFileWrite( "A:MID.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW, 60000, 4096 ) ) )
+              || (    ( 20 == u32Slices )
+                   && ( EF_RET_OK != eTestFileWrite( "A:LATE.BIN", EF_FILE_OPEN_WRITE | EF_FILE_OPEN_NEW, 30000, 4096 ) ) )
+              || ( ( 40 == u32Slices ) && ( EF_RET_OK != eEF_remove( "A:HEAD.BIN" ) ) ) )
+    {
+      s32RetVal = 5;
+    }
+    else
+    {
+      u32Slices++;
+    }
+  }
+  (void) eEF_umount( "A:" );
+
+  /* The count of the slices is the one of a full scan, and the number of clusters left by the files */
+  if ( 0 != s32RetVal )
+  {
+    EF_CODE_COVERAGE( );
+  }
+  else if (    ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+            || ( EF_RET_OK != eEF_getfree( "A:", &u32ClstFull ) ) )
+  {
+    s32RetVal = 3;
+  }
+  else if (    ( u32ClstFull != u32ClstFree )
+            || ( ( EF_TEST_FILE_CLST_NB - 1 - ( ( 60000 + 511 ) / 512 ) - ( ( 30000 + 511 ) / 512 ) ) != u32ClstFree ) )
+  {
+    s32RetVal = 6;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+
+  /* A full count requested while the slices are half way counts the rest of the FAT only */
+  if (    ( 0 == s32RetVal )
+       && (    ( EF_RET_OK != eEF_umount( "A:" ) )
+            || ( EF_RET_OK != eEF_mount( "A:", 0, 0, 0 ) )
+            || ( EF_RET_OK != eEF_getfree_slice( "A:", 64, &u32ClstFree ) )
+            || ( 0xFFFFFFFF != u32ClstFree )
+            || ( EF_RET_OK != eEF_remove( "A:MID.BIN" ) )
+            || ( EF_RET_OK != eEF_getfree( "A:", &u32ClstFree ) ) ) )
+  {
+    s32RetVal = 5;
+  }
+  else if ( ( 0 == s32RetVal ) && ( ( u32ClstFull + ( ( 60000 + 511 ) / 512 ) ) != u32ClstFree ) )
+  {
+    s32RetVal = 6;
+  }
+  else
+  {
+    EF_CODE_COVERAGE( );
+  }
+  (void) eEF_umount( "A:" );
+  if ( 0 == s32RetVal )
+  {
+    s32RetVal = s32TestFileFatCheck( 0, 0 );
+  }
+
+  return s32RetVal;
+}
+#endif
+
+/* ***************************************************************************************************************** */
+/* END OF FILE ***************************************************************************************************** */